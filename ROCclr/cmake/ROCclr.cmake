@@ -59,11 +59,13 @@ target_sources(rocclr PRIVATE
   ${ROCCLR_SRC_DIR}/device/blit.cpp
   ${ROCCLR_SRC_DIR}/device/blitcl.cpp
   ${ROCCLR_SRC_DIR}/device/comgrctx.cpp
+  ${ROCCLR_SRC_DIR}/device/devcodecache.cpp
   ${ROCCLR_SRC_DIR}/device/devhcmessages.cpp
   ${ROCCLR_SRC_DIR}/device/devhcprintf.cpp
   ${ROCCLR_SRC_DIR}/device/devhostcall.cpp
   ${ROCCLR_SRC_DIR}/device/device.cpp
   ${ROCCLR_SRC_DIR}/device/devkernel.cpp
+  ${ROCCLR_SRC_DIR}/device/devmemranges.cpp
   ${ROCCLR_SRC_DIR}/device/devprogram.cpp
   ${ROCCLR_SRC_DIR}/device/devwavelimiter.cpp
   ${ROCCLR_SRC_DIR}/device/hsailctx.cpp
@@ -75,19 +77,26 @@ target_sources(rocclr PRIVATE
   ${ROCCLR_SRC_DIR}/os/os.cpp
   ${ROCCLR_SRC_DIR}/platform/activity.cpp
   ${ROCCLR_SRC_DIR}/platform/agent.cpp
+  ${ROCCLR_SRC_DIR}/platform/callbackpool.cpp
   ${ROCCLR_SRC_DIR}/platform/command.cpp
+  ${ROCCLR_SRC_DIR}/platform/commandbuffer.cpp
   ${ROCCLR_SRC_DIR}/platform/commandqueue.cpp
   ${ROCCLR_SRC_DIR}/platform/context.cpp
+  ${ROCCLR_SRC_DIR}/platform/hostcopy.cpp
   ${ROCCLR_SRC_DIR}/platform/kernel.cpp
+  ${ROCCLR_SRC_DIR}/platform/latency.cpp
+  ${ROCCLR_SRC_DIR}/platform/memstats.cpp
   ${ROCCLR_SRC_DIR}/platform/memory.cpp
   ${ROCCLR_SRC_DIR}/platform/ndrange.cpp
   ${ROCCLR_SRC_DIR}/platform/program.cpp
   ${ROCCLR_SRC_DIR}/platform/runtime.cpp
+  ${ROCCLR_SRC_DIR}/platform/timeline.cpp
   ${ROCCLR_SRC_DIR}/thread/monitor.cpp
   ${ROCCLR_SRC_DIR}/thread/semaphore.cpp
   ${ROCCLR_SRC_DIR}/thread/thread.cpp
   ${ROCCLR_SRC_DIR}/utils/debug.cpp
-  ${ROCCLR_SRC_DIR}/utils/flags.cpp)
+  ${ROCCLR_SRC_DIR}/utils/flags.cpp
+  ${ROCCLR_SRC_DIR}/utils/trace.cpp)
 
 if(WIN32)
   target_compile_definitions(rocclr PUBLIC ATI_OS_WIN)
@@ -26,6 +26,8 @@
 #include <iterator>
 #include <cassert>
 #include <regex>
+#include <mutex>
+#include <unordered_map>
 #include "options.hpp"
 
 namespace {
@@ -1029,8 +1031,8 @@ namespace amd {
 
 namespace option {
 
-bool
-parseAllOptions(std::string& options, Options& Opts, bool linkOptsOnly, bool isLC)
+static bool
+parseOptionsUncached(std::string& options, Options& Opts, bool linkOptsOnly, bool isLC)
 {
     Opts.origOptionStr = options;
     OptionVariables*  ovars = Opts.oVariables;
@@ -1267,6 +1269,51 @@ parseAllOptions(std::string& options, Options& Opts, bool linkOptsOnly, bool isL
     return true;
 }
 
+// The same option strings are parsed on every build, so keep the parsed
+// results. The cache is bounded, the strings rarely change in a process.
+static const size_t MaxParsedOptions = 64;
+static std::mutex ParsedOptionsLock;
+static std::unordered_map<std::string, std::shared_ptr<const Options>> ParsedOptions;
+
+bool
+parseAllOptions(std::string& options, Options& Opts, bool linkOptsOnly, bool isLC)
+{
+    // The parser skips the leading and trailing blanks
+    size_t bpos = options.find_first_not_of(' ');
+    size_t epos = options.find_last_not_of(' ');
+    std::string key(linkOptsOnly ? "L" : "C");
+    key += isLC ? "1:" : "0:";
+    if (bpos != std::string::npos) {
+        key.append(options, bpos, epos - bpos + 1);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(ParsedOptionsLock);
+        auto it = ParsedOptions.find(key);
+        if (it != ParsedOptions.end()) {
+            Opts.copyParsedOptions(it->second);
+            Opts.origOptionStr = options;
+            return true;
+        }
+    }
+
+    std::shared_ptr<Options> parsed = std::make_shared<Options>();
+    if (!parseOptionsUncached(options, *parsed, linkOptsOnly, isLC)) {
+        // Errors aren't cached, so the log is produced again for the caller
+        return parseOptionsUncached(options, Opts, linkOptsOnly, isLC);
+    }
+    Opts.copyParsedOptions(parsed);
+
+    // The help prints on every parse
+    if (!parsed->isOptionSeen(OID_ShowHelp)) {
+        std::lock_guard<std::mutex> lock(ParsedOptionsLock);
+        if (ParsedOptions.size() < MaxParsedOptions) {
+            ParsedOptions.emplace(key, parsed);
+        }
+    }
+    return true;
+}
+
 bool
 init()
 {
@@ -1710,6 +1757,30 @@ bool Options::setOptionVariablesAs(const Options& other)
     return true;
 }
 
+void Options::copyParsedOptions(const std::shared_ptr<const Options>& parsed)
+{
+    origOptionStr = parsed->origOptionStr;
+    *oVariables = *parsed->oVariables;
+    clcOptions.append(parsed->clcOptions);
+    clangOptions.insert(clangOptions.end(), parsed->clangOptions.begin(),
+                        parsed->clangOptions.end());
+    llvmOptions.append(parsed->llvmOptions);
+    finalizerOptions.insert(finalizerOptions.end(), parsed->finalizerOptions.begin(),
+                            parsed->finalizerOptions.end());
+    for (size_t i = 0; i < 3; ++i) {
+        WorkGroupSize[i] = parsed->WorkGroupSize[i];
+    }
+    UseDefaultWGS = parsed->UseDefaultWGS;
+    for (size_t i = 0; i < sizeof(flags) / sizeof(flags[0]); ++i) {
+        flags[i] |= parsed->flags[i];
+    }
+    if (parsed->llvmargv != NULL) {
+        llvmargc = parsed->llvmargc;
+        llvmargv = parsed->llvmargv;
+    }
+    parsedFrom = parsed;
+}
+
 std::string Options::getStringFromStringVec(std::vector<std::string>& stringVec)
 {
     const char* const delim = " ";
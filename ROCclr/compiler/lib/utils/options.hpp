@@ -23,6 +23,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <cstdio>
 #include "top.hpp"
 #include "library.hpp"
@@ -302,6 +303,10 @@ public:
 
     std::string getFinalizerOptions() { return getStringFromStringVec(finalizerOptions); }
 
+    // Copies the result of parseAllOptions() from "parsed". The string option
+    // variables and llvmargv keep pointing into "parsed", so it stays alive.
+    void copyParsedOptions(const std::shared_ptr<const Options>& parsed);
+
 private:
     std::string fullPath, baseName;
     long basename_max;
@@ -324,6 +329,7 @@ private:
     int encryptCode;
 
     std::vector<char*> MemoryHandles;
+    std::shared_ptr<const Options> parsedFrom;  // Owner of the shared option strings
 
     bool UseDefaultWGS;
 
@@ -22,8 +22,12 @@
 #include "os/os.hpp"
 #include "utils/flags.hpp"
 #include "appprofile.hpp"
+#include <algorithm>
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <map>
 
 typedef void* ADLApplicationProfile;
 int SearchProfileOfAnApplication(const wchar_t* fileName, ADLApplicationProfile** lppProfile)
@@ -73,6 +77,100 @@ bool AppProfile::init() {
 
   ParseApplicationProfile();
 
+  LoadPresets();
+
+  return true;
+}
+
+namespace {
+
+std::string trim(const std::string& str) {
+  const size_t begin = str.find_first_not_of(" \t\r");
+  if (begin == std::string::npos) {
+    return std::string();
+  }
+  return str.substr(begin, str.find_last_not_of(" \t\r") - begin + 1);
+}
+
+std::string toLower(std::string str) {
+  std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+  return str;
+}
+
+}  // namespace
+
+bool AppProfile::LoadPresets() {
+  if (flagIsDefault(ROC_APP_PROFILE_FILE) || (ROC_APP_PROFILE_FILE[0] == '\0')) {
+    return false;
+  }
+  std::ifstream file(ROC_APP_PROFILE_FILE);
+  if (!file.is_open()) {
+    ClPrint(LOG_WARNING, LOG_INIT, "Can't open the application profile %s",
+            ROC_APP_PROFILE_FILE);
+    return false;
+  }
+  const std::string preset =
+      toLower(flagIsDefault(ROC_APP_PROFILE) ? appFileName_ : std::string(ROC_APP_PROFILE));
+
+  // The settings of the application override the ones of all applications
+  std::map<std::string, std::string> settings;
+  std::map<std::string, std::string> defaults;
+  std::map<std::string, std::string>* current = nullptr;
+  std::string line;
+  uint lineNum = 0;
+  while (std::getline(file, line)) {
+    ++lineNum;
+    line = trim(line);
+    if (line.empty() || (line[0] == '#') || (line[0] == ';')) {
+      continue;
+    }
+    if ((line.front() == '[') && (line.back() == ']')) {
+      const std::string section = toLower(trim(line.substr(1, line.size() - 2)));
+      current = (section == preset) ? &settings : (section == "*") ? &defaults : nullptr;
+      continue;
+    }
+    const size_t pos = line.find('=');
+    if (pos == std::string::npos) {
+      ClPrint(LOG_WARNING, LOG_INIT, "%s:%u: Expected NAME=value", ROC_APP_PROFILE_FILE,
+              lineNum);
+      continue;
+    }
+    if (current != nullptr) {
+      (*current)[trim(line.substr(0, pos))] = trim(line.substr(pos + 1));
+    }
+  }
+  settings.insert(defaults.begin(), defaults.end());
+  if (settings.empty()) {
+    return false;
+  }
+
+  bool force = profileOverridesAllSettings_;
+  auto it = settings.find("OverrideEnvironment");
+  if (it != settings.end()) {
+    force = (it->second == "true") || (atoi(it->second.c_str()) != 0);
+    settings.erase(it);
+  }
+
+  for (const auto& setting : settings) {
+    const std::string& value = setting.second;
+    auto prop = propertyDataMap_.find(setting.first);
+    if (prop != propertyDataMap_.end()) {
+      if (prop->second.type_ == DataType_Boolean) {
+        *static_cast<bool*>(prop->second.data_) = (value == "true") || (atoi(value.c_str()) != 0);
+      } else if (prop->second.type_ == DataType_String) {
+        *static_cast<std::string*>(prop->second.data_) = value;
+      }
+    } else {
+      presetValues_.push_back(value);
+      if (!Flag::setValue(setting.first.c_str(), presetValues_.back().c_str(), force)) {
+        ClPrint(LOG_WARNING, LOG_INIT, "Unknown or constant setting %s in the application "
+                "profile", setting.first.c_str());
+        continue;
+      }
+    }
+    ClPrint(LOG_INFO, LOG_INIT, "Application profile %s: %s=%s", preset.c_str(),
+            setting.first.c_str(), value.c_str());
+  }
   return true;
 }
 
@@ -22,6 +22,7 @@
 #define APPPROFILE_HPP_
 
 #include <unordered_map>
+#include <list>
 #include <string>
 
 namespace amd {
@@ -61,9 +62,17 @@ class AppProfile {
 
   virtual bool ParseApplicationProfile();
 
+  /*! Applies the presets of the application from ROC_APP_PROFILE_FILE. The file has
+   *  NAME=value lines in [application] sections, NAME is a runtime flag or a profile property.
+   *  The [*] section applies to all applications. The environment variables take precedence,
+   *  unless the section sets OverrideEnvironment=1
+   */
+  bool LoadPresets();
+
   bool gpuvmHighAddr_;                // Currently not used.
   bool profileOverridesAllSettings_;  // Overrides hint flags and env.var.
   std::string buildOptsAppend_;
+  std::list<std::string> presetValues_;  //!< The string flags point to the preset values
 };
 }
 #endif
@@ -0,0 +1,154 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "device/devcodecache.hpp"
+#include "device/device.hpp"
+#include "os/os.hpp"
+#include "utils/debug.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <system_error>
+
+namespace amd {
+
+static constexpr const char* kCodeCacheExtension = ".co";
+
+// ================================================================================================
+std::string CodeCache::file(const std::string& prefix, const std::string& key) {
+  const std::string path = Device::cachePath();
+  if (path.empty()) {
+    return std::string();
+  }
+  std::stringstream name;
+  name << path << Os::fileSeparator() << prefix << "_" << std::hex
+       << std::hash<std::string>()(key) << kCodeCacheExtension;
+  std::string file = name.str();
+  // The prefix may have ':' for the target features, which isn't valid in the Windows paths
+  std::replace(file.begin() + path.size(), file.end(), ':', '-');
+  return file;
+}
+
+// ================================================================================================
+bool CodeCache::load(const std::string& file, const std::string& key, std::vector<char>* image) {
+  std::ifstream in(file, std::ios::binary);
+  if (!in.good()) {
+    return false;
+  }
+  // The file starts with the key and the size of the code object
+  std::string fileKey;
+  uint64_t size = 0;
+  if (!std::getline(in, fileKey, '\0') || (fileKey != key) ||
+      !in.read(reinterpret_cast<char*>(&size), sizeof(size)) || (size == 0)) {
+    return false;
+  }
+  image->resize(size);
+  if (!in.read(image->data(), size)) {
+    image->clear();
+    return false;
+  }
+  in.close();
+
+  // Update the time of the file, so the trim keeps the recently used code objects
+  std::error_code ec;
+  std::filesystem::last_write_time(file, std::filesystem::file_time_type::clock::now(), ec);
+  return true;
+}
+
+// ================================================================================================
+void CodeCache::save(const std::string& file, const std::string& key, const void* image,
+                     size_t size) {
+  if ((image == nullptr) || (size == 0)) {
+    return;
+  }
+  // Write a temporary file first, so other processes never see a partial code object
+  std::stringstream temp;
+  temp << file << "." << std::hex << Os::timeNanos();
+  {
+    const uint64_t size64 = size;
+    std::ofstream out(temp.str(), std::ios::binary | std::ios::trunc);
+    out.write(key.c_str(), key.size() + 1);
+    out.write(reinterpret_cast<const char*>(&size64), sizeof(size64));
+    out.write(reinterpret_cast<const char*>(image), size);
+    if (!out.good()) {
+      out.close();
+      Os::unlink(temp.str());
+      return;
+    }
+  }
+  if (std::rename(temp.str().c_str(), file.c_str()) != 0) {
+    Os::unlink(temp.str());
+  }
+}
+
+// ================================================================================================
+void CodeCache::trim(const std::string& prefix, uint64_t maxSize) {
+  const std::string path = Device::cachePath();
+  if (path.empty()) {
+    return;
+  }
+  struct Entry {
+    std::filesystem::path file_;
+    std::filesystem::file_time_type time_;
+    uint64_t size_;
+  };
+  std::vector<Entry> entries;
+  uint64_t total = 0;
+  std::error_code ec;
+  for (const auto& it : std::filesystem::directory_iterator(path, ec)) {
+    const std::string name = it.path().filename().string();
+    if ((name.compare(0, prefix.size(), prefix) != 0) ||
+        (it.path().extension() != kCodeCacheExtension)) {
+      continue;
+    }
+    Entry entry = {it.path(), it.last_write_time(ec), it.file_size(ec)};
+    if (!ec) {
+      total += entry.size_;
+      entries.push_back(entry);
+    }
+  }
+  if (total <= maxSize) {
+    return;
+  }
+
+  // Remove the oldest files first. Other processes may remove the same files, hence the
+  // failures are ignored
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) { return a.time_ < b.time_; });
+  for (const auto& entry : entries) {
+    if (total <= maxSize) {
+      break;
+    }
+    std::filesystem::remove(entry.file_, ec);
+    total -= entry.size_;
+    ClPrint(LOG_INFO, LOG_INIT, "Removed %s from the code cache", entry.file_.string().c_str());
+  }
+}
+
+// ================================================================================================
+void CodeCache::reset(const std::string& prefix) {
+  trim(prefix, 0);
+}
+
+}  // namespace amd
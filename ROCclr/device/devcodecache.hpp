@@ -0,0 +1,57 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include "top.hpp"
+
+#include <string>
+#include <vector>
+
+namespace amd {
+
+/*! \brief Content addressed disk cache of the compiled code objects
+ *
+ *  A file holds the full key, the size and the code object. The file name has only
+ *  the hash of the key, hence the loads compare the full key. The files are written
+ *  under a temporary name and renamed, so other processes never see a partial file.
+ */
+class CodeCache : AllStatic {
+ public:
+  //! Returns the cache file for \a key, empty if the cache directory isn't available
+  static std::string file(const std::string& prefix,  //!< File name prefix of the cache user
+                          const std::string& key      //!< The full key of the code object
+                          );
+
+  //! Loads the code object of \a key, returns false on a miss
+  static bool load(const std::string& file, const std::string& key, std::vector<char>* image);
+
+  //! Saves the code object of \a key
+  static void save(const std::string& file, const std::string& key, const void* image,
+                   size_t size);
+
+  //! Removes the least recently used files of \a prefix until they fit into \a maxSize bytes
+  static void trim(const std::string& prefix, uint64_t maxSize);
+
+  //! Removes all files of \a prefix
+  static void reset(const std::string& prefix);
+};
+
+}  // namespace amd
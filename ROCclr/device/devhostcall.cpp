@@ -34,6 +34,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include <map>
 #include <set>
 
 #if defined(__clang__)
@@ -88,7 +89,12 @@ static void handlePayload(MessageHandler& messages, uint32_t service, uint64_t*
       }
       return;
     case SERVICE_DEVMEM: {
+      // The pre-reserved heap serves the slabs without a new allocation
+      amd::Device& heapDev = const_cast<amd::Device&>(dev);
       if (payload[0]) {
+        if (heapDev.MallocHeapFree(payload[0])) {
+          return;
+        }
         amd::Memory* mem = amd::MemObjMap::FindMemObj(reinterpret_cast<void*>(payload[0]));
         if (mem) {
           amd::MemObjMap::RemoveMemObj(reinterpret_cast<void*>(payload[0]));
@@ -97,6 +103,10 @@ static void handlePayload(MessageHandler& messages, uint32_t service, uint64_t*
           ClPrint(amd::LOG_ERROR, amd::LOG_ALWAYS, "Hostcall: Unknown pointer in devmem service\n");
         }
       } else {
+        payload[0] = heapDev.MallocHeapAlloc(payload[1]);
+        if (payload[0] != 0) {
+          return;
+        }
         amd::Context& ctx = dev.context();
         amd::Buffer* buf = new(ctx) amd::Buffer(ctx, CL_MEM_READ_WRITE, payload[1]);
         uint64_t va = 0;
@@ -215,14 +225,18 @@ void HostcallBuffer::initialize(uint32_t num_packets) {
   ready_stack_ = 0;
 }
 
-/** \brief Manage a unique listener thread and its associated buffers.
+/** \brief Manage a listener thread and its associated buffers.
+ *
+ *  Every device has a listener with its own doorbell, so a wakeup processes only the
+ *  buffers of that device. With GPU_HOSTCALL_QUEUE_LISTENER every buffer gets a listener,
+ *  hence the doorbell identifies the buffer, which rang.
  */
 class HostcallListener {
   std::set<HostcallBuffer*> buffers_;
-  device::Signal* doorbell_;
+  device::Signal* doorbell_ = nullptr;
   MessageHandler messages_;
-  // Keep track of devices for which signal creation have already been done
-  std::set<const amd::Device*> devices_;
+  //! Protects buffers_, the listener thread takes it only against the registration
+  amd::Monitor buffersLock_{"Hostcall buffers lock"};
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
    device::UriLocator* urilocator = nullptr;
@@ -261,16 +275,20 @@ class HostcallListener {
 
   /* \brief Return true if no buffers are registered.
   */
-  bool idle() const {
+  bool idle() {
+    amd::ScopedLock lock(buffersLock_);
     return buffers_.empty();
   }
 
   void terminate();
-  bool initSignal(const amd::Device &dev);
-  bool initDevice(const amd::Device &dev);
+  bool init(const amd::Device &dev);
 };
 
-HostcallListener* hostcallListener = nullptr;
+//! The listeners by the device, or by the buffer with GPU_HOSTCALL_QUEUE_LISTENER
+std::map<const void*, HostcallListener*> hostcallListeners;
+//! The listener of every registered buffer
+std::map<HostcallBuffer*, HostcallListener*> bufferListeners;
+//! Protects the listener maps, the packet processing doesn't take it
 amd::Monitor listenerLock("Hostcall listener lock");
 constexpr static uint64_t kTimeoutFloor = K * K * 4;
 constexpr static uint64_t kTimeoutCeil = K * K * 16;
@@ -297,12 +315,9 @@ void HostcallListener::consumePackets() {
       return;
     }
 
-    if (!idle()) {
-      amd::ScopedLock lock{listenerLock};
-
-      for (auto ii : buffers_) {
-        ii->processPackets(messages_);
-      }
+    amd::ScopedLock lock(buffersLock_);
+    for (auto ii : buffers_) {
+      ii->processPackets(messages_);
     }
   }
 
@@ -327,10 +342,10 @@ void HostcallListener::terminate() {
 #endif
 #endif
   delete doorbell_;
-  devices_.clear();
 }
 
 void HostcallListener::addBuffer(HostcallBuffer* buffer) {
+  amd::ScopedLock lock(buffersLock_);
   assert(buffers_.count(buffer) == 0 && "buffer already present");
   buffer->setDoorbell(doorbell_->getHandle());
 #if defined(__clang__)
@@ -342,13 +357,23 @@ void HostcallListener::addBuffer(HostcallBuffer* buffer) {
 }
 
 void HostcallListener::removeBuffer(HostcallBuffer* buffer) {
+  amd::ScopedLock lock(buffersLock_);
   assert(buffers_.count(buffer) != 0 && "unknown buffer");
   buffers_.erase(buffer);
 }
 
-bool HostcallListener::initSignal(const amd::Device &dev) {
+bool HostcallListener::init(const amd::Device &dev) {
+#if defined(WITH_PAL_DEVICE) && !defined(_WIN32)
+  auto ws = device::Signal::WaitState::Active;
+#else
+  auto ws = device::Signal::WaitState::Blocked;
+#endif
   doorbell_ = dev.createSignal();
-  initDevice(dev);
+  if ((doorbell_ == nullptr) || !doorbell_->Init(dev, SIGNAL_INIT, ws)) {
+    delete doorbell_;
+    doorbell_ = nullptr;
+    return false;
+  }
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
   urilocator = dev.createUriLocator();
@@ -358,7 +383,7 @@ bool HostcallListener::initSignal(const amd::Device &dev) {
   // everything up and bail out.
   if (thread_.state() < Thread::INITIALIZED) {
     delete doorbell_;
-    devices_.clear();
+    doorbell_ = nullptr;
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
     delete urilocator;
@@ -370,70 +395,54 @@ bool HostcallListener::initSignal(const amd::Device &dev) {
   return true;
 }
 
-bool HostcallListener::initDevice(const amd::Device &dev) {
-  // Create only one signal per device
-  // This is to avoid conflicts when n signals are created for n HIP streams per device
-  if (devices_.count(&dev) == 0) {
-#if defined(WITH_PAL_DEVICE) && !defined(_WIN32)
-    auto ws = device::Signal::WaitState::Active;
-#else
-    auto ws = device::Signal::WaitState::Blocked;
-#endif
-    if ((doorbell_ == nullptr) || !doorbell_->Init(dev, SIGNAL_INIT, ws)) {
-      return false;
-    }
-    devices_.insert(&dev);
-  }
-return true;
-}
-
 bool enableHostcalls(const amd::Device &dev, void* bfr, uint32_t numPackets) {
   auto buffer = reinterpret_cast<HostcallBuffer*>(bfr);
   buffer->initialize(numPackets);
   buffer->setDevice(&dev);
 
   amd::ScopedLock lock(listenerLock);
-  if (!hostcallListener) {
-    hostcallListener = new HostcallListener();
-    if (!hostcallListener->initSignal(dev)) {
+  const void* key = GPU_HOSTCALL_QUEUE_LISTENER ? static_cast<const void*>(buffer) : &dev;
+  HostcallListener*& listener = hostcallListeners[key];
+  if (listener == nullptr) {
+    listener = new HostcallListener();
+    if (!listener->init(dev)) {
       ClPrint(amd::LOG_ERROR, (amd::LOG_INIT | amd::LOG_QUEUE | amd::LOG_RESOURCE),
               "Failed to launch hostcall listener");
-      delete hostcallListener;
-      hostcallListener = nullptr;
+      delete listener;
+      hostcallListeners.erase(key);
       return false;
     }
     ClPrint(amd::LOG_INFO, (amd::LOG_INIT | amd::LOG_QUEUE | amd::LOG_RESOURCE),
-            "Launched hostcall listener at %p", hostcallListener);
+            "Launched hostcall listener at %p", listener);
   }
-// For PAL, create one signal per device (inside hostcallListener->initDevice(dev)) whose pointer is stored in this hostcall buffer
-// For ROCr, create only one signal across all devices (inside hostcallListener->initSignal(dev)) whose pointer is stored in every hostcall buffer
-#if defined(WITH_PAL_DEVICE)
-  else if (!hostcallListener->initDevice(dev)) {
-    ClPrint(amd::LOG_INFO, (amd::LOG_INIT | amd::LOG_QUEUE | amd::LOG_RESOURCE),
-            "failed to initialize device for hostcall");
-    return false;
-  }
-#endif // defined(WITH_PAL_DEVICE)
-  hostcallListener->addBuffer(buffer);
+  listener->addBuffer(buffer);
+  bufferListeners[buffer] = listener;
   ClPrint(amd::LOG_INFO, amd::LOG_QUEUE, "Registered hostcall buffer %p with listener %p", buffer,
-          hostcallListener);
+          listener);
   return true;
 }
 
 void disableHostcalls(void* bfr) {
-  {
-    amd::ScopedLock lock(listenerLock);
-    if (!hostcallListener) {
-      return;
-    }
-    assert(bfr && "expected a hostcall buffer");
-    auto buffer = reinterpret_cast<HostcallBuffer*>(bfr);
-    hostcallListener->removeBuffer(buffer);
+  assert(bfr && "expected a hostcall buffer");
+  auto buffer = reinterpret_cast<HostcallBuffer*>(bfr);
+  amd::ScopedLock lock(listenerLock);
+  auto it = bufferListeners.find(buffer);
+  if (it == bufferListeners.end()) {
+    return;
   }
-  if (hostcallListener->idle()) {
-    hostcallListener->terminate();
-    delete hostcallListener;
-    hostcallListener = nullptr;
-    ClPrint(amd::LOG_INFO, amd::LOG_INIT, "Terminated hostcall listener");
+  HostcallListener* listener = it->second;
+  bufferListeners.erase(it);
+  listener->removeBuffer(buffer);
+  if (listener->idle()) {
+    for (auto ii = hostcallListeners.begin(); ii != hostcallListeners.end(); ++ii) {
+      if (ii->second == listener) {
+        hostcallListeners.erase(ii);
+        break;
+      }
+    }
+    // The listener thread never takes listenerLock, so the join can't deadlock
+    listener->terminate();
+    delete listener;
+    ClPrint(amd::LOG_INFO, amd::LOG_INIT, "Terminated hostcall listener %p", listener);
   }
 }
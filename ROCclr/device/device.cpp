@@ -22,6 +22,7 @@
 #include "thread/monitor.hpp"
 #include "utils/options.hpp"
 #include "comgrctx.hpp"
+#include "devcodecache.hpp"
 
 #include <algorithm>
 #include <array>
@@ -65,6 +66,7 @@ extern void PalDeviceUnload();
 #include <fstream>
 #include <set>
 #include <algorithm>
+#include <limits>
 #include <numeric>
 
 namespace {
@@ -262,86 +264,279 @@ Context* Device::glb_ctx_ = nullptr;
 Monitor Device::p2p_stage_ops_("P2P Staging Lock", true);
 Memory* Device::p2p_stage_ = nullptr;
 
+namespace {
+
+//! Readers of the lookup index, which can pin an epoch at the same time
+constexpr uint32_t kMaxIndexReaders = 256;
+//! Number of the lookups under the lock, which rebuild a stale index
+constexpr uint32_t kIndexRebuildLookups = 8;
+
+struct alignas(64) IndexReader {
+  std::atomic<uint64_t> epoch_{0};  //!< The pinned epoch or 0 if the reader is idle
+  std::atomic<bool> used_{false};   //!< True if a thread owns the slot
+};
+
+IndexReader indexReaders[kMaxIndexReaders];
+std::atomic<uint64_t> indexEpoch{1};
+
+//! Owns a reader slot for the lifetime of the thread
+class IndexReaderSlot {
+ public:
+  IndexReaderSlot() : reader_(nullptr) {
+    for (auto& reader : indexReaders) {
+      bool used = false;
+      if (!reader.used_.load(std::memory_order_relaxed) &&
+          reader.used_.compare_exchange_strong(used, true)) {
+        reader_ = &reader;
+        break;
+      }
+    }
+  }
+  ~IndexReaderSlot() {
+    if (reader_ != nullptr) {
+      reader_->used_.store(false, std::memory_order_release);
+    }
+  }
+  IndexReader* reader() const { return reader_; }
+
+ private:
+  IndexReader* reader_;  //!< The slot of this thread or nullptr if all slots are busy
+};
+
+//! Pins the current epoch, so the snapshots, visible to the thread, aren't destroyed
+class IndexEpochPin {
+ public:
+  IndexEpochPin() {
+    static thread_local IndexReaderSlot slot;
+    reader_ = slot.reader();
+    if (reader_ != nullptr) {
+      // The store is ordered before the snapshot load, hence the writer will see the pin
+      reader_->epoch_.store(indexEpoch.load());
+    }
+  }
+  ~IndexEpochPin() {
+    if (reader_ != nullptr) {
+      reader_->epoch_.store(0, std::memory_order_release);
+    }
+  }
+  bool pinned() const { return reader_ != nullptr; }
+
+ private:
+  IndexReader* reader_;
+};
+
+//! Entries of the per-thread lookup cache. The cache is indexed by the page of the address
+constexpr uint32_t kLookupCacheSize = 256;
+constexpr uint32_t kLookupCachePageShift = 12;
+
+//! A recent lookup hit. The entry is valid while its generation matches the global one
+struct LookupCacheEntry {
+  uintptr_t start_;
+  uintptr_t end_;
+  amd::Memory* mem_;
+  uint64_t generation_;
+};
+
+//! Generation of the mem objects. A removal of any object invalidates all cached hits
+std::atomic<uint64_t> lookupGeneration{1};
+
+thread_local LookupCacheEntry memObjCache[kLookupCacheSize];
+thread_local LookupCacheEntry virtualMemObjCache[kLookupCacheSize];
+
+//! Finds the mem object in the cache and falls back to the container lookup on a miss
+template <typename Lookup>
+amd::Memory* CachedFind(LookupCacheEntry* cache, uintptr_t key, Lookup lookup) {
+  // Load the generation before the lookup, so a concurrent removal invalidates the new entry
+  const uint64_t generation = lookupGeneration.load(std::memory_order_acquire);
+  LookupCacheEntry& entry = cache[(key >> kLookupCachePageShift) % kLookupCacheSize];
+  if ((entry.generation_ == generation) && (key >= entry.start_) && (key < entry.end_)) {
+    return entry.mem_;
+  }
+  uintptr_t start = 0;
+  amd::Memory* mem = lookup(key, &start);
+  if (mem != nullptr) {
+    entry = {start, start + mem->getSize(), mem, generation};
+  }
+  return mem;
+}
+
+}  // namespace
+
+struct MemObjMap::Snapshot {
+  struct Range {
+    uintptr_t start_;    //!< Start address of the mem object
+    uintptr_t end_;      //!< End address of the mem object
+    amd::Memory* mem_;   //!< The mem object
+  };
+  std::vector<Range> ranges_;  //!< Ranges, sorted by the start address
+
+  explicit Snapshot(const std::map<uintptr_t, amd::Memory*>& map) {
+    ranges_.reserve(map.size());
+    for (const auto& it : map) {
+      ranges_.push_back({it.first, it.first + it.second->getSize(), it.second});
+    }
+  }
+
+  amd::Memory* find(uintptr_t key, uintptr_t* start) const {
+    auto it = std::upper_bound(ranges_.begin(), ranges_.end(), key,
+                               [](uintptr_t k, const Range& range) { return k < range.start_; });
+    if (it == ranges_.begin()) {
+      return nullptr;
+    }
+    --it;
+    *start = it->start_;
+    return (key < it->end_) ? it->mem_ : nullptr;
+  }
+};
+
 Monitor MemObjMap::AllocatedLock_ ROCCLR_INIT_PRIORITY(101) ("Guards MemObjMap allocation list");
-std::map<uintptr_t, amd::Memory*> MemObjMap::MemObjMap_ ROCCLR_INIT_PRIORITY(101);
-std::map<uintptr_t, amd::Memory*> MemObjMap::VirtualMemObjMap_ ROCCLR_INIT_PRIORITY(101);
+MemObjMap::Container MemObjMap::MemObjMap_ ROCCLR_INIT_PRIORITY(101);
+MemObjMap::Container MemObjMap::VirtualMemObjMap_ ROCCLR_INIT_PRIORITY(101);
+std::unordered_map<const Device*, std::map<uintptr_t, Memory*>> MemObjMap::PeerPending_
+    ROCCLR_INIT_PRIORITY(101);
+std::vector<std::pair<MemObjMap::Snapshot*, uint64_t>> MemObjMap::Retired_
+    ROCCLR_INIT_PRIORITY(101);
+
+amd::Memory* MemObjMap::Find(Container& container, uintptr_t key, uintptr_t* start) {
+  {
+    IndexEpochPin pin;
+    if (pin.pinned()) {
+      const Snapshot* snapshot = container.snapshot_.load();
+      if (snapshot != nullptr) {
+        return snapshot->find(key, start);
+      }
+    }
+  }
+
+  amd::ScopedSharedLock lock(AllocatedLock_);
+  amd::Memory* mem = nullptr;
+  auto it = container.map_.upper_bound(key);
+  if (it != container.map_.begin()) {
+    --it;
+    if (key >= it->first && key < (it->first + it->second->getSize())) {
+      // the k is in the range
+      mem = it->second;
+      *start = it->first;
+    }
+  }
+  // Rebuild the index only after a few lookups, so a series of updates copies the map once
+  if ((container.snapshot_.load(std::memory_order_relaxed) == nullptr) &&
+      ((container.lockedLookups_.fetch_add(1, std::memory_order_relaxed) + 1) >=
+       kIndexRebuildLookups)) {
+    // Other readers can build the index at the same time, only one installs it
+    Snapshot* snapshot = new Snapshot(container.map_);
+    Snapshot* expected = nullptr;
+    if (!container.snapshot_.compare_exchange_strong(expected, snapshot)) {
+      delete snapshot;
+    }
+  }
+  return mem;
+}
+
+void MemObjMap::Invalidate(Container& container) {
+  container.lockedLookups_ = 0;
+  Snapshot* snapshot = container.snapshot_.exchange(nullptr);
+  if (snapshot == nullptr) {
+    return;
+  }
+  // The readers, which pinned the current or an older epoch, can still use the snapshot
+  Retired_.push_back({snapshot, indexEpoch.fetch_add(1)});
+
+  uint64_t oldest = std::numeric_limits<uint64_t>::max();
+  for (const auto& reader : indexReaders) {
+    uint64_t epoch = reader.epoch_.load();
+    if (epoch != 0) {
+      oldest = std::min(oldest, epoch);
+    }
+  }
+  for (auto it = Retired_.begin(); it != Retired_.end();) {
+    if (it->second < oldest) {
+      delete it->first;
+      it = Retired_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
 
 size_t MemObjMap::size() {
-  amd::ScopedLock lock(AllocatedLock_);
-  return MemObjMap_.size();
+  amd::ScopedSharedLock lock(AllocatedLock_);
+  return MemObjMap_.map_.size();
 }
 
 void MemObjMap::AddMemObj(const void* k, amd::Memory* v) {
   amd::ScopedLock lock(AllocatedLock_);
-  auto rval = MemObjMap_.insert({ reinterpret_cast<uintptr_t>(k), v });
+  auto rval = MemObjMap_.map_.insert({ reinterpret_cast<uintptr_t>(k), v });
   if (!rval.second) {
     DevLogPrintfError("Memobj map already has an entry for ptr: 0x%x",
                       reinterpret_cast<uintptr_t>(k));
+  } else {
+    Invalidate(MemObjMap_);
+    const std::vector<Device*>& devices = v->getContext().devices();
+    if (devices.size() == 1) {
+      PeerPending_[devices[0]].insert({reinterpret_cast<uintptr_t>(k), v});
+    }
   }
 }
 
 void MemObjMap::RemoveMemObj(const void* k) {
   amd::ScopedLock lock(AllocatedLock_);
-  auto rval = MemObjMap_.erase(reinterpret_cast<uintptr_t>(k));
-  if (rval != 1) {
+  auto it = MemObjMap_.map_.find(reinterpret_cast<uintptr_t>(k));
+  if (it == MemObjMap_.map_.end()) {
     DevLogPrintfError("Memobj map does not have ptr: 0x%x",
                       reinterpret_cast<uintptr_t>(k));
     guarantee(false, "Memobj map does not have ptr");
+    return;
+  }
+  const std::vector<Device*>& devices = it->second->getContext().devices();
+  if (devices.size() == 1) {
+    auto pending = PeerPending_.find(devices[0]);
+    if (pending != PeerPending_.end()) {
+      pending->second.erase(it->first);
+    }
   }
+  MemObjMap_.map_.erase(it);
+  Invalidate(MemObjMap_);
+  lookupGeneration.fetch_add(1, std::memory_order_release);
 }
 
 amd::Memory* MemObjMap::FindMemObj(const void* k) {
-  amd::ScopedLock lock(AllocatedLock_);
-  uintptr_t key = reinterpret_cast<uintptr_t>(k);
-  auto it = MemObjMap_.upper_bound(key);
-  if (it == MemObjMap_.begin()) {
-    return nullptr;
-  }
+  return CachedFind(memObjCache, reinterpret_cast<uintptr_t>(k),
+                    [](uintptr_t key, uintptr_t* start) { return Find(MemObjMap_, key, start); });
+}
 
-  --it;
-  amd::Memory* mem = it->second;
-  if (key >= it->first && key < (it->first + mem->getSize())) {
-    // the k is in the range
-    return mem;
-  } else {
-    return nullptr;
-  }
+uint64_t MemObjMap::Generation() {
+  return lookupGeneration.load(std::memory_order_acquire);
 }
+
 void MemObjMap::AddVirtualMemObj(const void* k, amd::Memory* v) {
   amd::ScopedLock lock(AllocatedLock_);
-  auto rval = VirtualMemObjMap_.insert({ reinterpret_cast<uintptr_t>(k), v });
+  auto rval = VirtualMemObjMap_.map_.insert({ reinterpret_cast<uintptr_t>(k), v });
   if (!rval.second) {
     DevLogPrintfError("Virtual Memobj map already has an entry for ptr: 0x%x",
                       reinterpret_cast<uintptr_t>(k));
+  } else {
+    Invalidate(VirtualMemObjMap_);
   }
 }
 
 void MemObjMap::RemoveVirtualMemObj(const void* k) {
   amd::ScopedLock lock(AllocatedLock_);
-  auto rval = VirtualMemObjMap_.erase(reinterpret_cast<uintptr_t>(k));
+  auto rval = VirtualMemObjMap_.map_.erase(reinterpret_cast<uintptr_t>(k));
   if (rval != 1) {
     DevLogPrintfError("Virtual Memobj map does not have ptr: 0x%x",
                       reinterpret_cast<uintptr_t>(k));
     guarantee(false, "VirtualMemobj map does not have ptr");
   }
+  Invalidate(VirtualMemObjMap_);
+  lookupGeneration.fetch_add(1, std::memory_order_release);
 }
 
 amd::Memory* MemObjMap::FindVirtualMemObj(const void* k) {
-  amd::ScopedLock lock(AllocatedLock_);
-  uintptr_t key = reinterpret_cast<uintptr_t>(k);
-  auto it = VirtualMemObjMap_.upper_bound(key);
-  if (it == VirtualMemObjMap_.begin()) {
-    return nullptr;
-  }
-
-  --it;
-  amd::Memory* mem = it->second;
-  if (key >= it->first && key < (it->first + mem->getSize())) {
-    // the k is in the range
-    return mem;
-  } else {
-    return nullptr;
-  }
+  return CachedFind(virtualMemObjCache, reinterpret_cast<uintptr_t>(k),
+                    [](uintptr_t key, uintptr_t* start) {
+                      return Find(VirtualMemObjMap_, key, start);
+                    });
 }
 
 void MemObjMap::UpdateAccess(amd::Device *peerDev) {
@@ -350,34 +545,49 @@ void MemObjMap::UpdateAccess(amd::Device *peerDev) {
   }
 
   // Provides access to all memory allocated on peerDev but
-  // hsa_amd_agents_allow_access was not called because there was no peer
+  // hsa_amd_agents_allow_access was not called because there was no peer.
+  // Only the allocations of peerDev are visited and the device grants them in bulk
   amd::ScopedLock lock(AllocatedLock_);
-  for (auto it : MemObjMap_) {
-    const std::vector<Device*>& devices = it.second->getContext().devices();
-    if (devices.size() == 1 && devices[0] == peerDev) {
-      device::Memory* devMem = it.second->getDeviceMemory(*devices[0]);
-      if (!devMem->getAllowedPeerAccess()) {
-        peerDev->deviceAllowAccess(reinterpret_cast<void*>(it.first));
-        devMem->setAllowedPeerAccess(true);
-      }
+  auto pending = PeerPending_.find(peerDev);
+  if (pending == PeerPending_.end()) {
+    return;
+  }
+  std::vector<void*> ptrs;
+  std::vector<device::Memory*> devMems;
+  ptrs.reserve(pending->second.size());
+  devMems.reserve(pending->second.size());
+  for (auto it : pending->second) {
+    device::Memory* devMem = it.second->getDeviceMemory(*peerDev);
+    if ((devMem != nullptr) && !devMem->getAllowedPeerAccess()) {
+      ptrs.push_back(reinterpret_cast<void*>(it.first));
+      devMems.push_back(devMem);
     }
   }
+  peerDev->deviceAllowAccess(ptrs);
+  for (auto devMem : devMems) {
+    devMem->setAllowedPeerAccess(true);
+  }
+  // All allocations have the access now, only the new ones need a grant later
+  pending->second.clear();
 }
 
 void MemObjMap::Purge(amd::Device* dev) {
   assert(dev != nullptr);
 
   amd::ScopedLock lock(AllocatedLock_);
-  for (auto it = MemObjMap_.cbegin(); it != MemObjMap_.cend(); ) {
+  for (auto it = MemObjMap_.map_.cbegin(); it != MemObjMap_.map_.cend(); ) {
     amd::Memory* memObj = it->second;
     unsigned int flags = memObj->getMemFlags();
     const std::vector<Device*>& devices = memObj->getContext().devices();
     if (devices.size() == 1 && devices[0] == dev && !(flags & ROCCLR_MEM_INTERNAL_MEMORY)) {
-      it = MemObjMap_.erase(it);
+      PeerPending_[dev].erase(it->first);
+      it = MemObjMap_.map_.erase(it);
     } else {
       ++it;
     }
   }
+  Invalidate(MemObjMap_);
+  lookupGeneration.fetch_add(1, std::memory_order_release);
 }
 
 Device::BlitProgram::~BlitProgram() {
@@ -401,12 +611,6 @@ bool Device::BlitProgram::create(amd::Device* device, const std::string& extraKe
     kernels += extraKernels;
   }
 
-  // Create a program with all blit kernels
-  program_ = new Program(*context_, kernels.c_str(), Program::OpenCL_C);
-  if (program_ == nullptr) {
-    return false;
-  }
-
   // Build all kernels
   std::string opt = "-cl-internal-kernel ";
   if (!device->settings().useLightning_) {
@@ -419,6 +623,20 @@ bool Device::BlitProgram::create(amd::Device* device, const std::string& extraKe
   if (!GPU_DUMP_BLIT_KERNELS) {
     opt += " -fno-enable-dump";
   }
+
+  // Skip the compilation if a previous process cached the code object for this device
+  std::string key;
+  const std::string file = cacheFile(device, kernels, opt, &key);
+  if (!file.empty() && loadCached(device, file, key, opt)) {
+    return true;
+  }
+
+  // Create a program with all blit kernels
+  program_ = new Program(*context_, kernels.c_str(), Program::OpenCL_C);
+  if (program_ == nullptr) {
+    return false;
+  }
+
   if (CL_SUCCESS !=
       program_->build(devices, opt.c_str(), nullptr, nullptr, GPU_DUMP_BLIT_KERNELS)) {
     DevLogPrintfError("Build failed for Kernel: %s \n", kernels.c_str());
@@ -429,9 +647,85 @@ bool Device::BlitProgram::create(amd::Device* device, const std::string& extraKe
     return false;
   }
 
+  if (!file.empty()) {
+    saveCached(device, file, key);
+  }
+
   return true;
 }
 
+std::string Device::cachePath() {
+  std::string path = GPU_BLIT_CODE_CACHE_PATH;
+  if (path.empty()) {
+    path = Os::getEnvironment("XDG_CACHE_HOME");
+    if (path.empty()) {
+      path = Os::getEnvironment(IS_WINDOWS ? "LOCALAPPDATA" : "HOME");
+      if (path.empty()) {
+        return std::string();
+      }
+      if (!IS_WINDOWS) {
+        path += Os::fileSeparator() + std::string(".cache");
+      }
+    }
+    path += Os::fileSeparator() + std::string("rocclr");
+  }
+  if (!Os::pathExists(path) && !Os::createPath(path)) {
+    return std::string();
+  }
+  return path;
+}
+
+std::string Device::BlitProgram::cacheFile(const Device* device, const std::string& kernels,
+                                           const std::string& options, std::string* key) {
+  if (!GPU_BLIT_CODE_CACHE || GPU_DUMP_BLIT_KERNELS) {
+    return std::string();
+  }
+
+  // The key identifies the code object, since the file name has only the hash of it
+  std::stringstream stream;
+  stream << device->isa().targetId() << ";" << AMD_BUILD_STRING << ";" << options << ";"
+         << kernels.size() << ";" << std::hex << std::hash<std::string>()(kernels);
+  *key = stream.str();
+
+  return CodeCache::file(std::string("blit_") + device->isa().targetId(), *key);
+}
+
+bool Device::BlitProgram::loadCached(Device* device, const std::string& file,
+                                     const std::string& key, const std::string& options) {
+  std::vector<char> image;
+  if (!CodeCache::load(file, key, &image)) {
+    return false;
+  }
+
+  std::vector<amd::Device*> devices;
+  devices.push_back(device);
+  program_ = new Program(*context_);
+  if ((program_ == nullptr) ||
+      (CL_SUCCESS != program_->addDeviceProgram(*device, image.data(), image.size())) ||
+      (CL_SUCCESS != program_->build(devices, options.c_str(), nullptr, nullptr, false)) ||
+      !program_->load()) {
+    // The cache is stale or broken, rebuild the kernels from the source
+    LogPrintfWarning("Blit kernel cache %s is invalid", file.c_str());
+    if (program_ != nullptr) {
+      program_->release();
+      program_ = nullptr;
+    }
+    return false;
+  }
+  ClPrint(LOG_INFO, LOG_INIT, "Loaded blit kernels from %s", file.c_str());
+  return true;
+}
+
+void Device::BlitProgram::saveCached(Device* device, const std::string& file,
+                                     const std::string& key) const {
+  const device::Program* devProgram = program_->getDeviceProgram(*device);
+  if (devProgram == nullptr) {
+    return;
+  }
+  device::Program::binary_t binary = devProgram->binary();
+  CodeCache::save(file, key, binary.first, binary.second);
+}
+
 bool Device::init() {
   assert(!Runtime::initialized() && "initialize only once");
   bool ret = false;
@@ -490,7 +784,7 @@ void Device::tearDown() {
 Device::Device()
     : settings_(nullptr),
       online_(true),
-      activeWait_(false),
+      waitMode_(WaitAuto),
       blitProgram_(nullptr),
       hwDebugMgr_(nullptr),
       context_(nullptr),
@@ -519,6 +813,12 @@ Device::~Device() {
     arena_mem_obj_->release();
   }
 
+  if (malloc_heap_ != nullptr) {
+    amd::MemObjMap::RemoveMemObj(
+        reinterpret_cast<void*>(malloc_heap_->getDeviceMemory(*this)->virtualAddress()));
+    malloc_heap_->release();
+  }
+
   delete settings_;
   delete[] info_.extensions_;
 }
@@ -716,6 +1016,86 @@ bool Device::UpdateStackSize(uint64_t stackSize) {
   return true;
 }
 
+// ================================================================================================
+bool Device::UpdateMallocHeapSize(uint64_t heapSize) {
+  ScopedLock lock(malloc_heap_lock_);
+  // The device library may hold slabs of the heap already
+  if ((malloc_heap_ != nullptr) || (heapSize > info().maxMemAllocSize_)) {
+    return false;
+  }
+  malloc_heap_size_ = heapSize;
+  return true;
+}
+
+// ================================================================================================
+uint64_t Device::MallocHeapAlloc(size_t size) {
+  // Keep the slabs page aligned, as the separate buffers would be
+  static constexpr size_t kChunkAlignment = 4 * Ki;
+  size = amd::alignUp(size, kChunkAlignment);
+  ScopedLock lock(malloc_heap_lock_);
+  if ((malloc_heap_size_ == 0) || (size > malloc_heap_size_)) {
+    return 0;
+  }
+  if (malloc_heap_ == nullptr) {
+    // Reserve the whole heap on the first request, hence the growth of the device allocator
+    // doesn't allocate the memory in the hostcall path
+    amd::Buffer* heap = new (context()) amd::Buffer(context(), CL_MEM_READ_WRITE,
+                                                    malloc_heap_size_);
+    if ((heap == nullptr) || !heap->create()) {
+      if (heap != nullptr) {
+        heap->release();
+      }
+      LogError("Device malloc heap reservation failed!");
+      malloc_heap_size_ = 0;
+      return 0;
+    }
+    uint64_t base = heap->getDeviceMemory(*this)->virtualAddress();
+    amd::MemObjMap::AddMemObj(reinterpret_cast<void*>(base), heap);
+    malloc_heap_ = heap;
+    malloc_heap_free_[base] = malloc_heap_size_;
+  }
+  // First fit, the device allocator requests the slabs of a few sizes only
+  for (auto it = malloc_heap_free_.begin(); it != malloc_heap_free_.end(); ++it) {
+    if (it->second >= size) {
+      const uint64_t va = it->first;
+      const size_t left = it->second - size;
+      malloc_heap_free_.erase(it);
+      if (left != 0) {
+        malloc_heap_free_[va + size] = left;
+      }
+      malloc_heap_used_[va] = size;
+      return va;
+    }
+  }
+  return 0;
+}
+
+// ================================================================================================
+bool Device::MallocHeapFree(uint64_t va) {
+  ScopedLock lock(malloc_heap_lock_);
+  auto used = malloc_heap_used_.find(va);
+  if (used == malloc_heap_used_.end()) {
+    return false;
+  }
+  size_t size = used->second;
+  malloc_heap_used_.erase(used);
+  // Merge the chunk with the adjacent free ranges
+  auto next = malloc_heap_free_.lower_bound(va);
+  if ((next != malloc_heap_free_.end()) && (next->first == va + size)) {
+    size += next->second;
+    next = malloc_heap_free_.erase(next);
+  }
+  if (next != malloc_heap_free_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == va) {
+      prev->second += size;
+      return true;
+    }
+  }
+  malloc_heap_free_[va] = size;
+  return true;
+}
+
 char* Device::getExtensionString() {
   std::stringstream extStream;
   size_t size;
@@ -821,7 +1201,7 @@ ClBinary::ClBinary(const amd::Device& dev, BinaryImageFormat bifVer)
 ClBinary::~ClBinary() {
   release();
 
-  delete elfIn_;
+  resetElfIn();
   delete elfOut_;
 }
 
@@ -932,7 +1312,12 @@ bool ClBinary::isRecompilable(std::string& llvmBinary, amd::Elf::ElfPlatform the
 
 void ClBinary::release() {
   if (isBinaryAllocated() && (binary_ != nullptr)) {
-    delete[] binary_;
+    if (elfIn_ != nullptr) {
+      // elfIn_ reads the binary in place, hence keep it until resetElfIn()
+      retiredBinaries_.push_back(binary_);
+    } else {
+      delete[] binary_;
+    }
     binary_ = nullptr;
     flags_ &= ~BinaryAllocated;
   }
@@ -1111,6 +1496,10 @@ bool ClBinary::setElfIn() {
 void ClBinary::resetElfIn() {
   delete elfIn_;
   elfIn_ = nullptr;
+  for (auto it : retiredBinaries_) {
+    delete[] it;
+  }
+  retiredBinaries_.clear();
 }
 
 bool ClBinary::setElfOut(unsigned char eclass,
@@ -27,6 +27,8 @@
 #include "platform/context.hpp"
 #include "platform/object.hpp"
 #include "platform/memory.hpp"
+#include "platform/latency.hpp"
+#include "platform/memstats.hpp"
 #include "utils/util.hpp"
 #include "amdocl/cl_kernel.h"
 #include "elf/elf.hpp"
@@ -56,6 +58,7 @@
 #include <mutex>
 #include <list>
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
@@ -93,6 +96,8 @@ class SvmPrefetchAsyncCommand;
 class TransferBufferFileCommand;
 class StreamOperationCommand;
 class VirtualMapCommand;
+class CopyMemoryBatchCommand;
+class AccumulateCommand;
 class ExternalSemaphoreCmd;
 class HwDebugManager;
 class Isa;
@@ -169,6 +174,8 @@ enum OclExtensions {
   ClAMDLiquidFlash,
   ClAmdCopyBufferP2P,
   ClAmdAssemblyProgram,
+  ClAmdCommandBuffer,
+  ClAmdPipeHostAccess,
 #if defined(_WIN32)
   ClAmdPlanarYuv,
 #endif
@@ -215,6 +222,8 @@ static constexpr const char* OclExtensionsString[] = {"cl_khr_fp64 ",
                                             "cl_amd_liquid_flash ",
                                             "cl_amd_copy_buffer_p2p ",
                                             "cl_amd_assembly_program ",
+                                            "cl_amd_command_buffer ",
+                                            "cl_amd_pipe_host_access ",
 #if defined(_WIN32)
                                             "cl_amd_planar_yuv",
 #endif
@@ -882,7 +891,8 @@ class Memory : public amd::HeapObject {
     HostMemoryRegistered = 0x00000010,    //!< Host memory was registered
     MemoryCpuUncached = 0x00000020,       //!< Memory is uncached on CPU access(slow read)
     AllowedPeerAccess = 0x00000040,       //!< Memory can be accessed from peer
-    PersistentMap = 0x00000080            //!< Map Peristent memory
+    PersistentMap = 0x00000080,           //!< Map Peristent memory
+    SubAllocated = 0x00000100             //!< Memory is suballocated from a larger chunk
   };
   uint flags_;  //!< Memory object flags
 
@@ -1113,6 +1123,9 @@ class ClBinary : public amd::HeapObject {
   std::string fname_; //!< name of elf dump file
   bool tempFile_;     //!< Is the elf dump file temporary
 
+  //! The replaced binaries, which elfIn_ may still read
+  std::vector<const char*> retiredBinaries_;
+
  protected:
   amd::Elf* elfIn_;        //!< ELF object for input ELF binary
   amd::Elf* elfOut_;       //!< ELF object for output ELF binary
@@ -1242,11 +1255,26 @@ class VirtualDevice : public amd::HeapObject {
   }
   virtual void submitStreamOperation(amd::StreamOperationCommand& cmd) { ShouldNotReachHere(); }
   virtual void submitVirtualMap(amd::VirtualMapCommand& cmd) { ShouldNotReachHere(); }
+  virtual void submitCopyMemoryBatch(amd::CopyMemoryBatchCommand& cmd) { ShouldNotReachHere(); }
+  virtual void submitAccumulate(amd::AccumulateCommand& cmd) { ShouldNotReachHere(); }
+  //! Returns true if NDRangeKernelCommand can capture the AQL packets for submitAccumulate()
+  virtual bool packetCaptureSupported() const { return false; }
 
   virtual void profilerAttach(bool enable) = 0;
 
   virtual address allocKernelArguments(size_t size, size_t alignment) { return nullptr; }
 
+  //! Enables or disables batched submission. While enabled, the device can defer
+  //! the HW notification of the submitted work. Disabling publishes all deferred work
+  virtual void setBatchSubmission(bool enable) {}
+
+  //! Records a timestamp on the queue without a command. Returns a retained HW event,
+  //! which completes after all previous work, or nullptr if the device can't record it
+  virtual void* recordTimestamp(int32_t scope) { return nullptr; }
+
+  //! Makes the queue wait for a HW event, returned by recordTimestamp() on any queue
+  virtual bool waitHwTimestamp(void* hw_event) { return false; }
+
   //! Get the blit manager object
   device::BlitManager& blitMgr() const { return *blitMgr_; }
 
@@ -1256,12 +1284,28 @@ class VirtualDevice : public amd::HeapObject {
   //! Returns the virtual device unique index
   uint index() const { return index_; }
 
+  //! Returns the ID of the HW queue, shared by several virtual devices
+  virtual uint64_t hwQueueId() const { return index_; }
+
   //! Returns true if device has active wait setting
   bool ActiveWait() const;
 
   //! Returns the status of queue handler callback
   virtual bool isHandlerPending() const = 0;
 
+  //! Returns true if the device can wait for the HW event of another queue on GPU
+  virtual bool canWaitHwEvent() const { return false; }
+
+  //! State of the submitted work, as seen without any lock
+  enum class QueueState : uint32_t {
+    Unknown = 0,  //!< The caller must check the commands
+    Busy,         //!< The last submission is still running
+    Idle          //!< All submitted work is done
+  };
+
+  //! Returns the state of the submitted work with a single HW signal read
+  virtual QueueState queryState() const { return QueueState::Unknown; }
+
  private:
   //! Disable default copy constructor
   VirtualDevice& operator=(const VirtualDevice&);
@@ -1292,6 +1336,7 @@ class MemObjMap : public AllStatic {
   static void RemoveMemObj(const void* k);  //!< Remove an entry of mem object from the container
   static amd::Memory* FindMemObj(
       const void* k);  //!< find the mem object based on the input pointer
+  static uint64_t Generation();  //!< Changes on every removal of a mem object
   static void UpdateAccess(amd::Device *peerDev);
   static void Purge(amd::Device* dev); //!< Purge all user allocated memories on the given device
 
@@ -1301,10 +1346,26 @@ class MemObjMap : public AllStatic {
   static amd::Memory* FindVirtualMemObj(
       const void* k);  //!< Same as FindMemObj but for virtual addressing
  private:
-  static std::map<uintptr_t, amd::Memory*>
-      MemObjMap_;                      //!< the mem object<->hostptr information container
-  static std::map<uintptr_t, amd::Memory*>
-      VirtualMemObjMap_;               //!< the virtual mem object<->hostptr information container
+  struct Snapshot;  //!< Sorted copy of a container for the lookups without the lock
+
+  //! A container of mem objects with the lock-free lookup index
+  struct Container {
+    std::map<uintptr_t, amd::Memory*> map_;     //!< The mem objects, guarded by AllocatedLock_
+    std::atomic<Snapshot*> snapshot_{nullptr};  //!< Index of map_ or nullptr if it's stale
+    std::atomic<uint32_t> lockedLookups_{0};  //!< Locked lookups since the index became stale
+  };
+
+  //! Finds the mem object, which contains the address, and returns its start address
+  static amd::Memory* Find(Container& container, uintptr_t key, uintptr_t* start);
+  //! Drops the index after the container update. Requires AllocatedLock_
+  static void Invalidate(Container& container);
+
+  static Container MemObjMap_;         //!< the mem object<->hostptr information container
+  //! Single device mem objects per device, which may not have the peer access yet
+  static std::unordered_map<const amd::Device*, std::map<uintptr_t, amd::Memory*>> PeerPending_;
+  static Container VirtualMemObjMap_;  //!< the virtual mem object<->hostptr information container
+  static std::vector<std::pair<Snapshot*, uint64_t>>
+      Retired_;                        //!< Dropped snapshots with their retire epochs
   static amd::Monitor AllocatedLock_;  //!< amd monitor locker
 };
 
@@ -1573,6 +1634,18 @@ class Device : public RuntimeObject {
                 const std::string& extraKernel,  //!< Extra kernels from the device layer
                 const std::string& extraOptions  //!< Extra compilation options
     );
+
+   private:
+    //! Returns the cache file of the blit code object, empty if the cache is disabled
+    static std::string cacheFile(const Device* device, const std::string& kernels,
+                                 const std::string& options, std::string* key);
+
+    //! Builds the program from the code object in the cache file
+    bool loadCached(Device* device, const std::string& file, const std::string& key,
+                    const std::string& options);
+
+    //! Saves the code object of the built program into the cache file
+    void saveCached(Device* device, const std::string& file, const std::string& key) const;
   };
 
 #if defined(WITH_COMPILER_LIB)
@@ -1601,6 +1674,9 @@ class Device : public RuntimeObject {
   //! Register a device as available
   void registerDevice();
 
+  //! Returns the directory of the runtime disk cache, created on demand, empty if unavailable
+  static std::string cachePath();
+
   //! Initialize the device layer (enumerate known devices)
   static bool init();
 
@@ -1712,6 +1788,15 @@ class Device : public RuntimeObject {
     return true;
   }
 
+  //! Allows the peer access to all allocations in \a ptrs
+  virtual bool deviceAllowAccess(const std::vector<void*>& ptrs) const {
+    bool result = true;
+    for (auto ptr : ptrs) {
+      result &= deviceAllowAccess(ptr);
+    }
+    return result;
+  }
+
   virtual bool enableP2P(amd::Device* ptrDev) {
     ShouldNotCallThis();
     return true;
@@ -1791,6 +1876,10 @@ class Device : public RuntimeObject {
     return false;
   };
 
+  // Waits for the HW events of all events with a single host sleep. Returns false if
+  // the device can't wait on HW events or an event has no HW event
+  virtual bool WaitHwEvents(const std::vector<amd::Event*>& events) const { return false; }
+
   // Returns bool value if the device cache is equal to the parameter
   virtual bool IsCacheFlushed(CacheState state) const {
     return false;
@@ -1798,6 +1887,15 @@ class Device : public RuntimeObject {
 
   virtual void getHwEventTime(const amd::Event& event, uint64_t* start, uint64_t* end) const {};
 
+  // Returns the status of HW event, returned by VirtualDevice::recordTimestamp()
+  virtual bool IsHwTimestampReady(void* hw_event, bool wait = false) const { return false; }
+
+  // Returns the time of HW event, returned by VirtualDevice::recordTimestamp()
+  virtual void getHwTimestampTime(void* hw_event, uint64_t* start, uint64_t* end) const {}
+
+  // Releases the pinned host ranges that the device keeps between the transfers
+  virtual void ReleasePinnedRange(const void* hostPtr, size_t size) const {}
+
   virtual const uint32_t getPreferredNumaNode() const { return 0; }
   virtual void ReleaseGlobalSignal(void* signal) const {}
   virtual const bool isFineGrainSupported() const {
@@ -1895,6 +1993,33 @@ class Device : public RuntimeObject {
     return false;
   }
 
+  //! Returns the sums of the sampled counters of \a kernel, see ROC_COUNTER_SAMPLE_RATE
+  virtual bool getCounterSamples(const std::string& kernel, std::vector<uint64_t>* values,
+                                 uint64_t* samples) const {
+    return false;
+  }
+
+  //! Statistics of the HW queues
+  enum HwQueueStat : uint32_t {
+    HwQueueOccupancy = 0,  //!< Packets in flight at every submission
+    HwQueueSlotWait,       //!< Host waits in ns for a free slot of the full queue
+    HwQueueStartLatency,   //!< From the submission to the GPU start in ns
+    HwQueueStatCount
+  };
+
+  //! Returns the histogram of \a stat of the HW queue \a index, nullptr if there is no queue
+  virtual const LatencyHistogram* hwQueueStats(uint32_t index, HwQueueStat stat,
+                                               uint64_t* queueId) const {
+    return nullptr;
+  }
+
+  //! Captures a GPU trace of the next \a dispatches dispatches into \a fileName.
+  //! The capture starts on a dispatch of \a kernelName, unless it's empty
+  virtual bool captureTrace(uint32_t dispatches, const std::string& kernelName,
+                            const std::string& fileName) {
+    return false;
+  }
+
   //! Return context
   amd::Context& context() const { return *context_; }
 
@@ -1916,6 +2041,18 @@ class Device : public RuntimeObject {
   //! Sets the stack size of the device
   bool UpdateStackSize(uint64_t stackSize);
 
+  //! Returns the size of the pre-reserved heap for the device malloc, 0 if there is none
+  uint64_t MallocHeapSize() const { return malloc_heap_size_; }
+
+  //! Sets the size of the pre-reserved malloc heap, fails once the heap is reserved
+  bool UpdateMallocHeapSize(uint64_t heapSize);
+
+  //! Returns a chunk of the pre-reserved malloc heap, 0 if the heap can't fit \a size
+  uint64_t MallocHeapAlloc(size_t size);
+
+  //! Returns a chunk to the malloc heap, false if \a va doesn't belong to the heap
+  bool MallocHeapFree(uint64_t va);
+
   //! Does this device allow P2P access?
   bool P2PAccessAllowed() const { return (p2p_access_devices_.size() > 0) ? true : false; }
 
@@ -1925,6 +2062,15 @@ class Device : public RuntimeObject {
   //! Returns index of current device
   uint32_t index() const { return index_; }
 
+  //! Returns the latency histograms of the submission path
+  LatencyStats& latencyStats() { return latencyStats_; }
+
+  //! Returns the footprint of the allocations per category and tag
+  MemoryStats& memoryStats() const { return memoryStats_; }
+
+  //! Returns the CPU NUMA node for the queue threads, -1 if the threads aren't pinned
+  virtual int32_t queueNumaNode() const { return -1; }
+
   //! Returns value for LinkAttribute for lost of vectors
   virtual bool findLinkInfo(const amd::Device& other_device,
                             std::vector<LinkAttrType>* link_attr) {
@@ -1935,10 +2081,23 @@ class Device : public RuntimeObject {
   // Notifies device about context destroy
   virtual void ContextDestroy() {}
 
+  //! Host wait strategies for the GPU work completion
+  enum WaitMode : uint32_t {
+    WaitAuto = 0,  //!< A short active wait, then the blocked wait
+    WaitSpin,      //!< Active wait without a limit
+    WaitYield,     //!< Polls the completion and yields the CPU between the checks
+    WaitBlocking   //!< Interrupt based wait without an active wait
+  };
+
   //! Returns active wait state for this device
-  bool ActiveWait() const { return activeWait_; }
+  bool ActiveWait() const { return (waitMode_ == WaitSpin) || (waitMode_ == WaitYield); }
+
+  void SetActiveWait(bool state) { waitMode_ = state ? WaitSpin : WaitAuto; }
 
-  void SetActiveWait(bool state) { activeWait_ = state; }
+  //! Returns the host wait strategy of this device
+  WaitMode GetWaitMode() const { return static_cast<WaitMode>(waitMode_); }
+
+  void SetWaitMode(WaitMode mode) { waitMode_ = mode; }
 
   virtual amd::Memory* GetArenaMemObj(const void* ptr, size_t& offset, size_t size = 0) {
     return nullptr;
@@ -1957,7 +2116,7 @@ class Device : public RuntimeObject {
   union {
     struct {
       uint32_t online_: 1;        //!< The device in online
-      uint32_t activeWait_: 1;    //!< If true device requires active wait
+      uint32_t waitMode_: 2;      //!< WaitMode of the host waits
     };
     uint32_t  state_;             //!< State bit mask
   };
@@ -1977,6 +2136,12 @@ class Device : public RuntimeObject {
   amd::Memory* arena_mem_obj_;    //!< Arena memory object
   uint64_t stack_size_{0};        //!< Device stack size
 
+  amd::Monitor malloc_heap_lock_{"Device malloc heap"};  //!< Lock of the malloc heap state
+  amd::Memory* malloc_heap_{nullptr};        //!< Heap for the slabs of the device malloc
+  uint64_t malloc_heap_size_{0};             //!< Size of the pre-reserved malloc heap
+  std::map<uint64_t, size_t> malloc_heap_free_;  //!< Free ranges of the heap, keyed by VA
+  std::map<uint64_t, size_t> malloc_heap_used_;  //!< Allocated chunks of the heap
+
  private:
   const Isa *isa_;                //!< Device isa
   bool IsTypeMatching(cl_device_type type, bool offlineDevices);
@@ -1990,6 +2155,8 @@ class Device : public RuntimeObject {
   Monitor* vaCacheAccess_;                            //!< Lock to serialize VA caching access
   std::map<uintptr_t, device::Memory*>* vaCacheMap_;  //!< VA cache map
   uint32_t index_;  //!< Unique device index
+  LatencyStats latencyStats_;  //!< Latency histograms of the submission path
+  mutable MemoryStats memoryStats_;  //!< Footprint of the allocations
 };
 
 /*! @}
@@ -665,6 +665,82 @@ std::string Kernel::openclMangledName(const std::string& name) {
 }
 #endif
 
+// ================================================================================================
+size_t Kernel::maxWavesPerCU() const {
+  const amd::Isa& isa = device().isa();
+  // Limited by SPI 32 per CU, hence 8 per SIMD
+  const size_t maxWavesPerSimd = (isa.versionMajor() <= 9) ? 8 : 16;
+
+  size_t maxVGPRs;
+  uint32_t vgprGranularity;
+  if (isa.versionMajor() <= 9) {
+    if (isa.versionMajor() == 9 && isa.versionMinor() == 0 && isa.versionStepping() == 10) {
+      maxVGPRs = 512;
+      vgprGranularity = 8;
+    } else {
+      maxVGPRs = 256;
+      vgprGranularity = 4;
+    }
+  } else {
+    maxVGPRs = 1024;
+    vgprGranularity = 8;
+  }
+  size_t gprWaves = maxWavesPerSimd;
+  if (workGroupInfo()->usedVGPRs_ > 0) {
+    gprWaves = maxVGPRs / amd::alignUp(workGroupInfo()->usedVGPRs_, vgprGranularity);
+  }
+  if (workGroupInfo()->usedSGPRs_ > 0) {
+    size_t maxSGPRs;
+    if (isa.versionMajor() < 8) {
+      maxSGPRs = 512;
+    } else if (isa.versionMajor() < 10) {
+      maxSGPRs = 800;
+    } else {
+      maxSGPRs = SIZE_MAX;  // gfx10+ does not share SGPRs between waves
+    }
+    gprWaves = std::min(gprWaves, maxSGPRs / amd::alignUp(workGroupInfo()->usedSGPRs_, 16));
+  }
+  return device().info().simdPerCU_ * std::min(maxWavesPerSimd, gprWaves);
+}
+
+// ================================================================================================
+size_t Kernel::ldsGroupsPerCU(size_t dynamicLds) const {
+  const size_t usedLds = workGroupInfo()->usedLDSSize_ + dynamicLds;
+  return (usedLds != 0) ? device().info().localMemSize_ / usedLds : SIZE_MAX;
+}
+
+// ================================================================================================
+size_t Kernel::occupancyGroupSize(size_t numThreads, size_t maxSize) const {
+  const size_t waveSize = workGroupInfo()->wavefrontSize_;
+  const size_t numCUs = device().info().maxComputeUnits_;
+  const size_t wavesPerCU = maxWavesPerCU();
+  const size_t ldsGroups = ldsGroupsPerCU();
+
+  // The candidates are the power of 2 multiples of a wave, which keep the split of the global
+  // size below efficient, and the kernel limit itself. The score is the number of the resident
+  // waves on the whole device and then the number of the busy CUs, a larger group wins a tie.
+  size_t bestSize = maxSize;
+  size_t bestWaves = 0;
+  size_t bestCUs = 0;
+  auto score = [&](size_t size) {
+    const size_t wavesPerGroup = amd::alignUp(size, waveSize) / waveSize;
+    const size_t groupsPerCU = std::min(wavesPerCU / wavesPerGroup, ldsGroups);
+    const size_t numGroups = (numThreads + size - 1) / size;
+    const size_t residentWaves = std::min(numGroups, groupsPerCU * numCUs) * wavesPerGroup;
+    const size_t busyCUs = (groupsPerCU != 0) ? std::min(numGroups, numCUs) : 0;
+    if ((residentWaves > bestWaves) || ((residentWaves == bestWaves) && (busyCUs >= bestCUs))) {
+      bestSize = size;
+      bestWaves = residentWaves;
+      bestCUs = busyCUs;
+    }
+  };
+  for (size_t size = waveSize; size < maxSize; size *= 2) {
+    score(size);
+  }
+  score(maxSize);
+  return bestSize;
+}
+
 // ================================================================================================
 void Kernel::FindLocalWorkSize(size_t workDim, const amd::NDRange& gblWorkSize,
   amd::NDRange& lclWorkSize) const {
@@ -697,6 +773,9 @@ void Kernel::FindLocalWorkSize(size_t workDim, const amd::NDRange& gblWorkSize,
           }
         }
         else {
+          if (GPU_OCCUPANCY_LOCAL_SIZE) {
+            thrPerGrp = occupancyGroupSize(gblWorkSize.product(), thrPerGrp);
+          }
           size_t tmp = thrPerGrp;
           // Split the local workgroup into the most efficient way
           for (uint d = 0; d < workDim; ++d) {
@@ -491,6 +491,15 @@ class Kernel : public amd::HeapObject {
     amd::NDRange& lclWorkSize         //!< Calculated local work size
   ) const;
 
+  //! Returns the resident waves per CU, limited by the GPR usage
+  size_t maxWavesPerCU() const;
+
+  //! Returns the resident workgroups per CU, limited by the LDS usage
+  size_t ldsGroupsPerCU(size_t dynamicLds = 0) const;
+
+  //! Returns the workgroup size up to \a maxSize with the best occupancy for \a numThreads
+  size_t occupancyGroupSize(size_t numThreads, size_t maxSize) const;
+
   const uint64_t KernelCodeHandle() const { return kernelCodeHandle_; }
 
   const uint32_t WorkgroupGroupSegmentByteSize() const { return workgroupGroupSegmentByteSize_; }
@@ -0,0 +1,99 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "device/devmemranges.hpp"
+
+#include <iterator>
+
+namespace device {
+
+// ================================================================================================
+MemoryRanges::RangeMap::const_iterator MemoryRanges::first(uint64_t address) const {
+  auto it = ranges_.upper_bound(address);
+  if (it != ranges_.begin()) {
+    auto prev = std::prev(it);
+    if (prev->second.end_ > address) {
+      return prev;
+    }
+  }
+  return it;
+}
+
+// ================================================================================================
+bool MemoryRanges::conflict(uint64_t start, uint64_t end, bool readOnly) const {
+  for (auto it = first(start); (it != ranges_.end()) && (it->first < end); ++it) {
+    // If the busy region was written or the current one is for write
+    if (!it->second.readOnly_ || !readOnly) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// ================================================================================================
+void MemoryRanges::split(uint64_t address) {
+  auto it = ranges_.upper_bound(address);
+  if (it == ranges_.begin()) {
+    return;
+  }
+  --it;
+  if ((it->first < address) && (it->second.end_ > address)) {
+    Range tail = {it->second.end_, it->second.readOnly_};
+    it->second.end_ = address;
+    ranges_.emplace_hint(std::next(it), address, tail);
+  }
+}
+
+// ================================================================================================
+void MemoryRanges::insert(uint64_t start, uint64_t end, bool readOnly) {
+  if (start >= end) {
+    return;
+  }
+  // Align the existing ranges with the new one, so they are either inside or outside of it
+  split(start);
+  split(end);
+
+  auto it = ranges_.lower_bound(start);
+  if (!readOnly) {
+    // A write makes the whole region written, hence a single range replaces the covered ones
+    while ((it != ranges_.end()) && (it->first < end)) {
+      it = ranges_.erase(it);
+    }
+    ranges_.emplace_hint(it, start, Range{end, false});
+    return;
+  }
+
+  // Fill the gaps with read-only ranges and keep the state of the busy ones
+  uint64_t pos = start;
+  while (pos < end) {
+    const bool inside = (it != ranges_.end()) && (it->first < end);
+    const uint64_t gapEnd = inside ? it->first : end;
+    if (pos < gapEnd) {
+      ranges_.emplace_hint(it, pos, Range{gapEnd, true});
+    }
+    if (!inside) {
+      break;
+    }
+    pos = it->second.end_;
+    ++it;
+  }
+}
+
+}  // namespace device
@@ -0,0 +1,65 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include "top.hpp"
+
+#include <map>
+
+namespace device {
+
+/*! \brief Busy memory ranges of a queue with their read/write state
+ *
+ *  The ranges never overlap, so an overlap check is a map lookup plus a walk over
+ *  the ranges inside the checked one. The same buffer used by many kernels keeps
+ *  a single entry.
+ */
+class MemoryRanges : public amd::EmbeddedObject {
+ public:
+  //! Returns true if [start, end) overlaps a written range, or any range if \a readOnly is false
+  bool conflict(uint64_t start, uint64_t end, bool readOnly) const;
+
+  //! Marks [start, end) busy, a write turns the covered ranges into written ones
+  void insert(uint64_t start, uint64_t end, bool readOnly);
+
+  //! Number of the disjoint ranges
+  size_t size() const { return ranges_.size(); }
+
+  //! Removes all ranges
+  void clear() { ranges_.clear(); }
+
+ private:
+  struct Range {
+    uint64_t end_;    //!< Busy memory end address
+    bool readOnly_;   //!< Current GPU state in the queue
+  };
+  typedef std::map<uint64_t, Range> RangeMap;
+
+  //! Splits the range, which contains \a address, at \a address
+  void split(uint64_t address);
+
+  //! Returns the first range, which ends after \a address
+  RangeMap::const_iterator first(uint64_t address) const;
+
+  RangeMap ranges_;  //!< The busy ranges, keyed by the start address
+};
+
+}  // namespace device
@@ -27,11 +27,13 @@
 #include "devkernel.hpp"
 #include "utils/macros.hpp"
 #include "utils/options.hpp"
+#include "utils/versions.hpp"
 #if defined(WITH_COMPILER_LIB)
 #include "utils/bif_section_labels.hpp"
 #include "utils/libUtils.h"
 #endif
 #include "comgrctx.hpp"
+#include "devcodecache.hpp"
 
 #include <algorithm>
 #include <atomic>
@@ -39,6 +41,7 @@
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <mutex>
 #include <string>
 #include <sstream>
 #include <cstdio>
@@ -127,6 +130,19 @@ void Program::clear() {
   kernels_.clear();
 }
 
+// ================================================================================================
+Kernel* Program::getKernel(const std::string& name) {
+  amd::ScopedLock sl(kernelsLock_);
+  auto it = kernels_.find(name);
+  if (it == kernels_.end()) {
+    return nullptr;
+  }
+  if (it->second == nullptr) {
+    it->second = createKernel(name);
+  }
+  return it->second;
+}
+
 // ================================================================================================
 bool Program::compileImpl(const std::string& sourceCode,
                           const std::vector<const std::string*>& headers,
@@ -343,6 +359,102 @@ amd_comgr_status_t Program::createAction(const amd_comgr_language_t oclver,
   return status;
 }
 
+// The device libraries of the last links, keyed by the ISA, the language and the link options.
+// Comgr extracts the libraries from its embedded archive on every add, which is the dominant
+// cost of small builds. The data objects are reference counted, so many sets can share them
+static amd::Monitor devLibCacheLock_("Device library cache lock");
+static std::unordered_map<std::string, std::vector<amd_comgr_data_t>> devLibCache_;
+
+static std::string devLibCacheKey(const std::string& isaName, amd_comgr_language_t langver,
+                                  const std::vector<std::string>& options) {
+  std::string key = isaName + '\0' + std::to_string(langver);
+  for (const auto& option : options) {
+    key += '\0' + option;
+  }
+  return key;
+}
+
+// Collects the BC data objects of a data set, the returned objects must be released
+static amd_comgr_status_t getDataSetBc(const amd_comgr_data_set_t set,
+                                       std::vector<amd_comgr_data_t>* data) {
+  size_t count = 0;
+  amd_comgr_status_t status = amd::Comgr::action_data_count(set, AMD_COMGR_DATA_KIND_BC, &count);
+  for (size_t i = 0; (status == AMD_COMGR_STATUS_SUCCESS) && (i < count); ++i) {
+    amd_comgr_data_t item;
+    status = amd::Comgr::action_data_get_data(set, AMD_COMGR_DATA_KIND_BC, i, &item);
+    if (status == AMD_COMGR_STATUS_SUCCESS) {
+      data->push_back(item);
+    }
+  }
+  return status;
+}
+
+amd_comgr_status_t Program::addDeviceLibraries(const amd_comgr_action_info_t action,
+                                               amd_comgr_language_t langver,
+                                               const std::vector<std::string>& options,
+                                               const amd_comgr_data_set_t inputs,
+                                               amd_comgr_data_set_t output) {
+  const std::string key = devLibCacheKey(device().isa().isaName(), langver, options);
+  std::vector<amd_comgr_data_t> inputData;
+  amd_comgr_status_t status = getDataSetBc(inputs, &inputData);
+
+  {
+    amd::ScopedLock lock(devLibCacheLock_);
+    auto it = devLibCache_.find(key);
+    if ((status == AMD_COMGR_STATUS_SUCCESS) && (it != devLibCache_.end())) {
+      for (const auto& data : inputData) {
+        if (status == AMD_COMGR_STATUS_SUCCESS) {
+          status = amd::Comgr::data_set_add(output, data);
+        }
+      }
+      for (const auto& data : it->second) {
+        if (status == AMD_COMGR_STATUS_SUCCESS) {
+          status = amd::Comgr::data_set_add(output, data);
+        }
+      }
+      for (const auto& data : inputData) {
+        amd::Comgr::release_data(data);
+      }
+      return status;
+    }
+  }
+
+  if (status == AMD_COMGR_STATUS_SUCCESS) {
+    status = amd::Comgr::do_action(AMD_COMGR_ACTION_ADD_DEVICE_LIBRARIES, action, inputs, output);
+    extractBuildLog(output);
+  }
+
+  // The output has the input objects and the libraries. Keep the libraries for the next links
+  std::vector<amd_comgr_data_t> outputData;
+  if (status == AMD_COMGR_STATUS_SUCCESS) {
+    status = getDataSetBc(output, &outputData);
+  }
+  std::vector<amd_comgr_data_t> devLibs;
+  for (const auto& data : outputData) {
+    const bool isInput = std::any_of(inputData.begin(), inputData.end(),
+        [&data](const amd_comgr_data_t& input) { return input.handle == data.handle; });
+    if (isInput || (status != AMD_COMGR_STATUS_SUCCESS)) {
+      amd::Comgr::release_data(data);
+    } else {
+      devLibs.push_back(data);
+    }
+  }
+  for (const auto& data : inputData) {
+    amd::Comgr::release_data(data);
+  }
+
+  if (!devLibs.empty()) {
+    amd::ScopedLock lock(devLibCacheLock_);
+    if (!devLibCache_.emplace(key, devLibs).second) {
+      // Another build added the same libraries
+      for (const auto& data : devLibs) {
+        amd::Comgr::release_data(data);
+      }
+    }
+  }
+  return status;
+}
+
 bool Program::linkLLVMBitcode(const amd_comgr_data_set_t inputs,
                               const std::vector<std::string>& options, const bool requiredDump,
                               amd::option::Options* amdOptions, amd_comgr_data_set_t* output,
@@ -371,9 +483,7 @@ bool Program::linkLLVMBitcode(const amd_comgr_data_set_t inputs,
 
     if (status == AMD_COMGR_STATUS_SUCCESS) {
       hasDataSetDevLibs = true;
-      status = amd::Comgr::do_action(AMD_COMGR_ACTION_ADD_DEVICE_LIBRARIES, action, inputs,
-                                    dataSetDevLibs);
-      extractBuildLog(dataSetDevLibs);
+      status = addDeviceLibraries(action, langver, options, inputs, dataSetDevLibs);
     }
   }
 
@@ -1807,9 +1917,15 @@ int32_t Program::build(const std::string& sourceCode, const char* origOptions,
     headers.push_back(&tmpHeaders[i]);
     headerIncludeNames.push_back(tmpHeaderNames[i].c_str());
   }
+  // Look for the executable of a previous build with the same source, options and device
+  std::string cacheKey;
+  const std::string cacheFile = (buildStatus_ == CL_BUILD_IN_PROGRESS) ?
+      codeCacheFile(sourceCode, preCompiledHeaders, options, &cacheKey) : std::string();
+  const bool cached = !cacheFile.empty() && loadCodeCache(cacheFile, cacheKey, options);
+
   // Compile the source code if any
   bool compileStatus = true;
-  if ((buildStatus_ == CL_BUILD_IN_PROGRESS) && !sourceCode.empty()) {
+  if ((buildStatus_ == CL_BUILD_IN_PROGRESS) && !cached && !sourceCode.empty()) {
     if (!headerIncludeNames.empty()) {
       compileStatus =
           compileImpl(sourceCode, headers, &headerIncludeNames[0], options, preCompiledHeaders);
@@ -1823,7 +1939,7 @@ int32_t Program::build(const std::string& sourceCode, const char* origOptions,
       buildLog_ = "Internal error: Compilation failed.";
     }
   }
-  if ((buildStatus_ == CL_BUILD_IN_PROGRESS) && !linkImpl(options)) {
+  if ((buildStatus_ == CL_BUILD_IN_PROGRESS) && !cached && !linkImpl(options)) {
     buildStatus_ = CL_BUILD_ERROR;
     if (buildLog_.empty()) {
       buildLog_ += "Internal error: Link failed.\n";
@@ -1831,6 +1947,10 @@ int32_t Program::build(const std::string& sourceCode, const char* origOptions,
     }
   }
 
+  if ((buildStatus_ == CL_BUILD_IN_PROGRESS) && !cached && !cacheFile.empty()) {
+    saveCodeCache(cacheFile, cacheKey);
+  }
+
   if (!finiBuild(buildStatus_ == CL_BUILD_IN_PROGRESS)) {
     buildStatus_ = CL_BUILD_ERROR;
     if (buildLog_.empty()) {
@@ -1875,6 +1995,91 @@ int32_t Program::build(const std::string& sourceCode, const char* origOptions,
   return buildError();
 }
 
+// ================================================================================================
+static constexpr const char* kCodeCachePrefix = "prog_";
+
+std::string Program::codeCacheFile(const std::string& sourceCode,
+                                   const std::vector<std::string>& preCompiledHeaders,
+                                   amd::option::Options* options, std::string* key) const {
+  // The cache holds the LC executables of the source builds. The internal kernels have
+  // their own cache and the dumps need the full compilation
+  if (!OCL_CODE_CACHE_ENABLE || !device().settings().useLightning_ || sourceCode.empty() ||
+      (compileOptions_.find("-cl-internal-kernel") != std::string::npos) ||
+      (options->oVariables->DumpFlags > 0) || GPU_DUMP_CODE_OBJECT) {
+    return std::string();
+  }
+
+  static std::once_flag resetOnce;
+  std::call_once(resetOnce, []() {
+    if (OCL_CODE_CACHE_RESET) {
+      amd::CodeCache::reset(kCodeCachePrefix);
+    }
+  });
+
+  size_t comgrMajor = 0;
+  size_t comgrMinor = 0;
+#if defined(USE_COMGR_LIBRARY)
+  amd::Comgr::get_version(&comgrMajor, &comgrMinor);
+#endif  // defined(USE_COMGR_LIBRARY)
+
+  // The key has everything that changes the executable: the device, the compiler versions,
+  // the options and the hashes of the source and headers
+  std::hash<std::string> hash;
+  std::stringstream stream;
+  stream << device().isa().targetId() << ";" << AMD_BUILD_STRING << ";comgr " << comgrMajor
+         << "." << comgrMinor << ";" << options->origOptionStr << ";" << options->llvmOptions
+         << ";";
+  for (const auto& option : options->clangOptions) {
+    stream << option << " ";
+  }
+  stream << ";co" << options->oVariables->LCCodeObjectVersion << ";"
+         << device().settings().lcWavefrontSize64_ << device().settings().enableWgpMode_
+         << AMD_GPU_FORCE_SINGLE_FP_DENORM << ";" << std::hex << sourceCode.size() << ":"
+         << hash(sourceCode);
+  const std::vector<std::string>& headerNames = owner()->headerNames();
+  const std::vector<std::string>& headers = owner()->headers();
+  for (size_t i = 0; i < headers.size(); ++i) {
+    stream << ";" << headerNames[i] << ":" << hash(headers[i]);
+  }
+  for (const auto& header : preCompiledHeaders) {
+    stream << ";pch:" << hash(header);
+  }
+  *key = stream.str();
+
+  return amd::CodeCache::file(std::string(kCodeCachePrefix) + device().isa().targetId(), *key);
+}
+
+// ================================================================================================
+bool Program::loadCodeCache(const std::string& file, const std::string& key,
+                            amd::option::Options* options) {
+  std::vector<char> image;
+  if (!amd::CodeCache::load(file, key, &image)) {
+    return false;
+  }
+
+  internal_ = false;
+  clBinary()->saveBIFBinary(image.data(), image.size());
+  if (!createKernels(const_cast<void*>(clBinary()->data().first), clBinary()->data().second,
+                     options->oVariables->UniformWorkGroupSize, internal_)) {
+    // The cache is broken, rebuild the program from the source
+    LogPrintfWarning("Code cache %s is invalid", file.c_str());
+    buildLog_.clear();
+    return false;
+  }
+  setType(TYPE_EXECUTABLE);
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "Loaded the program executable from %s", file.c_str());
+  return true;
+}
+
+// ================================================================================================
+void Program::saveCodeCache(const std::string& file, const std::string& key) const {
+  if (type() != TYPE_EXECUTABLE) {
+    return;
+  }
+  amd::CodeCache::save(file, key, clBinary()->data().first, clBinary()->data().second);
+  amd::CodeCache::trim(kCodeCachePrefix, static_cast<uint64_t>(OCL_CODE_CACHE_SIZE) * Mi);
+}
+
 // ================================================================================================
 bool Program::loadHSAIL() {
 #if  defined(WITH_COMPILER_LIB)
@@ -2197,6 +2402,22 @@ bool Program::setBinary(const char* binaryIn, size_t size, const device::Program
     return false;
   }
 
+  // HIP code objects are mapped from the files or stay in the application memory. Their ELF
+  // header has all the runtime needs, hence skip the input ELF object, which copies all sections
+  if (amd::IS_HIP && isLC() && (clBinary()->data().second >= sizeof(Elf64_Ehdr))) {
+    Elf64_Ehdr ehdr;
+    ::memcpy(&ehdr, clBinary()->data().first, sizeof(ehdr));
+    if ((ehdr.e_ident[EI_CLASS] == ELFCLASS64) && (ehdr.e_machine == EM_AMDGPU) &&
+        ((ehdr.e_type == ET_DYN) || (ehdr.e_type == ET_EXEC))) {
+      setType(TYPE_EXECUTABLE);
+      if (same_dev_prog != nullptr) {
+        compileOptions_ = same_dev_prog->compileOptions();
+        linkOptions_ = same_dev_prog->linkOptions();
+      }
+      return true;
+    }
+  }
+
   if (!clBinary()->setElfIn()) {
     LogError("Setting input OCL binary failed");
     return false;
@@ -2757,32 +2978,29 @@ bool Program::FindGlobalVarSize(void* binary, size_t binSize) {
     size_t dynamicSize = 0;
     size_t progvarsWriteSize = 0;
 
-    amd::Elf elfIn(ELFCLASSNONE, reinterpret_cast<const char *>(binary), binSize,
-                      nullptr, amd::Elf::ELF_C_READ);
+    // Only the program headers are needed, hence avoid the copy of the whole code object
+    amd::ElfView elfIn(reinterpret_cast<const char *>(binary), binSize);
 
-    if (!elfIn.isSuccessful()) {
-      buildLog_ += "Creating input amd::Elf object failed\n";
+    if (!elfIn.isValid()) {
+      buildLog_ += "Creating input amd::ElfView object failed\n";
       return false;
     }
 
-    auto numpHdrs = elfIn.getSegmentNum();
+    auto numpHdrs = elfIn.segmentNum();
     for (unsigned int i = 0; i < numpHdrs; ++i) {
-      amd::ELFIO::segment* seg = nullptr;
-      if (!elfIn.getSegment(i, seg)) {
-        continue;
-      }
+      const amd::ElfView::Segment* seg = elfIn.segment(i);
 
       // Accumulate the size of R & !X loadable segments
-      if (seg->get_type() == PT_LOAD && !(seg->get_flags() & PF_X)) {
-        if (seg->get_flags() & PF_R) {
-          progvarsTotalSize += seg->get_memory_size();
+      if (seg->type_ == PT_LOAD && !(seg->flags_ & PF_X)) {
+        if (seg->flags_ & PF_R) {
+          progvarsTotalSize += seg->memSize_;
         }
-        if (seg->get_flags() & PF_W) {
-          progvarsWriteSize += seg->get_memory_size();
+        if (seg->flags_ & PF_W) {
+          progvarsWriteSize += seg->memSize_;
         }
       }
-      else if (seg->get_type() == PT_DYNAMIC) {
-        dynamicSize += seg->get_memory_size();
+      else if (seg->type_ == PT_DYNAMIC) {
+        dynamicSize += seg->memSize_;
       }
     }
 
@@ -2977,6 +3195,10 @@ bool Program::runInitFiniKernel(kernel_kind_t kind) const {
   for (const auto& i : kernels_) {
     LogPrintfInfo("For Init/Fini: Kernel Name: %s", i.first.c_str());
     const auto &kernel = i.second;
+    // The lazy kernels are never the init or fini kernels
+    if (kernel == nullptr) {
+      continue;
+    }
     if ((kernel->isInitKernel() && kind == kernel_kind_t::InitKernel) ||
         (kernel->isFiniKernel() && kind == kernel_kind_t::FiniKernel)) {
       amd::ScopedLock sl(initFiniLock_);
@@ -114,6 +114,7 @@ class Program : public amd::HeapObject {
   amd::Program& owner_; //!< owner of this program
 
   kernels_t kernels_; //!< The kernel entry points this binary.
+  amd::Monitor kernelsLock_{"Program kernels lock"};  //!< Serializes the kernel creation
   type_t type_;       //!< type of this program
 
   typedef enum { InitKernel = 0, FiniKernel } kernel_kind_t;  //!< Kernel kind
@@ -216,10 +217,13 @@ class Program : public amd::HeapObject {
   //! Return the build error.
   int32_t buildError() const { return buildError_; }
 
-  //! Return the symbols vector.
+  //! Return the symbols vector. The kernels of a lazy program can be NULL before the first lookup
   const kernels_t& kernels() const { return kernels_; }
   kernels_t& kernels() { return kernels_; }
 
+  //! Returns the kernel \a name, creates the kernel object on the first lookup if it's NULL
+  Kernel* getKernel(const std::string& name);
+
   //! Return the binary image.
   inline const binary_t binary() const;
   inline binary_t binary();
@@ -348,6 +352,9 @@ class Program : public amd::HeapObject {
   virtual bool createKernels(void* binary, size_t binSize, bool useUniformWorkGroupSize,
                              bool internalKernel) { return true; }
 
+  //! Creates the kernel \a name, which createKernels() left as a name only entry
+  virtual device::Kernel* createKernel(const std::string& name) { return nullptr; }
+
   virtual bool setKernels(
     void* binary, size_t binSize,
     amd::Os::FileDesc fdesc = amd::Os::FDescInit(), size_t foffset = 0,
@@ -418,6 +425,18 @@ class Program : public amd::HeapObject {
   //! Link the device program with LC path
   bool linkImplLC(amd::option::Options* options);
 
+  //! Returns the code cache file of the build, empty if the build can't be cached
+  std::string codeCacheFile(const std::string& sourceCode,
+    const std::vector<std::string>& preCompiledHeaders, amd::option::Options* options,
+    std::string* key) const;
+
+  //! Creates the kernels from the cached executable, returns false on a cache miss
+  bool loadCodeCache(const std::string& file, const std::string& key,
+    amd::option::Options* options);
+
+  //! Saves the executable of the build into the code cache
+  void saveCodeCache(const std::string& file, const std::string& key) const;
+
   //! Link the device program with HSAIL path
   bool linkImplHSAIL(amd::option::Options* options);
 
@@ -452,6 +471,11 @@ class Program : public amd::HeapObject {
     const std::vector<std::string>& options, amd_comgr_action_info_t* action,
     bool* hasAction);
 
+  //! Add the inputs and the device libraries to the output, the libraries come from a cache
+  amd_comgr_status_t addDeviceLibraries(const amd_comgr_action_info_t action,
+    amd_comgr_language_t langver, const std::vector<std::string>& options,
+    const amd_comgr_data_set_t inputs, amd_comgr_data_set_t output);
+
   //! Create the bitcode of the linked input dataset
   bool linkLLVMBitcode(const amd_comgr_data_set_t inputs,
     const std::vector<std::string>& options, const bool requiredDump,
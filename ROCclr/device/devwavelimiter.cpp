@@ -98,6 +98,20 @@ WLAlgorithmSmooth::WLAlgorithmSmooth(WaveLimiterManager* manager, uint seqNum, b
   runSampleCnt_.resize(MaxWave + 1);
 
   clearData();
+  seed();
+}
+
+// ================================================================================================
+void WLAlgorithmSmooth::seed() {
+  uint waves = 0;
+  if (!enable_ || !WaveLimitCache::instance().find(manager_->target(), manager_->name(), &waves) ||
+      (waves > MaxWave)) {
+    return;
+  }
+  // Skip the warmup and the first adaptation, the later adaptations still track the changes
+  bestWave_ = waves;
+  waves_ = waves;
+  state_ = RUN;
 }
 
 // ================================================================================================
@@ -216,6 +230,7 @@ void WLAlgorithmSmooth::callback(ulong duration, uint32_t waves) {
           }
           state_ = RUN;
           outputTrace();
+          WaveLimitCache::instance().store(manager_->target(), manager_->name(), bestWave_);
           // Start to collect the new data for the best wave
           countAll_ = 0;
           runMeasure_[bestWave_] = 0;
@@ -270,6 +285,59 @@ void WaveLimiter::DataDumper::addData(ulong time, uint wave, char state) {
   state_.push_back(state);
 }
 
+// ================================================================================================
+WaveLimitCache::WaveLimitCache() : dirty_(false), monitor_("Wave limit cache lock") {
+  if (flagIsDefault(GPU_WAVE_LIMIT_CACHE)) {
+    return;
+  }
+  // Every line is "<target> <kernel> <waves per SIMD>"
+  std::ifstream IFS(GPU_WAVE_LIMIT_CACHE);
+  std::string target;
+  std::string kernel;
+  uint waves;
+  while (IFS >> target >> kernel >> waves) {
+    waves_[key(target, kernel)] = waves;
+  }
+}
+
+// ================================================================================================
+WaveLimitCache::~WaveLimitCache() {
+  if (!dirty_ || flagIsDefault(GPU_WAVE_LIMIT_CACHE)) {
+    return;
+  }
+  std::ofstream OFS(GPU_WAVE_LIMIT_CACHE);
+  for (const auto& it : waves_) {
+    OFS << it.first << ' ' << it.second << '\n';
+  }
+  OFS.close();
+}
+
+// ================================================================================================
+WaveLimitCache& WaveLimitCache::instance() {
+  static WaveLimitCache cache;
+  return cache;
+}
+
+// ================================================================================================
+bool WaveLimitCache::find(const std::string& target, const std::string& kernel,
+                          uint* waves) const {
+  amd::ScopedLock SL(monitor_);
+  auto loc = waves_.find(key(target, kernel));
+  if (loc == waves_.end()) {
+    return false;
+  }
+  *waves = loc->second;
+  return true;
+}
+
+// ================================================================================================
+void WaveLimitCache::store(const std::string& target, const std::string& kernel, uint waves) {
+  amd::ScopedLock SL(monitor_);
+  uint& value = waves_[key(target, kernel)];
+  dirty_ |= (value != waves);
+  value = waves;
+}
+
 // ================================================================================================
 WaveLimiterManager::WaveLimiterManager(device::Kernel* kernel, const uint simdPerSH)
     : owner_(kernel), enable_(false), enableDump_(!flagIsDefault(GPU_WAVE_LIMIT_DUMP)) {
@@ -287,6 +355,9 @@ WaveLimiterManager::~WaveLimiterManager() {
 // ================================================================================================
 const std::string& WaveLimiterManager::name() const { return owner_->name(); }
 
+// ================================================================================================
+const char* WaveLimiterManager::target() const { return owner_->device().isa().targetId(); }
+
 // ================================================================================================
 uint WaveLimiterManager::getWavesPerSH(const device::VirtualDevice* vdev) const {
   if (fixed_ > 0) {
@@ -342,6 +413,13 @@ void WaveLimiterManager::enable(bool isSupported) {
       fixed_ = owner_->workGroupInfo()->wavesPerSimdHint_ * getSimdPerSH();
     }
   }
+
+  // Without the adaptation run with the waves learned by the previous runs or seeded by the app
+  uint waves = 0;
+  if (!enable_ && (fixed_ == 0) && WaveLimitCache::instance().find(target(), name(), &waves) &&
+      (waves <= GPU_WAVE_LIMIT_MAX_WAVE)) {
+    fixed_ = waves * getSimdPerSH();
+  }
 }
 
 }  // namespace pal
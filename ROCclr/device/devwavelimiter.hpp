@@ -126,6 +126,9 @@ class WLAlgorithmSmooth : public WaveLimiter {
   uint dynRunCount_;
   uint dataCount_;
 
+  //! Starts from the best waves of the previous runs, if the cache has it
+  void seed();
+
   //! Update measurement data and optimal waves/simd with execution time.
   void updateData(ulong time);
 
@@ -139,6 +142,39 @@ class WLAlgorithmSmooth : public WaveLimiter {
   void outputTrace() override;
 };
 
+/*! \brief Process-wide cache of the best waves per SIMD of the kernels
+ *
+ *  The entries are keyed by the device target and the kernel name. The results of the
+ *  adaptation are saved into GPU_WAVE_LIMIT_CACHE at exit and loaded by the next process,
+ *  so the wave limiter starts from the learned value.
+ */
+class WaveLimitCache {
+ public:
+  //! Returns the cache, loads GPU_WAVE_LIMIT_CACHE on the first use
+  static WaveLimitCache& instance();
+
+  //! Saves the cache file if it has new entries
+  ~WaveLimitCache();
+
+  //! Finds the waves per SIMD of \a kernel on \a target
+  bool find(const std::string& target, const std::string& kernel, uint* waves) const;
+
+  //! Updates the waves per SIMD of \a kernel on \a target
+  void store(const std::string& target, const std::string& kernel, uint waves);
+
+ private:
+  WaveLimitCache();
+
+  //! Returns the map key of the kernel
+  static std::string key(const std::string& target, const std::string& kernel) {
+    return target + ' ' + kernel;
+  }
+
+  std::unordered_map<std::string, uint> waves_;  //!< Best waves per SIMD by the kernel key
+  bool dirty_;                                   //!< The cache has unsaved entries
+  mutable amd::Monitor monitor_;                 //!< Protects the map
+};
+
 // Create wave limiter for each virtual device for a kernel and manages the wave limiters.
 class WaveLimiterManager {
  public:
@@ -157,6 +193,9 @@ class WaveLimiterManager {
   //! Returns the kernel name
   const std::string& name() const;
 
+  //! Returns the target of the device, the key of the wave limit cache
+  const char* target() const;
+
   //! Get SimdPerSH.
   uint getSimdPerSH() const { return simdPerSH_; }
 
@@ -28,11 +28,14 @@ namespace pal {
 // ================================================================================================
 ManagedBuffer::ManagedBuffer(VirtualGPU& gpu, uint32_t size)
     : gpu_(gpu),
-      pool_(MaxNumberOfBuffers),
+      pool_(MinNumberOfBuffers),
       activeBuffer_(0),
       size_(size),
       wrtOffset_(0),
-      wrtAddress_(nullptr) {}
+      wrtAddress_(nullptr),
+      type_(Resource::Empty),
+      idleWraps_(0),
+      wrapStalls_(0) {}
 
 // ================================================================================================
 void ManagedBuffer::release() {
@@ -42,33 +45,108 @@ void ManagedBuffer::release() {
     }
     delete it.buf;
   }
+  pool_.clear();
+  if (wrapStalls_ != 0) {
+    ClPrint(amd::LOG_INFO, amd::LOG_RESOURCE, "Managed buffer stalled on %llu wraps",
+            wrapStalls_);
+  }
+}
+
+// ================================================================================================
+bool ManagedBuffer::createBuffer(TimeStampedBuffer* buffer) {
+  buffer->buf = new Memory(const_cast<pal::Device&>(gpu_.dev()), size_);
+  if (nullptr == buffer->buf || !buffer->buf->create(type_)) {
+    LogPrintfError("We couldn't create HW constant buffer, size(%d)!", size_);
+    return false;
+  }
+  // Assign virtual gpu to the allocation. Buffer will be used only on a particular queue
+  buffer->buf->memRef()->gpu_ = &gpu_;
+  void* wrtAddress = buffer->buf->map(&gpu_);
+  if (wrtAddress == nullptr) {
+    LogPrintfError("We couldn't map HW constant buffer, size(%d)!", size_);
+    return false;
+  }
+  // Make sure OCL touches every buffer in the queue to avoid delays on the first submit
+  uint dummy = 0;
+  static constexpr bool Wait = true;
+  // Write 0 for the buffer paging by VidMM
+  buffer->buf->writeRawData(gpu_, 0, sizeof(dummy), &dummy, Wait);
+  return true;
 }
 
 // ================================================================================================
 bool ManagedBuffer::create(Resource::MemoryType type) {
+  type_ = type;
   for (uint i = 0; i < pool_.size(); ++i) {
-    pool_[i].buf = new Memory(const_cast<pal::Device&>(gpu_.dev()), size_);
-    if (nullptr == pool_[i].buf || !pool_[i].buf->create(type)) {
-      LogPrintfError("We couldn't create HW constant buffer, size(%d)!", size_);
+    if (!createBuffer(&pool_[i])) {
       return false;
     }
-    // Assign virtual gpu to the allocation. Buffer will be used only on a particular queue
-    pool_[i].buf->memRef()->gpu_ = &gpu_;
-    void* wrtAddress = pool_[i].buf->map(&gpu_);
-    if (wrtAddress == nullptr) {
-      LogPrintfError("We couldn't map HW constant buffer, size(%d)!", size_);
+  }
+  wrtAddress_ = pool_[activeBuffer_].buf->data();
+  return true;
+}
+
+// ================================================================================================
+bool ManagedBuffer::isIdle(TimeStampedBuffer* buffer) {
+  for (uint i = 0; i < AllEngines; ++i) {
+    GpuEvent* event = &buffer->events[i];
+    if (!event->isValid()) {
+      continue;
+    }
+    // The commands in the current command buffer didn't start yet
+    if (event->id_ == gpu().queue(static_cast<EngineType>(event->engineId_)).cmdBufId()) {
+      return false;
+    }
+    if (!gpu().isDone(event)) {
       return false;
     }
-    // Make sure OCL touches every buffer in the queue to avoid delays on the first submit
-    uint dummy = 0;
-    static constexpr bool Wait = true;
-    // Write 0 for the buffer paging by VidMM
-    pool_[i].buf->writeRawData(gpu_, 0, sizeof(dummy), &dummy, Wait);
   }
-  wrtAddress_ = pool_[activeBuffer_].buf->data();
   return true;
 }
 
+// ================================================================================================
+void ManagedBuffer::wrap() {
+  uint32_t next = (activeBuffer_ + 1) % pool_.size();
+  if (isIdle(&pool_[next])) {
+    // Shrink the ring if the buffers were idle for two full rounds
+    if ((++idleWraps_ > 2 * pool_.size()) && (pool_.size() > MinNumberOfBuffers)) {
+      uint32_t after = (next + 1) % pool_.size();
+      // Keep the first buffer, since it's the parent of the transfer views
+      if ((after != 0) && (after != activeBuffer_) && isIdle(&pool_[after])) {
+        pool_[after].buf->unmap(&gpu_);
+        delete pool_[after].buf;
+        pool_.erase(pool_.begin() + after);
+        if (after < next) {
+          --next;
+        }
+        if (after < activeBuffer_) {
+          --activeBuffer_;
+        }
+      }
+      idleWraps_ = 0;
+    }
+  } else {
+    idleWraps_ = 0;
+    TimeStampedBuffer buffer = {};
+    // Insert a new buffer in front of the busy one to avoid the wait
+    if ((pool_.size() < MaxNumberOfBuffers) && createBuffer(&buffer)) {
+      next = activeBuffer_ + 1;
+      pool_.insert(pool_.begin() + next, buffer);
+    } else {
+      delete buffer.buf;
+      ++wrapStalls_;
+      if (!gpu().dev().settings().disableSdma_) {
+        // Make sure the buffer isn't busy
+        gpu().waitForEvent(&pool_[next].events[SdmaEngine]);
+      }
+      gpu().waitForEvent(&pool_[next].events[MainEngine]);
+    }
+  }
+  activeBuffer_ = next;
+  wrtAddress_ = pool_[activeBuffer_].buf->data();
+  wrtOffset_ = 0;
+}
+
 // ================================================================================================
 address ManagedBuffer::reserve(uint32_t size, uint64_t* gpu_address) {
   // Align to the maximum data size available in OpenCL
@@ -83,15 +161,7 @@ address ManagedBuffer::reserve(uint32_t size, uint64_t* gpu_address) {
   // Check if buffer has enough space for reservation
   if ((wrtOffset_ + count) > size_) {
     // Get the next buffer in the list
-    ++activeBuffer_;
-    activeBuffer_ %= MaxNumberOfBuffers;
-    if (!gpu().dev().settings().disableSdma_) {
-      // Make sure the buffer isn't busy
-      gpu().waitForEvent(&pool_[activeBuffer_].events[SdmaEngine]);
-    }
-    gpu().waitForEvent(&pool_[activeBuffer_].events[MainEngine]);
-    wrtAddress_ = pool_[activeBuffer_].buf->data();
-    wrtOffset_ = 0;
+    wrap();
   }
 
   *gpu_address = pool_[activeBuffer_].buf->vmAddress() + wrtOffset_;
@@ -65,14 +65,29 @@ class ManagedBuffer : public amd::EmbeddedObject {
   //! Returns VirtualGPU object this managed resource associated
   VirtualGPU& gpu() const { return gpu_; }
 
+  //! Returns the number of the waits for a busy buffer on a wrap
+  uint64_t wrapStalls() const { return wrapStalls_; }
+
  private:
   struct TimeStampedBuffer {
     Memory* buf;
     GpuEvent events[AllEngines];
   };
 
-  //! The maximum number of the managed buffers
-  static constexpr uint32_t MaxNumberOfBuffers = 3;
+  //! The initial number of the managed buffers
+  static constexpr uint32_t MinNumberOfBuffers = 3;
+
+  //! The maximum number of the managed buffers, the ring grows under pressure
+  static constexpr uint32_t MaxNumberOfBuffers = 16;
+
+  //! Creates a new buffer for the pool
+  bool createBuffer(TimeStampedBuffer* buffer);
+
+  //! Returns true if the GPU doesn't use the buffer, never flushes the current command buffer
+  bool isIdle(TimeStampedBuffer* buffer);
+
+  //! Switches to the next buffer in the ring
+  void wrap();
 
   //! Disable copy constructor
   ManagedBuffer(const ManagedBuffer&) = delete;
@@ -86,6 +101,9 @@ class ManagedBuffer : public amd::EmbeddedObject {
   uint32_t size_;                        //!< Constant buffer size
   uint32_t wrtOffset_;                   //!< Current write offset
   address wrtAddress_;                   //!< Write address in CB
+  Resource::MemoryType type_;            //!< Memory type of the buffers
+  uint32_t idleWraps_;                   //!< Wraps on an idle buffer since the last resize
+  uint64_t wrapStalls_;                  //!< Waits for a busy buffer on a wrap
 };
 
 //! Constant buffer
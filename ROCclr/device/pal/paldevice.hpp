@@ -545,6 +545,13 @@ class Device : public NullDevice {
 
   RgpCaptureMgr* rgpCaptureMgr() const { return rgpCaptureMgr_; }
 
+  //! Captures an RGP trace without the RGP GUI, requires the developer driver
+  virtual bool captureTrace(uint32_t dispatches, const std::string& kernelName,
+                            const std::string& fileName) {
+    return (rgpCaptureMgr_ != nullptr) &&
+        rgpCaptureMgr_->RequestCapture(dispatches, kernelName, fileName);
+  }
+
   //! Update free memory for OCL extension
   void updateAllocedMemory(Pal::GpuHeap heap,  //!< PAL GPU heap for update
                            Pal::gpusize size,  //!< Size of alocated/destroyed memory
@@ -58,6 +58,9 @@ RgpCaptureMgr::RgpCaptureMgr(Pal::IPlatform* platform, const Device& device)
       inst_tracing_enabled_(false),
       perf_counters_enabled_(false) {
   memset(&trace_, 0, sizeof(trace_));
+  local_.pending_ = false;
+  local_.active_ = false;
+  local_.dispatches_ = 0;
 }
 
 // ================================================================================================
@@ -267,12 +270,13 @@ void RgpCaptureMgr::WaitForDriverResume() {
 // Called before a swap chain presents.  This signals a frame-end boundary and
 // is used to coordinate RGP trace start/stop.
 void RgpCaptureMgr::PostDispatch(VirtualGPU* gpu) {
-  if (rgp_server_->TracesEnabled()) {
+  if (rgp_server_->TracesEnabled() || local_.active_) {
     // If there's currently a trace running, submit the trace-end command buffer
     if (trace_.status_ == TraceStatus::Running) {
       amd::ScopedLock traceLock(&trace_mutex_);
       trace_.sqtt_disp_count_++;
-      if (trace_.sqtt_disp_count_ >= max_sqtt_disp_) {
+      const uint32_t max_disp = (local_.active_) ? local_.dispatches_ : max_sqtt_disp_;
+      if (trace_.sqtt_disp_count_ >= max_disp) {
         Pal::Result res = EndRGPHardwareTrace(gpu);
         if (Pal::Result::ErrorIncompatibleQueue == res) {
           // continue until we find the right queue...
@@ -323,11 +327,23 @@ Pal::Result RgpCaptureMgr::CheckForTraceResults() {
       // Get trace data from GPA session
       if (trace_.gpa_session_->GetResults(trace_.gpa_sample_id_, &traceDataSize, pTraceData) ==
           Pal::Result::Success) {
-        // Transmit trace data to anyone who's listening
-        auto devResult =
-            rgp_server_->WriteTraceData(static_cast<Pal::uint8*>(pTraceData), traceDataSize);
+        if (local_.active_) {
+          // Write the trace data into the file, requested by the application
+          FILE* file = fopen(local_.file_name_.c_str(), "wb");
+          if (file != nullptr) {
+            success = (fwrite(pTraceData, 1, traceDataSize, file) == traceDataSize);
+            fclose(file);
+          }
+          if (!success) {
+            LogPrintfError("Couldn't write RGP trace into %s", local_.file_name_.c_str());
+          }
+        } else {
+          // Transmit trace data to anyone who's listening
+          auto devResult =
+              rgp_server_->WriteTraceData(static_cast<Pal::uint8*>(pTraceData), traceDataSize);
 
-        success = (devResult == DevDriver::Result::Success);
+          success = (devResult == DevDriver::Result::Success);
+        }
       }
 
       amd::AlignedMemory::deallocate(pTraceData);
@@ -349,7 +365,7 @@ void RgpCaptureMgr::PreDispatch(VirtualGPU* gpu, const HSAILKernel& kernel, size
   // Wait for the driver to be resumed in case it's been paused.
   WaitForDriverResume();
 
-  if (rgp_server_->TracesEnabled()) {
+  if (rgp_server_->TracesEnabled() || local_.pending_ || local_.active_) {
     amd::ScopedLock traceLock(&trace_mutex_);
 
     // Check if there's an RGP trace request pending and we're idle
@@ -363,6 +379,14 @@ void RgpCaptureMgr::PreDispatch(VirtualGPU* gpu, const HSAILKernel& kernel, size
           }
         }
       }
+    } else if ((trace_.status_ == TraceStatus::Idle) && local_.pending_ &&
+               (local_.kernel_name_.empty() || (kernel.name() == local_.kernel_name_))) {
+      // The application requested a capture, start it without any preparation
+      if (PrepareLocalTrace(gpu) == Pal::Result::Success) {
+        if (BeginRGPTrace(gpu) != Pal::Result::Success) {
+          FinishRGPTrace(gpu, true);
+        }
+      }
     } else if (trace_.status_ == TraceStatus::Preparing) {
       // Wait some number of "preparation frames" before starting the trace in order to get enough
       // timer samples to sync CPU/GPU clock domains.
@@ -558,6 +582,50 @@ Pal::Result RgpCaptureMgr::PrepareRGPTrace(VirtualGPU* gpu) {
   return result;
 }
 
+// ================================================================================================
+// This function starts a local capture, requested by the application. The capture doesn't use
+// the RGP protocol and the lead-up dispatches.
+//
+// This function transitions from the Idle state to the Preparing state.
+Pal::Result RgpCaptureMgr::PrepareLocalTrace(VirtualGPU* gpu) {
+  assert(trace_.status_ == TraceStatus::Idle);
+
+  if (trace_.gpa_session_ == nullptr) {
+    local_.pending_ = false;
+    return Pal::Result::ErrorUnavailable;
+  }
+
+  num_prep_disp_ = 0;
+  trace_gpu_mem_limit_ = LocalTraceMemLimit;
+  inst_tracing_enabled_ = false;
+  perf_counters_enabled_ = false;
+  se_mask_ = 0;
+  perf_counter_ids_.clear();
+
+  // Tell the GPA session class we're starting a trace
+  GpuUtil::GpaSessionBeginInfo info = {};
+  info.flags.enableQueueTiming = true;
+  Pal::Result result = trace_.gpa_session_->Begin(info);
+
+  trace_.prepared_disp_count_ = 0;
+  trace_.sqtt_disp_count_ = 0;
+  local_.pending_ = false;
+
+  if (result == Pal::Result::Success) {
+    // Sample the timing clocks prior to starting a trace.
+    trace_.gpa_session_->SampleTimingClocks();
+
+    trace_.prepare_queue_ = gpu;
+    trace_.begin_queue_ = nullptr;
+    trace_.status_ = TraceStatus::Preparing;
+    local_.active_ = true;
+  } else {
+    LogPrintfError("RGP capture %s failed to start", local_.file_name_.c_str());
+  }
+
+  return result;
+}
+
 // ================================================================================================
 // This function begins an RGP trace by initializing all dependent resources and submitting
 // the "begin trace" information command buffer.
@@ -565,7 +633,7 @@ Pal::Result RgpCaptureMgr::PrepareRGPTrace(VirtualGPU* gpu) {
 // This function transitions from the Preparing state to the Running state.
 Pal::Result RgpCaptureMgr::BeginRGPTrace(VirtualGPU* gpu) {
   assert(trace_.status_ == TraceStatus::Preparing);
-  assert(trace_enabled_);
+  assert(trace_enabled_ || local_.active_);
 
   // We can only trace using a single device at a time currently, so recreate RGP trace
   // resources against this new one if the device is changing.
@@ -722,7 +790,12 @@ void RgpCaptureMgr::FinishRGPTrace(VirtualGPU* gpu, bool aborted) {
   }
 
   // Inform RGP protocol that we're done with the trace, either by aborting it or finishing normally
-  if (aborted) {
+  if (local_.active_) {
+    // The local capture doesn't use the RGP protocol
+    local_.active_ = false;
+    ClPrint(amd::LOG_INFO, amd::LOG_ALWAYS, "RGP capture %s %s", local_.file_name_.c_str(),
+            aborted ? "aborted" : "done");
+  } else if (aborted) {
     rgp_server_->AbortTrace();
   } else {
     rgp_server_->EndTrace();
@@ -741,6 +814,23 @@ void RgpCaptureMgr::FinishRGPTrace(VirtualGPU* gpu, bool aborted) {
   trace_.begin_queue_ = nullptr;
 }
 
+// ================================================================================================
+// Requests a capture from the application. The trace starts on the next dispatch (of the
+// kernel, if specified) and the results are written on a later dispatch, once they are ready.
+bool RgpCaptureMgr::RequestCapture(uint32_t dispatches, const std::string& kernel_name,
+                                   const std::string& file_name) {
+  amd::ScopedLock traceLock(&trace_mutex_);
+  if ((dispatches == 0) || file_name.empty() || (trace_.gpa_session_ == nullptr) ||
+      local_.pending_ || local_.active_) {
+    return false;
+  }
+  local_.dispatches_ = dispatches;
+  local_.kernel_name_ = kernel_name;
+  local_.file_name_ = file_name;
+  local_.pending_ = true;
+  return true;
+}
+
 // ================================================================================================
 // Destroys device-persistent RGP resources
 void RgpCaptureMgr::DestroyRGPTracing() {
@@ -20,7 +20,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
+#include <string>
 #include "device/pal/paldefs.hpp"
 #include "platform/commandqueue.hpp"
 #include "device/blit.hpp"
@@ -342,6 +344,11 @@ class RgpCaptureMgr {
   bool Update(Pal::IPlatform* platform);
   uint64_t AddElfBinary(const void* exe_binary, size_t exe_binary_size, const void* elf_binary,
                     size_t elf_binary_size, Pal::IGpuMemory* pGpuMemory, size_t offset);
+
+  //! Captures the next \a dispatches dispatches into \a file_name without the RGP GUI.
+  //! If \a kernel_name isn't empty, then the capture starts on a dispatch of this kernel
+  bool RequestCapture(uint32_t dispatches, const std::string& kernel_name,
+                      const std::string& file_name);
  private:
   // Steps that an RGP trace goes through
   enum class TraceStatus {
@@ -373,10 +380,23 @@ class RgpCaptureMgr {
     mutable uint32_t current_event_id_;  // Current event ID
   };
 
+  // A capture, requested by the application
+  struct LocalCapture {
+    std::atomic<bool> pending_;  // The capture waits for the start
+    bool active_;                // The current trace is a local capture
+    uint32_t dispatches_;        // Number of the dispatches in the capture
+    std::string kernel_name_;    // The kernel, which starts the capture
+    std::string file_name_;      // Output file for the trace data
+  };
+
+  // Default SQTT memory limit of a local capture
+  static constexpr uint32_t LocalTraceMemLimit = 128 * 1024 * 1024;
+
   RgpCaptureMgr(Pal::IPlatform* platform, const Device& device);
 
   bool Init(Pal::IPlatform* platform);
   Pal::Result PrepareRGPTrace(VirtualGPU* pQueue);
+  Pal::Result PrepareLocalTrace(VirtualGPU* pQueue);
   Pal::Result BeginRGPTrace(VirtualGPU* pQueue);
   Pal::Result EndRGPHardwareTrace(VirtualGPU* pQueue);
   Pal::Result EndRGPTrace(VirtualGPU* pQueue);
@@ -396,6 +416,7 @@ class RgpCaptureMgr {
   DevDriver::RGPProtocol::RGPServer* rgp_server_;
   mutable amd::Monitor trace_mutex_;
   TraceState trace_;
+  LocalCapture local_;
   RgpSqttMarkerUserEventWithString* user_event_;
 
   uint32_t num_prep_disp_;
@@ -449,6 +470,10 @@ class RgpCaptureMgr {
                     size_t elf_binary_size, Pal::IGpuMemory* pGpuMemory, size_t offset) {
     return true;
   }
+  bool RequestCapture(uint32_t dispatches, const std::string& kernel_name,
+                      const std::string& file_name) {
+    return false;
+  }
 };
 }  // namespace pal
 #endif // PAL_GPUOPEN_OCL
@@ -223,7 +223,11 @@ GpuMemoryReference* GpuMemoryReference::Create(const Device& dev,
 
 // ================================================================================================
 GpuMemoryReference::GpuMemoryReference(const Device& dev)
-    : gpuMem_(nullptr), cpuAddress_(nullptr), device_(dev), gpu_(nullptr) {}
+    : gpuMem_(nullptr),
+      cpuAddress_(nullptr),
+      device_(dev),
+      gpu_(nullptr),
+      subAllocator_(nullptr) {}
 
 // ================================================================================================
 GpuMemoryReference::~GpuMemoryReference() {
@@ -1525,7 +1529,7 @@ bool Resource::partialMemCopyTo(VirtualGPU& gpu, const amd::Coord3D& srcOrigin,
             copyRegion.copySize = orgSize;
           }
         } while (orgSize > 0);
-      } else {
+      } else if (!gpu.splitSdmaCopy(*this, dstResource, copyRegion)) {
         gpu.iCmd()->CmdCopyMemory(*iMem(), *dstResource.iMem(), 1, &copyRegion);
       }
     }
@@ -1939,6 +1943,9 @@ bool MemorySubAllocator::InitAllocator(GpuMemoryReference* mem_ref) {
     delete allocator;
     return false;
   }
+  mem_ref->subAllocator_ = this;
+  mem_ref->subAllocClasses_.reset(
+      new uint8_t[device_->settings().subAllocationChunkSize_ / minSize_]());
   return true;
 }
 
@@ -2041,8 +2048,21 @@ bool FineUncachedMemorySubAllocator::CreateChunk(const Pal::IGpuMemory* reserved
   return false;
 }
 
+// ================================================================================================
+MemorySubAllocator::MemorySubAllocator(Device* device)
+    : device_(device),
+      id_([]() {
+        static std::atomic<uint64_t> nextId(1);
+        return nextId++;
+      }()),
+      minSize_(device->settings().subAllocationMinSize_) {}
+
 // ================================================================================================
 MemorySubAllocator::~MemorySubAllocator() {
+  // The stale entries in the thread caches never match, since the ids aren't reused
+  for (auto it : magazines_) {
+    delete it;
+  }
   // Release memory heap for suballocations
   for (const auto& it : heaps_) {
     it.first->release();
@@ -2051,62 +2071,187 @@ MemorySubAllocator::~MemorySubAllocator() {
 }
 
 // ================================================================================================
-GpuMemoryReference* MemorySubAllocator::Allocate(Pal::gpusize size, Pal::gpusize alignment,
-                                                 const Pal::IGpuMemory* reserved_va,
-                                                 Pal::gpusize* offset) {
+MemorySubAllocator::Magazine* MemorySubAllocator::magazine(amd::Monitor* monitor) {
+  //! The magazines are owned by the suballocators, so a thread exit doesn't lose the blocks
+  thread_local std::vector<std::pair<uint64_t, Magazine*>> threadMagazines;
+  if (!PAL_SUBALLOC_THREAD_CACHE) {
+    return nullptr;
+  }
+  for (const auto& it : threadMagazines) {
+    if (it.first == id_) {
+      return it.second;
+    }
+  }
+  Magazine* magazine = new Magazine();
+  {
+    amd::ScopedLock l(monitor);
+    magazines_.push_back(magazine);
+  }
+  threadMagazines.push_back({id_, magazine});
+  return magazine;
+}
+
+// ================================================================================================
+GpuMemoryReference* MemorySubAllocator::AllocateLocked(Pal::gpusize size, Pal::gpusize alignment,
+                                                       const Pal::IGpuMemory* reserved_va,
+                                                       Pal::gpusize* offset) {
   GpuMemoryReference* mem_ref = nullptr;
   MemBuddyAllocator* allocator = nullptr;
+  uint i = 0;
+  do {
+    // Find if current heap has enough empty space
+    for (const auto& it : heaps_) {
+      mem_ref = it.first;
+      allocator = it.second;
+      // SVM allocations may required a fixed VA, make sure we find the heap with the same VA
+      if (reserved_va &&
+          (reserved_va->Desc().gpuVirtAddr != mem_ref->iMem()->Desc().gpuVirtAddr)) {
+        continue;
+      }
+      // If we have found a valid chunk, then suballocate memory
+      if (Pal::Result::Success == allocator->Allocate(size, alignment, offset)) {
+        return mem_ref;
+      }
+    }
+    // The idle thread caches may hold enough space to avoid a new chunk
+    if ((i == 0) && (reserved_va == nullptr) && Drain()) {
+      continue;
+    }
+    // We didn't find a valid chunk, so create a new one
+    if (!CreateChunk(reserved_va)) {
+      return nullptr;
+    }
+    i++;
+  } while (i < 2);
+  return nullptr;
+}
+
+// ================================================================================================
+bool MemorySubAllocator::FreeLocked(GpuMemoryReference* mem_ref, Pal::gpusize offset) {
+  auto it = heaps_.find(mem_ref);
+  it->second->Free(offset);
+  // If this suballocator empty, then release memory chunk
+  if (it->second->IsEmpty()) {
+    delete it->second;
+    heaps_.erase(it);
+    return true;
+  }
+  return false;
+}
+
+// ================================================================================================
+bool MemorySubAllocator::Drain() {
+  bool drained = false;
+  for (auto magazine : magazines_) {
+    // Skip the magazine if the owner thread uses it
+    if (magazine->busy_.exchange(true, std::memory_order_acquire)) {
+      continue;
+    }
+    for (uint cls = 0; cls < MagazineClasses; ++cls) {
+      for (uint j = 0; j < magazine->count_[cls]; ++j) {
+        const Block& block = magazine->blocks_[cls][j];
+        setClass(block.ref_, block.offset_, 0);
+        // Keep the empty chunks, since the caller is about to allocate from them
+        heaps_.find(block.ref_)->second->Free(block.offset_);
+        drained = true;
+      }
+      magazine->count_[cls] = 0;
+    }
+    magazine->busy_.store(false, std::memory_order_release);
+  }
+  return drained;
+}
+
+// ================================================================================================
+GpuMemoryReference* MemorySubAllocator::Allocate(amd::Monitor* monitor, Pal::gpusize size,
+                                                 Pal::gpusize alignment,
+                                                 const Pal::IGpuMemory* reserved_va,
+                                                 Pal::gpusize* offset) {
   // Check if the resource size and alignment are allowed for suballocation
-  if ((size < device_->settings().subAllocationMaxSize_) &&
-      (alignment <= device_->properties().gpuMemoryProperties.fragmentSize)) {
-    uint i = 0;
-    size = amd::alignUp(size, device_->settings().subAllocationMinSize_);
-    do {
-      // Find if current heap has enough empty space
-      for (const auto& it : heaps_) {
-        mem_ref = it.first;
-        allocator = it.second;
-        // SVM allocations may required a fixed VA, make sure we find the heap with the same VA
-        if (reserved_va &&
-            (reserved_va->Desc().gpuVirtAddr != mem_ref->iMem()->Desc().gpuVirtAddr)) {
-          continue;
-        }
-        // If we have found a valid chunk, then suballocate memory
-        if (Pal::Result::Success == allocator->Allocate(size, alignment, offset)) {
-          return mem_ref;
+  if ((size >= device_->settings().subAllocationMaxSize_) ||
+      (alignment > device_->properties().gpuMemoryProperties.fragmentSize)) {
+    return nullptr;
+  }
+  size = amd::alignUp(size, minSize_);
+
+  // The small blocks without a fixed VA come from the magazine of the thread
+  const Pal::gpusize blockSize = amd::nextPowerOfTwo(std::max(size, alignment));
+  const uint cls = amd::log2(blockSize / minSize_);
+  Magazine* magazine = nullptr;
+  if ((reserved_va == nullptr) && (cls < MagazineClasses) &&
+      (blockSize < device_->settings().subAllocationMaxSize_)) {
+    magazine = this->magazine(monitor);
+  }
+  if ((magazine != nullptr) && !magazine->busy_.exchange(true, std::memory_order_acquire)) {
+    GpuMemoryReference* mem_ref = nullptr;
+    uint& count = magazine->count_[cls];
+    if (count == 0) {
+      // Refill half of the magazine, so the next free doesn't have to take the lock
+      amd::ScopedLock l(monitor);
+      for (; count < MagazineSize / 2; ++count) {
+        Block& block = magazine->blocks_[cls][count];
+        block.ref_ = AllocateLocked(blockSize, alignment, nullptr, &block.offset_);
+        if (block.ref_ == nullptr) {
+          break;
         }
+        setClass(block.ref_, block.offset_, cls + 1);
       }
-      // We didn't find a valid chunk, so create a new one
-      if (!CreateChunk(reserved_va)) {
-        return nullptr;
-      }
-      i++;
-    } while (i < 2);
+    }
+    if (count != 0) {
+      const Block& block = magazine->blocks_[cls][--count];
+      mem_ref = block.ref_;
+      *offset = block.offset_;
+    }
+    magazine->busy_.store(false, std::memory_order_release);
+    return mem_ref;
   }
-  return nullptr;
+
+  amd::ScopedLock l(monitor);
+  GpuMemoryReference* mem_ref = AllocateLocked(size, alignment, reserved_va, offset);
+  if (mem_ref != nullptr) {
+    setClass(mem_ref, *offset, 0);
+  }
+  return mem_ref;
 }
 
 // ================================================================================================
 bool MemorySubAllocator::Free(amd::Monitor* monitor, GpuMemoryReference* ref, Pal::gpusize offset) {
-  bool release_mem = false;
-  {
-    amd::ScopedLock l(monitor);
-    // Find if current memory reference is a chunk allocation
-    auto it = heaps_.find(ref);
-    if (it == heaps_.end()) {
-      return false;
+  // Find if current memory reference is a chunk allocation
+  if (ref->subAllocator_ != this) {
+    return false;
+  }
+  GpuMemoryReference* release_mem[MagazineSize / 2] = {};
+  uint num_release = 0;
+
+  const uint cls = ref->subAllocClasses_[offset / minSize_];
+  Magazine* magazine = (cls != 0) ? this->magazine(monitor) : nullptr;
+  if ((magazine != nullptr) && !magazine->busy_.exchange(true, std::memory_order_acquire)) {
+    uint& count = magazine->count_[cls - 1];
+    Block* blocks = magazine->blocks_[cls - 1];
+    if (count == MagazineSize) {
+      // Return the older half of the magazine to the chunks for the other threads
+      constexpr uint Half = MagazineSize / 2;
+      amd::ScopedLock l(monitor);
+      for (uint i = 0; i < Half; ++i) {
+        setClass(blocks[i].ref_, blocks[i].offset_, 0);
+        if (FreeLocked(blocks[i].ref_, blocks[i].offset_)) {
+          release_mem[num_release++] = blocks[i].ref_;
+        }
+      }
+      std::memmove(blocks, &blocks[Half], Half * sizeof(Block));
+      count = Half;
     }
-
-    it->second->Free(offset);
-    // If this suballocator empty, then release memory chunk
-    if (it->second->IsEmpty()) {
-      delete it->second;
-      heaps_.erase(it);
-      release_mem = true;
+    blocks[count++] = {ref, offset};
+    magazine->busy_.store(false, std::memory_order_release);
+  } else {
+    amd::ScopedLock l(monitor);
+    setClass(ref, offset, 0);
+    if (FreeLocked(ref, offset)) {
+      release_mem[num_release++] = ref;
     }
   }
-  if (release_mem) {
-    ref->release();
+  for (uint i = 0; i < num_release; ++i) {
+    release_mem[i]->release();
   }
   return true;
 }
@@ -2145,7 +2290,7 @@ bool ResourceCache::addGpuMemory(Resource::Descriptor* desc, GpuMemoryReference*
       (size < cacheSizeLimit_) && !desc->SVMRes_) {
     // Validate the cache size limit. Loop until we have enough space
     while ((cacheSize_ + size) > cacheSizeLimit_) {
-      removeLast();
+      evict(cacheSize_ + size - cacheSizeLimit_);
     }
 
     Resource::Descriptor* descCached = new Resource::Descriptor;
@@ -2155,7 +2300,9 @@ bool ResourceCache::addGpuMemory(Resource::Descriptor* desc, GpuMemoryReference*
 
       amd::ScopedLock l(&lockCacheOps_);
       // Add the current resource to the cache
-      resCache_.push_front({descCached, ref});
+      resCache_[bucketKey(amd::log2(size), desc->type_)].push_front(
+          {descCached, ref, size, stamp_++});
+      ++numEntries_;
       ref->gpu_ = nullptr;
       cacheSize_ += size;
       if (desc->type_ == Resource::Local) {
@@ -2173,19 +2320,19 @@ GpuMemoryReference* ResourceCache::findGpuMemory(Resource::Descriptor* desc, Pal
                                                  Pal::gpusize alignment,
                                                  const Pal::IGpuMemory* reserved_va,
                                                  Pal::gpusize* offset) {
-  amd::ScopedLock l(&lockCacheOps_);
   GpuMemoryReference* ref = nullptr;
 
-  // Check if the runtime can suballocate memory
+  // Check if the runtime can suballocate memory, the small blocks don't take the lock
   if ((desc->type_ == Resource::Local) && !desc->SVMRes_) {
-    ref = mem_sub_alloc_local_.Allocate(size, alignment, reserved_va, offset);
+    ref = mem_sub_alloc_local_.Allocate(&lockCacheOps_, size, alignment, reserved_va, offset);
   } else if ((desc->type_ == Resource::Local) && desc->SVMRes_) {
-    ref = mem_sub_alloc_coarse_.Allocate(size, alignment, reserved_va, offset);
+    ref = mem_sub_alloc_coarse_.Allocate(&lockCacheOps_, size, alignment, reserved_va, offset);
   } else if (desc->SVMRes_) {
     if (desc->gl2CacheDisabled_) {
-      ref = mem_sub_alloc_fine_uncached_.Allocate(size, alignment, reserved_va, offset);
+      ref = mem_sub_alloc_fine_uncached_.Allocate(&lockCacheOps_, size, alignment, reserved_va,
+                                                  offset);
     } else {
-      ref = mem_sub_alloc_fine_.Allocate(size, alignment, reserved_va, offset);
+      ref = mem_sub_alloc_fine_.Allocate(&lockCacheOps_, size, alignment, reserved_va, offset);
     }
   }
 
@@ -2199,23 +2346,37 @@ GpuMemoryReference* ResourceCache::findGpuMemory(Resource::Descriptor* desc, Pal
     return ref;
   }
 
-  // Serach the right resource through the cache list
-  for (const auto& it : resCache_) {
-    Resource::Descriptor* entry = it.first;
-    size_t sizeRes = it.second->iMem()->Desc().size;
-    // Find if we can reuse this entry
-    if ((entry->type_ == desc->type_) && (entry->flags_ == desc->flags_) && (size <= sizeRes) &&
-        (size > (sizeRes >> 1)) && ((it.second->iMem()->Desc().gpuVirtAddr % alignment) == 0) &&
-        (entry->isAllocExecute_ == desc->isAllocExecute_)) {
-      ref = it.second;
-      cacheSize_ -= sizeRes;
-      if (entry->type_ == Resource::Local) {
-        lclCacheSize_ -= sizeRes;
+  amd::ScopedLock l(&lockCacheOps_);
+
+  // A reusable entry is in [size, 2 * size), hence only 2 size classes can have it
+  const size_t sizeClass = amd::log2(size);
+  for (size_t cls = sizeClass; (cls <= sizeClass + 1) && (ref == nullptr); ++cls) {
+    auto bucket = resCache_.find(bucketKey(cls, desc->type_));
+    if (bucket == resCache_.end()) {
+      continue;
+    }
+    // Search the most recent entries first, the alignment depends on the VA of the entry
+    for (auto it = bucket->second.begin(); it != bucket->second.end(); ++it) {
+      Resource::Descriptor* entry = it->desc_;
+      size_t sizeRes = it->size_;
+      // Find if we can reuse this entry
+      if ((entry->flags_ == desc->flags_) && (size <= sizeRes) && (size > (sizeRes >> 1)) &&
+          ((it->ref_->iMem()->Desc().gpuVirtAddr % alignment) == 0) &&
+          (entry->isAllocExecute_ == desc->isAllocExecute_)) {
+        ref = it->ref_;
+        cacheSize_ -= sizeRes;
+        if (entry->type_ == Resource::Local) {
+          lclCacheSize_ -= sizeRes;
+        }
+        delete entry;
+        // Remove the found etry from the cache
+        bucket->second.erase(it);
+        if (bucket->second.empty()) {
+          resCache_.erase(bucket);
+        }
+        --numEntries_;
+        break;
       }
-      delete it.first;
-      // Remove the found etry from the cache
-      resCache_.remove(it);
-      break;
     }
   }
 
@@ -2225,7 +2386,7 @@ GpuMemoryReference* ResourceCache::findGpuMemory(Resource::Descriptor* desc, Pal
 // ================================================================================================
 bool ResourceCache::free(size_t minCacheEntries) {
   bool result = false;
-  if (minCacheEntries < resCache_.size()) {
+  if (minCacheEntries < numEntries_) {
     result = true;
     // Clear the cache
     while (static_cast<int64_t>(cacheSize_) > 0) {
@@ -2237,25 +2398,52 @@ bool ResourceCache::free(size_t minCacheEntries) {
 }
 
 // ================================================================================================
-void ResourceCache::removeLast() {
-  std::pair<Resource::Descriptor*, GpuMemoryReference*> entry;
+void ResourceCache::evict(size_t needed) {
+  GpuMemoryReference* ref = nullptr;
   {
     // Protect access to the global data
     amd::ScopedLock l(&lockCacheOps_);
-    if (resCache_.size() > 0) {
-      entry = resCache_.back();
-      resCache_.pop_back();
-      cacheSize_ -= entry.second->iMem()->Desc().size;
-      if (entry.first->type_ == Resource::Local) {
-        lclCacheSize_ -= entry.second->iMem()->Desc().size;
+    if (numEntries_ == 0) {
+      return;
+    }
+    // The bucket backs are the oldest entries of every bucket
+    auto victim = resCache_.end();
+    if (needed != 0) {
+      for (auto it = resCache_.lower_bound(bucketKey(amd::log2(needed), Resource::Empty));
+           it != resCache_.end(); ++it) {
+        const CacheEntry& oldest = it->second.back();
+        if ((oldest.size_ >= needed) &&
+            ((victim == resCache_.end()) || (oldest.stamp_ < victim->second.back().stamp_))) {
+          victim = it;
+        }
       }
-      // Delete Descriptor
-      delete entry.first;
     }
+    if (victim == resCache_.end()) {
+      for (auto it = resCache_.begin(); it != resCache_.end(); ++it) {
+        if ((victim == resCache_.end()) ||
+            (it->second.back().stamp_ < victim->second.back().stamp_)) {
+          victim = it;
+        }
+      }
+    }
+
+    CacheEntry entry = victim->second.back();
+    victim->second.pop_back();
+    if (victim->second.empty()) {
+      resCache_.erase(victim);
+    }
+    --numEntries_;
+    cacheSize_ -= entry.size_;
+    if (entry.desc_->type_ == Resource::Local) {
+      lclCacheSize_ -= entry.size_;
+    }
+    // Delete Descriptor
+    delete entry.desc_;
+    ref = entry.ref_;
   }
 
   // Destroy PAL resource
-  entry.second->release();
+  ref->release();
 }
 
 }  // namespace pal
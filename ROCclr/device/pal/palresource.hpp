@@ -26,13 +26,17 @@
 #include "util/palBuddyAllocatorImpl.h"
 
 #include <atomic>
+#include <map>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 //! \namespace pal PAL Resource Implementation
 namespace pal {
 
 class Device;
 class VirtualGPU;
+class MemorySubAllocator;
 
 /*! \addtogroup PAL PAL Resource Implementation
  *  @{
@@ -68,6 +72,9 @@ class GpuMemoryReference : public amd::ReferenceCountedObject {
   const Device& device_;     //!< GPU device
   //! @note: This field is necessary for the thread safe release only
   VirtualGPU* gpu_;  //!< Resource will be used only on this queue
+  MemorySubAllocator* subAllocator_;  //!< Owner of the chunk, if memory is a suballocation chunk
+  //! Magazine class + 1 of every block in the chunk or 0 for the blocks of the shared path
+  std::unique_ptr<uint8_t[]> subAllocClasses_;
 
  protected:
   //! Default destructor
@@ -516,12 +523,12 @@ typedef Util::BuddyAllocator<Device> MemBuddyAllocator;
 
 class MemorySubAllocator : public amd::HeapObject {
  public:
-  MemorySubAllocator(Device* device) : device_(device) {}
+  MemorySubAllocator(Device* device);
 
   ~MemorySubAllocator();
 
   //! Create suballocation
-  GpuMemoryReference* Allocate(Pal::gpusize size, Pal::gpusize alignment,
+  GpuMemoryReference* Allocate(amd::Monitor* monitor, Pal::gpusize size, Pal::gpusize alignment,
                                const Pal::IGpuMemory* reserved_va, Pal::gpusize* offset);
   //! Free suballocation
   bool Free(amd::Monitor* monitor, GpuMemoryReference* mem_ref, Pal::gpusize offset);
@@ -534,6 +541,44 @@ class MemorySubAllocator : public amd::HeapObject {
 
   Device* device_;
   std::unordered_map<GpuMemoryReference*, MemBuddyAllocator*> heaps_;
+
+ private:
+  static constexpr uint MagazineClasses = 5;  //!< Block sizes from subAllocationMinSize_ up
+  static constexpr uint MagazineSize = 16;    //!< Max number of the blocks per class
+
+  struct Block {
+    GpuMemoryReference* ref_;  //!< Chunk of the block
+    Pal::gpusize offset_;      //!< Offset of the block in the chunk
+  };
+
+  //! Per thread cache of the small free blocks
+  struct Magazine : public amd::HeapObject {
+    std::atomic<bool> busy_{false};  //!< The owner or the drain on memory pressure uses it
+    uint count_[MagazineClasses] = {};
+    Block blocks_[MagazineClasses][MagazineSize];
+  };
+
+  //! Returns the magazine of the current thread, nullptr if the magazines are disabled
+  Magazine* magazine(amd::Monitor* monitor);
+
+  //! Finds space in the chunks, expects the lock
+  GpuMemoryReference* AllocateLocked(Pal::gpusize size, Pal::gpusize alignment,
+                                     const Pal::IGpuMemory* reserved_va, Pal::gpusize* offset);
+
+  //! Returns a block to the chunk, expects the lock. Returns true if the chunk is empty
+  bool FreeLocked(GpuMemoryReference* mem_ref, Pal::gpusize offset);
+
+  //! Moves the blocks of all idle magazines back to the chunks, expects the lock
+  bool Drain();
+
+  //! Records the magazine class of a block
+  void setClass(GpuMemoryReference* mem_ref, Pal::gpusize offset, uint cls) {
+    mem_ref->subAllocClasses_[offset / minSize_] = static_cast<uint8_t>(cls);
+  }
+
+  const uint64_t id_;                  //!< Unique id, the thread caches are looked up with it
+  const Pal::gpusize minSize_;         //!< Min size of a block
+  std::vector<Magazine*> magazines_;   //!< Magazines of all threads, protected by the lock
 };
 
 class CoarseMemorySubAllocator : public MemorySubAllocator {
@@ -564,6 +609,8 @@ class ResourceCache : public amd::HeapObject {
         cacheSize_(0),
         lclCacheSize_(0),
         cacheSizeLimit_(cacheSizeLimit),
+        numEntries_(0),
+        stamp_(0),
         mem_sub_alloc_local_(device),
         mem_sub_alloc_coarse_(device),
         mem_sub_alloc_fine_(device),
@@ -602,8 +649,18 @@ class ResourceCache : public amd::HeapObject {
   //! Disable operator=
   ResourceCache& operator=(const ResourceCache&);
 
-  //! Removes one last entry from the cache
-  void removeLast();
+  //! Removes the least recently used entry from the cache
+  void removeLast() { evict(0); }
+
+  //! Removes an entry to make room for \a needed bytes. The oldest entry of at least
+  //! \a needed bytes goes first, so a big allocation doesn't evict many small ones.
+  //! Without such entry or with 0 bytes, the least recently used entry is removed.
+  void evict(size_t needed);
+
+  //! Returns the bucket key of the resource, the size class goes first for the eviction search
+  static uint64_t bucketKey(size_t sizeClass, Resource::MemoryType type) {
+    return (static_cast<uint64_t>(sizeClass) << 8) | static_cast<uint64_t>(type);
+  }
 
   amd::Monitor lockCacheOps_;  //!< Lock to serialise cache access
 
@@ -611,8 +668,19 @@ class ResourceCache : public amd::HeapObject {
   size_t lclCacheSize_;         //!< Local memory stored in the cache
   const size_t cacheSizeLimit_; //!< Cache size limit in bytes
 
-  //! PAL resource cache
-  std::list<std::pair<Resource::Descriptor*, GpuMemoryReference*> > resCache_;
+  struct CacheEntry {
+    Resource::Descriptor* desc_;  //!< Copy of the original descriptor
+    GpuMemoryReference* ref_;     //!< Cached PAL resource
+    size_t size_;                 //!< Size of the resource
+    uint64_t stamp_;              //!< Insertion order for the LRU eviction
+  };
+
+  size_t numEntries_;  //!< Number of the cached resources
+  uint64_t stamp_;     //!< Stamp of the next cached resource
+
+  //! PAL resource cache, indexed by the memory type and the power of 2 size class,
+  //! every bucket is in the LRU order with the most recent entry in the front
+  std::map<uint64_t, std::list<CacheEntry>> resCache_;
 
   MemorySubAllocator mem_sub_alloc_local_;                     //!< Allocator for suballocations in Local
   CoarseMemorySubAllocator mem_sub_alloc_coarse_;              //!< Allocator for suballocations in Coarse SVM
@@ -168,6 +168,7 @@ Settings::Settings() {
   enableHwP2P_ = false;
   imageBufferWar_ = false;
   disableSdma_ = PAL_DISABLE_SDMA;
+  sdmaSplitSize_ = static_cast<uint64_t>(PAL_SDMA_SPLIT_SIZE) * Mi;
   mallPolicy_ = 0;
   alwaysResident_ = amd::IS_HIP ? true : false;
   prepinnedMinSize_ = 0;
@@ -430,6 +431,7 @@ bool Settings::create(const Pal::DeviceProperties& palProp,
     enableExtension(ClKhrGlEvent);
     enableExtension(ClAmdCopyBufferP2P);
   }
+  enableExtension(ClAmdCommandBuffer);
 
   if (!useLightning_) {
     enableExtension(ClAmdPopcnt);
@@ -117,6 +117,7 @@ class Settings : public device::Settings {
   uint64_t subAllocationMinSize_;    //!< Minimum size allowed for suballocations
   uint64_t subAllocationMaxSize_;    //!< Maximum size allowed with suballocations
   uint64_t subAllocationChunkSize_;  //!< Chunk size for suballocaitons
+  uint64_t sdmaSplitSize_;           //!< Min size of a copy, split across 2 SDMA engines
 
   amd::LibrarySelector libSelector_;  //!< Select linking libraries for compiler
 
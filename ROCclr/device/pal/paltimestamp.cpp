@@ -25,11 +25,15 @@
 #include "device/pal/palvirtual.hpp"
 #include "device/pal/palcounters.hpp"
 
+#include <algorithm>
+
 namespace pal {
 
-TimeStamp::TimeStamp(const VirtualGPU& gpu, Pal::IGpuMemory* iMem, uint memOffset, address cpuAddr)
-    : gpu_(gpu), iMem_(iMem), memOffset_(memOffset) {
+TimeStamp::TimeStamp(const VirtualGPU& gpu, Pal::IGpuMemory* iMem, uint memOffset, address cpuAddr,
+                     address hostAddr, uint slab)
+    : gpu_(gpu), iMem_(iMem), memOffset_(memOffset), slab_(slab) {
   values_ = reinterpret_cast<volatile uint64_t*>(cpuAddr + memOffset);
+  hostValues_ = reinterpret_cast<uint64_t*>(hostAddr + memOffset);
 }
 
 TimeStamp::~TimeStamp() {}
@@ -58,8 +62,13 @@ void TimeStamp::value(uint64_t* startTime, uint64_t* endTime) {
   //! @todo optimize!
   const double NanoSecondsPerTick = 1000000000.0 / (gpu_.dev().properties().timestampFrequency);
 
-  SetValue(startTime, values_[CommandStartTime], NanoSecondsPerTick);
-  SetValue(endTime, values_[CommandEndTime], NanoSecondsPerTick);
+  if (flags_.cached_) {
+    SetValue(startTime, hostValues_[CommandStartTime], NanoSecondsPerTick);
+    SetValue(endTime, hostValues_[CommandEndTime], NanoSecondsPerTick);
+  } else {
+    SetValue(startTime, values_[CommandStartTime], NanoSecondsPerTick);
+    SetValue(endTime, values_[CommandEndTime], NanoSecondsPerTick);
+  }
 }
 
 TimeStampCache::~TimeStampCache() {
@@ -102,9 +111,13 @@ TimeStamp* TimeStampCache::allocTimeStamp() {
       memset(tsBufCpu_, 0, TimerBufSize);
       tsOffset_ = 0;
       tsBuf_.push_back(buf);
+      tsBufMap_.push_back(tsBufCpu_);
+      tsBufHost_.emplace_back(new uint64_t[TimerBufSize / sizeof(uint64_t)]);
     }
     // Allocate a TimeStamp object
-    ts = new TimeStamp(gpu_, tsBuf_[(tsBuf_.size() - 1)]->iMem(), tsOffset_, tsBufCpu_);
+    const uint slab = static_cast<uint>(tsBuf_.size() - 1);
+    ts = new TimeStamp(gpu_, tsBuf_[slab]->iMem(), tsOffset_, tsBufCpu_,
+                       reinterpret_cast<address>(tsBufHost_[slab].get()), slab);
     // Create a timestamp
     if (ts == nullptr) {
       return nullptr;
@@ -118,4 +131,32 @@ TimeStamp* TimeStampCache::allocTimeStamp() {
   return ts;
 }
 
+void TimeStampCache::readback(const std::vector<TimeStamp*>& timeStamps) {
+  readRanges_.assign(tsBuf_.size(), {TimerBufSize, 0});
+
+  // Find the used ranges in every buffer. The freed objects are reused in LIFO order,
+  // hence the time stamps of a batch are usually close to each other
+  for (const auto ts : timeStamps) {
+    if (ts->isValid()) {
+      ReadRange& range = readRanges_[ts->slab_];
+      range.begin_ = std::min(range.begin_, ts->memOffset_);
+      range.end_ = std::max(range.end_, ts->memOffset_ + TimerSlotSize);
+    }
+  }
+
+  for (uint i = 0; i < readRanges_.size(); ++i) {
+    const ReadRange& range = readRanges_[i];
+    if (range.begin_ < range.end_) {
+      memcpy(reinterpret_cast<address>(tsBufHost_[i].get()) + range.begin_,
+             tsBufMap_[i] + range.begin_, range.end_ - range.begin_);
+    }
+  }
+
+  for (const auto ts : timeStamps) {
+    if (ts->isValid()) {
+      ts->flags_.cached_ = true;
+    }
+  }
+}
+
 }  // namespace pal
@@ -23,6 +23,8 @@
 #include "device/pal/paldefs.hpp"
 #include "device/pal/palresource.hpp"
 
+#include <memory>
+
 /*! \addtogroup pal PAL Resource Implementation
  *  @{
  */
@@ -46,6 +48,7 @@ class TimeStamp : public amd::HeapObject {
     struct {
       uint32_t beginIssued_ : 1;
       uint32_t endIssued_ : 1;
+      uint32_t cached_ : 1;  //!< The values were copied into the host memory
     };
     uint32_t value_;
     Flags() : value_(0) {}
@@ -55,7 +58,9 @@ class TimeStamp : public amd::HeapObject {
   TimeStamp(const VirtualGPU& gpu,  //!< Virtual GPU
             Pal::IGpuMemory* iMem,  //!< Buffer with the timer values
             uint memOffset,         //!< Offset in the buffer for the current TS
-            address cpuAddr         //!< CPU pointer for the values in memory
+            address cpuAddr,        //!< CPU pointer for the values in memory
+            address hostAddr,       //!< Host copy of the buffer for the bulk readback
+            uint slab               //!< Index of the buffer in the cache
   );
 
   //! Default destructor
@@ -81,6 +86,8 @@ class TimeStamp : public amd::HeapObject {
   bool isValid() const { return (flags_.endIssued_) ? true : false; }
 
  private:
+  friend class TimeStampCache;
+
   //! Disable copy constructor
   TimeStamp(const TimeStamp&);
 
@@ -95,6 +102,8 @@ class TimeStamp : public amd::HeapObject {
   Pal::IGpuMemory* iMem_;      //!< Buffer with the timer values
   uint memOffset_;             //!< Offset in the buffer for the current timer
   volatile uint64_t* values_;  //!< CPU pointer to the timer values
+  uint64_t* hostValues_;       //!< Timer values in the host copy
+  uint slab_;                  //!< Index of the buffer in the cache
 };
 
 class TimeStampCache : public amd::HeapObject {
@@ -113,6 +122,10 @@ class TimeStampCache : public amd::HeapObject {
   //! Frees a time stamp object
   void freeTimeStamp(TimeStamp* ts) { freedTS_.push_back(ts); }
 
+  //! Copies the values of the completed time stamps with a single read per buffer,
+  //! so TimeStamp::value() doesn't access the mapped memory
+  void readback(const std::vector<TimeStamp*>& timeStamps);
+
  private:
   static constexpr uint TimerSlotSize = TimeStamp::CommandTotal * sizeof(uint64_t);
   static constexpr uint TimerBufSize = TimerSlotSize * 4096;
@@ -123,9 +136,18 @@ class TimeStampCache : public amd::HeapObject {
   //! Disable operator=
   TimeStampCache& operator=(const TimeStampCache&);
 
+  //! The range of the buffer for the readback
+  struct ReadRange {
+    uint begin_;  //!< Start offset
+    uint end_;    //!< End offset
+  };
+
   std::vector<TimeStamp*> freedTS_;  //!< Array of freed time stamp objects
   VirtualGPU& gpu_;                  //!< Virtual GPU
   std::vector<Memory*> tsBuf_;       //!< Array of memory objects with the timer value
+  std::vector<address> tsBufMap_;    //!< CPU pointers of the memory objects
+  std::vector<std::unique_ptr<uint64_t[]>> tsBufHost_;  //!< Host copies of the memory objects
+  std::vector<ReadRange> readRanges_;                   //!< Ranges of the current readback
   address tsBufCpu_;                 //!< CPU pointer for current TS memory
   uint tsOffset_;                    //!< Active offset in the current mem object
 };
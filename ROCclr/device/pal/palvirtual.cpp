@@ -213,6 +213,7 @@ VirtualGPU::Queue* VirtualGPU::Queue::Create(const VirtualGPU& gpu, Pal::QueueTy
           delete queue;
           return nullptr;
         }
+        queue->cmdBufState_[i] = CmdBufBuilding;
       }
     }
   }
@@ -288,10 +289,14 @@ void VirtualGPU::Queue::addCmdMemRef(GpuMemoryReference* mem) {
   Pal::IGpuMemory* iMem = mem->iMem();
   auto it = memReferences_.find(mem);
   if (it != memReferences_.end()) {
-    it->second = cmdBufIdSlot_;
+    if (it->second != cmdBufIdSlot_) {
+      it->second = cmdBufIdSlot_;
+      slotMemRefs_[cmdBufIdSlot_].push_back(mem);
+    }
   } else {
     // Update runtime tracking with TS
     memReferences_[mem] = cmdBufIdSlot_;
+    slotMemRefs_[cmdBufIdSlot_].push_back(mem);
     // Update PAL list with the new entry
     Pal::GpuMemoryRef memRef = {};
     memRef.pGpuMemory = iMem;
@@ -413,10 +418,17 @@ bool VirtualGPU::Queue::flush() {
     cmbBufIdRetired_ = 0;
   }
 
+  // The fence of the submitted buffer signals the reset
+  cmdBufState_[cmdBufIdSlot_] = CmdBufPending;
+
   // Wrap current slot
   cmdBufIdSlot_ = cmdBufIdCurrent_ % max_command_buffers_;
 
-  waifForFence<IbReuse>(cmdBufIdSlot_);
+  // Start the next command buffer. Usually it was recycled already and the fence wait
+  // occurs only if all buffers in the ring are busy
+  if (!beginCmdBuffer(cmdBufIdSlot_)) {
+    return false;
+  }
 
   // Progress retired TS
   if ((cmdBufIdCurrent_ > max_command_buffers_) &&
@@ -424,35 +436,30 @@ bool VirtualGPU::Queue::flush() {
     cmbBufIdRetired_ = cmdBufIdCurrent_ - max_command_buffers_;
   }
 
-  // Reset command buffer, so CB chunks could be reused
-  if (Pal::Result::Success != iCmdBuffs_[cmdBufIdSlot_]->Reset(nullptr, false)) {
-    LogError("PAL failed CB reset!");
-    return false;
-  }
-  // Start command buffer building
-  Pal::CmdBufferBuildInfo cmdBuildInfo = {};
-  cmdBuildInfo.pMemAllocator = &vlAlloc_;
-  if (Pal::Result::Success != iCmdBuffs_[cmdBufIdSlot_]->Begin(cmdBuildInfo)) {
-    LogError("PAL failed CB building initialization!");
-    return false;
-  }
-
   // Clear dopp references
   palDoppRefs_.clear();
   palSdiRefs_.clear();
 
-  // Remove old memory references
-  if ((memReferences_.size() > 2048) || (residency_size_ > residency_limit_)) {
-    for (auto it = memReferences_.begin(); it != memReferences_.end();) {
-      if (it->second == cmdBufIdSlot_) {
-        palMems_.push_back(it->first->iMem());
-        residency_size_ -= it->first->iMem()->Desc().size;
-        it = memReferences_.erase(it);
-      } else {
-        ++it;
-      }
+  // Remove old memory references. Only the references of the reused slot are checked,
+  // so the cost depends on the changes since the last use of the slot
+  const bool evict = (memReferences_.size() > 2048) || (residency_size_ > residency_limit_);
+  auto& slotRefs = slotMemRefs_[cmdBufIdSlot_];
+  size_t keep = 0;
+  for (auto mem : slotRefs) {
+    auto it = memReferences_.find(mem);
+    // Skip the references, used in a later slot or removed already
+    if ((it == memReferences_.end()) || (it->second != cmdBufIdSlot_)) {
+      continue;
+    }
+    if (evict) {
+      palMems_.push_back(mem->iMem());
+      residency_size_ -= mem->iMem()->Desc().size;
+      memReferences_.erase(it);
+    } else {
+      slotRefs[keep++] = mem;
     }
   }
+  slotRefs.resize(keep);
   if (!gpu_.dev().settings().alwaysResident_ && palMems_.size() != 0) {
     iDev_->RemoveGpuMemoryReferences(palMems_.size(), &palMems_[0], iQueue_);
     palMems_.clear();
@@ -475,6 +482,8 @@ bool VirtualGPU::Queue::waitForEvent(uint id) {
   constexpr bool IbReuse = true;
   bool result = waifForFence<!IbReuse>(slotId);
   cmbBufIdRetired_ = id;
+  // The host waited anyway, so reset the idle buffers here instead of the next flush
+  recycle();
   return result;
 }
 
@@ -495,6 +504,49 @@ bool VirtualGPU::Queue::isDone(uint id) {
     return false;
   }
   cmbBufIdRetired_ = id;
+  recycle();
+  return true;
+}
+
+void VirtualGPU::Queue::recycle() {
+  for (uint i = 0; i < max_command_buffers_; ++i) {
+    if ((cmdBufState_[i] == CmdBufPending) &&
+        (Pal::Result::Success == iCmdFences_[i]->GetStatus())) {
+      resetCmdBuffer(i);
+    }
+  }
+}
+
+bool VirtualGPU::Queue::resetCmdBuffer(uint slot) {
+  // Reset command buffer, so CB chunks could be reused
+  if (Pal::Result::Success != iCmdBuffs_[slot]->Reset(nullptr, false)) {
+    LogError("PAL failed CB reset!");
+    return false;
+  }
+  cmdBufState_[slot] = CmdBufReady;
+  return true;
+}
+
+bool VirtualGPU::Queue::beginCmdBuffer(uint slot) {
+  if (cmdBufState_[slot] == CmdBufPending) {
+    // Make sure the slot isn't busy
+    if (Pal::Result::Success != iCmdFences_[slot]->GetStatus()) {
+      constexpr bool IbReuse = true;
+      waifForFence<IbReuse>(slot);
+    }
+    if (!resetCmdBuffer(slot)) {
+      return false;
+    }
+  }
+
+  // Start command buffer building
+  Pal::CmdBufferBuildInfo cmdBuildInfo = {};
+  cmdBuildInfo.pMemAllocator = &vlAlloc_;
+  if (Pal::Result::Success != iCmdBuffs_[slot]->Begin(cmdBuildInfo)) {
+    LogError("PAL failed CB building initialization!");
+    return false;
+  }
+  cmdBufState_[slot] = CmdBufBuilding;
   return true;
 }
 
@@ -549,22 +601,21 @@ void VirtualGPU::Queue::DumpMemoryReferences() const {
 }
 
 bool VirtualGPU::MemoryDependency::create(size_t numMemObj) {
-  if (numMemObj > 0) {
-    // Allocate the array of memory objects for dependency tracking
-    memObjectsInQueue_ = new MemoryState[numMemObj];
-    if (nullptr == memObjectsInQueue_) {
-      return false;
-    }
-    memset(memObjectsInQueue_, 0, sizeof(MemoryState) * numMemObj);
-    maxMemObjectsInQueue_ = numMemObj;
-  }
-
+  // The kernel arguments don't have a limit, hence the reservation is a hint only
+  kernelObjects_.reserve(numMemObj);
+  maxMemObjectsInQueue_ = numMemObj;
   return true;
 }
 
-void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memory, bool readOnly) {
-  bool flushL1Cache = false;
+void VirtualGPU::MemoryDependency::newKernel() {
+  // The objects of the last kernel become busy for the next one
+  for (const auto& it : kernelObjects_) {
+    busyRanges_.insert(it.start_, it.end_, it.readOnly_);
+  }
+  kernelObjects_.clear();
+}
 
+void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memory, bool readOnly) {
   if (maxMemObjectsInQueue_ == 0) {
     // Return earlier if tracking is disabled
     return;
@@ -572,35 +623,20 @@ void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memor
 
   uint64_t curStart = memory->vmAddress();
   uint64_t curEnd = curStart + memory->size();
+  bool flushL1Cache = false;
 
   if (memory->isModified(gpu) || !readOnly) {
     // Mark resource as modified
     memory->setModified(gpu, !readOnly);
 
-    // Loop through all memory objects in the queue and find dependency
+    // Check the busy ranges of the previous kernels for dependency
     // @note don't include objects from the current kernel
-    for (size_t j = 0; j < endMemObjectsInQueue_; ++j) {
-      // Check if the queue already contains this mem object and
-      // GPU operations aren't readonly
-      uint64_t busyStart = memObjectsInQueue_[j].start_;
-      uint64_t busyEnd = memObjectsInQueue_[j].end_;
-
-      // Check if the start inside the busy region
-      if ((((curStart >= busyStart) && (curStart < busyEnd)) ||
-           // Check if the end inside the busy region
-           ((curEnd > busyStart) && (curEnd <= busyEnd)) ||
-           // Check if the start/end cover the busy region
-           ((curStart <= busyStart) && (curEnd >= busyEnd))) &&
-          // If the buys region was written or the current one is for write
-          (!memObjectsInQueue_[j].readOnly_ || !readOnly)) {
-        flushL1Cache = true;
-        break;
-      }
-    }
+    flushL1Cache = busyRanges_.conflict(curStart, curEnd, readOnly);
   }
 
-  // Did we reach the limit?
-  if (maxMemObjectsInQueue_ <= numMemObjectsInQueue_) {
+  // Did we reach the limit? The same buffer in many kernels is a single range,
+  // so only a large set of distinct buffers can get here
+  if (maxMemObjectsInQueue_ <= busyRanges_.size()) {
     flushL1Cache = true;
   }
 
@@ -616,49 +652,19 @@ void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memor
   // Insert current memory object into the queue always,
   // since runtime calls flush before kernel execution and it has to keep
   // current kernel in tracking
-  memObjectsInQueue_[numMemObjectsInQueue_].start_ = curStart;
-  memObjectsInQueue_[numMemObjectsInQueue_].end_ = curEnd;
-  memObjectsInQueue_[numMemObjectsInQueue_].readOnly_ = readOnly;
-  numMemObjectsInQueue_++;
+  kernelObjects_.push_back({curStart, curEnd, readOnly});
 }
 
 void VirtualGPU::MemoryDependency::clear(bool all) {
-  if (numMemObjectsInQueue_ > 0) {
-    if (all) {
-      endMemObjectsInQueue_ = numMemObjectsInQueue_;
-    }
-
-    // If the current launch didn't start from the beginning, then move the data
-    if (0 != endMemObjectsInQueue_) {
-      size_t i, j;
-      // Preserve all objects from the current kernel
-      for (i = 0, j = endMemObjectsInQueue_; j < numMemObjectsInQueue_; i++, j++) {
-        memObjectsInQueue_[i].start_ = memObjectsInQueue_[j].start_;
-        memObjectsInQueue_[i].end_ = memObjectsInQueue_[j].end_;
-        memObjectsInQueue_[i].readOnly_ = memObjectsInQueue_[j].readOnly_;
-      }
-    } else if (numMemObjectsInQueue_ >= maxMemObjectsInQueue_) {
-      // note: The array growth shouldn't occur under the normal conditions,
-      // but in a case when SVM path sends the amount of SVM ptrs over
-      // the max size of kernel arguments
-      MemoryState* ptr = new MemoryState[maxMemObjectsInQueue_ << 1];
-      if (nullptr == ptr) {
-        numMemObjectsInQueue_ = 0;
-        return;
-      }
-      maxMemObjectsInQueue_ <<= 1;
-      memcpy(ptr, memObjectsInQueue_, sizeof(MemoryState) * numMemObjectsInQueue_);
-      delete[] memObjectsInQueue_;
-      memObjectsInQueue_ = ptr;
-    }
-
-    // Adjust the number of active objects
-    numMemObjectsInQueue_ -= endMemObjectsInQueue_;
-    endMemObjectsInQueue_ = 0;
+  busyRanges_.clear();
+  // Preserve all objects from the current kernel, unless it's a full clear
+  if (all) {
+    kernelObjects_.clear();
   }
 }
 
-VirtualGPU::DmaFlushMgmt::DmaFlushMgmt(const Device& dev) : cbWorkload_(0), dispatchSplitSize_(0) {
+VirtualGPU::DmaFlushMgmt::DmaFlushMgmt(const Device& dev)
+    : cbWorkload_(0), dispatchSplitSize_(0), cbTime_(0), cbId_(0) {
   aluCnt_ = dev.properties().gfxipProperties.shaderCore.numSimdsPerCu * dev.info().simdWidth_ *
       dev.info().maxComputeUnits_;
   maxDispatchWorkload_ = static_cast<uint64_t>(dev.info().maxEngineClockFrequency_) *
@@ -675,7 +681,31 @@ void VirtualGPU::DmaFlushMgmt::resetCbWorkload(const Device& dev) {
 }
 
 void VirtualGPU::DmaFlushMgmt::findSplitSize(const Device& dev, uint64_t threads,
-                                             uint instructions) {
+                                             uint instructions, const device::Kernel* kernel,
+                                             uint cbId) {
+  if (GPU_WORKLOAD_FEEDBACK) {
+    // A new command buffer starts with an empty budget
+    if (cbId != cbId_) {
+      cbId_ = cbId;
+      cbTime_ = 0;
+    }
+    const auto it = kernelTime_.find(kernel);
+    if (it != kernelTime_.end()) {
+      const uint64_t budget = static_cast<uint64_t>(GPU_WORKLOAD_CB_BUDGET) * 1000;
+      const double time = it->second * threads;
+      cbTime_ += static_cast<uint64_t>(time);
+      if (cbTime_ < budget) {
+        dispatchSplitSize_ = 0;
+      } else {
+        // The number of threads, which fit into the budget
+        dispatchSplitSize_ = static_cast<uint>(
+            std::min<double>(std::max<double>(budget / it->second, 1.0), UINT32_MAX));
+      }
+      return;
+    }
+    // Use the static estimation until the kernel has a measurement
+  }
+
   if (!dev.settings().splitSizeForWin7_) {
     dispatchSplitSize_ = 0;
     return;
@@ -694,6 +724,21 @@ void VirtualGPU::DmaFlushMgmt::findSplitSize(const Device& dev, uint64_t threads
   }
 }
 
+void VirtualGPU::DmaFlushMgmt::recordKernelTime(const device::Kernel* kernel, uint64_t threads,
+                                                uint64_t time) {
+  if ((threads == 0) || (time == 0)) {
+    return;
+  }
+  const double sample = static_cast<double>(time) / threads;
+  auto it = kernelTime_.find(kernel);
+  if (it == kernelTime_.end()) {
+    kernelTime_[kernel] = sample;
+  } else {
+    // Smooth the noise of the single dispatches
+    it->second = (it->second * 3 + sample) / 4;
+  }
+}
+
 bool VirtualGPU::DmaFlushMgmt::isCbReady(VirtualGPU& gpu, uint64_t threads, uint instructions) {
   bool cbReady = false;
   uint64_t workload = amd::alignUp(threads, 4 * aluCnt_) * instructions;
@@ -878,6 +923,9 @@ VirtualGPU::VirtualGPU(Device& device)
 
   queues_[MainEngine] = nullptr;
   queues_[SdmaEngine] = nullptr;
+  sdmaSplit_ = nullptr;
+  sdmaFork_ = nullptr;
+  sdmaJoin_ = nullptr;
 
   // The hostcall buffer for this vqueue is initialized on demand.
   hostcallBuffer_ = nullptr;
@@ -959,6 +1007,33 @@ bool VirtualGPU::create(bool profiling, uint deviceQueueSize, uint rtCUs,
       if (nullptr == queues_[SdmaEngine]) {
         return false;
       }
+      // Large copies are split with the next engine, the split is optional
+      if ((dev().numDMAEngines() > 1) && (dev().settings().sdmaSplitSize_ != 0)) {
+        Pal::QueueSemaphoreCreateInfo semInfo = {};
+        semInfo.maxCount = max_cmd_buffers;
+        auto createSemaphore = [&](Pal::IQueueSemaphore** sem) {
+          size_t semSize = dev().iDev()->GetQueueSemaphoreSize(semInfo, &result);
+          if (Pal::Result::Success != result) {
+            return false;
+          }
+          void* mem = amd::Os::alignedMalloc(semSize, 16);
+          if (Pal::Result::Success != dev().iDev()->CreateQueueSemaphore(semInfo, mem, sem)) {
+            amd::Os::alignedFree(mem);
+            *sem = nullptr;
+            return false;
+          }
+          return true;
+        };
+        if (!createSemaphore(&sdmaFork_) || !createSemaphore(&sdmaJoin_)) {
+          LogWarning("PAL failed to create the semaphores for the SDMA split!");
+        } else {
+          sdmaSplit_ = Queue::Create(*this, Pal::QueueTypeDma,
+                                     (sdma + 1) % dev().numDMAEngines(), cmdAllocator_,
+                                     amd::CommandQueue::RealTimeDisabled,
+                                     amd::CommandQueue::Priority::Normal, residency_limit,
+                                     max_cmd_buffers);
+        }
+      }
     }
   } else {
     LogError("Runtme couldn't find compute queues!");
@@ -1110,6 +1185,13 @@ VirtualGPU::~VirtualGPU() {
     // Destroy queues
     delete queues_[MainEngine];
     delete queues_[SdmaEngine];
+    delete sdmaSplit_;
+    for (auto sem : {sdmaFork_, sdmaJoin_}) {
+      if (sem != nullptr) {
+        sem->Destroy();
+        amd::Os::alignedFree(sem);
+      }
+    }
 
     if (nullptr != cmdAllocator_) {
       cmdAllocator_->Destroy();
@@ -1516,6 +1598,27 @@ void VirtualGPU::submitCopyMemory(amd::CopyMemoryCommand& vcmd) {
   profilingEnd(vcmd);
 }
 
+void VirtualGPU::submitCopyMemoryBatch(amd::CopyMemoryBatchCommand& vcmd) {
+  // Make sure VirtualGPU has an exclusive access to the resources
+  amd::ScopedLock lock(execution());
+
+  profilingBegin(vcmd);
+
+  for (const auto& it : vcmd.ranges()) {
+    amd::Coord3D srcOrigin(it.srcOffset_);
+    amd::Coord3D dstOrigin(it.dstOffset_);
+    amd::Coord3D size(it.size_);
+    amd::BufferRect rect;
+    if (!copyMemory(CL_COMMAND_COPY_BUFFER, *it.src_, *it.dst_, false, srcOrigin, dstOrigin,
+                    size, rect, rect)) {
+      vcmd.setStatus(CL_INVALID_OPERATION);
+      break;
+    }
+  }
+
+  profilingEnd(vcmd);
+}
+
 void VirtualGPU::submitSvmCopyMemory(amd::SvmCopyMemoryCommand& vcmd) {
   // Make sure VirtualGPU has an exclusive access to the resources
   amd::ScopedLock lock(execution());
@@ -2129,31 +2232,41 @@ void VirtualGPU::submitVirtualMap(amd::VirtualMapCommand& vcmd) {
   amd::ScopedLock lock(execution());
 
   profilingBegin(vcmd);
-  amd::Memory* va = amd::MemObjMap::FindVirtualMemObj(vcmd.ptr());
-  if (va == nullptr || !(va->getMemFlags() & CL_MEM_VA_RANGE_AMD)) {
-    profilingEnd(vcmd);
-    return;
-  }
-  pal::Memory* vaRange = dev().getGpuMemory(va);
-  Pal::IGpuMemory* memory = (vcmd.memory() == nullptr)? nullptr : dev().getGpuMemory(vcmd.memory())->iMem();
-  Pal::VirtualMemoryRemapRange range{
-    vaRange->iMem(),
-    0,
-    memory,
-    0,
-    vcmd.size(),
-    Pal::VirtualGpuMemAccessMode::NoAccess
-  };
-  Pal::Result result = queue(MainEngine).iQueue_->RemapVirtualMemoryPages(1, &range, false, nullptr);
+  std::vector<Pal::VirtualMemoryRemapRange> ranges;
+  ranges.reserve(vcmd.ranges().size());
+  for (const auto& it : vcmd.ranges()) {
+    amd::Memory* va = amd::MemObjMap::FindVirtualMemObj(it.ptr_);
+    if (va == nullptr || !(va->getMemFlags() & CL_MEM_VA_RANGE_AMD)) {
+      profilingEnd(vcmd);
+      return;
+    }
+    pal::Memory* vaRange = dev().getGpuMemory(va);
+    Pal::IGpuMemory* memory = (it.memory_ == nullptr) ? nullptr :
+        dev().getGpuMemory(it.memory_)->iMem();
+    ranges.push_back(Pal::VirtualMemoryRemapRange{
+      vaRange->iMem(),
+      static_cast<Pal::gpusize>(reinterpret_cast<const_address>(it.ptr_) -
+                                reinterpret_cast<const_address>(va->getSvmPtr())),
+      memory,
+      0,
+      it.size_,
+      Pal::VirtualGpuMemAccessMode::NoAccess
+    });
+  }
+  // Update all page mappings of the command with a single remap call
+  Pal::Result result = queue(MainEngine).iQueue_->RemapVirtualMemoryPages(
+      static_cast<uint32_t>(ranges.size()), ranges.data(), false, nullptr);
   if (result == Pal::Result::Success) {
-    if (vcmd.memory() != nullptr) {
-      // assert the va wasn't mapped already
-      assert(amd::MemObjMap::FindMemObj(vcmd.ptr()) == nullptr);
-      amd::MemObjMap::AddMemObj(vcmd.ptr(), vcmd.memory());
-    } else {
-      // assert the va is mapped and needs to be removed
-      assert(amd::MemObjMap::FindMemObj(vcmd.ptr()) != nullptr);
-      amd::MemObjMap::RemoveMemObj(vcmd.ptr());
+    for (const auto& it : vcmd.ranges()) {
+      if (it.memory_ != nullptr) {
+        // assert the va wasn't mapped already
+        assert(amd::MemObjMap::FindMemObj(it.ptr_) == nullptr);
+        amd::MemObjMap::AddMemObj(it.ptr_, it.memory_);
+      } else {
+        // assert the va is mapped and needs to be removed
+        assert(amd::MemObjMap::FindMemObj(it.ptr_) != nullptr);
+        amd::MemObjMap::RemoveMemObj(it.ptr_);
+      }
     }
   }
   profilingEnd(vcmd);
@@ -2519,7 +2632,9 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes, const
   // Avoid flushing when PerfCounter is enabled, to make sure PerfStart/dispatch/PerfEnd
   // are in the same cmdBuffer
   if (!state_.perfCounterEnabled_) {
-    dmaFlushMgmt_.findSplitSize(dev(), sizes.global().product(), hsaKernel.aqlCodeSize());
+    dmaFlushMgmt_.findSplitSize(dev(), sizes.global().product(), hsaKernel.aqlCodeSize(),
+                                kernel.getDeviceKernel(dev()),
+                                queues_[MainEngine]->cmdBufId());
     if (dmaFlushMgmt().dispatchSplitSize() != 0) {
       needFlush = true;
     }
@@ -2706,6 +2821,9 @@ void VirtualGPU::releaseMemory(GpuMemoryReference* mem) {
   queues_[MainEngine]->removeCmdMemRef(mem);
   if (!dev().settings().disableSdma_) {
     queues_[SdmaEngine]->removeCmdMemRef(mem);
+    if (sdmaSplit_ != nullptr) {
+      sdmaSplit_->removeCmdMemRef(mem);
+    }
   }
 }
 
@@ -3236,8 +3354,9 @@ bool VirtualGPU::allocConstantBuffers() {
 }
 
 void VirtualGPU::profilingBegin(amd::Command& command, bool drmProfiling) {
-  // Is profiling enabled?
-  if (command.profilingInfo().enabled_) {
+  // Is profiling enabled? The workload feedback needs the time of every kernel
+  if (command.profilingInfo().enabled_ ||
+      (GPU_WORKLOAD_FEEDBACK && (command.type() == CL_COMMAND_NDRANGE_KERNEL))) {
     // Allocate a timestamp object from the cache
     TimeStamp* ts = tsCache_->allocTimeStamp();
     if (nullptr == ts) {
@@ -3278,6 +3397,16 @@ bool VirtualGPU::profilingCollectResults(CommandBatch* cb, const amd::Event* wai
   // Wait for the last known GPU events on all engines
   waitEventLock(cb);
 
+  // Read all time stamps of the batch at once
+  std::vector<TimeStamp*> timeStamps;
+  for (current = first; current != nullptr; current = current->getNext()) {
+    TimeStamp* ts = reinterpret_cast<TimeStamp*>(current->data());
+    if (ts != nullptr) {
+      timeStamps.push_back(ts);
+    }
+  }
+  tsCache_->readback(timeStamps);
+
   // Find the CPU base time of the entire command batch execution
   uint64_t endTimeStamp = amd::Os::timeNanos();
   uint64_t startTimeStamp = endTimeStamp;
@@ -3314,6 +3443,12 @@ bool VirtualGPU::profilingCollectResults(CommandBatch* cb, const amd::Event* wai
       ts->value(&startTimeStamp, &endTimeStamp);
       endTimeStamp -= readjustTimeGPU_;
       startTimeStamp -= readjustTimeGPU_;
+      if (GPU_WORKLOAD_FEEDBACK && (first->type() == CL_COMMAND_NDRANGE_KERNEL)) {
+        auto& vcmd = static_cast<amd::NDRangeKernelCommand&>(*first);
+        dmaFlushMgmt_.recordKernelTime(vcmd.kernel().getDeviceKernel(dev()),
+                                       vcmd.sizes().global().product(),
+                                       endTimeStamp - startTimeStamp);
+      }
       // Destroy the TimeStamp object
       tsCache_->freeTimeStamp(ts);
       first->setData(nullptr);
@@ -3811,55 +3946,121 @@ bool VirtualGPU::validateSdmaOverlap(const Resource& src, const Resource& dst) {
   return false;
 }
 
+bool VirtualGPU::splitSdmaCopy(const Resource& src, const Resource& dst,
+                               const Pal::MemoryCopyRegion& region) {
+  if ((sdmaSplit_ == nullptr) || (engineID_ != SdmaEngine) ||
+      (region.copySize < dev().settings().sdmaSplitSize_)) {
+    return false;
+  }
+  Queue& sdma = *queues_[SdmaEngine];
+  Queue& split = *sdmaSplit_;
+
+  // Submit the earlier SDMA work, so the split half starts after it
+  if (!sdma.flush()) {
+    return false;
+  }
+  {
+    amd::ScopedLock l(sdma.lock_);
+    sdma.iQueue_->SignalQueueSemaphore(sdmaFork_, 0);
+  }
+  {
+    amd::ScopedLock l(split.lock_);
+    split.iQueue_->WaitQueueSemaphore(sdmaFork_, 0);
+  }
+
+  // Both engines copy a half, aligned to the SDMA copy granularity
+  Pal::MemoryCopyRegion first = region;
+  first.copySize = amd::alignUp(region.copySize / 2, 256);
+  Pal::MemoryCopyRegion second = region;
+  second.srcOffset += first.copySize;
+  second.dstOffset += first.copySize;
+  second.copySize -= first.copySize;
+
+  split.addCmdMemRef(src.memRef());
+  split.addCmdMemRef(dst.memRef());
+  split.iCmd()->CmdCopyMemory(*src.iMem(), *dst.iMem(), 1, &second);
+  if (!split.flush()) {
+    LogError("PAL failed to submit the split SDMA copy!");
+  }
+  {
+    amd::ScopedLock l(split.lock_);
+    split.iQueue_->SignalQueueSemaphore(sdmaJoin_, 0);
+  }
+
+  sdma.iCmd()->CmdCopyMemory(*src.iMem(), *dst.iMem(), 1, &first);
+  // Join, the next command buffer of SDMA queue, hence the event of the copy, waits for both
+  sdma.flush();
+  {
+    amd::ScopedLock l(sdma.lock_);
+    sdma.iQueue_->WaitQueueSemaphore(sdmaJoin_, 0);
+  }
+  return true;
+}
+
 void VirtualGPU::submitTransferBufferFromFile(amd::TransferBufferFileCommand& cmd) {
-  size_t copySize = cmd.size()[0];
-  size_t fileOffset = cmd.fileOffset();
+  const size_t copySize = cmd.size()[0];
+  const size_t fileOffset = cmd.fileOffset();
+  const size_t memOffset = cmd.origin()[0];
   Memory* mem = dev().getGpuMemory(&cmd.memory());
-  uint idx = 0;
+  const uint numStaging = cmd.numStaging();
+  const size_t chunkSize = amd::TransferBufferFileCommand::stagingSize();
+  const size_t numChunks = (copySize + chunkSize - 1) / chunkSize;
+  auto chunk = [&](size_t k) { return std::min(chunkSize, copySize - k * chunkSize); };
 
   assert((cmd.type() == CL_COMMAND_READ_SSG_FILE_AMD) ||
          (cmd.type() == CL_COMMAND_WRITE_SSG_FILE_AMD));
   const bool writeBuffer(cmd.type() == CL_COMMAND_READ_SSG_FILE_AMD);
 
   if (writeBuffer) {
-    size_t dstOffset = cmd.origin()[0];
-    while (copySize > 0) {
+    // Read the whole ring ahead, so the file I/O of the next chunks overlaps the DMA
+    for (uint i = 0; i < numStaging; ++i) {
+      Memory* staging = dev().getGpuMemory(&cmd.staging(i));
+      cmd.startFileIo(i, staging->cpuMap(*this), fileOffset + i * chunkSize, chunk(i));
+    }
+    for (size_t k = 0; k < numChunks; ++k) {
+      // Refill the buffer of the previous chunk, the map waits for its DMA
+      if ((k > 0) && ((k - 1 + numStaging) < numChunks)) {
+        const size_t next = k - 1 + numStaging;
+        Memory* staging = dev().getGpuMemory(&cmd.staging((k - 1) % numStaging));
+        cmd.startFileIo((k - 1) % numStaging, staging->cpuMap(*this),
+                        fileOffset + next * chunkSize, chunk(next));
+      }
+      const uint idx = k % numStaging;
       Memory* staging = dev().getGpuMemory(&cmd.staging(idx));
-      size_t dstSize = amd::TransferBufferFileCommand::StagingBufferSize;
-      dstSize = std::min(dstSize, copySize);
-      void* dstBuffer = staging->cpuMap(*this);
-      if (!cmd.file()->transferBlock(writeBuffer, dstBuffer, staging->size(), fileOffset, 0,
-                                     dstSize)) {
+      if (!cmd.finishFileIo(idx)) {
+        cmd.finishFileIo();
         cmd.setStatus(CL_INVALID_OPERATION);
         return;
       }
       staging->cpuUnmap(*this);
 
-      blitMgr().copyBuffer(*staging, *mem, 0, dstOffset, dstSize, false);
+      blitMgr().copyBuffer(*staging, *mem, 0, memOffset + k * chunkSize, chunk(k), false);
       flushDMA(staging->getGpuEvent(*this)->engineId_);
-      fileOffset += dstSize;
-      dstOffset += dstSize;
-      copySize -= dstSize;
     }
   } else {
-    size_t srcOffset = cmd.origin()[0];
-    while (copySize > 0) {
+    for (size_t k = 0; k < numChunks; ++k) {
+      const uint idx = k % numStaging;
       Memory* staging = dev().getGpuMemory(&cmd.staging(idx));
-      size_t srcSize = amd::TransferBufferFileCommand::StagingBufferSize;
-      srcSize = std::min(srcSize, copySize);
-      blitMgr().copyBuffer(*mem, *staging, srcOffset, 0, srcSize, false);
-
-      void* srcBuffer = staging->cpuMap(*this);
-      if (!cmd.file()->transferBlock(writeBuffer, srcBuffer, staging->size(), fileOffset, 0,
-                                     srcSize)) {
-        cmd.setStatus(CL_INVALID_OPERATION);
-        return;
+      // The staging buffer is free after the write of its previous chunk
+      if (k >= numStaging) {
+        if (!cmd.finishFileIo(idx)) {
+          cmd.finishFileIo();
+          cmd.setStatus(CL_INVALID_OPERATION);
+          return;
+        }
+        staging->cpuUnmap(*this);
       }
-      staging->cpuUnmap(*this);
+      blitMgr().copyBuffer(*mem, *staging, memOffset + k * chunkSize, 0, chunk(k), false);
 
-      fileOffset += srcSize;
-      srcOffset += srcSize;
-      copySize -= srcSize;
+      // The map waits for the DMA, then the write runs along with the next chunks
+      cmd.startFileIo(idx, staging->cpuMap(*this), fileOffset + k * chunkSize, chunk(k));
+    }
+    const bool result = cmd.finishFileIo();
+    for (uint i = 0; i < numStaging; ++i) {
+      dev().getGpuMemory(&cmd.staging(i))->cpuUnmap(*this);
+    }
+    if (!result) {
+      cmd.setStatus(CL_INVALID_OPERATION);
     }
   }
 }
@@ -30,6 +30,7 @@
 #include "device/pal/palgpuopen.hpp"
 #include "platform/commandqueue.hpp"
 #include "device/blit.hpp"
+#include "device/devmemranges.hpp"
 #include "palUtil.h"
 #include "palCmdBuffer.h"
 #include "palCmdAllocator.h"
@@ -65,6 +66,13 @@ class VirtualGPU : public device::VirtualDevice {
     static constexpr uint64_t WaitTimeoutInNsec = 6000000000;
     static constexpr uint64_t PollIntervalInNsec = 200000;
 
+    //! States of a command buffer in the ring
+    enum CmdBufState : uint8_t {
+      CmdBufReady = 0,  //!< Reset and ready for building
+      CmdBufBuilding,   //!< Current buffer for the commands
+      CmdBufPending     //!< Submitted, the reset waits for the fence
+    };
+
     Queue(const Queue&) = delete;
     Queue& operator=(const Queue&) = delete;
 
@@ -84,6 +92,8 @@ class VirtualGPU : public device::VirtualDevice {
           iQueue_(nullptr),
           iCmdBuffs_(max_command_buffers, nullptr),
           iCmdFences_(max_command_buffers, nullptr),
+          cmdBufState_(max_command_buffers, CmdBufReady),
+          slotMemRefs_(max_command_buffers),
           last_kernel_(nullptr),
           gpu_(gpu),
           iDev_(iDev),
@@ -163,6 +173,10 @@ class VirtualGPU : public device::VirtualDevice {
 
     bool isDone(uint id);
 
+    //! Resets the submitted command buffers with a signaled fence, so the next flush
+    //! doesn't wait on the reset
+    void recycle();
+
     Pal::ICmdBuffer* iCmd() const { return iCmdBuffs_[cmdBufIdSlot_]; }
 
     uint cmdBufId() const { return cmdBufIdCurrent_; }
@@ -173,10 +187,18 @@ class VirtualGPU : public device::VirtualDevice {
     Pal::IQueue* iQueue_;                      //!< PAL queue object
     std::vector<Pal::ICmdBuffer*> iCmdBuffs_;  //!< PAL command buffers
     std::vector<Pal::IFence*> iCmdFences_;     //!< PAL fences, associated with CMD
+    std::vector<CmdBufState> cmdBufState_;     //!< States of the command buffers
     const amd::Kernel* last_kernel_;           //!< Last submitted kernel
 
    private:
     void DumpMemoryReferences() const;
+
+    //! Resets the command buffer in \a slot, the chunks stay allocated for the reuse
+    bool resetCmdBuffer(uint slot);
+
+    //! Starts the command buffer in \a slot, waits for the fence if it's still busy
+    bool beginCmdBuffer(uint slot);
+
     const VirtualGPU& gpu_;  //!< OCL virtual GPU object
     Pal::IDevice* iDev_;     //!< PAL device
     uint cmdBufIdSlot_;      //!< Command buffer ID slot for submissions
@@ -184,6 +206,9 @@ class VirtualGPU : public device::VirtualDevice {
     uint cmbBufIdRetired_;   //!< The last retired command buffer ID
     uint cmdCnt_;            //!< Counter of commands
     std::unordered_map<GpuMemoryReference*, uint> memReferences_;
+    //! The references, last used in every command buffer slot. Only these references are
+    //! candidates for the removal, when the slot is reused
+    std::vector<std::vector<GpuMemoryReference*>> slotMemRefs_;
     Util::VirtualLinearAllocator vlAlloc_;
     std::vector<Pal::GpuMemoryRef> palMemRefs_;
     std::vector<Pal::IGpuMemory*> palMems_;
@@ -238,16 +263,13 @@ class VirtualGPU : public device::VirtualDevice {
   class MemoryDependency : public amd::EmbeddedObject {
    public:
     //! Default constructor
-    MemoryDependency()
-        : memObjectsInQueue_(nullptr), numMemObjectsInQueue_(0), maxMemObjectsInQueue_(0) {}
-
-    ~MemoryDependency() { delete[] memObjectsInQueue_; }
+    MemoryDependency() : maxMemObjectsInQueue_(0) {}
 
     //! Creates memory dependecy structure
     bool create(size_t numMemObj);
 
     //! Notify the tracker about new kernel
-    void newKernel() { endMemObjectsInQueue_ = numMemObjectsInQueue_; }
+    void newKernel();
 
     //! Validates memory object on dependency
     void validate(VirtualGPU& gpu, const Memory* memory, bool readOnly);
@@ -269,10 +291,9 @@ class VirtualGPU : public device::VirtualDevice {
       bool readOnly_;   //! Current GPU state in the queue
     };
 
-    MemoryState* memObjectsInQueue_;  //!< Memory object state in the queue
-    size_t endMemObjectsInQueue_;     //!< End of mem objects in the queue
-    size_t numMemObjectsInQueue_;     //!< Number of mem objects in the queue
-    size_t maxMemObjectsInQueue_;     //!< Maximum number of mem objects in the queue
+    device::MemoryRanges busyRanges_;         //!< Busy ranges of the previous kernels
+    std::vector<MemoryState> kernelObjects_;  //!< Memory objects of the current kernel
+    size_t maxMemObjectsInQueue_;             //!< Maximum number of busy ranges in the queue
   };
 
 
@@ -284,9 +305,17 @@ class VirtualGPU : public device::VirtualDevice {
     void resetCbWorkload(const Device& dev);
 
     // Finds split size for the current dispatch
-    void findSplitSize(const Device& dev,  //!< GPU device object
-                       uint64_t threads,   //!< Total number of execution threads
-                       uint instructions   //!< Number of ALU instructions
+    void findSplitSize(const Device& dev,             //!< GPU device object
+                       uint64_t threads,              //!< Total number of execution threads
+                       uint instructions,             //!< Number of ALU instructions
+                       const device::Kernel* kernel,  //!< Device kernel of the dispatch
+                       uint cbId                      //!< Current command buffer ID
+    );
+
+    // Updates the measured execution time of a kernel
+    void recordKernelTime(const device::Kernel* kernel,  //!< Device kernel
+                          uint64_t threads,              //!< Total number of execution threads
+                          uint64_t time                  //!< Execution time in ns
     );
 
     // Returns TRUE if DMA command buffer is ready for a flush
@@ -304,6 +333,11 @@ class VirtualGPU : public device::VirtualDevice {
     uint64_t cbWorkload_;           //!< Current number of operations in DMA command buffer
     uint aluCnt_;                   //!< All ALUs on the chip
     uint dispatchSplitSize_;        //!< Dispath split size in elements
+
+    //! Average time of a thread in ns, measured for every kernel with GPU_WORKLOAD_FEEDBACK
+    std::unordered_map<const device::Kernel*, double> kernelTime_;
+    uint64_t cbTime_;  //!< Estimated GPU time of the current command buffer in ns
+    uint cbId_;        //!< Command buffer ID of the estimation
   };
 
  public:
@@ -349,6 +383,7 @@ class VirtualGPU : public device::VirtualDevice {
   virtual void submitSvmUnmapMemory(amd::SvmUnmapMemoryCommand& cmd);
   virtual void submitTransferBufferFromFile(amd::TransferBufferFileCommand& cmd);
   virtual void submitVirtualMap(amd::VirtualMapCommand& cmd);
+  virtual void submitCopyMemoryBatch(amd::CopyMemoryBatchCommand& cmd);
 
   void submitExternalSemaphoreCmd(amd::ExternalSemaphoreCmd& cmd);
 
@@ -549,6 +584,14 @@ class VirtualGPU : public device::VirtualDevice {
                            const Resource& dst   //!< Destination resource for SDMA transfer
   );
 
+  //! Splits a large SDMA buffer copy across 2 SDMA engines. The current SDMA command buffer
+  //! signals the second engine and waits for it, so the next event covers both halves.
+  //! Returns FALSE if the copy wasn't split
+  bool splitSdmaCopy(const Resource& src,                //!< Source resource for SDMA transfer
+                     const Resource& dst,                //!< Destination resource for SDMA transfer
+                     const Pal::MemoryCopyRegion& region  //!< Copy region of the whole transfer
+  );
+
   //! Checks if RGP capture is enabled
   bool rgpCaptureEna() const { return state_.rgpCaptureEnabled_; }
 
@@ -691,6 +734,9 @@ class VirtualGPU : public device::VirtualDevice {
   Memory* hsaQueueMem_;                     //!< Memory for the amd_queue_t object
   Pal::ICmdAllocator* cmdAllocator_;        //!< Command buffer allocator
   Queue* queues_[AllEngines];               //!< HW queues for all engines
+  Queue* sdmaSplit_;                        //!< SDMA queue on another engine for the splits
+  Pal::IQueueSemaphore* sdmaFork_;          //!< Starts the split half after the earlier SDMA work
+  Pal::IQueueSemaphore* sdmaJoin_;          //!< Signals the split half completion to SDMA queue
   MemoryRange sdmaRange_;                   //!< SDMA memory range for write access
 
   void* hostcallBuffer_;  //!< Hostcall buffer
@@ -26,6 +26,15 @@
 #include "device/rocm/rocsched.hpp"
 #include "utils/debug.hpp"
 #include <algorithm>
+#include <limits>
+
+// ROCr selects the SDMA engine for the async copies since the 1.2 interface of the AMD extension
+#if defined(HSA_AMD_INTERFACE_VERSION_MAJOR) && \
+    ((HSA_AMD_INTERFACE_VERSION_MAJOR > 1) || (HSA_AMD_INTERFACE_VERSION_MINOR >= 2))
+#define ROCCLR_SDMA_ENGINE_COPY 1
+#else
+#define ROCCLR_SDMA_ENGINE_COPY 0
+#endif
 
 namespace roc {
 DmaBlitManager::DmaBlitManager(VirtualGPU& gpu, Setup setup)
@@ -646,7 +655,9 @@ bool DmaBlitManager::hsaCopy(const Memory& srcMemory, const Memory& dstMemory,
   // This workaround is needed for performance to get around the slowdown
   // caused to SDMA engine powering down if its not active. Forcing agents
   // to amdgpu device causes rocr to take blit path internally.
-  if (size[0] <= dev().settings().sdmaCopyThreshold_) {
+  // The threshold may come from the calibration of the engines and depends on the queue load
+  if (size[0] <= dev().sdmaCopyThreshold(srcMemory.isHostMemDirectAccess(),
+                                         gpu().IsPendingDispatch())) {
     srcAgent = dstAgent = dev().getBackendDevice();
   }
 
@@ -659,26 +670,98 @@ bool DmaBlitManager::hsaCopy(const Memory& srcMemory, const Memory& dstMemory,
     engine = HwQueueEngine::SdmaRead;
   }
 
+  uint32_t engines[kMaxStripeEngines];
+  const uint32_t numEngines = stripeEngines(srcMemory, dstMemory, srcAgent, dstAgent, size[0],
+                                            engines);
+
   auto wait_events = gpu().Barriers().WaitingSignal(engine);
-  hsa_signal_t active = gpu().Barriers().ActiveSignal(kInitSignalValueOne, gpu().timestamp());
+  // Every copy decrements the completion signal, hence it waits for all stripes
+  hsa_signal_t active = gpu().Barriers().ActiveSignal(numEngines, gpu().timestamp());
 
   // Use SDMA to transfer the data
   ClPrint(amd::LOG_DEBUG, amd::LOG_COPY,
-          "HSA Asycn Copy wait_event=0x%zx, completion_signal=0x%zx",
-          (wait_events.size() != 0) ? wait_events[0].handle : 0, active.handle);
+          "HSA Asycn Copy wait_event=0x%zx, completion_signal=0x%zx, engines=%d",
+          (wait_events.size() != 0) ? wait_events[0].handle : 0, active.handle, numEngines);
+
+  size_t offset = 0;
+  uint32_t submitted = 0;
+#if ROCCLR_SDMA_ENGINE_COPY
+  if (numEngines > 1) {
+    // Page aligned stripes, the last engine copies the remainder
+    const size_t stripe = amd::alignUp(size[0] / numEngines, 4 * Ki);
+    for (; (submitted < numEngines) && (offset < size[0]); ++submitted) {
+      const size_t copySize = std::min(stripe, size[0] - offset);
+      status = hsa_amd_memory_async_copy_on_engine(dst + offset, dstAgent, src + offset, srcAgent,
+          copySize, wait_events.size(), wait_events.data(), active,
+          static_cast<hsa_amd_sdma_engine_id_t>(engines[submitted]), true);
+      if (status != HSA_STATUS_SUCCESS) {
+        LogPrintfWarning("Hsa copy on SDMA engine 0x%x failed with code %d", engines[submitted],
+                         status);
+        break;
+      }
+      offset += copySize;
+    }
+  }
+#endif  // ROCCLR_SDMA_ENGINE_COPY
 
-  status = hsa_amd_memory_async_copy(dst, dstAgent, src, srcAgent,
-      size[0], wait_events.size(), wait_events.data(), active);
+  status = HSA_STATUS_SUCCESS;
+  if (offset < size[0]) {
+    // Release the counts of the stripes, which weren't submitted, except the final copy
+    if ((numEngines - submitted) > 1) {
+      hsa_signal_subtract_relaxed(active, numEngines - submitted - 1);
+    }
+    status = hsa_amd_memory_async_copy(dst + offset, dstAgent, src + offset, srcAgent,
+        size[0] - offset, wait_events.size(), wait_events.data(), active);
+  } else if (submitted < numEngines) {
+    // The copy didn't need all engines
+    hsa_signal_subtract_relaxed(active, numEngines - submitted);
+  }
   if (status == HSA_STATUS_SUCCESS) {
     gpu().addSystemScope();
   } else {
-    gpu().Barriers().ResetCurrentSignal();
+    if (submitted == 0) {
+      gpu().Barriers().ResetCurrentSignal();
+    } else {
+      // The submitted stripes still have to complete the signal
+      hsa_signal_subtract_relaxed(active, 1);
+    }
     LogPrintfError("Hsa copy from host to device failed with code %d", status);
   }
 
   return (status == HSA_STATUS_SUCCESS);
 }
 
+// ================================================================================================
+uint32_t DmaBlitManager::stripeEngines(const Memory& srcMemory, const Memory& dstMemory,
+                                       hsa_agent_t srcAgent, hsa_agent_t dstAgent, size_t size,
+                                       uint32_t* engines) const {
+  uint32_t numEngines = 0;
+#if ROCCLR_SDMA_ENGINE_COPY
+  // Copies inside the device go to the blit kernels, and profiling needs a signal per copy
+  if ((dev().settings().sdmaStripeSize_ == 0) || (size < dev().settings().sdmaStripeSize_) ||
+      (srcAgent.handle == dstAgent.handle) || (gpu().timestamp() != nullptr)) {
+    return 1;
+  }
+
+  uint32_t mask = 0;
+  if (HSA_STATUS_SUCCESS != hsa_amd_memory_copy_engine_status(dstAgent, srcAgent, &mask)) {
+    return 1;
+  }
+
+  // A couple of engines saturate PCIe, but xGMI bandwidth scales with the number of engines
+  uint32_t maxEngines = kMaxPcieStripeEngines;
+  if ((&srcMemory.dev() != &dstMemory.dev()) && srcMemory.dev().isXgmiPeer(dstMemory.dev())) {
+    maxEngines = kMaxStripeEngines;
+  }
+  for (uint32_t bit = 0; (bit < 32) && (numEngines < maxEngines); ++bit) {
+    if ((mask & (1u << bit)) != 0) {
+      engines[numEngines++] = 1u << bit;
+    }
+  }
+#endif  // ROCCLR_SDMA_ENGINE_COPY
+  return (numEngines > 1) ? numEngines : 1;
+}
+
 // ================================================================================================
 bool DmaBlitManager::hsaCopyStaged(const_address hostSrc, address hostDst, size_t size,
                                    address staging, bool hostToDev) const {
@@ -695,75 +778,114 @@ bool DmaBlitManager::hsaCopyStaged(const_address hostSrc, address hostDst, size_
     return (status == HSA_STATUS_SUCCESS);
   }
 
-  size_t totalSize = size;
-  size_t offset = 0;
-
-  address hsaBuffer = staging;
+  const size_t chunkSize = dev().settings().stagedXferSize_;
+  const size_t numChunks = (size + chunkSize - 1) / chunkSize;
 
-  // Allocate requested size of memory
-  while (totalSize > 0) {
-    size = std::min(totalSize, dev().settings().stagedXferSize_);
+  // Extra staged buffers let the CPU copy of a chunk overlap the SDMA copy of the previous ones
+  Device::XferBuffers& xferBuffers = hostToDev ? dev().xferWrite() : dev().xferRead();
+  const size_t depth = std::min({static_cast<size_t>(dev().settings().stagedXferDepth_),
+                                 Device::XferBuffers::MaxXferBufListSize, numChunks});
 
-    // Copy data from Host to Device
-    if (hostToDev) {
-      // This workaround is needed for performance to get around the slowdown
-      // caused to SDMA engine powering down if its not active. Forcing agents
-      // to amdgpu device causes rocr to take blit path internally.
-      const hsa_agent_t srcAgent =
-          (size <= dev().settings().sdmaCopyThreshold_) ? dev().getBackendDevice() : dev().getCpuAgent();
-
-      HwQueueEngine engine = HwQueueEngine::Unknown;
-      if (srcAgent.handle == dev().getBackendDevice().handle) {
-        engine = HwQueueEngine::SdmaWrite;
-      }
-      gpu().Barriers().SetActiveEngine(engine);
-      hsa_signal_t active = gpu().Barriers().ActiveSignal(kInitSignalValueOne, gpu().timestamp());
-
-      memcpy(hsaBuffer, hostSrc + offset, size);
-      ClPrint(amd::LOG_DEBUG, amd::LOG_COPY,
-              "HSA Async Copy completion_signal=0x%zx", active.handle);
-      status = hsa_amd_memory_async_copy(hostDst + offset, dev().getBackendDevice(), hsaBuffer,
-                                         srcAgent, size, 0, nullptr, active);
-      if (status != HSA_STATUS_SUCCESS) {
-        gpu().Barriers().ResetCurrentSignal();
-        LogPrintfError("Hsa copy from host to device failed with code %d", status);
-        return false;
-      }
-      gpu().Barriers().WaitCurrent();
-      totalSize -= size;
-      offset += size;
-      continue;
-    }
+  struct Stage {
+    address buffer_;        //!< Staged buffer of the stage
+    Memory* memory_;        //!< Staged memory object, if it was acquired for the pipeline
+    hsa_signal_t signal_;   //!< Completion signal of the SDMA copy
+    bool busy_;             //!< True if the SDMA copy is in flight
+  };
+  Stage stages[Device::XferBuffers::MaxXferBufListSize] = {};
+  stages[0].buffer_ = staging;
+  for (size_t i = 1; i < depth; ++i) {
+    stages[i].memory_ = &xferBuffers.acquire();
+    stages[i].buffer_ = stages[i].memory_->getDeviceMemory();
+  }
 
+  // Submits the SDMA copy of the chunk between the staged buffer and the device memory
+  auto submitChunk = [&](Stage& stage, size_t chunk) {
+    const size_t offset = chunk * chunkSize;
+    const size_t copySize = std::min(chunkSize, size - offset);
     // This workaround is needed for performance to get around the slowdown
     // caused to SDMA engine powering down if its not active. Forcing agents
     // to amdgpu device causes rocr to take blit path internally.
-    const hsa_agent_t dstAgent =
-        (size <= dev().settings().sdmaCopyThreshold_) ? dev().getBackendDevice() : dev().getCpuAgent();
+    const hsa_agent_t hostAgent =
+        (copySize <= dev().sdmaCopyThreshold(hostToDev, gpu().IsPendingDispatch())) ?
+        dev().getBackendDevice() : dev().getCpuAgent();
 
     HwQueueEngine engine = HwQueueEngine::Unknown;
-    if (dstAgent.handle == dev().getBackendDevice().handle) {
-      engine = HwQueueEngine::SdmaRead;
+    if (hostAgent.handle == dev().getBackendDevice().handle) {
+      engine = hostToDev ? HwQueueEngine::SdmaWrite : HwQueueEngine::SdmaRead;
     }
     gpu().Barriers().SetActiveEngine(engine);
     hsa_signal_t active = gpu().Barriers().ActiveSignal(kInitSignalValueOne, gpu().timestamp());
 
-    // Copy data from Device to Host
     ClPrint(amd::LOG_DEBUG, amd::LOG_COPY,
             "HSA Async Copy completion_signal=0x%zx", active.handle);
-    status = hsa_amd_memory_async_copy(hsaBuffer, dstAgent, hostSrc + offset,
-        dev().getBackendDevice(), size, 0, nullptr, active);
-    if (status == HSA_STATUS_SUCCESS) {
-      gpu().Barriers().WaitCurrent();
-      memcpy(hostDst + offset, hsaBuffer, size);
-    } else {
+    hsa_status_t status = hostToDev ?
+        hsa_amd_memory_async_copy(hostDst + offset, dev().getBackendDevice(), stage.buffer_,
+                                  hostAgent, copySize, 0, nullptr, active) :
+        hsa_amd_memory_async_copy(stage.buffer_, hostAgent, hostSrc + offset,
+                                  dev().getBackendDevice(), copySize, 0, nullptr, active);
+    if (status != HSA_STATUS_SUCCESS) {
       gpu().Barriers().ResetCurrentSignal();
-      LogPrintfError("Hsa copy from device to host failed with code %d", status);
+      LogPrintfError("Hsa copy %s failed with code %d",
+                     hostToDev ? "from host to device" : "from device to host", status);
       return false;
     }
-    totalSize -= size;
-    offset += size;
+    stage.signal_ = active;
+    stage.busy_ = true;
+    return true;
+  };
+
+  // Waits for the SDMA copy of the stage, so its staged buffer can be accessed
+  auto waitStage = [&](Stage& stage) {
+    if (stage.busy_) {
+      stage.busy_ = false;
+      if (!WaitForSignalMode(stage.signal_, gpu().dev().GetWaitMode())) {
+        LogPrintfError("Failed signal [0x%lx] wait", stage.signal_.handle);
+        return false;
+      }
+    }
+    return true;
+  };
+
+  bool result = true;
+  if (hostToDev) {
+    for (size_t chunk = 0; result && (chunk < numChunks); ++chunk) {
+      Stage& stage = stages[chunk % depth];
+      const size_t offset = chunk * chunkSize;
+      result = waitStage(stage);
+      if (result) {
+        dev().hostCopy(stage.buffer_, hostSrc + offset, std::min(chunkSize, size - offset));
+        result = submitChunk(stage, chunk);
+      }
+    }
+  } else {
+    for (size_t chunk = 0; result && (chunk < depth); ++chunk) {
+      result = submitChunk(stages[chunk], chunk);
+    }
+    for (size_t chunk = 0; result && (chunk < numChunks); ++chunk) {
+      Stage& stage = stages[chunk % depth];
+      const size_t offset = chunk * chunkSize;
+      result = waitStage(stage);
+      if (result) {
+        dev().hostCopy(hostDst + offset, stage.buffer_, std::min(chunkSize, size - offset));
+        if ((chunk + depth) < numChunks) {
+          result = submitChunk(stage, chunk + depth);
+        }
+      }
+    }
+  }
+
+  // Drain the pipeline before the staged buffers are released
+  for (size_t i = 0; i < depth; ++i) {
+    result &= waitStage(stages[i]);
+    if (stages[i].memory_ != nullptr) {
+      xferBuffers.release(gpu(), *stages[i].memory_);
+    }
   }
+  if (!result) {
+    return false;
+  }
+  gpu().Barriers().WaitCurrent();
 
   gpu().addSystemScope();
 
@@ -774,8 +896,13 @@ bool DmaBlitManager::hsaCopyStaged(const_address hostSrc, address hostDst, size_
 KernelBlitManager::KernelBlitManager(VirtualGPU& gpu, Setup setup)
     : DmaBlitManager(gpu, setup),
       program_(nullptr),
+      missingKernels_(0),
       constantBuffer_(nullptr),
       constantBufferOffset_(0),
+      batchBuffer_(nullptr),
+      batchBufferOffset_(0),
+      readbackBuffer_(nullptr),
+      readbackSequence_(0),
       xferBufferSize_(0),
       lockXferOps_("Transfer Ops Lock", true) {
   for (uint i = 0; i < BlitTotal; ++i) {
@@ -803,6 +930,14 @@ KernelBlitManager::~KernelBlitManager() {
   if (nullptr != constantBuffer_) {
     constantBuffer_->release();
   }
+
+  if (nullptr != batchBuffer_) {
+    batchBuffer_->release();
+  }
+
+  if (nullptr != readbackBuffer_) {
+    readbackBuffer_->release();
+  }
 }
 
 bool KernelBlitManager::create(amd::Device& device) {
@@ -823,50 +958,62 @@ bool KernelBlitManager::createProgram(Device& device) {
     }
   }
 
-  std::vector<amd::Device*> devices;
-  devices.push_back(&device);
-
-  // Save context and program for this device
+  // Save context and program for this device. The kernels and the constant buffer are
+  // created on the first blit, so the queues without blits don't pay for them
   context_ = device.blitProgram()->context_;
   context_->retain();
   program_ = device.blitProgram()->program_;
   program_->retain();
 
-  bool result = false;
-  do {
-    // Create kernel objects for all blits
-    for (uint i = 0; i < NumBlitKernels(); ++i) {
-      const amd::Symbol* symbol = program_->findSymbol(BlitName[i]);
-      if (symbol == nullptr) {
-        // Not all blit kernels are needed in some setup, so continue with the rest
-        continue;
-      }
-      kernels_[i] = new amd::Kernel(*program_, *symbol, BlitName[i]);
-      if (kernels_[i] == nullptr) {
-        break;
-      }
-      // Validate blit kernels for the scratch memory usage (pre SI)
-      if (!device.validateKernel(*kernels_[i], &gpu())) {
-        break;
-      }
-    }
+  return true;
+}
 
-    result = true;
-  } while (!result);
+// ================================================================================================
+amd::Kernel* KernelBlitManager::blitKernel(uint type) const {
+  if (type >= NumBlitKernels()) {
+    return nullptr;
+  }
+  if ((kernels_[type] != nullptr) || ((missingKernels_ & (1ull << type)) != 0)) {
+    return kernels_[type];
+  }
 
-  // Create an internal constant buffer
-  constantBuffer_ = new (*context_) amd::Buffer(*context_, CL_MEM_ALLOC_HOST_PTR, 4 * Ki);
-  // Assign the constant buffer to the current virtual GPU
-  constantBuffer_->setVirtualDevice(&gpu());
-  if ((constantBuffer_ != nullptr) && !constantBuffer_->create(nullptr)) {
-    constantBuffer_->release();
-    constantBuffer_ = nullptr;
-    return false;
-  } else if (constantBuffer_ == nullptr) {
-    return false;
+  const amd::Symbol* symbol = program_->findSymbol(BlitName[type]);
+  // Not all blit kernels are needed in some setup, so the program may not have the kernel
+  if (symbol != nullptr) {
+    amd::Kernel* kernel = new amd::Kernel(*program_, *symbol, BlitName[type]);
+    // Validate blit kernels for the scratch memory usage (pre SI)
+    if ((kernel != nullptr) &&
+        !const_cast<Device&>(dev()).validateKernel(*kernel, &gpu())) {
+      LogPrintfError("Blit kernel %s validation failed", BlitName[type]);
+      kernel->release();
+      kernel = nullptr;
+    }
+    kernels_[type] = kernel;
+  }
+  if (kernels_[type] == nullptr) {
+    missingKernels_ |= 1ull << type;
   }
+  return kernels_[type];
+}
 
-  return result;
+// ================================================================================================
+Memory* KernelBlitManager::constantBufferMem() const {
+  if (constantBuffer_ == nullptr) {
+    // Create an internal constant buffer
+    amd::MemoryStats::Scope scope(amd::MemoryStats::Blit);
+    constantBuffer_ = new (*context_) amd::Buffer(*context_, CL_MEM_ALLOC_HOST_PTR, 4 * Ki);
+    if (constantBuffer_ == nullptr) {
+      return nullptr;
+    }
+    // Assign the constant buffer to the current virtual GPU
+    constantBuffer_->setVirtualDevice(&gpu());
+    if (!constantBuffer_->create(nullptr)) {
+      constantBuffer_->release();
+      constantBuffer_ = nullptr;
+      return nullptr;
+    }
+  }
+  return dev().getRocMemory(constantBuffer_);
 }
 
 // The following data structures will be used for the view creations.
@@ -1055,9 +1202,9 @@ bool KernelBlitManager::copyBufferToImageKernel(device::Memory& srcMemory,
 
   // Program kernels arguments for the blit operation
   cl_mem mem = as_cl<amd::Memory>(srcMemory.owner());
-  setArgument(kernels_[blitType], 0, sizeof(cl_mem), &mem);
+  setArgument(blitKernel(blitType), 0, sizeof(cl_mem), &mem);
   mem = as_cl<amd::Memory>(dstView->owner());
-  setArgument(kernels_[blitType], 1, sizeof(cl_mem), &mem);
+  setArgument(blitKernel(blitType), 1, sizeof(cl_mem), &mem);
   uint32_t memFmtSize = dstImage->getImageFormat().getElementSize();
   uint32_t components = dstImage->getImageFormat().getNumChannels();
 
@@ -1070,7 +1217,7 @@ bool KernelBlitManager::copyBufferToImageKernel(device::Memory& srcMemory,
   }
   CondLog(((srcOrigin[0] % granularity) != 0), "Unaligned offset in blit!");
   uint64_t srcOrg[4] = {srcOrigin[0] / granularity, srcOrigin[1], srcOrigin[2], 0};
-  setArgument(kernels_[blitType], 2, sizeof(srcOrg), srcOrg);
+  setArgument(blitKernel(blitType), 2, sizeof(srcOrg), srcOrg);
 
   int32_t dstOrg[4] = {(int32_t)dstOrigin[0], (int32_t)dstOrigin[1], (int32_t)dstOrigin[2], 0};
   int32_t copySize[4] = {(int32_t)size[0], (int32_t)size[1], (int32_t)size[2], 0};
@@ -1081,31 +1228,30 @@ bool KernelBlitManager::copyBufferToImageKernel(device::Memory& srcMemory,
     copySize[1] = 1;
   }
 
-  setArgument(kernels_[blitType], 3, sizeof(dstOrg), dstOrg);
-  setArgument(kernels_[blitType], 4, sizeof(copySize), copySize);
+  setArgument(blitKernel(blitType), 3, sizeof(dstOrg), dstOrg);
+  setArgument(blitKernel(blitType), 4, sizeof(copySize), copySize);
 
   // Program memory format
   uint multiplier = memFmtSize / sizeof(uint32_t);
   multiplier = (multiplier == 0) ? 1 : multiplier;
   uint32_t format[4] = {components, memFmtSize / components, multiplier, 0};
-  setArgument(kernels_[blitType], 5, sizeof(format), format);
+  setArgument(blitKernel(blitType), 5, sizeof(format), format);
 
   // Program row and slice pitches
   uint64_t pitch[4] = {0};
   CalcRowSlicePitches(pitch, copySize, rowPitch, slicePitch, gpuMem(dstMemory));
-  setArgument(kernels_[blitType], 6, sizeof(pitch), pitch);
+  setArgument(blitKernel(blitType), 6, sizeof(pitch), pitch);
 
   // Create ND range object for the kernel's execution
   amd::NDRangeContainer ndrange(dim, globalWorkOffset, globalWorkSize, localWorkSize);
 
   // Execute the blit
-  address parameters = captureArguments(kernels_[blitType]);
-  result = gpu().submitKernelInternal(ndrange, *kernels_[blitType], parameters, nullptr);
+  address parameters = captureArguments(blitKernel(blitType));
+  result = gpu().submitKernelInternal(ndrange, *blitKernel(blitType), parameters, nullptr);
   releaseArguments(parameters);
   if (releaseView) {
-    // todo SRD programming could be changed to avoid a stall
-    gpu().releaseGpuMemoryFence();
-    dstView->owner()->release();
+    // The blit may still access the SRD of the view, hence delay the release
+    gpu().addDelayedView(dstView->owner());
   }
 
   return result;
@@ -1250,15 +1396,15 @@ bool KernelBlitManager::copyImageToBufferKernel(device::Memory& srcMemory,
 
   // Program kernels arguments for the blit operation
   cl_mem mem = as_cl<amd::Memory>(srcView->owner());
-  setArgument(kernels_[blitType], 0, sizeof(cl_mem), &mem);
+  setArgument(blitKernel(blitType), 0, sizeof(cl_mem), &mem);
   mem = as_cl<amd::Memory>(dstMemory.owner());
-  setArgument(kernels_[blitType], 1, sizeof(cl_mem), &mem);
+  setArgument(blitKernel(blitType), 1, sizeof(cl_mem), &mem);
 
   // Update extra paramters for USHORT and UBYTE pointers.
   // Only then compiler can optimize the kernel to use
   // UAV Raw for other writes
-  setArgument(kernels_[blitType], 2, sizeof(cl_mem), &mem);
-  setArgument(kernels_[blitType], 3, sizeof(cl_mem), &mem);
+  setArgument(blitKernel(blitType), 2, sizeof(cl_mem), &mem);
+  setArgument(blitKernel(blitType), 3, sizeof(cl_mem), &mem);
 
   int32_t srcOrg[4] = {(int32_t)srcOrigin[0], (int32_t)srcOrigin[1], (int32_t)srcOrigin[2], 0};
   int32_t copySize[4] = {(int32_t)size[0], (int32_t)size[1], (int32_t)size[2], 0};
@@ -1269,7 +1415,7 @@ bool KernelBlitManager::copyImageToBufferKernel(device::Memory& srcMemory,
     copySize[1] = 1;
   }
 
-  setArgument(kernels_[blitType], 4, sizeof(srcOrg), srcOrg);
+  setArgument(blitKernel(blitType), 4, sizeof(srcOrg), srcOrg);
   uint32_t memFmtSize = srcImage->getImageFormat().getElementSize();
   uint32_t components = srcImage->getImageFormat().getNumChannels();
 
@@ -1282,31 +1428,30 @@ bool KernelBlitManager::copyImageToBufferKernel(device::Memory& srcMemory,
   }
   CondLog(((dstOrigin[0] % granularity) != 0), "Unaligned offset in blit!");
   uint64_t dstOrg[4] = {dstOrigin[0] / granularity, dstOrigin[1], dstOrigin[2], 0};
-  setArgument(kernels_[blitType], 5, sizeof(dstOrg), dstOrg);
-  setArgument(kernels_[blitType], 6, sizeof(copySize), copySize);
+  setArgument(blitKernel(blitType), 5, sizeof(dstOrg), dstOrg);
+  setArgument(blitKernel(blitType), 6, sizeof(copySize), copySize);
 
   // Program memory format
   uint multiplier = memFmtSize / sizeof(uint32_t);
   multiplier = (multiplier == 0) ? 1 : multiplier;
   uint32_t format[4] = {components, memFmtSize / components, multiplier, 0};
-  setArgument(kernels_[blitType], 7, sizeof(format), format);
+  setArgument(blitKernel(blitType), 7, sizeof(format), format);
 
   // Program row and slice pitches
   uint64_t pitch[4] = {0};
   CalcRowSlicePitches(pitch, copySize, rowPitch, slicePitch, gpuMem(srcMemory));
-  setArgument(kernels_[blitType], 8, sizeof(pitch), pitch);
+  setArgument(blitKernel(blitType), 8, sizeof(pitch), pitch);
 
   // Create ND range object for the kernel's execution
   amd::NDRangeContainer ndrange(dim, globalWorkOffset, globalWorkSize, localWorkSize);
 
   // Execute the blit
-  address parameters = captureArguments(kernels_[blitType]);
-  result = gpu().submitKernelInternal(ndrange, *kernels_[blitType], parameters, nullptr);
+  address parameters = captureArguments(blitKernel(blitType));
+  result = gpu().submitKernelInternal(ndrange, *blitKernel(blitType), parameters, nullptr);
   releaseArguments(parameters);
   if (releaseView) {
-    // todo SRD programming could be changed to avoid a stall
-    gpu().releaseGpuMemoryFence();
-    srcView->owner()->release();
+    // The blit may still access the SRD of the view, hence delay the release
+    gpu().addDelayedView(srcView->owner());
   }
 
   return result;
@@ -1409,39 +1554,38 @@ bool KernelBlitManager::copyImage(device::Memory& srcMemory, device::Memory& dst
 
   // Program kernels arguments for the blit operation
   cl_mem mem = as_cl<amd::Memory>(srcView->owner());
-  setArgument(kernels_[blitType], 0, sizeof(cl_mem), &mem);
+  setArgument(blitKernel(blitType), 0, sizeof(cl_mem), &mem);
   mem = as_cl<amd::Memory>(dstView->owner());
-  setArgument(kernels_[blitType], 1, sizeof(cl_mem), &mem);
+  setArgument(blitKernel(blitType), 1, sizeof(cl_mem), &mem);
 
   // Program source origin
   int32_t srcOrg[4] = {(int32_t)srcOrigin[0], (int32_t)srcOrigin[1], (int32_t)srcOrigin[2], 0};
   if ((srcImage->getType() == CL_MEM_OBJECT_IMAGE1D_ARRAY) && (dev().isa().versionMajor() >= 10)) {
     srcOrg[3] = 1;
   }
-  setArgument(kernels_[blitType], 2, sizeof(srcOrg), srcOrg);
+  setArgument(blitKernel(blitType), 2, sizeof(srcOrg), srcOrg);
 
   // Program destinaiton origin
   int32_t dstOrg[4] = {(int32_t)dstOrigin[0], (int32_t)dstOrigin[1], (int32_t)dstOrigin[2], 0};
   if ((dstImage->getType() == CL_MEM_OBJECT_IMAGE1D_ARRAY) && (dev().isa().versionMajor() >= 10)) {
     dstOrg[3] = 1;
   }
-  setArgument(kernels_[blitType], 3, sizeof(dstOrg), dstOrg);
+  setArgument(blitKernel(blitType), 3, sizeof(dstOrg), dstOrg);
 
   int32_t copySize[4] = {(int32_t)size[0], (int32_t)size[1], (int32_t)size[2], 0};
-  setArgument(kernels_[blitType], 4, sizeof(copySize), copySize);
+  setArgument(blitKernel(blitType), 4, sizeof(copySize), copySize);
 
   // Create ND range object for the kernel's execution
   amd::NDRangeContainer ndrange(dim, globalWorkOffset, globalWorkSize, localWorkSize);
 
   // Execute the blit
-  address parameters = captureArguments(kernels_[blitType]);
-  result = gpu().submitKernelInternal(ndrange, *kernels_[blitType], parameters, nullptr);
+  address parameters = captureArguments(blitKernel(blitType));
+  result = gpu().submitKernelInternal(ndrange, *blitKernel(blitType), parameters, nullptr);
   releaseArguments(parameters);
   if (releaseView) {
-    // todo SRD programming could be changed to avoid a stall
-    gpu().releaseGpuMemoryFence();
-    srcView->owner()->release();
-    dstView->owner()->release();
+    // The blit may still access the SRD of the view, hence delay the release
+    gpu().addDelayedView(srcView->owner());
+    gpu().addDelayedView(dstView->owner());
   }
 
   synchronize();
@@ -1584,9 +1728,16 @@ bool KernelBlitManager::copyBufferRect(device::Memory& srcMemory, device::Memory
   bool result = false;
   bool rejected = false;
 
+  // SDMA can't express pitches, which aren't dword aligned, in one rect command
+  const bool sdmaRect = ((srcRectIn.rowPitch_ % 4) == 0) && ((srcRectIn.slicePitch_ % 4) == 0) &&
+                        ((dstRectIn.rowPitch_ % 4) == 0) && ((dstRectIn.slicePitch_ % 4) == 0);
+  const bool wideRect = (blitKernel(BlitCopyBufferRectWide) != nullptr) &&
+                        !setup_.disableCopyBufferRect_;
+
   // Fall into the ROC path for rejected transfers
   if (dev().info().pcie_atomics_ && (setup_.disableCopyBufferRect_ ||
-      srcMemory.isHostMemDirectAccess() || dstMemory.isHostMemDirectAccess())) {
+      srcMemory.isHostMemDirectAccess() || dstMemory.isHostMemDirectAccess()) &&
+      (sdmaRect || !wideRect)) {
     result = DmaBlitManager::copyBufferRect(srcMemory, dstMemory, srcRectIn, dstRectIn, sizeIn, entire);
 
     if (result) {
@@ -1595,6 +1746,21 @@ bool KernelBlitManager::copyBufferRect(device::Memory& srcMemory, device::Memory
     }
   }
 
+  if (wideRect) {
+    result = copyBufferRectWide(srcMemory, dstMemory, srcRectIn, dstRectIn, sizeIn);
+    if (amd::IS_HIP) {
+      // Update the command type for ROC profiler
+      if (srcMemory.isHostMemDirectAccess()) {
+        gpu().SetCopyCommandType(CL_COMMAND_WRITE_BUFFER_RECT);
+      }
+      if (dstMemory.isHostMemDirectAccess()) {
+        gpu().SetCopyCommandType(CL_COMMAND_READ_BUFFER_RECT);
+      }
+    }
+    synchronize();
+    return result;
+  }
+
   uint blitType = BlitCopyBufferRect;
   size_t dim = 3;
   size_t globalWorkOffset[3] = {0, 0, 0};
@@ -1668,22 +1834,22 @@ bool KernelBlitManager::copyBufferRect(device::Memory& srcMemory, device::Memory
 
   // Program kernels arguments for the blit operation
   cl_mem mem = as_cl<amd::Memory>(srcMemory.owner());
-  setArgument(kernels_[blitType], 0, sizeof(cl_mem), &mem);
+  setArgument(blitKernel(blitType), 0, sizeof(cl_mem), &mem);
   mem = as_cl<amd::Memory>(dstMemory.owner());
-  setArgument(kernels_[blitType], 1, sizeof(cl_mem), &mem);
+  setArgument(blitKernel(blitType), 1, sizeof(cl_mem), &mem);
   uint64_t src[4] = {srcRect.rowPitch_, srcRect.slicePitch_, srcRect.start_, 0};
-  setArgument(kernels_[blitType], 2, sizeof(src), src);
+  setArgument(blitKernel(blitType), 2, sizeof(src), src);
   uint64_t dst[4] = {dstRect.rowPitch_, dstRect.slicePitch_, dstRect.start_, 0};
-  setArgument(kernels_[blitType], 3, sizeof(dst), dst);
+  setArgument(blitKernel(blitType), 3, sizeof(dst), dst);
   uint64_t copySize[4] = {size[0], size[1], size[2], CopyRectAlignment[i]};
-  setArgument(kernels_[blitType], 4, sizeof(copySize), copySize);
+  setArgument(blitKernel(blitType), 4, sizeof(copySize), copySize);
 
   // Create ND range object for the kernel's execution
   amd::NDRangeContainer ndrange(dim, globalWorkOffset, globalWorkSize, localWorkSize);
 
   // Execute the blit
-  address parameters = captureArguments(kernels_[blitType]);
-  result = gpu().submitKernelInternal(ndrange, *kernels_[blitType], parameters, nullptr);
+  address parameters = captureArguments(blitKernel(blitType));
+  result = gpu().submitKernelInternal(ndrange, *blitKernel(blitType), parameters, nullptr);
   releaseArguments(parameters);
 
   if (amd::IS_HIP) {
@@ -1737,6 +1903,11 @@ bool KernelBlitManager::readBuffer(device::Memory& srcMemory, void* dstHost,
     result = HostBlitManager::readBuffer(srcMemory, dstHost, origin, size, entire);
     synchronize();
     return result;
+  } else if ((size[0] != 0) &&
+             (size[0] <= std::min<size_t>(ROC_SMALL_READBACK_SIZE, kReadbackFlagOffset)) &&
+             readBufferPolled(srcMemory, dstHost, origin, size)) {
+    synchronize();
+    return true;
   } else {
     size_t pinSize = size[0];
     // Check if a pinned transfer can be executed with a single pin
@@ -1829,15 +2000,16 @@ bool KernelBlitManager::writeBuffer(const void* srcHost, device::Memory& dstMemo
   amd::ScopedLock k(lockXferOps_);
   bool result = false;
 
-  if (dev().info().largeBar_ && size[0] <= kMaxH2dMemcpySize) {
+  if (dev().info().largeBar_ && size[0] <= dev().largeBarWriteThreshold()) {
     if ((dstMemory.owner()->getHostMem() == nullptr) && (dstMemory.owner()->getSvmPtr() != nullptr)) {
-      // CPU read ahead, hence release GPU memory
+      // CPU write ahead, hence release GPU memory
       gpu().releaseGpuMemoryFence();
       char* dst = reinterpret_cast<char*>(dstMemory.owner()->getSvmPtr());
-      std::memcpy(dst + origin[0], srcHost, size[0]);
-      // Set hasPendingDispatch_ flag. Then releaseGpuMemoryFence() will use barrier to invalidate cache
+      dev().largeBarWrite(dst + origin[0], srcHost, size[0]);
+      // Set hasPendingDispatch_ flag. Then releaseGpuMemoryFence() will use barrier to invalidate
+      // cache. The later packets are ordered after the barrier, hence CPU doesn't wait for it
       gpu().hasPendingDispatch();
-      gpu().releaseGpuMemoryFence();
+      gpu().releaseGpuMemoryFence(kSkipCpuWait);
       return true;
     }
   }
@@ -1982,6 +2154,13 @@ bool KernelBlitManager::fillBuffer1D(device::Memory& memory, const void* pattern
     return result;
   } else {
 
+    // The wide kernel handles the unaligned head and tail in the same dispatch
+    if ((blitKernel(FillBufferWide) != nullptr) && (patternSize <= kWideFillMaxPattern)) {
+      result = fillBufferWide(memory, pattern, patternSize, origin[0], size[0]);
+      synchronize();
+      return result;
+    }
+
     // Pack the fill buffer info, that handles unaligned memories.
     std::vector<FillBufferInfo> packed_vector{};
     FillBufferInfo::PackInfo(memory, size[0], origin[0], pattern, patternSize, packed_vector);
@@ -2009,28 +2188,28 @@ bool KernelBlitManager::fillBuffer1D(device::Memory& memory, const void* pattern
       // Program kernels arguments for the fill operation
       cl_mem mem = as_cl<amd::Memory>(memory.owner());
       if (alignment == sizeof(uint64_t)) {
-        setArgument(kernels_[fillType], 0, sizeof(cl_mem), nullptr);
-        setArgument(kernels_[fillType], 1, sizeof(cl_mem), nullptr);
-        setArgument(kernels_[fillType], 2, sizeof(cl_mem), nullptr);
-        setArgument(kernels_[fillType], 3, sizeof(cl_mem), &mem);
+        setArgument(blitKernel(fillType), 0, sizeof(cl_mem), nullptr);
+        setArgument(blitKernel(fillType), 1, sizeof(cl_mem), nullptr);
+        setArgument(blitKernel(fillType), 2, sizeof(cl_mem), nullptr);
+        setArgument(blitKernel(fillType), 3, sizeof(cl_mem), &mem);
       } else if (alignment == sizeof(uint32_t)) {
-        setArgument(kernels_[fillType], 0, sizeof(cl_mem), nullptr);
-        setArgument(kernels_[fillType], 1, sizeof(cl_mem), nullptr);
-        setArgument(kernels_[fillType], 2, sizeof(cl_mem), &mem);
-        setArgument(kernels_[fillType], 3, sizeof(cl_mem), nullptr);
+        setArgument(blitKernel(fillType), 0, sizeof(cl_mem), nullptr);
+        setArgument(blitKernel(fillType), 1, sizeof(cl_mem), nullptr);
+        setArgument(blitKernel(fillType), 2, sizeof(cl_mem), &mem);
+        setArgument(blitKernel(fillType), 3, sizeof(cl_mem), nullptr);
       } else if (alignment == sizeof(uint16_t)) {
-        setArgument(kernels_[fillType], 0, sizeof(cl_mem), nullptr);
-        setArgument(kernels_[fillType], 1, sizeof(cl_mem), &mem);
-        setArgument(kernels_[fillType], 2, sizeof(cl_mem), nullptr);
-        setArgument(kernels_[fillType], 3, sizeof(cl_mem), nullptr);
+        setArgument(blitKernel(fillType), 0, sizeof(cl_mem), nullptr);
+        setArgument(blitKernel(fillType), 1, sizeof(cl_mem), &mem);
+        setArgument(blitKernel(fillType), 2, sizeof(cl_mem), nullptr);
+        setArgument(blitKernel(fillType), 3, sizeof(cl_mem), nullptr);
       } else {
-        setArgument(kernels_[fillType], 0, sizeof(cl_mem), &mem);
-        setArgument(kernels_[fillType], 1, sizeof(cl_mem), nullptr);
-        setArgument(kernels_[fillType], 2, sizeof(cl_mem), nullptr);
-        setArgument(kernels_[fillType], 3, sizeof(cl_mem), nullptr);
+        setArgument(blitKernel(fillType), 0, sizeof(cl_mem), &mem);
+        setArgument(blitKernel(fillType), 1, sizeof(cl_mem), nullptr);
+        setArgument(blitKernel(fillType), 2, sizeof(cl_mem), nullptr);
+        setArgument(blitKernel(fillType), 3, sizeof(cl_mem), nullptr);
       }
 
-      Memory* gpuCB = dev().getRocMemory(constantBuffer_);
+      Memory* gpuCB = constantBufferMem();
       if (gpuCB == nullptr) {
         return false;
       }
@@ -2047,21 +2226,21 @@ bool KernelBlitManager::fillBuffer1D(device::Memory& memory, const void* pattern
       }
 
       mem = as_cl<amd::Memory>(gpuCB->owner());
-      setArgument(kernels_[fillType], 4, sizeof(cl_mem), &mem, constBufOffset);
+      setArgument(blitKernel(fillType), 4, sizeof(cl_mem), &mem, constBufOffset);
 
       koffset /= alignment;
       kpattern_size32 /= alignment;
 
-      setArgument(kernels_[fillType], 5, sizeof(uint32_t), &kpattern_size32);
-      setArgument(kernels_[fillType], 6, sizeof(koffset), &koffset);
-      setArgument(kernels_[fillType], 7, sizeof(kfill_size), &kfill_size);
+      setArgument(blitKernel(fillType), 5, sizeof(uint32_t), &kpattern_size32);
+      setArgument(blitKernel(fillType), 6, sizeof(koffset), &koffset);
+      setArgument(blitKernel(fillType), 7, sizeof(kfill_size), &kfill_size);
 
       // Create ND range object for the kernel's execution
       amd::NDRangeContainer ndrange(1, globalWorkOffset, &globalWorkSize, &localWorkSize);
 
       // Execute the blit
-      address parameters = captureArguments(kernels_[fillType]);
-      result = gpu().submitKernelInternal(ndrange, *kernels_[fillType], parameters, nullptr);
+      address parameters = captureArguments(blitKernel(fillType));
+      result = gpu().submitKernelInternal(ndrange, *blitKernel(fillType), parameters, nullptr);
       releaseArguments(parameters);
     }
   }
@@ -2071,6 +2250,274 @@ bool KernelBlitManager::fillBuffer1D(device::Memory& memory, const void* pattern
   return result;
 }
 
+// ================================================================================================
+size_t KernelBlitManager::wideGridSize(size_t size) const {
+  // Enough work-groups to keep all CUs busy, the threads loop over the rest of the body
+  constexpr size_t kGroupsPerCu = 8;
+  const size_t maxSize = dev().info().maxComputeUnits_ * kGroupsPerCu * kWideBlitGroupSize;
+  // The head and tail need up to 16 threads
+  const size_t items = std::max(size / kWideBlitAccess, kWideBlitAccess);
+  return std::min(amd::alignUp(items, kWideBlitGroupSize), maxSize);
+}
+
+// ================================================================================================
+bool KernelBlitManager::copyBufferWide(device::Memory& srcMemory, device::Memory& dstMemory,
+                                       size_t srcOffset, size_t dstOffset, size_t size) const {
+  amd::Kernel* kernel = blitKernel(BlitCopyBufferWide);
+
+  cl_mem mem = as_cl<amd::Memory>(srcMemory.owner());
+  setArgument(kernel, 0, sizeof(cl_mem), &mem, 0, &srcMemory);
+  mem = as_cl<amd::Memory>(dstMemory.owner());
+  setArgument(kernel, 1, sizeof(cl_mem), &mem, 0, &dstMemory);
+  uint64_t srcOrigin = srcOffset;
+  setArgument(kernel, 2, sizeof(srcOrigin), &srcOrigin);
+  uint64_t dstOrigin = dstOffset;
+  setArgument(kernel, 3, sizeof(dstOrigin), &dstOrigin);
+  uint64_t copySize = size;
+  setArgument(kernel, 4, sizeof(copySize), &copySize);
+
+  size_t globalWorkOffset[3] = {0, 0, 0};
+  size_t globalWorkSize = wideGridSize(size);
+  size_t localWorkSize = kWideBlitGroupSize;
+  amd::NDRangeContainer ndrange(1, globalWorkOffset, &globalWorkSize, &localWorkSize);
+
+  // Execute the blit
+  address parameters = captureArguments(kernel);
+  bool result = gpu().submitKernelInternal(ndrange, *kernel, parameters, nullptr);
+  releaseArguments(parameters);
+  return result;
+}
+
+// ================================================================================================
+bool KernelBlitManager::fillBufferWide(device::Memory& memory, const void* pattern,
+                                       size_t patternSize, size_t offset, size_t size) const {
+  amd::Kernel* kernel = blitKernel(FillBufferWide);
+
+  Memory* gpuCB = constantBufferMem();
+  if (gpuCB == nullptr) {
+    return false;
+  }
+
+  // Repeat the pattern to a period, which is a multiple of the access size of the kernel.
+  // The extra access at the end keeps any window of the period contiguous for the kernel
+  size_t common = kWideBlitAccess;
+  for (size_t rem = patternSize; rem != 0;) {
+    size_t tmp = common % rem;
+    common = rem;
+    rem = tmp;
+  }
+  const uint32_t period = static_cast<uint32_t>(patternSize * kWideBlitAccess / common);
+  const size_t expandedSize = period + kWideBlitAccess;
+  uint32_t constBufOffset = ConstantBufferOffset(expandedSize);
+  auto constBuf = reinterpret_cast<address>(constantBuffer_->getHostMem()) + constBufOffset;
+  for (size_t i = 0; i < expandedSize; i += patternSize) {
+    memcpy(constBuf + i, pattern, std::min(patternSize, expandedSize - i));
+  }
+
+  cl_mem mem = as_cl<amd::Memory>(memory.owner());
+  setArgument(kernel, 0, sizeof(cl_mem), &mem, 0, &memory);
+  mem = as_cl<amd::Memory>(gpuCB->owner());
+  setArgument(kernel, 1, sizeof(cl_mem), &mem, constBufOffset);
+  uint64_t fillOffset = offset;
+  setArgument(kernel, 2, sizeof(fillOffset), &fillOffset);
+  uint64_t fillSize = size;
+  setArgument(kernel, 3, sizeof(fillSize), &fillSize);
+  setArgument(kernel, 4, sizeof(period), &period);
+
+  size_t globalWorkOffset[3] = {0, 0, 0};
+  size_t globalWorkSize = wideGridSize(size);
+  size_t localWorkSize = kWideBlitGroupSize;
+  amd::NDRangeContainer ndrange(1, globalWorkOffset, &globalWorkSize, &localWorkSize);
+
+  // Execute the blit
+  address parameters = captureArguments(kernel);
+  bool result = gpu().submitKernelInternal(ndrange, *kernel, parameters, nullptr);
+  releaseArguments(parameters);
+  return result;
+}
+
+// ================================================================================================
+bool KernelBlitManager::copyBufferRectWide(device::Memory& srcMemory, device::Memory& dstMemory,
+                                           const amd::BufferRect& srcRect,
+                                           const amd::BufferRect& dstRect,
+                                           const amd::Coord3D& size) const {
+  amd::Kernel* kernel = blitKernel(BlitCopyBufferRectWide);
+
+  // Pick the widest element, which all starts, pitches and the row size are aligned to
+  const static uint CopyRectAlignment[] = {16, 8, 4, 1};
+  uint alignment = 1;
+  for (uint i = 0; i < sizeof(CopyRectAlignment) / sizeof(uint); i++) {
+    const uint64_t bits = srcRect.rowPitch_ | srcRect.slicePitch_ | srcRect.start_ |
+        dstRect.rowPitch_ | dstRect.slicePitch_ | dstRect.start_ | size[0];
+    if ((bits % CopyRectAlignment[i]) == 0) {
+      alignment = CopyRectAlignment[i];
+      break;
+    }
+  }
+
+  cl_mem mem = as_cl<amd::Memory>(srcMemory.owner());
+  setArgument(kernel, 0, sizeof(cl_mem), &mem, 0, &srcMemory);
+  mem = as_cl<amd::Memory>(dstMemory.owner());
+  setArgument(kernel, 1, sizeof(cl_mem), &mem, 0, &dstMemory);
+  uint64_t src[4] = {srcRect.rowPitch_, srcRect.slicePitch_, srcRect.start_, 0};
+  setArgument(kernel, 2, sizeof(src), src);
+  uint64_t dst[4] = {dstRect.rowPitch_, dstRect.slicePitch_, dstRect.start_, 0};
+  setArgument(kernel, 3, sizeof(dst), dst);
+  uint64_t copySize[4] = {size[0] / alignment, size[1], size[2], alignment};
+  setArgument(kernel, 4, sizeof(copySize), copySize);
+
+  // The grid loops over the elements of all rows, sized as the wide blits of 16 byte elements
+  const size_t elements = copySize[0] * copySize[1] * copySize[2];
+  size_t globalWorkOffset[3] = {0, 0, 0};
+  size_t globalWorkSize = wideGridSize(elements * kWideBlitAccess);
+  size_t localWorkSize = kWideBlitGroupSize;
+  amd::NDRangeContainer ndrange(1, globalWorkOffset, &globalWorkSize, &localWorkSize);
+
+  // Execute the blit
+  address parameters = captureArguments(kernel);
+  bool result = gpu().submitKernelInternal(ndrange, *kernel, parameters, nullptr);
+  releaseArguments(parameters);
+  return result;
+}
+
+// ================================================================================================
+bool KernelBlitManager::writeBatchTable(const amd::CopyMemoryBatchCommand::Range* ranges,
+                                        size_t count, size_t* offset) const {
+  if (batchBuffer_ == nullptr) {
+    amd::MemoryStats::Scope scope(amd::MemoryStats::Blit);
+    batchBuffer_ = new (*context_) amd::Buffer(*context_, CL_MEM_ALLOC_HOST_PTR, kBatchBufferSize);
+    if (batchBuffer_ == nullptr) {
+      return false;
+    }
+    // Assign the batch buffer to the current virtual GPU
+    batchBuffer_->setVirtualDevice(&gpu());
+    if (!batchBuffer_->create(nullptr)) {
+      batchBuffer_->release();
+      batchBuffer_ = nullptr;
+      return false;
+    }
+  }
+
+  // Each range is described with the source address, the destination address and the size
+  const size_t tableSize = amd::alignUp(count * 3 * sizeof(uint64_t), 256);
+  if ((batchBufferOffset_ + tableSize) > batchBuffer_->getSize()) {
+    // Stall GPU and reset the offset
+    gpu().releaseGpuMemoryFence();
+    batchBufferOffset_ = 0;
+  }
+
+  auto table = reinterpret_cast<uint64_t*>(
+      reinterpret_cast<address>(batchBuffer_->getHostMem()) + batchBufferOffset_);
+  for (size_t i = 0; i < count; ++i) {
+    Memory* srcMemory = dev().getRocMemory(ranges[i].src_);
+    Memory* dstMemory = dev().getRocMemory(ranges[i].dst_);
+    table[3 * i] = srcMemory->virtualAddress() + ranges[i].srcOffset_;
+    table[3 * i + 1] = dstMemory->virtualAddress() + ranges[i].dstOffset_;
+    table[3 * i + 2] = ranges[i].size_;
+    // The kernel accesses the ranges through the table, so track them explicitly
+    gpu().addIndirectMemObject(srcMemory, true);
+    gpu().addIndirectMemObject(dstMemory, false);
+  }
+  *offset = batchBufferOffset_;
+  batchBufferOffset_ += tableSize;
+  return true;
+}
+
+// ================================================================================================
+bool KernelBlitManager::readBufferPolled(device::Memory& srcMemory, void* dstHost,
+                                         const amd::Coord3D& origin,
+                                         const amd::Coord3D& size) const {
+  if ((blitKernel(BlitCopyBufferWide) == nullptr) || (blitKernel(StreamOpsWrite) == nullptr)) {
+    return false;
+  }
+  if (readbackBuffer_ == nullptr) {
+    amd::MemoryStats::Scope scope(amd::MemoryStats::Blit);
+    readbackBuffer_ = new (*context_) amd::Buffer(*context_, CL_MEM_ALLOC_HOST_PTR,
+                                                  kReadbackBufferSize);
+    if (readbackBuffer_ == nullptr) {
+      return false;
+    }
+    // Assign the bounce slot to the current virtual GPU
+    readbackBuffer_->setVirtualDevice(&gpu());
+    if (!readbackBuffer_->create(nullptr)) {
+      readbackBuffer_->release();
+      readbackBuffer_ = nullptr;
+      return false;
+    }
+  }
+  Memory* bounce = dev().getRocMemory(readbackBuffer_);
+  address host = reinterpret_cast<address>(readbackBuffer_->getHostMem());
+  auto flag = reinterpret_cast<volatile uint64_t*>(host + kReadbackFlagOffset);
+
+  // The flag follows the data in the queue order, both writes must reach the system memory
+  const uint64_t sequence = ++readbackSequence_;
+  gpu().addSystemScope();
+  if (!copyBufferWide(srcMemory, *bounce, origin[0], 0, size[0])) {
+    return false;
+  }
+  gpu().addSystemScope();
+  if (!streamOpsWrite(*bounce, sequence, kReadbackFlagOffset, sizeof(uint64_t))) {
+    gpu().releaseGpuMemoryFence();
+    return false;
+  }
+  // The dispatches rang the doorbell already, so poll the flag instead of the queue signal
+  const uint64_t start = amd::Os::timeNanos();
+  while (*flag != sequence) {
+    if ((amd::Os::timeNanos() - start) > kReadbackSpinNs) {
+      // A long queue ahead of the read, block on the queue instead of the CPU spin
+      gpu().releaseGpuMemoryFence();
+      break;
+    }
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  std::memcpy(dstHost, host, size[0]);
+  ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "Polled readback of %zu bytes, sequence %lu",
+          size[0], sequence);
+  return true;
+}
+
+// ================================================================================================
+bool KernelBlitManager::copyBufferBatch(const amd::CopyMemoryBatchCommand::Range* ranges,
+                                        size_t count) const {
+  amd::Kernel* kernel = blitKernel(BlitCopyBufferBatch);
+  if (kernel == nullptr) {
+    return false;
+  }
+
+  amd::ScopedLock k(lockXferOps_);
+  // A work-group copies a range, hence limit the groups to the number of ranges
+  constexpr size_t kGroupsPerCu = 8;
+  const size_t maxGroups = dev().info().maxComputeUnits_ * kGroupsPerCu;
+  bool result = true;
+
+  for (size_t first = 0; result && (first < count); first += kBatchMaxRanges) {
+    const size_t batch = std::min(count - first, kBatchMaxRanges);
+    size_t offset = 0;
+    if (!writeBatchTable(ranges + first, batch, &offset)) {
+      return false;
+    }
+
+    cl_mem mem = as_cl<amd::Memory>(batchBuffer_);
+    setArgument(kernel, 0, sizeof(cl_mem), &mem, offset);
+    uint32_t numRanges = static_cast<uint32_t>(batch);
+    setArgument(kernel, 1, sizeof(numRanges), &numRanges);
+
+    size_t globalWorkOffset[3] = {0, 0, 0};
+    size_t globalWorkSize = std::min(batch, maxGroups) * kWideBlitGroupSize;
+    size_t localWorkSize = kWideBlitGroupSize;
+    amd::NDRangeContainer ndrange(1, globalWorkOffset, &globalWorkSize, &localWorkSize);
+
+    // Execute the blit
+    address parameters = captureArguments(kernel);
+    result = gpu().submitKernelInternal(ndrange, *kernel, parameters, nullptr);
+    releaseArguments(parameters);
+  }
+
+  synchronize();
+
+  return result;
+}
+
 // ================================================================================================
 bool KernelBlitManager::fillBuffer2D(device::Memory& memory, const void* pattern,
                                      size_t patternSize, const amd::Coord3D& surface,
@@ -2106,28 +2553,28 @@ bool KernelBlitManager::fillBuffer2D(device::Memory& memory, const void* pattern
 
     cl_mem mem = as_cl<amd::Memory>(memory.owner());
      if (alignment == sizeof(uint64_t)) {
-      setArgument(kernels_[fillType], 0, sizeof(cl_mem), nullptr);
-      setArgument(kernels_[fillType], 1, sizeof(cl_mem), nullptr);
-      setArgument(kernels_[fillType], 2, sizeof(cl_mem), nullptr);
-      setArgument(kernels_[fillType], 3, sizeof(cl_mem), &mem);
+      setArgument(blitKernel(fillType), 0, sizeof(cl_mem), nullptr);
+      setArgument(blitKernel(fillType), 1, sizeof(cl_mem), nullptr);
+      setArgument(blitKernel(fillType), 2, sizeof(cl_mem), nullptr);
+      setArgument(blitKernel(fillType), 3, sizeof(cl_mem), &mem);
     } else if (alignment == sizeof(uint32_t)) {
-      setArgument(kernels_[fillType], 0, sizeof(cl_mem), nullptr);
-      setArgument(kernels_[fillType], 1, sizeof(cl_mem), nullptr);
-      setArgument(kernels_[fillType], 2, sizeof(cl_mem), &mem);
-      setArgument(kernels_[fillType], 3, sizeof(cl_mem), nullptr);
+      setArgument(blitKernel(fillType), 0, sizeof(cl_mem), nullptr);
+      setArgument(blitKernel(fillType), 1, sizeof(cl_mem), nullptr);
+      setArgument(blitKernel(fillType), 2, sizeof(cl_mem), &mem);
+      setArgument(blitKernel(fillType), 3, sizeof(cl_mem), nullptr);
     } else if (alignment == sizeof(uint16_t)) {
-      setArgument(kernels_[fillType], 0, sizeof(cl_mem), nullptr);
-      setArgument(kernels_[fillType], 1, sizeof(cl_mem), &mem);
-      setArgument(kernels_[fillType], 2, sizeof(cl_mem), nullptr);
-      setArgument(kernels_[fillType], 3, sizeof(cl_mem), nullptr);
+      setArgument(blitKernel(fillType), 0, sizeof(cl_mem), nullptr);
+      setArgument(blitKernel(fillType), 1, sizeof(cl_mem), &mem);
+      setArgument(blitKernel(fillType), 2, sizeof(cl_mem), nullptr);
+      setArgument(blitKernel(fillType), 3, sizeof(cl_mem), nullptr);
     } else {
-      setArgument(kernels_[fillType], 0, sizeof(cl_mem), &mem);
-      setArgument(kernels_[fillType], 1, sizeof(cl_mem), nullptr);
-      setArgument(kernels_[fillType], 2, sizeof(cl_mem), nullptr);
-      setArgument(kernels_[fillType], 3, sizeof(cl_mem), nullptr);
+      setArgument(blitKernel(fillType), 0, sizeof(cl_mem), &mem);
+      setArgument(blitKernel(fillType), 1, sizeof(cl_mem), nullptr);
+      setArgument(blitKernel(fillType), 2, sizeof(cl_mem), nullptr);
+      setArgument(blitKernel(fillType), 3, sizeof(cl_mem), nullptr);
     }
 
-    Memory* gpuCB = dev().getRocMemory(constantBuffer_);
+    Memory* gpuCB = constantBufferMem();
     if (gpuCB == nullptr) {
       return false;
     }
@@ -2138,7 +2585,7 @@ bool KernelBlitManager::fillBuffer2D(device::Memory& memory, const void* pattern
     memcpy(constBuf, pattern, patternSize);
 
     mem = as_cl<amd::Memory>(gpuCB->owner());
-    setArgument(kernels_[fillType], 4, sizeof(cl_mem), &mem, constBufOffset);
+    setArgument(blitKernel(fillType), 4, sizeof(cl_mem), &mem, constBufOffset);
 
     uint64_t mem_origin = static_cast<uint64_t>(origin[0]);
     uint64_t width = static_cast<uint64_t>(size[0]);
@@ -2148,19 +2595,19 @@ bool KernelBlitManager::fillBuffer2D(device::Memory& memory, const void* pattern
     patternSize/= alignment;
     mem_origin /= alignment;
 
-    setArgument(kernels_[fillType], 5, sizeof(uint32_t), &patternSize);
-    setArgument(kernels_[fillType], 6, sizeof(mem_origin), &mem_origin);
-    setArgument(kernels_[fillType], 7, sizeof(width), &width);
-    setArgument(kernels_[fillType], 8, sizeof(height), &height);
-    setArgument(kernels_[fillType], 9, sizeof(pitch), &pitch);
+    setArgument(blitKernel(fillType), 5, sizeof(uint32_t), &patternSize);
+    setArgument(blitKernel(fillType), 6, sizeof(mem_origin), &mem_origin);
+    setArgument(blitKernel(fillType), 7, sizeof(width), &width);
+    setArgument(blitKernel(fillType), 8, sizeof(height), &height);
+    setArgument(blitKernel(fillType), 9, sizeof(pitch), &pitch);
 
 
     // Create ND range object for the kernel's execution
     amd::NDRangeContainer ndrange(2, globalWorkOffset, globalWorkSize, localWorkSize);
 
     // Execute the blit
-    address parameters = captureArguments(kernels_[fillType]);
-    result = gpu().submitKernelInternal(ndrange, *kernels_[fillType], parameters, nullptr);
+    address parameters = captureArguments(blitKernel(fillType));
+    result = gpu().submitKernelInternal(ndrange, *blitKernel(fillType), parameters, nullptr);
     releaseArguments(parameters);
   }
 
@@ -2194,6 +2641,12 @@ bool KernelBlitManager::copyBuffer(device::Memory& srcMemory, device::Memory& ds
   if (setup_.disableHwlCopyBuffer_ ||
       (!srcMemory.isHostMemDirectAccess() && !dstMemory.isHostMemDirectAccess() &&
        !(p2p || asan))) {
+    if (blitKernel(BlitCopyBufferWide) != nullptr) {
+      result = copyBufferWide(srcMemory, dstMemory, srcOrigin[0], dstOrigin[0], sizeIn[0]);
+      synchronize();
+      return result;
+    }
+
     uint blitType = BlitCopyBuffer;
     size_t dim = 1;
     size_t globalWorkOffset[3] = {0, 0, 0};
@@ -2237,33 +2690,33 @@ bool KernelBlitManager::copyBuffer(device::Memory& srcMemory, device::Memory& ds
 
     // Program kernels arguments for the blit operation
     cl_mem mem = as_cl<amd::Memory>(srcMemory.owner());
-    setArgument(kernels_[blitType], 0, sizeof(cl_mem), &mem, 0, &srcMemory);
+    setArgument(blitKernel(blitType), 0, sizeof(cl_mem), &mem, 0, &srcMemory);
     mem = as_cl<amd::Memory>(dstMemory.owner());
-    setArgument(kernels_[blitType], 1, sizeof(cl_mem), &mem, 0, &dstMemory);
+    setArgument(blitKernel(blitType), 1, sizeof(cl_mem), &mem, 0, &dstMemory);
     // Program source origin
     uint64_t srcOffset = srcOrigin[0] / CopyBuffAlignment[i];
-    setArgument(kernels_[blitType], 2, sizeof(srcOffset), &srcOffset);
+    setArgument(blitKernel(blitType), 2, sizeof(srcOffset), &srcOffset);
 
     // Program destinaiton origin
     uint64_t dstOffset = dstOrigin[0] / CopyBuffAlignment[i];
-    setArgument(kernels_[blitType], 3, sizeof(dstOffset), &dstOffset);
+    setArgument(blitKernel(blitType), 3, sizeof(dstOffset), &dstOffset);
 
     uint64_t copySize = size[0];
-    setArgument(kernels_[blitType], 4, sizeof(copySize), &copySize);
+    setArgument(blitKernel(blitType), 4, sizeof(copySize), &copySize);
 
     if (blitType == BlitCopyBufferAligned) {
       int32_t alignment = CopyBuffAlignment[i];
-      setArgument(kernels_[blitType], 5, sizeof(alignment), &alignment);
+      setArgument(blitKernel(blitType), 5, sizeof(alignment), &alignment);
     } else {
-      setArgument(kernels_[blitType], 5, sizeof(remain), &remain);
+      setArgument(blitKernel(blitType), 5, sizeof(remain), &remain);
     }
 
     // Create ND range object for the kernel's execution
     amd::NDRangeContainer ndrange(1, globalWorkOffset, &globalWorkSize, &localWorkSize);
 
     // Execute the blit
-    address parameters = captureArguments(kernels_[blitType]);
-    result = gpu().submitKernelInternal(ndrange, *kernels_[blitType], parameters, nullptr);
+    address parameters = captureArguments(blitKernel(blitType));
+    result = gpu().submitKernelInternal(ndrange, *blitKernel(blitType), parameters, nullptr);
     releaseArguments(parameters);
   } else {
     if (amd::IS_HIP) {
@@ -2398,10 +2851,10 @@ bool KernelBlitManager::fillImage(device::Memory& memory, const void* pattern,
 
   // Program kernels arguments for the blit operation
   cl_mem mem = as_cl<amd::Memory>(memView->owner());
-  setArgument(kernels_[fillType], 0, sizeof(cl_mem), &mem);
-  setArgument(kernels_[fillType], 1, sizeof(float[4]), newpattern);
-  setArgument(kernels_[fillType], 2, sizeof(int32_t[4]), newpattern);
-  setArgument(kernels_[fillType], 3, sizeof(uint32_t[4]), newpattern);
+  setArgument(blitKernel(fillType), 0, sizeof(cl_mem), &mem);
+  setArgument(blitKernel(fillType), 1, sizeof(float[4]), newpattern);
+  setArgument(blitKernel(fillType), 2, sizeof(int32_t[4]), newpattern);
+  setArgument(blitKernel(fillType), 3, sizeof(uint32_t[4]), newpattern);
 
   int32_t fillOrigin[4] = {(int32_t)origin[0], (int32_t)origin[1], (int32_t)origin[2], 0};
   int32_t fillSize[4] = {(int32_t)size[0], (int32_t)size[1], (int32_t)size[2], 0};
@@ -2411,8 +2864,8 @@ bool KernelBlitManager::fillImage(device::Memory& memory, const void* pattern,
     fillSize[2] = fillSize[1];
     fillSize[1] = 1;
   }
-  setArgument(kernels_[fillType], 4, sizeof(fillOrigin), fillOrigin);
-  setArgument(kernels_[fillType], 5, sizeof(fillSize), fillSize);
+  setArgument(blitKernel(fillType), 4, sizeof(fillOrigin), fillOrigin);
+  setArgument(blitKernel(fillType), 5, sizeof(fillSize), fillSize);
 
   // Find the type of image
   uint32_t type = 0;
@@ -2439,19 +2892,18 @@ bool KernelBlitManager::fillImage(device::Memory& memory, const void* pattern,
       type = 2;
       break;
   }
-  setArgument(kernels_[fillType], 6, sizeof(type), &type);
+  setArgument(blitKernel(fillType), 6, sizeof(type), &type);
 
   // Create ND range object for the kernel's execution
   amd::NDRangeContainer ndrange(dim, globalWorkOffset, globalWorkSize, localWorkSize);
 
   // Execute the blit
-  address parameters = captureArguments(kernels_[fillType]);
-  result = gpu().submitKernelInternal(ndrange, *kernels_[fillType], parameters, nullptr);
+  address parameters = captureArguments(blitKernel(fillType));
+  result = gpu().submitKernelInternal(ndrange, *blitKernel(fillType), parameters, nullptr);
   releaseArguments(parameters);
   if (releaseView) {
-    // todo SRD programming could be changed to avoid a stall
-    gpu().releaseGpuMemoryFence();
-    memView->owner()->release();
+    // The blit may still access the SRD of the view, hence delay the release
+    gpu().addDelayedView(memView->owner());
   }
 
   synchronize();
@@ -2474,20 +2926,20 @@ bool KernelBlitManager::streamOpsWrite(device::Memory& memory, uint64_t value,
   bool is32BitWrite = (sizeBytes == sizeof(uint32_t)) ? true : false;
   // Program kernels arguments for the write operation
   if (is32BitWrite) {
-    setArgument(kernels_[blitType], 0, sizeof(cl_mem), &mem, offset);
-    setArgument(kernels_[blitType], 1, sizeof(cl_mem), nullptr);
-    setArgument(kernels_[blitType], 2, sizeof(uint32_t), &value);
+    setArgument(blitKernel(blitType), 0, sizeof(cl_mem), &mem, offset);
+    setArgument(blitKernel(blitType), 1, sizeof(cl_mem), nullptr);
+    setArgument(blitKernel(blitType), 2, sizeof(uint32_t), &value);
   } else {
-    setArgument(kernels_[blitType], 0, sizeof(cl_mem), nullptr);
-    setArgument(kernels_[blitType], 1, sizeof(cl_mem), &mem, offset);
-    setArgument(kernels_[blitType], 2, sizeof(uint64_t), &value);
+    setArgument(blitKernel(blitType), 0, sizeof(cl_mem), nullptr);
+    setArgument(blitKernel(blitType), 1, sizeof(cl_mem), &mem, offset);
+    setArgument(blitKernel(blitType), 2, sizeof(uint64_t), &value);
   }
-  setArgument(kernels_[blitType], 3, sizeof(size_t), &sizeBytes);
+  setArgument(blitKernel(blitType), 3, sizeof(size_t), &sizeBytes);
   // Create ND range object for the kernel's execution
   amd::NDRangeContainer ndrange(dim, globalWorkOffset, globalWorkSize, localWorkSize);
   // Execute the blit
-  address parameters = captureArguments(kernels_[blitType]);
-  result = gpu().submitKernelInternal(ndrange, *kernels_[blitType], parameters, nullptr);
+  address parameters = captureArguments(blitKernel(blitType));
+  result = gpu().submitKernelInternal(ndrange, *blitKernel(blitType), parameters, nullptr);
   releaseArguments(parameters);
   synchronize();
   return result;
@@ -2510,25 +2962,25 @@ bool KernelBlitManager::streamOpsWait(device::Memory& memory, uint64_t value, si
   bool is32BitWait = (sizeBytes == sizeof(uint32_t)) ? true : false;
   // Program kernels arguments for the wait operation
   if (is32BitWait) {
-    setArgument(kernels_[blitType], 0, sizeof(cl_mem), &mem, offset);
-    setArgument(kernels_[blitType], 1, sizeof(cl_mem), nullptr);
-    setArgument(kernels_[blitType], 2, sizeof(uint32_t), &value);
-    setArgument(kernels_[blitType], 3, sizeof(uint32_t), &flags);
-    setArgument(kernels_[blitType], 4, sizeof(uint32_t), &mask);
+    setArgument(blitKernel(blitType), 0, sizeof(cl_mem), &mem, offset);
+    setArgument(blitKernel(blitType), 1, sizeof(cl_mem), nullptr);
+    setArgument(blitKernel(blitType), 2, sizeof(uint32_t), &value);
+    setArgument(blitKernel(blitType), 3, sizeof(uint32_t), &flags);
+    setArgument(blitKernel(blitType), 4, sizeof(uint32_t), &mask);
   } else {
-    setArgument(kernels_[blitType], 0, sizeof(cl_mem), nullptr);
-    setArgument(kernels_[blitType], 1, sizeof(cl_mem), &mem, offset);
-    setArgument(kernels_[blitType], 2, sizeof(uint64_t), &value);
-    setArgument(kernels_[blitType], 3, sizeof(uint64_t), &flags);
-    setArgument(kernels_[blitType], 4, sizeof(uint64_t), &mask);
+    setArgument(blitKernel(blitType), 0, sizeof(cl_mem), nullptr);
+    setArgument(blitKernel(blitType), 1, sizeof(cl_mem), &mem, offset);
+    setArgument(blitKernel(blitType), 2, sizeof(uint64_t), &value);
+    setArgument(blitKernel(blitType), 3, sizeof(uint64_t), &flags);
+    setArgument(blitKernel(blitType), 4, sizeof(uint64_t), &mask);
   }
 
   // Create ND range object for the kernel's execution
   amd::NDRangeContainer ndrange(dim, globalWorkOffset, globalWorkSize, localWorkSize);
 
   // Execute the blit
-  address parameters = captureArguments(kernels_[blitType]);
-  result = gpu().submitKernelInternal(ndrange, *kernels_[blitType], parameters, nullptr);
+  address parameters = captureArguments(blitKernel(blitType));
+  result = gpu().submitKernelInternal(ndrange, *blitKernel(blitType), parameters, nullptr);
   releaseArguments(parameters);
   synchronize();
 
@@ -2558,6 +3010,15 @@ amd::Memory* DmaBlitManager::pinHostMemory(const void* hostMem, size_t pinSize,
     return amdMemory;
   }
 
+  // Reuse the host range, which is still pinned after an earlier transfer
+  Device::PinnedCache* cache = dev().pinnedCache();
+  if (cache != nullptr) {
+    amdMemory = cache->find(tmpHost, pinAllocSize);
+    if (nullptr != amdMemory) {
+      return amdMemory;
+    }
+  }
+
   amdMemory = new (*context_) amd::Buffer(*context_, CL_MEM_USE_HOST_PTR, pinAllocSize);
   amdMemory->setVirtualDevice(&gpu());
   if ((amdMemory != nullptr) && !amdMemory->create(tmpHost, SysMem)) {
@@ -2573,6 +3034,9 @@ amd::Memory* DmaBlitManager::pinHostMemory(const void* hostMem, size_t pinSize,
   if (srcMemory == nullptr) {
     // Release all pinned memory and attempt pinning again
     gpu().releasePinnedMem();
+    if (cache != nullptr) {
+      cache->invalidate(nullptr, std::numeric_limits<size_t>::max());
+    }
     srcMemory = dev().getRocMemory(amdMemory);
     if (srcMemory == nullptr) {
       // Release memory
@@ -2581,6 +3045,11 @@ amd::Memory* DmaBlitManager::pinHostMemory(const void* hostMem, size_t pinSize,
     }
   }
 
+  if ((amdMemory != nullptr) && (cache != nullptr)) {
+    // Keep the range pinned for the next transfers from the same host memory
+    cache->add(amdMemory);
+  }
+
   return amdMemory;
 }
 
@@ -2633,7 +3102,7 @@ bool KernelBlitManager::runScheduler(uint64_t vqVM, amd::Memory* schedulerParam,
 
   amd::NDRangeContainer ndrange(1, globalWorkOffset, globalWorkSize, localWorkSize);
 
-  device::Kernel* devKernel = const_cast<device::Kernel*>(kernels_[Scheduler]->getDeviceKernel(dev()));
+  device::Kernel* devKernel = const_cast<device::Kernel*>(blitKernel(Scheduler)->getDeviceKernel(dev()));
   Kernel& gpuKernel = static_cast<Kernel&>(*devKernel);
 
   SchedulerParam* sp = reinterpret_cast<SchedulerParam*>(schedulerParam->getHostMem());
@@ -2675,17 +3144,18 @@ bool KernelBlitManager::runScheduler(uint64_t vqVM, amd::Memory* schedulerParam,
   sp->write_index = hsa_queue_load_write_index_relaxed(schedulerQueue);
 
   cl_mem mem = as_cl<amd::Memory>(schedulerParam);
-  setArgument(kernels_[Scheduler], 0, sizeof(cl_mem), &mem);
+  setArgument(blitKernel(Scheduler), 0, sizeof(cl_mem), &mem);
 
-  address parameters = captureArguments(kernels_[Scheduler]);
+  address parameters = captureArguments(blitKernel(Scheduler));
 
-  if (!gpu().submitKernelInternal(ndrange, *kernels_[Scheduler],
+  if (!gpu().submitKernelInternal(ndrange, *blitKernel(Scheduler),
                                   parameters, nullptr)) {
     return false;
   }
   releaseArguments(parameters);
 
-  if (!WaitForSignal(schedulerSignal)) {
+  // With the GPU wait the caller orders the queue after the scheduler with a barrier
+  if (!ROC_SCHEDULER_GPU_WAIT && !WaitForSignal(schedulerSignal)) {
     LogWarning("Failed schedulerSignal wait");
     return false;
   }
@@ -2703,15 +3173,15 @@ bool KernelBlitManager::RunGwsInit(
   size_t localWorkSize[1] = { 1 };
 
   // Program kernels arguments
-  setArgument(kernels_[GwsInit], 0, sizeof(uint32_t), &value);
+  setArgument(blitKernel(GwsInit), 0, sizeof(uint32_t), &value);
 
   // Create ND range object for the kernel's execution
   amd::NDRangeContainer ndrange(1, globalWorkOffset, globalWorkSize, localWorkSize);
 
   // Execute the blit
-  address parameters = captureArguments(kernels_[GwsInit]);
+  address parameters = captureArguments(blitKernel(GwsInit));
 
-  bool result = gpu().submitKernelInternal(ndrange, *kernels_[GwsInit], parameters, nullptr);
+  bool result = gpu().submitKernelInternal(ndrange, *blitKernel(GwsInit), parameters, nullptr);
 
   releaseArguments(parameters);
 
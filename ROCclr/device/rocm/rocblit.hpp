@@ -159,7 +159,6 @@ class DmaBlitManager : public device::HostBlitManager {
 
  protected:
   static constexpr uint MaxPinnedBuffers = 4;
-  static constexpr size_t kMaxH2dMemcpySize = 8 * Ki;
   static constexpr size_t kMaxD2hMemcpySize = 64; //!< 1 cacheline
 
   //! Synchronizes the blit operations if necessary
@@ -185,6 +184,18 @@ class DmaBlitManager : public device::HostBlitManager {
                const amd::Coord3D& dstOrigin, const amd::Coord3D& size, bool enableCopyRect = false,
                bool flushDMA = true) const;
 
+  //! Returns the number of SDMA engines for the copy and their IDs, 1 if the copy isn't split
+  uint32_t stripeEngines(const Memory& srcMemory,  //!< Source memory object
+                         const Memory& dstMemory,  //!< Destination memory object
+                         hsa_agent_t srcAgent,     //!< Agent of the source memory
+                         hsa_agent_t dstAgent,     //!< Agent of the destination memory
+                         size_t size,              //!< Size of the copy in bytes
+                         uint32_t* engines         //!< SDMA engine IDs for the stripes
+                         ) const;
+
+  static constexpr uint32_t kMaxStripeEngines = 8;      //!< Max engines for a copy over xGMI
+  static constexpr uint32_t kMaxPcieStripeEngines = 2;  //!< Max engines for a copy over PCIe
+
   const size_t MinSizeForPinnedTransfer;
   bool completeOperation_;  //!< DMA blit manager must complete operation
   amd::Context* context_;   //!< A dummy context
@@ -240,6 +251,10 @@ class KernelBlitManager : public DmaBlitManager {
     StreamOpsWait,
     Scheduler,
     GwsInit,
+    BlitCopyBufferWide,
+    FillBufferWide,
+    BlitCopyBufferBatch,
+    BlitCopyBufferRectWide,
     BlitLinearTotal,
     FillImage = BlitLinearTotal,
     BlitCopyImage,
@@ -249,6 +264,17 @@ class KernelBlitManager : public DmaBlitManager {
     BlitTotal
   };
 
+  static constexpr size_t kWideBlitAccess = 16;      //!< Bytes per access of the wide blits
+  static constexpr size_t kWideBlitGroupSize = 256;  //!< Work-group size of the wide blits
+  static constexpr size_t kWideFillMaxPattern = 128; //!< Max pattern size of the wide fill
+  static constexpr size_t kBatchMaxRanges = 64;      //!< Max ranges of a single batch dispatch
+  static constexpr size_t kBatchMaxRangeSize = 256 * Ki;  //!< Max range size of a batch copy
+  static constexpr size_t kBatchBufferSize = 16 * Ki;     //!< Size of the batch table ring
+  static constexpr size_t kReadbackBufferSize = 4 * Ki;   //!< Size of the readback bounce slot
+  //! Offset of the sequence flag in the readback slot, the data is below it
+  static constexpr size_t kReadbackFlagOffset = kReadbackBufferSize - 64;
+  static constexpr uint64_t kReadbackSpinNs = 200000;     //!< Max poll time of the readback flag
+
   //! Constructor
   KernelBlitManager(VirtualGPU& gpu,       //!< Virtual GPU to be used for blits
                     Setup setup = Setup()  //!< Specifies HW accelerated blits
@@ -442,6 +468,12 @@ class KernelBlitManager : public DmaBlitManager {
                              uint64_t mask
   ) const;
 
+  //! Copies a list of linear device ranges with one dispatch per kBatchMaxRanges ranges.
+  //! Returns false if the batch kernel isn't available
+  bool copyBufferBatch(const amd::CopyMemoryBatchCommand::Range* ranges,  //!< Batch ranges
+                       size_t count                                       //!< Number of ranges
+                       ) const;
+
   virtual amd::Monitor* lockXfer() const { return &lockXferOps_; }
 
  private:
@@ -471,10 +503,58 @@ class KernelBlitManager : public DmaBlitManager {
                                size_t slicePitch = 0           //!< Slice for buffer
                                ) const;
 
+  //! Copies a linear range with 16 byte accesses, including the unaligned head and tail
+  bool copyBufferWide(device::Memory& srcMemory,  //!< Source memory object
+                      device::Memory& dstMemory,  //!< Destination memory object
+                      size_t srcOffset,           //!< Source offset in bytes
+                      size_t dstOffset,           //!< Destination offset in bytes
+                      size_t size                 //!< Size of the copy in bytes
+                      ) const;
+
+  //! Fills a linear range with 16 byte accesses, the pattern can have up to 128 bytes
+  bool fillBufferWide(device::Memory& memory,  //!< Memory object to fill
+                      const void* pattern,     //!< Pattern data
+                      size_t patternSize,      //!< Pattern size in bytes
+                      size_t offset,           //!< Offset of the fill in bytes
+                      size_t size              //!< Size of the fill in bytes
+                      ) const;
+
+  //! Copies a 3D region with arbitrary pitches in one dispatch of the flattened rows
+  bool copyBufferRectWide(device::Memory& srcMemory,       //!< Source memory object
+                          device::Memory& dstMemory,       //!< Destination memory object
+                          const amd::BufferRect& srcRect,  //!< Source rectangle
+                          const amd::BufferRect& dstRect,  //!< Destination rectangle
+                          const amd::Coord3D& size         //!< Size of the copy region
+                          ) const;
+
+  //! Returns the grid size of the grid-stride wide blits for the size in bytes
+  size_t wideGridSize(size_t size) const;
+
+  //! Writes the descriptor table of a batch into the batch buffer and returns its offset
+  bool writeBatchTable(const amd::CopyMemoryBatchCommand::Range* ranges,  //!< Batch ranges
+                       size_t count,                                      //!< Number of ranges
+                       size_t* offset                                     //!< Table offset
+                       ) const;
+
+  //! Reads a few bytes through the pinned bounce slot of the queue. The blits write the data
+  //! and a sequence flag, so the host polls the flag instead of the wait for the queue
+  bool readBufferPolled(device::Memory& srcMemory,  //!< Source memory object
+                        void* dstHost,              //!< Destination host memory
+                        const amd::Coord3D& origin, //!< Source origin
+                        const amd::Coord3D& size    //!< Size of the copy region
+                        ) const;
+
   //! Creates a program for all blit operations
   bool createProgram(Device& device  //!< Device object
                      );
 
+  //! Returns the blit kernel, created on the first use, or nullptr if the program doesn't have it
+  amd::Kernel* blitKernel(uint type  //!< Blit kernel type
+                          ) const;
+
+  //! Returns the internal constant buffer, created on the first use
+  Memory* constantBufferMem() const;
+
   //! Creates a view memory object
   Memory* createView(const Memory& parent,    //!< Parent memory object
                      cl_image_format format,  //!< The new format for a view
@@ -488,21 +568,24 @@ class KernelBlitManager : public DmaBlitManager {
                           size_t size, const void* value, size_t offset = 0,
                           const device::Memory* dev_mem = nullptr) const;
 
-  uint32_t ConstantBufferOffset() const {
+  //! Returns the offset of a new slot for \a size bytes in the constant buffer
+  uint32_t ConstantBufferOffset(uint32_t size = 0) const {
     // Make sure it can fit at least 128 bytes for OCL memory fill of double16
     constexpr uint32_t kManagedSize = 0x80;
-    // Adjust the ofset to the new location
-    constantBufferOffset_ += kManagedSize;
+    size = amd::alignUp(std::max(size, kManagedSize), kManagedSize);
+    uint32_t offset = constantBufferOffset_;
     // Check if the allocation exceeds the limit
-    if ((constantBufferOffset_ + kManagedSize) > constantBuffer_->getSize()) {
+    if ((offset + size) > constantBuffer_->getSize()) {
       // Stall GPU and reset the ofset
       gpu().releaseGpuMemoryFence();
-      constantBufferOffset_ = 0;
+      offset = 0;
     }
-    return constantBufferOffset_;
+    // Adjust the ofset to the new location
+    constantBufferOffset_ = offset + size;
+    return offset;
   }
 
-  inline uint32_t NumBlitKernels() {
+  inline uint32_t NumBlitKernels() const {
     return (dev().info().imageSupport_) ? BlitTotal : BlitLinearTotal;
   }
 
@@ -513,9 +596,14 @@ class KernelBlitManager : public DmaBlitManager {
   KernelBlitManager& operator=(const KernelBlitManager&);
 
   amd::Program* program_;             //!< GPU program object
-  amd::Kernel* kernels_[BlitTotal];   //!< GPU kernels for blit
-  amd::Memory* constantBuffer_;       //!< An internal CB for blits
-  mutable uint32_t constantBufferOffset_; //!< Current offset in the constant buffer
+  mutable amd::Kernel* kernels_[BlitTotal]; //!< GPU kernels for blit, created on demand
+  mutable uint64_t missingKernels_;   //!< Mask of the kernels, which the program doesn't have
+  mutable amd::Memory* constantBuffer_; //!< An internal CB for blits
+  mutable uint32_t constantBufferOffset_; //!< Next free offset in the constant buffer
+  mutable amd::Memory* batchBuffer_;  //!< Ring of the descriptor tables for batched copies
+  mutable size_t batchBufferOffset_;  //!< Current offset in the batch buffer
+  mutable amd::Memory* readbackBuffer_; //!< Pinned bounce slot of the small reads
+  mutable uint64_t readbackSequence_; //!< The last sequence in the readback flag
   size_t xferBufferSize_;             //!< Transfer buffer size
   mutable amd::Monitor  lockXferOps_; //!< Lock transfer operation
 };
@@ -524,8 +612,9 @@ static const char* BlitName[KernelBlitManager::BlitTotal] = {
   "__amd_rocclr_fillBufferAligned", "__amd_rocclr_fillBufferAligned2D", "__amd_rocclr_copyBuffer",
   "__amd_rocclr_copyBufferAligned", "__amd_rocclr_copyBufferRect",
   "__amd_rocclr_copyBufferRectAligned", "__amd_rocclr_streamOpsWrite", "__amd_rocclr_streamOpsWait",
-  "__amd_rocclr_scheduler", "__amd_rocclr_gwsInit", "__amd_rocclr_fillImage",
-  "__amd_rocclr_copyImage", "__amd_rocclr_copyImage1DA", "__amd_rocclr_copyImageToBuffer",
+  "__amd_rocclr_scheduler", "__amd_rocclr_gwsInit", "__amd_rocclr_copyBufferWide",
+  "__amd_rocclr_fillBufferWide", "__amd_rocclr_copyBufferBatch",
+  "__amd_rocclr_copyBufferRectWide", "__amd_rocclr_fillImage", "__amd_rocclr_copyImage", "__amd_rocclr_copyImage1DA", "__amd_rocclr_copyImageToBuffer",
   "__amd_rocclr_copyBufferToImage"
 };
 
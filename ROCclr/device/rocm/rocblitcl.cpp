@@ -41,6 +41,140 @@ const char* rocBlitLinearSourceCode = BLIT_KERNEL(
   }
 );
 
+const char* BlitWideSourceCode = BLIT_KERNEL(
+
+  // Copies with 16 bytes per access. The first threads copy the head before the 16 byte aligned
+  // destination and the tail, all threads loop over the body with the grid stride
+  __kernel void __amd_rocclr_copyBufferWide(__global uchar* src, __global uchar* dst,
+                                            ulong srcOrigin, ulong dstOrigin, ulong size) {
+    src += srcOrigin;
+    dst += dstOrigin;
+    ulong head = min((16 - ((ulong)dst & 15)) & 15, size);
+    ulong body = (size - head) >> 4;
+    ulong tail = size - head - (body << 4);
+    ulong id = get_global_id(0);
+    ulong stride = get_global_size(0);
+
+    if (id < head) {
+      dst[id] = src[id];
+    }
+    if (id < tail) {
+      dst[size - tail + id] = src[size - tail + id];
+    }
+
+    __global uint4* dst4 = (__global uint4*)(dst + head);
+    __global uchar* srcBody = src + head;
+    if (((ulong)srcBody & 15) == 0) {
+      __global uint4* src4 = (__global uint4*)srcBody;
+      for (ulong i = id; i < body; i += stride) {
+        dst4[i] = src4[i];
+      }
+    } else if (((ulong)srcBody & 3) == 0) {
+      __global uint* src1 = (__global uint*)srcBody;
+      for (ulong i = id; i < body; i += stride) {
+        dst4[i] = vload4(i, src1);
+      }
+    } else {
+      for (ulong i = id; i < body; i += stride) {
+        dst4[i] = as_uint4(vload16(i, srcBody));
+      }
+    }
+  }
+
+  // Fills with a pattern of up to 128 bytes. The pattern is repeated to a period, which is a
+  // multiple of 16 bytes, and extended by 16 bytes, hence any 16 byte window is contiguous
+  __kernel void __amd_rocclr_fillBufferWide(__global uchar* buf, __constant uchar* pattern,
+                                            ulong offset, ulong size, uint period) {
+    buf += offset;
+    ulong head = min((16 - ((ulong)buf & 15)) & 15, size);
+    ulong body = (size - head) >> 4;
+    ulong tail = size - head - (body << 4);
+    ulong id = get_global_id(0);
+    ulong stride = get_global_size(0);
+
+    if (id < head) {
+      buf[id] = pattern[(uint)id];
+    }
+    if (id < tail) {
+      ulong pos = size - tail + id;
+      buf[pos] = pattern[(uint)(pos % period)];
+    }
+
+    // The body starts after the head, hence each access reads the window at its fill position
+    uint pos = (uint)((head + (id << 4)) % period);
+    uint step = (uint)((stride << 4) % period);
+    __global uint4* buf4 = (__global uint4*)(buf + head);
+    for (ulong i = id; i < body; i += stride) {
+      buf4[i] = as_uint4(vload16(0, pattern + pos));
+      pos += step;
+      if (pos >= period) {
+        pos -= period;
+      }
+    }
+  }
+
+  // Copies a 3D region with arbitrary pitches. The grid is flattened over the rows, hence narrow
+  // rows don't leave threads idle and adjacent threads access adjacent elements. The rects hold
+  // the row pitch, slice pitch and start in bytes, size holds the row size in elements of
+  // size.w bytes, the number of rows and slices
+  __kernel void __amd_rocclr_copyBufferRectWide(__global uchar* src, __global uchar* dst,
+                                                ulong4 srcRect, ulong4 dstRect, ulong4 size) {
+    ulong total = size.x * size.y * size.z;
+    ulong stride = get_global_size(0);
+
+    for (ulong idx = get_global_id(0); idx < total; idx += stride) {
+      ulong row = idx / size.x;
+      ulong x = (idx - row * size.x) * size.w;
+      ulong y = row % size.y;
+      ulong z = row / size.y;
+      __global uchar* s = src + srcRect.z + y * srcRect.x + z * srcRect.y + x;
+      __global uchar* d = dst + dstRect.z + y * dstRect.x + z * dstRect.y + x;
+
+      if (size.w == 16) {
+        *(__global uint4*)d = *(__global uint4*)s;
+      } else if (size.w == 8) {
+        *(__global uint2*)d = *(__global uint2*)s;
+      } else if (size.w == 4) {
+        *(__global uint*)d = *(__global uint*)s;
+      } else {
+        *d = *s;
+      }
+    }
+  }
+
+  // Copies a list of ranges, described with the source, destination and size in the table.
+  // The work-groups loop over the ranges and pick the widest access the alignment allows
+  __kernel void __amd_rocclr_copyBufferBatch(__global ulong* desc, uint count) {
+    ulong id = get_local_id(0);
+    ulong stride = get_local_size(0);
+
+    for (uint r = get_group_id(0); r < count; r += get_num_groups(0)) {
+      __global uchar* src = (__global uchar*)desc[3 * r];
+      __global uchar* dst = (__global uchar*)desc[3 * r + 1];
+      ulong size = desc[3 * r + 2];
+      ulong align = (ulong)src | (ulong)dst | size;
+
+      if ((align & 15) == 0) {
+        __global uint4* src4 = (__global uint4*)src;
+        __global uint4* dst4 = (__global uint4*)dst;
+        for (ulong i = id; i < (size >> 4); i += stride) {
+          dst4[i] = src4[i];
+        }
+      } else if ((align & 3) == 0) {
+        __global uint* src1 = (__global uint*)src;
+        __global uint* dst1 = (__global uint*)dst;
+        for (ulong i = id; i < (size >> 2); i += stride) {
+          dst1[i] = src1[i];
+        }
+      } else {
+        for (ulong i = id; i < size; i += stride) {
+          dst[i] = src[i];
+        }
+      }
+    }
+  }
+);
+
 const char* SchedulerSourceCode = BLIT_KERNEL(
 
   extern void __amd_scheduler_rocm(__global void*);
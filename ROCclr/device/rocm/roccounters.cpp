@@ -542,7 +542,7 @@ bool PerfCounterProfile::initialize() {
   const uint32_t alignment = amd::Os::pageSize();     // use page alignment
 
   if (cmd_buf.ptr != nullptr && cmd_buf.size != profile_.command_buffer.size) {
-    roc_device_.memFree(cmd_buf.ptr, cmd_buf.size);
+    roc_device_.hostFree(cmd_buf.ptr, cmd_buf.size);
     cmd_buf.ptr = nullptr;
   }
 
@@ -558,7 +558,7 @@ bool PerfCounterProfile::initialize() {
   }
 
   if (out_buf.ptr != nullptr && out_buf.size != profile_.output_buffer.size) {
-    roc_device_.memFree(out_buf.ptr, out_buf.size);
+    roc_device_.hostFree(out_buf.ptr, out_buf.size);
     out_buf.ptr = nullptr;
   }
 
@@ -620,11 +620,11 @@ PerfCounterProfile::~PerfCounterProfile() {
   }
 
   if (profile_.command_buffer.ptr) {
-    roc_device_.memFree(profile_.command_buffer.ptr, profile_.command_buffer.size);
+    roc_device_.hostFree(profile_.command_buffer.ptr, profile_.command_buffer.size);
   }
 
   if (profile_.output_buffer.ptr) {
-    roc_device_.memFree(profile_.output_buffer.ptr, profile_.output_buffer.size);
+    roc_device_.hostFree(profile_.output_buffer.ptr, profile_.output_buffer.size);
   }
 }
 
@@ -160,6 +160,9 @@ class PerfCounterProfile : public amd::ReferenceCountedObject {
   //! Return the stop AQL packet
   hsa_ext_amd_aql_pm4_packet_t* postPacket() { return &postPacket_; }
 
+  //! Return the signal of the stop packet, it's 0 when the counter data is ready
+  hsa_signal_t completionSignal() const { return completionSignal_; }
+
  private:
 
   //! Disable copy constructor
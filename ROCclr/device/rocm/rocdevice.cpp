@@ -40,6 +40,7 @@
 #include "device/rocm/rocmemory.hpp"
 #include "device/rocm/rocglinterop.hpp"
 #include "device/rocm/rocsignal.hpp"
+#include "amdocl/cl_vk_amd.hpp"
 #ifdef WITH_AMDGPU_PRO
 #include "pro/prodriver.hpp"
 #endif
@@ -52,15 +53,18 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #ifdef ROCCLR_SUPPORT_NUMA_POLICY
 #include <numa.h>
 #include <numaif.h>
 #endif // ROCCLR_SUPPORT_NUMA_POLICY
 #include <sstream>
+#include <thread>
 #include <vector>
 #endif // WITHOUT_HSA_BaCKEND
 
@@ -164,6 +168,12 @@ Device::Device(hsa_agent_t bkendDevice)
     , xferQueue_(nullptr)
     , xferRead_(nullptr)
     , xferWrite_(nullptr)
+    , pinnedCache_(nullptr)
+    , mem_sub_alloc_(nullptr)
+    , ipcLock_("IPC attachments lock")
+    , sdmaThreshold_{0, 0}
+    , largeBarWriteThreshold_(0)
+    , host_copy_pool_(nullptr)
     , pro_device_(nullptr)
     , pro_ena_(false)
     , freeMem_(0)
@@ -198,6 +208,25 @@ void Device::setupCpuAgent() {
       }
     }
   }
+  // Apply the override of the visible device, if it's valid
+  if (ROC_DEVICE_NUMA_NODES[0] != '\0') {
+    auto it = std::find_if(gpu_agents_.begin(), gpu_agents_.end(),
+                           [&](hsa_agent_t agent) { return agent.handle == bkendDevice_.handle; });
+    std::stringstream nodes(ROC_DEVICE_NUMA_NODES);
+    std::string node;
+    for (auto i = std::distance(gpu_agents_.begin(), it); std::getline(nodes, node, ','); --i) {
+      if (i == 0) {
+        int value = atoi(node.c_str());
+        if ((value >= 0) && (static_cast<size_t>(value) < size)) {
+          index = value;
+        } else if (value != -1) {
+          LogPrintfWarning("Invalid NUMA node %d for the device, using node %d", value, index);
+        }
+        break;
+      }
+    }
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_INIT, "CPU NUMA node %d selected for the device", index);
   preferred_numa_node_ = index;
   cpu_agent_ = cpu_agents_[index].agent;
   system_segment_ = cpu_agents_[index].fine_grain_pool;
@@ -223,6 +252,13 @@ Device::~Device() {
   delete pro_device_;
 #endif
 
+  // Destroy the recycled signals, the late releases will destroy their signals
+  signal_pool_closed_.store(true);
+  while (ProfilingSignal* signal = signal_pool_.dequeue()) {
+    signal->pool_ = nullptr;
+    signal->release();
+  }
+
   // Release cached map targets
   for (uint i = 0; mapCache_ != nullptr && i < mapCache_->size(); ++i) {
     if ((*mapCache_)[i] != nullptr) {
@@ -245,12 +281,27 @@ Device::~Device() {
       glb_ctx_ = nullptr;
   }
 
+  delete host_copy_pool_;
+
+  // Unpin the cached host ranges
+  delete pinnedCache_;
+
+  // Detach the closed IPC memory, kept in the cache
+  for (const auto& handle : ipcIdle_) {
+    ipcDetachMemory(ipcAttachments_[handle].devPtr_);
+  }
+  ipcIdle_.clear();
+
+  // Release the chunks of the suballocated memory
+  delete mem_sub_alloc_;
+
   // Destroy temporary buffers for read/write
   delete xferRead_;
   delete xferWrite_;
 
   // Destroy transfer queue
   delete xferQueue_;
+  delete scratchQueue_.load();
 
   delete blitProgram_;
 
@@ -366,6 +417,7 @@ bool Device::XferBuffers::create() {
   bool result = false;
 
   // Create a buffer object
+  amd::MemoryStats::Scope scope(amd::MemoryStats::Staging);
   xferBuf = new Buffer(dev(), bufSize_);
 
   // Try to allocate memory for the transfer buffer
@@ -392,6 +444,7 @@ Memory& Device::XferBuffers::acquire() {
   // If the list is empty, then attempt to allocate a staged buffer
   if (listSize == 0) {
     // Allocate memory
+    amd::MemoryStats::Scope scope(amd::MemoryStats::Staging);
     xferBuf = new Buffer(dev(), bufSize_);
 
     // Allocate memory for the transfer buffer
@@ -423,6 +476,185 @@ void Device::XferBuffers::release(VirtualGPU& gpu, Memory& buffer) {
   --acquiredCnt_;
 }
 
+Device::PinnedCache::~PinnedCache() {
+  for (auto& mem : lru_) {
+    mem->release();
+  }
+}
+
+amd::Memory* Device::PinnedCache::find(const void* addr, size_t size) {
+  amd::ScopedLock l(lock_);
+  auto it = ranges_.find(reinterpret_cast<uintptr_t>(addr));
+  if ((it == ranges_.end()) || (size > (*it->second)->getSize())) {
+    return nullptr;
+  }
+  // Move the range to the front of the LRU list
+  lru_.splice(lru_.begin(), lru_, it->second);
+  amd::Memory* mem = *it->second;
+  mem->retain();
+  return mem;
+}
+
+void Device::PinnedCache::add(amd::Memory* mem) {
+  size_t size = mem->getSize();
+  if (size > maxSize_) {
+    return;
+  }
+  amd::ScopedLock l(lock_);
+  uintptr_t key = reinterpret_cast<uintptr_t>(mem->getHostMem());
+  auto it = ranges_.find(key);
+  if (it != ranges_.end()) {
+    // A smaller range at the same address, replace it with the new one
+    size_ -= (*it->second)->getSize();
+    (*it->second)->release();
+    lru_.erase(it->second);
+    ranges_.erase(it);
+  }
+  // Evict the least recently used ranges
+  while ((size_ + size) > maxSize_) {
+    amd::Memory* last = lru_.back();
+    size_ -= last->getSize();
+    ranges_.erase(reinterpret_cast<uintptr_t>(last->getHostMem()));
+    lru_.pop_back();
+    last->release();
+  }
+  mem->retain();
+  lru_.push_front(mem);
+  ranges_[key] = lru_.begin();
+  size_ += size;
+}
+
+void Device::PinnedCache::invalidate(const void* addr, size_t size) {
+  uintptr_t start = reinterpret_cast<uintptr_t>(addr);
+  uintptr_t end = (size > (std::numeric_limits<uintptr_t>::max() - start)) ?
+      std::numeric_limits<uintptr_t>::max() : (start + size);
+  amd::ScopedLock l(lock_);
+  for (auto it = lru_.begin(); it != lru_.end();) {
+    uintptr_t host = reinterpret_cast<uintptr_t>((*it)->getHostMem());
+    if ((host < end) && (start < (host + (*it)->getSize()))) {
+      size_ -= (*it)->getSize();
+      ranges_.erase(host);
+      (*it)->release();
+      it = lru_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+Device::MemorySubAllocator::MemorySubAllocator(const Device& device, size_t maxBlockSize)
+    : dev_(device), numClasses_(0), lock_("Memory suballocator lock", true) {
+  while ((numClasses_ < kNumClasses) && (blockSize(numClasses_) <= maxBlockSize)) {
+    ++numClasses_;
+  }
+  for (auto& chunk : empty_) {
+    chunk = nullptr;
+  }
+}
+
+Device::MemorySubAllocator::~MemorySubAllocator() {
+  for (auto& it : chunks_) {
+    dev_.memFree(it.second->base_, kChunkSize);
+    delete it.second;
+  }
+}
+
+uint32_t Device::MemorySubAllocator::sizeClass(size_t size) {
+  uint32_t sizeClass = 0;
+  while (blockSize(sizeClass) < size) {
+    ++sizeClass;
+  }
+  return sizeClass;
+}
+
+void* Device::MemorySubAllocator::alloc(size_t size) {
+  if ((numClasses_ == 0) || (size > blockSize(numClasses_ - 1))) {
+    return nullptr;
+  }
+  const uint32_t sizeCls = sizeClass(size);
+
+  amd::ScopedLock l(lock_);
+  Chunk* chunk = nullptr;
+  if (!partial_[sizeCls].empty()) {
+    chunk = partial_[sizeCls].back();
+  } else if (empty_[sizeCls] != nullptr) {
+    chunk = empty_[sizeCls];
+    empty_[sizeCls] = nullptr;
+    partial_[sizeCls].push_back(chunk);
+  } else {
+    // Allocate a new chunk, which also enables the peer access for it
+    amd::MemoryStats::Scope scope(amd::MemoryStats::SubAlloc);
+    address base = reinterpret_cast<address>(dev_.deviceLocalAlloc(kChunkSize));
+    if (base == nullptr) {
+      return nullptr;
+    }
+    chunk = new Chunk;
+    chunk->base_ = base;
+    chunk->sizeClass_ = sizeCls;
+    const uint32_t numBlocks = static_cast<uint32_t>(kChunkSize / blockSize(sizeCls));
+    chunk->free_.reserve(numBlocks);
+    for (uint32_t i = numBlocks; i > 0; --i) {
+      chunk->free_.push_back(i - 1);
+    }
+    chunks_[reinterpret_cast<uintptr_t>(base)] = chunk;
+    partial_[sizeCls].push_back(chunk);
+    ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Suballocation chunk %p for blocks of 0x%zx bytes",
+            base, blockSize(sizeCls));
+  }
+
+  const uint32_t block = chunk->free_.back();
+  chunk->free_.pop_back();
+  if (chunk->free_.empty()) {
+    // The chunk is the last one in the list
+    partial_[sizeCls].pop_back();
+  }
+  return chunk->base_ + block * blockSize(sizeCls);
+}
+
+void Device::MemorySubAllocator::free(void* ptr) {
+  amd::ScopedLock l(lock_);
+  auto it = chunks_.upper_bound(reinterpret_cast<uintptr_t>(ptr));
+  assert((it != chunks_.begin()) && "Memory wasn't suballocated!");
+  Chunk* chunk = (--it)->second;
+  const uint32_t sizeCls = chunk->sizeClass_;
+  const uint32_t numBlocks = static_cast<uint32_t>(kChunkSize / blockSize(sizeCls));
+
+  if (chunk->free_.empty()) {
+    partial_[sizeCls].push_back(chunk);
+  }
+  chunk->free_.push_back(
+      static_cast<uint32_t>((reinterpret_cast<address>(ptr) - chunk->base_) / blockSize(sizeCls)));
+
+  if (chunk->free_.size() == numBlocks) {
+    auto& partial = partial_[sizeCls];
+    partial.erase(std::find(partial.begin(), partial.end(), chunk));
+    // Keep one empty chunk per size class to avoid ROCr calls on alloc/free loops
+    if (empty_[sizeCls] == nullptr) {
+      empty_[sizeCls] = chunk;
+    } else {
+      chunks_.erase(it);
+      dev_.memFree(chunk->base_, kChunkSize);
+      delete chunk;
+    }
+  }
+}
+
+void* Device::MemorySubAllocator::findChunk(const void* ptr, size_t* chunkSize) const {
+  amd::ScopedLock l(lock_);
+  auto it = chunks_.upper_bound(reinterpret_cast<uintptr_t>(ptr));
+  if (it == chunks_.begin()) {
+    return nullptr;
+  }
+  --it;
+  if (reinterpret_cast<uintptr_t>(ptr) >= (it->first + kChunkSize)) {
+    return nullptr;
+  }
+  if (chunkSize != nullptr) {
+    *chunkSize = kChunkSize;
+  }
+  return it->second->base_;
+}
+
 bool Device::init() {
   ClPrint(amd::LOG_INFO, amd::LOG_INIT, "Initializing HSA stack.");
 
@@ -480,15 +712,42 @@ bool Device::init() {
     gpu_agents_ = valid_agents;
   }
 
+  std::vector<std::unique_ptr<Device>> roc_devices;
   for (auto agent : gpu_agents_) {
-    std::unique_ptr<Device> roc_device(new Device(agent));
-    if (!roc_device) {
+    roc_devices.emplace_back(new Device(agent));
+    if (!roc_devices.back()) {
       LogError("Error creating new instance of Device on then heap.");
-      continue;
     }
+  }
 
-    if (!roc_device->create()) {
-      LogError("Error creating new instance of Device.");
+  // The device creation queries HSA and allocates the per-device state only, hence the devices
+  // can be created in parallel. That hides the HSA latencies on the systems with many GPUs
+  std::vector<char> created(roc_devices.size(), false);
+  auto createDevice = [&roc_devices, &created](size_t idx) {
+    created[idx] = (roc_devices[idx] != nullptr) && roc_devices[idx]->create();
+  };
+  if (ROC_PARALLEL_DEVICE_INIT && (roc_devices.size() > 1)) {
+    std::vector<std::thread> threads;
+    for (size_t idx = 1; idx < roc_devices.size(); ++idx) {
+      threads.emplace_back(createDevice, idx);
+    }
+    createDevice(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  } else {
+    for (size_t idx = 0; idx < roc_devices.size(); ++idx) {
+      createDevice(idx);
+    }
+  }
+
+  // Register the devices in the agent order, so the device indices don't depend on the threads
+  for (size_t idx = 0; idx < roc_devices.size(); ++idx) {
+    std::unique_ptr<Device>& roc_device = roc_devices[idx];
+    if (!created[idx]) {
+      if (roc_device) {
+        LogError("Error creating new instance of Device.");
+      }
       continue;
     }
 
@@ -496,7 +755,8 @@ bool Device::init() {
     // request via environment variable. By default the
     // System Memory is setup to be Coherent
     if (roc_device->settings().enableNCMode_) {
-      hsa_status_t err = hsa_amd_coherency_set_type(agent, HSA_AMD_COHERENCY_TYPE_NONCOHERENT);
+      hsa_status_t err = hsa_amd_coherency_set_type(roc_device->getBackendDevice(),
+                                                    HSA_AMD_COHERENCY_TYPE_NONCOHERENT);
       if (err != HSA_STATUS_SUCCESS) {
         LogError("Unable to set NC memory policy!");
         continue;
@@ -508,9 +768,19 @@ bool Device::init() {
       roc_device->getGlobalCUMask(ROC_GLOBAL_CU_MASK);
     }
 
+    // The calibration measures the host link, hence it runs for one device at a time
+    roc_device->calibrateCopyEngines();
+
     roc_device.release()->registerDevice();
   }
 
+  // Create the global context with all devices
+  if ((0 != Device::numDevices(CL_DEVICE_TYPE_GPU, false)) &&
+      !static_cast<Device*>(Device::devices().back())->createGlbCtx()) {
+    LogError("Couldn't create the global context");
+    return false;
+  }
+
   if (0 != Device::numDevices(CL_DEVICE_TYPE_GPU, false)) {
     // Loop through all available devices
     for (auto device1: Device::devices()) {
@@ -534,6 +804,7 @@ bool Device::init() {
 extern const char* SchedulerSourceCode;
 extern const char* GwsInitSourceCode;
 extern const char* rocBlitLinearSourceCode;
+extern const char* BlitWideSourceCode;
 
 void Device::tearDown() {
   NullDevice::tearDown();
@@ -724,49 +995,11 @@ bool Device::create() {
   // Use just 1 entry by default for the map cache
   mapCache_->push_back(nullptr);
 
-  if ((glb_ctx_ == nullptr) && (gpu_agents_.size() >= 1) &&
-      // Allow creation for the last device in the list.
-      (gpu_agents_[gpu_agents_.size() - 1].handle == bkendDevice_.handle)) {
-    std::vector<amd::Device*> devices;
-    uint32_t numDevices = amd::Device::numDevices(CL_DEVICE_TYPE_GPU, false);
-    // Add all PAL devices
-    for (uint32_t i = 0; i < numDevices; ++i) {
-      devices.push_back(amd::Device::devices()[i]);
-    }
-    // Add current
-    devices.push_back(this);
-    // Create a dummy context
-    glb_ctx_ = new amd::Context(devices, info);
-    if (glb_ctx_ == nullptr) {
-      return false;
-    }
-
-    if ((p2p_agents_.size() < (devices.size()-1)) && (devices.size() > 1)) {
-      amd::Buffer* buf = new (GlbCtx()) amd::Buffer(GlbCtx(), CL_MEM_ALLOC_HOST_PTR, kP2PStagingSize);
-      if ((buf != nullptr) && buf->create()) {
-        p2p_stage_ = buf;
-      }
-      else {
-        delete buf;
-        return false;
-      }
-    }
-    // Check if sync buffer wasn't allocated yet
-    if (amd::IS_HIP && mg_sync_ == nullptr) {
-      mg_sync_ = reinterpret_cast<address>(amd::SvmBuffer::malloc(
-          GlbCtx(), (CL_MEM_SVM_FINE_GRAIN_BUFFER | CL_MEM_SVM_ATOMICS),
-          kMGInfoSizePerDevice * GlbCtx().devices().size(), kMGInfoSizePerDevice));
-      if (mg_sync_ == nullptr) {
-        return false;
-      }
-    }
-  }
-
   if (settings().stagedXferSize_ != 0) {
-    // Initialize staged write buffers
+    // Initialize staged write buffers. The buffers are allocated on the first transfer
     if (settings().stagedXferWrite_) {
       xferWrite_ = new XferBuffers(*this, amd::alignUp(settings().stagedXferSize_, 4 * Ki));
-      if ((xferWrite_ == nullptr) || !xferWrite_->create()) {
+      if (xferWrite_ == nullptr) {
         LogError("Couldn't allocate transfer buffer objects for read");
         return false;
       }
@@ -775,13 +1008,29 @@ bool Device::create() {
     // Initialize staged read buffers
     if (settings().stagedXferRead_) {
       xferRead_ = new XferBuffers(*this, amd::alignUp(settings().stagedXferSize_, 4 * Ki));
-      if ((xferRead_ == nullptr) || !xferRead_->create()) {
+      if (xferRead_ == nullptr) {
         LogError("Couldn't allocate transfer buffer objects for write");
         return false;
       }
     }
   }
 
+  if (settings().pinnedCacheSize_ != 0) {
+    pinnedCache_ = new PinnedCache(settings().pinnedCacheSize_);
+    if (pinnedCache_ == nullptr) {
+      LogError("Couldn't allocate the cache of pinned host ranges");
+      return false;
+    }
+  }
+
+  if (settings().subAllocMaxSize_ != 0) {
+    mem_sub_alloc_ = new MemorySubAllocator(*this, settings().subAllocMaxSize_);
+    if (mem_sub_alloc_ == nullptr) {
+      LogError("Couldn't allocate the device memory suballocator");
+      return false;
+    }
+  }
+
   // Create signal for HMM prefetch operation on device
   if (HSA_STATUS_SUCCESS != hsa_signal_create(kInitSignalValueOne, 0, nullptr, &prefetch_signal_)) {
     return false;
@@ -790,6 +1039,45 @@ bool Device::create() {
   return true;
 }
 
+// ================================================================================================
+bool Device::createGlbCtx() {
+  assert((glb_ctx_ == nullptr) && "The global context was already created!");
+  amd::Context::Info info = {0};
+  std::vector<amd::Device*> devices;
+  uint32_t numDevices = amd::Device::numDevices(CL_DEVICE_TYPE_GPU, false);
+  // Add all registered devices, the current device is the last one
+  for (uint32_t i = 0; i < numDevices; ++i) {
+    devices.push_back(amd::Device::devices()[i]);
+  }
+  // Create a dummy context
+  glb_ctx_ = new amd::Context(devices, info);
+  if (glb_ctx_ == nullptr) {
+    return false;
+  }
+
+  if ((p2p_agents_.size() < (devices.size()-1)) && (devices.size() > 1)) {
+    amd::MemoryStats::Scope scope(amd::MemoryStats::Staging);
+    amd::Buffer* buf = new (GlbCtx()) amd::Buffer(GlbCtx(), CL_MEM_ALLOC_HOST_PTR, kP2PStagingSize);
+    if ((buf != nullptr) && buf->create()) {
+      p2p_stage_ = buf;
+    }
+    else {
+      delete buf;
+      return false;
+    }
+  }
+  // Check if sync buffer wasn't allocated yet
+  if (amd::IS_HIP && mg_sync_ == nullptr) {
+    mg_sync_ = reinterpret_cast<address>(amd::SvmBuffer::malloc(
+        GlbCtx(), (CL_MEM_SVM_FINE_GRAIN_BUFFER | CL_MEM_SVM_ATOMICS),
+        kMGInfoSizePerDevice * GlbCtx().devices().size(), kMGInfoSizePerDevice));
+    if (mg_sync_ == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // ================================================================================================
 device::Program* NullDevice::createProgram(amd::Program& owner, amd::option::Options* options) {
   device::Program* program;
@@ -853,7 +1141,7 @@ bool Device::createBlitProgram() {
     else {
       extraKernel = SchedulerSourceCode;
     }
-
+    extraKernel.append(BlitWideSourceCode);
   }
 #endif  // USE_COMGR_LIBRARY
 
@@ -1896,9 +2184,7 @@ device::Memory* Device::createMemory(size_t size) const {
 }
 
 // ================================================================================================
-void* Device::hostAlloc(size_t size, size_t alignment, MemorySegment mem_seg) const {
-  void* ptr = nullptr;
-
+hsa_amd_memory_pool_t Device::hostSegment(MemorySegment mem_seg) const {
   hsa_amd_memory_pool_t segment{0};
   switch (mem_seg) {
     case kKernArg : {
@@ -1922,8 +2208,25 @@ void* Device::hostAlloc(size_t size, size_t alignment, MemorySegment mem_seg) co
       guarantee(false && "Invalid Memory Segment");
       break;
   }
+  return segment;
+}
 
+// ================================================================================================
+void* Device::hostAlloc(size_t size, size_t alignment, MemorySegment mem_seg) const {
+  void* ptr = nullptr;
+
+  hsa_amd_memory_pool_t segment = hostSegment(mem_seg);
   assert(segment.handle != 0);
+
+  // Only the allocations, which fill the huge pages, avoid the waste of the memory
+  const size_t hugePageSize = static_cast<size_t>(ROC_HOST_HUGE_PAGES) * Mi;
+  if ((hugePageSize != 0) && (size >= hugePageSize)) {
+    ptr = hugePageAlloc(size, hugePageSize, segment);
+    if (ptr != nullptr) {
+      return ptr;
+    }
+  }
+
   hsa_status_t stat = hsa_amd_memory_pool_allocate(segment, size, 0, &ptr);
   ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Allocate hsa host memory %p, size 0x%zx", ptr, size);
   if (stat != HSA_STATUS_SUCCESS) {
@@ -1937,10 +2240,122 @@ void* Device::hostAlloc(size_t size, size_t alignment, MemorySegment mem_seg) co
     hostFree(ptr, size);
     return nullptr;
   }
+  memoryStats().allocated(ptr, size, true);
 
   return ptr;
 }
 
+// ================================================================================================
+void* Device::hostHugePageAlloc(size_t size, MemorySegment mem_seg) const {
+  const size_t hugePageSize = (ROC_HOST_HUGE_PAGES != 0)
+      ? static_cast<size_t>(ROC_HOST_HUGE_PAGES) * Mi : 2 * Mi;
+  return hugePageAlloc(size, hugePageSize, hostSegment(mem_seg));
+}
+
+// ================================================================================================
+void* Device::hugePageAlloc(size_t size, size_t hugePageSize,
+                            hsa_amd_memory_pool_t segment) const {
+  if (!amd::isPowerOfTwo(hugePageSize)) {
+    LogPrintfWarning("Invalid huge page size 0x%zx", hugePageSize);
+    return nullptr;
+  }
+  const size_t allocSize = amd::alignUp(size, hugePageSize);
+  void* ptr = amd::Os::reserveHugeMemory(allocSize, hugePageSize, amd::Os::MEM_PROT_RW);
+  if (ptr == nullptr) {
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM, "No huge pages of size 0x%zx for 0x%zx bytes",
+            hugePageSize, allocSize);
+    return nullptr;
+  }
+
+  if (!lockToPool(ptr, allocSize, segment)) {
+    return nullptr;
+  }
+  memoryStats().allocated(ptr, allocSize, true);
+  ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Allocate huge page host memory %p, size 0x%zx, "
+          "page size 0x%zx", ptr, allocSize, hugePageSize);
+  return ptr;
+}
+
+// ================================================================================================
+bool Device::lockToPool(void* ptr, size_t allocSize, hsa_amd_memory_pool_t segment) const {
+  // Register the pages with ROCr, so the GPUs access them with the same address
+  void* agentPtr = nullptr;
+  hsa_status_t stat = hsa_amd_memory_lock_to_pool(ptr, allocSize,
+      const_cast<hsa_agent_t*>(&gpu_agents_[0]), gpu_agents_.size(), segment, 0, &agentPtr);
+  if ((stat != HSA_STATUS_SUCCESS) || (agentPtr != ptr)) {
+    LogPrintfError("Fail locking host pages to the pool with err %d", stat);
+    if (stat == HSA_STATUS_SUCCESS) {
+      hsa_amd_memory_unlock(ptr);
+    }
+    amd::Os::releaseMemory(ptr, allocSize);
+    return false;
+  }
+  amd::ScopedLock lock(hugePageLock_);
+  hugePageAllocs_[ptr] = allocSize;
+  return true;
+}
+
+// ================================================================================================
+void* Device::interleavedAlloc(size_t size, hsa_amd_memory_pool_t segment) const {
+#ifdef ROCCLR_SUPPORT_NUMA_POLICY
+  if ((numa_available() < 0) || (cpu_agents_.size() < 2)) {
+    return nullptr;
+  }
+  const size_t allocSize = amd::alignUp(size, amd::Os::pageSize());
+  void* ptr = amd::Os::reserveMemory(nullptr, allocSize, amd::Os::pageSize(),
+                                     amd::Os::MEM_PROT_RW);
+  if (ptr == nullptr) {
+    return nullptr;
+  }
+  // The pages aren't touched yet, hence the lock faults them in with the policy.
+  // The CPU agents follow the order of the NUMA nodes, see setupCpuAgent()
+  bitmask* nodeMask = numa_bitmask_alloc(numa_num_possible_nodes());
+  for (uint32_t i = 0; i < cpu_agents_.size(); ++i) {
+    numa_bitmask_setbit(nodeMask, i);
+  }
+  long res = mbind(ptr, allocSize, MPOL_INTERLEAVE, nodeMask->maskp, nodeMask->size + 1, 0);
+  numa_bitmask_free(nodeMask);
+  if (res != 0) {
+    LogPrintfWarning("mbind(MPOL_INTERLEAVE) failed with error %ld", res);
+    amd::Os::releaseMemory(ptr, allocSize);
+    return nullptr;
+  }
+  if (!lockToPool(ptr, allocSize, segment)) {
+    return nullptr;
+  }
+  memoryStats().allocated(ptr, allocSize, true);
+  ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Allocate interleaved host memory %p, size 0x%zx on "
+          "%zu nodes", ptr, allocSize, cpu_agents_.size());
+  return ptr;
+#else
+  return nullptr;
+#endif // ROCCLR_SUPPORT_NUMA_POLICY
+}
+
+// ================================================================================================
+bool Device::hugePageFree(void* ptr) const {
+  size_t allocSize = 0;
+  {
+    amd::ScopedLock lock(hugePageLock_);
+    if (hugePageAllocs_.empty()) {
+      return false;
+    }
+    auto it = hugePageAllocs_.find(ptr);
+    if (it == hugePageAllocs_.end()) {
+      return false;
+    }
+    allocSize = it->second;
+    hugePageAllocs_.erase(it);
+  }
+  memoryStats().freed(ptr);
+  ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Free huge page host memory %p", ptr);
+  if (hsa_amd_memory_unlock(ptr) != HSA_STATUS_SUCCESS) {
+    LogError("Fail unlocking huge page host memory");
+  }
+  amd::Os::releaseMemory(ptr, allocSize);
+  return true;
+}
+
 // ================================================================================================
 void* Device::hostAgentAlloc(size_t size, const AgentInfo& agentInfo, bool atomics) const {
   void* ptr = nullptr;
@@ -1963,6 +2378,7 @@ void* Device::hostAgentAlloc(size_t size, const AgentInfo& agentInfo, bool atomi
     hostFree(ptr, size);
     return nullptr;
   }
+  memoryStats().allocated(ptr, size, true);
 
   return ptr;
 }
@@ -2010,7 +2426,31 @@ void* Device::hostNumaAlloc(size_t size, size_t alignment, bool atomics) const {
   return ptr;
 }
 
-void Device::hostFree(void* ptr, size_t size) const { memFree(ptr, size); }
+// ================================================================================================
+void* Device::hostNumaPolicyAlloc(size_t size, cl_mem_flags flags, bool atomics) const {
+  const MemorySegment segment = atomics ? MemorySegment::kAtomics : MemorySegment::kNoAtomics;
+  if (flags & ROCCLR_MEM_NUMA_INTERLEAVE) {
+    void* ptr = interleavedAlloc(size, hostSegment(segment));
+    if (ptr != nullptr) {
+      return ptr;
+    }
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM, "No interleaved host memory, using node %u",
+            preferred_numa_node_);
+  } else if (flags & ROCCLR_MEM_NUMA_NODE) {
+    const uint32_t node = ROCCLR_MEM_NUMA_NODE_ID(flags);
+    if (node < cpu_agents_.size()) {
+      return hostAgentAlloc(size, cpu_agents_[node], atomics);
+    }
+    LogPrintfWarning("Invalid NUMA node %u, using node %u", node, preferred_numa_node_);
+  }
+  return hostAlloc(size, 1, segment);
+}
+
+void Device::hostFree(void* ptr, size_t size) const {
+  if (!hugePageFree(ptr)) {
+    memFree(ptr, size);
+  }
+}
 
 bool Device::enableP2P(amd::Device* ptrDev) {
   assert(ptrDev != nullptr);
@@ -2038,6 +2478,13 @@ bool Device::disableP2P(amd::Device* ptrDev) {
 }
 
 bool Device::deviceAllowAccess(void* ptr) const {
+  // ROCr tracks the access of the whole chunk for suballocated memory
+  if (mem_sub_alloc_ != nullptr) {
+    void* chunk = mem_sub_alloc_->findChunk(ptr, nullptr);
+    if (chunk != nullptr) {
+      ptr = chunk;
+    }
+  }
   std::lock_guard<std::mutex> lock(lock_allow_access_);
   if (!p2pAgents().empty()) {
     hsa_status_t stat = hsa_amd_agents_allow_access(p2pAgents().size(),
@@ -2050,6 +2497,33 @@ bool Device::deviceAllowAccess(void* ptr) const {
   return true;
 }
 
+bool Device::deviceAllowAccess(const std::vector<void*>& ptrs) const {
+  if (p2pAgents().empty()) {
+    return true;
+  }
+  // The suballocations of a chunk share a single grant
+  std::unordered_set<void*> granted;
+  std::lock_guard<std::mutex> lock(lock_allow_access_);
+  for (auto ptr : ptrs) {
+    if (mem_sub_alloc_ != nullptr) {
+      void* chunk = mem_sub_alloc_->findChunk(ptr, nullptr);
+      if (chunk != nullptr) {
+        ptr = chunk;
+      }
+    }
+    if (!granted.insert(ptr).second) {
+      continue;
+    }
+    hsa_status_t stat = hsa_amd_agents_allow_access(p2pAgents().size(),
+                                                    p2pAgents().data(), nullptr, ptr);
+    if (stat != HSA_STATUS_SUCCESS) {
+      LogError("Allow p2p access");
+      return false;
+    }
+  }
+  return true;
+}
+
 void* Device::deviceLocalAlloc(size_t size, bool atomics) const {
   const hsa_amd_memory_pool_t& pool = (atomics)? gpu_fine_grained_segment_ : gpuvm_segment_;
 
@@ -2072,10 +2546,12 @@ void* Device::deviceLocalAlloc(size_t size, bool atomics) const {
     memFree(ptr, size);
     return nullptr;
   }
+  memoryStats().allocated(ptr, size, false);
   return ptr;
 }
 
 void Device::memFree(void* ptr, size_t size) const {
+  memoryStats().freed(ptr);
   hsa_status_t stat = hsa_amd_memory_pool_free(ptr);
   ClPrint(amd::LOG_DEBUG, amd::LOG_MEM, "Free hsa memory %p", ptr);
   if (stat != HSA_STATUS_SUCCESS) {
@@ -2141,6 +2617,17 @@ bool Device::IpcCreate(void* dev_ptr, size_t* mem_size, void* handle, size_t* me
     return false;
   }
 
+  // Suballocated memory shares the IPC handle of its chunk
+  if (mem_sub_alloc_ != nullptr) {
+    size_t chunk_size = 0;
+    void* chunk = mem_sub_alloc_->findChunk(orig_dev_ptr, &chunk_size);
+    if (chunk != nullptr) {
+      *mem_offset += reinterpret_cast<address>(orig_dev_ptr) - reinterpret_cast<address>(chunk);
+      *mem_size = chunk_size;
+      orig_dev_ptr = chunk;
+    }
+  }
+
   // Pass the pointer and memory size to retrieve the handle
   hsa_status = hsa_amd_ipc_memory_create(orig_dev_ptr, amd::alignUp(*mem_size, alloc_granularity()),
                                          reinterpret_cast<hsa_amd_ipc_memory_t*>(handle));
@@ -2158,6 +2645,23 @@ bool Device::IpcAttach(const void* handle, size_t mem_size, size_t mem_offset,
   amd::Memory* amd_mem_obj = nullptr;
   void* orig_dev_ptr = nullptr;
 
+  // The repeated opens of the same handle reuse the attachment without the KFD calls
+  std::string key;
+  amd::ScopedLock lock(ipcLock_);
+  if (ROC_IPC_MEM_CACHE_SIZE > 0) {
+    key.assign(reinterpret_cast<const char*>(handle), sizeof(hsa_amd_ipc_memory_t));
+    key.append(reinterpret_cast<const char*>(&mem_size), sizeof(mem_size));
+    auto it = ipcAttachments_.find(key);
+    if (it != ipcAttachments_.end()) {
+      if (it->second.refCount_++ == 0) {
+        ipcIdle_.remove(key);
+      }
+      guarantee((mem_offset < mem_size) && "IPC mem offset greater than allocated size");
+      *dev_ptr = it->second.devPtr_;
+      return true;
+    }
+  }
+
   // Retrieve the devPtr from the handle
   hsa_status_t hsa_status =
       hsa_amd_ipc_memory_attach(reinterpret_cast<const hsa_amd_ipc_memory_t*>(handle),
@@ -2196,13 +2700,95 @@ bool Device::IpcAttach(const void* handle, size_t mem_size, size_t mem_offset,
   //Make sure the mem_offset doesnt overflow the allocated memory
   guarantee((mem_offset < mem_size) && "IPC mem offset greater than allocated size");
 
+  if (!key.empty() && (ipcHandles_.find(orig_dev_ptr) == ipcHandles_.end())) {
+    ipcAttachments_[key] = {orig_dev_ptr, 1};
+    ipcHandles_[orig_dev_ptr] = key;
+  }
+
   // Return orig_dev_ptr
   *dev_ptr = reinterpret_cast<address>(orig_dev_ptr);
 
   return true;
 }
 
-bool Device::IpcDetach (void* dev_ptr) const {
+// ================================================================================================
+void Device::addCounterSample(const std::string& kernel,
+                              const std::vector<uint64_t>& values) const {
+  amd::ScopedLock lock(counterSamplesLock_);
+  CounterSample& sample = counterSamples_[kernel];
+  if (sample.values_.size() < values.size()) {
+    sample.values_.resize(values.size(), 0);
+  }
+  for (size_t i = 0; i < values.size(); ++i) {
+    sample.values_[i] += values[i];
+  }
+  ++sample.samples_;
+}
+
+// ================================================================================================
+bool Device::getCounterSamples(const std::string& kernel, std::vector<uint64_t>* values,
+                               uint64_t* samples) const {
+  amd::ScopedLock lock(counterSamplesLock_);
+  auto it = counterSamples_.find(kernel);
+  if (it == counterSamples_.end()) {
+    return false;
+  }
+  *values = it->second.values_;
+  *samples = it->second.samples_;
+  return true;
+}
+
+// ================================================================================================
+HwQueueStats* Device::hwQueueStats(const hsa_queue_t* queue) const {
+  amd::ScopedLock lock(hwQueueStatsLock_);
+  auto& stats = hwQueueStats_[queue->id];
+  if (stats == nullptr) {
+    stats.reset(new HwQueueStats());
+  }
+  return stats.get();
+}
+
+// ================================================================================================
+const amd::LatencyHistogram* Device::hwQueueStats(uint32_t index, HwQueueStat stat,
+                                                  uint64_t* queueId) const {
+  amd::ScopedLock lock(hwQueueStatsLock_);
+  if ((index >= hwQueueStats_.size()) || (stat >= HwQueueStatCount)) {
+    return nullptr;
+  }
+  auto it = std::next(hwQueueStats_.begin(), index);
+  if (queueId != nullptr) {
+    *queueId = it->first;
+  }
+  return &it->second->stats_[stat];
+}
+
+// ================================================================================================
+bool Device::IpcDetach(void* dev_ptr) const {
+  amd::ScopedLock lock(ipcLock_);
+  auto handle = ipcHandles_.find(dev_ptr);
+  if (handle == ipcHandles_.end()) {
+    return ipcDetachMemory(dev_ptr);
+  }
+  auto& attachment = ipcAttachments_[handle->second];
+  if (--attachment.refCount_ > 0) {
+    return true;
+  }
+  // Keep the closed attachment for the next open and detach the oldest ones over the limit
+  ipcIdle_.push_back(handle->second);
+  bool result = true;
+  while (ipcIdle_.size() > ROC_IPC_MEM_CACHE_SIZE) {
+    auto oldest = ipcAttachments_.find(ipcIdle_.front());
+    void* ptr = oldest->second.devPtr_;
+    ipcIdle_.pop_front();
+    ipcHandles_.erase(ptr);
+    ipcAttachments_.erase(oldest);
+    result &= ipcDetachMemory(ptr);
+  }
+  return result;
+}
+
+// ================================================================================================
+bool Device::ipcDetachMemory(void* dev_ptr) const {
   hsa_status_t hsa_status = HSA_STATUS_SUCCESS;
 
   amd::Memory* amd_mem_obj = amd::MemObjMap::FindMemObj(dev_ptr);
@@ -2622,6 +3208,53 @@ VirtualGPU* Device::xferQueue() const {
   return xferQueue_;
 }
 
+// ================================================================================================
+bool Device::importExtSemaphore(void** extSemaphore, const amd::Os::FileDesc& handle) {
+#if defined(_WIN32)
+  return false;
+#else
+  // The GPU waits and writes the payload in the queue with the stream operations, hence the
+  // semaphore doesn't need a round trip to the host thread
+  amd::BufferVk* payload = new (context()) amd::BufferVk(context(), sizeof(uint64_t), handle);
+  if (payload == nullptr) {
+    return false;
+  }
+  if (!payload->create()) {
+    LogError("External semaphore import failed");
+    payload->release();
+    return false;
+  }
+  *extSemaphore = payload;
+  return true;
+#endif
+}
+
+// ================================================================================================
+void Device::DestroyExtSemaphore(void* extSemaphore) {
+  reinterpret_cast<amd::BufferVk*>(extSemaphore)->release();
+}
+
+// ================================================================================================
+VirtualGPU* Device::scratchQueue(bool create) const {
+  VirtualGPU* queue = scratchQueue_.load(std::memory_order_acquire);
+  if ((queue == nullptr) && create) {
+    amd::ScopedLock lock(scratchQueueLock_);
+    queue = scratchQueue_.load(std::memory_order_relaxed);
+    if (queue == nullptr) {
+      // ROCr grows the scratch of this queue only, the other queues keep the default size
+      amd::ScopedLock vgpusLock(vgpusAccess());
+      queue = new VirtualGPU(*const_cast<Device*>(this), amd::IS_HIP, false);
+      if (!queue->create()) {
+        LogError("Couldn't create the scratch queue!");
+        delete queue;
+        return nullptr;
+      }
+      scratchQueue_.store(queue, std::memory_order_release);
+    }
+  }
+  return queue;
+}
+
 // ================================================================================================
 bool Device::SetClockMode(const cl_set_device_clock_mode_input_amd setClockModeInput,
   cl_set_device_clock_mode_output_amd* pSetClockModeOutput) {
@@ -2636,8 +3269,49 @@ bool Device::IsHwEventReady(const amd::Event& event, bool wait) const {
   if (hw_event == nullptr) {
     ClPrint(amd::LOG_INFO, amd::LOG_SIG, "No HW event");
     return false;
-  } else if (wait) {
-    return WaitForSignal(reinterpret_cast<ProfilingSignal*>(hw_event)->signal_, ActiveWait());
+  }
+  return IsHwTimestampReady(hw_event, wait);
+}
+
+// ================================================================================================
+bool Device::WaitHwEvents(const std::vector<amd::Event*>& events) const {
+  std::vector<hsa_signal_t> signals;
+  signals.reserve(events.size());
+  for (auto event : events) {
+    void* hw_event = (event->NotifyEvent() != nullptr) ?
+      event->NotifyEvent()->HwEvent() : event->HwEvent();
+    if (hw_event == nullptr) {
+      return false;
+    }
+    signals.push_back(reinterpret_cast<ProfilingSignal*>(hw_event)->signal_);
+  }
+
+  const hsa_wait_state_t wait_state = ActiveWait() ? HSA_WAIT_STATE_ACTIVE : HSA_WAIT_STATE_BLOCKED;
+  std::vector<hsa_signal_condition_t> conds(signals.size(), HSA_SIGNAL_CONDITION_LT);
+  std::vector<hsa_signal_value_t> values(signals.size(), kInitSignalValueOne);
+  while (true) {
+    // Drop all completed signals, hence every sleep waits for the unfinished work only
+    signals.erase(std::remove_if(signals.begin(), signals.end(), [](hsa_signal_t signal) {
+      return hsa_signal_load_scacquire(signal) < kInitSignalValueOne;
+    }), signals.end());
+    if (signals.empty()) {
+      break;
+    }
+    ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Host wait for %zu signals", signals.size());
+    hsa_signal_value_t value;
+    const uint32_t count = static_cast<uint32_t>(signals.size());
+    if (hsa_amd_signal_wait_any(count, signals.data(), conds.data(), values.data(),
+                                kUnlimitedWait, wait_state, &value) >= count) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ================================================================================================
+bool Device::IsHwTimestampReady(void* hw_event, bool wait) const {
+  if (wait) {
+    return WaitForSignalMode(reinterpret_cast<ProfilingSignal*>(hw_event)->signal_, GetWaitMode());
   }
   static constexpr bool Timeout = true;
   return WaitForSignal<Timeout>(reinterpret_cast<ProfilingSignal*>(hw_event)->signal_);
@@ -2651,11 +3325,16 @@ void Device::getHwEventTime(const amd::Event& event, uint64_t* start, uint64_t*
     ClPrint(amd::LOG_INFO, amd::LOG_SIG, "No HW event to read time");
     *start = *end = 0;
   } else {
-    fetchSignalTime(reinterpret_cast<ProfilingSignal*>(hw_event)->signal_, getBackendDevice(),
-                    start, end);
+    getHwTimestampTime(hw_event, start, end);
   }
 }
 
+// ================================================================================================
+void Device::getHwTimestampTime(void* hw_event, uint64_t* start, uint64_t* end) const {
+  fetchSignalTime(reinterpret_cast<ProfilingSignal*>(hw_event)->signal_, getBackendDevice(),
+                  start, end);
+}
+
 // ================================================================================================
 bool Device::IsCacheFlushed(Device::CacheState state) const {
 
@@ -2684,13 +3363,35 @@ static void callbackQueue(hsa_status_t status, hsa_queue_t* queue, void* data) {
 hsa_queue_t* Device::getQueueFromPool(const uint qIndex) {
   if (qIndex < QueuePriority::Total && queuePool_[qIndex].size() > 0) {
     typedef decltype(queuePool_)::value_type::const_reference PoolRef;
-    auto lowest = std::min_element(queuePool_[qIndex].begin(),
-        queuePool_[qIndex].end(), [] (PoolRef A, PoolRef B) {
-          return A.second.refCount < B.second.refCount;
-        });
-    ClPrint(amd::LOG_INFO, amd::LOG_QUEUE,
-        "selected queue with least refCount: %p (%d)", lowest->first,
-        lowest->second.refCount);
+    auto lowest = queuePool_[qIndex].begin();
+    if (ROC_QUEUE_LOAD_BALANCE) {
+      // The load is the packets in flight and the packets submitted since the last selection,
+      // so a queue, which is idle at the moment, but busy between the selections, isn't picked.
+      // The users count only breaks the ties
+      uint64_t lowestLoad = std::numeric_limits<uint64_t>::max();
+      for (auto it = queuePool_[qIndex].begin(); it != queuePool_[qIndex].end(); ++it) {
+        const uint64_t write = hsa_queue_load_write_index_relaxed(it->first);
+        const uint64_t read = hsa_queue_load_read_index_relaxed(it->first);
+        const uint64_t load = (write - std::min(read, write)) +
+                              (write - std::min(it->second.sampledWriteIndex_, write));
+        it->second.sampledWriteIndex_ = write;
+        if ((load < lowestLoad) ||
+            ((load == lowestLoad) && (it->second.refCount < lowest->second.refCount))) {
+          lowestLoad = load;
+          lowest = it;
+        }
+      }
+      ClPrint(amd::LOG_INFO, amd::LOG_QUEUE, "selected queue with least load: %p (%d, %lu)",
+              lowest->first, lowest->second.refCount, lowestLoad);
+    } else {
+      lowest = std::min_element(queuePool_[qIndex].begin(),
+          queuePool_[qIndex].end(), [] (PoolRef A, PoolRef B) {
+            return A.second.refCount < B.second.refCount;
+          });
+      ClPrint(amd::LOG_INFO, amd::LOG_QUEUE,
+          "selected queue with least refCount: %p (%d)", lowest->first,
+          lowest->second.refCount);
+    }
     lowest->second.refCount++;
     return lowest->first;
   } else {
@@ -2783,18 +3484,33 @@ hsa_queue_t* Device::acquireQueue(uint32_t queue_size_hint, bool coop_queue,
       " cooperative: %i", queue, queue_size, queue_priority, coop_queue);
 
   hsa_amd_profiling_set_profiler_enabled(queue, 1);
-  if (cuMask.size() != 0 || info_.globalCUMask_.size() != 0) {
+
+  // QoS mode: the low and normal priority queues leave the reserved CUs to the high priority
+  // queues, so the latency critical work isn't starved by the long running kernels
+  std::vector<uint32_t> qosMask;
+  if ((ROC_HIGH_PRIORITY_CU_RESERVE > 0) && (qIndex != QueuePriority::High) && !coop_queue &&
+      (cuMask.size() == 0)) {
+    const uint32_t numCUs = info_.maxComputeUnits_ * (settings().enableWgpMode_ ? 2 : 1);
+    const uint32_t reserved = std::min<uint32_t>(ROC_HIGH_PRIORITY_CU_RESERVE, numCUs - 1);
+    qosMask.resize(amd::alignUp(numCUs, 32) / 32, 0);
+    for (uint32_t cu = 0; cu < numCUs - reserved; ++cu) {
+      qosMask[cu / 32] |= 1u << (cu % 32);
+    }
+  }
+  const std::vector<uint32_t>& queueMask = (cuMask.size() != 0) ? cuMask : qosMask;
+
+  if (queueMask.size() != 0 || info_.globalCUMask_.size() != 0) {
     std::stringstream ss;
     ss << std::hex;
     std::vector<uint32_t> mask = {};
 
     // handle scenarios where cuMask (custom-defined), globalCUMask_ or both are valid and
     // fill the final mask which will be appiled to the current queue
-    if (cuMask.size() != 0 && info_.globalCUMask_.size() == 0) {
-      mask = cuMask;
-    } else if (cuMask.size() != 0 && info_.globalCUMask_.size() != 0) {
-      for (unsigned int i = 0; i < std::min(cuMask.size(), info_.globalCUMask_.size()); i++) {
-        mask.push_back(cuMask[i] & info_.globalCUMask_[i]);
+    if (queueMask.size() != 0 && info_.globalCUMask_.size() == 0) {
+      mask = queueMask;
+    } else if (queueMask.size() != 0 && info_.globalCUMask_.size() != 0) {
+      for (unsigned int i = 0; i < std::min(queueMask.size(), info_.globalCUMask_.size()); i++) {
+        mask.push_back(queueMask[i] & info_.globalCUMask_[i]);
       }
       // check to make sure after ANDing cuMask (custom-defined) with global
       //CU mask, we have non-zero mask, oterwise just apply global CU mask
@@ -2832,6 +3548,7 @@ hsa_queue_t* Device::acquireQueue(uint32_t queue_size_hint, bool coop_queue,
       assert(result.second && "QueueInfo already exists");
       auto& qInfo = result.first->second;
       qInfo.refCount = 1;
+      qInfo.sampledWriteIndex_ = 0;
 
       return queue;
     }
@@ -2846,6 +3563,7 @@ hsa_queue_t* Device::acquireQueue(uint32_t queue_size_hint, bool coop_queue,
   assert(result.second && "QueueInfo already exists");
   auto &qInfo = result.first->second;
   qInfo.refCount = 1;
+  qInfo.sampledWriteIndex_ = 0;
   return queue;
 }
 
@@ -2940,6 +3658,160 @@ bool Device::findLinkInfo(const amd::Device& other_device,
                        link_attrs);
 }
 
+bool Device::isXgmiPeer(const Device& other_device) const {
+  uint32_t hops = 0;
+  if ((HSA_STATUS_SUCCESS != hsa_amd_agent_memory_pool_get_info(bkendDevice_,
+          other_device.gpuvm_segment_, HSA_AMD_AGENT_MEMORY_POOL_INFO_NUM_LINK_HOPS, &hops)) ||
+      (hops == 0)) {
+    return false;
+  }
+  std::vector<hsa_amd_memory_pool_link_info_t> link_info(hops);
+  if (HSA_STATUS_SUCCESS != hsa_amd_agent_memory_pool_get_info(bkendDevice_,
+          other_device.gpuvm_segment_, HSA_AMD_AGENT_MEMORY_POOL_INFO_LINK_INFO,
+          link_info.data())) {
+    return false;
+  }
+  return (link_info[0].link_type == HSA_AMD_LINK_INFO_TYPE_XGMI);
+}
+
+// ================================================================================================
+void Device::calibrateCopyEngines() {
+  sdmaThreshold_[0] = sdmaThreshold_[1] = settings().sdmaCopyThreshold_;
+  constexpr size_t kLargeBarWriteSize = 8 * Ki;
+  largeBarWriteThreshold_ = info_.largeBar_ ? kLargeBarWriteSize : 0;
+  if (!ROC_COPY_ENGINE_CALIBRATE) {
+    return;
+  }
+
+  // The results depend on the device and its link, hence the file is per PCI location
+  std::string file;
+  const std::string path = amd::Device::cachePath();
+  if (!path.empty()) {
+    std::stringstream name;
+    name << path << amd::Os::fileSeparator() << "copy_engines_" << std::hex << pciDeviceId_
+         << "_" << static_cast<uint32_t>(info_.deviceTopology_.pcie.bus) << "_"
+         << static_cast<uint32_t>(info_.deviceTopology_.pcie.device) << "_"
+         << static_cast<uint32_t>(info_.deviceTopology_.pcie.function) << ".txt";
+    file = name.str();
+    if (loadCopyEngines(file)) {
+      return;
+    }
+  }
+
+  constexpr size_t kMinSize = 4 * Ki;
+  constexpr size_t kMaxSize = 16 * Mi;
+  constexpr uint32_t kRepeats = 3;
+  void* devPtr = deviceLocalAlloc(kMaxSize);
+  void* hostPtr = hostAlloc(kMaxSize, 0);
+  hsa_signal_t signal{0};
+  if ((devPtr == nullptr) || (hostPtr == nullptr) ||
+      (HSA_STATUS_SUCCESS != hsa_signal_create(1, 0, nullptr, &signal))) {
+    LogWarning("Couldn't allocate the resources for the copy engine calibration");
+    if (devPtr != nullptr) {
+      memFree(devPtr, kMaxSize);
+    }
+    if (hostPtr != nullptr) {
+      hostFree(hostPtr, kMaxSize);
+    }
+    return;
+  }
+
+  // Returns the best time of the copies. The GPU agent for the host memory selects the blit
+  // kernels in ROCr, the CPU agent selects SDMA
+  auto measure = [&](bool hostToDev, size_t size, hsa_agent_t hostAgent) {
+    uint64_t best = std::numeric_limits<uint64_t>::max();
+    for (uint32_t i = 0; i < kRepeats; ++i) {
+      hsa_signal_store_relaxed(signal, 1);
+      const uint64_t start = amd::Os::timeNanos();
+      hsa_status_t status = hostToDev ?
+          hsa_amd_memory_async_copy(devPtr, bkendDevice_, hostPtr, hostAgent, size,
+                                    0, nullptr, signal) :
+          hsa_amd_memory_async_copy(hostPtr, hostAgent, devPtr, bkendDevice_, size,
+                                    0, nullptr, signal);
+      if (status != HSA_STATUS_SUCCESS) {
+        break;
+      }
+      hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, 1, UINT64_MAX,
+                                HSA_WAIT_STATE_ACTIVE);
+      best = std::min(best, amd::Os::timeNanos() - start);
+    }
+    return best;
+  };
+
+  for (uint32_t dir = 0; dir < 2; ++dir) {
+    const bool hostToDev = (dir == 0);
+    // Warm up both engines, so the first measurement doesn't include the engine setup
+    measure(hostToDev, kMinSize, bkendDevice_);
+    measure(hostToDev, kMinSize, getCpuAgent());
+    // The blit path wins for small copies, find the size where SDMA becomes faster
+    size_t threshold = 0;
+    for (size_t size = kMinSize; size <= kMaxSize; size *= 2) {
+      if (measure(hostToDev, size, bkendDevice_) >= measure(hostToDev, size, getCpuAgent())) {
+        break;
+      }
+      threshold = size;
+    }
+    sdmaThreshold_[dir] = threshold;
+  }
+
+  // Direct CPU writes win for small uploads, find the size where the blit path becomes faster
+  if (info_.largeBar_ &&
+      (HSA_STATUS_SUCCESS == hsa_amd_agents_allow_access(1, &cpu_agent_, nullptr, devPtr))) {
+    constexpr size_t kMinBarSize = 256;
+    constexpr size_t kMaxBarSize = 64 * Ki;
+    size_t threshold = 0;
+    for (size_t size = kMinBarSize; size <= kMaxBarSize; size *= 2) {
+      uint64_t best = std::numeric_limits<uint64_t>::max();
+      for (uint32_t i = 0; i < kRepeats; ++i) {
+        const uint64_t start = amd::Os::timeNanos();
+        largeBarWrite(devPtr, hostPtr, size);
+        best = std::min(best, amd::Os::timeNanos() - start);
+      }
+      if (best >= measure(true, size, bkendDevice_)) {
+        break;
+      }
+      threshold = size;
+    }
+    largeBarWriteThreshold_ = threshold;
+  }
+
+  hsa_signal_destroy(signal);
+  memFree(devPtr, kMaxSize);
+  hostFree(hostPtr, kMaxSize);
+
+  ClPrint(amd::LOG_INFO, amd::LOG_INIT,
+          "Copy engine thresholds H2D %zu, D2H %zu, large BAR write %zu bytes",
+          sdmaThreshold_[0], sdmaThreshold_[1], largeBarWriteThreshold_);
+
+  if (!file.empty()) {
+    std::ofstream out(file, std::ios::trunc);
+    out << isa().targetId() << " " << AMD_BUILD_STRING << "\n"
+        << sdmaThreshold_[0] << " " << sdmaThreshold_[1] << " " << largeBarWriteThreshold_
+        << "\n";
+  }
+}
+
+// ================================================================================================
+bool Device::loadCopyEngines(const std::string& file) {
+  std::ifstream in(file);
+  std::string targetId;
+  std::string build;
+  size_t h2d = 0;
+  size_t d2h = 0;
+  size_t bar = 0;
+  if (!(in >> targetId >> build >> h2d >> d2h >> bar) || (targetId != isa().targetId()) ||
+      (build != AMD_BUILD_STRING)) {
+    return false;
+  }
+  sdmaThreshold_[0] = h2d;
+  sdmaThreshold_[1] = d2h;
+  largeBarWriteThreshold_ = info_.largeBar_ ? bar : 0;
+  ClPrint(amd::LOG_INFO, amd::LOG_INIT,
+          "Loaded copy engine thresholds H2D %zu, D2H %zu, large BAR write %zu bytes",
+          h2d, d2h, bar);
+  return true;
+}
+
 bool Device::findLinkInfo(const hsa_amd_memory_pool_t& pool,
                           std::vector<LinkAttrType>* link_attrs) {
 
@@ -3171,6 +4043,7 @@ void Device::HiddenHeapAlloc() {
   auto HeapAllocZeroOut = [this]()->bool {
     // Allocate initial heap for device memory allocator
     static constexpr size_t HeapBufferSize = 128 * Ki;
+    amd::MemoryStats::Scope scope(amd::MemoryStats::DeviceHeap);
     heap_buffer_ = createMemory(HeapBufferSize);
     // Clear memory to 0 for device library logic
     if ((heap_buffer_ == nullptr) ||
@@ -3185,6 +4058,107 @@ void Device::HiddenHeapAlloc() {
   std::call_once(heap_initialized_, HeapAllocZeroOut);
 }
 
+// ================================================================================================
+void Device::ReleasePinnedRange(const void* hostPtr, size_t size) const {
+  if (pinnedCache_ != nullptr) {
+    // Page aligned ranges may start before the host pointer
+    const char* start = amd::alignDown(reinterpret_cast<const char*>(hostPtr),
+                                       PinnedMemoryAlignment);
+    pinnedCache_->invalidate(start, size + (reinterpret_cast<const char*>(hostPtr) - start));
+  }
+}
+
+// ================================================================================================
+void Device::hostCopy(void* dst, const void* src, size_t size) const {
+  if ((GPU_HOST_COPY_THREADS == 0) || (size < 2 * amd::HostCopyPool::kMinPartSize)) {
+    memcpy(dst, src, size);
+    return;
+  }
+  auto HostCopyPoolCreate = [this]() {
+    host_copy_pool_ = new amd::HostCopyPool(GPU_HOST_COPY_THREADS,
+                                            static_cast<int32_t>(preferred_numa_node_));
+    if ((host_copy_pool_ != nullptr) && !host_copy_pool_->create()) {
+      LogWarning("Host copy workers creation failed, copies will use the calling thread");
+      delete host_copy_pool_;
+      host_copy_pool_ = nullptr;
+    }
+  };
+  std::call_once(host_copy_initialized_, HostCopyPoolCreate);
+  if (host_copy_pool_ != nullptr) {
+    host_copy_pool_->copy(dst, src, size);
+  } else {
+    memcpy(dst, src, size);
+  }
+}
+
+// ================================================================================================
+void Device::largeBarWrite(void* dst, const void* src, size_t size) const {
+  // The streaming stores are combined in the WC buffers and drained before the GPU can observe
+  // the data
+  amd::Os::streamMemcpy(dst, src, size);
+  // Flush HDP, so the GPU doesn't read stale data from memory
+  if (info_.hdpMemFlushCntl != nullptr) {
+    *reinterpret_cast<volatile uint32_t*>(info_.hdpMemFlushCntl) = 1;
+  }
+}
+
+// ================================================================================================
+void Device::largeBarFlush() const {
+  // The application wrote with regular stores, so drain the WC buffers before the HDP flush
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (info_.hdpMemFlushCntl != nullptr) {
+    *reinterpret_cast<volatile uint32_t*>(info_.hdpMemFlushCntl) = 1;
+  }
+}
+
+// ================================================================================================
+bool ProfilingSignal::terminate() {
+  // A busy signal can't be reused, hence the destructor will wait for it
+  if ((pool_ != nullptr) && (signal_.handle != 0) && (hsa_signal_load_relaxed(signal_) <= 0)) {
+    if (ts_ != nullptr) {
+      ts_->release();
+      ts_ = nullptr;
+    }
+    done_ = true;
+    // Restore the reference for the next owner before the signal becomes visible in the pool
+    retain();
+    if (pool_->RecycleProfilingSignal(this)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ================================================================================================
+ProfilingSignal* Device::AcquireProfilingSignal() const {
+  ProfilingSignal* signal = signal_pool_.dequeue();
+  if (signal != nullptr) {
+    --signal_pool_size_;
+    return signal;
+  }
+  std::unique_ptr<ProfilingSignal> new_signal(new ProfilingSignal(this));
+  if (new_signal == nullptr) {
+    return nullptr;
+  }
+  hsa_agent_t agent = getBackendDevice();
+  hsa_agent_t* agents = (settings().system_scope_signal_) ? nullptr : &agent;
+  uint32_t num_agents = (settings().system_scope_signal_) ? 0 : 1;
+  if (HSA_STATUS_SUCCESS != hsa_signal_create(0, num_agents, agents, &new_signal->signal_)) {
+    return nullptr;
+  }
+  return new_signal.release();
+}
+
+// ================================================================================================
+bool Device::RecycleProfilingSignal(ProfilingSignal* signal) const {
+  if (signal_pool_closed_.load() || (signal_pool_size_ >= ROC_SIGNAL_RECYCLE_LIMIT)) {
+    return false;
+  }
+  ++signal_pool_size_;
+  signal_pool_.enqueue(signal);
+  return true;
+}
+
 // ================================================================================================
 ProfilingSignal::~ProfilingSignal() {
   if (signal_.handle != 0) {
@@ -29,6 +29,7 @@
 #include "platform/program.hpp"
 #include "platform/perfctr.hpp"
 #include "platform/memory.hpp"
+#include "platform/hostcopy.hpp"
 #include "utils/concurrent.hpp"
 #include "thread/thread.hpp"
 #include "thread/monitor.hpp"
@@ -47,6 +48,9 @@
 
 #include <atomic>
 #include <iostream>
+#include <list>
+#include <map>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
@@ -76,6 +80,7 @@ class Resource;
 class VirtualDevice;
 class PrintfDbg;
 class IProDevice;
+class Device;
 
 class ProfilingSignal : public amd::ReferenceCountedObject {
 public:
@@ -84,15 +89,21 @@ public:
   HwQueueEngine engine_;  //!< Engine used with this signal
   bool          done_;    //!< True if signal is done
   amd::Monitor  lock_;    //!< Signal lock for update
-  ProfilingSignal()
+  const Device* pool_;    //!< The device, which recycles the signal, or nullptr
+  ProfilingSignal(const Device* pool = nullptr)
     : ts_(nullptr)
     , engine_(HwQueueEngine::Compute)
     , done_(true)
     , lock_("Signal Ops Lock", true)
+    , pool_(pool)
     { signal_.handle = 0; }
 
   virtual ~ProfilingSignal();
   amd::Monitor& LockSignalOps() { return lock_; }
+
+ protected:
+  //! Returns the idle signal into the device pool instead of the destruction
+  virtual bool terminate();
 };
 
 class Sampler : public device::Sampler {
@@ -222,12 +233,10 @@ class NullDevice : public amd::Device {
     return !settings().enableCoarseGrainSVM_ || (memory->getContext().devices().size() > 1);
   }
 
-  virtual bool importExtSemaphore(void** extSemahore, const amd::Os::FileDesc& handle) {
-    ShouldNotReachHere();
-    return false;
-  }
+  //! Imports a memory backed semaphore, a dma-buf with the 64 bit payload at offset 0
+  virtual bool importExtSemaphore(void** extSemaphore, const amd::Os::FileDesc& handle);
 
-  virtual void DestroyExtSemaphore(void* extSemaphore) { ShouldNotReachHere(); }
+  virtual void DestroyExtSemaphore(void* extSemaphore);
 
   //! Acquire external graphics API object in the host thread
   //! Needed for OpenGL objects on CPU device
@@ -300,6 +309,11 @@ struct AgentInfo {
 };
 
 //! A HSA device ordinal (physical HSA device)
+//! Submission stats of a HW queue, shared by all virtual GPUs on the queue
+struct HwQueueStats : public amd::HeapObject {
+  amd::LatencyHistogram stats_[amd::Device::HwQueueStatCount];
+};
+
 class Device : public NullDevice {
  public:
   //! Transfer buffers
@@ -345,6 +359,92 @@ class Device : public NullDevice {
     const Device& gpuDevice_;         //!< GPU device object
   };
 
+  //! LRU cache of the pinned host ranges, used in the pageable transfers
+  class PinnedCache : public amd::HeapObject {
+   public:
+    //! Default constructor
+    PinnedCache(size_t maxSize) : maxSize_(maxSize), size_(0), lock_("Pinned cache lock") {}
+
+    //! Default destructor
+    ~PinnedCache();
+
+    //! Finds a pinned range at the page aligned address and retains it for the caller
+    amd::Memory* find(const void* addr,  //!< Page aligned host address
+                      size_t size        //!< Size of the transfer, including the alignment
+                      );
+
+    //! Adds a pinned range to the cache, the cache takes its own reference
+    void add(amd::Memory* mem);
+
+    //! Releases all pinned ranges, which overlap [addr, addr + size)
+    void invalidate(const void* addr, size_t size);
+
+   private:
+    //! Disable copy constructor
+    PinnedCache(const PinnedCache&);
+
+    //! Disable assignment operator
+    PinnedCache& operator=(const PinnedCache&);
+
+    typedef std::list<amd::Memory*> LruList;
+
+    size_t maxSize_;  //!< The maximum size of the cached ranges
+    size_t size_;     //!< The current size of the cached ranges
+    LruList lru_;     //!< The cached ranges, the most recently used first
+    std::unordered_map<uintptr_t, LruList::iterator> ranges_;  //!< Ranges by the host address
+    amd::Monitor lock_;  //!< Cache access lock
+  };
+
+  //! Suballocates small device memory allocations from large chunks, similar to PAL
+  class MemorySubAllocator : public amd::HeapObject {
+   public:
+    static constexpr size_t kChunkSize = 2 * Mi;     //!< The size of a chunk, allocated in ROCr
+    static constexpr size_t kMinBlockSize = 4 * Ki;  //!< The smallest suballocation
+
+    //! Default constructor
+    MemorySubAllocator(const Device& device, size_t maxBlockSize);
+
+    //! Default destructor
+    ~MemorySubAllocator();
+
+    //! Suballocates device memory, returns nullptr if the size is too big or no memory
+    void* alloc(size_t size);
+
+    //! Frees a suballocation
+    void free(void* ptr);
+
+    //! Returns the chunk of a suballocation and its size, nullptr if it's not suballocated
+    void* findChunk(const void* ptr, size_t* chunkSize) const;
+
+   private:
+    //! Disable copy constructor
+    MemorySubAllocator(const MemorySubAllocator&);
+
+    //! Disable assignment operator
+    MemorySubAllocator& operator=(const MemorySubAllocator&);
+
+    struct Chunk {
+      address base_;                   //!< Device address of the chunk
+      uint32_t sizeClass_;             //!< Size class of the blocks in the chunk
+      std::vector<uint32_t> free_;     //!< Indices of the free blocks
+    };
+
+    //! Returns the size class of the allocation size
+    static uint32_t sizeClass(size_t size);
+
+    //! Returns the block size of the size class
+    static size_t blockSize(uint32_t sizeClass) { return kMinBlockSize << sizeClass; }
+
+    static constexpr uint32_t kNumClasses = 10;  //!< Up to kChunkSize / 2 blocks
+
+    const Device& dev_;     //!< GPU device object
+    uint32_t numClasses_;   //!< Number of the size classes, allowed for suballocation
+    std::map<uintptr_t, Chunk*> chunks_;       //!< All chunks by the base address
+    std::vector<Chunk*> partial_[kNumClasses];  //!< Chunks with free blocks per size class
+    Chunk* empty_[kNumClasses];               //!< A cached empty chunk per size class
+    mutable amd::Monitor lock_;               //!< Suballocation lock
+  };
+
   //! Initialise the whole HSA device subsystem (CAL init, device enumeration, etc).
   static bool init();
   static void tearDown();
@@ -402,6 +502,12 @@ class Device : public NullDevice {
 
   virtual device::Signal* createSignal() const;
 
+  //! Returns a recycled or a new profiling signal. The signal is reset to the idle state
+  ProfilingSignal* AcquireProfilingSignal() const;
+
+  //! Takes an idle profiling signal for recycling, returns false if the pool is full
+  bool RecycleProfilingSignal(ProfilingSignal* signal) const;
+
   //! Acquire external graphics API object in the host thread
   //! Needed for OpenGL objects on CPU device
   virtual bool bindExternalDevice(uint flags, void* const pDevice[], void* pContext,
@@ -430,11 +536,18 @@ class Device : public NullDevice {
 
   virtual void hostFree(void* ptr, size_t size = 0) const;
 
+  //! Allocates the host memory backed with the huge pages of ROC_HOST_HUGE_PAGES size,
+  //! 2MB by default. Returns nullptr if the huge pages aren't available
+  void* hostHugePageAlloc(size_t size, MemorySegment mem_seg = MemorySegment::kNoAtomics) const;
+
   virtual bool enableP2P(amd::Device* peerDev);
   virtual bool disableP2P(amd::Device* peerDev);
 
   bool deviceAllowAccess(void* dst) const;
 
+  //! Allows the peer access with a single ROCr call per suballocation chunk
+  bool deviceAllowAccess(const std::vector<void*>& ptrs) const;
+
   void* deviceLocalAlloc(size_t size, bool atomics = false) const;
 
   void memFree(void* ptr, size_t size) const;
@@ -456,7 +569,10 @@ class Device : public NullDevice {
                             cl_set_device_clock_mode_output_amd* pSetClockModeOutput);
 
   virtual bool IsHwEventReady(const amd::Event& event, bool wait = false) const;
+  virtual bool WaitHwEvents(const std::vector<amd::Event*>& events) const;
   virtual void getHwEventTime(const amd::Event& event, uint64_t* start, uint64_t* end) const;
+  virtual bool IsHwTimestampReady(void* hw_event, bool wait = false) const;
+  virtual void getHwTimestampTime(void* hw_event, uint64_t* start, uint64_t* end) const;
   virtual bool IsCacheFlushed(Device::CacheState state) const;
   virtual void SetCacheState(Device::CacheState state);
   virtual void ReleaseGlobalSignal(void* signal) const;
@@ -467,6 +583,9 @@ class Device : public NullDevice {
   //! Allocate host memory from agent info
   void* hostAgentAlloc(size_t size, const AgentInfo& agentInfo, bool atomics = false) const;
 
+  //! Allocates the host memory with the ROCCLR_MEM_NUMA_* placement of \a flags
+  void* hostNumaPolicyAlloc(size_t size, cl_mem_flags flags, bool atomics = false) const;
+
   //! Returns transfer engine object
   const device::BlitManager& xferMgr() const { return xferQueue()->blitMgr(); }
 
@@ -486,6 +605,34 @@ class Device : public NullDevice {
   //! Returns transfer buffer object
   XferBuffers& xferRead() const { return *xferRead_; }
 
+  //! Returns the cache of pinned host ranges, nullptr if the cache is disabled
+  PinnedCache* pinnedCache() const { return pinnedCache_; }
+
+  //! Releases the cached pinned ranges, which overlap the host memory range
+  virtual void ReleasePinnedRange(const void* hostPtr, size_t size) const;
+
+  //! Returns the suballocator of small device allocations, nullptr if it's disabled
+  MemorySubAllocator* memSubAllocator() const { return mem_sub_alloc_; }
+
+  //! Returns the size up to which the copies with the host use the blit path instead of SDMA
+  size_t sdmaCopyThreshold(bool hostToDev, bool busy) const {
+    const size_t threshold = sdmaThreshold_[hostToDev ? 0 : 1];
+    // Blit kernels compete with the queued dispatches for the CUs, hence prefer SDMA
+    return busy ? (threshold / 4) : threshold;
+  }
+
+  //! Copies host memory and splits a large copy between the workers, closest to the device
+  void hostCopy(void* dst, const void* src, size_t size) const;
+
+  //! Returns the size up to which the CPU writes directly into the large BAR visible memory
+  size_t largeBarWriteThreshold() const { return largeBarWriteThreshold_; }
+
+  //! Writes host data into the large BAR visible memory with streaming stores and flushes HDP
+  void largeBarWrite(void* dst, const void* src, size_t size) const;
+
+  //! Drains the CPU writes into the large BAR visible memory and flushes HDP
+  void largeBarFlush() const;
+
   //! Returns a ROC memory object from AMD memory object
   roc::Memory* getRocMemory(amd::Memory* mem  //!< Pointer to AMD memory object
                             ) const;
@@ -511,6 +658,16 @@ class Device : public NullDevice {
                          unsigned int flags, void** dev_ptr) const;
   virtual bool IpcDetach (void* dev_ptr) const;
 
+  //! Adds the counter values of a sampled dispatch of \a kernel
+  void addCounterSample(const std::string& kernel, const std::vector<uint64_t>& values) const;
+  virtual bool getCounterSamples(const std::string& kernel, std::vector<uint64_t>* values,
+                                 uint64_t* samples) const;
+
+  //! Returns the stats of the HW queue, the stats outlive the queue
+  HwQueueStats* hwQueueStats(const hsa_queue_t* queue) const;
+  virtual const amd::LatencyHistogram* hwQueueStats(uint32_t index, HwQueueStat stat,
+                                                    uint64_t* queueId) const;
+
   bool AcquireExclusiveGpuAccess();
   void ReleaseExclusiveGpuAccess(VirtualGPU& vgpu) const;
 
@@ -524,6 +681,10 @@ class Device : public NullDevice {
 
   VirtualGPU* xferQueue() const;
 
+  //! Returns the queue for the kernels with large private segments, NULL if \a create is false
+  //! and the queue doesn't exist
+  VirtualGPU* scratchQueue(bool create = true) const;
+
   hsa_amd_memory_pool_t SystemSegment() const { return system_segment_; }
 
   hsa_amd_memory_pool_t SystemCoarseSegment() const { return system_coarse_segment_; }
@@ -549,6 +710,15 @@ class Device : public NullDevice {
   virtual bool findLinkInfo(const amd::Device& other_device,
                             std::vector<LinkAttrType>* link_attr);
 
+  //! Returns TRUE if the memory of the other device is accessed over xGMI
+  bool isXgmiPeer(const Device& other_device) const;
+
+  //! Measures SDMA and blit copies with the host and selects the engine thresholds
+  void calibrateCopyEngines();
+
+  //! Loads the thresholds of a previous calibration, returns false if the file doesn't match
+  bool loadCopyEngines(const std::string& file);
+
   //! Returns a GPU memory object from AMD memory object
   roc::Memory* getGpuMemory(amd::Memory* mem  //!< Pointer to AMD memory object
                             ) const;
@@ -561,6 +731,11 @@ class Device : public NullDevice {
   virtual amd::Memory* GetArenaMemObj(const void* ptr, size_t& offset, size_t size = 0);
 
   const uint32_t getPreferredNumaNode() const { return preferred_numa_node_; }
+
+  //! Returns the CPU NUMA node for the queue threads, -1 if the threads aren't pinned
+  virtual int32_t queueNumaNode() const {
+    return ROC_QUEUE_NUMA_AFFINITY ? static_cast<int32_t>(preferred_numa_node_) : -1;
+  }
   const bool isFineGrainSupported() const;
 
   //! Returns True if memory pointer is known to ROCr (excludes HMM allocations)
@@ -572,6 +747,9 @@ class Device : public NullDevice {
  private:
   bool create();
 
+  //! Creates the global context with all registered devices and its shared buffers
+  bool createGlbCtx();
+
   //! Construct a new physical HSA device
   Device(hsa_agent_t bkendDevice);
 
@@ -612,25 +790,85 @@ class Device : public NullDevice {
   size_t alloc_granularity_;
   static constexpr bool offlineDevice_ = false;
   VirtualGPU* xferQueue_;  //!< Transfer queue, created on demand
+  mutable std::atomic<VirtualGPU*> scratchQueue_{nullptr};  //!< Scratch queue, created on demand
+  mutable amd::Monitor scratchQueueLock_{"Scratch queue creation lock"};
 
   XferBuffers* xferRead_;   //!< Transfer buffers read
   XferBuffers* xferWrite_;  //!< Transfer buffers write
+  PinnedCache* pinnedCache_;  //!< Pinned host ranges, cached between transfers
+  MemorySubAllocator* mem_sub_alloc_;  //!< Suballocator of small device allocations
+  size_t sdmaThreshold_[2];  //!< Blit thresholds of the host copies, H2D and D2H
+  size_t largeBarWriteThreshold_;  //!< Max size of the direct CPU writes over large BAR
+  mutable std::once_flag host_copy_initialized_;  //!< Host copy pool initialization flag
+  mutable amd::HostCopyPool* host_copy_pool_;     //!< Workers of the large host copies
   const IProDevice* pro_device_;  //!< AMDGPUPro device
   bool  pro_ena_;           //!< Extra functionality with AMDGPUPro device, beyond ROCr
   std::atomic<size_t> freeMem_;   //!< Total of free memory available
   mutable amd::Monitor vgpusAccess_;     //!< Lock to serialise virtual gpu list access
+  //! Idle profiling signals for recycling between the queues without the signal creation
+  mutable amd::ConcurrentLinkedQueue<ProfilingSignal*> signal_pool_;
+  mutable std::atomic<uint32_t> signal_pool_size_{0};  //!< The number of signals in the pool
+  std::atomic<bool> signal_pool_closed_{false};  //!< The pool doesn't accept signals anymore
   bool hsa_exclusive_gpu_access_;  //!< TRUE if current device was moved into exclusive GPU access mode
   static address mg_sync_;  //!< MGPU grid launch sync memory (SVM location)
 
+  struct IpcAttachment {
+    void* devPtr_;   //!< Device address of the attached memory
+    uint refCount_;  //!< Number of the opens, which aren't closed yet
+  };
+  //! IPC attachments by the handle bytes. The closed attachments stay until they are evicted
+  mutable std::unordered_map<std::string, IpcAttachment> ipcAttachments_;
+  mutable std::unordered_map<void*, std::string> ipcHandles_;  //!< Handles by the device address
+  mutable std::list<std::string> ipcIdle_;  //!< The closed attachments, the oldest first
+  mutable amd::Monitor ipcLock_;            //!< Lock to serialise the IPC attachments access
+
+  //! Releases the memory object of the IPC memory and detaches it with the last reference
+  bool ipcDetachMemory(void* dev_ptr) const;
+
+  struct CounterSample {
+    std::vector<uint64_t> values_;  //!< Sums of the counters over all samples
+    uint64_t samples_;              //!< Number of the sampled dispatches
+  };
+  //! Sampled counters by the kernel name
+  mutable std::unordered_map<std::string, CounterSample> counterSamples_;
+  mutable amd::Monitor counterSamplesLock_{"Counter samples lock"};
+
+  //! Returns the system pool of the host allocations in \a mem_seg
+  hsa_amd_memory_pool_t hostSegment(MemorySegment mem_seg) const;
+
+  //! Allocates the huge pages in the OS and locks them to \a segment
+  void* hugePageAlloc(size_t size, size_t hugePageSize, hsa_amd_memory_pool_t segment) const;
+
+  //! Locks the OS allocation to \a segment and tracks it for hugePageFree(), releases it on
+  //! a failure
+  bool lockToPool(void* ptr, size_t allocSize, hsa_amd_memory_pool_t segment) const;
+
+  //! Allocates the pages interleaved across the CPU NUMA nodes and locks them to \a segment.
+  //! Returns nullptr if the NUMA policy isn't supported
+  void* interleavedAlloc(size_t size, hsa_amd_memory_pool_t segment) const;
+
+  //! Frees the memory of hugePageAlloc() or interleavedAlloc(), returns false if \a ptr
+  //! isn't such allocation
+  bool hugePageFree(void* ptr) const;
+
+  //! The locked allocations and their sizes, rounded up to the page
+  mutable std::unordered_map<void*, size_t> hugePageAllocs_;
+  mutable amd::Monitor hugePageLock_{"Huge page allocations lock"};
+
+  //! Stats of the HW queues by the queue ID
+  mutable std::map<uint64_t, std::unique_ptr<HwQueueStats>> hwQueueStats_;
+  mutable amd::Monitor hwQueueStatsLock_{"HW queue stats lock"};
+
   struct QueueInfo {
     int refCount;
     void* hostcallBuffer_;
+    uint64_t sampledWriteIndex_;  //!< The write index at the last pool selection
   };
 
   //! a vector for keeping Pool of HSA queues with low, normal and high priorities for recycling
   std::vector<std::map<hsa_queue_t*, QueueInfo>> queuePool_;
 
-  //! returns a hsa queue from queuePool with least refCount and updates the refCount as well
+  //! returns a hsa queue from queuePool with the least load and updates the refCount as well
   hsa_queue_t* getQueueFromPool(const uint qIndex);
 
   void* coopHostcallBuffer_;
@@ -43,6 +43,37 @@ Kernel::Kernel(std::string name, Program* prog)
     : device::Kernel(prog->device(), name, *prog) {
 }
 
+const Kernel::HiddenArgs& Kernel::hiddenArgs(const amd::KernelSignature& signature) const {
+  std::call_once(hiddenArgsOnce_, [&]() {
+    for (uint32_t i = signature.numParameters(); i < signature.numParametersAll(); ++i) {
+      const amd::KernelParameterDescriptor& desc = signature.at(i);
+      switch (desc.info_.oclObject_) {
+        case amd::KernelParameterDescriptor::HiddenNone:
+          break;
+        case amd::KernelParameterDescriptor::HiddenGlobalOffsetX:
+        case amd::KernelParameterDescriptor::HiddenGlobalOffsetY:
+        case amd::KernelParameterDescriptor::HiddenGlobalOffsetZ:
+        case amd::KernelParameterDescriptor::HiddenBlockCountX:
+        case amd::KernelParameterDescriptor::HiddenBlockCountY:
+        case amd::KernelParameterDescriptor::HiddenBlockCountZ:
+        case amd::KernelParameterDescriptor::HiddenGroupSizeX:
+        case amd::KernelParameterDescriptor::HiddenGroupSizeY:
+        case amd::KernelParameterDescriptor::HiddenGroupSizeZ:
+        case amd::KernelParameterDescriptor::HiddenRemainderX:
+        case amd::KernelParameterDescriptor::HiddenRemainderY:
+        case amd::KernelParameterDescriptor::HiddenRemainderZ:
+        case amd::KernelParameterDescriptor::HiddenGridDims:
+          hiddenArgs_.sizes_.push_back(&desc);
+          break;
+        default:
+          hiddenArgs_.resources_.push_back(&desc);
+          break;
+      }
+    }
+  });
+  return hiddenArgs_;
+}
+
 #if defined(USE_COMGR_LIBRARY)
 bool LightningKernel::init() {
   return GetAttrCodePropMetadata();
@@ -21,6 +21,8 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+#include <vector>
 #include "rocprogram.hpp"
 #include "top.hpp"
 #include "rocprintf.hpp"
@@ -46,6 +48,19 @@ class Kernel : public device::Kernel {
   virtual bool init() = 0;
 
   const Program* program() const { return static_cast<const Program*>(&prog_); }
+
+  //! Hidden arguments of the kernel, split by the way a dispatch fills them
+  struct HiddenArgs {
+    std::vector<const amd::KernelParameterDescriptor*> sizes_;      //!< Offsets and launch sizes
+    std::vector<const amd::KernelParameterDescriptor*> resources_;  //!< Buffers and queue state
+  };
+
+  //! Returns the hidden arguments of \a signature, collected on the first launch
+  const HiddenArgs& hiddenArgs(const amd::KernelSignature& signature) const;
+
+ private:
+  mutable std::once_flag hiddenArgsOnce_;
+  mutable HiddenArgs hiddenArgs_;
 };
 
 class HSAILKernel : public roc::Kernel {
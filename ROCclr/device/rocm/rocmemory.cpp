@@ -122,9 +122,16 @@ void* Memory::allocMapTarget(const amd::Coord3D& origin, const amd::Coord3D& reg
   if (IsPersistentDirectMap()) {
     return (static_cast<char*>(persistent_host_ptr_) + origin[0]);
   }
+  if (IsLargeBarDirectMap(mapFlags)) {
+    // Keep the SVM convention of the indirect map below
+    if (owner()->getSvmPtr() != nullptr) {
+      return owner()->getSvmPtr();
+    }
+    return (static_cast<char*>(deviceMemory_) + origin[0]);
+  }
 
-  // Allocate one if needed.
-  if (indirectMapCount_ == 1) {
+  // Allocate one if needed. A direct map may have been the first one
+  if ((indirectMapCount_ == 1) || (mapMemory_ == nullptr)) {
     if (!allocateMapMemory(owner()->getSize())) {
       decIndMapCount();
       DevLogPrintfError("Cannot allocate Map memory for size: %u \n",
@@ -154,6 +161,18 @@ void* Memory::allocMapTarget(const amd::Coord3D& origin, const amd::Coord3D& reg
   return mappedMemory;
 }
 
+bool Memory::IsLargeBarDirectMap(uint mapFlags) const {
+  // CPU reads over BAR are uncached, hence only the write-only maps go direct
+  if (!ROC_LARGE_BAR_DIRECT_MAP || !dev().info().largeBar_ || (mapFlags == 0) ||
+      (mapFlags & CL_MAP_READ)) {
+    return false;
+  }
+  return (owner() != nullptr) && (owner()->getType() == CL_MEM_OBJECT_BUFFER) &&
+      (kind_ == MEMORY_KIND_NORMAL) && (deviceMemory_ != nullptr) &&
+      (owner()->getHostMem() == nullptr) && !isHostMemDirectAccess() &&
+      !(owner()->getMemFlags() & ROCCLR_MEM_HSA_SIGNAL_MEMORY);
+}
+
 void Memory::decIndMapCount() {
   // Map/Unmap must be serialized.
   amd::ScopedLock lock(owner()->lockMemoryOps());
@@ -660,6 +679,8 @@ void Buffer::destroy() {
         } else {
           dev().hostFree(deviceMemory_, size());
         }
+      } else if (flags_ & SubAllocated) {
+        dev().memSubAllocator()->free(deviceMemory_);
       } else {
         dev().memFree(deviceMemory_, size());
       }
@@ -721,7 +742,9 @@ bool Buffer::create(bool alloc_local) {
         return true;
       }
     } else {
-      deviceMemory_ = dev().hostAlloc(size(), 1, Device::MemorySegment::kNoAtomics);
+      // The staging buffers follow the placement of the other pinned memory
+      deviceMemory_ = dev().hostNumaPolicyAlloc(size(),
+          ROC_STAGING_NUMA_INTERLEAVE ? ROCCLR_MEM_NUMA_INTERLEAVE : 0);
       if (deviceMemory_ != nullptr) {
         flags_ |= HostMemoryDirectAccess;
         return true;
@@ -764,6 +787,9 @@ bool Buffer::create(bool alloc_local) {
           }
         } else if (memFlags & CL_MEM_FOLLOW_USER_NUMA_POLICY) {
           deviceMemory_ = dev().hostNumaAlloc(size(), 1, (memFlags & CL_MEM_SVM_ATOMICS) != 0);
+        } else if (memFlags & (ROCCLR_MEM_NUMA_NODE | ROCCLR_MEM_NUMA_INTERLEAVE)) {
+          deviceMemory_ = dev().hostNumaPolicyAlloc(size(), memFlags,
+                                                    (memFlags & CL_MEM_SVM_ATOMICS) != 0);
         } else if (memFlags & ROCCLR_MEM_HSA_SIGNAL_MEMORY) {
           // TODO: ROCr will introduce a new attribute enum that implies a non-blocking signal,
           // replace "HSA_AMD_SIGNAL_AMD_GPU_ONLY" with this new enum when it is ready.
@@ -787,13 +813,28 @@ bool Buffer::create(bool alloc_local) {
           // Disable host access to force blit path for memeory writes.
           flags_ &= ~HostMemoryDirectAccess;
         } else {
-          deviceMemory_ = dev().hostAlloc(size(), 1, ((memFlags & CL_MEM_SVM_ATOMICS) != 0)
-                                                       ? Device::MemorySegment::kAtomics
-                                                       : Device::MemorySegment::kNoAtomics);
+          const Device::MemorySegment segment = ((memFlags & CL_MEM_SVM_ATOMICS) != 0)
+              ? Device::MemorySegment::kAtomics : Device::MemorySegment::kNoAtomics;
+          if (memFlags & ROCCLR_MEM_HUGE_PAGES) {
+            deviceMemory_ = dev().hostHugePageAlloc(size(), segment);
+          }
+          if (deviceMemory_ == nullptr) {
+            deviceMemory_ = dev().hostAlloc(size(), 1, segment);
+          }
         }
       } else {
         assert(!isHostMemDirectAccess() && "Runtime doesn't support direct access to GPU memory!");
-        deviceMemory_ = dev().deviceLocalAlloc(size(), (memFlags & CL_MEM_SVM_ATOMICS) != 0);
+        const bool atomics = (memFlags & CL_MEM_SVM_ATOMICS) != 0;
+        // Small allocations come from the device chunks without ROCr calls
+        if (!atomics && (dev().memSubAllocator() != nullptr)) {
+          deviceMemory_ = dev().memSubAllocator()->alloc(size());
+          if (deviceMemory_ != nullptr) {
+            flags_ |= SubAllocated;
+          }
+        }
+        if (deviceMemory_ == nullptr) {
+          deviceMemory_ = dev().deviceLocalAlloc(size(), atomics);
+        }
       }
       owner()->setSvmPtr(deviceMemory_);
     } else {
@@ -1376,7 +1417,11 @@ void Image::destroy() {
   }
 
   if (originalDeviceMemory_ != nullptr) {
-    dev().memFree(originalDeviceMemory_, deviceImageInfo_.size);
+    if (kind_ == MEMORY_KIND_HOST) {
+      dev().hostFree(originalDeviceMemory_, deviceImageInfo_.size);
+    } else {
+      dev().memFree(originalDeviceMemory_, deviceImageInfo_.size);
+    }
     if (kind_ == MEMORY_KIND_HOST) {
       if (dev().settings().apuSystem_) {
         const_cast<Device&>(dev()).updateFreeMemory(deviceImageInfo_.size, true);
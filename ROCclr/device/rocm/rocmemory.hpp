@@ -117,6 +117,9 @@ class Memory : public device::Memory {
 
   void* PersistentHostPtr() const { return persistent_host_ptr_; }
 
+  //! Returns true if the map with \a mapFlags uses the large BAR address without staging
+  bool IsLargeBarDirectMap(uint mapFlags) const;
+
   //! Validates allocated memory for possible workarounds
   virtual bool ValidateMemory() { return true; }
 
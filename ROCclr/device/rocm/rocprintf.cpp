@@ -36,7 +36,108 @@ namespace roc {
 PrintfDbg::PrintfDbg(Device& device, FILE* file)
     : dbgBuffer_(nullptr), dbgBuffer_size_(0), dbgFile_(file), gpuDevice_(device) {}
 
-PrintfDbg::~PrintfDbg() { dev().hostFree(dbgBuffer_, dbgBuffer_size_); }
+//! Max printf buffers in flight per queue in the asynchronous mode
+static constexpr size_t kMaxAsyncBuffers = 4;
+
+//! The barrier after a printf kernel makes the buffer visible to the host
+static constexpr uint16_t kPrintfBarrierHeader =
+    (HSA_PACKET_TYPE_BARRIER_AND << HSA_PACKET_HEADER_TYPE) | (1 << HSA_PACKET_HEADER_BARRIER) |
+    (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_ACQUIRE_FENCE_SCOPE) |
+    (HSA_FENCE_SCOPE_SYSTEM << HSA_PACKET_HEADER_RELEASE_FENCE_SCOPE);
+
+PrintfDbg::~PrintfDbg() {
+  if (worker_ != nullptr) {
+    {
+      amd::ScopedLock lock(asyncLock_);
+      stop_ = true;
+      asyncLock_.notifyAll();
+    }
+    // The worker prints all pending buffers before the exit
+    while (worker_->state() < amd::Thread::FINISHED) {
+      amd::Os::yield();
+    }
+    delete worker_;
+  }
+  for (auto it : buffers_) {
+    hsa_signal_destroy(it->signal_);
+    dev().hostFree(it->buffer_, dev().info().printfBufferSize_);
+    delete it;
+  }
+  dev().hostFree(dbgBuffer_, dbgBuffer_size_);
+}
+
+// ================================================================================================
+PrintfDbg::AsyncBuffer* PrintfDbg::acquireAsyncBuffer() {
+  amd::ScopedLock lock(asyncLock_);
+  if (worker_ == nullptr) {
+    worker_ = new Worker();
+    if (worker_->state() < amd::Thread::INITIALIZED) {
+      // Fall back to the synchronous output
+      delete worker_;
+      worker_ = nullptr;
+      return nullptr;
+    }
+    worker_->start(this);
+  }
+  if (free_.empty() && (buffers_.size() < kMaxAsyncBuffers)) {
+    AsyncBuffer* buffer = new AsyncBuffer();
+    buffer->buffer_ = reinterpret_cast<address>(
+        dev().hostAlloc(dev().info().printfBufferSize_, sizeof(void*)));
+    if ((buffer->buffer_ == nullptr) ||
+        (hsa_signal_create(0, 0, nullptr, &buffer->signal_) != HSA_STATUS_SUCCESS)) {
+      dev().hostFree(buffer->buffer_, dev().info().printfBufferSize_);
+      delete buffer;
+      return nullptr;
+    }
+    buffers_.push_back(buffer);
+    free_.push_back(buffer);
+  }
+  // All buffers are in flight, wait for the oldest kernel
+  while (free_.empty()) {
+    asyncLock_.wait();
+  }
+  AsyncBuffer* buffer = free_.back();
+  free_.pop_back();
+  return buffer;
+}
+
+// ================================================================================================
+void PrintfDbg::asyncWorker() {
+  amd::ScopedLock lock(asyncLock_);
+  while (true) {
+    while (pending_.empty() && !stop_) {
+      asyncLock_.wait();
+    }
+    if (pending_.empty()) {
+      return;
+    }
+    // The FIFO keeps the kernel order of the queue
+    AsyncBuffer* buffer = pending_.front();
+    pending_.pop_front();
+    formatting_ = true;
+    asyncLock_.unlock();
+
+    hsa_signal_wait_scacquire(buffer->signal_, HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne,
+                              kUnlimitedWait, HSA_WAIT_STATE_BLOCKED);
+    if (!outputBuffer(buffer->buffer_, buffer->printfInfo_)) {
+      LogError("Could not print data from the printf buffer!");
+    }
+    buffer->printfInfo_.clear();
+
+    asyncLock_.lock();
+    formatting_ = false;
+    free_.push_back(buffer);
+    asyncLock_.notifyAll();
+  }
+}
+
+// ================================================================================================
+void PrintfDbg::drain() {
+  amd::ScopedLock lock(asyncLock_);
+  while (!pending_.empty() || formatting_) {
+    asyncLock_.wait();
+  }
+}
 
 bool PrintfDbg::allocate(bool realloc) {
   if (nullptr == dbgBuffer_) {
@@ -377,9 +478,13 @@ void PrintfDbg::outputDbgBuffer(const device::PrintfInfo& info, const uint32_t*
 }
 
 bool PrintfDbg::init(bool printfEnabled) {
+  current_ = nullptr;
   // Set up debug output buffer (if printf active)
   if (printfEnabled) {
-    if (!allocate()) {
+    if (ROC_PRINTF_ASYNC) {
+      current_ = acquireAsyncBuffer();
+    }
+    if ((current_ == nullptr) && !allocate()) {
       return false;
     }
 
@@ -391,12 +496,13 @@ bool PrintfDbg::init(bool printfEnabled) {
     const uint8_t initSize = 2 * sizeof(uint32_t);
     uint8_t sysMem[initSize];
     memset(sysMem, 0, initSize);
-    uint32_t dbgBufferSize = dbgBuffer_size_ - initSize;
+    uint32_t dbgBufferSize =
+        ((current_ != nullptr) ? dev().info().printfBufferSize_ : dbgBuffer_size_) - initSize;
     memcpy(&sysMem[4], &dbgBufferSize, sizeof(dbgBufferSize));
 
     // Copy offset and number of bytes available for printf data
     // into the corresponding location in the debug buffer
-    hsa_status_t err = hsa_memory_copy(dbgBuffer_, sysMem, 2 * sizeof(uint32_t));
+    hsa_status_t err = hsa_memory_copy(dbgBuffer(), sysMem, 2 * sizeof(uint32_t));
     if (err != HSA_STATUS_SUCCESS) {
       LogPrintfError("\n Can't copy offset and bytes available data to dgbBuffer_,"
                      "failed with status: %d \n!", err);
@@ -409,52 +515,68 @@ bool PrintfDbg::init(bool printfEnabled) {
 bool PrintfDbg::output(VirtualGPU& gpu, bool printfEnabled,
                        const std::vector<device::PrintfInfo>& printfInfo) {
   if (printfEnabled) {
-    uint32_t offsetSize = 0;
+    if (current_ != nullptr) {
+      // The barrier signals the completion of the kernel, the worker prints the buffer then
+      hsa_signal_store_relaxed(current_->signal_, kInitSignalValueOne);
+      gpu.dispatchBarrierPacket(kPrintfBarrierHeader, true, current_->signal_);
+      current_->printfInfo_ = printfInfo;
+      amd::ScopedLock lock(asyncLock_);
+      pending_.push_back(current_);
+      current_ = nullptr;
+      asyncLock_.notifyAll();
+      return true;
+    }
 
     // Wait until outstanding kernels finish
     gpu.releaseGpuMemoryFence();
 
-    // Get memory pointer to the staged buffer
-    uint32_t* dbgBufferPtr = reinterpret_cast<uint32_t*>(dbgBuffer_);
-    if (nullptr == dbgBufferPtr) {
-      return false;
-    }
+    return outputBuffer(dbgBuffer_, printfInfo);
+  }
 
-    offsetSize = *dbgBufferPtr;
+  return true;
+}
 
-    if (offsetSize == 0) {
-      return true;
-    }
+bool PrintfDbg::outputBuffer(address buffer,
+                             const std::vector<device::PrintfInfo>& printfInfo) const {
+  uint32_t offsetSize = 0;
 
-    // Get a pointer to the buffer data
-    dbgBufferPtr = reinterpret_cast<uint32_t*>(dbgBuffer_ + 2 * sizeof(uint32_t));
-    if (nullptr == dbgBufferPtr) {
-      return false;
-    }
+  // Get memory pointer to the staged buffer
+  uint32_t* dbgBufferPtr = reinterpret_cast<uint32_t*>(buffer);
+  if (nullptr == dbgBufferPtr) {
+    return false;
+  }
 
-    uint sb = 0;
-    uint sbt = 0;
+  offsetSize = *dbgBufferPtr;
 
-    // parse the debug buffer
-    while (sbt < offsetSize) {
-      if (*dbgBufferPtr >= printfInfo.size()) {
-        LogError("Couldn't find the reported PrintfID!");
-        return false;
-      }
-      const device::PrintfInfo& info = printfInfo[(*dbgBufferPtr)];
-      sb += sizeof(uint32_t);
-      for (const auto& ita : info.arguments_) {
-        sb += ita;
-      }
+  if (offsetSize == 0) {
+    return true;
+  }
 
-      size_t idx = 1;
-      // There's something in the debug buffer
-      outputDbgBuffer(info, dbgBufferPtr, idx);
+  // Get a pointer to the buffer data
+  dbgBufferPtr = reinterpret_cast<uint32_t*>(buffer + 2 * sizeof(uint32_t));
 
-      sbt += sb;
-      dbgBufferPtr += sb / sizeof(uint32_t);
-      sb = 0;
+  uint sb = 0;
+  uint sbt = 0;
+
+  // parse the debug buffer
+  while (sbt < offsetSize) {
+    if (*dbgBufferPtr >= printfInfo.size()) {
+      LogError("Couldn't find the reported PrintfID!");
+      return false;
+    }
+    const device::PrintfInfo& info = printfInfo[(*dbgBufferPtr)];
+    sb += sizeof(uint32_t);
+    for (const auto& ita : info.arguments_) {
+      sb += ita;
     }
+
+    size_t idx = 1;
+    // There's something in the debug buffer
+    outputDbgBuffer(info, dbgBufferPtr, idx);
+
+    sbt += sb;
+    dbgBufferPtr += sb / sizeof(uint32_t);
+    sb = 0;
   }
 
   return true;
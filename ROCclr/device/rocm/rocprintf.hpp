@@ -20,6 +20,12 @@
 
 #pragma once
 
+#include "thread/monitor.hpp"
+#include "thread/thread.hpp"
+
+#include <deque>
+#include <vector>
+
 /*! \addtogroup GPU GPU Device Implementation
  *  @{
  */
@@ -70,14 +76,47 @@ class PrintfDbg : public amd::HeapObject {
               );
 
   //! Returns debug buffer object
-  address dbgBuffer() const { return dbgBuffer_; }
+  address dbgBuffer() const { return (current_ != nullptr) ? current_->buffer_ : dbgBuffer_; }
+
+  //! Waits until the background thread printed the output of all submitted kernels
+  void drain();
 
  protected:
+  //! A printf buffer of the asynchronous mode, in flight from init() to the formatting
+  struct AsyncBuffer {
+    address buffer_;                                //!< Printf buffer of the kernel
+    hsa_signal_t signal_;                           //!< Completion of the kernel
+    std::vector<device::PrintfInfo> printfInfo_;    //!< Formats of the kernel
+  };
+
   address dbgBuffer_;      //!< Buffer to hold debug output
   size_t dbgBuffer_size_;  //!< Size of the debugger buffer
   FILE* dbgFile_;          //!< Debug file
   Device& gpuDevice_;      //!< GPU device object
 
+  AsyncBuffer* current_ = nullptr;       //!< Buffer of the kernel between init() and output()
+  std::vector<AsyncBuffer*> buffers_;    //!< All asynchronous buffers
+  std::vector<AsyncBuffer*> free_;       //!< The buffers, available for a kernel
+  std::deque<AsyncBuffer*> pending_;     //!< Submitted kernels in the launch order
+  amd::Monitor asyncLock_{"Printf async lock"};  //!< Protects free_ and pending_
+  //! Formats the pending buffers
+  class Worker : public amd::Thread {
+   public:
+    Worker() : amd::Thread("Printf Thread", CQ_THREAD_STACK_SIZE) {}
+    void run(void* data) { reinterpret_cast<PrintfDbg*>(data)->asyncWorker(); }
+  }* worker_ = nullptr;
+  bool stop_ = false;                    //!< Stops the worker after the pending buffers
+  bool formatting_ = false;              //!< The worker prints a buffer
+
+  //! Returns a free asynchronous buffer, waits for the worker if all are in flight
+  AsyncBuffer* acquireAsyncBuffer();
+
+  //! Background thread of the asynchronous mode
+  void asyncWorker();
+
+  //! Prints the records of a completed printf buffer
+  bool outputBuffer(address buffer, const std::vector<device::PrintfInfo>& printfInfo) const;
+
   //! Gets GPU device object
   Device& dev() const { return gpuDevice_; }
 
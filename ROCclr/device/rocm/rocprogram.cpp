@@ -45,10 +45,14 @@ static inline const char* hsa_strerror(hsa_status_t status) {
   return "Unknown error";
 }
 
+std::atomic<uint64_t> Program::loadGeneration_(0);
+
 Program::~Program() {
   // Destroy the executable.
   if (hsaExecutable_.handle != 0) {
     hsa_executable_destroy(hsaExecutable_);
+    // The code object ranges of the executable are gone, so the address lookups must refresh
+    loadGeneration_.fetch_add(1, std::memory_order_release);
   }
   if (hsaCodeObjectReader_.handle != 0) {
     hsa_code_object_reader_destroy(hsaCodeObjectReader_);
@@ -268,10 +272,21 @@ bool LightningProgram::createKernels(void* binary, size_t binSize, bool useUnifo
     return false;
   }
 
+  // HIP binaries may have many kernels, which the application never launches. The lazy program
+  // keeps only the names, getKernel() creates the kernel from the metadata on the first lookup.
+  // The init and fini kernels run after the loading, hence they are always created
+  const bool lazy = amd::IS_HIP && HIP_LAZY_KERNEL_INIT && !internalKernel;
+  uniformWorkGroupSize_ = useUniformWorkGroupSize;
   for (const auto &kernelMeta : kernelMetadataMap_) {
     const std::string kernelName = kernelMeta.first;
-    Kernel* aKernel = new roc::LightningKernel(kernelName, this);
+    if (lazy && (kernelName.find("amdgcn.device.init") == std::string::npos) &&
+        (kernelName.find("amdgcn.device.fini") == std::string::npos)) {
+      kernels()[kernelName] = nullptr;
+      continue;
+    }
+    LightningKernel* aKernel = new roc::LightningKernel(kernelName, this);
     if (!aKernel->init()) {
+      delete aKernel;
       return false;
     }
     aKernel->setUniformWorkGroupSize(useUniformWorkGroupSize);
@@ -281,6 +296,17 @@ bool LightningProgram::createKernels(void* binary, size_t binSize, bool useUnifo
   return true;
 }
 
+device::Kernel* LightningProgram::createKernel(const std::string& name) {
+  LightningKernel* aKernel = new roc::LightningKernel(name, this);
+  if (!aKernel->init() || !aKernel->postLoad()) {
+    LogPrintfError("Setup of kernel %s on the first use failed", name.c_str());
+    delete aKernel;
+    return nullptr;
+  }
+  aKernel->setUniformWorkGroupSize(uniformWorkGroupSize_);
+  return aKernel;
+}
+
 bool LightningProgram::setKernels(void* binary, size_t binSize,
                                   amd::Os::FileDesc fdesc, size_t foffset, std::string uri) {
 #if defined(USE_COMGR_LIBRARY)
@@ -330,10 +356,11 @@ bool LightningProgram::setKernels(void* binary, size_t binSize,
     buildLog_ += "\n";
     return false;
   }
+  loadGeneration_.fetch_add(1, std::memory_order_release);
 
   for (auto& kit : kernels()) {
     LightningKernel* kernel = static_cast<LightningKernel*>(kit.second);
-    if (!kernel->postLoad()) {
+    if ((kernel != nullptr) && !kernel->postLoad()) {
       return false;
     }
   }
@@ -22,6 +22,7 @@
 
 #ifndef WITHOUT_HSA_BACKEND
 
+#include <atomic>
 #include <string>
 #include <sstream>
 #include <fstream>
@@ -64,6 +65,9 @@ class Program : public device::Program {
   virtual bool createGlobalVarObj(amd::Memory** amd_mem_obj, void** device_pptr,
                                   size_t* bytes, const char* global_name) const;
 
+  //! Returns the count of the executable loads and unloads in the process
+  static uint64_t loadGeneration() { return loadGeneration_.load(std::memory_order_acquire); }
+
  protected:
   /*! \brief Compiles LLVM binary to HSAIL code (compiler backend: link+opt+codegen)
    *
@@ -84,6 +88,8 @@ protected:
   /* HSA executable */
   hsa_executable_t hsaExecutable_;               //!< Handle to HSA executable
   hsa_code_object_reader_t hsaCodeObjectReader_; //!< Handle to HSA code reader
+
+  static std::atomic<uint64_t> loadGeneration_;  //!< Changes on every code object update
 };
 
 class HSAILProgram : public roc::Program {
@@ -120,9 +126,13 @@ private:
   bool createKernels(void* binary, size_t binSize, bool useUniformWorkGroupSize,
                      bool internalKernel) override final;
 
+  device::Kernel* createKernel(const std::string& name) override final;
+
   bool setKernels(void* binary, size_t binSize,
                   amd::Os::FileDesc fdesc = amd::Os::FDescInit(), size_t foffset = 0,
                   std::string uri = std::string()) override final;
+
+  bool uniformWorkGroupSize_ = false;  //!< The lazy kernels use the uniform work-group size
 };
 
 /*@}*/} // namespace roc
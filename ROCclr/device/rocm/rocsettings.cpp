@@ -63,6 +63,7 @@ Settings::Settings() {
   stagedXferRead_ = true;
   stagedXferWrite_ = true;
   stagedXferSize_ = GPU_STAGING_BUFFER_SIZE * Ki;
+  stagedXferDepth_ = std::max(GPU_STAGING_PIPELINE_DEPTH, 1u);
 
   // Initialize transfer buffer size to 1MB by default
   xferBufSize_ = 1024 * Ki;
@@ -70,8 +71,11 @@ Settings::Settings() {
   const static size_t MaxPinnedXferSize = 128;
   pinnedXferSize_ = std::min(GPU_PINNED_XFER_SIZE, MaxPinnedXferSize) * Mi;
   pinnedMinXferSize_ = std::min(GPU_PINNED_MIN_XFER_SIZE * Ki, pinnedXferSize_);
+  pinnedCacheSize_ = GPU_PINNED_CACHE_SIZE * Mi;
 
   sdmaCopyThreshold_ = GPU_FORCE_BLIT_COPY_SIZE * Ki;
+  sdmaStripeSize_ = GPU_SDMA_STRIPE_SIZE * Mi;
+  subAllocMaxSize_ = static_cast<size_t>(ROC_SUBALLOC_MAX_SIZE) * Ki;
 
   // Don't support Denormals for single precision by default
   singleFpDenorm_ = false;
@@ -88,6 +92,8 @@ Settings::Settings() {
   imageBufferWar_ = false;
 
   hmmFlags_ = (!flagIsDefault(ROC_HMM_FLAGS)) ? ROC_HMM_FLAGS : 0;
+  hmmPrefetchChunkSize_ = ROC_HMM_PREFETCH_CHUNK_SIZE * Mi;
+  hmmPrefetchAhead_ = ROC_HMM_PREFETCH_AHEAD;
 
   rocr_backend_ = true;
 
@@ -140,6 +146,8 @@ bool Settings::create(bool fullProfile, uint32_t gfxipMajor, uint32_t gfxipMinor
   enableExtension(ClKhrSubGroups);
   enableExtension(ClKhrDepthImages);
   enableExtension(ClAmdCopyBufferP2P);
+  enableExtension(ClAmdCommandBuffer);
+  enableExtension(ClAmdPipeHostAccess);
   enableExtension(ClKhrFp16);
   supportDepthsRGB_ = true;
 
@@ -211,6 +219,7 @@ void Settings::override() {
 
   if (!flagIsDefault(GPU_PINNED_MIN_XFER_SIZE)) {
     pinnedMinXferSize_ = std::min(GPU_PINNED_MIN_XFER_SIZE * Ki, pinnedXferSize_);
+  pinnedCacheSize_ = GPU_PINNED_CACHE_SIZE * Mi;
   }
 
   if (!flagIsDefault(AMD_GPU_FORCE_SINGLE_FP_DENORM)) {
@@ -79,12 +79,18 @@ class Settings : public device::Settings {
 
   size_t xferBufSize_;        //!< Transfer buffer size for image copy optimization
   size_t stagedXferSize_;     //!< Staged buffer size
+  uint stagedXferDepth_;      //!< Number of staged buffers in the copy pipeline
   size_t pinnedXferSize_;     //!< Pinned buffer size for transfer
   size_t pinnedMinXferSize_;  //!< Minimal buffer size for pinned transfer
+  size_t pinnedCacheSize_;    //!< Size of pinned host ranges, cached between transfers
 
   size_t sdmaCopyThreshold_;  //!< Use SDMA to copy above this size
+  size_t sdmaStripeSize_;     //!< Split SDMA copies between engines above this size
+  size_t subAllocMaxSize_;    //!< Max size of device allocations, suballocated in chunks
 
   uint32_t  hmmFlags_;        //!< HMM functionality control flags
+  size_t    hmmPrefetchChunkSize_;  //!< Size of one HMM prefetch request, 0 - no split
+  uint32_t  hmmPrefetchAhead_;      //!< The number of chunks to read ahead on streaming
 
   //! Default constructor
   Settings();
@@ -21,6 +21,8 @@
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
 #include "rocurilocator.hpp"
+#include "rocprogram.hpp"
+#include <algorithm>
 #include <sstream>
 
 namespace roc {
@@ -93,7 +95,24 @@ hsa_status_t UriLocator::createUriRangeTable() {
     return HSA_STATUS_ERROR;
 
   uint64_t callbackArgs[2] = {(uint64_t)& fn_table_, (uint64_t) &rangeTab_};
-  return fn_table_.hsa_ven_amd_loader_iterate_executables(execCb, (void*) callbackArgs);
+  rangeTab_.clear();
+  hsa_status_t status = fn_table_.hsa_ven_amd_loader_iterate_executables(execCb,
+    (void*) callbackArgs);
+  // The code objects never overlap, so the start addresses order the ranges
+  std::sort(rangeTab_.begin(), rangeTab_.end(), [](const UriRange& a, const UriRange& b) {
+    return a.startAddr_ < b.startAddr_;
+  });
+  return status;
+}
+
+int64_t UriLocator::findRange(uint64_t device_pc) const {
+  // The last range that starts at or below the PC is the only candidate
+  auto it = std::upper_bound(rangeTab_.begin(), rangeTab_.end(), device_pc,
+    [](uint64_t pc, const UriRange& range) { return pc < range.startAddr_; });
+  if (it == rangeTab_.begin())
+    return -1;
+  --it;
+  return (device_pc <= it->endAddr_) ? (it - rangeTab_.begin()) : -1;
 }
 
 // Encoding of uniform-resource-identifier(URI) is detailed in
@@ -164,19 +183,37 @@ UriLocator::UriInfo UriLocator::lookUpUri(uint64_t device_pc) {
         sizeof(fn_table_), &fn_table_);
     if (result != HSA_STATUS_SUCCESS)
       return errorstate;
-    result = createUriRangeTable();
-    if (result != HSA_STATUS_SUCCESS) {
+    init_ = true;
+    // Force the first table build below
+    generation_ = Program::loadGeneration() + 1;
+  }
+
+  // Walk the loader only after a code object load or unload, not on every report
+  const uint64_t generation = Program::loadGeneration();
+  if (generation != generation_) {
+    pcCache_.clear();
+    if (createUriRangeTable() != HSA_STATUS_SUCCESS) {
       rangeTab_.clear();
       return errorstate;
     }
-    init_ = true;
+    generation_ = generation;
   }
 
-  for(auto& seg : rangeTab_)
-    if (seg.startAddr_ <= device_pc && device_pc <= seg.endAddr_)
-     return UriInfo{seg.Uri_.c_str(), seg.elfDelta_};
+  int64_t index;
+  auto it = pcCache_.find(device_pc);
+  if (it != pcCache_.end()) {
+    index = it->second;
+  } else {
+    index = findRange(device_pc);
+    if (pcCache_.size() >= kPcCacheSize)
+      pcCache_.clear();
+    pcCache_.emplace(device_pc, index);
+  }
 
-  return errorstate;
+  if (index < 0)
+    return errorstate;
+  const UriRange& seg = rangeTab_[index];
+  return UriInfo{seg.Uri_.c_str(), seg.elfDelta_};
 }
 } //namespace roc
 #endif
@@ -24,6 +24,7 @@
 #include "device/devurilocator.hpp"
 #include "hsa_ven_amd_loader.h"
 
+#include <unordered_map>
 #include <vector>
 namespace roc {
 class UriLocator : public device::UriLocator {
@@ -33,10 +34,18 @@ class UriLocator : public device::UriLocator {
     int64_t elfDelta_;
     std::string  Uri_;
   };
+  //! The ranges of all loaded code objects, sorted by the start address
   std::vector<UriRange> rangeTab_;
+  //! Program::loadGeneration() of the table, rebuilt after any load or unload
+  uint64_t generation_ = 0;
+  //! Range index of the recent PCs, -1 for the PCs outside of any code object
+  std::unordered_map<uint64_t, int64_t> pcCache_;
+  static constexpr size_t kPcCacheSize = 4096;
   hsa_ven_amd_loader_1_03_pfn_t fn_table_;
 
   hsa_status_t createUriRangeTable();
+  //! Returns the index of the range with \a device_pc, -1 if no code object has it
+  int64_t findRange(uint64_t device_pc) const;
   public:
    virtual ~UriLocator() {}
    virtual UriInfo lookUpUri(uint64_t device_pc) override;
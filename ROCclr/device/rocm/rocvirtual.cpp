@@ -26,10 +26,12 @@
 #include "device/rocm/rocblit.hpp"
 #include "device/rocm/roccounters.hpp"
 #include "platform/kernel.hpp"
+#include "platform/callbackpool.hpp"
 #include "platform/context.hpp"
 #include "platform/command.hpp"
 #include "platform/command_utils.hpp"
 #include "platform/memory.hpp"
+#include "amdocl/cl_vk_amd.hpp"
 #include "platform/sampler.hpp"
 #include "utils/debug.hpp"
 #include "os/os.hpp"
@@ -39,6 +41,8 @@
 #include <fstream>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
@@ -120,6 +124,7 @@ void Timestamp::checkGpuTime() {
   if (HwProfiling()) {
     uint64_t  start = std::numeric_limits<uint64_t>::max();
     uint64_t  end = 0;
+    uint64_t  computeStart = std::numeric_limits<uint64_t>::max();
 
     for (auto it : signals_) {
       amd::ScopedLock lock(it->LockSignalOps());
@@ -144,6 +149,9 @@ void Timestamp::checkGpuTime() {
 
         start = std::min(time.start, start);
         end = std::max(time.end, end);
+        if (it->engine_ == HwQueueEngine::Compute) {
+          computeStart = std::min(time.start, computeStart);
+        }
         ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Signal = (0x%lx), start = %ld, "
           "end = %ld", it->signal_.handle, start, end);
       }
@@ -154,9 +162,43 @@ void Timestamp::checkGpuTime() {
       start_ = start * ticksToTime_;
       end_ = end * ticksToTime_;
     }
+    // The SDMA copies don't go through the HW queue, hence only the compute start counts
+    const uint64_t gpuStart = (computeStart != std::numeric_limits<uint64_t>::max()) ?
+        static_cast<uint64_t>(computeStart * ticksToTime_) : 0;
+    if ((gpuStart > submitTime_) && (submitTime_ != 0) && (gpu()->hwQueueStats() != nullptr)) {
+      gpu()->hwQueueStats()->stats_[amd::Device::HwQueueStartLatency].record(
+          gpuStart - submitTime_);
+    }
   }
 }
 
+// ================================================================================================
+//! Processes the completed batch with the API callback and releases the blocked AQL queue
+static void ProcessCallbackBatch(void* arg) {
+  Timestamp* ts = reinterpret_cast<Timestamp*>(arg);
+  // Save callback signal, since the batch update can release the timestamp
+  hsa_signal_t callback_signal = ts->GetCallbackSignal();
+  ts->gpu()->updateCommandsState(ts->command().GetBatchHead());
+  hsa_signal_subtract_relaxed(callback_signal, 1);
+}
+
+// ================================================================================================
+//! Returns the pool for the API callbacks, nullptr if the callbacks run on the signal handler
+static amd::CallbackPool* CallbackWorkers() {
+  static std::once_flag initialized;
+  static amd::CallbackPool* pool = nullptr;
+  std::call_once(initialized, []() {
+    if (ROC_CALLBACK_THREADS > 0) {
+      pool = new amd::CallbackPool(ROC_CALLBACK_THREADS);
+      if ((pool != nullptr) && !pool->create()) {
+        delete pool;
+        pool = nullptr;
+      }
+    }
+  });
+  return pool;
+}
+
 // ================================================================================================
 bool HsaAmdSignalHandler(hsa_signal_value_t value, void* arg) {
   Timestamp* ts = reinterpret_cast<Timestamp*>(arg);
@@ -201,6 +243,15 @@ bool HsaAmdSignalHandler(hsa_signal_value_t value, void* arg) {
   // Save callback signal
   hsa_signal_t callback_signal = ts->GetCallbackSignal();
 
+  // The API callback blocks the AQL queue until it's done. Run it on a worker, so a slow
+  // callback doesn't delay the completion processing of the other queues
+  if (callback_signal.handle != 0) {
+    amd::CallbackPool* pool = CallbackWorkers();
+    if ((pool != nullptr) && pool->submit(&ProcessCallbackBatch, ts)) {
+      return false;
+    }
+  }
+
   // Update the batch, since signal is complete
   ts->gpu()->updateCommandsState(ts->command().GetBatchHead());
 
@@ -215,23 +266,23 @@ bool HsaAmdSignalHandler(hsa_signal_value_t value, void* arg) {
 
 // ================================================================================================
 bool VirtualGPU::MemoryDependency::create(size_t numMemObj) {
-  if (numMemObj > 0) {
-    // Allocate the array of memory objects for dependency tracking
-    memObjectsInQueue_ = new MemoryState[numMemObj];
-    if (nullptr == memObjectsInQueue_) {
-      return false;
-    }
-    memset(memObjectsInQueue_, 0, sizeof(MemoryState) * numMemObj);
-    maxMemObjectsInQueue_ = numMemObj;
-  }
-
+  // The kernel arguments don't have a limit, hence the reservation is a hint only
+  kernelObjects_.reserve(numMemObj);
+  maxMemObjectsInQueue_ = numMemObj;
   return true;
 }
 
 // ================================================================================================
-void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memory, bool readOnly) {
-  bool flushL1Cache = false;
+void VirtualGPU::MemoryDependency::newKernel() {
+  // The objects of the last kernel become busy for the next one
+  for (const auto& it : kernelObjects_) {
+    busyRanges_.insert(it.start_, it.end_, it.readOnly_);
+  }
+  kernelObjects_.clear();
+}
 
+// ================================================================================================
+void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memory, bool readOnly) {
   if (maxMemObjectsInQueue_ == 0) {
     // Sync AQL packets
     gpu.setAqlHeader(gpu.dispatchPacketHeader_);
@@ -241,29 +292,13 @@ void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memor
   uint64_t curStart = reinterpret_cast<uint64_t>(memory->getDeviceMemory());
   uint64_t curEnd = curStart + memory->size();
 
-  // Loop through all memory objects in the queue and find dependency
+  // Check the busy ranges of the previous kernels for dependency
   // @note don't include objects from the current kernel
-  for (size_t j = 0; j < endMemObjectsInQueue_; ++j) {
-    // Check if the queue already contains this mem object and
-    // GPU operations aren't readonly
-    uint64_t busyStart = memObjectsInQueue_[j].start_;
-    uint64_t busyEnd = memObjectsInQueue_[j].end_;
-
-    // Check if the start inside the busy region
-    if ((((curStart >= busyStart) && (curStart < busyEnd)) ||
-         // Check if the end inside the busy region
-         ((curEnd > busyStart) && (curEnd <= busyEnd)) ||
-         // Check if the start/end cover the busy region
-         ((curStart <= busyStart) && (curEnd >= busyEnd))) &&
-        // If the buys region was written or the current one is for write
-        (!memObjectsInQueue_[j].readOnly_ || !readOnly)) {
-      flushL1Cache = true;
-      break;
-    }
-  }
+  bool flushL1Cache = busyRanges_.conflict(curStart, curEnd, readOnly);
 
-  // Did we reach the limit?
-  if (maxMemObjectsInQueue_ <= numMemObjectsInQueue_) {
+  // Did we reach the limit? The same buffer in many kernels is a single range,
+  // so only a large set of distinct buffers can get here
+  if (maxMemObjectsInQueue_ <= busyRanges_.size()) {
     flushL1Cache = true;
   }
 
@@ -279,45 +314,15 @@ void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memor
   // Insert current memory object into the queue always,
   // since runtime calls flush before kernel execution and it has to keep
   // current kernel in tracking
-  memObjectsInQueue_[numMemObjectsInQueue_].start_ = curStart;
-  memObjectsInQueue_[numMemObjectsInQueue_].end_ = curEnd;
-  memObjectsInQueue_[numMemObjectsInQueue_].readOnly_ = readOnly;
-  numMemObjectsInQueue_++;
+  kernelObjects_.push_back({curStart, curEnd, readOnly});
 }
 
 // ================================================================================================
 void VirtualGPU::MemoryDependency::clear(bool all) {
-  if (numMemObjectsInQueue_ > 0) {
-    if (all) {
-      endMemObjectsInQueue_ = numMemObjectsInQueue_;
-    }
-
-    // If the current launch didn't start from the beginning, then move the data
-    if (0 != endMemObjectsInQueue_) {
-      // Preserve all objects from the current kernel
-      size_t i, j;
-      for (i = 0, j = endMemObjectsInQueue_; j < numMemObjectsInQueue_; i++, j++) {
-        memObjectsInQueue_[i].start_ = memObjectsInQueue_[j].start_;
-        memObjectsInQueue_[i].end_ = memObjectsInQueue_[j].end_;
-        memObjectsInQueue_[i].readOnly_ = memObjectsInQueue_[j].readOnly_;
-      }
-    } else if (numMemObjectsInQueue_ >= maxMemObjectsInQueue_) {
-      // note: The array growth shouldn't occur under the normal conditions,
-      // but in a case when SVM path sends the amount of SVM ptrs over
-      // the max size of kernel arguments
-      MemoryState* ptr  = new MemoryState[maxMemObjectsInQueue_ << 1];
-      if (nullptr == ptr) {
-        numMemObjectsInQueue_ = 0;
-        return;
-      }
-      maxMemObjectsInQueue_ <<= 1;
-      memcpy(ptr, memObjectsInQueue_, sizeof(MemoryState) * numMemObjectsInQueue_);
-      delete[] memObjectsInQueue_;
-      memObjectsInQueue_= ptr;
-    }
-
-    numMemObjectsInQueue_ -= endMemObjectsInQueue_;
-    endMemObjectsInQueue_ = 0;
+  busyRanges_.clear();
+  // Preserve all objects from the current kernel, unless it's a full clear
+  if (all) {
+    kernelObjects_.clear();
   }
 }
 
@@ -328,23 +333,115 @@ VirtualGPU::HwQueueTracker::~HwQueueTracker() {
   }
 }
 
+// ================================================================================================
+void VirtualGPU::HwQueueTracker::QueueCompletion(Timestamp* ts, ProfilingSignal* signal) {
+  // Retire the completed markers inline, so the handler has less work
+  ReapCompletions();
+
+  // Keep the signal until the marker is retired, so the queue can't reuse it
+  signal->retain();
+  amd::ScopedLock lock(reaper_lock_);
+  pending_markers_.push_back({ts, signal});
+  // Only the oldest pending marker has a handler. It will retire all completed markers
+  if (armed_signal_ == nullptr) {
+    ArmCompletionHandler();
+  }
+}
+
+// ================================================================================================
+void VirtualGPU::HwQueueTracker::ArmCompletionHandler() {
+  armed_signal_ = pending_markers_.front().signal_;
+  armed_signal_->retain();
+  hsa_status_t result = hsa_amd_signal_async_handler(armed_signal_->signal_,
+      HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne, &CompletionHandler, this);
+  if (HSA_STATUS_SUCCESS != result) {
+    LogError("hsa_amd_signal_async_handler() failed to set the completion handler!");
+    // The pending markers will be retired inline on the next marker or in the drain
+    armed_signal_->release();
+    armed_signal_ = nullptr;
+  } else {
+    ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Set completion handler: handle(0x%lx)",
+            armed_signal_->signal_.handle);
+  }
+}
+
+// ================================================================================================
+void VirtualGPU::HwQueueTracker::ReapCompletions() {
+  std::vector<PendingMarker> completed;
+  {
+    amd::ScopedLock lock(reaper_lock_);
+    // The markers complete in the submission order, so stop on the first busy one
+    while (!pending_markers_.empty() &&
+           (hsa_signal_load_relaxed(pending_markers_.front().signal_->signal_) <
+            kInitSignalValueOne)) {
+      completed.push_back(pending_markers_.front());
+      pending_markers_.pop_front();
+    }
+  }
+  for (auto& marker : completed) {
+    ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Retire marker: timestamp(%p), handle(0x%lx)",
+            marker.ts_, marker.signal_->signal_.handle);
+    // Update the batch, since signal is complete
+    gpu_.updateCommandsState(marker.ts_->command().GetBatchHead());
+    marker.signal_->release();
+  }
+}
+
+// ================================================================================================
+bool VirtualGPU::HwQueueTracker::CompletionHandler(hsa_signal_value_t value, void* arg) {
+  HwQueueTracker* tracker = reinterpret_cast<HwQueueTracker*>(arg);
+
+  amd::Thread* thread = amd::Thread::current();
+  if (!(thread != nullptr ||
+      ((thread = new amd::HostThread()) != nullptr && thread == amd::Thread::current()))) {
+    return false;
+  }
+
+  tracker->ReapCompletions();
+
+  ProfilingSignal* fired = nullptr;
+  {
+    amd::ScopedLock lock(tracker->reaper_lock_);
+    fired = tracker->armed_signal_;
+    tracker->armed_signal_ = nullptr;
+    // Move the handler to the oldest marker, which is still busy
+    if (!tracker->pending_markers_.empty()) {
+      tracker->ArmCompletionHandler();
+    }
+  }
+  // Note: the tracker can be destroyed already if the handler isn't rearmed
+  fired->release();
+
+  // Return false, so the callback will not be called again for this signal
+  return false;
+}
+
+// ================================================================================================
+void VirtualGPU::HwQueueTracker::DrainCompletions() {
+  while (true) {
+    ReapCompletions();
+    {
+      amd::ScopedLock lock(reaper_lock_);
+      if (pending_markers_.empty() && (armed_signal_ == nullptr)) {
+        break;
+      }
+    }
+    // The queue is idle, hence the armed handler fires shortly
+    amd::Os::yield();
+  }
+}
+
 // ================================================================================================
 bool VirtualGPU::HwQueueTracker::Create() {
   uint kSignalListSize = ROC_SIGNAL_POOL_SIZE;
   signal_list_.resize(kSignalListSize);
 
-  hsa_agent_t agent = gpu_.gpu_device();
-  const Settings& settings = gpu_.dev().settings();
-  hsa_agent_t* agents = (settings.system_scope_signal_) ? nullptr : &agent;
-  uint32_t num_agents = (settings.system_scope_signal_) ? 0 : 1;
-
   for (uint i = 0; i < kSignalListSize; ++i) {
-    std::unique_ptr<ProfilingSignal> signal(new ProfilingSignal());
-    if ((signal == nullptr) ||
-        (HSA_STATUS_SUCCESS != hsa_signal_create(0, num_agents, agents, &signal->signal_))) {
+    // The device recycles signals between the queues
+    signal_list_[i] = gpu_.dev().AcquireProfilingSignal();
+    if (signal_list_[i] == nullptr) {
       return false;
     }
-    signal_list_[i] = signal.release();
   }
   return true;
 }
@@ -358,20 +455,13 @@ hsa_signal_t VirtualGPU::HwQueueTracker::ActiveSignal(
   auto temp_id = (current_id_ + 2) % signal_list_.size();
   // If GPU is still busy with processing, then add more signals to avoid more frequent stalls
   if (hsa_signal_load_relaxed(signal_list_[temp_id]->signal_) > 0) {
-    std::unique_ptr<ProfilingSignal> signal(new ProfilingSignal());
+    ProfilingSignal* signal = gpu_.dev().AcquireProfilingSignal();
     if (signal != nullptr) {
-      hsa_agent_t agent = gpu_.gpu_device();
-      const Settings& settings = gpu_.dev().settings();
-      hsa_agent_t* agents = (settings.system_scope_signal_) ? nullptr : &agent;
-      uint32_t num_agents = (settings.system_scope_signal_) ? 0 : 1;
-
-      if (HSA_STATUS_SUCCESS == hsa_signal_create(0, num_agents, agents, &signal->signal_)) {
-        // Find valid new index
-        ++current_id_ %= signal_list_.size();
-        // Insert the new signal into the current slot and ignore any wait
-        signal_list_.insert(signal_list_.begin() + current_id_, signal.release());
-        new_signal = true;
-      }
+      // Find valid new index
+      ++current_id_ %= signal_list_.size();
+      // Insert the new signal into the current slot and ignore any wait
+      signal_list_.insert(signal_list_.begin() + current_id_, signal);
+      new_signal = true;
     }
   }
 
@@ -392,19 +482,10 @@ hsa_signal_t VirtualGPU::HwQueueTracker::ActiveSignal(
   if (signal_list_[current_id_]->referenceCount() > 1) {
     // The signal was assigned to the global marker's event, hence runtime can't reuse it
     // and needs a new signal
-    std::unique_ptr<ProfilingSignal> signal(new ProfilingSignal());
+    ProfilingSignal* signal = gpu_.dev().AcquireProfilingSignal();
     if (signal != nullptr) {
-      hsa_agent_t agent = gpu_.gpu_device();
-      const Settings& settings = gpu_.dev().settings();
-      hsa_agent_t* agents = (settings.system_scope_signal_) ? nullptr : &agent;
-      uint32_t num_agents = (settings.system_scope_signal_) ? 0 : 1;
-
-      if (HSA_STATUS_SUCCESS == hsa_signal_create(0, num_agents, agents, &signal->signal_)) {
-        signal_list_[current_id_]->release();
-        signal_list_[current_id_] = signal.release();
-      } else {
-        assert(!"ProfilingSignal reallocation failed! Marker has a conflict with signal reuse!");
-      }
+      signal_list_[current_id_]->release();
+      signal_list_[current_id_] = signal;
     } else {
       assert(!"ProfilingSignal reallocation failed! Marker has a conflict with signal reuse!");
     }
@@ -438,13 +519,20 @@ hsa_signal_t VirtualGPU::HwQueueTracker::ActiveSignal(
           hsa_signal_add_relaxed(prof_signal->signal_, 1);
           init_value += 1;
         }
-        hsa_status_t result = hsa_amd_signal_async_handler(prof_signal->signal_,
-            HSA_SIGNAL_CONDITION_LT, init_value, &HsaAmdSignalHandler, ts);
-        if (HSA_STATUS_SUCCESS != result) {
-          LogError("hsa_amd_signal_async_handler() failed to set the handler!");
+        // API callbacks block the AQL queue and the profiler requeues the handler,
+        // hence both require a handler per marker
+        if (ROC_BATCH_COMPLETION && (ts->command().Callback() == nullptr) &&
+            !gpu_.isProfilerAttached()) {
+          QueueCompletion(ts, prof_signal);
         } else {
-          ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Set Handler: handle(0x%lx), timestamp(%p)",
-            prof_signal->signal_.handle, prof_signal);
+          hsa_status_t result = hsa_amd_signal_async_handler(prof_signal->signal_,
+              HSA_SIGNAL_CONDITION_LT, init_value, &HsaAmdSignalHandler, ts);
+          if (HSA_STATUS_SUCCESS != result) {
+            LogError("hsa_amd_signal_async_handler() failed to set the handler!");
+          } else {
+            ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Set Handler: handle(0x%lx), timestamp(%p)",
+              prof_signal->signal_.handle, prof_signal);
+          }
         }
         SetHandlerPending(false);
         // Update the current command/marker with HW event
@@ -462,6 +550,10 @@ hsa_signal_t VirtualGPU::HwQueueTracker::ActiveSignal(
       sdma_profiling_ = true;
     }
   }
+  // SDMA copies complete with this signal. The AQL packets update the state on the doorbell
+  if (gpu_.doorbell_pending_ == 0) {
+    gpu_.lastSignal_.store(prof_signal->signal_.handle, std::memory_order_release);
+  }
   return prof_signal->signal_;
 }
 
@@ -531,6 +623,8 @@ std::vector<hsa_signal_t>& VirtualGPU::HwQueueTracker::WaitingSignal(HwQueueEngi
 
 // ================================================================================================
 bool VirtualGPU::HwQueueTracker::CpuWaitForSignal(ProfilingSignal* signal) {
+  // The signal can belong to a packet with the deferred doorbell
+  gpu_.flushDoorbell();
   // Wait for the current signal
   if (signal->ts_ != nullptr) {
     // Update timestamp values if requested
@@ -542,7 +636,11 @@ bool VirtualGPU::HwQueueTracker::CpuWaitForSignal(ProfilingSignal* signal) {
     amd::ScopedLock lock(signal->LockSignalOps());
     ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "Host wait on completion_signal=0x%zx",
             signal->signal_.handle);
-    if (!WaitForSignal(signal->signal_, gpu_.ActiveWait())) {
+    const amd::Device::WaitMode mode = gpu_.dev().GetWaitMode();
+    bool result = (ROC_ADAPTIVE_SIGNAL_WAIT && (mode == amd::Device::WaitAuto)) ?
+        WaitForSignalAdaptive(signal->signal_, &expected_wait_) :
+        WaitForSignalMode(signal->signal_, mode);
+    if (!result) {
       LogPrintfError("Failed signal [0x%lx] wait", signal->signal_);
       return false;
     }
@@ -784,6 +882,12 @@ bool VirtualGPU::processMemObjects(const amd::Kernel& kernel, const_address para
     }
   }
 
+  // Validate the memory objects, which the kernel accesses through a descriptor table
+  for (const auto& it : indirectMemObjects_) {
+    memoryDependency().validate(*this, it.first, it.second);
+  }
+  indirectMemObjects_.clear();
+
   if (hsaKernel.program()->hasGlobalStores()) {
     // Sync AQL packets
     setAqlHeader(dispatchPacketHeader_);
@@ -804,12 +908,15 @@ static inline void packet_store_release(uint32_t* packet, uint16_t header, uint1
 template <typename AqlPacket>
 bool VirtualGPU::dispatchGenericAqlPacket(
   AqlPacket* packet, uint16_t header, uint16_t rest, bool blocking, size_t size) {
+  const uint64_t writeTime = amd::LatencyStats::start();
   const uint32_t queueSize = gpu_queue_->size;
   const uint32_t queueMask = queueSize - 1;
   const uint32_t sw_queue_size = queueMask;
 
+  // Reserve the slots with acquire-release ordering, because several VirtualGPUs and
+  // host threads can share the HW queue and contend only on the write index.
   // Check for queue full and wait if needed.
-  uint64_t index = hsa_queue_add_write_index_screlease(gpu_queue_, size);
+  uint64_t index = hsa_queue_add_write_index_scacq_screl(gpu_queue_, size);
   uint64_t read = hsa_queue_load_read_index_relaxed(gpu_queue_);
 
   auto cache_state = extractAqlBits(header, HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE,
@@ -821,9 +928,7 @@ bool VirtualGPU::dispatchGenericAqlPacket(
   }
 
   // Make sure the slot is free for usage
-  while ((index - hsa_queue_load_read_index_scacquire(gpu_queue_)) >= sw_queue_size) {
-    amd::Os::yield();
-  }
+  waitFreeSlot(index, read, sw_queue_size);
 
   // Add blocking command if the original value of read index was behind of the queue size.
   // Note: direct dispatch relies on the slot stall above to keep the forward progress
@@ -835,6 +940,11 @@ bool VirtualGPU::dispatchGenericAqlPacket(
     blocking = true;
   }
 
+  // Kernel arguments of the dispatch for the kernel arg ring tracking
+  const void* kernarg = (extractAqlBits(header, HSA_PACKET_HEADER_TYPE,
+      HSA_PACKET_HEADER_WIDTH_TYPE) == HSA_PACKET_TYPE_KERNEL_DISPATCH) ?
+      reinterpret_cast<hsa_kernel_dispatch_packet_t*>(packet)->kernarg_address : nullptr;
+
   // Insert packet(s)
   // NOTE: need multiple packets to dispatch the performance counter
   //       packet blob of the legacy devices (gfx8)
@@ -869,13 +979,17 @@ bool VirtualGPU::dispatchGenericAqlPacket(
             reinterpret_cast<hsa_kernel_dispatch_packet_t*>(packet)->completion_signal);
   }
 
+  roc_device_.latencyStats().record(amd::LatencyStats::PacketWrite, writeTime);
+
   //hsa_queue_store_write_index_release(gpu_queue_, index);
-  hsa_signal_store_screlease(gpu_queue_->doorbell_signal, index - 1);
+  ringDoorbell(index - 1);
+  markKernArg(index - 1, header, kernarg);
 
   roc_device_.SetCacheState(static_cast<Device::CacheState>(cache_state));
 
   // Wait on signal ?
   if (blocking) {
+    flushDoorbell();
     LogInfo("Runtime reachead the AQL queue limit. SW is much ahead of HW. Blocking AQL queue!");
     if (!Barriers().WaitCurrent()) {
       LogPrintfError("Failed blocking queue wait with signal [0x%lx]",
@@ -965,7 +1079,7 @@ void VirtualGPU::dispatchBarrierPacket(uint16_t packetHeader, bool skipSignal,
     }
   }
 
-  uint64_t index = hsa_queue_add_write_index_screlease(gpu_queue_, 1);
+  uint64_t index = hsa_queue_add_write_index_scacq_screl(gpu_queue_, 1);
   uint64_t read = hsa_queue_load_read_index_relaxed(gpu_queue_);
 
   auto cache_state = extractAqlBits(packetHeader, HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE,
@@ -979,13 +1093,14 @@ void VirtualGPU::dispatchBarrierPacket(uint16_t packetHeader, bool skipSignal,
     barrier_packet_.completion_signal = signal;
   }
 
-  while ((index - hsa_queue_load_read_index_scacquire(gpu_queue_)) >= queueMask);
+  waitFreeSlot(index, read, queueMask);
   hsa_barrier_and_packet_t* aql_loc =
     &(reinterpret_cast<hsa_barrier_and_packet_t*>(gpu_queue_->base_address))[index & queueMask];
   *aql_loc = barrier_packet_;
   __atomic_store_n(reinterpret_cast<uint32_t*>(aql_loc), packetHeader, __ATOMIC_RELEASE);
 
-  hsa_signal_store_screlease(gpu_queue_->doorbell_signal, index);
+  ringDoorbell(index);
+  markKernArg(index, packetHeader);
   ClPrint(amd::LOG_DEBUG, amd::LOG_AQL,
           "HWq=0x%zx, BarrierAND Header = 0x%x (type=%d, barrier=%d, acquire=%d,"
           " release=%d), "
@@ -1017,6 +1132,9 @@ void VirtualGPU::ResetQueueStates() {
   // Release all transfer buffers on this command queue
   releaseXferWrite();
 
+  // Release the views of the completed image blits
+  releaseDelayedViews();
+
   // Release all memory dependencies
   memoryDependency().clear();
 
@@ -1039,6 +1157,11 @@ bool VirtualGPU::releaseGpuMemoryFence(bool skip_cpu_wait) {
     Barriers().WaitCurrent();
 
     ResetQueueStates();
+
+    // The queue is idle, so the asynchronous printf output must be complete as well
+    if (ROC_PRINTF_ASYNC && (printfdbg_ != nullptr)) {
+      printfdbg_->drain();
+    }
   }
   return true;
 }
@@ -1058,8 +1181,8 @@ VirtualGPU::VirtualGPU(Device& device, bool profiling, bool cooperative,
       schedulerParam_(nullptr),
       schedulerQueue_(nullptr),
       schedulerSignal_({0}),
+      prefetchAheadSignal_({0}),
       barriers_(*this),
-      kernarg_pool_signal_(KernelArgPoolNumSignal),
       cuMask_(cuMask),
       priority_(priority),
       copy_command_type_(0)
@@ -1076,7 +1199,7 @@ VirtualGPU::VirtualGPU(Device& device, bool profiling, bool cooperative,
 
   kernarg_pool_base_ = nullptr;
   kernarg_pool_size_ = 0;
-  kernarg_pool_cur_offset_ = 0;
+  resetKernArgPool();
 
   if (device.settings().fenceScopeAgent_) {
     dispatchPacketHeaderNoSync_ =
@@ -1115,12 +1238,18 @@ VirtualGPU::~VirtualGPU() {
   if (tracking_created_) {
     // Release the resources of signal
     releaseGpuMemoryFence();
+    // Make sure the completion handler doesn't access this queue anymore
+    barriers_.DrainCompletions();
   }
 
   destroyPool();
 
+  destroyCounterSampling();
+
   releasePinnedMem();
 
+  releaseDelayedViews();
+
   if (timestamp_ != nullptr) {
     timestamp_->release();
     timestamp_ = nullptr;
@@ -1133,6 +1262,12 @@ VirtualGPU::~VirtualGPU() {
     hsa_signal_destroy(schedulerSignal_);
   }
 
+  if (0 != prefetchAheadSignal_.handle) {
+    // The read-ahead may still run in ROCr
+    WaitForSignal(prefetchAheadSignal_);
+    hsa_signal_destroy(prefetchAheadSignal_);
+  }
+
   if (nullptr != schedulerQueue_) {
     hsa_queue_destroy(schedulerQueue_);
   }
@@ -1165,6 +1300,9 @@ bool VirtualGPU::create() {
   uint32_t queue_size = ROC_AQL_QUEUE_SIZE;
   gpu_queue_ = roc_device_.acquireQueue(queue_size, cooperative_, cuMask_, priority_);
   if (!gpu_queue_) return false;
+  if (ROC_LATENCY_STATS) {
+    hwQueueStats_ = roc_device_.hwQueueStats(gpu_queue_);
+  }
 
   if (!initPool(dev().settings().kernargPoolSize_)) {
     LogError("Couldn't allocate arguments/signals for the queue");
@@ -1213,65 +1351,281 @@ bool VirtualGPU::create() {
 // ================================================================================================
 bool VirtualGPU::initPool(size_t kernarg_pool_size) {
   kernarg_pool_size_ = kernarg_pool_size;
-  kernarg_pool_chunk_end_ = kernarg_pool_size_ / KernelArgPoolNumSignal;
-  active_chunk_ = 0;
+  resetKernArgPool();
+  amd::MemoryStats::Scope scope(amd::MemoryStats::Kernarg);
   kernarg_pool_base_ = reinterpret_cast<address>(roc_device_.hostAlloc(kernarg_pool_size_, 0,
                                                  Device::MemorySegment::kKernArg));
   if (kernarg_pool_base_ == nullptr) {
     return false;
   }
-  hsa_agent_t agent = gpu_device();
-  for (auto& it : kernarg_pool_signal_) {
-    if (HSA_STATUS_SUCCESS != hsa_signal_create(0, 1, &agent, &it)) {
+  return true;
+}
+
+// ================================================================================================
+void VirtualGPU::destroyPool() {
+  if (kernarg_pool_base_ != nullptr) {
+    roc_device_.hostFree(kernarg_pool_base_, kernarg_pool_size_);
+  }
+}
+
+// ================================================================================================
+bool VirtualGPU::createCounterSampling() {
+  PerfCounterProfile* profile = new PerfCounterProfile(roc_device_);
+  if (!profile->Create()) {
+    profile->release();
+    return false;
+  }
+  counterSampling_.profile_ = profile;
+
+  // Parse the list of block:event pairs, the counter index is ignored by aqlprofile
+  std::stringstream events(ROC_COUNTER_SAMPLE_EVENTS);
+  std::string item;
+  while (std::getline(events, item, ',')) {
+    uint32_t block = 0;
+    uint32_t event = 0;
+    if (sscanf(item.c_str(), "%u:%u", &block, &event) != 2) {
+      LogPrintfError("Invalid counter sample event %s", item.c_str());
+      return false;
+    }
+    PerfCounter* counter = new PerfCounter(roc_device_, block,
+        static_cast<uint32_t>(counterSampling_.counters_.size()), event);
+    counterSampling_.counters_.push_back(counter);
+    if (counter->gfxVersion() == PerfCounter::ROC_UNSUPPORTED) {
+      return false;
+    }
+    counter->setProfile(profile);
+  }
+
+  // The packets are built once and replayed for every sampled dispatch
+  return !counterSampling_.counters_.empty() && profile->initialize() &&
+         (profile->createStartPacket() != nullptr) && (profile->createStopPacket() != nullptr);
+}
+
+// ================================================================================================
+void VirtualGPU::destroyCounterSampling() {
+  // The queue is idle after the memory fence release, hence the last sample is done
+  if (counterSampling_.pending_) {
+    counterSampleCollect();
+  }
+  for (auto counter : counterSampling_.counters_) {
+    delete counter;
+  }
+  counterSampling_.counters_.clear();
+  if (counterSampling_.profile_ != nullptr) {
+    counterSampling_.profile_->release();
+    counterSampling_.profile_ = nullptr;
+  }
+}
+
+// ================================================================================================
+bool VirtualGPU::counterSampleCollect() {
+  if (hsa_signal_load_relaxed(counterSampling_.profile_->completionSignal()) != 0) {
+    return false;
+  }
+  std::vector<uint64_t> values(counterSampling_.counters_.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = counterSampling_.counters_[i]->getInfo(CL_PERFCOUNTER_DATA);
+  }
+  roc_device_.addCounterSample(counterSampling_.kernel_, values);
+  counterSampling_.pending_ = false;
+  return true;
+}
+
+// ================================================================================================
+bool VirtualGPU::counterSampleBegin(const std::string& kernel) {
+  if (counterSampling_.disabled_ ||
+      ((counterSampling_.dispatches_++ % ROC_COUNTER_SAMPLE_RATE) != 0)) {
+    return false;
+  }
+  if (counterSampling_.profile_ == nullptr) {
+    if (!createCounterSampling()) {
+      LogWarning("Counter sampling is disabled, the counter set isn't supported");
+      destroyCounterSampling();
+      counterSampling_.disabled_ = true;
       return false;
     }
   }
+  // The output buffer is shared by all samples, hence skip the dispatch if the previous sample
+  // is still in flight. The submission never waits for the counters.
+  if (counterSampling_.pending_ && !counterSampleCollect()) {
+    return false;
+  }
+  PerfCounterProfile* profile = counterSampling_.profile_;
+  hsa_signal_store_relaxed(profile->completionSignal(), 1);
+  counterSampling_.kernel_ = kernel;
+
+  // The profiling signal of the command must stay on the kernel dispatch
+  Timestamp* timestamp = timestamp_;
+  timestamp_ = nullptr;
+  dispatchCounterAqlPacket(profile->prePacket(), counterSampling_.counters_[0]->gfxVersion(),
+                           false, profile->api());
+  timestamp_ = timestamp;
   return true;
 }
 
 // ================================================================================================
-void VirtualGPU::destroyPool() {
-  for (auto& it : kernarg_pool_signal_) {
-    if (it.handle != 0) {
-      hsa_signal_destroy(it);
+void VirtualGPU::counterSampleEnd() {
+  PerfCounterProfile* profile = counterSampling_.profile_;
+  Timestamp* timestamp = timestamp_;
+  timestamp_ = nullptr;
+  dispatchCounterAqlPacket(profile->postPacket(), counterSampling_.counters_[0]->gfxVersion(),
+                           false, profile->api());
+  timestamp_ = timestamp;
+  counterSampling_.pending_ = true;
+}
+
+// ================================================================================================
+void VirtualGPU::waitFreeSlot(uint64_t index, uint64_t read, uint64_t swQueueSize) {
+  if (hwQueueStats_ != nullptr) {
+    hwQueueStats_->stats_[amd::Device::HwQueueOccupancy].record(index - std::min(read, index));
+  }
+  if ((index - hsa_queue_load_read_index_scacquire(gpu_queue_)) < swQueueSize) {
+    return;
+  }
+  const uint64_t waitStart = amd::LatencyStats::start();
+  while ((index - hsa_queue_load_read_index_scacquire(gpu_queue_)) >= swQueueSize) {
+    amd::Os::yield();
+  }
+  if ((hwQueueStats_ != nullptr) && (waitStart != 0)) {
+    hwQueueStats_->stats_[amd::Device::HwQueueSlotWait].record(amd::Os::timeNanos() - waitStart);
+  }
+}
+
+// ================================================================================================
+void VirtualGPU::ringDoorbell(uint64_t index) {
+  if (doorbell_batch_) {
+    const uint64_t now = amd::Os::timeNanos();
+    if (doorbell_pending_ == 0) {
+      doorbell_start_ = now;
+    }
+    doorbell_index_ = index;
+    ++doorbell_pending_;
+    // Publish the batch if it's too big or the first packet waits too long
+    if ((doorbell_pending_ < ROC_DOORBELL_BATCH_SIZE) &&
+        ((now - doorbell_start_) < (ROC_DOORBELL_BATCH_LATENCY * 1000ull))) {
+      // The HW doesn't see the packet, hence the queries must take the slow path with a flush
+      lastSignal_.store(0, std::memory_order_release);
+      return;
     }
   }
-  if (kernarg_pool_base_ != nullptr) {
-    roc_device_.hostFree(kernarg_pool_base_, kernarg_pool_size_);
+  const uint64_t doorbellTime = amd::LatencyStats::start();
+  hsa_signal_store_screlease(gpu_queue_->doorbell_signal, index);
+  roc_device_.latencyStats().record(amd::LatencyStats::Doorbell, doorbellTime);
+  doorbell_pending_ = 0;
+  trackLastPacket(index);
+}
+
+// ================================================================================================
+void VirtualGPU::flushDoorbell() const {
+  if (doorbell_pending_ != 0) {
+    const uint64_t doorbellTime = amd::LatencyStats::start();
+    hsa_signal_store_screlease(gpu_queue_->doorbell_signal, doorbell_index_);
+    roc_device_.latencyStats().record(amd::LatencyStats::Doorbell, doorbellTime);
+    doorbell_pending_ = 0;
+    trackLastPacket(doorbell_index_);
+  }
+}
+
+// ================================================================================================
+void VirtualGPU::trackLastPacket(uint64_t index) const {
+  // All AQL packet types keep the completion signal at the same offset
+  const hsa_barrier_and_packet_t* packet =
+      &(reinterpret_cast<const hsa_barrier_and_packet_t*>(gpu_queue_->base_address))
+          [index & (gpu_queue_->size - 1)];
+  lastSignal_.store(packet->completion_signal.handle, std::memory_order_release);
+}
+
+// ================================================================================================
+device::VirtualDevice::QueueState VirtualGPU::queryState() const {
+  const uint64_t handle = lastSignal_.load(std::memory_order_acquire);
+  if (handle == 0) {
+    return QueueState::Unknown;
+  }
+  // The queue is in-order, hence the last signal completes after all earlier work
+  const hsa_signal_t signal = {handle};
+  return (hsa_signal_load_scacquire(signal) < kInitSignalValueOne) ? QueueState::Idle :
+                                                                     QueueState::Busy;
+}
+
+// ================================================================================================
+void VirtualGPU::markKernArg(uint64_t index, uint16_t header, const void* kernarg) {
+  uint32_t offset = kernarg_pool_dispatch_offset_;
+  const uint8_t* args = reinterpret_cast<const uint8_t*>(kernarg);
+  const bool ring_args = (args >= kernarg_pool_base_) &&
+                         (args < kernarg_pool_base_ + kernarg_pool_size_);
+  if (ring_args) {
+    // All earlier packets have their arguments below this packet arguments
+    offset = static_cast<uint32_t>(args - kernarg_pool_base_);
+  }
+  // A packet without the barrier bit doesn't wait for the earlier packets
+  if ((header & (1 << HSA_PACKET_HEADER_BARRIER)) != 0) {
+    if (kernarg_pool_marks_.empty() || (kernarg_pool_marks_.back().offset_ != offset)) {
+      kernarg_pool_marks_.push_back({index, offset});
+    } else {
+      kernarg_pool_marks_.back().index_ = index;
+    }
+  }
+  if (ring_args) {
+    // The next packets can't use the arguments, allocated before this dispatch
+    kernarg_pool_dispatch_offset_ = kernarg_pool_cur_offset_;
+  }
+}
+
+// ================================================================================================
+void VirtualGPU::reclaimKernArg() {
+  uint64_t read = hsa_queue_load_read_index_scacquire(gpu_queue_);
+  while (!kernarg_pool_marks_.empty() && (kernarg_pool_marks_.front().index_ < read)) {
+    kernarg_pool_tail_ = kernarg_pool_marks_.front().offset_;
+    kernarg_pool_marks_.pop_front();
   }
 }
 
 // ================================================================================================
 void* VirtualGPU::allocKernArg(size_t size, size_t alignment) {
   assert(alignment != 0);
-  address result = nullptr;
-  result = amd::alignUp(kernarg_pool_base_ + kernarg_pool_cur_offset_, alignment);
-  const size_t pool_new_usage = (result + size) - kernarg_pool_base_;
-  if (pool_new_usage <= kernarg_pool_chunk_end_) {
-    kernarg_pool_cur_offset_ = pool_new_usage;
-    return result;
-  } else {
-    //! We run out of the arguments space!
-    //! That means the app didn't call clFlush/clFinish for very long time.
-    // Reset the signal for the barrier packet
-    hsa_signal_silent_store_relaxed(kernarg_pool_signal_[active_chunk_], kInitSignalValueOne);
-    // Dispatch a barrier packet into the queue
-    dispatchBarrierPacket(kBarrierPacketHeader, true, kernarg_pool_signal_[active_chunk_]);
-    // Get the next chunk
-    active_chunk_ = ++active_chunk_ % KernelArgPoolNumSignal;
-    // Make sure the new active chunk is free
-    bool test = WaitForSignal(kernarg_pool_signal_[active_chunk_], ActiveWait());
-    assert(test && "Runtime can't fail a wait for chunk!");
-    // Make sure the current offset matches the new chunk to avoid possible overlaps
-    // between chunks and issues during recycle
-    kernarg_pool_cur_offset_ = (active_chunk_ == 0) ? 0 : kernarg_pool_chunk_end_;
-    kernarg_pool_chunk_end_ = kernarg_pool_cur_offset_ +
-                              kernarg_pool_size_ / KernelArgPoolNumSignal;
-    result = amd::alignUp(kernarg_pool_base_ + kernarg_pool_cur_offset_, alignment);
-    kernarg_pool_cur_offset_ = (result + size) - kernarg_pool_base_;
+  assert(size < kernarg_pool_size_ && "Kernel args can't exceed the ring size!");
+  bool barrier = false;
+  while (true) {
+    address result = amd::alignUp(kernarg_pool_base_ + kernarg_pool_cur_offset_, alignment);
+    const size_t end = (result + size) - kernarg_pool_base_;
+    if (kernarg_pool_cur_offset_ >= kernarg_pool_tail_) {
+      // The free space is above the head and below the tail
+      if (end <= kernarg_pool_size_) {
+        kernarg_pool_cur_offset_ = end;
+        return result;
+      }
+      result = amd::alignUp(kernarg_pool_base_, alignment);
+      const size_t wrap_end = (result + size) - kernarg_pool_base_;
+      // Keep the head behind the tail, so the full ring doesn't look empty
+      if (wrap_end < kernarg_pool_tail_) {
+        // The wrap reuses old kernel args, hence make sure the caches are invalidated
+        dispatchBarrierPacket(kBarrierPacketHeader, true);
+        kernarg_pool_cur_offset_ = wrap_end;
+        return result;
+      }
+    } else if (end < kernarg_pool_tail_) {
+      kernarg_pool_cur_offset_ = end;
+      return result;
+    }
+    //! The ring is full, hence wait for the packet processor
+    flushDoorbell();
+    reclaimKernArg();
+    if ((kernarg_pool_cur_offset_ == kernarg_pool_tail_) && kernarg_pool_marks_.empty()) {
+      // All packets are retired, restart from the beginning of the ring
+      kernarg_pool_cur_offset_ = kernarg_pool_tail_ = kernarg_pool_dispatch_offset_ = 0;
+      kernarg_pool_marks_.clear();
+      continue;
+    }
+    if (!barrier && kernarg_pool_marks_.empty()) {
+      // No packet retires the used space. A barrier forces retirement of all earlier packets
+      dispatchBarrierPacket(kBarrierPacketHeader, true);
+      barrier = true;
+    }
+    if (!kernarg_pool_marks_.empty() &&
+        (hsa_queue_load_read_index_scacquire(gpu_queue_) <= kernarg_pool_marks_.front().index_)) {
+      amd::Os::yield();
+    }
   }
-
-  return result;
 }
 
 // ================================================================================================
@@ -1302,21 +1656,21 @@ void VirtualGPU::profilingBegin(amd::Command& command, bool drmProfiling) {
     timestamp_->start();
   }
 
-  if (AMD_DIRECT_DISPATCH) {
-    if (!retainExternalSignals_) {
-      Barriers().ClearExternalSignals();
-    }
-    for (auto it = command.eventWaitList().begin(); it < command.eventWaitList().end(); ++it) {
-      void* hw_event = ((*it)->NotifyEvent() != nullptr) ?
-        (*it)->NotifyEvent()->HwEvent() : (*it)->HwEvent();
-      if (hw_event != nullptr) {
-        Barriers().AddExternalSignal(reinterpret_cast<ProfilingSignal*>(hw_event));
-      } else if (static_cast<amd::Command*>(*it)->queue() != command.queue() &&
-                 ((*it)->status() != CL_COMPLETE)) {
-        LogPrintfError("Waiting event(%p) doesn't have a HSA signal!\n", *it);
-      } else {
-        // Assume serialization on the same queue...
-      }
+  // Collect HSA signals of the wait list. The host queue thread skips the CPU wait for
+  // the events with HW signals, hence the wait occurs on GPU in both dispatch modes
+  if (!retainExternalSignals_) {
+    Barriers().ClearExternalSignals();
+  }
+  for (auto it = command.eventWaitList().begin(); it < command.eventWaitList().end(); ++it) {
+    void* hw_event = ((*it)->NotifyEvent() != nullptr) ?
+      (*it)->NotifyEvent()->HwEvent() : (*it)->HwEvent();
+    if (hw_event != nullptr) {
+      Barriers().AddExternalSignal(reinterpret_cast<ProfilingSignal*>(hw_event));
+    } else if (static_cast<amd::Command*>(*it)->queue() != command.queue() &&
+               ((*it)->status() != CL_COMPLETE)) {
+      LogPrintfError("Waiting event(%p) doesn't have a HSA signal!\n", *it);
+    } else {
+      // Assume serialization on the same queue...
     }
   }
 }
@@ -1645,25 +1999,47 @@ void VirtualGPU::submitSvmPrefetchAsync(amd::SvmPrefetchAsyncCommand& cmd) {
   profilingBegin(cmd);
 
   if (dev().info().hmmSupported_) {
-    // Initialize signal for the barrier
-    auto wait_events = Barriers().WaitingSignal(HwQueueEngine::Unknown);
-    hsa_signal_t active = Barriers().ActiveSignal(kInitSignalValueOne, timestamp_);
-
     // Find the requested agent for the transfer
     hsa_agent_t agent = (cmd.cpu_access() ||
         (dev().settings().hmmFlags_ & Settings::Hmm::EnableSystemMemory)) ?
         dev().getCpuAgent() : (static_cast<const roc::Device*>(cmd.device()))->getBackendDevice();
 
-    // Initiate a prefetch command
-    hsa_status_t status = hsa_amd_svm_prefetch_async(
-        const_cast<void*>(cmd.dev_ptr()), cmd.count(), agent,
-        wait_events.size(), wait_events.data(), active);
+    // Split the range into chunks, so the migration of the first chunks overlaps the rest
+    const size_t chunk = (dev().settings().hmmPrefetchChunkSize_ != 0) ?
+        dev().settings().hmmPrefetchChunkSize_ : std::max<size_t>(cmd.count(), 1);
+    const uint32_t numChunks = std::max(1u,
+        static_cast<uint32_t>((cmd.count() + chunk - 1) / chunk));
+
+    // Initialize signal for the barrier. Every chunk decrements it
+    auto wait_events = Barriers().WaitingSignal(HwQueueEngine::Unknown);
+    hsa_signal_t active = Barriers().ActiveSignal(numChunks, timestamp_);
+
+    address dev_ptr = reinterpret_cast<address>(const_cast<void*>(cmd.dev_ptr()));
+    hsa_status_t status = HSA_STATUS_SUCCESS;
+    uint32_t submitted = 0;
+    for (size_t offset = 0; submitted < numChunks; offset += chunk, ++submitted) {
+      // Initiate a prefetch command
+      status = hsa_amd_svm_prefetch_async(dev_ptr + offset, std::min(chunk, cmd.count() - offset),
+          agent, wait_events.size(), wait_events.data(), active);
+      if (status != HSA_STATUS_SUCCESS) {
+        break;
+      }
+    }
 
-    // Wait for the prefetch. Should skip wait, but may require extra tracking for kernel execution
-    if ((status != HSA_STATUS_SUCCESS) || !Barriers().WaitCurrent()) {
-      Barriers().ResetCurrentSignal();
-      LogError("hsa_amd_svm_prefetch_async failed");
+    // The prefetch doesn't wait on the host. The next operation on the queue waits for
+    // the signal, since the prefetch runs on an unknown engine
+    if (status != HSA_STATUS_SUCCESS) {
+      if (submitted == 0) {
+        Barriers().ResetCurrentSignal();
+      } else {
+        // The submitted chunks still have to complete the signal
+        hsa_signal_subtract_relaxed(active, numChunks - submitted);
+      }
+      LogPrintfError("hsa_amd_svm_prefetch_async failed with code %d", status);
       cmd.setStatus(CL_INVALID_OPERATION);
+      prefetchStream_.next_ = nullptr;
+    } else {
+      prefetchAhead(cmd, agent);
     }
 
     // Add system scope, since the prefetch scope is unclear
@@ -1674,6 +2050,68 @@ void VirtualGPU::submitSvmPrefetchAsync(amd::SvmPrefetchAsyncCommand& cmd) {
   profilingEnd(cmd);
 }
 
+// ================================================================================================
+void VirtualGPU::prefetchAhead(const amd::SvmPrefetchAsyncCommand& cmd, hsa_agent_t agent) {
+  const Settings& settings = dev().settings();
+  address start = reinterpret_cast<address>(const_cast<void*>(cmd.dev_ptr()));
+  address end = start + cmd.count();
+
+  // The stream is sequential if the prefetch continues the previous one to the same agent
+  bool sequential = (start == prefetchStream_.next_) &&
+                    (prefetchStream_.agent_.handle == agent.handle);
+  if (!sequential) {
+    prefetchStream_.ahead_ = nullptr;
+  }
+  prefetchStream_.next_ = end;
+  prefetchStream_.agent_ = agent;
+
+  if (!sequential || (settings.hmmPrefetchAhead_ == 0) ||
+      (settings.hmmPrefetchChunkSize_ == 0)) {
+    return;
+  }
+
+  // Skip the chunks, which the previous read-ahead covered
+  address ahead = std::max(end, prefetchStream_.ahead_);
+  address target = end + static_cast<size_t>(settings.hmmPrefetchAhead_) *
+                         settings.hmmPrefetchChunkSize_;
+  if (ahead >= target) {
+    return;
+  }
+
+  // Clamp the read-ahead to the allocation, since HMM can't migrate unmapped ranges
+  amd::Memory* mem = amd::MemObjMap::FindMemObj(ahead);
+  if (mem == nullptr) {
+    return;
+  }
+  address limit = std::min(target, reinterpret_cast<address>(mem->getSvmPtr()) + mem->getSize());
+  if (ahead >= limit) {
+    return;
+  }
+  const size_t size = limit - ahead;
+
+  if (prefetchAheadSignal_.handle == 0) {
+    if (HSA_STATUS_SUCCESS != hsa_signal_create(0, 0, nullptr, &prefetchAheadSignal_)) {
+      prefetchAheadSignal_.handle = 0;
+      return;
+    }
+  } else if (hsa_signal_load_relaxed(prefetchAheadSignal_) > 0) {
+    // The previous read-ahead is still in flight, hence skip this one
+    return;
+  }
+
+  // The read-ahead doesn't depend on the queue and nothing waits for it, so
+  // it overlaps the kernels, which consume the current range
+  hsa_signal_store_relaxed(prefetchAheadSignal_, kInitSignalValueOne);
+  if (HSA_STATUS_SUCCESS != hsa_amd_svm_prefetch_async(ahead, size, agent, 0, nullptr,
+                                                      prefetchAheadSignal_)) {
+    hsa_signal_store_relaxed(prefetchAheadSignal_, 0);
+    return;
+  }
+  ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "HMM read-ahead ptr=0x%zx, size=%zu",
+          reinterpret_cast<uintptr_t>(ahead), size);
+  prefetchStream_.ahead_ = limit;
+}
+
 // ================================================================================================
 bool VirtualGPU::copyMemory(cl_command_type type, amd::Memory& srcMem, amd::Memory& dstMem,
                             bool entire, const amd::Coord3D& srcOrigin,
@@ -1780,32 +2218,90 @@ void VirtualGPU::submitCopyMemory(amd::CopyMemoryCommand& cmd) {
 }
 
 // ================================================================================================
-void VirtualGPU::submitSvmCopyMemory(amd::SvmCopyMemoryCommand& cmd) {
+void VirtualGPU::submitCopyMemoryBatch(amd::CopyMemoryBatchCommand& cmd) {
   // Make sure VirtualGPU has an exclusive access to the resources
   amd::ScopedLock lock(execution());
 
   profilingBegin(cmd);
-  // no op for FGS supported device
-  if (!dev().isFineGrainedSystem(true)) {
-    amd::Coord3D srcOrigin(0, 0, 0);
-    amd::Coord3D dstOrigin(0, 0, 0);
-    amd::Coord3D size(cmd.srcSize(), 1, 1);
-    amd::BufferRect srcRect;
-    amd::BufferRect dstRect;
 
-    bool result = false;
-    amd::Memory* srcMem = amd::MemObjMap::FindMemObj(cmd.src());
-    amd::Memory* dstMem = amd::MemObjMap::FindMemObj(cmd.dst());
+  // Small device to device ranges go into a single blit dispatch, the rest is copied
+  // with the regular path, which may pick SDMA or the wide blits
+  std::vector<amd::CopyMemoryBatchCommand::Range> batch;
+  batch.reserve(cmd.ranges().size());
+  bool result = true;
+  for (const auto& it : cmd.ranges()) {
+    Memory* srcDevMem = dev().getRocMemory(it.src_);
+    Memory* dstDevMem = dev().getRocMemory(it.dst_);
+    if ((it.size_ <= KernelBlitManager::kBatchMaxRangeSize) &&
+        !srcDevMem->isHostMemDirectAccess() && !dstDevMem->isHostMemDirectAccess() &&
+        (&srcDevMem->dev() == &dev()) && (&dstDevMem->dev() == &dev())) {
+      srcDevMem->syncCacheFromHost(*this);
+      dstDevMem->syncCacheFromHost(*this);
+      batch.push_back(it);
+    } else {
+      amd::Coord3D srcOrigin(it.srcOffset_);
+      amd::Coord3D dstOrigin(it.dstOffset_);
+      amd::Coord3D size(it.size_);
+      amd::BufferRect rect;
+      result &= copyMemory(CL_COMMAND_COPY_BUFFER, *it.src_, *it.dst_, false, srcOrigin,
+                           dstOrigin, size, rect, rect);
+    }
+  }
 
-    device::Memory::SyncFlags syncFlags;
-    if (nullptr != srcMem) {
-      srcOrigin.c[0] =
-          static_cast<const_address>(cmd.src()) - static_cast<address>(srcMem->getSvmPtr());
-      if (!(srcMem->validateRegion(srcOrigin, size))) {
-        cmd.setStatus(CL_INVALID_OPERATION);
-        return;
+  if (!batch.empty()) {
+    KernelBlitManager& blit = static_cast<KernelBlitManager&>(blitMgr());
+    if (blit.copyBufferBatch(batch.data(), batch.size())) {
+      for (const auto& it : batch) {
+        // Mark this as the most-recently written cache of the destination
+        it.dst_->signalWrite(&dev());
       }
-    }
+    } else {
+      // The batch kernel isn't available, hence copy the ranges one by one
+      for (const auto& it : batch) {
+        amd::Coord3D srcOrigin(it.srcOffset_);
+        amd::Coord3D dstOrigin(it.dstOffset_);
+        amd::Coord3D size(it.size_);
+        amd::BufferRect rect;
+        result &= copyMemory(CL_COMMAND_COPY_BUFFER, *it.src_, *it.dst_, false, srcOrigin,
+                             dstOrigin, size, rect, rect);
+      }
+    }
+  }
+
+  if (!result) {
+    cmd.setStatus(CL_INVALID_OPERATION);
+  }
+
+  profilingEnd(cmd);
+}
+
+// ================================================================================================
+void VirtualGPU::submitSvmCopyMemory(amd::SvmCopyMemoryCommand& cmd) {
+  // Make sure VirtualGPU has an exclusive access to the resources
+  amd::ScopedLock lock(execution());
+
+  profilingBegin(cmd);
+  // no op for FGS supported device
+  if (!dev().isFineGrainedSystem(true)) {
+    amd::Coord3D srcOrigin(0, 0, 0);
+    amd::Coord3D dstOrigin(0, 0, 0);
+    amd::Coord3D size(cmd.srcSize(), 1, 1);
+    amd::BufferRect srcRect;
+    amd::BufferRect dstRect;
+
+    bool result = false;
+    amd::Memory* srcMem = amd::MemObjMap::FindMemObj(cmd.src());
+    amd::Memory* dstMem = amd::MemObjMap::FindMemObj(cmd.dst());
+
+    device::Memory::SyncFlags syncFlags;
+    if (nullptr != srcMem) {
+      srcOrigin.c[0] =
+          static_cast<const_address>(cmd.src()) - static_cast<address>(srcMem->getSvmPtr());
+      if (!(srcMem->validateRegion(srcOrigin, size))) {
+        cmd.setStatus(CL_INVALID_OPERATION);
+        return;
+      }
+    }
     if (nullptr != dstMem) {
       dstOrigin.c[0] =
           static_cast<const_address>(cmd.dst()) - static_cast<address>(dstMem->getSvmPtr());
@@ -1861,6 +2357,63 @@ void VirtualGPU::submitSvmCopyMemory(amd::SvmCopyMemoryCommand& cmd) {
   profilingEnd(cmd);
 }
 
+// ================================================================================================
+//! Returns true if the device can access the memory of the owner device
+static bool canAccessP2P(const Device& device, const Device& owner) {
+  if (&device == &owner) {
+    return true;
+  }
+  for (auto agent : owner.p2pAgents()) {
+    if (agent.handle == device.getBackendDevice().handle) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// ================================================================================================
+//! Finds the device with the shortest links to both memories, which can copy between them
+static Device* findP2PRelay(const Device& src, const Device& dst) {
+  // The topology doesn't change, hence the route is found once per devices pair
+  static amd::Monitor relayLock("P2P relay lock");
+  static std::map<std::pair<const Device*, const Device*>, Device*> relays;
+  amd::ScopedLock lock(relayLock);
+  auto key = std::make_pair(&src, &dst);
+  auto it = relays.find(key);
+  if (it != relays.end()) {
+    return it->second;
+  }
+
+  Device* relay = nullptr;
+  int32_t minDistance = std::numeric_limits<int32_t>::max();
+  for (auto device : amd::Device::getDevices(CL_DEVICE_TYPE_GPU, false)) {
+    Device* candidate = static_cast<Device*>(device);
+    if (!canAccessP2P(*candidate, src) || !canAccessP2P(*candidate, dst)) {
+      continue;
+    }
+    // The NUMA distance accumulates the hops and prefers xGMI over PCIe
+    int32_t distance = 0;
+    for (const Device* owner : {&src, &dst}) {
+      std::vector<amd::Device::LinkAttrType> link_attrs;
+      link_attrs.push_back(std::make_pair(amd::Device::LinkAttribute::kLinkDistance, 0));
+      if (!candidate->findLinkInfo(*owner, &link_attrs)) {
+        distance = std::numeric_limits<int32_t>::max();
+        break;
+      }
+      distance += link_attrs[0].second;
+    }
+    if (distance < minDistance) {
+      minDistance = distance;
+      relay = candidate;
+    }
+  }
+  relays[key] = relay;
+  ClPrint(amd::LOG_INFO, amd::LOG_COPY, "P2P route from %p to %p: %s %p (distance %d)",
+          &src, &dst, (relay != nullptr) ? "relay" : "host staging", relay, minDistance);
+  return relay;
+}
+
+// ================================================================================================
 void VirtualGPU::submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& cmd) {
   // Make sure VirtualGPU has an exclusive access to the resources
   amd::ScopedLock lock(execution());
@@ -1872,22 +2425,12 @@ void VirtualGPU::submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& cmd) {
   Memory* dstDevMem = static_cast<roc::Memory*>(
     cmd.destination().getDeviceMemory(*cmd.destination().getContext().devices()[0]));
 
-  bool p2pAllowed = false;
-  // Loop through all available P2P devices for the destination buffer
-  for (auto agent: dstDevMem->dev().p2pAgents()) {
-    // Find the device, which is matching the current
-    if (agent.handle == dev().getBackendDevice().handle) {
-      p2pAllowed = true;
-      break;
-    }
-
-    for (auto agent: srcDevMem->dev().p2pAgents()) {
-      if (agent.handle == dev().getBackendDevice().handle) {
-        p2pAllowed = true;
-        break;
-      }
-    }
-  }
+  // Route the copy: on the current device, if it can access both memories, on a relay device
+  // with the access, i.e. over another GPU links, or through the host staging buffer
+  const bool p2pAllowed = canAccessP2P(dev(), srcDevMem->dev()) &&
+                          canAccessP2P(dev(), dstDevMem->dev());
+  Device* relay = (p2pAllowed || !ROC_P2P_RELAY) ? nullptr :
+                  findP2PRelay(srcDevMem->dev(), dstDevMem->dev());
 
   // Synchronize source and destination memory
   device::Memory::SyncFlags syncFlags;
@@ -1903,6 +2446,11 @@ void VirtualGPU::submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& cmd) {
       if (p2pAllowed) {
           result = blitMgr().copyBuffer(*srcDevMem, *dstDevMem, srcOrigin, dstOrigin,
                                         size, cmd.isEntireMemory());
+      } else if (relay != nullptr) {
+          // Sync the current queue, since the relay device copies on its transfer queue
+          releaseGpuMemoryFence();
+          result = relay->xferMgr().copyBuffer(*srcDevMem, *dstDevMem, srcOrigin, dstOrigin,
+                                               size, cmd.isEntireMemory());
       }
       else {
           // Sync the current queue, since P2P staging uses the device queues for transfer
@@ -1986,6 +2534,17 @@ void VirtualGPU::submitSvmMapMemory(amd::SvmMapMemoryCommand& cmd) {
         const void* mappedPtr = hsaMapMemory->owner()->getHostMem();
         amd::Os::fastMemcpy(cmd.svmPtr(), mappedPtr, cmd.size()[0]);
       }
+      if (ROC_SVM_MAP_WRITE_WATCH &&
+          (cmd.mapFlags() & (CL_MAP_WRITE | CL_MAP_WRITE_INVALIDATE_REGION))) {
+        // Only the whole pages are watched, the partial pages at the ends are always copied
+        address begin = amd::alignUp(reinterpret_cast<address>(cmd.svmPtr()),
+                                     amd::Os::pageSize());
+        address end = amd::alignDown(reinterpret_cast<address>(cmd.svmPtr()) + cmd.size()[0],
+                                     amd::Os::pageSize());
+        if (end > begin) {
+          amd::Os::watchWrites(begin, end - begin);
+        }
+      }
     } else {
       LogError("Unhandled svm map!");
     }
@@ -1994,6 +2553,50 @@ void VirtualGPU::submitSvmMapMemory(amd::SvmMapMemoryCommand& cmd) {
   profilingEnd(cmd);
 }
 
+// ================================================================================================
+bool VirtualGPU::copySvmWrittenPages(Memory& memory, Memory& hsaMapMemory, void* svmPtr,
+                                     const device::Memory::WriteMapInfo& writeMapInfo) {
+  const size_t size = writeMapInfo.region_[0];
+  address start = reinterpret_cast<address>(svmPtr);
+  address begin = amd::alignUp(start, amd::Os::pageSize());
+  address end = amd::alignDown(start + size, amd::Os::pageSize());
+  std::vector<bool> pages;
+  if ((end <= begin) || !amd::Os::unwatchWrites(begin, &pages)) {
+    return false;
+  }
+
+  // Copies the ranges of the written pages, including the partial pages at the ends
+  address mappedPtr = reinterpret_cast<address>(hsaMapMemory.owner()->getHostMem());
+  auto copy = [&](size_t offset, size_t count) {
+    if (count == 0) {
+      return true;
+    }
+    amd::Os::fastMemcpy(mappedPtr + offset, start + offset, count);
+    amd::Coord3D origin(writeMapInfo.origin_[0] + offset);
+    return blitMgr().copyBuffer(hsaMapMemory, memory, origin, origin, amd::Coord3D(count));
+  };
+  bool result = copy(0, begin - start);
+  size_t skipped = 0;
+  for (size_t i = 0; i < pages.size();) {
+    size_t last = i;
+    while ((last < pages.size()) && (pages[last] == pages[i])) {
+      ++last;
+    }
+    const size_t offset = (begin - start) + i * amd::Os::pageSize();
+    const size_t count = (last - i) * amd::Os::pageSize();
+    if (pages[i]) {
+      result &= copy(offset, count);
+    } else {
+      skipped += count;
+    }
+    i = last;
+  }
+  result &= copy(end - start, start + size - end);
+  ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "SVM unmap %p skipped 0x%zx of 0x%zx bytes", svmPtr,
+          skipped, size);
+  return result;
+}
+
 void VirtualGPU::submitSvmUnmapMemory(amd::SvmUnmapMemoryCommand& cmd) {
   // Make sure VirtualGPU has an exclusive access to the resources
   amd::ScopedLock lock(execution());
@@ -2013,14 +2616,18 @@ void VirtualGPU::submitSvmUnmapMemory(amd::SvmUnmapMemoryCommand& cmd) {
         amd::Coord3D srcOrigin(0, 0, 0);
         Memory* hsaMapMemory = dev().getRocMemory(memory->mapMemory());
 
-        void* mappedPtr = hsaMapMemory->owner()->getHostMem();
-        amd::Os::fastMemcpy(mappedPtr, cmd.svmPtr(), writeMapInfo->region_[0]);
-        // Target is a remote resource, so copy
-        if (!blitMgr().copyBuffer(*hsaMapMemory, *memory, writeMapInfo->origin_,
-                                  writeMapInfo->origin_, writeMapInfo->region_,
-                                  writeMapInfo->isEntire())) {
-          LogError("submitSvmUnmapMemory() - copy failed");
-          cmd.setStatus(CL_OUT_OF_RESOURCES);
+        // The write watch copies only the written pages, else the whole region is copied
+        if (!ROC_SVM_MAP_WRITE_WATCH ||
+            !copySvmWrittenPages(*memory, *hsaMapMemory, cmd.svmPtr(), *writeMapInfo)) {
+          void* mappedPtr = hsaMapMemory->owner()->getHostMem();
+          amd::Os::fastMemcpy(mappedPtr, cmd.svmPtr(), writeMapInfo->region_[0]);
+          // Target is a remote resource, so copy
+          if (!blitMgr().copyBuffer(*hsaMapMemory, *memory, writeMapInfo->origin_,
+                                    writeMapInfo->origin_, writeMapInfo->region_,
+                                    writeMapInfo->isEntire())) {
+            LogError("submitSvmUnmapMemory() - copy failed");
+            cmd.setStatus(CL_OUT_OF_RESOURCES);
+          }
         }
       }
     } else {
@@ -2074,6 +2681,9 @@ void VirtualGPU::submitMapMemory(amd::MapMemoryCommand& cmd) {
     }
   } else if (devMemory->IsPersistentDirectMap()) {
     // Persistent memory - NOP map
+  } else if (devMemory->IsLargeBarDirectMap(cmd.mapFlags())) {
+    // The CPU writes into the device memory, so only wait for the GPU accesses
+    releaseGpuMemoryFence();
   } else if (mapFlag & (CL_MAP_READ | CL_MAP_WRITE)) {
     bool result = false;
     roc::Memory* hsaMemory = static_cast<roc::Memory*>(devMemory);
@@ -2163,6 +2773,14 @@ void VirtualGPU::submitUnmapMemory(amd::UnmapMemoryCommand& cmd) {
     }
   } else if (devMemory->IsPersistentDirectMap()) {
     // Persistent memory - NOP unmap
+  } else if (mapInfo->isUnmapWrite() && !mapInfo->isUnmapRead() &&
+             devMemory->IsLargeBarDirectMap(CL_MAP_WRITE)) {
+    // The data is in place already. The barrier invalidates the GPU caches and the later
+    // packets are ordered after it, hence CPU doesn't wait
+    dev().largeBarFlush();
+    hasPendingDispatch();
+    releaseGpuMemoryFence(kSkipCpuWait);
+    cmd.memory().signalWrite(&dev());
   } else if (mapInfo->isUnmapWrite()) {
     // Commit the changes made by the user.
     if (!devMemory->isHostMemDirectAccess()) {
@@ -2303,7 +2921,7 @@ void VirtualGPU::dispatchBarrierValuePacket(const hsa_amd_barrier_value_packet_t
   const uint32_t queueSize = gpu_queue_->size;
   const uint32_t queueMask = queueSize - 1;
 
-  uint64_t index = hsa_queue_add_write_index_screlease(gpu_queue_, 1);
+  uint64_t index = hsa_queue_add_write_index_scacq_screl(gpu_queue_, 1);
   while ((index - hsa_queue_load_read_index_scacquire(gpu_queue_)) >= queueMask) {
     amd::Os::yield();
   }
@@ -2316,7 +2934,7 @@ void VirtualGPU::dispatchBarrierValuePacket(const hsa_amd_barrier_value_packet_t
   auto cache_state = extractAqlBits(header.header, HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE,
                          HSA_PACKET_HEADER_WIDTH_SCRELEASE_FENCE_SCOPE);
 
-  hsa_signal_store_screlease(gpu_queue_->doorbell_signal, index);
+  ringDoorbell(index);
   roc_device_.SetCacheState(static_cast<Device::CacheState>(cache_state));
 
   ClPrint(amd::LOG_DEBUG, amd::LOG_AQL,
@@ -2349,10 +2967,13 @@ void VirtualGPU::submitStreamOperation(amd::StreamOperationCommand& cmd) {
   Memory* memory = dev().getRocMemory(amdMemory);
 
   if (type == ROCCLR_COMMAND_STREAM_WAIT_VALUE) {
-    if (GPU_STREAMOPS_CP_WAIT) {
-      hsa_amd_barrier_value_packet_t aqlPacket;
+    // The CP waits on the signal memory with a barrier-value packet, so the wait doesn't occupy
+    // a CU with a polling kernel. The packet compares the whole signal value
+    const bool cpWait = (amdMemory->getMemFlags() & ROCCLR_MEM_HSA_SIGNAL_MEMORY) &&
+                        (offset == 0) && (dev().info().aqlBarrierValue_ || GPU_STREAMOPS_CP_WAIT);
+    if (cpWait) {
+      hsa_amd_barrier_value_packet_t aqlPacket = {};
       hsa_amd_vendor_packet_header_t header;
-      hsa_signal_t signal;
       Buffer* buff = static_cast<Buffer*>(memory);
 
       header.header = kBarrierVendorPacketHeader;
@@ -2360,33 +2981,43 @@ void VirtualGPU::submitStreamOperation(amd::StreamOperationCommand& cmd) {
       aqlPacket.signal = buff->getSignal();
       aqlPacket.completion_signal = Barriers().ActiveSignal();
 
+      // 32 bit waits compare the low half of the 64 bit signal value only
+      const uint64_t sizeMask = (sizeBytes == sizeof(uint32_t)) ?
+          std::numeric_limits<uint32_t>::max() : std::numeric_limits<uint64_t>::max();
+      const uint64_t waitMask = mask & sizeMask;
+      const uint64_t waitValue = value & sizeMask;
+
       // mask is always applied on value at signal before performing
       // the comparision defiend by 'condition'
       switch (flags) {
         case ROCCLR_STREAM_WAIT_VALUE_GTE:
-          aqlPacket.value = value;
-          aqlPacket.mask = mask;
+          aqlPacket.value = waitValue;
+          aqlPacket.mask = waitMask;
           aqlPacket.cond = HSA_SIGNAL_CONDITION_GTE;
           break;
         case ROCCLR_STREAM_WAIT_VALUE_EQ:
-          aqlPacket.value = value;
-          aqlPacket.mask = mask;
+          aqlPacket.value = waitValue;
+          aqlPacket.mask = waitMask;
           aqlPacket.cond = HSA_SIGNAL_CONDITION_EQ;
           break;
         case ROCCLR_STREAM_WAIT_VALUE_AND:
+          // (signal & mask & value) != 0
           aqlPacket.value = 0;
-          aqlPacket.mask = (value & mask);
+          aqlPacket.mask = waitValue & waitMask;
           aqlPacket.cond = HSA_SIGNAL_CONDITION_NE;
           break;
         case ROCCLR_STREAM_WAIT_VALUE_NOR:
-          aqlPacket.value = ~value & mask;
-          aqlPacket.mask = ~value & mask;
+          // (~(signal | value) & mask) != 0, i.e. a bit of ~value & mask is clear in the signal
+          aqlPacket.value = ~waitValue & waitMask;
+          aqlPacket.mask = ~waitValue & waitMask;
           aqlPacket.cond = HSA_SIGNAL_CONDITION_NE;
           break;
         default:
           ShouldNotReachHere();
           break;
       }
+      ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "CP waiting for value: 0x%lx."
+              " Flags: 0x%lx mask: 0x%lx", value, flags, mask);
       dispatchBarrierValuePacket(&aqlPacket, header);
     }
     // Use a blit kernel to perform the wait operation
@@ -2419,6 +3050,33 @@ void VirtualGPU::submitStreamOperation(amd::StreamOperationCommand& cmd) {
   profilingEnd(cmd);
 }
 
+// ================================================================================================
+void VirtualGPU::submitExternalSemaphoreCmd(amd::ExternalSemaphoreCmd& cmd) {
+  // Make sure VirtualGPU has an exclusive access to the resources
+  amd::ScopedLock lock(execution());
+  profilingBegin(cmd);
+
+  amd::Memory* payload = reinterpret_cast<amd::BufferVk*>(const_cast<void*>(cmd.sem_ptr()));
+  Memory* memory = dev().getRocMemory(payload);
+  bool result = false;
+  if (cmd.semaphoreCmd() == amd::ExternalSemaphoreCmd::COMMAND_SIGNAL_EXTSEMAPHORE) {
+    // Ensure memory ordering preceding the write
+    dispatchBarrierPacket(kBarrierPacketReleaseHeader);
+    result = static_cast<KernelBlitManager&>(blitMgr()).streamOpsWrite(*memory, cmd.fence(), 0,
+                                                                        sizeof(uint64_t));
+  } else {
+    // The payload is a timeline value, hence the wait completes on any value at or above fence
+    result = static_cast<KernelBlitManager&>(blitMgr()).streamOpsWait(
+        *memory, cmd.fence(), 0, sizeof(uint64_t), ROCCLR_STREAM_WAIT_VALUE_GTE,
+        std::numeric_limits<uint64_t>::max());
+  }
+  if (!result) {
+    LogError("submitExternalSemaphoreCmd: GPU semaphore operation failed!");
+    cmd.setStatus(CL_INVALID_OPERATION);
+  }
+  profilingEnd(cmd);
+}
+
 void VirtualGPU::submitSvmFillMemory(amd::SvmFillMemoryCommand& cmd) {
   // Make sure VirtualGPU has an exclusive access to the resources
   amd::ScopedLock lock(execution());
@@ -2680,6 +3338,114 @@ bool VirtualGPU::createVirtualQueue(uint deviceQueueSize)
   return true;
 }
 
+// ================================================================================================
+bool VirtualGPU::isOutOfOrderLaunch(const amd::Command& command) {
+  if (!ROC_OUT_OF_ORDER_DISPATCH || (command.queue() == nullptr) ||
+      command.queue()->isInOrder()) {
+    return false;
+  }
+  // The host queue thread doesn't wait for the commands of the same queue, hence only the
+  // barrier bit can order the kernel after a pending command of the same queue
+  for (const auto& it : command.eventWaitList()) {
+    if ((it->command().queue() == command.queue()) && (it->status() != CL_COMPLETE)) {
+      return false;
+    }
+  }
+  // The waits for other queues are the barrier packets ahead of the dispatch
+  return Barriers().IsExternalSignalListEmpty();
+}
+
+// ================================================================================================
+//! Writes a hidden argument of the launch sizes, specialized for the work dimensions
+template <uint32_t Dims>
+static void WriteHiddenSizeArg(address args, const amd::KernelParameterDescriptor& desc,
+                               const size_t* offset, const size_t* global,
+                               const amd::NDRange& local) {
+  switch (desc.info_.oclObject_) {
+    case amd::KernelParameterDescriptor::HiddenGlobalOffsetX:
+      WriteAqlArgAt(args, offset[0], desc.size_, desc.offset_);
+      break;
+    case amd::KernelParameterDescriptor::HiddenGlobalOffsetY:
+      if (Dims >= 2) {
+        WriteAqlArgAt(args, offset[1], desc.size_, desc.offset_);
+      }
+      break;
+    case amd::KernelParameterDescriptor::HiddenGlobalOffsetZ:
+      if (Dims >= 3) {
+        WriteAqlArgAt(args, offset[2], desc.size_, desc.offset_);
+      }
+      break;
+    case amd::KernelParameterDescriptor::HiddenBlockCountX:
+      WriteAqlArgAt(args, static_cast<uint32_t>(global[0] / local[0]), desc.size_, desc.offset_);
+      break;
+    case amd::KernelParameterDescriptor::HiddenBlockCountY:
+      WriteAqlArgAt(args, static_cast<uint32_t>((Dims >= 2) ? global[1] / local[1] : 1),
+                    desc.size_, desc.offset_);
+      break;
+    case amd::KernelParameterDescriptor::HiddenBlockCountZ:
+      WriteAqlArgAt(args, static_cast<uint32_t>((Dims >= 3) ? global[2] / local[2] : 1),
+                    desc.size_, desc.offset_);
+      break;
+    case amd::KernelParameterDescriptor::HiddenGroupSizeX:
+      WriteAqlArgAt(args, static_cast<uint16_t>(local[0]), desc.size_, desc.offset_);
+      break;
+    case amd::KernelParameterDescriptor::HiddenGroupSizeY:
+      WriteAqlArgAt(args, static_cast<uint16_t>((Dims >= 2) ? local[1] : 1),
+                    desc.size_, desc.offset_);
+      break;
+    case amd::KernelParameterDescriptor::HiddenGroupSizeZ:
+      WriteAqlArgAt(args, static_cast<uint16_t>((Dims >= 3) ? local[2] : 1),
+                    desc.size_, desc.offset_);
+      break;
+    case amd::KernelParameterDescriptor::HiddenRemainderX:
+      WriteAqlArgAt(args, static_cast<uint16_t>(global[0] % local[0]), desc.size_, desc.offset_);
+      break;
+    case amd::KernelParameterDescriptor::HiddenRemainderY:
+      if (Dims >= 2) {
+        WriteAqlArgAt(args, static_cast<uint16_t>(global[1] % local[1]), desc.size_, desc.offset_);
+      }
+      break;
+    case amd::KernelParameterDescriptor::HiddenRemainderZ:
+      if (Dims >= 3) {
+        WriteAqlArgAt(args, static_cast<uint16_t>(global[2] % local[2]), desc.size_, desc.offset_);
+      }
+      break;
+    case amd::KernelParameterDescriptor::HiddenGridDims:
+      WriteAqlArgAt(args, static_cast<uint16_t>(Dims), desc.size_, desc.offset_);
+      break;
+  }
+}
+
+// ================================================================================================
+//! Fills the dispatch packet with straight-line stores, specialized for the work dimensions.
+//! The header stays invalid until the dispatch publishes the packet
+template <uint32_t Dims>
+static void FillDispatchPacket(hsa_kernel_dispatch_packet_t* packet, const size_t* global,
+                               const amd::NDRange& local) {
+  packet->header = kInvalidAql;
+  packet->setup = 0;
+  packet->workgroup_size_x = local[0];
+  packet->workgroup_size_y = (Dims >= 2) ? local[1] : 1;
+  packet->workgroup_size_z = (Dims >= 3) ? local[2] : 1;
+  packet->reserved0 = 0;
+  packet->grid_size_x = global[0];
+  packet->grid_size_y = (Dims >= 2) ? global[1] : 1;
+  packet->grid_size_z = (Dims >= 3) ? global[2] : 1;
+  packet->reserved2 = 0;
+  packet->completion_signal.handle = 0;
+}
+
+//! The writers of the launch sizes, selected once per launch by the work dimensions
+struct LaunchWriter {
+  void (*hidden_)(address, const amd::KernelParameterDescriptor&, const size_t*, const size_t*,
+                  const amd::NDRange&);
+  void (*packet_)(hsa_kernel_dispatch_packet_t*, const size_t*, const amd::NDRange&);
+};
+static constexpr LaunchWriter kLaunchWriters[3] = {
+    {WriteHiddenSizeArg<1>, FillDispatchPacket<1>},
+    {WriteHiddenSizeArg<2>, FillDispatchPacket<2>},
+    {WriteHiddenSizeArg<3>, FillDispatchPacket<3>}};
+
 // ================================================================================================
 bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
     const amd::Kernel& kernel, const_address parameters, void* eventHandle,
@@ -2692,6 +3458,11 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
 
   // Check memory dependency and SVM objects
   bool coopGroups = (vcmd != nullptr) ? vcmd->cooperativeGroups() : false;
+  // The kernel can overlap the earlier packets, unless the memory processing below
+  // adds some packets for this launch
+  const uint64_t outOfOrderIndex =
+      ((vcmd != nullptr) && !coopGroups && isOutOfOrderLaunch(*vcmd)) ?
+      hsa_queue_load_write_index_relaxed(gpu_queue_) : std::numeric_limits<uint64_t>::max();
   if (!processMemObjects(kernel, parameters, ldsUsage, coopGroups,
                          imageBufferWrtBack, wrtBackImageBuffer)) {
     LogError("Wrong memory objects!");
@@ -2700,6 +3471,15 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
 
   // Init PrintfDbg object if printf is enabled.
   bool printfEnabled = (gpuKernel.printfInfo().size() > 0) ? true : false;
+  const bool capturing = (vcmd != nullptr) && vcmd->getCapturingState();
+  if (capturing && (printfEnabled || gpuKernel.dynamicParallelism() || imageBufferWrtBack ||
+                    gpuKernel.isInternalKernel())) {
+    // The captured packet can't rely on the per dispatch processing after the submission
+    ClPrint(amd::LOG_INFO, amd::LOG_KERN, "Kernel %s can't be captured into AQL packet",
+            gpuKernel.name().c_str());
+    vcmd->setCapturingState(false);
+    return true;
+  }
   if (!printfDbg()->init(printfEnabled)) {
     LogError("\nPrintfDbg object initialization failed!");
     return false;
@@ -2707,6 +3487,7 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
 
   const amd::KernelSignature& signature = kernel.signature();
   const amd::KernelParameters& kernelParams = kernel.parameters();
+  const Kernel::HiddenArgs& hiddenArgs = gpuKernel.hiddenArgs(signature);
 
   size_t newOffset[3] = {0, 0, 0};
   size_t newGlobalSize[3] = {0, 0, 0};
@@ -2752,28 +3533,15 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
     // Calculate local size if it wasn't provided
     devKernel->FindLocalWorkSize(sizes.dimensions(), sizes.global(), local);
 
-    // Check if runtime has to setup hidden arguments
-    for (uint32_t i = signature.numParameters(); i < signature.numParametersAll(); ++i) {
-      const auto& it = signature.at(i);
+    // Setup the hidden arguments of the launch sizes with the writer of the dimensions
+    const LaunchWriter& writer = kLaunchWriters[sizes.dimensions() - 1];
+    for (const auto desc : hiddenArgs.sizes_) {
+      writer.hidden_(hidden_arguments, *desc, newOffset, newGlobalSize, local);
+    }
+    // Check if runtime has to setup the other hidden arguments
+    for (const auto desc : hiddenArgs.resources_) {
+      const auto& it = *desc;
       switch (it.info_.oclObject_) {
-        case amd::KernelParameterDescriptor::HiddenNone:
-          break;
-        case amd::KernelParameterDescriptor::HiddenGlobalOffsetX: {
-          WriteAqlArgAt(hidden_arguments, newOffset[0], it.size_, it.offset_);
-          break;
-        }
-        case amd::KernelParameterDescriptor::HiddenGlobalOffsetY: {
-          if (sizes.dimensions() >= 2) {
-            WriteAqlArgAt(hidden_arguments, newOffset[1], it.size_, it.offset_);
-          }
-          break;
-        }
-        case amd::KernelParameterDescriptor::HiddenGlobalOffsetZ: {
-          if (sizes.dimensions() >= 3) {
-            WriteAqlArgAt(hidden_arguments, newOffset[2], it.size_, it.offset_);
-          }
-          break;
-        }
         case amd::KernelParameterDescriptor::HiddenPrintfBuffer: {
           uintptr_t bufferPtr = reinterpret_cast<uintptr_t>(printfDbg()->dbgBuffer());
           if (printfEnabled && bufferPtr) {
@@ -2858,63 +3626,6 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
             WriteAqlArgAt(hidden_arguments, heap_ptr, it.size_, it.offset_);
           }
           break;
-        case amd::KernelParameterDescriptor::HiddenBlockCountX:
-          WriteAqlArgAt(hidden_arguments, static_cast<uint32_t>(newGlobalSize[0] / local[0]),
-                        it.size_, it.offset_);
-          break;
-        case amd::KernelParameterDescriptor::HiddenBlockCountY:
-          if (sizes.dimensions() >= 2) {
-            WriteAqlArgAt(hidden_arguments, static_cast<uint32_t>(newGlobalSize[1] / local[1]),
-                          it.size_, it.offset_);
-          } else {
-            WriteAqlArgAt(hidden_arguments, static_cast<uint32_t>(1), it.size_, it.offset_);
-          }
-          break;
-        case amd::KernelParameterDescriptor::HiddenBlockCountZ:
-          if (sizes.dimensions() >= 3) {
-            WriteAqlArgAt(hidden_arguments, static_cast<uint32_t>(newGlobalSize[2] / local[2]),
-                          it.size_, it.offset_);
-          } else {
-            WriteAqlArgAt(hidden_arguments, static_cast<uint32_t>(1), it.size_, it.offset_);
-          }
-          break;
-        case amd::KernelParameterDescriptor::HiddenGroupSizeX:
-          WriteAqlArgAt(hidden_arguments, static_cast<uint16_t>(local[0]), it.size_, it.offset_);
-          break;
-        case amd::KernelParameterDescriptor::HiddenGroupSizeY:
-          if (sizes.dimensions() >= 2) {
-            WriteAqlArgAt(hidden_arguments, static_cast<uint16_t>(local[1]), it.size_, it.offset_);
-          } else {
-            WriteAqlArgAt(hidden_arguments, static_cast<uint16_t>(1), it.size_, it.offset_);
-          }
-          break;
-        case amd::KernelParameterDescriptor::HiddenGroupSizeZ:
-          if (sizes.dimensions() >= 3) {
-            WriteAqlArgAt(hidden_arguments, static_cast<uint16_t>(local[2]), it.size_, it.offset_);
-          } else {
-            WriteAqlArgAt(hidden_arguments, static_cast<uint16_t>(1), it.size_, it.offset_);
-          }
-          break;
-        case amd::KernelParameterDescriptor::HiddenRemainderX:
-          WriteAqlArgAt(hidden_arguments, static_cast<uint16_t>(newGlobalSize[0] % local[0]),
-                        it.size_, it.offset_);
-          break;
-        case amd::KernelParameterDescriptor::HiddenRemainderY:
-          if (sizes.dimensions() >= 2) {
-            WriteAqlArgAt(hidden_arguments, static_cast<uint16_t>(newGlobalSize[1] % local[1]),
-                          it.size_, it.offset_);
-          }
-          break;
-        case amd::KernelParameterDescriptor::HiddenRemainderZ:
-          if (sizes.dimensions() >= 3) {
-            WriteAqlArgAt(hidden_arguments, static_cast<uint16_t>(newGlobalSize[2] % local[2]),
-                          it.size_, it.offset_);
-          }
-          break;
-        case amd::KernelParameterDescriptor::HiddenGridDims:
-          WriteAqlArgAt(hidden_arguments, static_cast<uint16_t>(sizes.dimensions()),
-                        it.size_, it.offset_);
-          break;
         case amd::KernelParameterDescriptor::HiddenPrivateBase:
           WriteAqlArgAt(hidden_arguments,
                         reinterpret_cast<amd_queue_t*>(gpu_queue_)->private_segment_aperture_base_hi,
@@ -2928,17 +3639,29 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
         case amd::KernelParameterDescriptor::HiddenQueuePtr:
           WriteAqlArgAt(hidden_arguments, gpu_queue_, it.size_, it.offset_);
           break;
+        default:
+          break;
       }
     }
 
     address argBuffer = hidden_arguments;
     // Find all parameters for the current kernel
-    if (!kernel.parameters().deviceKernelArgs() || gpuKernel.isInternalKernel()) {
+    if (capturing) {
+      // The captured arguments must outlive the kernel arg pool, hence use the provided storage
+      argBuffer = vcmd->getCapturedKernArgs();
+      memcpy(argBuffer, parameters, gpuKernel.KernargSegmentByteSize());
+    } else if (!kernel.parameters().deviceKernelArgs() || gpuKernel.isInternalKernel()) {
+      const size_t argSize = gpuKernel.KernargSegmentByteSize();
+      size_t argAlignment = gpuKernel.KernargSegmentAlignment();
+      if (ROC_KERNARG_SINGLE_LINE && (argSize <= kKernArgCacheLine)) {
+        // Small arguments must not straddle two cachelines, so the dispatch writes
+        // only one line of system memory
+        argAlignment = std::max(argAlignment, kKernArgCacheLine);
+      }
       // Allocate buffer to hold kernel arguments
-      argBuffer = reinterpret_cast<address>(allocKernArg(gpuKernel.KernargSegmentByteSize(),
-                                            gpuKernel.KernargSegmentAlignment()));
+      argBuffer = reinterpret_cast<address>(allocKernArg(argSize, argAlignment));
       // Load all kernel arguments
-      memcpy(argBuffer, parameters, gpuKernel.KernargSegmentByteSize());
+      memcpy(argBuffer, parameters, argSize);
     }
 
     // Check for group memory overflow
@@ -2951,21 +3674,8 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
 
     // Initialize the dispatch Packet
     hsa_kernel_dispatch_packet_t dispatchPacket;
-    memset(&dispatchPacket, 0, sizeof(dispatchPacket));
-
-    dispatchPacket.header = kInvalidAql;
+    writer.packet_(&dispatchPacket, newGlobalSize, local);
     dispatchPacket.kernel_object = gpuKernel.KernelCodeHandle();
-
-   // dispatchPacket.header = aqlHeader_;
-    // dispatchPacket.setup |= sizes.dimensions() << HSA_KERNEL_DISPATCH_PACKET_SETUP_DIMENSIONS;
-    dispatchPacket.grid_size_x = sizes.dimensions() > 0 ? newGlobalSize[0] : 1;
-    dispatchPacket.grid_size_y = sizes.dimensions() > 1 ? newGlobalSize[1] : 1;
-    dispatchPacket.grid_size_z = sizes.dimensions() > 2 ? newGlobalSize[2] : 1;
-
-    dispatchPacket.workgroup_size_x = sizes.dimensions() > 0 ? local[0] : 1;
-    dispatchPacket.workgroup_size_y = sizes.dimensions() > 1 ? local[1] : 1;
-    dispatchPacket.workgroup_size_z = sizes.dimensions() > 2 ? local[2] : 1;
-
     dispatchPacket.kernarg_address = argBuffer;
     dispatchPacket.group_segment_size = ldsUsage + sharedMemBytes;
     dispatchPacket.private_segment_size = devKernel->workGroupInfo()->privateMemSize_;
@@ -2980,7 +3690,8 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
 
     // Pass the header accordingly
     auto aqlHeaderWithOrder = aqlHeader_;
-    if (vcmd != nullptr && vcmd->getAnyOrderLaunchFlag()) {
+    if ((vcmd != nullptr && vcmd->getAnyOrderLaunchFlag()) ||
+        (outOfOrderIndex == hsa_queue_load_write_index_relaxed(gpu_queue_))) {
       constexpr uint32_t kAqlHeaderMask = ~(1 << HSA_PACKET_HEADER_BARRIER);
       aqlHeaderWithOrder &= kAqlHeaderMask;
     }
@@ -2994,6 +3705,17 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
       addSystemScope_ = false;
     }
 
+    if (capturing) {
+      // The captured packets are replayed in order, hence always keep the barrier bit
+      dispatchPacket.header = dispatchPacketHeader_;
+      dispatchPacket.setup = sizes.dimensions() << HSA_KERNEL_DISPATCH_PACKET_SETUP_DIMENSIONS;
+      memcpy(vcmd->getAqlPacket(), &dispatchPacket, sizeof(dispatchPacket));
+      return true;
+    }
+
+    const bool counterSample = (ROC_COUNTER_SAMPLE_RATE != 0) &&
+        !gpuKernel.isInternalKernel() && counterSampleBegin(gpuKernel.name());
+
     // Dispatch the packet
     if (!dispatchAqlPacket(
             &dispatchPacket, aqlHeaderWithOrder,
@@ -3001,6 +3723,10 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
             GPU_FLUSH_ON_EXECUTION)) {
       return false;
     }
+
+    if (counterSample) {
+      counterSampleEnd();
+    }
   }
 
   // Mark the flag indicating if a dispatch is outstanding.
@@ -3014,9 +3740,23 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
   }
 
   if (gpuKernel.dynamicParallelism()) {
+    // The scheduler of the previous parent may still run, but it owns the parameters and
+    // the write index of the child queue
+    if (hsa_signal_load_relaxed(schedulerSignal_) != 0) {
+      flushDoorbell();
+      if (!WaitForSignal(schedulerSignal_)) {
+        LogWarning("Failed schedulerSignal wait");
+      }
+    }
     dispatchBarrierPacket(kBarrierPacketHeader, true);
-    static_cast<KernelBlitManager&>(blitMgr()).runScheduler(
-        getVQVirtualAddress(), schedulerParam_, schedulerQueue_, schedulerSignal_, schedulerThreads_);
+    if (static_cast<KernelBlitManager&>(blitMgr()).runScheduler(
+        getVQVirtualAddress(), schedulerParam_, schedulerQueue_, schedulerSignal_,
+        schedulerThreads_) && ROC_SCHEDULER_GPU_WAIT) {
+      // The scheduler relaunches itself until all children are done, hence the later packets
+      // wait for its signal on GPU and the host keeps submitting
+      barrier_packet_.dep_signal[0] = schedulerSignal_;
+      dispatchBarrierPacket(kBarrierPacketHeader, true);
+    }
   }
 
   // Check if image buffer write back is required
@@ -3049,71 +3789,212 @@ bool VirtualGPU::submitKernelInternal(const amd::NDRangeContainer& sizes,
  */
  // ================================================================================================
 void VirtualGPU::submitKernel(amd::NDRangeKernelCommand& vcmd) {
-  if (vcmd.cooperativeGroups() || vcmd.cooperativeMultiDeviceGroups()) {
-    // Wait for the execution on the current queue, since the coop groups will use the device queue
-    releaseGpuMemoryFence(kSkipCpuWait);
+  if (vcmd.getCapturingState()) {
+    // Make sure VirtualGPU has an exclusive access to the resources
+    amd::ScopedLock lock(execution());
+    if (vcmd.cooperativeGroups() || vcmd.cooperativeMultiDeviceGroups() ||
+        !submitKernelInternal(vcmd.sizes(), vcmd.kernel(), vcmd.parameters(),
+                              static_cast<void*>(as_cl(&vcmd.event())), vcmd.sharedMemBytes(),
+                              &vcmd)) {
+      vcmd.setCapturingState(false);
+    }
+    return;
+  }
 
+  if (vcmd.cooperativeGroups() || vcmd.cooperativeMultiDeviceGroups()) {
     // Get device queue for exclusive GPU access
-    VirtualGPU* queue = dev().xferQueue();
-    if (!queue) {
-      LogError("Runtime failed to acquire a cooperative queue!");
+    submitKernelOnQueue(vcmd, dev().xferQueue());
+  } else if (isScratchHeavy(vcmd.kernel())) {
+    // Only the scratch queue grows the scratch for the kernels with large private segments
+    submitKernelOnQueue(vcmd, dev().scratchQueue());
+  } else {
+    // Make sure VirtualGPU has an exclusive access to the resources
+    amd::ScopedLock lock(execution());
+
+    profilingBegin(vcmd);
+
+    // Submit kernel to HW
+    if (!submitKernelInternal(vcmd.sizes(), vcmd.kernel(), vcmd.parameters(),
+      static_cast<void*>(as_cl(&vcmd.event())), vcmd.sharedMemBytes(), &vcmd)) {
+      LogError("AQL dispatch failed!");
       vcmd.setStatus(CL_INVALID_OPERATION);
-      return;
     }
 
-    // Lock the queue, using the blit manager lock
-    amd::ScopedLock lock(queue->blitMgr().lockXfer());
+    profilingEnd(vcmd);
+  }
+}
+
+// ================================================================================================
+bool VirtualGPU::isScratchHeavy(const amd::Kernel& kernel) const {
+  if ((ROC_SCRATCH_QUEUE_THRESHOLD == 0) || (this == dev().scratchQueue(false))) {
+    return false;
+  }
+  const device::Kernel* devKernel = kernel.getDeviceKernel(dev());
+  return (devKernel != nullptr) &&
+      (devKernel->workGroupInfo()->privateMemSize_ > ROC_SCRATCH_QUEUE_THRESHOLD);
+}
+
+// ================================================================================================
+void VirtualGPU::submitKernelOnQueue(amd::NDRangeKernelCommand& vcmd, VirtualGPU* queue) {
+  if (!queue) {
+    LogError("Runtime failed to acquire a queue for the launch!");
+    vcmd.setStatus(CL_INVALID_OPERATION);
+    return;
+  }
+
+  // The device queue runs its own cooperative launches without the cross queue dependency
+  const bool external = (queue != this);
+
+  // The queue is in-order, hence if the current queue didn't submit anything after its
+  // last launch on the same queue, then the new launch is already ordered after the current queue
+  const bool chained = ROC_COOP_FAST_LAUNCH && external && (hopQueue_ == queue) &&
+      (hopWriteIndex_ == hsa_queue_load_write_index_relaxed(gpu_queue_)) &&
+      Barriers().IsOnlyExternalSignal(hopSignal_);
+
+  if (external && !chained) {
+    // Wait for the execution on the current queue, since the kernel will use the other queue
+    releaseGpuMemoryFence(kSkipCpuWait);
+  }
+
+  // Lock the queue, using the blit manager lock
+  amd::ScopedLock lock(queue->blitMgr().lockXfer());
 
-    queue->profilingBegin(vcmd);
+  queue->profilingBegin(vcmd);
 
-    // Add a dependency into the device queue on the current queue
+  if (external && !chained) {
+    // Add a dependency into the other queue on the current queue
     queue->Barriers().AddExternalSignal(Barriers().GetLastSignal());
+  }
 
-    if (vcmd.cooperativeGroups()) {
-      // Initialize GWS if it's cooperative groups launch
-      uint32_t workgroups = 1;
-      for (uint i = 0; i < vcmd.sizes().dimensions(); i++) {
-        if (vcmd.sizes().local()[i] != 0) {
-          workgroups *= (vcmd.sizes().global()[i] / vcmd.sizes().local()[i]);
-        }
+  if (vcmd.cooperativeGroups()) {
+    // Initialize GWS if it's cooperative groups launch
+    uint32_t workgroups = 1;
+    for (uint i = 0; i < vcmd.sizes().dimensions(); i++) {
+      if (vcmd.sizes().local()[i] != 0) {
+        workgroups *= (vcmd.sizes().global()[i] / vcmd.sizes().local()[i]);
       }
+    }
 
-      static_cast<KernelBlitManager&>(queue->blitMgr()).RunGwsInit(workgroups - 1);
+    // The GWS barrier rearms with the same value after the completion, hence the init kernel
+    // runs only if the size of the grid changes
+    if (!ROC_COOP_FAST_LAUNCH || (queue->gwsWorkgroups_ != workgroups)) {
+      if (static_cast<KernelBlitManager&>(queue->blitMgr()).RunGwsInit(workgroups - 1)) {
+        queue->gwsWorkgroups_ = workgroups;
+      }
     }
+  }
 
-    // Sync AQL packets
-    queue->setAqlHeader(dispatchPacketHeader_);
+  // Sync AQL packets
+  queue->setAqlHeader(dispatchPacketHeader_);
 
-    // Submit kernel to HW
-    if (!queue->submitKernelInternal(vcmd.sizes(), vcmd.kernel(), vcmd.parameters(),
-      static_cast<void*>(as_cl(&vcmd.event())), vcmd.sharedMemBytes(), &vcmd)) {
-      LogError("AQL dispatch failed!");
-      vcmd.setStatus(CL_INVALID_OPERATION);
-    }
-    // Wait for the execution on the device queue. Keep the current queue in-order
+  // Submit kernel to HW
+  if (!queue->submitKernelInternal(vcmd.sizes(), vcmd.kernel(), vcmd.parameters(),
+    static_cast<void*>(as_cl(&vcmd.event())), vcmd.sharedMemBytes(), &vcmd)) {
+    LogError("AQL dispatch failed!");
+    vcmd.setStatus(CL_INVALID_OPERATION);
+    // The GWS state is unknown after a failure
+    queue->gwsWorkgroups_ = 0;
+  }
+
+  if (external) {
+    // Wait for the execution on the other queue. Keep the current queue in-order
     queue->releaseGpuMemoryFence(kSkipCpuWait);
 
-    // Add a dependency into the current queue on the coop queue
-    Barriers().AddExternalSignal(queue->Barriers().GetLastSignal());
+    // Add a dependency into the current queue on the other queue. The signal of the previous
+    // chained launch is older on the same queue, hence the new signal replaces it
+    if (chained) {
+      Barriers().ClearExternalSignals();
+    }
+    hopQueue_ = queue;
+    hopSignal_ = queue->Barriers().GetLastSignal();
+    Barriers().AddExternalSignal(hopSignal_);
+    hopWriteIndex_ = hsa_queue_load_write_index_relaxed(gpu_queue_);
     hasPendingDispatch_ = true;
     retainExternalSignals_ = true;
+    // The current queue has no packet after the launch on the other queue yet
+    lastSignal_.store(0, std::memory_order_release);
+  }
 
-    queue->profilingEnd(vcmd);
-  } else {
-    // Make sure VirtualGPU has an exclusive access to the resources
-    amd::ScopedLock lock(execution());
+  queue->profilingEnd(vcmd);
+}
 
-    profilingBegin(vcmd);
+// ================================================================================================
+bool VirtualGPU::dispatchAqlPacketBatch(const hsa_kernel_dispatch_packet_t* packets,
+                                        size_t count) {
+  const uint32_t queueMask = gpu_queue_->size - 1;
+  // Keep a half of the queue available, so the batch can't starve other submissions
+  const uint32_t maxBatch = gpu_queue_->size / 2;
+
+  while (count > 0) {
+    const uint32_t batch = static_cast<uint32_t>(std::min<size_t>(count, maxBatch));
+    uint64_t index = hsa_queue_add_write_index_scacq_screl(gpu_queue_, batch);
+
+    // Make sure all slots are free for usage
+    while ((index + batch - hsa_queue_load_read_index_scacquire(gpu_queue_)) >= queueMask) {
+      amd::Os::yield();
+    }
 
-    // Submit kernel to HW
-    if (!submitKernelInternal(vcmd.sizes(), vcmd.kernel(), vcmd.parameters(),
-      static_cast<void*>(as_cl(&vcmd.event())), vcmd.sharedMemBytes(), &vcmd)) {
-      LogError("AQL dispatch failed!");
-      vcmd.setStatus(CL_INVALID_OPERATION);
+    hsa_kernel_dispatch_packet_t* first =
+        &(reinterpret_cast<hsa_kernel_dispatch_packet_t*>(gpu_queue_->base_address))
+            [index & queueMask];
+    // Copy the packet bodies first with the invalid headers
+    for (uint32_t i = 0; i < batch; ++i) {
+      hsa_kernel_dispatch_packet_t* aql_loc =
+          &(reinterpret_cast<hsa_kernel_dispatch_packet_t*>(gpu_queue_->base_address))
+              [(index + i) & queueMask];
+      *aql_loc = packets[i];
+      aql_loc->header = kInvalidAql;
+      if ((count == batch) && ((i + 1) == batch) && (timestamp_ != nullptr)) {
+        // Get active signal for the last dispatch if profiling is necessary
+        aql_loc->completion_signal = Barriers().ActiveSignal(kInitSignalValueOne, timestamp_);
+      }
     }
+    // Publish the packets in order, so CP can't process a partially written block
+    for (uint32_t i = 0; i < batch; ++i) {
+      hsa_kernel_dispatch_packet_t* aql_loc =
+          &(reinterpret_cast<hsa_kernel_dispatch_packet_t*>(gpu_queue_->base_address))
+              [(index + i) & queueMask];
+      packet_store_release(reinterpret_cast<uint32_t*>(aql_loc), packets[i].header,
+                           packets[i].setup);
+    }
+    hsa_signal_store_screlease(gpu_queue_->doorbell_signal, index + batch - 1);
+    trackLastPacket(index + batch - 1);
 
-    profilingEnd(vcmd);
+    ClPrint(amd::LOG_DEBUG, amd::LOG_AQL, "HWq=0x%zx, Dispatch batch of %d packets at 0x%zx",
+            gpu_queue_, batch, first);
+
+    auto cache_state = extractAqlBits(packets[batch - 1].header,
+                                      HSA_PACKET_HEADER_SCRELEASE_FENCE_SCOPE,
+                                      HSA_PACKET_HEADER_WIDTH_SCRELEASE_FENCE_SCOPE);
+    roc_device_.SetCacheState(static_cast<Device::CacheState>(cache_state));
+
+    packets += batch;
+    count -= batch;
   }
+  return true;
+}
+
+// ================================================================================================
+void VirtualGPU::submitAccumulate(amd::AccumulateCommand& vcmd) {
+  // Make sure VirtualGPU has an exclusive access to the resources
+  amd::ScopedLock lock(execution());
+
+  profilingBegin(vcmd);
+
+  // AQL dispatch doesn't support dependent signals and extra barrier packet must be generated
+  dispatchBlockingWait();
+
+  if (!dispatchAqlPacketBatch(
+          reinterpret_cast<const hsa_kernel_dispatch_packet_t*>(vcmd.packets()),
+          vcmd.numPackets())) {
+    LogError("AQL packet batch dispatch failed!");
+    vcmd.setStatus(CL_INVALID_OPERATION);
+  }
+
+  // Mark the flag indicating if a dispatch is outstanding.
+  hasPendingDispatch_ = true;
+
+  profilingEnd(vcmd);
 }
 
 // ================================================================================================
@@ -3150,6 +4031,42 @@ void VirtualGPU::submitMarker(amd::Marker& vcmd) {
   }
 }
 
+// ================================================================================================
+void* VirtualGPU::recordTimestamp(int32_t scope) {
+  // The profiler expects a marker command for every event record
+  if (isProfilerAttached()) {
+    return nullptr;
+  }
+  // Make sure VirtualGPU has an exclusive access to the resources
+  amd::ScopedLock lock(execution());
+  // A single barrier packet carries the timestamp in the profiling data of its signal
+  if (ROC_EVENT_NO_FLUSH && scope == Device::CacheState::kCacheStateIgnore) {
+    dispatchBarrierPacket(kNopPacketHeader, false);
+  } else if (scope == Device::CacheState::kCacheStateAgent) {
+    dispatchBarrierPacket(kBarrierPacketAgentScopeHeader, false);
+  } else {
+    dispatchBarrierPacket(kBarrierPacketHeader, false);
+    hasPendingDispatch_ = false;
+  }
+  // The caller can wait for the signal at any moment
+  flushDoorbell();
+  // The retained signal won't be reused for the next operations on the queue
+  ProfilingSignal* signal = Barriers().GetLastSignal();
+  signal->retain();
+  // No command tracks the barrier, hence the queue finish must submit a marker
+  Barriers().SetHandlerPending(true);
+  return signal;
+}
+
+// ================================================================================================
+bool VirtualGPU::waitHwTimestamp(void* hw_event) {
+  // Make sure VirtualGPU has an exclusive access to the resources
+  amd::ScopedLock lock(execution());
+  Barriers().AddExternalSignal(reinterpret_cast<ProfilingSignal*>(hw_event));
+  dispatchBarrierPacket(kBarrierPacketAcquireHeader, false);
+  return true;
+}
+
 // ================================================================================================
 void VirtualGPU::submitAcquireExtObjects(amd::AcquireExtObjectsCommand& vcmd) {
   // Make sure VirtualGPU has an exclusive access to the resources
@@ -3165,11 +4082,14 @@ void VirtualGPU::submitReleaseExtObjects(amd::ReleaseExtObjectsCommand& vcmd) {
   // Make sure VirtualGPU has an exclusive access to the resources
   amd::ScopedLock lock(execution());
   profilingBegin(vcmd);
+  // GL reads the memory after the release, hence the writes must reach the system scope
+  addSystemScope();
   profilingEnd(vcmd);
 }
 
 // ================================================================================================
 void VirtualGPU::flush(amd::Command* list, bool wait) {
+  flushDoorbell();
   // If barrier is requested, then wait for everything, otherwise
   // a per disaptch wait will occur later in updateCommandsState()
   releaseGpuMemoryFence();
@@ -3221,6 +4141,24 @@ void VirtualGPU::addPinnedMem(amd::Memory* mem) {
   }
 }
 
+// ================================================================================================
+void VirtualGPU::addDelayedView(amd::Memory* view) {
+  constexpr size_t kMaxDelayedViews = 16;
+  if (delayedViews_.size() >= kMaxDelayedViews) {
+    // Wait for the queue, which releases all delayed views
+    releaseGpuMemoryFence();
+  }
+  delayedViews_.push_back(view);
+}
+
+// ================================================================================================
+void VirtualGPU::releaseDelayedViews() {
+  for (auto& view : delayedViews_) {
+    view->release();
+  }
+  delayedViews_.clear();
+}
+
 // ================================================================================================
 void VirtualGPU::releasePinnedMem() {
   for (auto& amdMemory : pinnedMems_) {
@@ -3245,53 +4183,68 @@ void VirtualGPU::submitTransferBufferFromFile(amd::TransferBufferFileCommand& cm
   // Make sure VirtualGPU has an exclusive access to the resources
   amd::ScopedLock lock(execution());
 
-  size_t copySize = cmd.size()[0];
-  size_t fileOffset = cmd.fileOffset();
+  const size_t copySize = cmd.size()[0];
+  const size_t fileOffset = cmd.fileOffset();
+  const size_t memOffset = cmd.origin()[0];
   Memory* mem = dev().getRocMemory(&cmd.memory());
-  uint idx = 0;
+  const uint numStaging = cmd.numStaging();
+  const size_t chunkSize = amd::TransferBufferFileCommand::stagingSize();
+  const size_t numChunks = (copySize + chunkSize - 1) / chunkSize;
+  auto chunk = [&](size_t k) { return std::min(chunkSize, copySize - k * chunkSize); };
 
   assert((cmd.type() == CL_COMMAND_READ_SSG_FILE_AMD) ||
          (cmd.type() == CL_COMMAND_WRITE_SSG_FILE_AMD));
   const bool writeBuffer(cmd.type() == CL_COMMAND_READ_SSG_FILE_AMD);
 
   if (writeBuffer) {
-    size_t dstOffset = cmd.origin()[0];
-    while (copySize > 0) {
+    // Read the whole ring ahead, so the file I/O of the next chunks overlaps the DMA
+    for (uint i = 0; i < numStaging; ++i) {
+      Memory* staging = dev().getRocMemory(&cmd.staging(i));
+      cmd.startFileIo(i, staging->cpuMap(*this), fileOffset + i * chunkSize, chunk(i));
+    }
+    for (size_t k = 0; k < numChunks; ++k) {
+      // Refill the buffer of the previous chunk, the map waits for its DMA
+      if ((k > 0) && ((k - 1 + numStaging) < numChunks)) {
+        const size_t next = k - 1 + numStaging;
+        Memory* staging = dev().getRocMemory(&cmd.staging((k - 1) % numStaging));
+        cmd.startFileIo((k - 1) % numStaging, staging->cpuMap(*this),
+                        fileOffset + next * chunkSize, chunk(next));
+      }
+      const uint idx = k % numStaging;
       Memory* staging = dev().getRocMemory(&cmd.staging(idx));
-      size_t dstSize = amd::TransferBufferFileCommand::StagingBufferSize;
-      dstSize = std::min(dstSize, copySize);
-      void* dstBuffer = staging->cpuMap(*this);
-      if (!cmd.file()->transferBlock(writeBuffer, dstBuffer, staging->size(), fileOffset, 0,
-                                     dstSize)) {
+      if (!cmd.finishFileIo(idx)) {
+        cmd.finishFileIo();
         cmd.setStatus(CL_INVALID_OPERATION);
         return;
       }
       staging->cpuUnmap(*this);
 
-      bool result = blitMgr().copyBuffer(*staging, *mem, 0, dstOffset, dstSize, false);
-      fileOffset += dstSize;
-      dstOffset += dstSize;
-      copySize -= dstSize;
+      blitMgr().copyBuffer(*staging, *mem, 0, memOffset + k * chunkSize, chunk(k), false);
     }
   } else {
-    size_t srcOffset = cmd.origin()[0];
-    while (copySize > 0) {
+    for (size_t k = 0; k < numChunks; ++k) {
+      const uint idx = k % numStaging;
       Memory* staging = dev().getRocMemory(&cmd.staging(idx));
-      size_t srcSize = amd::TransferBufferFileCommand::StagingBufferSize;
-      srcSize = std::min(srcSize, copySize);
-      bool result = blitMgr().copyBuffer(*mem, *staging, srcOffset, 0, srcSize, false);
-
-      void* srcBuffer = staging->cpuMap(*this);
-      if (!cmd.file()->transferBlock(writeBuffer, srcBuffer, staging->size(), fileOffset, 0,
-                                     srcSize)) {
-        cmd.setStatus(CL_INVALID_OPERATION);
-        return;
+      // The staging buffer is free after the write of its previous chunk
+      if (k >= numStaging) {
+        if (!cmd.finishFileIo(idx)) {
+          cmd.finishFileIo();
+          cmd.setStatus(CL_INVALID_OPERATION);
+          return;
+        }
+        staging->cpuUnmap(*this);
       }
-      staging->cpuUnmap(*this);
+      blitMgr().copyBuffer(*mem, *staging, memOffset + k * chunkSize, 0, chunk(k), false);
 
-      fileOffset += srcSize;
-      srcOffset += srcSize;
-      copySize -= srcSize;
+      // The map waits for the DMA, then the write runs along with the next chunks
+      cmd.startFileIo(idx, staging->cpuMap(*this), fileOffset + k * chunkSize, chunk(k));
+    }
+    const bool result = cmd.finishFileIo();
+    for (uint i = 0; i < numStaging; ++i) {
+      dev().getRocMemory(&cmd.staging(i))->cpuUnmap(*this);
+    }
+    if (!result) {
+      cmd.setStatus(CL_INVALID_OPERATION);
     }
   }
 }
@@ -24,18 +24,24 @@
 #include "rocdefs.hpp"
 #include "rocdevice.hpp"
 #include "utils/util.hpp"
+#include "device/devmemranges.hpp"
 #include "hsa.h"
 #include "hsa_ext_image.h"
 #include "hsa_ext_amd.h"
 #include "rocprintf.hpp"
 #include "hsa_ven_amd_aqlprofile.h"
 #include "rocsched.hpp"
+#include <atomic>
+#include <deque>
 
 namespace roc {
 class Device;
 class Memory;
 struct ProfilingSignal;
 class Timestamp;
+class PerfCounter;
+class PerfCounterProfile;
+struct HwQueueStats;
 
 // Initial HSA signal value
 constexpr static hsa_signal_value_t kInitSignalValueOne = 1;
@@ -81,6 +87,69 @@ inline bool WaitForSignal(hsa_signal_t signal, bool active_wait = false) {
   return true;
 }
 
+// Waits for the signal with the strategy of the device scheduling mode
+inline bool WaitForSignalMode(hsa_signal_t signal, amd::Device::WaitMode mode) {
+  switch (mode) {
+    case amd::Device::WaitBlocking:
+      if (hsa_signal_load_relaxed(signal) > 0) {
+        ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Host blocked wait for Signal = (0x%lx)",
+                signal.handle);
+        // Suspend the thread until the completion interrupt, so the CPU is free for other work
+        if (hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne,
+                                      kUnlimitedWait, HSA_WAIT_STATE_BLOCKED) != 0) {
+          return false;
+        }
+      }
+      return true;
+    case amd::Device::WaitYield:
+      while (hsa_signal_load_scacquire(signal) > 0) {
+        amd::Os::yield();
+      }
+      return true;
+    default:
+      return WaitForSignal(signal, mode == amd::Device::WaitSpin);
+  }
+}
+
+// Expected wait limits for the adaptive wait policy
+constexpr static uint64_t kAdaptiveBusyWait = 20 * K;
+constexpr static uint64_t kAdaptiveTimedWait = K * K;
+constexpr static uint64_t kAdaptiveMinBusyWait = 5 * K;
+
+//! Waits for the signal with the mode, chosen by the expected wait time. A short wait polls the
+//! signal, a medium wait sleeps through most of the expected time and polls the rest, a long wait
+//! waits for the interrupt. The expected time is updated with the measured wait time
+inline bool WaitForSignalAdaptive(hsa_signal_t signal, uint64_t* expected) {
+  if (hsa_signal_load_relaxed(signal) <= 0) {
+    return true;
+  }
+  const uint64_t start = amd::Os::timeNanos();
+  bool done = false;
+  if (*expected <= kAdaptiveBusyWait) {
+    uint64_t timeout = std::max(2 * (*expected), kAdaptiveMinBusyWait);
+    done = (hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne,
+                                      timeout, HSA_WAIT_STATE_ACTIVE) < kInitSignalValueOne);
+  } else if (*expected <= kAdaptiveTimedWait) {
+    done = (hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne,
+                                      (*expected * 3) / 4, HSA_WAIT_STATE_BLOCKED) <
+            kInitSignalValueOne);
+    if (!done) {
+      done = (hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne,
+                                        *expected / 2, HSA_WAIT_STATE_ACTIVE) <
+              kInitSignalValueOne);
+    }
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_SIG, "Host adaptive wait for Signal = (0x%lx), expected %ld ns",
+          signal.handle, *expected);
+  if (!done && (hsa_signal_wait_scacquire(signal, HSA_SIGNAL_CONDITION_LT, kInitSignalValueOne,
+                                          kUnlimitedWait, HSA_WAIT_STATE_BLOCKED) != 0)) {
+    return false;
+  }
+  // Moving average of the measured wait times
+  *expected = (*expected * 3 + (amd::Os::timeNanos() - start)) / 4;
+  return true;
+}
+
 inline void fetchSignalTime(hsa_signal_t signal, hsa_agent_t gpu_device,
                             uint64_t* start, uint64_t* end) {
   if (start != nullptr && end != nullptr) {
@@ -105,6 +174,7 @@ class Timestamp : public amd::ReferenceCountedObject {
   std::vector<ProfilingSignal*> signals_; //!< The list of all signals, associated with the TS
   hsa_signal_t callback_signal_;  //!< Signal associated with a callback for possible later update
   amd::Monitor  lock_;            //!< Serialize timestamp update
+  uint64_t    submitTime_;        //!< Host time of the submission, 0 without the stats
 
   Timestamp(const Timestamp&) = delete;
   Timestamp& operator=(const Timestamp&) = delete;
@@ -117,7 +187,8 @@ class Timestamp : public amd::ReferenceCountedObject {
     , command_(command)
     , parsedCommand_(nullptr)
     , callback_signal_(hsa_signal_t{})
-    , lock_("Timestamp lock", true) {}
+    , lock_("Timestamp lock", true)
+    , submitTime_(amd::LatencyStats::start()) {}
 
   ~Timestamp() {}
 
@@ -178,16 +249,13 @@ class VirtualGPU : public device::VirtualDevice {
   class MemoryDependency : public amd::EmbeddedObject {
    public:
     //! Default constructor
-    MemoryDependency()
-        : memObjectsInQueue_(nullptr), numMemObjectsInQueue_(0), maxMemObjectsInQueue_(0) {}
-
-    ~MemoryDependency() { delete[] memObjectsInQueue_; }
+    MemoryDependency() : maxMemObjectsInQueue_(0) {}
 
     //! Creates memory dependecy structure
     bool create(size_t numMemObj);
 
     //! Notify the tracker about new kernel
-    void newKernel() { endMemObjectsInQueue_ = numMemObjectsInQueue_; }
+    void newKernel();
 
     //! Validates memory object on dependency
     void validate(VirtualGPU& gpu, const Memory* memory, bool readOnly);
@@ -205,15 +273,15 @@ class VirtualGPU : public device::VirtualDevice {
       bool readOnly_;   //! Current GPU state in the queue
     };
 
-    MemoryState* memObjectsInQueue_;  //!< Memory object state in the queue
-    size_t endMemObjectsInQueue_;     //!< End of mem objects in the queue
-    size_t numMemObjectsInQueue_;     //!< Number of mem objects in the queue
-    size_t maxMemObjectsInQueue_;     //!< Maximum number of mem objects in the queue
+    device::MemoryRanges busyRanges_;         //!< Busy ranges of the previous kernels
+    std::vector<MemoryState> kernelObjects_;  //!< Memory objects of the current kernel
+    size_t maxMemObjectsInQueue_;             //!< Maximum number of busy ranges in the queue
   };
 
   class HwQueueTracker : public amd::EmbeddedObject {
    public:
-    HwQueueTracker(const VirtualGPU& gpu): gpu_(gpu), handlerPending_(false) {}
+    HwQueueTracker(const VirtualGPU& gpu)
+      : gpu_(gpu), handlerPending_(false), reaper_lock_("Completion reaper lock") {}
 
     ~HwQueueTracker();
 
@@ -255,12 +323,39 @@ class VirtualGPU : public device::VirtualDevice {
     //! Empty check for external signals
     bool IsExternalSignalListEmpty() const { return external_signals_.empty(); }
 
+    //! Returns TRUE if \a signal is the only external signal
+    bool IsOnlyExternalSignal(const ProfilingSignal* signal) const {
+      return (external_signals_.size() == 1) && (external_signals_[0] == signal);
+    }
+
     //! Set the status to indicate a pending handler
     void SetHandlerPending(bool pending) { handlerPending_ = pending; }
 
     //! Check if callback has been queued
     bool IsHandlerPending() const { return handlerPending_; }
+
+    //! Retires all completed markers, queued for the batched completion
+    void ReapCompletions();
+
+    //! Waits until all markers for the batched completion are retired
+    void DrainCompletions();
+
   private:
+    //! A marker, which updates its batch upon the signal completion
+    struct PendingMarker {
+      Timestamp* ts_;             //!< Timestamp of the marker
+      ProfilingSignal* signal_;   //!< Completion signal of the marker
+    };
+
+    //! Queues the marker for the batched completion instead of a handler per marker
+    void QueueCompletion(Timestamp* ts, ProfilingSignal* signal);
+
+    //! Sets the HSA handler on the oldest pending marker. Requires reaper_lock_
+    void ArmCompletionHandler();
+
+    //! HSA handler of the batched completion
+    static bool CompletionHandler(hsa_signal_value_t value, void* arg);
+
     //! Wait for the next active signal
     void WaitNext() {
       size_t next = (current_id_ + 1) % signal_list_.size();
@@ -272,6 +367,7 @@ class VirtualGPU : public device::VirtualDevice {
     bool CpuWaitForSignal(ProfilingSignal* signal);
 
     HwQueueEngine engine_ = HwQueueEngine::Unknown; //!< Engine used in the current operations
+    uint64_t expected_wait_ = kAdaptiveBusyWait;    //!< Expected wait time for the adaptive wait
     std::vector<ProfilingSignal*> signal_list_;     //!< The pool of all signals for processing
     size_t current_id_ = 0;       //!< Last submitted signal
     bool sdma_profiling_ = false; //!< If TRUE, then SDMA profiling is enabled
@@ -279,6 +375,10 @@ class VirtualGPU : public device::VirtualDevice {
     std::vector<ProfilingSignal*> external_signals_;  //!< External signals for a wait in this queue
     std::vector<hsa_signal_t> waiting_signals_;   //!< Current waiting signals in this queue
     bool handlerPending_;         //!< This indicates if we have queued a callback handler
+
+    amd::Monitor reaper_lock_;                    //!< Lock for the pending markers
+    std::deque<PendingMarker> pending_markers_;   //!< Markers in the submission order
+    ProfilingSignal* armed_signal_ = nullptr;     //!< The signal with the HSA handler
   };
 
   VirtualGPU(Device& device, bool profiling = false, bool cooperative = false,
@@ -297,6 +397,7 @@ class VirtualGPU : public device::VirtualDevice {
   void submitReadMemory(amd::ReadMemoryCommand& cmd);
   void submitWriteMemory(amd::WriteMemoryCommand& cmd);
   void submitCopyMemory(amd::CopyMemoryCommand& cmd);
+  void submitCopyMemoryBatch(amd::CopyMemoryBatchCommand& cmd);
   void submitCopyMemoryP2P(amd::CopyMemoryP2PCommand& cmd);
   void submitMapMemory(amd::MapMemoryCommand& cmd);
   void submitUnmapMemory(amd::UnmapMemoryCommand& cmd);
@@ -308,6 +409,8 @@ class VirtualGPU : public device::VirtualDevice {
                             uint32_t sharedMemBytes = 0, //!< Shared memory size
                             amd::NDRangeKernelCommand* vcmd = nullptr //!< Original launch command
                             );
+  //! Returns true if the kernel of an out-of-order queue can overlap the earlier packets
+  bool isOutOfOrderLaunch(const amd::Command& command);
   void submitNativeFn(amd::NativeFnCommand& cmd);
   void submitMarker(amd::Marker& cmd);
 
@@ -340,10 +443,24 @@ class VirtualGPU : public device::VirtualDevice {
   void submitThreadTraceMemObjects(amd::ThreadTraceMemObjectsCommand& cmd) {}
   void submitThreadTrace(amd::ThreadTraceCommand& vcmd) {}
 
-  virtual void submitExternalSemaphoreCmd(amd::ExternalSemaphoreCmd& cmd){}
+  void submitExternalSemaphoreCmd(amd::ExternalSemaphoreCmd& cmd);
+
+  virtual void submitAccumulate(amd::AccumulateCommand& cmd);
+  virtual bool packetCaptureSupported() const { return true; }
 
   virtual address allocKernelArguments(size_t size, size_t alignment) final;
 
+  void setBatchSubmission(bool enable) final {
+    if (!enable) {
+      flushDoorbell();
+    }
+    doorbell_batch_ = enable && (ROC_DOORBELL_BATCH_SIZE != 0);
+  }
+
+  void* recordTimestamp(int32_t scope) final;
+
+  bool waitHwTimestamp(void* hw_event) final;
+
   /**
    * @brief Waits on an outstanding kernel without regard to how
    * it was dispatched - with or without a signal
@@ -361,6 +478,11 @@ class VirtualGPU : public device::VirtualDevice {
   //! Returns memory dependency class
   MemoryDependency& memoryDependency() { return memoryDependency_; }
 
+  //! Adds a memory object, which the next dispatch accesses outside of the kernel arguments
+  void addIndirectMemObject(const Memory* memory, bool readOnly) {
+    indirectMemObjects_.push_back({memory, readOnly});
+  }
+
   //! Detects memory dependency for HSAIL kernels and uses appropriate AQL header
   bool processMemObjects(const amd::Kernel& kernel,  //!< AMD kernel object for execution
                          const_address params,       //!< Pointer to the param's store
@@ -382,6 +504,12 @@ class VirtualGPU : public device::VirtualDevice {
   //! Release pinned memory objects
   void releasePinnedMem();
 
+  //! Delays the release of a blit view, until the queue is idle and the GPU can't access the SRD
+  void addDelayedView(amd::Memory* view);
+
+  //! Releases the delayed blit views
+  void releaseDelayedViews();
+
   //! Finds if pinned memory is cached
   amd::Memory* findPinnedMem(void* addr, size_t size);
 
@@ -396,6 +524,9 @@ class VirtualGPU : public device::VirtualDevice {
 
   Timestamp* timestamp() const { return timestamp_; }
 
+  //! Returns the stats of the HW queue, nullptr if ROC_LATENCY_STATS is disabled
+  HwQueueStats* hwQueueStats() const { return hwQueueStats_; }
+
   void profilerAttach(bool enable = false) { profilerAttached_ = enable; }
 
   bool isProfilerAttached() const { return profilerAttached_; }
@@ -403,6 +534,13 @@ class VirtualGPU : public device::VirtualDevice {
   //! Indicates the status of the callback handler. The callback would process the commands
   //! and would collect profiling data, update refcounts
   bool isHandlerPending() const { return barriers_.IsHandlerPending(); }
+
+  //! The wait list signals become barrier-AND dependencies in the AQL queue
+  bool canWaitHwEvent() const final { return true; }
+
+  QueueState queryState() const final;
+
+  uint64_t hwQueueId() const final { return gpu_queue_->id; }
   // } roc OpenCL integration
  private:
   //! Dispatches a barrier with blocking HSA signals
@@ -415,6 +553,8 @@ class VirtualGPU : public device::VirtualDevice {
   template <typename AqlPacket> bool dispatchGenericAqlPacket(AqlPacket* packet, uint16_t header,
                                                               uint16_t rest, bool blocking,
                                                               size_t size = 1);
+  //! Copies a block of prebuilt AQL packets into the queue with a single doorbell update
+  bool dispatchAqlPacketBatch(const hsa_kernel_dispatch_packet_t* packets, size_t count);
   void dispatchBarrierPacket(uint16_t packetHeader, bool skipSignal = false,
                              hsa_signal_t signal = hsa_signal_t{0});
   bool dispatchCounterAqlPacket(hsa_ext_amd_aql_pm4_packet_t* packet, const uint32_t gfxVersion,
@@ -424,16 +564,63 @@ class VirtualGPU : public device::VirtualDevice {
   void initializeDispatchPacket(hsa_kernel_dispatch_packet_t* packet,
                                 amd::NDRangeContainer& sizes);
 
+  //! Reads ahead the next chunks of a sequential prefetch stream, without a wait
+  void prefetchAhead(const amd::SvmPrefetchAsyncCommand& cmd, hsa_agent_t agent);
+
+  //! Copies the pages of an SVM map, which were written under ROC_SVM_MAP_WRITE_WATCH.
+  //! Returns false if the map wasn't watched
+  bool copySvmWrittenPages(Memory& memory, Memory& hsaMapMemory, void* svmPtr,
+                           const device::Memory::WriteMapInfo& writeMapInfo);
+
   bool initPool(size_t kernarg_pool_size);
   void destroyPool();
 
+  //! Waits until the slot \a index is free and records the occupancy of the HW queue
+  void waitFreeSlot(uint64_t index, uint64_t read, uint64_t swQueueSize);
+
+  //! Starts the counter sample before a dispatch of \a kernel, returns false if it's not sampled
+  bool counterSampleBegin(const std::string& kernel);
+  //! Stops the counter sample after the dispatch
+  void counterSampleEnd();
+  //! Adds the finished sample to the device stats, returns false if it's still in flight
+  bool counterSampleCollect();
+  //! Creates the profile of the counter set in ROC_COUNTER_SAMPLE_EVENTS
+  bool createCounterSampling();
+  void destroyCounterSampling();
+
+  //! Periodic sampling of the HW counters for the kernel dispatches
+  struct CounterSampling {
+    PerfCounterProfile* profile_ = nullptr;  //!< Profile with the start and stop packets
+    std::vector<PerfCounter*> counters_;     //!< The sampled counter set
+    std::string kernel_;                     //!< Kernel name of the pending sample
+    uint64_t dispatches_ = 0;                //!< Kernel dispatches on this queue
+    bool pending_ = false;                   //!< The sample isn't collected yet
+    bool disabled_ = false;                  //!< The counter set isn't available
+  } counterSampling_;
+
   void* allocKernArg(size_t size, size_t alignment);
   void resetKernArgPool() {
     kernarg_pool_cur_offset_ = 0;
-    kernarg_pool_chunk_end_ = kernarg_pool_size_ / KernelArgPoolNumSignal;
-    active_chunk_ = 0;
+    kernarg_pool_tail_ = 0;
+    kernarg_pool_dispatch_offset_ = 0;
+    kernarg_pool_marks_.clear();
   }
 
+  //! Writes the AQL queue doorbell, unless the batched submission defers it
+  void ringDoorbell(uint64_t index);
+
+  //! Writes the doorbell for the deferred AQL packets
+  void flushDoorbell() const;
+
+  //! Saves the completion signal of the AQL packet at \a index for queryState()
+  void trackLastPacket(uint64_t index) const;
+
+  //! Returns the kernel arg ring space, retired by the processed AQL packets
+  void reclaimKernArg();
+
+  //! Records the AQL packet, which retires the kernel args of all earlier packets
+  void markKernArg(uint64_t index, uint16_t header, const void* kernarg = nullptr);
+
   uint64_t getVQVirtualAddress();
 
   bool createSchedulerParam();
@@ -467,11 +654,18 @@ class VirtualGPU : public device::VirtualDevice {
   //! Updates AQL header for the upcomming dispatch
   void setAqlHeader(uint16_t header) { aqlHeader_ = header; }
 
+  //! Returns TRUE if the kernel's private segment is above ROC_SCRATCH_QUEUE_THRESHOLD
+  bool isScratchHeavy(const amd::Kernel& kernel) const;
+
+  //! Submits a kernel on another queue, i.e. a cooperative launch on the device queue
+  void submitKernelOnQueue(amd::NDRangeKernelCommand& vcmd, VirtualGPU* queue);
+
   //! Resets the current queue state. Note: should be called after AQL queue becomes idle
   void ResetQueueStates();
 
   std::vector<Memory*> xferWriteBuffers_;  //!< Stage write buffers
   std::vector<amd::Memory*> pinnedMems_;   //!< Pinned memory list
+  std::vector<amd::Memory*> delayedViews_; //!< Blit views, released after the queue is idle
 
   //! Queue state flags
   union {
@@ -490,6 +684,7 @@ class VirtualGPU : public device::VirtualDevice {
   Timestamp* timestamp_;
   hsa_agent_t gpu_device_;  //!< Physical device
   hsa_queue_t* gpu_queue_;  //!< Queue associated with a gpu
+  HwQueueStats* hwQueueStats_ = nullptr;  //!< Submission stats of gpu_queue_
   hsa_barrier_and_packet_t barrier_packet_;
 
   uint32_t dispatch_id_;  //!< This variable must be updated atomically.
@@ -507,18 +702,43 @@ class VirtualGPU : public device::VirtualDevice {
   hsa_queue_t* schedulerQueue_;
   hsa_signal_t schedulerSignal_;
 
+  //! The last prefetch ranges, used for the detection of sequential streams
+  struct PrefetchStream {
+    address       next_ = nullptr;   //!< The address after the last prefetched range
+    address       ahead_ = nullptr;  //!< The address after the last read-ahead range
+    hsa_agent_t   agent_ = {0};      //!< The target agent of the last prefetch
+  } prefetchStream_;
+  hsa_signal_t prefetchAheadSignal_;  //!< Completion of the last read-ahead prefetch
+
+  //! Memory objects, accessed by the next dispatch through a descriptor table
+  std::vector<std::pair<const Memory*, bool>> indirectMemObjects_;
+
   HwQueueTracker  barriers_;      //!< Tracks active barriers in ROCr
 
-  //!< The number of chunks the kernel arg pool will be divided
-  static constexpr uint32_t KernelArgPoolNumSignal = 8;
+  //! AQL packet with the barrier bit. Once the packet processor reads it, all earlier packets
+  //! are complete and their kernel args, allocated before offset_, can be reused
+  struct KernArgMark {
+    uint64_t  index_;   //!< AQL queue index of the barrier packet
+    uint32_t  offset_;  //!< Ring offset, which becomes the tail after the packet is processed
+  };
+  static constexpr size_t kKernArgCacheLine = 64;  //!< Cacheline size for kernel args placement
   address   kernarg_pool_base_;
   uint32_t  kernarg_pool_size_;
-  uint32_t  kernarg_pool_chunk_end_;    //!< The end offset of the current chunck
-  uint32_t  active_chunk_;              //!< The index of the current active chunk
-  uint32_t  kernarg_pool_cur_offset_;
-  std::vector<hsa_signal_t> kernarg_pool_signal_; //!< Pool of HSA signals to manage multiple chunks
+  uint32_t  kernarg_pool_cur_offset_;       //!< The head of the kernel arg ring
+  uint32_t  kernarg_pool_tail_;             //!< The oldest offset, still in use by the GPU
+  uint32_t  kernarg_pool_dispatch_offset_;  //!< The head at the last dispatch with kernel args
+  std::deque<KernArgMark> kernarg_pool_marks_;  //!< Pending retire points in the queue order
+
+  bool doorbell_batch_ = false;               //!< Doorbell writes are deferred in a batch
+  mutable uint32_t doorbell_pending_ = 0;     //!< The number of deferred doorbell writes
+  mutable uint64_t doorbell_index_ = 0;       //!< The last deferred AQL packet index
+  mutable uint64_t doorbell_start_ = 0;       //!< Time in ns of the first deferred write
+
+  //! Signal handle of the last submission, 0 if it has no signal or isn't visible to the HW yet
+  mutable std::atomic<uint64_t> lastSignal_{0};
 
   friend class Timestamp;
+  friend class PrintfDbg;
 
   //  PM4 packet for gfx8 performance counter
   enum {
@@ -529,6 +749,11 @@ class VirtualGPU : public device::VirtualDevice {
   uint16_t dispatchPacketHeaderNoSync_;
   uint16_t dispatchPacketHeader_;
 
+  uint32_t gwsWorkgroups_ = 0;             //!< GWS barrier size of the last cooperative launch
+  VirtualGPU* hopQueue_ = nullptr;        //!< The queue of the last launch on another queue
+  ProfilingSignal* hopSignal_ = nullptr;  //!< Signal of hopQueue_ after the last launch
+  uint64_t hopWriteIndex_ = 0;            //!< AQL write index after the last launch on hopQueue_
+
   //!< bit-vector representing the CU mask. Each active bit represents using one CU
   const std::vector<uint32_t> cuMask_;
   amd::CommandQueue::Priority priority_; //!< The priority for the hsa queue
@@ -165,6 +165,222 @@ namespace {
   };
 }
 
+///////////////////////////////////////////////////////////////
+///////////////////////// elf view ////////////////////////////
+///////////////////////////////////////////////////////////////
+
+ElfView::ElfView(const char* image, uint64_t size)
+: image_(image),
+  size_(size)
+{
+  if ((image_ == nullptr) || (size_ < EI_NIDENT) || (::memcmp(image_, ELFMAG, SELFMAG) != 0)) {
+    return;
+  }
+  if (image_[EI_CLASS] == ELFCLASS64) {
+    valid_ = init<Elf64_Ehdr, Elf64_Shdr, Elf64_Phdr>();
+  } else if (image_[EI_CLASS] == ELFCLASS32) {
+    valid_ = init<Elf32_Ehdr, Elf32_Shdr, Elf32_Phdr>();
+  }
+  if (!valid_) {
+    sections_.clear();
+    segments_.clear();
+  }
+}
+
+template <typename Ehdr, typename Shdr, typename Phdr>
+bool ElfView::init()
+{
+  Ehdr ehdr;
+  if (!read(0, &ehdr)) {
+    return false;
+  }
+  eclass_ = ehdr.e_ident[EI_CLASS];
+  machine_ = ehdr.e_machine;
+  type_ = ehdr.e_type;
+  flags_ = ehdr.e_flags;
+
+  if (ehdr.e_shnum != 0) {
+    if ((ehdr.e_shentsize != sizeof(Shdr)) || (ehdr.e_shstrndx >= ehdr.e_shnum)) {
+      return false;
+    }
+    // Only the headers are parsed, the names are resolved after .shstrtab is known
+    std::vector<uint32_t> nameOffsets(ehdr.e_shnum);
+    sections_.resize(ehdr.e_shnum);
+    for (uint32_t i = 0; i < ehdr.e_shnum; ++i) {
+      Shdr shdr;
+      if (!read(ehdr.e_shoff + static_cast<uint64_t>(i) * sizeof(Shdr), &shdr)) {
+        return false;
+      }
+      Section& sec = sections_[i];
+      sec.name_ = nullptr;
+      sec.data_ = nullptr;
+      sec.size_ = shdr.sh_size;
+      sec.addr_ = shdr.sh_addr;
+      sec.type_ = shdr.sh_type;
+      sec.link_ = shdr.sh_link;
+      sec.entSize_ = shdr.sh_entsize;
+      if ((sec.type_ != SHT_NOBITS) && (sec.type_ != SHT_NULL)) {
+        if (!inImage(shdr.sh_offset, shdr.sh_size)) {
+          return false;
+        }
+        sec.data_ = image_ + shdr.sh_offset;
+      }
+      nameOffsets[i] = shdr.sh_name;
+      if ((sec.type_ == SHT_SYMTAB) && (symtab_ == SHN_UNDEF)) {
+        symtab_ = i;
+      }
+    }
+    shstrtab_ = ehdr.e_shstrndx;
+    for (uint32_t i = 0; i < ehdr.e_shnum; ++i) {
+      sections_[i].name_ = string(sections_[shstrtab_], nameOffsets[i]);
+      if (sections_[i].name_ == nullptr) {
+        return false;
+      }
+    }
+    if ((symtab_ != SHN_UNDEF) && (sections_[symtab_].link_ >= ehdr.e_shnum)) {
+      return false;
+    }
+  }
+
+  if (ehdr.e_phnum != 0) {
+    if (ehdr.e_phentsize != sizeof(Phdr)) {
+      return false;
+    }
+    segments_.resize(ehdr.e_phnum);
+    for (uint32_t i = 0; i < ehdr.e_phnum; ++i) {
+      Phdr phdr;
+      if (!read(ehdr.e_phoff + static_cast<uint64_t>(i) * sizeof(Phdr), &phdr)) {
+        return false;
+      }
+      Segment& seg = segments_[i];
+      seg.type_ = phdr.p_type;
+      seg.flags_ = phdr.p_flags;
+      seg.offset_ = phdr.p_offset;
+      seg.vaddr_ = phdr.p_vaddr;
+      seg.fileSize_ = phdr.p_filesz;
+      seg.memSize_ = phdr.p_memsz;
+    }
+  }
+  return true;
+}
+
+const char* ElfView::string(const Section& strtab, uint64_t offset) const
+{
+  if ((strtab.data_ == nullptr) || (offset >= strtab.size_)) {
+    return nullptr;
+  }
+  const char* str = strtab.data_ + offset;
+  // The string must be terminated inside of the section
+  if (::memchr(str, '\0', strtab.size_ - offset) == nullptr) {
+    return nullptr;
+  }
+  return str;
+}
+
+const ElfView::Section* ElfView::section(const char* name) const
+{
+  for (const auto& sec : sections_) {
+    if (::strcmp(sec.name_, name) == 0) {
+      return &sec;
+    }
+  }
+  return nullptr;
+}
+
+uint32_t ElfView::symbolNum() const
+{
+  if (symtab_ == SHN_UNDEF) {
+    return 0;
+  }
+  const uint64_t entSize = (eclass_ == ELFCLASS64) ? sizeof(Elf64_Sym) : sizeof(Elf32_Sym);
+  const uint64_t num = sections_[symtab_].size_ / entSize;
+  // Exclude the first dummy symbol
+  return (num > 0) ? static_cast<uint32_t>(num - 1) : 0;
+}
+
+template <typename Sym>
+bool ElfView::readSymbol(uint32_t index, Symbol* sym) const
+{
+  const Section& symtab = sections_[symtab_];
+  // index + 1 for real index on top of the first dummy symbol
+  const uint64_t offset = (static_cast<uint64_t>(index) + 1) * sizeof(Sym);
+  if ((symtab.data_ == nullptr) || (offset + sizeof(Sym) > symtab.size_)) {
+    return false;
+  }
+  Sym entry;
+  ::memcpy(&entry, symtab.data_ + offset, sizeof(Sym));
+
+  sym->name_ = string(sections_[symtab.link_], entry.st_name);
+  if (sym->name_ == nullptr) {
+    return false;
+  }
+  sym->value_ = entry.st_value;
+  sym->size_ = entry.st_size;
+  sym->sectionIndex_ = entry.st_shndx;
+  sym->section_ = ((entry.st_shndx != SHN_UNDEF) && (entry.st_shndx < SHN_LORESERVE))
+      ? section(entry.st_shndx) : nullptr;
+  sym->type_ = ELF_ST_TYPE(entry.st_info);
+  sym->bind_ = ELF_ST_BIND(entry.st_info);
+  return true;
+}
+
+bool ElfView::symbol(uint32_t index, Symbol* sym) const
+{
+  if ((symtab_ == SHN_UNDEF) || (sym == nullptr)) {
+    return false;
+  }
+  return (eclass_ == ELFCLASS64) ? readSymbol<Elf64_Sym>(index, sym)
+                                 : readSymbol<Elf32_Sym>(index, sym);
+}
+
+bool ElfView::findSymbol(const char* sectionName, const char* symbolName, Symbol* sym) const
+{
+  const uint32_t num = symbolNum();
+  for (uint32_t i = 0; i < num; ++i) {
+    if (symbol(i, sym) && (sym->section_ != nullptr) &&
+        (::strcmp(sym->name_, symbolName) == 0) &&
+        (::strcmp(sym->section_->name_, sectionName) == 0)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ElfView::findNote(const char* noteName, const char** noteDesc, size_t* descSize,
+                       uint32_t* noteType) const
+{
+  // The entries are 4 bytes aligned in both ELF classes, the same as ELFIO
+  constexpr uint64_t align = sizeof(Elf_Word);
+  const size_t nameSize = ::strlen(noteName) + 1;
+  for (const auto& sec : sections_) {
+    if ((sec.type_ != SHT_NOTE) || (sec.data_ == nullptr)) {
+      continue;
+    }
+    uint64_t current = 0;
+    while (current + sizeof(Elf::ElfNote) <= sec.size_) {
+      Elf::ElfNote note;
+      ::memcpy(&note, sec.data_ + current, sizeof(note));
+      const uint64_t nameOffset = current + sizeof(note);
+      const uint64_t descOffset = nameOffset + alignUp<uint64_t>(note.n_namesz, align);
+      const uint64_t next = descOffset + alignUp<uint64_t>(note.n_descsz, align);
+      if ((next > sec.size_) || (descOffset + note.n_descsz > sec.size_)) {
+        break;
+      }
+      if ((note.n_namesz == nameSize) &&
+          (::memcmp(sec.data_ + nameOffset, noteName, nameSize) == 0)) {
+        *noteDesc = sec.data_ + descOffset;
+        *descSize = note.n_descsz;
+        if (noteType != nullptr) {
+          *noteType = note.n_type;
+        }
+        return true;
+      }
+      current = next;
+    }
+  }
+  return false;
+}
+
 ///////////////////////////////////////////////////////////////
 ////////////////////// elf initializers ///////////////////////
 ///////////////////////////////////////////////////////////////
@@ -181,6 +397,7 @@ Elf::Elf (
   _rawElfBytes (rawElfBytes),
   _rawElfSize (rawElfSize),
   _elfCmd (elfcmd),
+  _elfioLoaded (false),
   _elfMemory(),
   _shstrtab_ndx (SHN_UNDEF),
   _strtab_ndx (SHN_UNDEF),
@@ -215,6 +432,7 @@ bool Elf::Clear()
   ElfTrace(amd::LOG_INFO);
 
   _elfio.clean();
+  _elfioLoaded = false;
   elfMemoryRelease();
 
   // Re-initialize the object
@@ -240,12 +458,11 @@ bool Elf::Init()
         logElfError("failed: _rawElfBytes = nullptr or _rawElfSize = 0");
         return false;
       }
-      {
-        std::istringstream is { std::string(_rawElfBytes, _rawElfSize) };
-        if (!_elfio.load(is)) {
-          LogElfError("failed in _elfio.load(%p, %lu)", _rawElfBytes, _rawElfSize);
-          return false;
-        }
+      // Only the headers are parsed, the sections stay in the raw bytes
+      _view = ElfView(_rawElfBytes, _rawElfSize);
+      if (!_view.isValid()) {
+        LogElfError("failed in ElfView(%p, %lu)", _rawElfBytes, _rawElfSize);
+        return false;
       }
       break;
 
@@ -267,30 +484,26 @@ bool Elf::Init()
 bool Elf::InitElf ()
 {
   if (_elfCmd == ELF_C_READ) {
-    assert(_elfio.sections.size() > 0 && "elfio object should have been created already");
+    assert(_view.isValid() && "ELF view should have been created already");
 
     // Set up _shstrtab_ndx
-    _shstrtab_ndx = _elfio.get_section_name_str_index();
+    _shstrtab_ndx = _view.shstrtabIndex();
     if(_shstrtab_ndx == SHN_UNDEF) {
       logElfError("failed: _shstrtab_ndx = SHN_UNDEF");
       return false;
     }
 
     // Set up _strtab_ndx
-    section* strtab_sec = _elfio.sections[ElfSecDesc[STRTAB].name];
+    const ElfView::Section* strtab_sec = _view.section(ElfSecDesc[STRTAB].name);
     if (strtab_sec == nullptr) {
       logElfError("failed: null sections(STRTAB)");
       return false;
     }
 
-    _strtab_ndx = strtab_sec->get_index();
-
-    section* symtab_sec = _elfio.sections[ElfSecDesc[SYMTAB].name];
+    _strtab_ndx = static_cast<Elf64_Word>(strtab_sec - _view.section(0u));
 
-    if (symtab_sec != nullptr) {
-      _symtab_ndx = symtab_sec->get_index();
-    }
     // It's ok for empty SYMTAB
+    _symtab_ndx = _view.symtabIndex();
   } else if(_elfCmd == ELF_C_WRITE) {
     /*********************************/
     /******** ELF_C_WRITE ************/
@@ -425,7 +638,7 @@ bool Elf::setupShdr (
 
 bool Elf::getTarget(uint16_t& machine, ElfPlatform& platform) const
 {
-  Elf64_Half mach = _elfio.get_machine();
+  Elf64_Half mach = isReader() ? _view.machine() : _elfio.get_machine();
   if ((mach >= CPU_FIRST) && (mach <= CPU_LAST)) {
     platform = CPU_PLATFORM;
     machine = mach - CPU_BASE;
@@ -447,6 +660,20 @@ bool Elf::getTarget(uint16_t& machine, ElfPlatform& platform) const
   return true;
 }
 
+bool Elf::loadElfio() const
+{
+  if (_elfioLoaded) {
+    return true;
+  }
+  std::istringstream is { std::string(_rawElfBytes, _rawElfSize) };
+  if (!_elfio.load(is)) {
+    LogElfError("failed in _elfio.load(%p, %lu)", _rawElfBytes, _rawElfSize);
+    return false;
+  }
+  _elfioLoaded = true;
+  return true;
+}
+
 bool Elf::setTarget(uint16_t machine, ElfPlatform platform)
 {
   Elf64_Half mach;
@@ -464,7 +691,7 @@ bool Elf::setTarget(uint16_t machine, ElfPlatform platform)
 }
 
 bool Elf::getType(uint16_t &type) const {
-  type = _elfio.get_type();
+  type = isReader() ? _view.type() : _elfio.get_type();
   return true;
 }
 
@@ -474,7 +701,7 @@ bool Elf::setType(uint16_t  type) {
 }
 
 bool Elf::getFlags(uint32_t &flag) const {
-  flag = _elfio.get_flags();
+  flag = isReader() ? _view.flags() : _elfio.get_flags();
   return true;
 }
 
@@ -488,6 +715,18 @@ bool Elf::getSection(Elf::ElfSections id, char** dst, size_t* sz) const
   assert((ElfSecDesc[id].id == id) &&
       "ElfSecDesc[] should be in the same order as enum ElfSections");
 
+  if (isReader()) {
+    const ElfView::Section* sec = _view.section(ElfSecDesc[id].name);
+    if (sec == nullptr) {
+      LogElfError("failed: null sections(%s)", ElfSecDesc[id].name);
+      return false;
+    }
+    *dst = const_cast<char*>(sec->data_);
+    *sz = sec->size_;
+    LogElfInfo("succeeded: *dst=%p, *sz=%zu", *dst, *sz);
+    return true;
+  }
+
   section* sec = _elfio.sections[ElfSecDesc[id].name];
   if (sec == nullptr) {
     LogElfError("failed: null sections(%s)", ElfSecDesc[id].name);
@@ -507,6 +746,9 @@ unsigned int Elf::getSymbolNum() const {
     logElfError(" failed: _symtab_ndx = SHN_UNDEF");
     return 0; // No SYMTAB
   }
+  if (isReader()) {
+    return _view.symbolNum();
+  }
   symbol_section_accessor symbol_reader(_elfio, _elfio.sections[_symtab_ndx]);
   auto num = symbol_reader.get_symbols_num() - 1;  // Exclude the first dummy symbol
   LogElfInfo(": num=%lu", num);
@@ -514,10 +756,13 @@ unsigned int Elf::getSymbolNum() const {
 }
 
 unsigned int Elf::getSegmentNum() const {
-  return _elfio.segments.size();
+  return isReader() ? _view.segmentNum() : _elfio.segments.size();
 }
 
 bool Elf::getSegment(const unsigned int index, segment*& seg) const {
+  if (isReader() && !loadElfio()) {
+    return false;
+  }
   bool ret = false;
   if (index < _elfio.segments.size()) {
     seg = _elfio.segments[index];
@@ -532,7 +777,6 @@ bool Elf::getSymbolInfo(unsigned int index, SymbolInfo* symInfo) const
     logElfError(" failed: _symtab_ndx = SHN_UNDEF");
     return false; // No SYMTAB
   }
-  symbol_section_accessor symbol_reader(_elfio, _elfio.sections[_symtab_ndx]);
 
   auto num = getSymbolNum();
 
@@ -541,6 +785,23 @@ bool Elf::getSymbolInfo(unsigned int index, SymbolInfo* symInfo) const
     return false;
   }
 
+  if (isReader()) {
+    ElfView::Symbol sym;
+    if (!_view.symbol(index, &sym) || (sym.section_ == nullptr)) {
+      LogElfError("failed to get symbol(%u)", index);
+      return false;
+    }
+    symInfo->sec_addr = sym.section_->data_;
+    symInfo->sec_size = sym.section_->size_;
+    symInfo->address = symInfo->sec_addr + static_cast<size_t>(sym.value_);
+    symInfo->size = sym.size_;
+    symInfo->sec_name = sym.section_->name_;
+    symInfo->sym_name = sym.name_;
+    return true;
+  }
+
+  symbol_section_accessor symbol_reader(_elfio, _elfio.sections[_symtab_ndx]);
+
   std::string   sym_name;
   Elf64_Addr    value = 0;
   Elf_Xword     size = 0;
@@ -773,6 +1034,18 @@ bool Elf::getSymbol(
 
   *size = 0;
   *buffer = nullptr;
+
+  if (isReader()) {
+    ElfView::Symbol sym;
+    if (!_view.findSymbol(ElfSecDesc[id].name, symbolName, &sym) ||
+        (sym.section_->data_ == nullptr)) {
+      return false;
+    }
+    *buffer = const_cast<char*>(sym.section_->data_ + sym.value_);
+    *size = static_cast<size_t>(sym.size_);
+    return true;
+  }
+
   symbol_section_accessor symbol_reader(_elfio, _elfio.sections[_symtab_ndx]);
 
   Elf64_Addr value = 0;
@@ -842,6 +1115,19 @@ bool Elf::getNote(
     return false;
   }
 
+  // Initialize the size and buffer to invalid data points.
+  *descSize = 0;
+  *noteDesc = nullptr;
+
+  if (isReader()) {
+    const char* desc = nullptr;
+    if (!_view.findNote(noteName, &desc, descSize)) {
+      return false;
+    }
+    *noteDesc = const_cast<char*>(desc);
+    return true;
+  }
+
   // Get section
   section* sec = _elfio.sections[ElfSecDesc[NOTES].name];
   if (sec == nullptr) {
@@ -849,10 +1135,6 @@ bool Elf::getNote(
     return false;
   }
 
-  // Initialize the size and buffer to invalid data points.
-  *descSize = 0;
-  *noteDesc = nullptr;
-
   note_section_accessor note_reader(_elfio, sec);
 
   auto num = note_reader.get_notes_num();
@@ -22,6 +22,8 @@
 #define ELF_HPP_
 
 #include <map>
+#include <vector>
+#include <cstring>
 
 #include "top.hpp"
 #include "elfio/elfio.hpp"
@@ -70,6 +72,124 @@ using amd::ELFIO::Elf64_Shdr;
 namespace amd {
 using namespace amd::ELFIO;
 
+/*! \brief Read-only view of an ELF image in memory, e.g. a mmapped code object
+ *
+ *  Nothing is copied: the section, symbol and note data point into the image, which the
+ *  client keeps alive for the lifetime of the view. Both ELF classes are supported and all
+ *  offsets are checked against the image size.
+ */
+class ElfView
+{
+public:
+    struct Section {
+        const char* name_;      //!< Section name
+        const char* data_;      //!< Section data in the image, nullptr for SHT_NOBITS
+        uint64_t    size_;      //!< Section size
+        uint64_t    addr_;      //!< Virtual address
+        uint32_t    type_;      //!< SHT_* type
+        uint32_t    link_;      //!< Index of the linked section
+        uint64_t    entSize_;   //!< Size of the table entries
+    };
+
+    struct Symbol {
+        const char*    name_;          //!< Symbol name
+        const Section* section_;       //!< Section of the symbol, nullptr for the special ones
+        uint64_t       value_;         //!< Symbol value
+        uint64_t       size_;          //!< Symbol size
+        uint16_t       sectionIndex_;  //!< Raw section index
+        unsigned char  type_;          //!< STT_* type
+        unsigned char  bind_;          //!< STB_* binding
+    };
+
+    struct Segment {
+        uint32_t type_;      //!< PT_* type
+        uint32_t flags_;     //!< PF_* flags
+        uint64_t offset_;    //!< Offset in the image
+        uint64_t vaddr_;     //!< Virtual address
+        uint64_t fileSize_;  //!< Size in the image
+        uint64_t memSize_;   //!< Size in memory
+    };
+
+    ElfView() {}
+    ElfView(const char* image, uint64_t size);
+
+    bool isValid() const { return valid_; }
+
+    const char*   image() const { return image_; }
+    uint64_t      size() const { return size_; }
+    unsigned char eclass() const { return eclass_; }
+    uint16_t      machine() const { return machine_; }
+    uint16_t      type() const { return type_; }
+    uint32_t      flags() const { return flags_; }
+
+    uint32_t sectionNum() const { return static_cast<uint32_t>(sections_.size()); }
+    uint32_t shstrtabIndex() const { return shstrtab_; }
+    uint32_t symtabIndex() const { return symtab_; }
+
+    /* Return the section at index, nullptr if it doesn't exist */
+    const Section* section(uint32_t index) const {
+        return (index < sections_.size()) ? &sections_[index] : nullptr;
+    }
+
+    /* Return the first section with name, nullptr if it doesn't exist */
+    const Section* section(const char* name) const;
+
+    /* Return number of symbols in SYMTAB section, without the first dummy symbol */
+    uint32_t symbolNum() const;
+
+    /* Return the index-th symbol in SYMTAB section, without the first dummy symbol */
+    bool symbol(uint32_t index, Symbol* sym) const;
+
+    /* Find the symbol with symbolName in the section with sectionName */
+    bool findSymbol(const char* sectionName, const char* symbolName, Symbol* sym) const;
+
+    /*
+     * Find the note with noteName in all SHT_NOTE sections.
+     * The description points into the image.
+     */
+    bool findNote(const char* noteName, const char** noteDesc, size_t* descSize,
+                  uint32_t* noteType = nullptr) const;
+
+    uint32_t segmentNum() const { return static_cast<uint32_t>(segments_.size()); }
+
+    /* Return the segment at index, nullptr if it doesn't exist */
+    const Segment* segment(uint32_t index) const {
+        return (index < segments_.size()) ? &segments_[index] : nullptr;
+    }
+
+private:
+    template <typename Ehdr, typename Shdr, typename Phdr> bool init();
+    template <typename Sym> bool readSymbol(uint32_t index, Symbol* sym) const;
+
+    /* Copy an object at offset in the image, the image may be unaligned */
+    template <typename T> bool read(uint64_t offset, T* obj) const {
+        if (!inImage(offset, sizeof(T))) {
+            return false;
+        }
+        ::memcpy(obj, image_ + offset, sizeof(T));
+        return true;
+    }
+
+    bool inImage(uint64_t offset, uint64_t size) const {
+        return (offset <= size_) && (size <= size_ - offset);
+    }
+
+    /* Return the null terminated string at offset in strtab, nullptr if it is invalid */
+    const char* string(const Section& strtab, uint64_t offset) const;
+
+    const char*          image_ = nullptr;  //!< The image, owned by the client
+    uint64_t             size_ = 0;         //!< Size of the image
+    unsigned char        eclass_ = ELFCLASSNONE;
+    uint16_t             machine_ = 0;
+    uint16_t             type_ = 0;
+    uint32_t             flags_ = 0;
+    uint32_t             shstrtab_ = SHN_UNDEF;  //!< Index of .shstrtab
+    uint32_t             symtab_ = SHN_UNDEF;    //!< Index of the first SHT_SYMTAB
+    std::vector<Section> sections_;
+    std::vector<Segment> segments_;
+    bool                 valid_ = false;
+};
+
 class Elf
 {
 public:
@@ -171,8 +291,12 @@ public:
     };
 
 private:
-    // elfio object for reading and writting
-    elfio _elfio;
+    // elfio object for writing. A reader loads it only on demand for getSegment()
+    mutable elfio _elfio;
+    mutable bool  _elfioLoaded;
+
+    // Zero-copy view of the raw ELF bytes for reading
+    ElfView _view;
 
     // file name
     std::string _fname;
@@ -181,7 +305,8 @@ private:
     unsigned char _eclass;
 
     // Raw ELF bytes in memory from which Elf object is initialized
-    // The memory is owned by the client, not this Elf object !
+    // The memory is owned by the client, not this Elf object, and must outlive it.
+    // All data returned by the reader points into these bytes !
     const char* _rawElfBytes;
     uint64_t    _rawElfSize;
 
@@ -327,12 +452,20 @@ public:
 
     bool isSuccessful() const { return _successful; }
 
-    bool isHsaCo() const { return _elfio.get_machine() == EM_AMDGPU; }
+    bool isHsaCo() const {
+        return (isReader() ? _view.machine() : _elfio.get_machine()) == EM_AMDGPU;
+    }
+
+    /* Return the zero-copy view of the ELF for reading */
+    const ElfView& view() const { return _view; }
 
     /* Return number of segments */
     unsigned int getSegmentNum() const;
 
-    /* Return segment at index */
+    /*
+     * Return segment at index. A reader has to load the whole ELF with ELFIO for it,
+     * hence view().segment() should be used instead.
+     */
     bool getSegment(const unsigned int index, segment*& seg) const;
 
     /* Return size of elf file */
@@ -345,6 +478,11 @@ public:
     static bool isCALTarget(const char* p, signed char ec);
 private:
 
+    bool isReader() const { return _elfCmd == ELF_C_READ; }
+
+    /* Load the whole raw ELF into _elfio, for the reader */
+    bool loadElfio() const;
+
     /* Initialization */
     bool Init();
 
@@ -301,6 +301,64 @@ bool verify(amd::Elf* elf) {
    return true;
 }
 
+bool verifyView(const char* buff, size_t len) {
+  amd::ElfView view(buff, len);
+  if (!view.isValid()) {
+    LogError("ElfView() failed");
+    return false;
+  }
+
+  if ((view.type() != ET_EXEC) || (view.shstrtabIndex() == SHN_UNDEF) ||
+      (view.section(".shstrtab") == nullptr)) {
+    LogPrintfError("Not matched view header: type = %u, shstrtab = %u",
+                   view.type(), view.shstrtabIndex());
+    return false;
+  }
+
+  // The data must point into the image, not into a copy
+  const amd::ElfView::Section* sec = view.section(".comment");
+  if ((sec == nullptr) || (sec->data_ < buff) || (sec->data_ + sec->size_ > buff + len) ||
+      (memcmp(sec->data_, comment_, commentSize_) != 0)) {
+    LogError("ElfView.section(.comment) failed");
+    return false;
+  }
+
+  for (size_t i = 0; i < rodataSymbolInfosSize_; i++) {
+    auto& info = rodataSymbolInfos_[i];
+    amd::ElfView::Symbol sym;
+    if (!view.findSymbol(".rodata", info.sym_name.c_str(), &sym) ||
+        (sym.size_ != info.size) ||
+        memcmp(sym.section_->data_ + sym.value_, info.address, info.size)) {
+      LogPrintfError("ElfView.findSymbol(%s) failed", info.sym_name.c_str());
+      return false;
+    }
+  }
+
+  amd::ElfView::Symbol sym;
+  if (view.findSymbol(".rodata", commentSymbolInfos_[0].sym_name.c_str(), &sym)) {
+    LogError("ElfView.findSymbol() found a symbol in a wrong section");
+    return false;
+  }
+
+  const char* desc = nullptr;
+  size_t descSize = 0;
+  if (!view.findNote(noteInfos_[2].noteName, &desc, &descSize) ||
+      (descSize != noteInfos_[2].descSize) ||
+      memcmp(desc, noteInfos_[2].noteDesc, descSize)) {
+    LogError("ElfView.findNote() failed");
+    return false;
+  }
+
+  // A truncated image must be rejected
+  if (amd::ElfView(buff, len / 2).isValid()) {
+    LogError("ElfView() accepted a truncated image");
+    return false;
+  }
+
+  LogPrintfInfo("%s: Succeeded", __func__);
+  return true;
+}
+
 bool test(unsigned char eclass = ELFCLASS64, const char *outFile =
                      nullptr) {
   amd::Elf *writer = new amd::Elf(eclass, nullptr, 0, outFile,
@@ -328,19 +386,21 @@ bool test(unsigned char eclass = ELFCLASS64, const char *outFile =
     if (writer->dumpImage(&buff, &len)) {
       LogPrintfInfo("dumpImage succeed: buff=%p, len=%u)", buff, len);
 
+      // The reader doesn't copy the bytes, hence they must outlive it
       reader = new amd::Elf(eclass, buff, len, nullptr,
                                       amd::Elf::ELF_C_READ);
 
-      delete [] buff;
-
       if ((reader == nullptr) || !reader->isSuccessful()) {
         LogError("Creating reader ELF object failed");
+        delete [] buff;
         break;
       }
 
-      ret = verify(reader);
+      ret = verify(reader) && verifyView(buff, len);
 
       delete reader;
+      reader = nullptr;
+      delete [] buff;
     }
   } while (false);
 
@@ -185,8 +185,8 @@ class ReferenceCountedObject {
  public:
   ReferenceCountedObject() : referenceCount_(1) {}
 
-  void* operator new(size_t size) { return ::operator new(size); }
-  void operator delete(void* p) { return ::operator delete(p); }
+  void* operator new(size_t size);
+  void operator delete(void* obj);
   void* operator new(size_t size, size_t extSize) {
     return ReferenceCountedObject::operator new(size + extSize);
   };
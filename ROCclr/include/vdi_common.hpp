@@ -74,8 +74,9 @@ not_null(T* ptrOrNull)
     return amd::NotNullReference<T>(ptrOrNull);
 }
 
+//! The host thread is attached on the first call only, hence the check is a TLS read after it
 #define VDI_CHECK_THREAD(thread)                                             \
-    (thread != NULL || ((thread = new amd::HostThread()) != NULL             \
+    (likely(thread != NULL) || ((thread = new amd::HostThread()) != NULL     \
             && thread == amd::Thread::current()))
 
 #define RUNTIME_ENTRY_RET(ret, func, args)                                   \
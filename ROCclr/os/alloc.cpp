@@ -20,9 +20,13 @@
 
 #include "os/alloc.hpp"
 #include "os/os.hpp"
+#include "utils/flags.hpp"
 #include "utils/util.hpp"
 
 #include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
 
 namespace amd {
 
@@ -77,9 +81,176 @@ void GuardedMemory::deallocate(void* ptr) {
   Os::releaseMemory(static_cast<address>(ptr) - offset, size);
 }
 
-void* HeapObject::operator new(size_t size) { return malloc(size); }
+namespace {
 
-void HeapObject::operator delete(void* obj) { free(obj); }
+//! Size classes of the small objects, including the header. Larger objects go to the heap
+constexpr size_t kObjectSizeClass[] = {64, 128, 256, 512, 1024};
+constexpr uint32_t kObjectNumClasses = sizeof(kObjectSizeClass) / sizeof(kObjectSizeClass[0]);
+//! Number of free blocks cached per thread and size class
+constexpr uint32_t kObjectMagazineSize = 32;
+
+//! Header in front of every object. The size class is unknown at the delete, since the objects
+//! can have an extra size and the base class delete doesn't get the size of the dynamic type
+struct alignas(16) ObjectHeader {
+  uint32_t cls_;  //!< Size class or kObjectNumClasses for the heap blocks
+};
+
+//! Free block of the object storage, linked in the depot list
+struct ObjectBlock {
+  ObjectBlock* next_;
+};
+
+// ================================================================================================
+//! Global depot of free object blocks. The blocks are exchanged between the threads in batches,
+//! so the objects, created on the app threads and freed on the queue threads, don't go to the heap.
+//! amd::Monitor can't be used here, since the threads and the monitors are heap objects themselves
+class ObjectDepot {
+ public:
+  //! Moves up to \a count blocks of the size class into \a blocks
+  uint32_t Get(uint32_t cls, void** blocks, uint32_t count) {
+    std::lock_guard<std::mutex> lock(lock_);
+    uint32_t i = 0;
+    for (; (i < count) && (head_[cls] != nullptr); ++i) {
+      blocks[i] = head_[cls];
+      head_[cls] = head_[cls]->next_;
+    }
+    count_[cls] -= i;
+    return i;
+  }
+
+  //! Takes \a count blocks of the size class. The blocks above the depth limit are freed
+  void Put(uint32_t cls, void** blocks, uint32_t count) {
+    uint32_t i = 0;
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      for (; (i < count) && (count_[cls] < ROC_OBJECT_POOL_DEPTH); ++i) {
+        auto block = reinterpret_cast<ObjectBlock*>(blocks[i]);
+        block->next_ = head_[cls];
+        head_[cls] = block;
+        ++count_[cls];
+      }
+    }
+    for (; i < count; ++i) {
+      free(blocks[i]);
+    }
+  }
+
+ private:
+  std::mutex lock_;                             //!< Lock for the depot lists
+  ObjectBlock* head_[kObjectNumClasses] = {};   //!< Free lists per size class
+  size_t count_[kObjectNumClasses] = {};        //!< Number of blocks per size class
+};
+
+//! The depot is never destroyed, since the thread magazines can be flushed after static teardown
+ObjectDepot& objectDepot() {
+  static ObjectDepot* depot = new ObjectDepot();
+  return *depot;
+}
+
+// ================================================================================================
+//! Per thread cache of free object blocks
+struct ObjectMagazine {
+  uint32_t count_[kObjectNumClasses] = {};
+  void* blocks_[kObjectNumClasses][kObjectMagazineSize];
+  bool closed_ = false;   //!< Objects released during the thread exit bypass the magazine
+
+  ~ObjectMagazine() {
+    for (uint32_t cls = 0; cls < kObjectNumClasses; ++cls) {
+      objectDepot().Put(cls, blocks_[cls], count_[cls]);
+      count_[cls] = 0;
+    }
+    closed_ = true;
+  }
+};
+
+thread_local ObjectMagazine objectMagazine;
+
+//! Returns the size class of the allocation or kObjectNumClasses if pooling is disabled
+uint32_t objectSizeClass(size_t size) {
+  static const bool enabled = (ROC_OBJECT_POOL_DEPTH != 0);
+  uint32_t cls = 0;
+  if (enabled) {
+    while ((cls < kObjectNumClasses) && (size > kObjectSizeClass[cls])) {
+      ++cls;
+    }
+    return cls;
+  }
+  return kObjectNumClasses;
+}
+
+// ================================================================================================
+void* objectAlloc(size_t size) {
+  const size_t total = size + sizeof(ObjectHeader);
+  const uint32_t cls = objectSizeClass(total);
+  void* block = nullptr;
+  if (cls == kObjectNumClasses) {
+    block = malloc(total);
+  } else {
+    ObjectMagazine& magazine = objectMagazine;
+    if (magazine.closed_) {
+      if (objectDepot().Get(cls, &block, 1) == 0) {
+        block = malloc(kObjectSizeClass[cls]);
+      }
+    } else {
+      if (magazine.count_[cls] == 0) {
+        // Refill half of the magazine, so the next free doesn't have to go to the depot
+        magazine.count_[cls] =
+            objectDepot().Get(cls, magazine.blocks_[cls], kObjectMagazineSize / 2);
+      }
+      block = (magazine.count_[cls] != 0) ? magazine.blocks_[cls][--magazine.count_[cls]] :
+                                            malloc(kObjectSizeClass[cls]);
+    }
+  }
+  if (block == nullptr) {
+    return nullptr;
+  }
+  auto header = reinterpret_cast<ObjectHeader*>(block);
+  header->cls_ = cls;
+  return header + 1;
+}
+
+// ================================================================================================
+void objectFree(void* obj) {
+  if (obj == nullptr) {
+    return;
+  }
+  auto header = reinterpret_cast<ObjectHeader*>(obj) - 1;
+  const uint32_t cls = header->cls_;
+  void* block = header;
+  if (cls == kObjectNumClasses) {
+    free(block);
+    return;
+  }
+  ObjectMagazine& magazine = objectMagazine;
+  if (magazine.closed_) {
+    objectDepot().Put(cls, &block, 1);
+    return;
+  }
+  if (magazine.count_[cls] == kObjectMagazineSize) {
+    // Return the older half of the magazine to the depot for the allocating threads
+    constexpr uint32_t kHalf = kObjectMagazineSize / 2;
+    objectDepot().Put(cls, magazine.blocks_[cls], kHalf);
+    std::memmove(magazine.blocks_[cls], &magazine.blocks_[cls][kHalf], kHalf * sizeof(void*));
+    magazine.count_[cls] = kHalf;
+  }
+  magazine.blocks_[cls][magazine.count_[cls]++] = block;
+}
+
+}  // namespace
+
+void* HeapObject::operator new(size_t size) { return objectAlloc(size); }
+
+void HeapObject::operator delete(void* obj) { objectFree(obj); }
+
+void* ReferenceCountedObject::operator new(size_t size) {
+  void* obj = objectAlloc(size);
+  if (obj == nullptr) {
+    throw std::bad_alloc();
+  }
+  return obj;
+}
+
+void ReferenceCountedObject::operator delete(void* obj) { objectFree(obj); }
 
 
 }  // namespace amd
@@ -211,17 +211,34 @@ class Os : AllStatic {
   static bool commitMemory(void* addr, size_t size, MemProt prot = MEM_PROT_NONE);
   //! Uncommit a chunk of memory previously committed with commitMemory.
   static bool uncommitMemory(void* addr, size_t size);
+  //! Reserve and commit a chunk of memory backed with the huge pages of \a hugePageSize.
+  //! Falls back to the transparent huge pages, the memory is released with releaseMemory.
+  static address reserveHugeMemory(size_t size, size_t hugePageSize,
+                                   MemProt prot = MEM_PROT_RW);
   //! Set the page protections for the given memory region.
   static bool protectMemory(void* addr, size_t size, MemProt prot);
+  //! Write-protects the pages of [addr, addr + size) and records the first write of each page.
+  //! Returns false if the pages can't be watched, then any page may be written
+  static bool watchWrites(void* addr, size_t size);
+  //! Ends the watch of \a addr and returns a flag per page, true if the page was written.
+  //! Returns false if \a addr isn't watched
+  static bool unwatchWrites(void* addr, std::vector<bool>* pages);
 
   //! Allocate an aligned chunk of memory.
   static void* alignedMalloc(size_t size, size_t alignment);
   //! Deallocate an aligned chunk of memory.
   static void alignedFree(void* mem);
 
-  //! Platform-specific optimized memcpy()
+  //! Platform-specific optimized memcpy(), large copies use the streaming stores
   static void* fastMemcpy(void* dest, const void* src, size_t n);
 
+  /*! \brief Copies with the non-temporal stores and drains the write combining buffers
+   *
+   *  For the write combined and the uncached destinations, such as the large BAR and USWC memory.
+   *  The widest supported store (AVX-512, AVX2 or SSE2) is selected once.
+   */
+  static void streamMemcpy(void* dest, const void* src, size_t n);
+
   //! NUMA related settings
   static void setPreferredNumaNode(uint32_t node);
 
@@ -64,11 +64,17 @@
 #include <algorithm>
 #include <mutex>
 
+#if defined(ATI_ARCH_X86)
+#include <immintrin.h>
+#endif  // ATI_ARCH_X86
+
 namespace amd {
 
 static struct sigaction oldSigAction;
+static struct sigaction oldSegvAction;
 
-static bool callOldSignalHandler(int sig, siginfo_t* info, void* ptr) {
+static bool callOldSignalHandler(struct sigaction& oldSigAction, int sig, siginfo_t* info,
+                                 void* ptr) {
   if (oldSigAction.sa_handler == SIG_DFL) {
     // no signal handler was previously installed.
     return false;
@@ -120,7 +126,7 @@ static void divisionErrorHandler(int sig, siginfo_t* info, void* ptr) {
   }
 
   // Call the chained signal handler
-  if (callOldSignalHandler(sig, info, ptr)) {
+  if (callOldSignalHandler(oldSigAction, sig, info, ptr)) {
     return;
   }
 
@@ -209,7 +215,7 @@ address Os::reserveMemory(address start, size_t size, size_t alignment, MemProt
                                 MAP_PRIVATE | MAP_NORESERVE | MAP_ANONYMOUS, 0, 0);
 
   // check for out of memory
-  if (mem == NULL) return NULL;
+  if (mem == reinterpret_cast<address>(MAP_FAILED)) return NULL;
 
   address aligned = alignUp(mem, alignment);
 
@@ -246,6 +252,37 @@ bool Os::commitMemory(void* addr, size_t size, MemProt prot) {
                 0) != MAP_FAILED;
 }
 
+address Os::reserveHugeMemory(size_t size, size_t hugePageSize, MemProt prot) {
+  assert(isPowerOfTwo(hugePageSize) && "not a power of 2");
+  size = alignUp(size, hugePageSize);
+
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+  // The pages of hugetlbfs are preallocated by the admin, hence they may run out any time
+  void* mem = ::mmap(nullptr, size, memProtToOsProt(prot),
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+                         (static_cast<int>(log2(hugePageSize)) << MAP_HUGE_SHIFT),
+                     -1, 0);
+  if (mem != MAP_FAILED) {
+    return reinterpret_cast<address>(mem);
+  }
+#endif  // MAP_HUGETLB && MAP_HUGE_SHIFT
+
+  // THP has 2MB pages only, but the bigger alignment doesn't hurt
+  address aligned = reserveMemory(nullptr, size, hugePageSize, prot);
+  if (aligned == nullptr) {
+    return nullptr;
+  }
+  if (!commitMemory(aligned, size, prot)) {
+    releaseMemory(aligned, size);
+    return nullptr;
+  }
+#if defined(MADV_HUGEPAGE)
+  // Even with THP disabled the memory stays usable with the regular pages
+  ::madvise(aligned, size, MADV_HUGEPAGE);
+#endif  // MADV_HUGEPAGE
+  return aligned;
+}
+
 bool Os::uncommitMemory(void* addr, size_t size) {
   assert(isMultipleOf(addr, pageSize()) && "not page aligned!");
   size = alignUp(size, pageSize());
@@ -261,6 +298,104 @@ bool Os::protectMemory(void* addr, size_t size, MemProt prot) {
   return 0 == ::mprotect(addr, size, memProtToOsProt(prot));
 }
 
+//! Write watched range, the signal handler reads it without a lock
+struct WriteWatch {
+  std::atomic<uintptr_t> base_{0};    //!< Start of the range, 0 if the slot is free
+  size_t size_ = 0;                   //!< Size of the range
+  std::atomic<uint8_t>* pages_ = nullptr;  //!< Written flag per page
+  size_t capacity_ = 0;               //!< Allocated flags, the array is reused by the slot
+};
+
+static constexpr size_t kMaxWriteWatches = 64;
+static WriteWatch writeWatches[kMaxWriteWatches];
+static std::mutex writeWatchLock;
+static bool writeWatchHandlerInstalled = false;
+
+static void writeWatchHandler(int sig, siginfo_t* info, void* ptr) {
+  const uintptr_t fault = reinterpret_cast<uintptr_t>(info->si_addr);
+  for (auto& it : writeWatches) {
+    const uintptr_t base = it.base_.load(std::memory_order_acquire);
+    if ((base != 0) && (fault >= base) && (fault < base + it.size_)) {
+      const size_t page = (fault - base) / Os::pageSize();
+      it.pages_[page].store(1, std::memory_order_relaxed);
+      // The write restarts on the return
+      ::mprotect(reinterpret_cast<void*>(base + page * Os::pageSize()), Os::pageSize(),
+                 PROT_READ | PROT_WRITE);
+      return;
+    }
+  }
+  if (!callOldSignalHandler(oldSegvAction, sig, info, ptr)) {
+    // Restore the default action, so the fault terminates the process on the restart
+    ::sigaction(SIGSEGV, &oldSegvAction, nullptr);
+  }
+}
+
+bool Os::watchWrites(void* addr, size_t size) {
+  assert(isMultipleOf(addr, pageSize()) && "not page aligned!");
+  const size_t numPages = alignUp(size, pageSize()) / pageSize();
+  if (numPages == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(writeWatchLock);
+  if (!writeWatchHandlerInstalled) {
+    struct sigaction sa;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_sigaction = writeWatchHandler;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART | SA_NODEFER;
+    if (::sigaction(SIGSEGV, &sa, &oldSegvAction) != 0) {
+      return false;
+    }
+    writeWatchHandlerInstalled = true;
+  }
+  WriteWatch* watch = nullptr;
+  for (auto& it : writeWatches) {
+    const uintptr_t base = it.base_.load(std::memory_order_relaxed);
+    if (base == reinterpret_cast<uintptr_t>(addr)) {
+      // Already watched by another map of the same region
+      return false;
+    }
+    if ((base == 0) && (watch == nullptr)) {
+      watch = &it;
+    }
+  }
+  if (watch == nullptr) {
+    return false;
+  }
+  if (watch->capacity_ < numPages) {
+    delete[] watch->pages_;
+    watch->pages_ = new std::atomic<uint8_t>[numPages];
+    watch->capacity_ = numPages;
+  }
+  for (size_t i = 0; i < numPages; ++i) {
+    watch->pages_[i].store(0, std::memory_order_relaxed);
+  }
+  watch->size_ = numPages * pageSize();
+  watch->base_.store(reinterpret_cast<uintptr_t>(addr), std::memory_order_release);
+  if (::mprotect(addr, watch->size_, PROT_READ) != 0) {
+    watch->base_.store(0, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+bool Os::unwatchWrites(void* addr, std::vector<bool>* pages) {
+  std::lock_guard<std::mutex> lock(writeWatchLock);
+  for (auto& it : writeWatches) {
+    if (it.base_.load(std::memory_order_relaxed) == reinterpret_cast<uintptr_t>(addr)) {
+      // Unprotect first, so the remaining writes don't fault after the slot is free
+      ::mprotect(addr, it.size_, PROT_READ | PROT_WRITE);
+      const size_t numPages = it.size_ / pageSize();
+      pages->resize(numPages);
+      for (size_t i = 0; i < numPages; ++i) {
+        (*pages)[i] = it.pages_[i].load(std::memory_order_relaxed) != 0;
+      }
+      it.base_.store(0, std::memory_order_release);
+      return true;
+    }
+  }
+  return false;
+}
+
 uint64_t Os::hostTotalPhysicalMemory() {
   static uint64_t totalPhys = 0;
 
@@ -310,7 +445,7 @@ void Os::setCurrentThreadName(const char* name) { ::prctl(PR_SET_NAME, name); }
 
 void Os::setPreferredNumaNode(uint32_t node) {
 #ifdef ROCCLR_SUPPORT_NUMA_POLICY
-  if (AMD_CPU_AFFINITY && (numa_available() >= 0)) {
+  if (numa_available() >= 0) {
     bitmask* bm = numa_allocate_cpumask();
     numa_node_to_cpus(node, bm);
     if (numa_sched_setaffinity(0, bm) < 0) {
@@ -678,7 +813,117 @@ uint64_t Os::xgetbv(uint32_t ecx) {
 }
 #endif  // ATI_ARCH_X86
 
-void* Os::fastMemcpy(void* dest, const void* src, size_t n) { return memcpy(dest, src, n); }
+#if defined(ATI_ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+//! Copies the unaligned head with regular stores, so the streaming stores are aligned
+static inline void streamHead(address& d, const_address& s, size_t& n, size_t alignment) {
+  const size_t head = std::min(n, (alignment - (reinterpret_cast<uintptr_t>(d) &
+                                                (alignment - 1))) & (alignment - 1));
+  memcpy(d, s, head);
+  d += head;
+  s += head;
+  n -= head;
+}
+
+__attribute__((target("avx512f"))) static void streamMemcpyAvx512(void* dest, const void* src,
+                                                                  size_t n) {
+  address d = reinterpret_cast<address>(dest);
+  const_address s = reinterpret_cast<const_address>(src);
+  streamHead(d, s, n, 64);
+  for (; n >= 256; n -= 256, d += 256, s += 256) {
+    const __m512i v0 = _mm512_loadu_si512(s);
+    const __m512i v1 = _mm512_loadu_si512(s + 64);
+    const __m512i v2 = _mm512_loadu_si512(s + 128);
+    const __m512i v3 = _mm512_loadu_si512(s + 192);
+    _mm512_stream_si512(reinterpret_cast<__m512i*>(d), v0);
+    _mm512_stream_si512(reinterpret_cast<__m512i*>(d + 64), v1);
+    _mm512_stream_si512(reinterpret_cast<__m512i*>(d + 128), v2);
+    _mm512_stream_si512(reinterpret_cast<__m512i*>(d + 192), v3);
+  }
+  for (; n >= 64; n -= 64, d += 64, s += 64) {
+    _mm512_stream_si512(reinterpret_cast<__m512i*>(d), _mm512_loadu_si512(s));
+  }
+  memcpy(d, s, n);
+  _mm_sfence();
+}
+
+__attribute__((target("avx2"))) static void streamMemcpyAvx2(void* dest, const void* src,
+                                                             size_t n) {
+  address d = reinterpret_cast<address>(dest);
+  const_address s = reinterpret_cast<const_address>(src);
+  streamHead(d, s, n, 32);
+  for (; n >= 128; n -= 128, d += 128, s += 128) {
+    const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 32));
+    const __m256i v2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 64));
+    const __m256i v3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 96));
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(d), v0);
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 32), v1);
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 64), v2);
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 96), v3);
+  }
+  for (; n >= 32; n -= 32, d += 32, s += 32) {
+    _mm256_stream_si256(reinterpret_cast<__m256i*>(d),
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s)));
+  }
+  memcpy(d, s, n);
+  _mm_sfence();
+}
+
+static void streamMemcpySse2(void* dest, const void* src, size_t n) {
+  address d = reinterpret_cast<address>(dest);
+  const_address s = reinterpret_cast<const_address>(src);
+  streamHead(d, s, n, 16);
+  for (; n >= 16; n -= 16, d += 16, s += 16) {
+    _mm_stream_si128(reinterpret_cast<__m128i*>(d),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+  }
+  memcpy(d, s, n);
+  _mm_sfence();
+}
+
+//! Selects the widest streaming copy, which the CPU and the OS support
+static void (*selectStreamMemcpy())(void*, const void*, size_t) {
+  int regs[4];
+  Os::cpuid(regs, 0);
+  const int maxLeaf = regs[0];
+  Os::cpuid(regs, 1);
+  // The OS must save the YMM/ZMM state, otherwise the wide registers can't be used
+  const bool osxsave = (regs[2] & (1 << 27)) != 0;
+  const uint64_t xcr0 = osxsave ? Os::xgetbv(0) : 0;
+  if (maxLeaf >= 7) {
+    Os::cpuid(regs, 7);
+    const bool avx512f = (regs[1] & (1 << 16)) != 0;
+    const bool avx2 = (regs[1] & (1 << 5)) != 0;
+    if (avx512f && ((xcr0 & 0xe6) == 0xe6)) {
+      return streamMemcpyAvx512;
+    }
+    if (avx2 && ((xcr0 & 0x6) == 0x6)) {
+      return streamMemcpyAvx2;
+    }
+  }
+  return streamMemcpySse2;
+}
+#endif  // ATI_ARCH_X86
+
+void Os::streamMemcpy(void* dest, const void* src, size_t n) {
+#if defined(ATI_ARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+  static void (*const copy)(void*, const void*, size_t) = selectStreamMemcpy();
+  copy(dest, src, n);
+#else
+  memcpy(dest, src, n);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+}
+
+void* Os::fastMemcpy(void* dest, const void* src, size_t n) {
+  // The streaming stores bypass the caches, which matters for the large copies only.
+  // The small ones are faster with the cached stores and the data stays in the caches
+  if ((ROC_STREAMING_COPY_THRESHOLD != 0) && (n >= ROC_STREAMING_COPY_THRESHOLD)) {
+    streamMemcpy(dest, src, n);
+    return dest;
+  }
+  return memcpy(dest, src, n);
+}
 
 uint64_t Os::offsetToEpochNanos() {
   static uint64_t offset = 0;
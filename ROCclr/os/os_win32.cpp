@@ -171,11 +171,23 @@ bool Os::uncommitMemory(void* addr, size_t size) {
   return VirtualFree(addr, size, MEM_DECOMMIT) != 0;
 }
 
+address Os::reserveHugeMemory(size_t size, size_t hugePageSize, MemProt prot) {
+  // MEM_LARGE_PAGES requires SeLockMemoryPrivilege, which the applications rarely have
+  return NULL;
+}
+
 bool Os::protectMemory(void* addr, size_t size, MemProt prot) {
   DWORD OldProtect;
   return VirtualProtect(addr, size, memProtToOsProt(prot), &OldProtect) != 0;
 }
 
+bool Os::watchWrites(void* addr, size_t size) {
+  // GetWriteWatch() needs MEM_WRITE_WATCH at the allocation, which the runtime doesn't own
+  return false;
+}
+
+bool Os::unwatchWrites(void* addr, std::vector<bool>* pages) { return false; }
+
 
 uint64_t Os::hostTotalPhysicalMemory() {
   static uint64_t totalPhys = 0;
@@ -758,6 +770,11 @@ $memcpy_final:
 #endif
 }
 
+void Os::streamMemcpy(void* dest, const void* src, size_t n) {
+  memcpy(dest, src, n);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
 uint64_t Os::offsetToEpochNanos() {
   static uint64_t offset = 0;
 
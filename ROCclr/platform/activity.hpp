@@ -21,10 +21,12 @@
 #pragma once
 
 #include "thread/monitor.hpp"
+#include "utils/flags.hpp"
 
 #include <atomic>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #define USE_PROF_API 1
 
@@ -38,6 +40,10 @@ enum OpId { OP_ID_DISPATCH = 0, OP_ID_COPY = 1, OP_ID_BARRIER = 2, OP_ID_NUMBER
   namespace activity_prof {                                                                        \
   CallbacksTable::table_t CallbacksTable::table_{};                                                \
   std::atomic<record_id_t> ActivityProf::globe_record_id_(0);                                      \
+  thread_local record_id_t ActivityProf::next_record_id_ = 0;                                      \
+  thread_local record_id_t ActivityProf::last_record_id_ = 0;                                      \
+  std::atomic<uint64_t> ActivityProf::op_count_[OP_ID_NUMBER] = {};                                \
+  std::atomic<uint64_t> ActivityProf::op_sampled_[OP_ID_NUMBER] = {};                              \
   }  // activity_prof
 
 namespace activity_prof {
@@ -47,6 +53,7 @@ typedef uint32_t command_id_t;
 
 typedef activity_id_callback_t id_callback_fun_t;
 typedef activity_async_callback_t callback_fun_t;
+typedef activity_batch_callback_t batch_callback_fun_t;
 typedef void* callback_arg_t;
 
 // Activity callbacks table
@@ -55,6 +62,7 @@ class CallbacksTable {
   struct table_t {
     id_callback_fun_t id_callback;
     callback_fun_t op_callback;
+    std::atomic<batch_callback_fun_t> batch_callback;
     callback_arg_t arg;
     std::atomic<bool> enabled[OP_ID_NUMBER];
   };
@@ -67,6 +75,11 @@ class CallbacksTable {
     table_.arg = arg;
   }
 
+  // Set the callback for the buffered records, nullptr delivers them with the activity callback
+  static void SetBatchCallback(const batch_callback_fun_t& batch_callback) {
+    table_.batch_callback.store(batch_callback, std::memory_order_release);
+  }
+
   static bool SetEnabled(const op_id_t& op_id, const bool& enable) {
     bool ret = true;
     if (op_id < OP_ID_NUMBER) {
@@ -83,12 +96,67 @@ class CallbacksTable {
 
   static id_callback_fun_t get_id_callback() { return table_.id_callback; }
   static callback_fun_t get_op_callback() { return table_.op_callback; }
+  static batch_callback_fun_t get_batch_callback() {
+    return table_.batch_callback.load(std::memory_order_acquire);
+  }
   static callback_arg_t get_arg() { return table_.arg; }
 
  private:
   static table_t table_;
 };
 
+// Buffer of the activity records of a queue, delivered in batches of ROC_ACTIVITY_BATCH_SIZE
+class ActivityBuffer {
+ public:
+  ActivityBuffer() : lock_("Activity buffer", true), start_(0) {}
+  ~ActivityBuffer() { flush(); }
+
+  // Buffered mode of the activity records
+  static bool IsEnabled() { return ROC_ACTIVITY_BATCH_SIZE > 1; }
+
+  // Adds a record and delivers the batch if it's full or the first record waits too long
+  void add(const activity_record_t& record) {
+    amd::ScopedLock lock(lock_);
+    if (records_.capacity() == 0) {
+      records_.reserve(ROC_ACTIVITY_BATCH_SIZE);
+    }
+    if (records_.empty()) {
+      start_ = record.end_ns;
+    }
+    records_.push_back(record);
+    if ((records_.size() >= ROC_ACTIVITY_BATCH_SIZE) ||
+        ((record.end_ns - start_) >= (ROC_ACTIVITY_BATCH_LATENCY * 1000ull))) {
+      deliver();
+    }
+  }
+
+  // Delivers the buffered records, called on the queue sync
+  void flush() {
+    amd::ScopedLock lock(lock_);
+    if (!records_.empty()) {
+      deliver();
+    }
+  }
+
+ private:
+  void deliver() {
+    batch_callback_fun_t batch_callback = CallbacksTable::get_batch_callback();
+    if (batch_callback != nullptr) {
+      batch_callback(records_.data(), static_cast<uint32_t>(records_.size()),
+                     CallbacksTable::get_arg());
+    } else {
+      for (auto& it : records_) {
+        (CallbacksTable::get_op_callback())(it.op, &it, CallbacksTable::get_arg());
+      }
+    }
+    records_.clear();
+  }
+
+  amd::Monitor lock_;                      //!< Serializes the completions from several threads
+  std::vector<activity_record_t> records_; //!< Records of the current batch
+  uint64_t start_;                         //!< End timestamp of the first record in the batch
+};
+
 // Activity profile class
 class ActivityProf {
  public:
@@ -101,12 +169,12 @@ class ActivityProf {
   void Initialize(const command_id_t command_id, const uint32_t queue_id,
                   const uint32_t device_id) {
     activity_op_t op_id = (command_id == CL_COMMAND_NDRANGE_KERNEL) ? OP_ID_DISPATCH : OP_ID_COPY;
-    enabled_ = CallbacksTable::IsEnabled(op_id);
+    enabled_ = CallbacksTable::IsEnabled(op_id) && Sample(op_id);
     if (IsEnabled()) {
       command_id_ = command_id;
       queue_id_ = queue_id;
       device_id_ = device_id;
-      record_id_ = globe_record_id_.fetch_add(1, std::memory_order_relaxed);
+      record_id_ = NextRecordId();
       (CallbacksTable::get_id_callback())(record_id_);
     }
   }
@@ -115,16 +183,57 @@ class ActivityProf {
     if (IsEnabled()) {
       uint64_t start = obj.profilingInfo().start_;
       uint64_t end = obj.profilingInfo().end_;
-      callback(obj.type(), start, end, bytes);
+      ActivityBuffer* buffer = (ActivityBuffer::IsEnabled() && (obj.queue() != nullptr)) ?
+          &obj.queue()->activityBuffer() : nullptr;
+      callback(obj.type(), start, end, bytes, buffer);
     }
   }
 
   bool IsEnabled() const { return enabled_; }
 
+  // Returns the correlation ID of the activity record, 0 if the command isn't recorded
+  record_id_t RecordId() const { return IsEnabled() ? record_id_ : 0; }
+
+  // Only 1 in ROC_ACTIVITY_SAMPLE_RATE commands of each op is recorded
+  static bool IsSampling() { return ROC_ACTIVITY_SAMPLE_RATE > 1; }
+
+  // Returns the number of all and of the recorded commands of the op
+  static bool GetSampleCount(const op_id_t op_id, uint64_t* total, uint64_t* sampled) {
+    if (op_id >= OP_ID_NUMBER) {
+      return false;
+    }
+    *total = op_count_[op_id].load(std::memory_order_relaxed);
+    *sampled = op_sampled_[op_id].load(std::memory_order_relaxed);
+    return true;
+  }
+
  private:
+  // Returns true if the command is in the sample
+  static bool Sample(const op_id_t op_id) {
+    const uint64_t count = op_count_[op_id].fetch_add(1, std::memory_order_relaxed);
+    if (IsSampling() && ((count % ROC_ACTIVITY_SAMPLE_RATE) != 0)) {
+      return false;
+    }
+    op_sampled_[op_id].fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Returns a new record ID. The buffered mode takes the IDs from the global counter in blocks
+  static record_id_t NextRecordId() {
+    if (!ActivityBuffer::IsEnabled()) {
+      return globe_record_id_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (next_record_id_ == last_record_id_) {
+      next_record_id_ = globe_record_id_.fetch_add(ROC_ACTIVITY_BATCH_SIZE,
+                                                   std::memory_order_relaxed);
+      last_record_id_ = next_record_id_ + ROC_ACTIVITY_BATCH_SIZE;
+    }
+    return next_record_id_++;
+  }
+
   // Activity callback routine
-  void callback(const command_id_t command_id,
-      const uint64_t begin_ts, const uint64_t end_ts, const size_t bytes) {
+  void callback(const command_id_t command_id, const uint64_t begin_ts, const uint64_t end_ts,
+                const size_t bytes, ActivityBuffer* buffer) {
     activity_op_t op_id = (command_id == CL_COMMAND_NDRANGE_KERNEL) ? OP_ID_DISPATCH : OP_ID_COPY;
     activity_record_t record {
         ACTIVITY_DOMAIN_ID,            // domain id
@@ -141,7 +250,11 @@ class ActivityProf {
         },
         bytes                          // copied data size, for memcpy
     };
-    (CallbacksTable::get_op_callback())(op_id, &record, CallbacksTable::get_arg());
+    if (buffer != nullptr) {
+      buffer->add(record);
+    } else {
+      (CallbacksTable::get_op_callback())(op_id, &record, CallbacksTable::get_arg());
+    }
   }
 
   command_id_t command_id_; //!< Command ID, executed on the queue
@@ -152,6 +265,10 @@ class ActivityProf {
 
   // Global record ID
   static std::atomic<record_id_t> globe_record_id_; //!< GLobal counter of all executed commands
+  static thread_local record_id_t next_record_id_;  //!< Next ID in the block of the thread
+  static thread_local record_id_t last_record_id_;  //!< End of the ID block of the thread
+  static std::atomic<uint64_t> op_count_[OP_ID_NUMBER];   //!< Commands of each op
+  static std::atomic<uint64_t> op_sampled_[OP_ID_NUMBER]; //!< Recorded commands of each op
 };
 
 }  // namespace activity_prof
@@ -165,14 +282,20 @@ typedef uint32_t command_id_t;
 
 typedef void* id_callback_fun_t;
 typedef void* callback_fun_t;
+typedef void* batch_callback_fun_t;
 typedef void* callback_arg_t;
 
 struct CallbacksTable {
   static void init(const id_callback_fun_t& id_callback, const callback_fun_t& op_callback,
                    const callback_arg_t& arg) {}
+  static void SetBatchCallback(const batch_callback_fun_t& batch_callback) {}
   static bool SetEnabled(const op_id_t& op_id, const bool& enable) { return false; }
 };
 
+struct ActivityBuffer {
+  void flush() {}
+};
+
 class ActivityProf {
  public:
   ActivityProf() {}
@@ -180,6 +303,10 @@ class ActivityProf {
                          const uint32_t device_id) {}
   template <class T> inline void ReportEventTimestamps(T& obj, const size_t bytes = 0) {}
   inline bool IsEnabled() { return false; }
+  static bool IsSampling() { return false; }
+  static bool GetSampleCount(const op_id_t op_id, uint64_t* total, uint64_t* sampled) {
+    return false;
+  }
 };
 
 }  // namespace activity_prof
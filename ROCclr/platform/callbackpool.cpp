@@ -0,0 +1,87 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "platform/callbackpool.hpp"
+#include "os/os.hpp"
+#include "utils/debug.hpp"
+#include "utils/flags.hpp"
+
+namespace amd {
+
+void CallbackPool::Worker::run(void* data) {
+  while (true) {
+    std::pair<Task, void*> task;
+    {
+      ScopedLock lock(pool_.lock_);
+      while (pool_.tasks_.empty() && !pool_.exiting_) {
+        pool_.lock_.wait();
+      }
+      if (pool_.tasks_.empty()) {
+        break;
+      }
+      task = pool_.tasks_.front();
+      pool_.tasks_.pop_front();
+    }
+    task.first(task.second);
+  }
+}
+
+CallbackPool::CallbackPool(uint32_t numWorkers)
+    : numWorkers_(numWorkers), exiting_(false), lock_("Callback pool lock") {}
+
+CallbackPool::~CallbackPool() {
+  {
+    ScopedLock lock(lock_);
+    exiting_ = true;
+    lock_.notifyAll();
+  }
+  for (auto worker : workers_) {
+    while (worker->state() < Thread::FINISHED) {
+      Os::yield();
+    }
+    delete worker;
+  }
+}
+
+bool CallbackPool::create() {
+  for (uint32_t i = 0; i < numWorkers_; ++i) {
+    Worker* worker = new Worker(*this);
+    if ((worker == nullptr) || (worker->state() != Thread::INITIALIZED)) {
+      delete worker;
+      break;
+    }
+    workers_.push_back(worker);
+    worker->start();
+  }
+  ClPrint(LOG_INFO, LOG_INIT, "Created %zu callback workers", workers_.size());
+  return !workers_.empty();
+}
+
+bool CallbackPool::submit(Task task, void* arg) {
+  if (workers_.empty()) {
+    return false;
+  }
+  ScopedLock lock(lock_);
+  tasks_.push_back(std::make_pair(task, arg));
+  lock_.notify();
+  return true;
+}
+
+}  // namespace amd
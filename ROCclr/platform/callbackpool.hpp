@@ -0,0 +1,73 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef CALLBACKPOOL_HPP_
+#define CALLBACKPOOL_HPP_
+
+#include "top.hpp"
+#include "thread/monitor.hpp"
+#include "thread/thread.hpp"
+
+#include <deque>
+#include <vector>
+
+namespace amd {
+
+/*! \brief A pool of worker threads for the API callbacks
+ *
+ *  The HSA signal handler thread hands the callbacks to the workers, so a slow
+ *  callback doesn't stall the completion processing of the other queues. The
+ *  callbacks of independent queues run concurrently on different workers.
+ */
+class CallbackPool : public HeapObject {
+ public:
+  typedef void (*Task)(void* arg);
+
+  explicit CallbackPool(uint32_t numWorkers);
+  ~CallbackPool();
+
+  //! Starts the worker threads, returns false if no worker could be created
+  bool create();
+
+  //! Queues \a task for a worker, returns false if the pool has no workers
+  bool submit(Task task, void* arg);
+
+ private:
+  class Worker : public Thread {
+   public:
+    explicit Worker(CallbackPool& pool) : Thread("Callback Thread"), pool_(pool) {}
+
+    //! The worker thread entry point
+    void run(void* data);
+
+   private:
+    CallbackPool& pool_;  //!< The pool of the worker
+  };
+
+  const uint32_t numWorkers_;                      //!< The number of requested workers
+  std::vector<Worker*> workers_;                   //!< The worker threads
+  std::deque<std::pair<Task, void*>> tasks_;       //!< The queued callbacks
+  bool exiting_;                                   //!< True if the workers must exit
+  Monitor lock_;                                   //!< Guards the tasks and wakes the workers
+};
+
+}  // namespace amd
+
+#endif  // CALLBACKPOOL_HPP_
@@ -34,6 +34,7 @@
 #include "thread/monitor.hpp"
 #include "platform/memory.hpp"
 #include "platform/agent.hpp"
+#include "platform/timeline.hpp"
 #include "os/alloc.hpp"
 
 #include <atomic>
@@ -50,7 +51,7 @@ Event::Event(HostQueue& queue)
       notify_event_(nullptr),
       device_(&queue.device()),
       profilingInfo_(IS_PROFILER_ON || queue.properties().test(CL_QUEUE_PROFILING_ENABLE) ||
-                     Agent::shouldPostEventEvents()),
+                     Agent::shouldPostEventEvents() || Timeline::enabled()),
       event_scope_(Device::kCacheStateInvalid) {
   notified_.clear();
 }
@@ -163,6 +164,13 @@ bool Event::setStatus(int32_t status, uint64_t timeStamp) {
     }
 
     activity_.ReportEventTimestamps(command());
+    if (Timeline::enabled()) {
+      Timeline::record(command());
+    }
+    if ((command().enqueueTime() != 0) && (command().queue() != nullptr)) {
+      command().queue()->device().latencyStats().record(LatencyStats::Completion,
+                                                        command().enqueueTime());
+    }
     // Broadcast all the waiters.
     if (referenceCount() > 1) {
       signal();
@@ -308,6 +316,144 @@ bool Event::notifyCmdQueue(bool cpu_wait) {
 
 const Event::EventWaitList Event::nullWaitList(0);
 
+namespace {
+
+//! Size classes of the command storage. Larger commands go to the heap directly
+constexpr size_t kCommandSizeClass[] = {256, 512, 1024, 2048};
+constexpr uint32_t kCommandNumClasses = sizeof(kCommandSizeClass) / sizeof(kCommandSizeClass[0]);
+//! Number of free blocks cached per thread and size class
+constexpr uint32_t kCommandMagazineSize = 32;
+
+//! Free block of the command storage, linked in the depot list
+struct CommandBlock {
+  CommandBlock* next_;
+};
+
+// ================================================================================================
+//! Global depot of free command blocks. The blocks are exchanged between the threads in
+//! batches, since commands are usually created on the app thread and freed on the queue thread
+class CommandDepot {
+ public:
+  CommandDepot() : lock_("Command depot lock"), head_{}, count_{} {}
+
+  //! Moves up to \a count blocks of the size class into \a blocks
+  uint32_t Get(uint32_t cls, void** blocks, uint32_t count) {
+    ScopedLock lock(lock_);
+    uint32_t i = 0;
+    for (; (i < count) && (head_[cls] != nullptr); ++i) {
+      blocks[i] = head_[cls];
+      head_[cls] = head_[cls]->next_;
+    }
+    count_[cls] -= i;
+    return i;
+  }
+
+  //! Takes \a count blocks of the size class. The blocks above the depth limit are freed
+  void Put(uint32_t cls, void** blocks, uint32_t count) {
+    uint32_t i = 0;
+    {
+      ScopedLock lock(lock_);
+      for (; (i < count) && (count_[cls] < AMD_COMMAND_POOL_DEPTH); ++i) {
+        auto block = reinterpret_cast<CommandBlock*>(blocks[i]);
+        block->next_ = head_[cls];
+        head_[cls] = block;
+        ++count_[cls];
+      }
+    }
+    for (; i < count; ++i) {
+      ::operator delete(blocks[i]);
+    }
+  }
+
+ private:
+  Monitor lock_;                                //!< Lock for the depot lists
+  CommandBlock* head_[kCommandNumClasses];      //!< Free lists per size class
+  size_t count_[kCommandNumClasses];            //!< Number of blocks per size class
+};
+
+//! The depot is never destroyed, since the thread magazines can be flushed after static teardown
+CommandDepot& commandDepot() {
+  static CommandDepot* depot = new CommandDepot();
+  return *depot;
+}
+
+// ================================================================================================
+//! Per thread cache of free command blocks
+struct CommandMagazine {
+  uint32_t count_[kCommandNumClasses] = {};
+  void* blocks_[kCommandNumClasses][kCommandMagazineSize];
+  bool closed_ = false;   //!< Commands released during the thread exit bypass the magazine
+
+  ~CommandMagazine() {
+    for (uint32_t cls = 0; cls < kCommandNumClasses; ++cls) {
+      commandDepot().Put(cls, blocks_[cls], count_[cls]);
+      count_[cls] = 0;
+    }
+    closed_ = true;
+  }
+};
+
+thread_local CommandMagazine commandMagazine;
+
+//! Returns the size class of the allocation or kCommandNumClasses if pooling is disabled
+uint32_t commandSizeClass(size_t size) {
+  static const bool enabled = (AMD_COMMAND_POOL_DEPTH != 0);
+  uint32_t cls = 0;
+  if (enabled) {
+    while ((cls < kCommandNumClasses) && (size > kCommandSizeClass[cls])) {
+      ++cls;
+    }
+    return cls;
+  }
+  return kCommandNumClasses;
+}
+
+}  // namespace
+
+// ================================================================================================
+void* Command::operator new(size_t size) {
+  uint32_t cls = commandSizeClass(size);
+  if (cls == kCommandNumClasses) {
+    return ::operator new(size);
+  }
+  CommandMagazine& magazine = commandMagazine;
+  if (magazine.closed_) {
+    void* block = nullptr;
+    return (commandDepot().Get(cls, &block, 1) != 0) ? block :
+                                                      ::operator new(kCommandSizeClass[cls]);
+  }
+  if (magazine.count_[cls] == 0) {
+    // Refill half of the magazine, so the next free doesn't have to go to the depot
+    magazine.count_[cls] = commandDepot().Get(cls, magazine.blocks_[cls], kCommandMagazineSize / 2);
+    if (magazine.count_[cls] == 0) {
+      return ::operator new(kCommandSizeClass[cls]);
+    }
+  }
+  return magazine.blocks_[cls][--magazine.count_[cls]];
+}
+
+// ================================================================================================
+void Command::operator delete(void* ptr, size_t size) {
+  uint32_t cls = commandSizeClass(size);
+  if (cls == kCommandNumClasses) {
+    ::operator delete(ptr);
+    return;
+  }
+  CommandMagazine& magazine = commandMagazine;
+  if (magazine.closed_) {
+    commandDepot().Put(cls, &ptr, 1);
+    return;
+  }
+  if (magazine.count_[cls] == kCommandMagazineSize) {
+    // Return the older half of the magazine to the depot for the allocating threads
+    constexpr uint32_t kHalf = kCommandMagazineSize / 2;
+    commandDepot().Put(cls, magazine.blocks_[cls], kHalf);
+    std::memmove(magazine.blocks_[cls], &magazine.blocks_[cls][kHalf], kHalf * sizeof(void*));
+    magazine.count_[cls] = kHalf;
+  }
+  magazine.blocks_[cls][magazine.count_[cls]++] = ptr;
+}
+
 // ================================================================================================
 Command::Command(HostQueue& queue, cl_command_type type,
                  const EventWaitList& eventWaitList, uint32_t commandWaitBits, const Event* waitingEvent)
@@ -323,7 +469,16 @@ Command::Command(HostQueue& queue, cl_command_type type,
   for (const auto &event: eventWaitList) {
     event->retain();
   }
-  if (type != 0) activity_.Initialize(type, queue.vdev()->index(), queue.device().index());
+  if (type != 0) {
+    activity_.Initialize(type, queue.vdev()->index(), queue.device().index());
+    // The profiler enables the queue profiling, but it needs the timestamps of the sampled
+    // commands only. The commands outside of the sample skip the profiling signals.
+    if (IS_HIP && activity_prof::ActivityProf::IsSampling() && IS_PROFILER_ON &&
+        !activity_.IsEnabled() && !HIP_FORCE_QUEUE_PROFILING &&
+        !Agent::shouldPostEventEvents() && !Timeline::enabled()) {
+      profilingInfo_.enabled_ = false;
+    }
+  }
 }
 
 // ================================================================================================
@@ -340,6 +495,9 @@ static constexpr uint32_t kMarkerTsCount = 64;
 // ================================================================================================
 void Command::enqueue() {
   assert(queue_ != NULL && "Cannot be enqueued");
+  // Save the time before the submission, since the command may complete before the return
+  const uint64_t enqueueTime = LatencyStats::start();
+  enqueueTime_ = enqueueTime;
 
   if (Agent::shouldPostEventEvents() && type_ != 0) {
     Agent::postEventCreate(as_cl(static_cast<Event*>(this)), type_);
@@ -352,6 +510,9 @@ void Command::enqueue() {
   if (AMD_DIRECT_DISPATCH) {
     setStatus(CL_QUEUED);
 
+    // The implied waits don't need a notification in the producer queue and a GPU barrier
+    elideImpliedWaits();
+
     // Notify all commands about the waiter. Barrier will be sent in order to obtain
     // HSA signal for a wait on the current queue
     for (const auto &event: eventWaitList()) {
@@ -361,6 +522,7 @@ void Command::enqueue() {
     // The batch update must be lock protected to avoid a race condition
     // when multiple threads submit/flush/update the batch at the same time
     ScopedLock sl(queue_->vdev()->execution());
+    queue_->AssignQueueSeq(*this);
     queue_->FormSubmissionBatch(this);
 
     bool isMarker = (type() == CL_COMMAND_MARKER || type() == 0);
@@ -402,6 +564,27 @@ void Command::enqueue() {
 
   // set this queue status is active
   queue_->SetQueueStatus();
+  queue_->device().latencyStats().record(LatencyStats::Enqueue, enqueueTime);
+}
+
+// ================================================================================================
+void Command::elideImpliedWaits() {
+  if (eventWaitList_.empty()) {
+    return;
+  }
+  auto it = std::remove_if(eventWaitList_.begin(), eventWaitList_.end(),
+                           [this](Event* event) { return queue_->isWaitImplied(*event); });
+  for (auto pruned = it; pruned != eventWaitList_.end(); ++pruned) {
+    ClPrint(LOG_DEBUG, LOG_CMD, "Command (%s) %p elides the wait for event: %p",
+            getOclCommandKindString(type()), this, *pruned);
+    (*pruned)->release();
+  }
+  eventWaitList_.erase(it, eventWaitList_.end());
+
+  // The remaining waits order this queue after the producers
+  for (const auto& event : eventWaitList_) {
+    queue_->recordWait(*event);
+  }
 }
 
 // ================================================================================================
@@ -422,7 +605,10 @@ NDRangeKernelCommand::NDRangeKernelCommand(HostQueue& queue, const EventWaitList
     numGrids_(numGrids),
     prevGridSum_(prevGridSum),
     allGridSum_(allGridSum),
-    firstDevice_(firstDevice) {
+    firstDevice_(firstDevice),
+    capturing_(false),
+    aqlPacket_(nullptr),
+    kernArgs_(nullptr) {
   auto& device = queue.device();
   auto devKernel = const_cast<device::Kernel*>(kernel.getDeviceKernel(device));
   profilingInfo_.setCallback(devKernel->getProfilingCallback(
@@ -663,6 +849,21 @@ int32_t NDRangeKernelCommand::captureAndValidate() {
   return error;
 }
 
+int32_t NDRangeKernelCommand::captureAndValidate(const void* const* args,
+                                                 const_address kernargs) {
+  const amd::Device& device = queue()->device();
+  if (!queue()->device().validateKernel(kernel(), queue()->vdev(), cooperativeGroups())) {
+    return CL_OUT_OF_RESOURCES;
+  }
+
+  int32_t error;
+  uint64_t lclMemSize = kernel().getDeviceKernel(device)->workGroupInfo()->localMemSize_;
+  parameters_ = kernel().parameters().captureDirect(*queue()->vdev(),
+                                                    sharedMemBytes_ + lclMemSize, args,
+                                                    kernargs, &error);
+  return error;
+}
+
 bool ExtObjectsCommand::validateMemory() {
   // Always process GL objects, even if deferred allocations are disabled,
   // because processGLResource() calls OGL Acquire().
@@ -723,16 +924,42 @@ bool ThreadTraceMemObjectsCommand::validateMemory() {
 }
 
 void TransferBufferFileCommand::releaseResources() {
-  for (uint i = 0; i < NumStagingBuffers; ++i) {
-    if (NULL != staging_[i]) {
-      staging_[i]->release();
+  // The staging buffers can't go away with a file I/O in flight
+  finishFileIo();
+  for (auto it : staging_) {
+    if (NULL != it) {
+      it->release();
     }
   }
+  file_->release();
 
   // Call the parent
   OneMemoryArgCommand::releaseResources();
 }
 
+void TransferBufferFileCommand::startFileIo(uint idx, void* host, size_t fileOffset,
+                                            size_t size) {
+  // The read is a write into the staging buffer
+  const bool writeBuffer = (type() == CL_COMMAND_READ_SSG_FILE_AMD);
+  const size_t bufferSize = staging_[idx]->getSize();
+  const LiquidFlashFile* file = file_;
+  fileIo_[idx] = std::async(std::launch::async, [=]() {
+    return file->transferBlock(writeBuffer, host, bufferSize, fileOffset, 0, size);
+  });
+}
+
+bool TransferBufferFileCommand::finishFileIo(uint idx) {
+  return fileIo_[idx].valid() ? fileIo_[idx].get() : true;
+}
+
+bool TransferBufferFileCommand::finishFileIo() {
+  bool result = true;
+  for (uint i = 0; i < fileIo_.size(); ++i) {
+    result &= finishFileIo(i);
+  }
+  return result;
+}
+
 void TransferBufferFileCommand::submit(device::VirtualDevice& device) {
   device::Memory* mem = memory_->getDeviceMemory(queue()->device());
   if (memory_->getMemFlags() &
@@ -768,10 +995,15 @@ bool TransferBufferFileCommand::validateMemory() {
   // Check if the destination buffer has direct host access
   if (!(memory_->getMemFlags() &
         (CL_MEM_USE_HOST_PTR | CL_MEM_ALLOC_HOST_PTR | CL_MEM_USE_PERSISTENT_MEM_AMD))) {
-    // Allocate staging buffers
-    for (uint i = 0; i < NumStagingBuffers; ++i) {
+    // Allocate the ring of staging buffers, but not more than the transfer needs
+    const size_t numChunks = (size_[0] + stagingSize() - 1) / stagingSize();
+    const uint numStaging = static_cast<uint>(
+        std::min<size_t>(std::max<uint>(GPU_FILE_STAGING_DEPTH, 1), numChunks));
+    staging_.resize(numStaging, nullptr);
+    fileIo_.resize(numStaging);
+    for (uint i = 0; i < numStaging; ++i) {
       staging_[i] = new (memory_->getContext())
-          Buffer(memory_->getContext(), StagingBufferMemType, StagingBufferSize);
+          Buffer(memory_->getContext(), StagingBufferMemType, stagingSize());
       if (NULL == staging_[i] || !staging_[i]->create(nullptr)) {
         DevLogPrintfError("Staging Create failed, Staging[%d]: 0x%x", i, staging_[i]);
         return false;
@@ -38,6 +38,7 @@
 #include "platform/kernel.hpp"
 #include "device/device.hpp"
 #include "utils/concurrent.hpp"
+#include "utils/small_vector.hpp"
 #include "platform/memory.hpp"
 #include "platform/perfctr.hpp"
 #include "platform/threadtrace.hpp"
@@ -49,6 +50,7 @@
 #include <algorithm>
 #include <atomic>
 #include <functional>
+#include <future>
 #include <vector>
 
 namespace amd {
@@ -85,7 +87,8 @@ class Event : public RuntimeObject {
   };
 
  public:
-  typedef std::vector<Event*> EventWaitList;
+  //! Most commands wait for a few events, so the list keeps them inline
+  typedef SmallVector<Event*, 4> EventWaitList;
 
  private:
   Monitor lock_;
@@ -177,6 +180,9 @@ class Event : public RuntimeObject {
   //! Return the profiling info.
   const ProfilingInfo& profilingInfo() const { return profilingInfo_; }
 
+  //! Return the activity profiling of this event
+  const activity_prof::ActivityProf& activity() const { return activity_; }
+
   //! Return this command's execution status.
   int32_t status() const { return status_.load(std::memory_order_relaxed); }
 
@@ -249,6 +255,8 @@ class Command : public Event {
   cl_command_type     type_;      //!< This command's OpenCL type.
   void* data_;
   const Event* waitingEvent_;     //!< Waiting event associated with the marker
+  std::atomic<uint64_t> queueSeq_{0}; //!< Execution order in the queue, 0 if not submitted yet
+  uint64_t enqueueTime_ = 0;      //!< Enqueue time for the latency stats, 0 if not recorded
 
  protected:
   bool cpu_wait_ = false;         //!< If true, then the command was issued for CPU/GPU sync
@@ -286,9 +294,18 @@ class Command : public Event {
   }
 
  public:
+  //! Allocate the command storage from the size class pool
+  void* operator new(size_t size);
+  //! Return the command storage to the size class pool.
+  //! \note The virtual destructor guarantees the size of the dynamic type
+  void operator delete(void* ptr, size_t size);
+
   //! Return the queue this command is enqueued into.
   HostQueue* queue() const { return queue_; }
 
+  //! Returns the enqueue time for the latency stats, 0 if not recorded
+  uint64_t enqueueTime() const { return enqueueTime_; }
+
   //! Enqueue this command into the associated command queue.
   void enqueue();
 
@@ -351,6 +368,15 @@ class Command : public Event {
 
   //! Check if this command(should be a marker) requires CPU wait
   bool CpuWaitRequested() const { return cpu_wait_; }
+
+  //! Returns the execution order of the command in the queue, 0 if it wasn't submitted yet
+  uint64_t queueSeq() const { return queueSeq_.load(std::memory_order_acquire); }
+
+  //! Sets the execution order of the command in the queue
+  void setQueueSeq(uint64_t seq) { queueSeq_.store(seq, std::memory_order_release); }
+
+  //! Drops the waits, implied by the in-order execution, from the wait list
+  void elideImpliedWaits();
 };
 
 class UserEvent : public Command {
@@ -1050,6 +1076,9 @@ class NDRangeKernelCommand : public Command {
   uint64_t prevGridSum_;    //!< A sum of previous grids to the current launch
   uint64_t allGridSum_;     //!< A sum of all grids in multi GPU launch
   uint32_t firstDevice_;    //!< Device index of the first device in the grid
+  bool capturing_;          //!< The dispatch packet is captured instead of the HW submission
+  address aqlPacket_;       //!< Storage for the captured AQL dispatch packet
+  address kernArgs_;        //!< Storage for the captured kernel arguments
 
  public:
   enum {
@@ -1121,6 +1150,27 @@ class NDRangeKernelCommand : public Command {
   void setLocalWorkSize(const NDRange& local) { sizes_.local() = local; }
 
   int32_t captureAndValidate();
+  //! Captures the arguments straight from \a args or \a kernargs, see
+  //! KernelParameters::captureDirect()
+  int32_t captureAndValidate(const void* const* args, const_address kernargs);
+
+  //! Enables AQL packet capture. The device layer builds the dispatch packet into \a aqlPacket
+  //! and the kernel arguments into \a kernArgs, but doesn't submit it. The device layer resets
+  //! the capturing state if the dispatch can't be captured.
+  void setCapturingState(bool state, address aqlPacket = nullptr, address kernArgs = nullptr) {
+    capturing_ = state;
+    aqlPacket_ = aqlPacket;
+    kernArgs_ = kernArgs;
+  }
+
+  //! Returns TRUE if the dispatch packet must be captured
+  bool getCapturingState() const { return capturing_; }
+
+  //! Returns the storage for the captured AQL packet
+  address getAqlPacket() const { return aqlPacket_; }
+
+  //! Returns the storage for the captured kernel arguments
+  address getCapturedKernArgs() const { return kernArgs_; }
 };
 
 class NativeFnCommand : public Command {
@@ -1159,11 +1209,11 @@ class ExternalSemaphoreCmd : public Command {
 
  private:
   const void* sem_ptr_; //!< Pointer to external semaphore
-  int fence_;           //!< semaphore value to be set
+  uint64_t fence_;      //!< semaphore value to be set
   ExternalSemaphoreCmdType cmd_type_; //!< Signal or Wait semaphore command
 
  public:
-  ExternalSemaphoreCmd(HostQueue& queue, const void* sem_ptr, int fence,
+  ExternalSemaphoreCmd(HostQueue& queue, const void* sem_ptr, uint64_t fence,
                        ExternalSemaphoreCmdType cmd_type)
       : Command::Command(queue, CL_COMMAND_USER), sem_ptr_(sem_ptr), fence_(fence), cmd_type_(cmd_type) {}
 
@@ -1171,7 +1221,7 @@ class ExternalSemaphoreCmd : public Command {
     device.submitExternalSemaphoreCmd(*this);
   }
   const void* sem_ptr() const { return sem_ptr_; }
-  const int fence() { return fence_; }
+  const uint64_t fence() { return fence_; }
   const ExternalSemaphoreCmdType semaphoreCmd() { return cmd_type_; }
 
 };
@@ -1601,16 +1651,15 @@ class SvmUnmapMemoryCommand : public Command {
  */
 class TransferBufferFileCommand : public OneMemoryArgCommand {
  public:
-  static constexpr uint NumStagingBuffers = 2;
-  static constexpr size_t StagingBufferSize = 4 * Mi;
   static constexpr uint StagingBufferMemType = CL_MEM_USE_PERSISTENT_MEM_AMD;
 
  protected:
-  const Coord3D origin_;                     //!< Origin of the region to write to
-  const Coord3D size_;                       //!< Size of the region to write to
-  LiquidFlashFile* file_;                    //!< The file object for data read
-  size_t fileOffset_;                        //!< Offset in the file for data read
-  amd::Memory* staging_[NumStagingBuffers];  //!< Staging buffers for transfer
+  const Coord3D origin_;                  //!< Origin of the region to write to
+  const Coord3D size_;                    //!< Size of the region to write to
+  LiquidFlashFile* file_;                 //!< The file object for data read
+  size_t fileOffset_;                     //!< Offset in the file for data read
+  std::vector<amd::Memory*> staging_;     //!< Ring of the staging buffers for transfer
+  std::vector<std::future<bool>> fileIo_; //!< The file I/O in flight per staging buffer
 
  public:
   TransferBufferFileCommand(cl_command_type type, HostQueue& queue,
@@ -1624,9 +1673,8 @@ class TransferBufferFileCommand : public OneMemoryArgCommand {
         fileOffset_(fileOffset) {
     // Sanity checks
     assert(size.c[0] > 0 && "invalid");
-    for (uint i = 0; i < NumStagingBuffers; ++i) {
-      staging_[i] = NULL;
-    }
+    // The file must stay open until the transfer is done
+    file_->retain();
   }
 
   virtual void releaseResources();
@@ -1650,6 +1698,23 @@ class TransferBufferFileCommand : public OneMemoryArgCommand {
   //! Return the staging buffer for transfer
   Memory& staging(uint i) const { return *staging_[i]; }
 
+  //! Returns the number of the staging buffers in the ring
+  uint numStaging() const { return static_cast<uint>(staging_.size()); }
+
+  //! Returns the size of a staging buffer, the transfer chunk size
+  static size_t stagingSize() {
+    return std::max<size_t>(GPU_FILE_STAGING_SIZE, 1) * Mi;
+  }
+
+  //! Starts the file I/O of a chunk in staging buffer \a idx, mapped at \a host
+  void startFileIo(uint idx, void* host, size_t fileOffset, size_t size);
+
+  //! Waits for the file I/O of staging buffer \a idx, returns false on a failure
+  bool finishFileIo(uint idx);
+
+  //! Waits for the file I/O of all staging buffers, returns false on a failure
+  bool finishFileIo();
+
   bool validateMemory();
 };
 
@@ -1699,43 +1764,138 @@ class SvmPrefetchAsyncCommand : public Command {
   size_t cpu_access() const { return cpu_access_; }
 };
 
+//! The size of a single AQL packet in bytes
+constexpr static size_t kAqlPacketSize = 64;
+
+/*! \brief  Submits a block of the previously captured AQL packets.
+ *
+ *  \details The packets and their kernel arguments are owned by the caller and
+ *  must stay valid until the command completes.
+ */
+class AccumulateCommand : public Command {
+ private:
+  const_address packets_;  //!< Contiguous block of AQL packets
+  size_t numPackets_;      //!< The number of packets in the block
+
+ public:
+  AccumulateCommand(HostQueue& queue, const EventWaitList& eventWaitList,
+                    const_address packets, size_t numPackets)
+      : Command(queue, CL_COMMAND_TASK, eventWaitList),
+        packets_(packets),
+        numPackets_(numPackets) {}
+
+  virtual void submit(device::VirtualDevice& device) { device.submitAccumulate(*this); }
+
+  //! Returns the block of AQL packets
+  const_address packets() const { return packets_; }
+
+  //! Returns the number of AQL packets
+  size_t numPackets() const { return numPackets_; }
+};
+
 /*! \brief  A virtual map memory command.
  *
  */
 
 class VirtualMapCommand : public Command {
+ public:
+  //! A single virtual address range for the map or unmap
+  struct Range {
+    const void* ptr_;  //!< Virtual address to map to the memory
+    size_t size_;      //!< Size of the mapping in bytes
+    Memory* memory_;   //!< Memory to map, nullptr means unmap
+  };
+
  private:
-  const void* ptr_;     //!< Virtual address to map to the memory
-  size_t size_;         //!< Size of the mapping in bytes
-  Memory* memory_;      //!< Memory to map, nullptr means unmap
+  std::vector<Range> ranges_;  //!< The ranges, remapped by the command in one update
 
  public:
   //! Construct a new VirtualMapCommand
   VirtualMapCommand(HostQueue& queue, const EventWaitList& eventWaitList,
                    void* ptr, size_t size, Memory* memory)
+      : VirtualMapCommand(queue, eventWaitList, std::vector<Range>{{ptr, size, memory}}) {}
+
+  //! Construct a new VirtualMapCommand, which maps or unmaps several ranges at once
+  VirtualMapCommand(HostQueue& queue, const EventWaitList& eventWaitList,
+                   std::vector<Range>&& ranges)
       : Command(queue, 1, eventWaitList),
-        ptr_(ptr),
-        size_(size),
-        memory_(memory) {
+        ranges_(std::move(ranges)) {
     // Sanity checks
-    assert(size > 0 && "invalid");
-    if (memory_) memory_->retain();
+    assert(!ranges_.empty() && "invalid");
+    for (const auto& range : ranges_) {
+      assert(range.size_ > 0 && "invalid");
+      if (range.memory_) range.memory_->retain();
+    }
   }
 
   virtual void releaseResources() {
-    if (memory_) memory_->release();
-    DEBUG_ONLY(memory_ = nullptr);
+    for (auto& range : ranges_) {
+      if (range.memory_) range.memory_->release();
+      DEBUG_ONLY(range.memory_ = nullptr);
+    }
     Command::releaseResources();
   }
 
   virtual void submit(device::VirtualDevice& device) { device.submitVirtualMap(*this); }
 
-  //! Read the memory object
-  Memory* memory() const { return memory_; }
-  //! Read the size
-  size_t size() const { return size_; }
-  //! Read the pointer
-  const void* ptr() const { return ptr_; }
+  //! Read the memory object of the first range
+  Memory* memory() const { return ranges_[0].memory_; }
+  //! Read the size of the first range
+  size_t size() const { return ranges_[0].size_; }
+  //! Read the pointer of the first range
+  const void* ptr() const { return ranges_[0].ptr_; }
+  //! Read all ranges of the command
+  const std::vector<Range>& ranges() const { return ranges_; }
+};
+
+/*! \brief      Copies a list of independent linear buffer ranges in one command.
+ *
+ *  \details    The device can execute all ranges with a single dispatch, which avoids
+ *              the launch overhead of one command per small copy.
+ */
+class CopyMemoryBatchCommand : public Command {
+ public:
+  //! A single linear copy of the batch
+  struct Range {
+    Memory* src_;       //!< Memory to read from
+    size_t srcOffset_;  //!< Offset in bytes in the source memory
+    Memory* dst_;       //!< Memory to write to
+    size_t dstOffset_;  //!< Offset in bytes in the destination memory
+    size_t size_;       //!< Number of bytes to copy
+  };
+
+ private:
+  std::vector<Range> ranges_;  //!< The copies of the batch
+
+ public:
+  //! Construct a new CopyMemoryBatchCommand
+  CopyMemoryBatchCommand(HostQueue& queue, const EventWaitList& eventWaitList,
+                         std::vector<Range>&& ranges)
+      : Command(queue, CL_COMMAND_COPY_BUFFER, eventWaitList),
+        ranges_(std::move(ranges)) {
+    // Sanity checks
+    assert(!ranges_.empty() && "invalid");
+    for (const auto& range : ranges_) {
+      assert((range.src_ != nullptr) && (range.dst_ != nullptr) && (range.size_ > 0) &&
+             "invalid");
+      range.src_->retain();
+      range.dst_->retain();
+    }
+  }
+
+  virtual void releaseResources() {
+    for (auto& range : ranges_) {
+      range.src_->release();
+      range.dst_->release();
+      DEBUG_ONLY(range.src_ = range.dst_ = nullptr);
+    }
+    Command::releaseResources();
+  }
+
+  virtual void submit(device::VirtualDevice& device) { device.submitCopyMemoryBatch(*this); }
+
+  //! Read all ranges of the command
+  const std::vector<Range>& ranges() const { return ranges_; }
 };
 
 /*! @}
@@ -0,0 +1,359 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "platform/commandbuffer.hpp"
+#include "platform/context.hpp"
+#include "device/device.hpp"
+
+#include <algorithm>
+
+namespace amd {
+
+// ================================================================================================
+CommandBuffer::CommandBuffer(HostQueue& queue)
+    : queue_(queue),
+      state_(Recording),
+      kernArgPool_(nullptr),
+      kernArgPoolSize_(0),
+      lastCommand_(nullptr),
+      lock_("Command buffer lock", true) {
+  queue_.retain();
+}
+
+// ================================================================================================
+CommandBuffer::~CommandBuffer() {
+  releasePackets();
+  for (auto& it : records_) {
+    if (it.kernel_ != nullptr) {
+      it.kernel_->release();
+    }
+    if (it.src_ != nullptr) {
+      it.src_->release();
+    }
+    if (it.dst_ != nullptr) {
+      it.dst_->release();
+    }
+  }
+  queue_.release();
+}
+
+// ================================================================================================
+int32_t CommandBuffer::recordKernel(const Kernel& kernel, const NDRangeContainer& sizes,
+                                    uint32_t* index) {
+  ScopedLock lock(lock_);
+  if (state_ != Recording) {
+    return CL_INVALID_OPERATION;
+  }
+  Record record = {};
+  record.type_ = CL_COMMAND_NDRANGE_KERNEL;
+  // The copy keeps the current arguments, hence the application may change them freely
+  record.kernel_ = new Kernel(kernel);
+  if (record.kernel_ == nullptr) {
+    return CL_OUT_OF_HOST_MEMORY;
+  }
+  record.dims_ = sizes.dimensions();
+  for (size_t i = 0; i < record.dims_; ++i) {
+    record.offset_[i] = sizes.offset()[i];
+    record.global_[i] = sizes.global()[i];
+    record.local_[i] = sizes.local()[i];
+  }
+  if (index != nullptr) {
+    *index = static_cast<uint32_t>(records_.size());
+  }
+  records_.push_back(record);
+  return CL_SUCCESS;
+}
+
+// ================================================================================================
+int32_t CommandBuffer::recordCopy(Memory& src, Memory& dst, size_t srcOffset, size_t dstOffset,
+                                  size_t size, uint32_t* index) {
+  ScopedLock lock(lock_);
+  if (state_ != Recording) {
+    return CL_INVALID_OPERATION;
+  }
+  Record record = {};
+  record.type_ = CL_COMMAND_COPY_BUFFER;
+  record.src_ = &src;
+  record.dst_ = &dst;
+  record.srcOffset_ = srcOffset;
+  record.dstOffset_ = dstOffset;
+  record.size_ = size;
+  src.retain();
+  dst.retain();
+  if (index != nullptr) {
+    *index = static_cast<uint32_t>(records_.size());
+  }
+  records_.push_back(record);
+  return CL_SUCCESS;
+}
+
+// ================================================================================================
+int32_t CommandBuffer::recordFill(Memory& memory, const void* pattern, size_t patternSize,
+                                  size_t offset, size_t size, uint32_t* index) {
+  ScopedLock lock(lock_);
+  if (state_ != Recording) {
+    return CL_INVALID_OPERATION;
+  }
+  if (patternSize > FillMemoryCommand::MaxFillPatterSize) {
+    return CL_INVALID_VALUE;
+  }
+  Record record = {};
+  record.type_ = CL_COMMAND_FILL_BUFFER;
+  record.src_ = &memory;
+  record.srcOffset_ = offset;
+  record.size_ = size;
+  memcpy(record.pattern_, pattern, patternSize);
+  record.patternSize_ = patternSize;
+  memory.retain();
+  if (index != nullptr) {
+    *index = static_cast<uint32_t>(records_.size());
+  }
+  records_.push_back(record);
+  return CL_SUCCESS;
+}
+
+// ================================================================================================
+int32_t CommandBuffer::finalize() {
+  ScopedLock lock(lock_);
+  if (state_ != Recording) {
+    return CL_INVALID_OPERATION;
+  }
+  state_ = Executable;
+  if (OCL_COMMAND_BUFFER_PACKETS && queue_.vdev()->packetCaptureSupported() &&
+      !capturePackets()) {
+    ClPrint(LOG_INFO, LOG_CODE, "Command buffer %p is replayed with the commands", this);
+  }
+  return CL_SUCCESS;
+}
+
+// ================================================================================================
+bool CommandBuffer::capturePackets() {
+  const Device& device = queue_.device();
+  size_t size = 0;
+  for (auto& it : records_) {
+    if (it.type_ != CL_COMMAND_NDRANGE_KERNEL) {
+      return false;
+    }
+    const device::Kernel* devKernel = it.kernel_->getDeviceKernel(device);
+    size = alignUp(size, std::max<size_t>(devKernel->KernargSegmentAlignment(), 1));
+    it.kernArgOffset_ = size;
+    size += devKernel->KernargSegmentByteSize();
+  }
+  if (records_.empty()) {
+    return false;
+  }
+
+  kernArgPoolSize_ = std::max<size_t>(size, 1);
+  kernArgPool_ = reinterpret_cast<address>(
+      device.hostAlloc(kernArgPoolSize_, 0, Device::MemorySegment::kKernArg));
+  if (kernArgPool_ == nullptr) {
+    kernArgPoolSize_ = 0;
+    return false;
+  }
+  aqlPackets_.resize(records_.size() * kAqlPacketSize);
+  for (size_t i = 0; i < records_.size(); ++i) {
+    if (!capturePacket(i)) {
+      releasePackets();
+      return false;
+    }
+  }
+  return true;
+}
+
+// ================================================================================================
+bool CommandBuffer::capturePacket(size_t index) {
+  Record& record = records_[index];
+  NDRangeContainer sizes(record.dims_, record.offset_, record.global_, record.local_);
+  Command::EventWaitList eventWaitList;
+  NDRangeKernelCommand* command =
+      new NDRangeKernelCommand(queue_, eventWaitList, *record.kernel_, sizes);
+  if (command == nullptr) {
+    return false;
+  }
+  if (command->captureAndValidate() != CL_SUCCESS) {
+    delete command;
+    return false;
+  }
+  command->setCapturingState(true, &aqlPackets_[index * kAqlPacketSize],
+                             kernArgPool_ + record.kernArgOffset_);
+  // The device layer only builds the packet, hence the command never reaches the HW queue
+  command->submit(*queue_.vdev());
+  const bool captured = command->getCapturingState();
+  command->releaseResources();
+  command->release();
+  return captured;
+}
+
+// ================================================================================================
+void CommandBuffer::waitLastCommand() {
+  if (lastCommand_ != nullptr) {
+    lastCommand_->awaitCompletion();
+    lastCommand_->release();
+    lastCommand_ = nullptr;
+  }
+}
+
+// ================================================================================================
+void CommandBuffer::releasePackets() {
+  waitLastCommand();
+  if (kernArgPool_ != nullptr) {
+    queue_.device().hostFree(kernArgPool_, kernArgPoolSize_);
+    kernArgPool_ = nullptr;
+    kernArgPoolSize_ = 0;
+  }
+  aqlPackets_.clear();
+}
+
+// ================================================================================================
+int32_t CommandBuffer::enqueue(const Command::EventWaitList& eventWaitList, Command** command) {
+  ScopedLock lock(lock_);
+  if (state_ != Executable) {
+    return CL_INVALID_OPERATION;
+  }
+  *command = nullptr;
+
+  if (!aqlPackets_.empty()) {
+    Command* replay =
+        new AccumulateCommand(queue_, eventWaitList, aqlPackets_.data(), records_.size());
+    if (replay == nullptr) {
+      return CL_OUT_OF_HOST_MEMORY;
+    }
+    replay->enqueue();
+    // The last replay is tracked, since all replays share the same kernel arguments
+    if (lastCommand_ != nullptr) {
+      lastCommand_->release();
+    }
+    replay->retain();
+    lastCommand_ = replay;
+    *command = replay;
+    return CL_SUCCESS;
+  }
+
+  if (records_.empty()) {
+    // An empty buffer still completes after the wait list
+    Command* marker = new Marker(queue_, true, eventWaitList);
+    if (marker == nullptr) {
+      return CL_OUT_OF_HOST_MEMORY;
+    }
+    marker->enqueue();
+    *command = marker;
+    return CL_SUCCESS;
+  }
+
+  // The queue is in order, hence only the first command waits for the events
+  const Command::EventWaitList noWait;
+  const Command::EventWaitList* waitList = &eventWaitList;
+  Command* last = nullptr;
+  int32_t result = CL_SUCCESS;
+  for (auto& it : records_) {
+    Command* cmd = nullptr;
+    if (it.type_ == CL_COMMAND_NDRANGE_KERNEL) {
+      NDRangeContainer sizes(it.dims_, it.offset_, it.global_, it.local_);
+      NDRangeKernelCommand* kernelCmd =
+          new NDRangeKernelCommand(queue_, *waitList, *it.kernel_, sizes);
+      if (kernelCmd == nullptr) {
+        result = CL_OUT_OF_HOST_MEMORY;
+        break;
+      }
+      result = kernelCmd->captureAndValidate();
+      if (result != CL_SUCCESS) {
+        delete kernelCmd;
+        break;
+      }
+      cmd = kernelCmd;
+    } else if (it.type_ == CL_COMMAND_COPY_BUFFER) {
+      CopyMemoryCommand* copyCmd =
+          new CopyMemoryCommand(queue_, CL_COMMAND_COPY_BUFFER, *waitList, *it.src_, *it.dst_,
+                                Coord3D(it.srcOffset_, 0, 0), Coord3D(it.dstOffset_, 0, 0),
+                                Coord3D(it.size_, 1, 1));
+      if (copyCmd == nullptr) {
+        result = CL_OUT_OF_HOST_MEMORY;
+        break;
+      }
+      // Make sure we have memory for the command execution
+      if (!copyCmd->validateMemory()) {
+        delete copyCmd;
+        result = CL_MEM_OBJECT_ALLOCATION_FAILURE;
+        break;
+      }
+      cmd = copyCmd;
+    } else {
+      // surface takes [pitch, width, height]
+      FillMemoryCommand* fillCmd =
+          new FillMemoryCommand(queue_, CL_COMMAND_FILL_BUFFER, *waitList, *it.src_, it.pattern_,
+                                it.patternSize_, Coord3D(it.srcOffset_, 0, 0),
+                                Coord3D(it.size_, 1, 1), Coord3D(it.size_, it.size_, 1));
+      if (fillCmd == nullptr) {
+        result = CL_OUT_OF_HOST_MEMORY;
+        break;
+      }
+      if (!fillCmd->validateMemory()) {
+        delete fillCmd;
+        result = CL_MEM_OBJECT_ALLOCATION_FAILURE;
+        break;
+      }
+      cmd = fillCmd;
+    }
+    cmd->enqueue();
+    if (last != nullptr) {
+      last->release();
+    }
+    last = cmd;
+    waitList = &noWait;
+  }
+  if (result != CL_SUCCESS) {
+    // The commands before the failure are in the queue already
+    if (last != nullptr) {
+      last->release();
+    }
+    return result;
+  }
+  *command = last;
+  return CL_SUCCESS;
+}
+
+// ================================================================================================
+Kernel* CommandBuffer::kernel(uint32_t index) const {
+  if (index >= records_.size()) {
+    return nullptr;
+  }
+  return records_[index].kernel_;
+}
+
+// ================================================================================================
+int32_t CommandBuffer::updateKernel(uint32_t index) {
+  ScopedLock lock(lock_);
+  if (kernel(index) == nullptr) {
+    return CL_INVALID_VALUE;
+  }
+  if (aqlPackets_.empty()) {
+    // The commands are recreated on every enqueue, hence nothing to patch
+    return CL_SUCCESS;
+  }
+  // The replays in flight read the same packets and kernel arguments
+  waitLastCommand();
+  if (!capturePacket(index)) {
+    // Fall back to the commands, which always pick the new arguments
+    releasePackets();
+  }
+  return CL_SUCCESS;
+}
+
+}  // namespace amd
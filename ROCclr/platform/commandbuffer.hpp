@@ -0,0 +1,122 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef COMMANDBUFFER_HPP_
+#define COMMANDBUFFER_HPP_
+
+#include "top.hpp"
+#include "platform/command.hpp"
+#include "platform/commandqueue.hpp"
+#include "platform/kernel.hpp"
+#include "thread/monitor.hpp"
+
+#include <vector>
+
+namespace amd {
+
+/*! \brief A recorded sequence of commands, replayed on one in-order queue
+ *
+ *  The recorded kernels are private copies, so the later clSetKernelArg() calls on the
+ *  application kernel don't change the recording. A buffer of kernels only is captured
+ *  into AQL packets on finalize() and replayed with a single AccumulateCommand, the same
+ *  way as a kernel only hipGraphExec. Other buffers recreate the commands on every enqueue.
+ */
+class CommandBuffer : public RuntimeObject {
+ public:
+  enum State { Recording = 0, Executable };
+
+  explicit CommandBuffer(HostQueue& queue);
+
+  //! Records a launch of \a kernel with its current arguments
+  int32_t recordKernel(const Kernel& kernel, const NDRangeContainer& sizes, uint32_t* index);
+
+  //! Records a buffer copy
+  int32_t recordCopy(Memory& src, Memory& dst, size_t srcOffset, size_t dstOffset, size_t size,
+                     uint32_t* index);
+
+  //! Records a buffer fill
+  int32_t recordFill(Memory& memory, const void* pattern, size_t patternSize, size_t offset,
+                     size_t size, uint32_t* index);
+
+  //! Ends the recording and captures the AQL packets, if the buffer has kernels only
+  int32_t finalize();
+
+  //! Enqueues the recorded commands after \a eventWaitList and returns the retained last one
+  int32_t enqueue(const Command::EventWaitList& eventWaitList, Command** command);
+
+  //! Returns the private kernel of the command \a index, nullptr if it isn't a kernel launch
+  Kernel* kernel(uint32_t index) const;
+
+  //! Applies the new arguments of kernel(\a index) to the captured packet
+  int32_t updateKernel(uint32_t index);
+
+  HostQueue& queue() const { return queue_; }
+  State state() const { return state_; }
+  size_t numCommands() const { return records_.size(); }
+
+  //! RTTI internal implementation
+  virtual ObjectType objectType() const { return ObjectTypeCommandBuffer; }
+
+ protected:
+  ~CommandBuffer();
+
+ private:
+  struct Record {
+    cl_command_type type_;     //!< CL_COMMAND_NDRANGE_KERNEL, COPY_BUFFER or FILL_BUFFER
+    Kernel* kernel_;           //!< Private copy of the kernel
+    size_t dims_;              //!< Number of the work dimensions
+    size_t offset_[3];         //!< Global work offset
+    size_t global_[3];         //!< Global work size
+    size_t local_[3];          //!< Local work size
+    Memory* src_;              //!< Copy source, or the filled memory
+    Memory* dst_;              //!< Copy destination
+    size_t srcOffset_;         //!< Copy source offset, or the fill offset
+    size_t dstOffset_;         //!< Copy destination offset
+    size_t size_;              //!< Copy or fill size
+    char pattern_[FillMemoryCommand::MaxFillPatterSize];  //!< Fill pattern
+    size_t patternSize_;       //!< Fill pattern size
+    size_t kernArgOffset_;     //!< Offset of the captured arguments in kernArgPool_
+  };
+
+  //! Captures the AQL packets of all records, returns false if any can't be captured
+  bool capturePackets();
+
+  //! Builds the AQL packet and the arguments of the record \a index
+  bool capturePacket(size_t index);
+
+  //! Waits for the last enqueue, since all replays share the packets and the arguments
+  void waitLastCommand();
+
+  //! Drops the captured packets
+  void releasePackets();
+
+  HostQueue& queue_;                 //!< The queue of the recording and the replays
+  std::vector<Record> records_;      //!< The recorded commands in the execution order
+  State state_;                      //!< Recording or Executable after finalize()
+  std::vector<uint8_t> aqlPackets_;  //!< Captured AQL packets, one per record
+  address kernArgPool_;              //!< Captured kernel arguments of all packets
+  size_t kernArgPoolSize_;           //!< The size of kernArgPool_
+  Command* lastCommand_;             //!< The last enqueued replay of the packets
+  Monitor lock_;                     //!< Serializes the updates and the enqueues
+};
+
+}  // namespace amd
+
+#endif  // COMMANDBUFFER_HPP_
@@ -23,6 +23,8 @@
 #include "device/device.hpp"
 #include "platform/context.hpp"
 
+#include <algorithm>
+
 /*!
  * \file commandQueue.cpp
  * \brief  Definitions for HostQueue object.
@@ -33,11 +35,26 @@
 
 namespace amd {
 
+//! The source of the unique queue ids
+static std::atomic<uint64_t> queueUid(0);
+
 HostQueue::HostQueue(Context& context, Device& device, cl_command_queue_properties properties,
-                     uint queueRTCUs, Priority priority, const std::vector<uint32_t>& cuMask)
+                     uint queueRTCUs, Priority priority, const std::vector<uint32_t>& cuMask,
+                     const BatchPolicy& batchPolicy)
     : CommandQueue(context, device, properties, device.info().queueProperties_, queueRTCUs,
                    priority, cuMask),
+      queue_(AMD_DIRECT_DISPATCH ? 2 : AMD_QUEUE_RING_SIZE),
+      lastEnqueueTime_(0),
+      enqueueInterval_(0),
       lastEnqueueCommand_(nullptr),
+      uid_(++queueUid),
+      queueSeq_(0),
+      waitLock_("HostQueue::waitLock"),
+      batchPolicy_(batchPolicy),
+      batchSize_(0),
+      batchStart_(0),
+      batchCount_(0),
+      batchCommands_(0),
       head_(nullptr),
       tail_(nullptr),
       isActive_(false),
@@ -75,11 +92,11 @@ bool HostQueue::terminate() {
           marker = new Marker(*this, false);
           if (marker != nullptr) {
             append(*marker);
-            queueLock_.notify();
           }
         }
       }
       if (marker != nullptr) {
+        flush();
         marker->awaitCompletion();
         marker->release();
       }
@@ -88,8 +105,8 @@ bool HostQueue::terminate() {
       {
         ScopedLock sl(queueLock_);
         thread_.acceptingCommands_ = false;
-        queueLock_.notify();
       }
+      flush();
 
       // FIXME_lmoriche: fix termination handshake
       while (thread_.state() < Thread::FINISHED) {
@@ -98,6 +115,11 @@ bool HostQueue::terminate() {
     }
   }
 
+  if (batchCount_ != 0) {
+    ClPrint(LOG_INFO, LOG_CMD, "Queue %p batch policy: %d, batches: %lu, average size: %.2f",
+            this, static_cast<int>(batchPolicy_.mode_), batchCount_.load(), averageBatchSize());
+  }
+
   if (Agent::shouldPostCommandQueueEvents()) {
     Agent::postCommandQueueFree(as_cl(this->asCommandQueue()));
   }
@@ -105,13 +127,14 @@ bool HostQueue::terminate() {
   return true;
 }
 
-void HostQueue::finish() {
+Command* HostQueue::finishCommand() {
   Command* command = nullptr;
   bool isCacheFlushed = device().IsCacheFlushed(Device::CacheState::kCacheStateSystem);
   if (IS_HIP) {
     command = getLastQueuedCommand(true);
     if (AMD_DIRECT_DISPATCH && isCacheFlushed && command == nullptr) {
-      return;
+      activityBuffer_.flush();
+      return nullptr;
     }
   }
   if (nullptr == command || !isCacheFlushed || vdev()->isHandlerPending()) {
@@ -121,17 +144,62 @@ void HostQueue::finish() {
     // Send a finish to make sure we finished all commands
     command = new Marker(*this, false);
     if (command == NULL) {
-      return;
+      return nullptr;
     }
     ClPrint(LOG_DEBUG, LOG_CMD, "Marker queued, Cache Flushed = %d", isCacheFlushed);
     command->enqueue();
   }
+  return command;
+}
+
+void HostQueue::finish() {
+  Command* command = finishCommand();
+  if (command == nullptr) {
+    return;
+  }
   // Check HW status of the ROCcrl event. Note: not all ROCclr modes support HW status
   static constexpr bool kWaitCompletion = true;
   if (!device().IsHwEventReady(command->event(), kWaitCompletion)) {
     ClPrint(LOG_DEBUG, LOG_CMD, "HW Event not ready, awaiting completion instead");
     command->awaitCompletion();
   }
+  finishDone(command);
+}
+
+void HostQueue::finishAll(const std::vector<HostQueue*>& queues) {
+  std::vector<std::pair<HostQueue*, Command*>> busy;
+  std::vector<Event*> events;
+  busy.reserve(queues.size());
+  events.reserve(queues.size());
+  for (auto queue : queues) {
+    Command* command = queue->finishCommand();
+    if (command != nullptr) {
+      busy.push_back({queue, command});
+      events.push_back(&command->event());
+    }
+  }
+  if (busy.empty()) {
+    return;
+  }
+  // A single wait for all queues of the device, if all commands have HW events
+  static constexpr bool kWaitCompletion = true;
+  const Device& device = busy[0].first->device();
+  bool sameDevice = std::all_of(busy.begin(), busy.end(), [&device](const auto& it) {
+    return &it.first->device() == &device;
+  });
+  if (!sameDevice || !device.WaitHwEvents(events)) {
+    for (auto& it : busy) {
+      if (!it.first->device().IsHwEventReady(it.second->event(), kWaitCompletion)) {
+        it.second->awaitCompletion();
+      }
+    }
+  }
+  for (auto& it : busy) {
+    it.first->finishDone(it.second);
+  }
+}
+
+void HostQueue::finishDone(Command* command) {
   command->release();
   if (IS_HIP) {
     ScopedLock sl(vdev()->execution());
@@ -141,9 +209,87 @@ void HostQueue::finish() {
       lastEnqueueCommand_ = nullptr;
     }
   }
+  // Deliver the activity records of the finished commands
+  activityBuffer_.flush();
   ClPrint(LOG_DEBUG, LOG_CMD, "All commands finished");
 }
 
+bool HostQueue::isWaitImplied(const Event& event) {
+  const Command& command = event.command();
+  HostQueue* producer = command.queue();
+  if ((producer == nullptr) || !isInOrder()) {
+    return false;
+  }
+  if (producer == this) {
+    return true;
+  }
+  uint64_t seq = command.queueSeq();
+  if ((seq == 0) || !producer->isInOrder()) {
+    return false;
+  }
+  ScopedLock l(waitLock_);
+  for (const auto& it : waited_) {
+    if (it.first == producer->uid_) {
+      return seq <= it.second;
+    }
+  }
+  return false;
+}
+
+void HostQueue::recordWait(const Event& event) {
+  const Command& command = event.command();
+  HostQueue* producer = command.queue();
+  uint64_t seq = command.queueSeq();
+  if ((producer == nullptr) || (producer == this) || (seq == 0)) {
+    return;
+  }
+  static constexpr size_t kMaxWaitedQueues = 32;
+  ScopedLock l(waitLock_);
+  for (auto& it : waited_) {
+    if (it.first == producer->uid_) {
+      it.second = std::max(it.second, seq);
+      return;
+    }
+  }
+  if (waited_.size() == kMaxWaitedQueues) {
+    // Forget the oldest producer, that only disables the elision for it
+    waited_.erase(waited_.begin());
+  }
+  waited_.push_back({producer->uid_, seq});
+}
+
+bool HostQueue::batchReady() const {
+  switch (batchPolicy_.mode_) {
+    case BatchPolicy::Mode::Immediate:
+      return true;
+    case BatchPolicy::Mode::Count:
+      return batchSize_ >= batchPolicy_.value_;
+    case BatchPolicy::Mode::Time:
+      return (Os::timeNanos() - batchStart_) >= (batchPolicy_.value_ * 1000ull);
+    case BatchPolicy::Mode::Default:
+    default:
+      return false;
+  }
+}
+
+uint64_t HostQueue::spinTime() const {
+  // Spin for two average intervals if the next command is expected within the spin limit
+  const uint64_t maxSpin = static_cast<uint64_t>(AMD_QUEUE_THREAD_SPIN) * 1000;
+  uint64_t interval = enqueueInterval_.load(std::memory_order_relaxed);
+  return (interval < maxSpin) ? std::min(2 * interval, maxSpin) : 0;
+}
+
+void HostQueue::flushBatch(device::VirtualDevice* virtualDevice, Command*& head, Command*& tail,
+                           bool wait) {
+  virtualDevice->flush(head, wait);
+  tail = head = NULL;
+  if (batchSize_ != 0) {
+    batchCount_.fetch_add(1, std::memory_order_relaxed);
+    batchCommands_.fetch_add(batchSize_, std::memory_order_relaxed);
+    batchSize_ = 0;
+  }
+}
+
 void HostQueue::loop(device::VirtualDevice* virtualDevice) {
   // Notify the caller that the queue is ready to accept commands.
   {
@@ -157,17 +303,27 @@ void HostQueue::loop(device::VirtualDevice* virtualDevice) {
   while (true) {
     // Get one command from the queue
     Command* command = queue_.dequeue();
+    if ((command == NULL) && (head != NULL) &&
+        (batchPolicy_.mode_ == BatchPolicy::Mode::Time)) {
+      // Hold the idle batch until the time limit, so the next commands can join it
+      while (((command = queue_.dequeue()) == NULL) && !batchReady()) {
+        Os::yield();
+      }
+      if (command == NULL) {
+        flushBatch(virtualDevice, head, tail);
+      }
+    }
     if (command == NULL) {
-      ScopedLock sl(queueLock_);
       while ((command = queue_.dequeue()) == NULL) {
         if (!thread_.acceptingCommands_) {
           return;
         }
-        queueLock_.wait();
+        parker_.park(spinTime());
       }
     }
 
     command->retain();
+    AssignQueueSeq(*command);
 
     // Process the command's event wait list.
     const Command::EventWaitList& events = command->eventWaitList();
@@ -175,13 +331,25 @@ void HostQueue::loop(device::VirtualDevice* virtualDevice) {
     ClPrint(LOG_DEBUG, LOG_CMD, "Command (%s) processing: %p ,events.size(): %d",
             getOclCommandKindString(command->type()), command, events.size());
     for (const auto& it : events) {
-      // Only wait if the command is enqueued into another queue.
-      if (it->command().queue() != this) {
+      // Only wait if the command is enqueued into another queue and the wait isn't implied
+      // by an earlier wait for the same queue
+      if ((it->command().queue() != this) && !isWaitImplied(*it)) {
+        recordWait(*it);
         // Runtime has to flush the current batch only if the dependent wait is blocking
         if (it->command().status() != CL_COMPLETE) {
+          // If the producer queue attached a HW event to the command, then the device
+          // resolves the dependency on GPU and the queue thread keeps submitting
+          void* hw_event = (it->NotifyEvent() != nullptr) ? it->NotifyEvent()->HwEvent() :
+                                                            it->HwEvent();
+          // Note: the HSA signals are created for the owning device only
+          if ((hw_event != nullptr) && virtualDevice->canWaitHwEvent() &&
+              (&it->command().queue()->device() == &device())) {
+            ClPrint(LOG_DEBUG, LOG_CMD, "Command (%s) %p GPU wait for event: %p",
+                    getOclCommandKindString(command->type()), command, it);
+            continue;
+          }
           ClPrint(LOG_DEBUG, LOG_CMD, "Command (%s) %p awaiting event: %p", getOclCommandKindString(command->type()), command, it);
-          virtualDevice->flush(head, true);
-          tail = head = NULL;
+          flushBatch(virtualDevice, head, tail, true);
           dependencyFailed |= !it->awaitCompletion();
         }
       }
@@ -190,10 +358,14 @@ void HostQueue::loop(device::VirtualDevice* virtualDevice) {
     // Insert the command to the linked list.
     if (NULL == head) {  // if the list is empty
       head = tail = command;
+      if (batchPolicy_.mode_ == BatchPolicy::Mode::Time) {
+        batchStart_ = Os::timeNanos();
+      }
     } else {
       tail->setNext(command);
       tail = command;
     }
+    batchSize_++;
 
     if (dependencyFailed) {
       command->setStatus(CL_EXEC_STATUS_ERROR_FOR_EVENTS_IN_WAIT_LIST);
@@ -204,13 +376,16 @@ void HostQueue::loop(device::VirtualDevice* virtualDevice) {
 
     command->setStatus(CL_SUBMITTED);
 
+    // Batch the submission while more commands are ready, the last command publishes the batch
+    virtualDevice->setBatchSubmission(!queue_.empty());
+
     // Submit to the device queue.
     command->submit(*virtualDevice);
 
-    // if this is a user invisible marker command, then flush
-    if (0 == command->type()) {
-      virtualDevice->flush(head);
-      tail = head = NULL;
+    // if this is a user invisible marker command or the batching policy limit is reached,
+    // then flush
+    if ((0 == command->type()) || batchReady()) {
+      flushBatch(virtualDevice, head, tail);
     }
   }  // while (true) {
 }
@@ -223,7 +398,21 @@ void HostQueue::append(Command& command) {
   }
   command.retain();
   command.setStatus(CL_QUEUED);
-  queue_.enqueue(&command);
+  while (!queue_.tryEnqueue(&command)) {
+    // The queue is full, so wake up the queue thread and wait for a free slot
+    flush();
+    Os::yield();
+  }
+
+  // Track the enqueue rate for the spin time of the queue thread
+  uint64_t now = Os::timeNanos();
+  uint64_t last = lastEnqueueTime_.exchange(now, std::memory_order_relaxed);
+  if (last != 0) {
+    static constexpr uint64_t kMaxInterval = 1000000;
+    uint64_t interval = std::min(now - last, kMaxInterval);
+    enqueueInterval_.store((enqueueInterval_.load(std::memory_order_relaxed) * 7 + interval) / 8,
+                           std::memory_order_relaxed);
+  }
   if (!IS_HIP) {
     return;
   }
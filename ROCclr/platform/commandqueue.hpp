@@ -75,6 +75,20 @@ class CommandQueue : public RuntimeObject {
     bool test(value_type bits) const { return (value_ & bits) != 0; }
   };
 
+  //! Batching policy of the command submission on the queue thread
+  struct BatchPolicy {
+    enum class Mode : uint {
+      Default = 0,  //!< Flush the batch on a marker or a blocking dependency
+      Immediate,    //!< Flush the batch after every command
+      Count,        //!< Flush the batch after value_ commands
+      Time          //!< Flush the batch after value_ microseconds
+    };
+    Mode mode_;
+    uint value_;  //!< The number of commands or the time in microseconds
+
+    BatchPolicy(Mode mode = Mode::Default, uint value = 0) : mode_(mode), value_(value) {}
+  };
+
   //! Return the context this command queue is part of.
   Context& context() const { return context_(); }
 
@@ -167,6 +181,11 @@ class HostQueue : public CommandQueue {
     //! The command queue thread entry point.
     void run(void* data) {
       HostQueue* queue = static_cast<HostQueue*>(data);
+      // Keep the queue thread on the CPU socket, closest to the device
+      int32_t node = queue->device().queueNumaNode();
+      if (node >= 0) {
+        Os::setPreferredNumaNode(node);
+      }
       virtualDevice_ = queue->device().createVirtualDevice(queue);
       if (virtualDevice_ != NULL) {
         queue->loop(virtualDevice_);
@@ -195,13 +214,39 @@ class HostQueue : public CommandQueue {
   } thread_;  //!< The command queue thread instance.
 
  private:
-  ConcurrentLinkedQueue<Command*> queue_;  //!< The queue.
+  ConcurrentRingQueue<Command*> queue_;    //!< The queue.
+  Parker parker_;                          //!< Parking spot of the queue thread
+
+  std::atomic<uint64_t> lastEnqueueTime_;  //!< The time of the last append()
+  std::atomic<uint64_t> enqueueInterval_;  //!< Average time between the appends
 
   Command* lastEnqueueCommand_;  //!< The last submitted command
 
+  const uint64_t uid_;          //!< Unique id of the queue, since the memory can be reused
+  uint64_t queueSeq_;           //!< Execution order of the last submitted command
+  Monitor waitLock_;            //!< Lock for the waited producers
+  //! Execution order of the last waited command per producer queue id
+  std::vector<std::pair<uint64_t, uint64_t>> waited_;
+
+  const BatchPolicy batchPolicy_;  //!< The batching policy of the queue thread
+  uint32_t batchSize_;             //!< The number of commands in the current batch
+  uint64_t batchStart_;            //!< The time of the first command in the current batch
+  std::atomic<uint64_t> batchCount_;     //!< The number of flushed batches
+  std::atomic<uint64_t> batchCommands_;  //!< The number of commands in the flushed batches
+
   //! Await commands and execute them as they become ready.
   void loop(device::VirtualDevice* virtualDevice);
 
+  //! Returns TRUE if the current batch has to be flushed by the batching policy
+  bool batchReady() const;
+
+  //! Returns the spin time of the queue thread before it parks, based on the enqueue rate
+  uint64_t spinTime() const;
+
+  //! Flush the current batch and update the batch statistics
+  void flushBatch(device::VirtualDevice* virtualDevice, Command*& head, Command*& tail,
+                  bool wait = false);
+
  protected:
   virtual bool terminate();
 
@@ -213,7 +258,8 @@ class HostQueue : public CommandQueue {
    */
   HostQueue(Context& context, Device& device, cl_command_queue_properties properties,
             uint queueRTCUs = 0, Priority priority = Priority::Normal,
-            const std::vector<uint32_t>& cuMask = {});
+            const std::vector<uint32_t>& cuMask = {},
+            const BatchPolicy& batchPolicy = BatchPolicy());
 
   //! Returns TRUE if this command queue can accept commands.
   virtual bool create() { return thread_.acceptingCommands_; }
@@ -225,17 +271,49 @@ class HostQueue : public CommandQueue {
   const Thread& thread() const { return thread_; }
 
   //! Signal to start processing the commands in the queue.
-  void flush() {
-    ScopedLock sl(queueLock_);
-    queueLock_.notify();
-  }
+  void flush() { parker_.unpark(); }
 
   //! Finish all queued commands
   void finish();
 
+  //! Finish all queued commands of \a queues, with a single wait for all busy queues
+  static void finishAll(const std::vector<HostQueue*>& queues);
+
   //! Check if hostQueue empty snapshot
   bool isEmpty();
 
+ private:
+  //! Returns the retained command to wait for in finish(), NULL if the queue is idle
+  Command* finishCommand();
+
+  //! Releases the command of finishCommand() after the wait and the last queued command
+  void finishDone(Command* command);
+
+ public:
+
+  //! Returns TRUE if the queue executes commands in the order of submission
+  bool isInOrder() const { return !properties().test(CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE); }
+
+  //! Assigns the execution order to the command. The submission must be serialized
+  void AssignQueueSeq(Command& command) { command.setQueueSeq(++queueSeq_); }
+
+  //! Returns TRUE if the in-order execution already implies the wait for the event,
+  //! i.e. the event is on this queue or this queue waited for a later command in the producer
+  bool isWaitImplied(const Event& event);
+
+  //! Records the wait for the event, so the waits for earlier commands can be elided
+  void recordWait(const Event& event);
+
+  //! Returns the batching policy of the queue thread
+  const BatchPolicy& batchPolicy() const { return batchPolicy_; }
+
+  //! Returns the average number of commands in the flushed batches
+  double averageBatchSize() const {
+    uint64_t count = batchCount_.load(std::memory_order_relaxed);
+    return (count != 0) ?
+      static_cast<double>(batchCommands_.load(std::memory_order_relaxed)) / count : 0.0;
+  }
+
   //! Get virtual device for the current command queue
   device::VirtualDevice* vdev() const { return thread_.vdev(); }
 
@@ -293,6 +371,9 @@ class HostQueue : public CommandQueue {
   //! Reset counter
   void ResetMarkerTsCount() { markerTsCount_ = 0; }
 
+  //! Returns the buffer of the activity records
+  activity_prof::ActivityBuffer& activityBuffer() { return activityBuffer_; }
+
 private:
   Command* head_;   //!< Head of the batch list
   Command* tail_;   //!< Tail of the batch list
@@ -301,6 +382,8 @@ private:
   bool isActive_;
 
   uint32_t markerTsCount_; //!< Count of TS markers
+
+  activity_prof::ActivityBuffer activityBuffer_;  //!< Activity records of the completed commands
 };
 
 
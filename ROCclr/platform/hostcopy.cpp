@@ -0,0 +1,118 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "platform/hostcopy.hpp"
+#include "os/os.hpp"
+#include "utils/debug.hpp"
+#include "utils/flags.hpp"
+#include "utils/util.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace amd {
+
+//! The time an idle worker spins before it parks, so back to back copies avoid a syscall
+static constexpr uint64_t kWorkerSpinNanos = 50000;
+
+void HostCopyPool::Worker::run(void* data) {
+  if (pool_.numaNode_ >= 0) {
+    Os::setPreferredNumaNode(pool_.numaNode_);
+  }
+  while (true) {
+    while (!busy() && !pool_.exiting_.load(std::memory_order_acquire)) {
+      parker_.park(kWorkerSpinNanos);
+    }
+    if (!busy()) {
+      break;
+    }
+    memcpy(dst_, src_, size_);
+    busy_.store(false, std::memory_order_release);
+  }
+}
+
+void HostCopyPool::Worker::submit(address dst, const_address src, size_t size) {
+  dst_ = dst;
+  src_ = src;
+  size_ = size;
+  busy_.store(true, std::memory_order_release);
+  parker_.unpark();
+}
+
+HostCopyPool::HostCopyPool(uint32_t numWorkers, int32_t numaNode)
+    : numWorkers_(numWorkers), numaNode_(numaNode), exiting_(false),
+      lock_("Host copy pool lock") {}
+
+HostCopyPool::~HostCopyPool() {
+  exiting_.store(true, std::memory_order_release);
+  for (auto worker : workers_) {
+    worker->wake();
+  }
+  for (auto worker : workers_) {
+    while (worker->state() < Thread::FINISHED) {
+      Os::yield();
+    }
+    delete worker;
+  }
+}
+
+bool HostCopyPool::create() {
+  for (uint32_t i = 0; i < numWorkers_; ++i) {
+    Worker* worker = new Worker(*this);
+    if ((worker == nullptr) || (worker->state() != Thread::INITIALIZED)) {
+      delete worker;
+      break;
+    }
+    workers_.push_back(worker);
+    worker->start();
+  }
+  ClPrint(LOG_INFO, LOG_INIT, "Created %zu host copy workers on NUMA node %d",
+          workers_.size(), numaNode_);
+  return !workers_.empty();
+}
+
+void HostCopyPool::copy(void* dst, const void* src, size_t size) {
+  const size_t parts = std::min(workers_.size() + 1, size / kMinPartSize);
+  // Another thread keeps the workers busy, hence the copy can't wait for them
+  if ((parts < 2) || !lock_.tryLock()) {
+    memcpy(dst, src, size);
+    return;
+  }
+
+  // Split the copy on the cache line boundary, the calling thread copies the last part
+  const size_t partSize = alignUp(size / parts, 64);
+  address dstPart = reinterpret_cast<address>(dst);
+  const_address srcPart = reinterpret_cast<const_address>(src);
+  size_t offset = 0;
+  for (size_t i = 0; i < (parts - 1); ++i) {
+    workers_[i]->submit(dstPart + offset, srcPart + offset, partSize);
+    offset += partSize;
+  }
+  memcpy(dstPart + offset, srcPart + offset, size - offset);
+
+  for (size_t i = 0; i < (parts - 1); ++i) {
+    while (workers_[i]->busy()) {
+      Os::yield();
+    }
+  }
+  lock_.unlock();
+}
+
+}  // namespace amd
@@ -0,0 +1,92 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef HOSTCOPY_HPP_
+#define HOSTCOPY_HPP_
+
+#include "top.hpp"
+#include "thread/monitor.hpp"
+#include "thread/semaphore.hpp"
+#include "thread/thread.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace amd {
+
+/*! \brief A pool of worker threads for large host memory copies
+ *
+ *  The calling thread splits a copy into equal parts, copies one part itself and
+ *  hands the rest to the workers. The workers run on the CPUs of the NUMA node
+ *  closest to the device, so they copy through the local memory controller.
+ */
+class HostCopyPool : public HeapObject {
+ public:
+  //! The smallest part of a copy, which is worth the hand-off to a worker
+  static constexpr size_t kMinPartSize = 256 * Ki;
+
+  HostCopyPool(uint32_t numWorkers, int32_t numaNode);
+  ~HostCopyPool();
+
+  //! Starts the worker threads, returns false if no worker could be created
+  bool create();
+
+  //! Copies \a size bytes from \a src to \a dst. A small copy, or a copy that
+  //! finds the pool busy with another thread, runs on the calling thread only
+  void copy(void* dst, const void* src, size_t size);
+
+ private:
+  class Worker : public Thread {
+   public:
+    explicit Worker(HostCopyPool& pool)
+        : Thread("Host Copy Thread"), pool_(pool), dst_(nullptr), src_(nullptr), size_(0),
+          busy_(false) {}
+
+    //! The worker thread entry point
+    void run(void* data);
+
+    //! Hands a part of the copy to the worker
+    void submit(address dst, const_address src, size_t size);
+
+    //! Returns true if the worker still copies its part
+    bool busy() const { return busy_.load(std::memory_order_acquire); }
+
+    //! Wakes up the worker
+    void wake() { parker_.unpark(); }
+
+   private:
+    HostCopyPool& pool_;      //!< The pool of the worker
+    address dst_;             //!< Destination of the current part
+    const_address src_;       //!< Source of the current part
+    size_t size_;             //!< Size of the current part
+    std::atomic<bool> busy_;  //!< True while the part isn't copied
+    Parker parker_;           //!< Parking spot of the idle worker
+  };
+
+  const uint32_t numWorkers_;     //!< The number of requested workers
+  const int32_t numaNode_;        //!< NUMA node of the workers or -1
+  std::vector<Worker*> workers_;  //!< The worker threads
+  std::atomic<bool> exiting_;     //!< True if the workers must exit
+  Monitor lock_;                  //!< Serializes the copies, submitted to the workers
+};
+
+}  // namespace amd
+
+#endif  // HOSTCOPY_HPP_
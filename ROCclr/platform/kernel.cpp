@@ -98,10 +98,20 @@ void KernelParameters::set(size_t index, size_t size, const void* value, bool sv
 
   if (desc.type_ == T_POINTER && (desc.addressQualifier_ != CL_KERNEL_ARG_ADDRESS_LOCAL)) {
     if (svmBound) {
-      desc.info_.rawPointer_ = true;
       LP64_SWITCH(uint32_value, uint64_value) = *(LP64_SWITCH(uint32_t*, uint64_t*))value;
-      memoryObjects_[desc.info_.arrayIndex_] = amd::MemObjMap::FindMemObj(
-        *reinterpret_cast<const void* const*>(value));
+      const void* svmPtr = *reinterpret_cast<const void* const*>(value);
+      Memory*& memArg = memoryObjects_[desc.info_.arrayIndex_];
+      uint64_t& generation = svmGeneration_[desc.info_.arrayIndex_];
+      // A found mem object stays valid until any mem object is removed from the map,
+      // hence the same SVM pointer skips the lookup and the argument stays clean
+      if (desc.info_.defined_ && desc.info_.rawPointer_ && (memArg != nullptr) &&
+          (generation == MemObjMap::Generation()) &&
+          (*reinterpret_cast<const void* const*>(param) == svmPtr)) {
+        return;
+      }
+      desc.info_.rawPointer_ = true;
+      generation = MemObjMap::Generation();
+      memArg = MemObjMap::FindMemObj(svmPtr);
     } else if ((value == NULL) || (static_cast<const cl_mem*>(value) == NULL)) {
       desc.info_.rawPointer_ = false;
       memoryObjects_[desc.info_.arrayIndex_] = nullptr;
@@ -152,6 +162,82 @@ void KernelParameters::set(size_t index, size_t size, const void* value, bool sv
   }
 
   desc.info_.defined_ = true;
+  markDirty(index);
+}
+
+bool KernelParameters::updateCache(const Device& device, uint64_t lclMemSize, int32_t* error) {
+  const bool rebuild = (cacheDevice_ != &device);
+  if (!rebuild && !argsDirty_ && (cacheLclMemStart_ == lclMemSize)) {
+    return true;
+  }
+  if (cache_ == nullptr) {
+    cache_ = reinterpret_cast<address>(AlignedMemory::allocate(totalSize_,
+                                                               PARAMETERS_MIN_ALIGNMENT));
+    if (cache_ == nullptr) {
+      *error = CL_OUT_OF_HOST_MEMORY;
+      return false;
+    }
+  }
+  cacheDevice_ = nullptr;
+  cacheLclMemStart_ = lclMemSize;
+
+  // The object arrays are small, hence refresh them on every update
+  ::memcpy(cache_ + memoryObjOffset_, values_ + memoryObjOffset_, totalSize_ - memoryObjOffset_);
+  if (rebuild) {
+    ::memcpy(cache_, values_, memoryObjOffset_);
+  }
+
+  for (size_t i = 0; i < signature_.numParameters(); ++i) {
+    const KernelParameterDescriptor& desc = signature_.at(i);
+    if (desc.addressQualifier_ == CL_KERNEL_ARG_ADDRESS_LOCAL) {
+      if (desc.size_ == 8) {
+        lclMemSize = alignUp(lclMemSize, device.info().minDataTypeAlignSize_) +
+          *reinterpret_cast<const uint64_t*>(values_ + desc.offset_);
+      } else {
+        lclMemSize = alignUp(lclMemSize, device.info().minDataTypeAlignSize_) +
+          *reinterpret_cast<const uint32_t*>(values_ + desc.offset_);
+      }
+    }
+    if (!rebuild && ((dirty_[i / 64] & (1ull << (i % 64))) == 0)) {
+      continue;
+    }
+    ::memcpy(cache_ + desc.offset_, values_ + desc.offset_, desc.size_);
+
+    if (desc.type_ == T_POINTER && (desc.addressQualifier_ != CL_KERNEL_ARG_ADDRESS_LOCAL)) {
+      Memory* memArg = memoryObjects_[desc.info_.arrayIndex_];
+      if (memArg != nullptr) {
+        device::Memory* devMem = memArg->getDeviceMemory(device);
+        if (nullptr == devMem) {
+          LogPrintfError("Can't allocate memory size - 0x%08X bytes!", memArg->getSize());
+          *error = CL_MEM_OBJECT_ALLOCATION_FAILURE;
+          return false;
+        }
+        // Write GPU VA addreess to the arguments
+        if (!desc.info_.rawPointer_) {
+          *reinterpret_cast<uintptr_t*>(cache_ + desc.offset_) = static_cast<uintptr_t>
+            (devMem->virtualAddress());
+        }
+      }
+    } else if (desc.type_ == T_SAMPLER) {
+      Sampler* samplerArg = samplerObjects_[desc.info_.arrayIndex_];
+      if (samplerArg != nullptr) {
+        // todo: It's uint64_t type
+        *reinterpret_cast<uintptr_t*>(cache_ + desc.offset_) = static_cast<uintptr_t>(
+          samplerArg->getDeviceSampler(device)->hwSrd());
+      }
+    } else if (desc.type_ == T_QUEUE) {
+      if (queueObjects_[desc.info_.arrayIndex_] != nullptr) {
+        // todo: It's uint64_t type
+        *reinterpret_cast<uintptr_t*>(cache_ + desc.offset_) = 0;
+      }
+    }
+  }
+
+  std::fill(dirty_.begin(), dirty_.end(), 0);
+  argsDirty_ = 0;
+  cacheDevice_ = &device;
+  cacheLclMemSize_ = lclMemSize;
+  return true;
 }
 
 address KernelParameters::capture(device::VirtualDevice& vDev, uint64_t lclMemSize, int32_t* error) {
@@ -166,76 +252,120 @@ address KernelParameters::capture(device::VirtualDevice& vDev, uint64_t lclMemSi
   if (mem == nullptr) {
     mem = reinterpret_cast<address>(AlignedMemory::allocate(totalSize_ + execInfoSize,
                                                             PARAMETERS_MIN_ALIGNMENT));
+    if (mem == nullptr) {
+      *error = CL_OUT_OF_HOST_MEMORY;
+      return nullptr;
+    }
   } else {
     deviceKernelArgs_ = true;
   }
 
-  if (mem != nullptr) {
-    ::memcpy(mem, values_, totalSize_);
+  // The device addresses are patched only for the arguments changed since the last capture,
+  // hence an enqueue with the same arguments is a single copy of the cache
+  if (!updateCache(device, lclMemSize, error)) {
+    if (!deviceKernelArgs()) {
+      AlignedMemory::deallocate(mem);
+    }
+    return nullptr;
+  }
+  // Validate the local memory oversubscription
+  if (cacheLclMemSize_ > device.info().localMemSize_) {
+    *error = CL_OUT_OF_RESOURCES;
+    if (!deviceKernelArgs()) {
+      AlignedMemory::deallocate(mem);
+    }
+    return nullptr;
+  }
+
+  ::memcpy(mem, cache_, totalSize_);
+  for (uint32_t i = 0; i < signature_.numMemories(); ++i) {
+    if (memoryObjects_[i] != nullptr) {
+      memoryObjects_[i]->retain();
+    }
+  }
+  for (uint32_t i = 0; i < signature_.numSamplers(); ++i) {
+    if (samplerObjects_[i] != nullptr) {
+      samplerObjects_[i]->retain();
+    }
+  }
+  for (uint32_t i = 0; i < signature_.numQueues(); ++i) {
+    if (queueObjects_[i] != nullptr) {
+      queueObjects_[i]->retain();
+    }
+  }
+
+  execInfoOffset_ = totalSize_;
+  address last = mem + execInfoOffset_;
+  if (0 != execInfoSize) {
+    ::memcpy(last, &execSvmPtr_[0], execInfoSize);
+  }
+  return mem;
+}
+
+address KernelParameters::captureDirect(device::VirtualDevice& vDev, uint64_t lclMemSize,
+                                        const void* const* args, const_address kernargs,
+                                        int32_t* error) {
+  const Device& device = vDev.device();
+  *error = CL_SUCCESS;
+
+  if ((args == nullptr) && (kernargs == nullptr) && (signature_.numParameters() != 0)) {
+    *error = CL_INVALID_KERNEL_ARGS;
+    return nullptr;
+  }
+
+  address mem = vDev.allocKernelArguments(totalSize_, 128);
+  if (mem == nullptr) {
+    mem = reinterpret_cast<address>(AlignedMemory::allocate(totalSize_, PARAMETERS_MIN_ALIGNMENT));
+    if (mem == nullptr) {
+      *error = CL_OUT_OF_HOST_MEMORY;
+      return nullptr;
+    }
+  } else {
+    deviceKernelArgs_ = true;
+  }
+
+  // The device layer writes only the hidden arguments it knows about, hence clear the rest
+  const size_t paramsSize = signature_.paramsSize();
+  size_t explicitSize = 0;
+  if (signature_.numParameters() != 0) {
+    const KernelParameterDescriptor& last = signature_.at(signature_.numParameters() - 1);
+    explicitSize = last.offset_ + last.size_;
+  }
+  ::memset(mem + explicitSize, '\0', paramsSize - explicitSize);
 
-    for (size_t i = 0; i < signature_.numParameters(); ++i) {
-      const KernelParameterDescriptor& desc = signature_.at(i);
-      if (desc.type_ == T_POINTER && (desc.addressQualifier_ != CL_KERNEL_ARG_ADDRESS_LOCAL)) {
-        Memory* memArg = memoryObjects_[desc.info_.arrayIndex_];
+  // The raw pointer state changes below, so the next capture() rebuilds the cache
+  cacheDevice_ = nullptr;
+  Memory** memories = reinterpret_cast<Memory**>(mem + memoryObjOffset_);
+  for (size_t i = 0; i < signature_.numParameters(); ++i) {
+    KernelParameterDescriptor& desc = signature_.params()[i];
+    const void* value = (args != nullptr) ? args[i] : kernargs + desc.offset_;
+    ::memcpy(mem + desc.offset_, value, desc.size_);
+    desc.info_.defined_ = true;
+    if (desc.type_ == T_POINTER) {
+      desc.info_.rawPointer_ = true;
+      Memory* memArg = nullptr;
+      if (*error == CL_SUCCESS) {
+        // Only the retained objects go to the captured state, so release() matches
+        memArg = MemObjMap::FindMemObj(*reinterpret_cast<const void* const*>(value));
         if (memArg != nullptr) {
           memArg->retain();
-          device::Memory* devMem = memArg->getDeviceMemory(device);
-          if (nullptr == devMem) {
+          if (nullptr == memArg->getDeviceMemory(device)) {
             LogPrintfError("Can't allocate memory size - 0x%08X bytes!", memArg->getSize());
             *error = CL_MEM_OBJECT_ALLOCATION_FAILURE;
-            break;
-          }
-          // Write GPU VA addreess to the arguments
-          if (!desc.info_.rawPointer_) {
-            *reinterpret_cast<uintptr_t*>(mem + desc.offset_) = static_cast<uintptr_t>
-              (devMem->virtualAddress());
-          }
-        } else if (desc.info_.rawPointer_) {
-          if (!device.isFineGrainedSystem(true)) {
           }
         }
-      } else if (desc.type_ == T_SAMPLER) {
-        Sampler* samplerArg = samplerObjects_[desc.info_.arrayIndex_];
-        if (samplerArg != nullptr) {
-          samplerArg->retain();
-          // todo: It's uint64_t type
-          *reinterpret_cast<uintptr_t*>(mem + desc.offset_) = static_cast<uintptr_t>(
-            samplerArg->getDeviceSampler(device)->hwSrd());
-        }
-      } else if (desc.type_ == T_QUEUE) {
-        DeviceQueue* queue = queueObjects_[desc.info_.arrayIndex_];
-        if (queue != nullptr) {
-          queue->retain();
-          // todo: It's uint64_t type
-          *reinterpret_cast<uintptr_t*>(mem + desc.offset_) = 0;
-        }
-      } else if (desc.addressQualifier_ == CL_KERNEL_ARG_ADDRESS_LOCAL) {
-        if (desc.size_ == 8) {
-          lclMemSize = alignUp(lclMemSize, device.info().minDataTypeAlignSize_) +
-            *reinterpret_cast<const uint64_t*>(values_ + desc.offset_);
-        } else {
-          lclMemSize = alignUp(lclMemSize, device.info().minDataTypeAlignSize_) +
-            *reinterpret_cast<const uint32_t*>(values_ + desc.offset_);
-        }
       }
+      memories[desc.info_.arrayIndex_] = memArg;
     }
-
-    execInfoOffset_ = totalSize_;
-    address last = mem + execInfoOffset_;
-    if (0 != execInfoSize) {
-      ::memcpy(last, &execSvmPtr_[0], execInfoSize);
-    }
-  } else {
-    *error = CL_OUT_OF_HOST_MEMORY;
   }
+  execInfoOffset_ = totalSize_;
+
   // Validate the local memory oversubscription
-  if (lclMemSize > device.info().localMemSize_) {
+  if ((*error == CL_SUCCESS) && (lclMemSize > device.info().localMemSize_)) {
     *error = CL_OUT_OF_RESOURCES;
   }
-
-  // Check if capture was successful
   if (CL_SUCCESS != *error) {
-    AlignedMemory::deallocate(mem);
+    release(mem, device);
     mem = nullptr;
   }
   return mem;
@@ -136,14 +136,47 @@ class KernelParameters : protected HeapObject {
 
   uint32_t  totalSize_;             //!< The total size of all captured parameters
 
+  address cache_;                       //!< Values of the last capture with the device addresses
+  mutable const Device* cacheDevice_;   //!< Device of cache_, nullptr if cache_ is invalid
+  uint64_t cacheLclMemStart_;           //!< Local memory size passed to the last cache update
+  uint64_t cacheLclMemSize_;            //!< Local memory size with the local arguments
+  std::vector<uint64_t> dirty_;         //!< Arguments changed since the last cache update
+  std::vector<uint64_t> svmGeneration_; //!< MemObjMap generation of the SVM argument lookups
+
   struct {
     uint32_t validated_ : 1;        //!< True if all parameters are defined.
     uint32_t execNewVcop_ : 1;      //!< special new VCOP for kernel execution
     uint32_t execPfpaVcop_ : 1;     //!< special PFPA VCOP for kernel execution
     uint32_t deviceKernelArgs_:1;   //!< Kernel arguments allocated on device
-    uint32_t unused : 28;           //!< unused
+    uint32_t directCapture_:1;      //!< Arguments can be captured without the values stack
+    uint32_t argsDirty_ : 1;        //!< At least one bit of dirty_ is set
+    uint32_t unused : 26;           //!< unused
   };
 
+  //! Returns true if all arguments are plain values or raw pointers
+  static bool isDirectCapture(const KernelSignature& signature) {
+    if ((signature.numSamplers() != 0) || (signature.numQueues() != 0)) {
+      return false;
+    }
+    for (size_t i = 0; i < signature.numParameters(); ++i) {
+      const KernelParameterDescriptor& desc = signature.at(i);
+      if ((desc.addressQualifier_ == CL_KERNEL_ARG_ADDRESS_LOCAL) ||
+          ((desc.type_ == T_POINTER) && (desc.size_ != sizeof(void*)))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  //! Marks the argument at \a index for the next cache update
+  void markDirty(size_t index) {
+    dirty_[index / 64] |= (1ull << (index % 64));
+    argsDirty_ = 1;
+  }
+
+  //! Brings cache_ up to date with the dirty arguments, returns false on an error
+  bool updateCache(const Device& device, uint64_t lclMemSize, int32_t* error);
+
  public:
   //! Construct a new instance of parameters for the given signature.
   KernelParameters(KernelSignature& signature)
@@ -153,10 +186,18 @@ class KernelParameters : protected HeapObject {
         memoryObjects_(nullptr),
         samplerObjects_(nullptr),
         queueObjects_(nullptr),
+        cache_(nullptr),
+        cacheDevice_(nullptr),
+        cacheLclMemStart_(0),
+        cacheLclMemSize_(0),
+        dirty_((signature_.numParameters() + 63) / 64, ~0ull),
+        svmGeneration_(signature_.numMemories(), 0),
         validated_(0),
         execNewVcop_(0),
         execPfpaVcop_(0),
-        deviceKernelArgs_(false) {
+        deviceKernelArgs_(false),
+        directCapture_(isDirectCapture(signature)),
+        argsDirty_(1) {
     totalSize_ = signature.paramsSize() + (signature.numMemories() +
         signature.numSamplers() + signature.numQueues()) * sizeof(void*);
     values_ = reinterpret_cast<address>(this) + alignUp(sizeof(KernelParameters), 16);
@@ -179,10 +220,18 @@ class KernelParameters : protected HeapObject {
         samplerObjects_(nullptr),
         queueObjects_(nullptr),
         totalSize_(rhs.totalSize_),
+        cache_(nullptr),
+        cacheDevice_(nullptr),
+        cacheLclMemStart_(0),
+        cacheLclMemSize_(0),
+        dirty_((signature_.numParameters() + 63) / 64, ~0ull),
+        svmGeneration_(rhs.svmGeneration_),
         validated_(rhs.validated_),
         execNewVcop_(rhs.execNewVcop_),
         execPfpaVcop_(rhs.execPfpaVcop_),
-        deviceKernelArgs_(false) {
+        deviceKernelArgs_(false),
+        directCapture_(rhs.directCapture_),
+        argsDirty_(1) {
     values_ = reinterpret_cast<address>(this) + alignUp(sizeof(KernelParameters), 16);
     memoryObjOffset_ = signature_.paramsSize();
     memoryObjects_ = reinterpret_cast<amd::Memory**>(values_ + memoryObjOffset_);
@@ -194,10 +243,13 @@ class KernelParameters : protected HeapObject {
     ::memcpy(values_, rhs.values_, limit - values_);
   }
 
+  ~KernelParameters() { AlignedMemory::deallocate(cache_); }
+
   //! Reset the parameter at the given \a index (becomes undefined).
   void reset(size_t index) {
     signature_.params()[index].info_.defined_ = false;
     validated_ = 0;
+    markDirty(index);
   }
   //! Set the parameter at the given \a index to the value pointed by \a value
   // \a svmBound indicates that \a value is a SVM pointer.
@@ -214,6 +266,12 @@ class KernelParameters : protected HeapObject {
 
   //! Capture the state of the parameters and return the stack base pointer.
   address capture(device::VirtualDevice& vDev, uint64_t lclMemSize, int32_t* error);
+  //! Returns true if captureDirect() can pack the arguments
+  bool directCapture() const { return (directCapture_ == 1) && execSvmPtr_.empty(); }
+  //! Capture the arguments straight from \a args (one pointer per argument) or from the packed
+  //  \a kernargs, without setting them first. The pointers are raw (SVM) pointers.
+  address captureDirect(device::VirtualDevice& vDev, uint64_t lclMemSize,
+                        const void* const* args, const_address kernargs, int32_t* error);
   //! Release the captured state of the parameters.
   void release(address parameters, const amd::Device& device) const;
 
@@ -234,8 +292,12 @@ class KernelParameters : protected HeapObject {
     AlignedMemory::deallocate(ptr);
   }
 
-  //! Returns raw kernel parameters without capture
-  address values() const { return values_; }
+  //! Returns raw kernel parameters without capture. The caller may write the values
+  //  directly, hence the next capture rebuilds the cache.
+  address values() const {
+    cacheDevice_ = nullptr;
+    return values_;
+  }
 
   //! Return true if the captured parameter at the given \a index is bound to
   // SVM pointer.
@@ -0,0 +1,74 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "platform/latency.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace amd {
+
+// ================================================================================================
+uint64_t LatencyHistogram::lowerBound(uint32_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const uint32_t shift = index / kSubBuckets - 1;
+  return static_cast<uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+}
+
+// ================================================================================================
+uint64_t LatencyHistogram::percentile(double percent) const {
+  const uint64_t count = this->count();
+  if (count == 0) {
+    return 0;
+  }
+  const uint64_t target =
+      std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(count * percent / 100.0)));
+  uint64_t sum = 0;
+  for (uint32_t i = 0; i < kBuckets; ++i) {
+    sum += buckets_[i].load(std::memory_order_relaxed);
+    if (sum >= target) {
+      // Report the top of the bucket, but never above the largest sample
+      const uint64_t top = (i + 1 < kBuckets) ? lowerBound(i + 1) - 1 : UINT64_MAX;
+      return std::min(top, max());
+    }
+  }
+  return max();
+}
+
+// ================================================================================================
+void LatencyHistogram::buckets(uint64_t* buckets) const {
+  for (uint32_t i = 0; i < kBuckets; ++i) {
+    buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+}
+
+// ================================================================================================
+void LatencyHistogram::reset() {
+  for (auto& it : buckets_) {
+    it.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  total_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace amd
@@ -0,0 +1,127 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include "top.hpp"
+#include "os/os.hpp"
+#include "utils/flags.hpp"
+#include "utils/util.hpp"
+
+#include <atomic>
+
+namespace amd {
+
+/*! \brief Log-linear histogram of the latencies in ns
+ *
+ *  Every power of 2 has 16 linear sub-buckets, so any value is recorded with an error
+ *  below 1/16. The updates are relaxed atomics, hence many threads can record at once.
+ */
+class LatencyHistogram : public HeapObject {
+ public:
+  static constexpr uint32_t kSubBits = 4;
+  static constexpr uint32_t kSubBuckets = 1 << kSubBits;
+  static constexpr uint32_t kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+  LatencyHistogram() { reset(); }
+
+  //! Adds one sample
+  void record(uint64_t ns) {
+    buckets_[index(ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while ((ns > max) && !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+  }
+
+  //! Returns the bucket of \a ns
+  static uint32_t index(uint64_t ns) {
+    if (ns < kSubBuckets) {
+      return static_cast<uint32_t>(ns);
+    }
+    const uint32_t msb = amd::log2(ns);
+    return (msb - kSubBits + 1) * kSubBuckets +
+        static_cast<uint32_t>((ns >> (msb - kSubBits)) & (kSubBuckets - 1));
+  }
+
+  //! Returns the smallest value of the bucket
+  static uint64_t lowerBound(uint32_t index);
+
+  //! Returns the value below which \a percent of the samples fall, 0 if there are no samples
+  uint64_t percentile(double percent) const;
+
+  //! Copies the bucket counts, \a buckets must have kBuckets entries
+  void buckets(uint64_t* buckets) const;
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t total() const { return total_.load(std::memory_order_relaxed); }
+  uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+  //! Clears all samples
+  void reset();
+
+ private:
+  std::atomic<uint64_t> buckets_[kBuckets];  //!< Sample counts
+  std::atomic<uint64_t> count_;              //!< Total number of the samples
+  std::atomic<uint64_t> total_;              //!< Sum of the samples in ns
+  std::atomic<uint64_t> max_;                //!< Largest sample
+};
+
+/*! \brief Latency histograms of the submission path of a device
+ *
+ *  The stages are recorded always, unless ROC_LATENCY_STATS is disabled. The cost is
+ *  2 timer reads and a few relaxed atomics per stage.
+ */
+class LatencyStats : public HeapObject {
+ public:
+  enum Stage : uint32_t {
+    Api = 0,      //!< HIP API from the entry to the exit
+    Enqueue,      //!< Command::enqueue(), including the direct dispatch submission
+    PacketWrite,  //!< AQL slot reservation and packet write
+    Doorbell,     //!< Doorbell signal store
+    Completion,   //!< From the command enqueue to the completion on the host
+    StageCount
+  };
+
+  //! Returns the start time of a stage, 0 if the stats are disabled
+  static uint64_t start() { return ROC_LATENCY_STATS ? Os::timeNanos() : 0; }
+
+  //! Records the time since \a start
+  void record(Stage stage, uint64_t start) {
+    if (start != 0) {
+      histograms_[stage].record(Os::timeNanos() - start);
+    }
+  }
+
+  const LatencyHistogram& histogram(Stage stage) const { return histograms_[stage]; }
+
+  //! Clears the histograms of all stages
+  void reset() {
+    for (auto& it : histograms_) {
+      it.reset();
+    }
+  }
+
+ private:
+  LatencyHistogram histograms_[StageCount];
+};
+
+}  // namespace amd
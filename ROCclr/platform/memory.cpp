@@ -553,6 +553,55 @@ void Pipe::initDeviceMemory() {
   memset(deviceMemories_, 0, NumDevicesWithP2P() * sizeof(DeviceMemory));
 }
 
+// ================================================================================================
+// The ring indices grow monotonically and a packet lives in the slot of its index modulo end_idx.
+// The host reserves the slots with a CAS on the index, the same way as the read_pipe() and
+// write_pipe() builtins, hence the host and the kernels can share either end of the pipe.
+static size_t ReservePipeSlots(size_t* index, size_t limit, size_t count, size_t* start) {
+  static_assert(sizeof(std::atomic<size_t>) == sizeof(size_t), "Unexpected atomic size");
+  std::atomic<size_t>* atomicIndex = reinterpret_cast<std::atomic<size_t>*>(index);
+  size_t idx = atomicIndex->load(std::memory_order_acquire);
+  size_t reserved = 0;
+  do {
+    if (idx >= limit) {
+      return 0;
+    }
+    reserved = std::min(count, limit - idx);
+  } while (!atomicIndex->compare_exchange_weak(idx, idx + reserved, std::memory_order_acq_rel,
+                                                std::memory_order_acquire));
+  *start = idx;
+  return reserved;
+}
+
+// ================================================================================================
+size_t Pipe::hostWrite(const void* packets, size_t count) {
+  clk_pipe_t* pipe = reinterpret_cast<clk_pipe_t*>(getSvmPtr());
+  const size_t readIdx =
+      reinterpret_cast<std::atomic<size_t>*>(&pipe->read_idx)->load(std::memory_order_acquire);
+  size_t start = 0;
+  const size_t written = ReservePipeSlots(&pipe->write_idx, readIdx + maxPackets_, count, &start);
+  for (size_t i = 0; i < written; ++i) {
+    ::memcpy(pipe->packets + ((start + i) % maxPackets_) * packetSize_,
+             reinterpret_cast<const char*>(packets) + i * packetSize_, packetSize_);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  return written;
+}
+
+// ================================================================================================
+size_t Pipe::hostRead(void* packets, size_t count) {
+  clk_pipe_t* pipe = reinterpret_cast<clk_pipe_t*>(getSvmPtr());
+  const size_t writeIdx =
+      reinterpret_cast<std::atomic<size_t>*>(&pipe->write_idx)->load(std::memory_order_acquire);
+  size_t start = 0;
+  const size_t read = ReservePipeSlots(&pipe->read_idx, writeIdx, count, &start);
+  for (size_t i = 0; i < read; ++i) {
+    ::memcpy(reinterpret_cast<char*>(packets) + i * packetSize_,
+             pipe->packets + ((start + i) % maxPackets_) * packetSize_, packetSize_);
+  }
+  return read;
+}
+
 #define GETMIPDIM(dim, mip) (((dim >> mip) > 0) ? (dim >> mip) : 1)
 
 Image::Image(const Format& format, Image& parent, uint baseMipLevel, cl_mem_flags flags)
@@ -1487,7 +1536,7 @@ void SvmBuffer::Remove(uintptr_t k) {
 }
 
 bool SvmBuffer::Contains(uintptr_t ptr) {
-  ScopedLock lock(AllocatedLock_);
+  ScopedSharedLock lock(AllocatedLock_);
   auto it = Allocated_.upper_bound(ptr);
   if (it == Allocated_.begin()) {
     return false;
@@ -41,6 +41,12 @@
 #define ROCCLR_MEM_HSA_SIGNAL_MEMORY                (1u << 30)
 #define ROCCLR_MEM_INTERNAL_MEMORY                  (1u << 29)
 #define CL_MEM_VA_RANGE_AMD                         (1u << 28)
+#define ROCCLR_MEM_HUGE_PAGES                       (1u << 27)
+//! NUMA placement of the host memory, the bits 32-47 of the flags have the node
+#define ROCCLR_MEM_NUMA_NODE                        (1ull << 63)
+#define ROCCLR_MEM_NUMA_INTERLEAVE                  (1ull << 62)
+#define ROCCLR_MEM_NUMA_NODE_SHIFT                  32
+#define ROCCLR_MEM_NUMA_NODE_ID(flags)              (((flags) >> ROCCLR_MEM_NUMA_NODE_SHIFT) & 0xffff)
 
 namespace device {
 class Memory;
@@ -403,6 +409,8 @@ class Buffer : public Memory {
 
   Buffer(Context& context, Type type, Flags flags, size_t size)
       : Memory(context, type, flags, size) {}
+  Buffer(Memory& parent, Type type, Flags flags, size_t origin, size_t size)
+      : Memory(parent, flags, origin, size, type) {}
 
  public:
   Buffer(Context& context, Flags flags, size_t size, void* svmPtr = NULL)
@@ -448,6 +456,13 @@ class Pipe : public Buffer {
     maxPackets_ = pipe_max_packets;
   }
 
+  //! Creates a pipe in the fine grain SVM memory of \a parent, the host accesses the ring directly
+  Pipe(Memory& parent, Flags flags, size_t pipe_packet_size, size_t pipe_max_packets)
+      : Buffer(parent, CL_MEM_OBJECT_PIPE, flags, 0, parent.getSize()), initialized_(false) {
+    packetSize_ = pipe_packet_size;
+    maxPackets_ = pipe_max_packets;
+  }
+
   //! static_cast to Pipe with sanity check
   virtual Pipe* asPipe() { return this; }
 
@@ -456,6 +471,15 @@ class Pipe : public Buffer {
 
   //! return max number of pipe packets
   size_t getMaxNumPackets() const { return maxPackets_; }
+
+  //! Returns true if the host can produce into and consume from the ring directly
+  bool hostAccess() const { return (getSvmPtr() != nullptr) && (parent() != nullptr); }
+
+  //! Writes up to \a count packets without blocking, returns the number of written packets
+  size_t hostWrite(const void* packets, size_t count);
+
+  //! Reads up to \a count packets without blocking, returns the number of read packets
+  size_t hostRead(void* packets, size_t count);
 };
 
 //! Images are a specialization of memory
@@ -658,16 +682,18 @@ class LiquidFlashFile : public RuntimeObject {
   std::wstring name_;
   cl_file_flags_amd flags_;
   void* handle_;
+  int fd_;  //!< POSIX file, if the LF library isn't available
   uint32_t blockSize_;
   uint64_t fileSize_;
 
  public:
   LiquidFlashFile(const wchar_t* name, cl_file_flags_amd flags)
-      : name_(name), flags_(flags), handle_(NULL), blockSize_(0), fileSize_(0) {}
+      : name_(name), flags_(flags), handle_(NULL), fd_(-1), blockSize_(0), fileSize_(0) {}
 
   ~LiquidFlashFile();
 
-  bool open();
+  //! Opens the file, \a direct bypasses the page cache for the block aligned transfers
+  bool open(bool direct = true);
   void close();
 
   uint32_t blockSize() const { return blockSize_; };
@@ -0,0 +1,131 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+#include "platform/memstats.hpp"
+#include "os/os.hpp"
+#include "utils/debug.hpp"
+
+#include <algorithm>
+
+namespace amd {
+
+thread_local MemoryStats::Category MemoryStats::category_tls_ = MemoryStats::Other;
+thread_local uint64_t MemoryStats::tag_tls_ = 0;
+thread_local uint64_t MemoryStats::user_tag_tls_ = 0;
+
+// ================================================================================================
+const char* MemoryStats::name(Category category) {
+  static const char* kNames[CategoryCount] = {"Other",   "Malloc",  "HostMalloc", "Managed",
+                                              "MemPool", "Vmm",     "SubAlloc",   "Staging",
+                                              "Kernarg", "Blit",    "DeviceHeap"};
+  return (category < CategoryCount) ? kNames[category] : "Unknown";
+}
+
+// ================================================================================================
+void MemoryStats::allocated(const void* ptr, size_t size, bool host) {
+  if (!ROC_MEMORY_STATS || (ptr == nullptr)) {
+    return;
+  }
+  const Allocation alloc = {size, tag(), category_tls_, host};
+  ScopedLock lock(lock_);
+  // The same memory can be reported by nested allocators, only the first report counts
+  if (!allocs_.emplace(ptr, alloc).second) {
+    return;
+  }
+  Usage& usage = usage_[host][alloc.category_];
+  usage.current_ += size;
+  usage.peak_ = std::max(usage.peak_, usage.current_);
+  ++usage.count_;
+  if (alloc.tag_ != 0) {
+    tagBytes_[alloc.tag_] += size;
+  }
+  periodicDump();
+}
+
+// ================================================================================================
+void MemoryStats::freed(const void* ptr) {
+  if (!ROC_MEMORY_STATS || (ptr == nullptr)) {
+    return;
+  }
+  ScopedLock lock(lock_);
+  auto it = allocs_.find(ptr);
+  if (it == allocs_.end()) {
+    return;
+  }
+  const Allocation& alloc = it->second;
+  Usage& usage = usage_[alloc.host_][alloc.category_];
+  usage.current_ -= alloc.size_;
+  --usage.count_;
+  if (alloc.tag_ != 0) {
+    auto tagIt = tagBytes_.find(alloc.tag_);
+    tagIt->second -= alloc.size_;
+    if (tagIt->second == 0) {
+      tagBytes_.erase(tagIt);
+    }
+  }
+  allocs_.erase(it);
+  periodicDump();
+}
+
+// ================================================================================================
+MemoryStats::Usage MemoryStats::usage(Category category, bool host) const {
+  ScopedLock lock(lock_);
+  return usage_[host][category];
+}
+
+// ================================================================================================
+void MemoryStats::tags(std::vector<std::pair<uint64_t, uint64_t>>* tags) const {
+  ScopedLock lock(lock_);
+  tags->assign(tagBytes_.begin(), tagBytes_.end());
+  std::sort(tags->begin(), tags->end(),
+            [](const auto& a, const auto& b) { return a.second > b.second; });
+}
+
+// ================================================================================================
+void MemoryStats::dump() const {
+  ScopedLock lock(lock_);
+  for (uint32_t i = 0; i < CategoryCount; ++i) {
+    const Usage& device = usage_[false][i];
+    const Usage& host = usage_[true][i];
+    if ((device.peak_ == 0) && (host.peak_ == 0)) {
+      continue;
+    }
+    ClPrint(LOG_INFO, LOG_ALWAYS, "Memory %-10s: device %zu bytes in %zu (peak %zu), "
+            "host %zu bytes in %zu (peak %zu)", name(static_cast<Category>(i)),
+            device.current_, device.count_, device.peak_, host.current_, host.count_,
+            host.peak_);
+  }
+  for (const auto& it : tagBytes_) {
+    ClPrint(LOG_INFO, LOG_ALWAYS, "Memory tag 0x%zx: %zu bytes", it.first, it.second);
+  }
+}
+
+// ================================================================================================
+void MemoryStats::periodicDump() {
+  if (ROC_MEMORY_STATS_DUMP == 0) {
+    return;
+  }
+  const uint64_t now = Os::timeNanos();
+  if (now - lastDump_ >= static_cast<uint64_t>(ROC_MEMORY_STATS_DUMP) * 1000000) {
+    lastDump_ = now;
+    dump();
+  }
+}
+
+}  // namespace amd
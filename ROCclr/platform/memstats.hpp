@@ -0,0 +1,122 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+#pragma once
+
+#include "top.hpp"
+#include "thread/monitor.hpp"
+#include "utils/flags.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+namespace amd {
+
+/*! \brief Footprint of the device and the host allocations of a device
+ *
+ *  Every allocation is attributed to the category and the tag of the thread at the time of
+ *  the allocation. The HIP APIs and the internal pools set the category with a Scope, the
+ *  application sets the tag with hipExtMemSetTag() or the memory pools use the stream.
+ */
+class MemoryStats : public HeapObject {
+ public:
+  enum Category : uint32_t {
+    Other = 0,   //!< Allocations outside of any scope
+    Malloc,      //!< hipMalloc and its variants
+    HostMalloc,  //!< hipHostMalloc
+    Managed,     //!< hipMallocManaged
+    MemPool,     //!< Memory pool growth, hipMallocAsync
+    Vmm,         //!< Physical allocations of hipMemCreate
+    SubAlloc,    //!< Chunks of the small buffer suballocator
+    Staging,     //!< Staging buffers of the transfers
+    Kernarg,     //!< Kernel argument pools of the queues
+    Blit,        //!< Constant and batch buffers of the blit kernels
+    DeviceHeap,  //!< Heap of the device side malloc
+    CategoryCount
+  };
+
+  struct Usage {
+    uint64_t current_ = 0;  //!< Allocated bytes
+    uint64_t peak_ = 0;     //!< Largest value of current_
+    uint64_t count_ = 0;    //!< Live allocations
+  };
+
+  //! Attributes the allocations of this thread to a category for the scope lifetime
+  class Scope : public StackObject {
+   public:
+    Scope(Category category, uint64_t tag = 0) : category_(category_tls_), tag_(tag_tls_) {
+      category_tls_ = category;
+      if (tag != 0) {
+        tag_tls_ = tag;
+      }
+    }
+    ~Scope() {
+      category_tls_ = category_;
+      tag_tls_ = tag_;
+    }
+
+   private:
+    Category category_;  //!< Category of the outer scope
+    uint64_t tag_;       //!< Tag of the outer scope
+  };
+
+  //! Sets the tag of the next allocations of this thread, 0 clears it
+  static void setTag(uint64_t tag) { user_tag_tls_ = tag; }
+  static uint64_t tag() { return (tag_tls_ != 0) ? tag_tls_ : user_tag_tls_; }
+
+  //! Records an allocation in the current category and tag
+  void allocated(const void* ptr, size_t size, bool host);
+
+  //! Releases the footprint of \a ptr, the unknown pointers are ignored
+  void freed(const void* ptr);
+
+  //! Returns the usage of a category
+  Usage usage(Category category, bool host) const;
+
+  //! Returns the current bytes of every tag with live allocations
+  void tags(std::vector<std::pair<uint64_t, uint64_t>>* tags) const;
+
+  //! Prints the usage of all categories and tags into the log
+  void dump() const;
+
+  static const char* name(Category category);
+
+ private:
+  struct Allocation {
+    size_t size_;
+    uint64_t tag_;
+    Category category_;
+    bool host_;
+  };
+
+  //! Dumps the usage every ROC_MEMORY_STATS_DUMP ms, expects lock_
+  void periodicDump();
+
+  mutable Monitor lock_{"Memory stats", true};  //!< Recursive for the dumps
+  std::unordered_map<const void*, Allocation> allocs_;  //!< Live allocations
+  std::unordered_map<uint64_t, uint64_t> tagBytes_;      //!< Current bytes per tag
+  Usage usage_[2][CategoryCount];                        //!< Device and host usage
+  uint64_t lastDump_ = 0;                                //!< Time of the last dump in ns
+
+  static thread_local Category category_tls_;
+  static thread_local uint64_t tag_tls_;
+  static thread_local uint64_t user_tag_tls_;
+};
+
+}  // namespace amd
@@ -42,7 +42,8 @@
   F(cl_counter_amd, Counter)                                                                       \
   F(cl_perfcounter_amd, PerfCounter)                                                               \
   F(cl_threadtrace_amd, ThreadTrace)                                                               \
-  F(cl_file_amd, LiquidFlashFile)
+  F(cl_file_amd, LiquidFlashFile)                                                                  \
+  F(cl_command_buffer_amd, CommandBuffer)
 
 
 #define CL_TYPES_DO(F)                                                                             \
@@ -144,7 +145,8 @@ class RuntimeObject : public ReferenceCountedObject, public ICDDispatchedObject
     ObjectTypeQueue = 8,
     ObjectTypeSampler = 9,
     ObjectTypeThreadTrace = 10,
-    ObjectTypeLiquidFlashFile = 11
+    ObjectTypeLiquidFlashFile = 11,
+    ObjectTypeCommandBuffer = 12
   };
 
   virtual ObjectType objectType() const = 0;
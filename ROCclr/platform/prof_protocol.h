@@ -86,5 +86,8 @@ typedef void* (*activity_sync_callback_t)(uint32_t cid, activity_record_t* recor
 // Activity async calback type
 typedef void (*activity_id_callback_t)(activity_correlation_id_t id);
 typedef void (*activity_async_callback_t)(uint32_t op, void* record, void* arg);
+// Activity batch calback type, the records carry their op
+typedef void (*activity_batch_callback_t)(const activity_record_t* records, uint32_t count,
+                                          void* arg);
 
 #endif  // INC_EXT_PROF_PROTOCOL_H_
@@ -31,9 +31,12 @@
 
 #include <cstdlib>  // for malloc
 #include <cstring>  // for strcmp
+#include <deque>
+#include <functional>
 #include <sstream>
 #include <fstream>
 #include <iostream>
+#include <thread>
 #include <utility>
 
 namespace amd {
@@ -229,6 +232,40 @@ device::Program* Program::getDeviceProgram(const Device& device) const {
 
 Monitor Program::buildLock_("OCL build program", true);
 
+// Runs the compile, link or build jobs of the device programs. The jobs of LC devices don't share
+// any state, hence they run concurrently. The results are merged in the device order, so the
+// returned error doesn't depend on the timing
+static int32_t runDeviceJobs(const std::vector<std::function<int32_t()>>& jobs, bool parallel,
+                             int32_t retval) {
+  std::vector<int32_t> results(jobs.size(), CL_SUCCESS);
+  if (parallel && OCL_PARALLEL_BUILD && (jobs.size() > 1)) {
+    std::vector<std::thread> threads;
+    threads.reserve(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      threads.emplace_back([&jobs, &results, i]() { results[i] = jobs[i](); });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  } else {
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      results[i] = jobs[i]();
+    }
+  }
+
+  for (const auto result : results) {
+    // Check if the previous device failed a build
+    if ((result != CL_SUCCESS) && (retval != CL_SUCCESS)) {
+      retval = CL_INVALID_OPERATION;
+    }
+    // Update the returned value with a build error
+    else if (result != CL_SUCCESS) {
+      retval = result;
+    }
+  }
+  return retval;
+}
+
 int32_t Program::compile(const std::vector<Device*>& devices, size_t numHeaders,
                         const std::vector<const Program*>& headerPrograms,
                         const char** headerIncludeNames, const char* options,
@@ -262,8 +299,11 @@ int32_t Program::compile(const std::vector<Device*>& devices, size_t numHeaders,
   }
 
   // Compile the program programs associated with the given devices.
+  std::deque<option::Options> devOptions;
+  std::vector<std::function<int32_t()>> jobs;
+  bool parallel = true;
   for (const auto& it : devices) {
-    option::Options parsedOptions;
+    option::Options& parsedOptions = devOptions.emplace_back();
     constexpr bool LinkOptsOnly = false;
     if (!ParseAllOptions(cppstr, parsedOptions, optionChangable, LinkOptsOnly,
                          it->settings().useLightning_)) {
@@ -291,18 +331,13 @@ int32_t Program::compile(const std::vector<Device*>& devices, size_t numHeaders,
     if (sourceCode_.empty()) {
       return CL_INVALID_OPERATION;
     }
-    int32_t result =
-        devProgram->compile(sourceCode_, headers, headerIncludeNames, options, &parsedOptions);
-
-    // Check if the previous device failed a build
-    if ((result != CL_SUCCESS) && (retval != CL_SUCCESS)) {
-      retval = CL_INVALID_OPERATION;
-    }
-    // Update the returned value with a build error
-    else if (result != CL_SUCCESS) {
-      retval = result;
-    }
+    parallel &= it->settings().useLightning_;
+    jobs.push_back([this, devProgram, &headers, headerIncludeNames, options, &parsedOptions]() {
+      return devProgram->compile(sourceCode_, headers, headerIncludeNames, options,
+                                 &parsedOptions);
+    });
   }
+  retval = runDeviceJobs(jobs, parallel, retval);
 
   if (notifyFptr != NULL) {
     notifyFptr(as_cl(this), data);
@@ -343,8 +378,12 @@ int32_t Program::link(const std::vector<Device*>& devices, size_t numInputs,
   }
 
   // Link the program programs associated with the given devices.
+  std::deque<option::Options> devOptions;
+  std::deque<std::vector<device::Program*>> devInputs;
+  std::vector<std::function<int32_t()>> jobs;
+  bool parallel = true;
   for (const auto& it : devices) {
-    option::Options parsedOptions;
+    option::Options& parsedOptions = devOptions.emplace_back();
     constexpr bool LinkOptsOnly = true;
     if (!ParseAllOptions(cppstr, parsedOptions, optionChangable, LinkOptsOnly,
                          it->settings().useLightning_)) {
@@ -353,7 +392,7 @@ int32_t Program::link(const std::vector<Device*>& devices, size_t numInputs,
       return CL_INVALID_LINKER_OPTIONS;
     }
     // find the corresponding device program in each input program
-    std::vector<device::Program*> inputDevPrograms(numInputs);
+    std::vector<device::Program*>& inputDevPrograms = devInputs.emplace_back(numInputs);
     bool found = false;
     for (size_t i = 0; i < numInputs; ++i) {
       Program& inputProgram = *inputPrograms[i];
@@ -413,17 +452,12 @@ int32_t Program::link(const std::vector<Device*>& devices, size_t numInputs,
     if (devProgram->buildStatus() != CL_BUILD_NONE) {
       continue;
     }
-    int32_t result = devProgram->link(inputDevPrograms, options, &parsedOptions);
-
-    // Check if the previous device failed a build
-    if ((result != CL_SUCCESS) && (retval != CL_SUCCESS)) {
-      retval = CL_INVALID_OPERATION;
-    }
-    // Update the returned value with a build error
-    else if (result != CL_SUCCESS) {
-      retval = result;
-    }
+    parallel &= it->settings().useLightning_;
+    jobs.push_back([devProgram, &inputDevPrograms, options, &parsedOptions]() {
+      return devProgram->link(inputDevPrograms, options, &parsedOptions);
+    });
   }
+  retval = runDeviceJobs(jobs, parallel, retval);
 
   if (retval != CL_SUCCESS) {
     return retval;
@@ -432,7 +466,7 @@ int32_t Program::link(const std::vector<Device*>& devices, size_t numInputs,
   // Rebuild the symbol table
   for (const auto& sit : devicePrograms_) {
     const Device& device = *(sit.first);
-    const device::Program& program = *(sit.second);
+    device::Program& program = *(sit.second);
 
     const device::Program::kernels_t& kernels = program.kernels();
     for (const auto& it : kernels) {
@@ -440,7 +474,9 @@ int32_t Program::link(const std::vector<Device*>& devices, size_t numInputs,
       const device::Kernel* devKernel = it.second;
 
       Symbol& symbol = (*symbolTable_)[name];
-      if (!symbol.setDeviceKernel(device, devKernel)) {
+      if (devKernel == nullptr) {
+        symbol.setPendingKernel(device, &program, name);
+      } else if (!symbol.setDeviceKernel(device, devKernel)) {
         retval = CL_LINK_PROGRAM_FAILURE;
       }
     }
@@ -528,8 +564,11 @@ int32_t Program::build(const std::vector<Device*>& devices, const char* options,
   }
 
   // Build the program programs associated with the given devices.
+  std::deque<option::Options> devOptions;
+  std::vector<std::function<int32_t()>> jobs;
+  bool parallel = true;
   for (const auto& it : devices) {
-    option::Options parsedOptions;
+    option::Options& parsedOptions = devOptions.emplace_back();
     constexpr bool LinkOptsOnly = false;
     if ((language_ != HIP) && !ParseAllOptions(cppstr, parsedOptions, optionChangable, LinkOptsOnly,
                          it->settings().useLightning_)) {
@@ -571,23 +610,18 @@ int32_t Program::build(const std::vector<Device*>& devices, const char* options,
     if (devProgram->buildStatus() != CL_BUILD_NONE) {
       continue;
     }
-    int32_t result = devProgram->build(sourceCode_, options, &parsedOptions, precompiledHeaders_);
-
-    // Check if the previous device failed a build
-    if ((result != CL_SUCCESS) && (retval != CL_SUCCESS)) {
-      retval = CL_INVALID_OPERATION;
-    }
-    // Update the returned value with a build error
-    else if (result != CL_SUCCESS) {
-      retval = result;
-    }
+    parallel &= it->settings().useLightning_;
+    jobs.push_back([this, devProgram, options, &parsedOptions]() {
+      return devProgram->build(sourceCode_, options, &parsedOptions, precompiledHeaders_);
+    });
   }
+  retval = runDeviceJobs(jobs, parallel, retval);
 
   if (retval == CL_SUCCESS) {
     // Rebuild the symbol table
     for (const auto& it : devicePrograms_) {
       const Device& device = *(it.first);
-      const device::Program& program = *(it.second);
+      device::Program& program = *(it.second);
 
       const device::Program::kernels_t& kernels = program.kernels();
       for (const auto& kit : kernels) {
@@ -595,7 +629,9 @@ int32_t Program::build(const std::vector<Device*>& devices, const char* options,
         const device::Kernel* devKernel = kit.second;
 
         Symbol& symbol = (*symbolTable_)[name];
-        if (!symbol.setDeviceKernel(device, devKernel)) {
+        if (devKernel == nullptr) {
+          symbol.setPendingKernel(device, &program, name);
+        } else if (!symbol.setDeviceKernel(device, devKernel)) {
           retval = CL_BUILD_PROGRAM_FAILURE;
         }
       }
@@ -713,6 +749,7 @@ bool Program::ParseAllOptions(const std::string& options, option::Options& parse
 }
 
 bool Symbol::setDeviceKernel(const Device& device, const device::Kernel* func) {
+  pendingKernels_.erase(&device);
   if (deviceKernels_.size() == 0 ||
       // Always pick the most recent version in MGPU case
       (func->signature().version() > signature_.version())) {
@@ -722,7 +759,40 @@ bool Symbol::setDeviceKernel(const Device& device, const device::Kernel* func) {
   return true;
 }
 
+void Symbol::setPendingKernel(const Device& device, device::Program* program,
+                              const std::string& name) {
+  // The signature of a lazy kernel is available after the creation on the first use
+  deviceKernels_.erase(&device);
+  pendingKernels_[&device] = program;
+  name_ = name;
+  pendingInit_ = true;
+}
+
+void Symbol::lazyInit() const {
+  static Monitor lock("Symbol lazy init lock");
+  ScopedLock sl(lock);
+  if (!pendingInit_) {
+    return;
+  }
+  for (const auto& it : pendingKernels_) {
+    const device::Kernel* func = it.second->getKernel(name_);
+    if (func == nullptr) {
+      // The kernel isn't available on the failed device, getDeviceKernel() returns NULL
+      continue;
+    }
+    if (deviceKernels_.size() == 0 || (func->signature().version() > signature_.version())) {
+      signature_ = func->signature();
+    }
+    deviceKernels_[it.first] = func;
+  }
+  pendingKernels_.clear();
+  pendingInit_ = false;
+}
+
 const device::Kernel* Symbol::getDeviceKernel(const Device& device) const {
+  if (pendingInit_) {
+    lazyInit();
+  }
   auto it = deviceKernels_.find(&device);
   if (it != deviceKernels_.cend()) {
     return it->second;
@@ -33,6 +33,7 @@
 #include "platform/object.hpp"
 #include "platform/kernel.hpp"
 
+#include <atomic>
 #include <set>
 #include <string>
 #include <vector>
@@ -53,10 +54,17 @@ namespace amd {
 class Symbol : public HeapObject {
  public:
   typedef std::unordered_map<const Device*, const device::Kernel*> devicekernels_t;
+  typedef std::unordered_map<const Device*, device::Program*> pendingkernels_t;
 
  private:
-  devicekernels_t deviceKernels_;    //! All device kernels objects.
-  KernelSignature signature_;        //! Kernel signature.
+  mutable devicekernels_t deviceKernels_;    //! All device kernels objects.
+  mutable pendingkernels_t pendingKernels_;  //! Device programs without the kernel object yet
+  std::string name_;                         //! Kernel name for the lookup in pendingKernels_
+  mutable KernelSignature signature_;  //! Kernel signature.
+  mutable std::atomic<bool> pendingInit_{false};  //! The device kernels need the setup
+
+  //! Creates the device kernels of the lazy device programs
+  void lazyInit() const;
 
  public:
   //! Default constructor
@@ -67,12 +75,23 @@ class Symbol : public HeapObject {
                        const device::Kernel* func   //!< Device kernel object.
                        );
 
+  //! Defers the device kernel to the first use, \a program creates it on the lookup
+  void setPendingKernel(const Device& device,      //!< Device object.
+                        device::Program* program,  //!< Device program of the kernel.
+                        const std::string& name    //!< Kernel name.
+                        );
+
   //! Return the device kernel.
   const device::Kernel* getDeviceKernel(const Device& device //!< Device object.
                                         ) const;
 
   //! Return this Symbol's signature.
-  const KernelSignature& signature() const { return signature_; }
+  const KernelSignature& signature() const {
+    if (pendingInit_) {
+      lazyInit();
+    }
+    return signature_;
+  }
 };
 
 class Context;
@@ -26,6 +26,7 @@
 #include "utils/options.hpp"
 #include "platform/context.hpp"
 #include "platform/agent.hpp"
+#include "platform/timeline.hpp"
 
 #include "amdocl/cl_gl_amd.hpp"
 
@@ -47,6 +48,7 @@ namespace amd {
 
 volatile bool Runtime::initialized_ = false;
 bool Runtime::LibraryDetached = false;
+bool Runtime::FastExit = false;
 
 bool Runtime::init() {
   if (initialized_) {
@@ -79,6 +81,10 @@ bool Runtime::init() {
     return false;
   }
 
+  if (!flagIsDefault(ROC_TIMELINE_FILE) && !Timeline::open(ROC_TIMELINE_FILE)) {
+    LogPrintfError("Failed to open the timeline file %s", ROC_TIMELINE_FILE);
+  }
+
   initialized_ = true;
   ClTrace(LOG_DEBUG, LOG_INIT);
   return true;
@@ -90,16 +96,31 @@ void Runtime::tearDown() {
   }
   ClTrace(LOG_DEBUG, LOG_INIT);
 
+  Timeline::close();
   Agent::tearDown();
   Device::tearDown();
   option::teardown();
   Flag::tearDown();
+  trace_close();
   if (outFile != stderr && outFile != nullptr) {
     fclose(outFile);
   }
   initialized_ = false;
 }
 
+void Runtime::fastExit() {
+  if (!initialized_ || FastExit) {
+    return;
+  }
+  ClPrint(LOG_INFO, LOG_INIT, "Fast exit, skipping the tear down");
+  FastExit = true;
+  Timeline::close();
+  trace_close();
+  if (outFile != nullptr) {
+    fflush(outFile);
+  }
+}
+
 class RuntimeTearDown : public amd::HeapObject {
 public:
   RuntimeTearDown() {}
@@ -33,6 +33,7 @@ namespace amd {
 class Runtime : AllStatic {
   static volatile bool initialized_;
   static bool LibraryDetached;
+  static bool FastExit;
 
  public:
   //! Return true if the OpencCL runtime is already initialized
@@ -44,6 +45,12 @@ class Runtime : AllStatic {
   //! Tear down the runtime.
   static void tearDown();
 
+  //! Flushes the profiling output at the process exit without the tear down
+  static void fastExit();
+
+  //! Returns true after fastExit(), the objects skip their release then
+  static bool isFastExit() { return FastExit; }
+
   //! Return true if the Runtime is still single-threaded.
   static bool singleThreaded() { return !initialized(); }
 
@@ -0,0 +1,184 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "platform/timeline.hpp"
+#include "platform/command.hpp"
+#include "platform/commandqueue.hpp"
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace amd {
+
+bool Timeline::enabled_ = false;
+
+namespace {
+
+struct TimelineEvent {
+  uint64_t start_;          //!< GPU start time in ns
+  uint64_t end_;            //!< GPU end time in ns
+  uint64_t hwQueue_;        //!< HW queue of the command
+  uint64_t correlationId_;  //!< Activity record ID, 0 without the activity profiling
+  cl_command_type type_;    //!< Command type
+  uint32_t device_;         //!< Device index
+  uint32_t queue_;          //!< Virtual device index of the queue
+  std::string name_;        //!< Kernel name of the dispatch
+};
+
+//! Events of a thread, the lock is only contended by the final write
+struct TimelineBuffer {
+  std::mutex lock_;
+  std::vector<TimelineEvent> events_;
+};
+
+std::mutex timelineLock;                     //!< Protects the buffer list
+std::vector<TimelineBuffer*> timelineBuffers; //!< The buffers are never freed, like the threads
+FILE* timelineFile = nullptr;
+
+// ================================================================================================
+TimelineBuffer* timelineBuffer() {
+  thread_local TimelineBuffer* buffer = nullptr;
+  if (buffer == nullptr) {
+    buffer = new TimelineBuffer();
+    std::lock_guard<std::mutex> lock(timelineLock);
+    timelineBuffers.push_back(buffer);
+  }
+  return buffer;
+}
+
+// ================================================================================================
+const char* commandName(cl_command_type type) {
+  switch (type) {
+    case CL_COMMAND_NDRANGE_KERNEL:
+    case CL_COMMAND_TASK:
+      return "Kernel";
+    case CL_COMMAND_READ_BUFFER:
+    case CL_COMMAND_READ_BUFFER_RECT:
+    case CL_COMMAND_READ_IMAGE:
+      return "CopyDeviceToHost";
+    case CL_COMMAND_WRITE_BUFFER:
+    case CL_COMMAND_WRITE_BUFFER_RECT:
+    case CL_COMMAND_WRITE_IMAGE:
+      return "CopyHostToDevice";
+    case CL_COMMAND_COPY_BUFFER:
+    case CL_COMMAND_COPY_BUFFER_RECT:
+    case CL_COMMAND_COPY_IMAGE:
+    case CL_COMMAND_COPY_IMAGE_TO_BUFFER:
+    case CL_COMMAND_COPY_BUFFER_TO_IMAGE:
+      return "CopyDeviceToDevice";
+    case CL_COMMAND_FILL_BUFFER:
+    case CL_COMMAND_FILL_IMAGE:
+      return "Fill";
+    case CL_COMMAND_MARKER:
+      return "Marker";
+    case CL_COMMAND_BARRIER:
+      return "Barrier";
+    default:
+      return "Command";
+  }
+}
+
+// ================================================================================================
+//! Writes the string with the JSON escapes
+void writeJsonString(const char* str) {
+  fputc('"', timelineFile);
+  for (; *str != '\0'; ++str) {
+    if ((*str == '"') || (*str == '\\')) {
+      fputc('\\', timelineFile);
+      fputc(*str, timelineFile);
+    } else if (static_cast<unsigned char>(*str) < 0x20) {
+      fprintf(timelineFile, "\\u%04x", *str);
+    } else {
+      fputc(*str, timelineFile);
+    }
+  }
+  fputc('"', timelineFile);
+}
+
+}  // namespace
+
+// ================================================================================================
+bool Timeline::open(const char* fileName) {
+  timelineFile = fopen(fileName, "w");
+  if (timelineFile == nullptr) {
+    return false;
+  }
+  enabled_ = true;
+  return true;
+}
+
+// ================================================================================================
+void Timeline::record(const Command& command) {
+  const auto& info = command.profilingInfo();
+  if (!info.enabled_ || (info.start_ == 0) || (command.queue() == nullptr)) {
+    return;
+  }
+  TimelineBuffer* buffer = timelineBuffer();
+  std::lock_guard<std::mutex> lock(buffer->lock_);
+  buffer->events_.push_back(TimelineEvent());
+  TimelineEvent& event = buffer->events_.back();
+  event.start_ = info.start_;
+  event.end_ = info.end_;
+  event.hwQueue_ = command.queue()->vdev()->hwQueueId();
+  event.correlationId_ = command.activity().RecordId();
+  event.type_ = command.type();
+  event.device_ = command.queue()->device().index();
+  event.queue_ = command.queue()->vdev()->index();
+  if (command.type() == CL_COMMAND_NDRANGE_KERNEL) {
+    event.name_ = static_cast<const NDRangeKernelCommand&>(command).kernel().name();
+  }
+}
+
+// ================================================================================================
+void Timeline::close() {
+  if (timelineFile == nullptr) {
+    return;
+  }
+  enabled_ = false;
+
+  // The timestamps are in us, the process is the device and the thread is the queue
+  std::lock_guard<std::mutex> lock(timelineLock);
+  fprintf(timelineFile, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  const char* separator = "\n";
+  for (auto buffer : timelineBuffers) {
+    std::lock_guard<std::mutex> bufferLock(buffer->lock_);
+    for (const auto& event : buffer->events_) {
+      fprintf(timelineFile, "%s{\"ph\":\"X\",\"cat\":\"%s\",\"name\":", separator,
+              commandName(event.type_));
+      writeJsonString(event.name_.empty() ? commandName(event.type_) : event.name_.c_str());
+      fprintf(timelineFile,
+              ",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"hwQueue\":%llu,"
+              "\"correlationId\":%llu,\"commandType\":%u}}",
+              event.device_, event.queue_, event.start_ / 1000.0,
+              (event.end_ - event.start_) / 1000.0,
+              static_cast<unsigned long long>(event.hwQueue_),
+              static_cast<unsigned long long>(event.correlationId_), event.type_);
+      separator = ",\n";
+    }
+    buffer->events_.clear();
+  }
+  fprintf(timelineFile, "\n]}\n");
+  fclose(timelineFile);
+  timelineFile = nullptr;
+}
+
+}  // namespace amd
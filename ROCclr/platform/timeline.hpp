@@ -0,0 +1,53 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include "top.hpp"
+
+namespace amd {
+
+class Command;
+
+/*! \brief Timeline of the executed commands in the Chrome trace format
+ *
+ *  Every completed command with the GPU timestamps is appended to the buffer of the
+ *  completing thread. The buffers are written into ROC_TIMELINE_FILE at the runtime
+ *  teardown as JSON, which chrome://tracing and Perfetto open directly.
+ */
+class Timeline : public AllStatic {
+ public:
+  //! Returns true if the timeline is recorded, all commands need the profiling then
+  static bool enabled() { return enabled_; }
+
+  //! Creates the timeline file and enables the recording
+  static bool open(const char* fileName);
+
+  //! Appends a completed command
+  static void record(const Command& command);
+
+  //! Writes all recorded commands and closes the file
+  static void close();
+
+ private:
+  static bool enabled_;
+};
+
+}  // namespace amd
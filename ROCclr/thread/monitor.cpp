@@ -23,6 +23,7 @@
 #include "thread/thread.hpp"
 #include "utils/util.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 #include <tuple>
@@ -31,7 +32,13 @@
 namespace amd {
 
 Monitor::Monitor(const char* name, bool recursive)
-    : contendersList_(0), onDeck_(0), waitersList_(NULL), owner_(NULL), recursive_(recursive) {
+    : contendersList_(0),
+      onDeck_(0),
+      waitersList_(NULL),
+      owner_(NULL),
+      recursive_(recursive),
+      readers_(0),
+      spinEstimate_(kMaxReadSpinIter / 2) {
   if (name == NULL) {
     const char* unknownName = "@unknown@";
     assert(sizeof(unknownName) < sizeof(name_) && "just checking");
@@ -43,21 +50,29 @@ Monitor::Monitor(const char* name, bool recursive)
 }
 
 bool Monitor::trySpinLock() {
-  if (tryLock()) {
+  if (tryAcquire()) {
     return true;
   }
 
-  for (int s = kMaxSpinIter; s > 0; --s) {
-    // First, be SMT friendly
-    if (s >= (kMaxSpinIter - kMaxReadSpinIter)) {
-      Os::spinPause();
-    }
-    // and then SMP friendly
-    else {
-      Thread::yield();
+  // First, be SMT friendly. Spin up to twice the iterations, which acquired the lock recently,
+  // so a short hold time keeps the spinning and a long one goes to sleep soon
+  const int32_t estimate = spinEstimate_.load(std::memory_order_relaxed);
+  const int32_t maxSpin = std::min(kMaxAdaptiveSpinIter, 2 * estimate + kMinAdaptiveSpinIter);
+  for (int32_t s = 0; s < maxSpin; ++s) {
+    Os::spinPause();
+    if (!isLocked() && tryAcquire()) {
+      spinEstimate_.store(estimate + (s - estimate) / 8, std::memory_order_relaxed);
+      return true;
     }
+  }
+  // Spinning didn't help, decay the estimate
+  spinEstimate_.store(estimate - estimate / 8, std::memory_order_relaxed);
+
+  // and then SMP friendly
+  for (int s = kMaxSpinIter - kMaxReadSpinIter; s > 0; --s) {
+    Thread::yield();
     if (!isLocked()) {
-      return tryLock();
+      return tryAcquire();
     }
   }
 
@@ -65,6 +80,29 @@ bool Monitor::trySpinLock() {
   return false;
 }
 
+void Monitor::finishLockShared() {
+  // The exclusive owner blocks this thread. The shared count can change only
+  // under the lock, so the writer, which took the lock after us, waits for this reader
+  if (!tryAcquire()) {
+    finishLock();
+  }
+  readers_.fetch_add(1, std::memory_order_relaxed);
+  unlock();
+}
+
+void Monitor::waitReaders() {
+  int32_t spinCount = 0;
+  while (readers_.load(std::memory_order_acquire) != 0) {
+    // The shared sections are short, spin before giving up the CPU
+    if (spinCount < kMaxReadSpinIter) {
+      Os::spinPause();
+    } else {
+      Thread::yield();
+    }
+    spinCount++;
+  }
+}
+
 void Monitor::finishLock() {
   Thread* thread = Thread::current();
   assert(thread != NULL && "cannot lock() from (null)");
@@ -87,7 +125,7 @@ void Monitor::finishLock() {
     // The assumption is that lockWord is locked. Make sure we do not
     // continue unless the lock bit is set.
     if ((head & kLockBit) == 0) {
-      if (tryLock()) {
+      if (tryAcquire()) {
         return;
       }
       continue;
@@ -130,7 +168,7 @@ void Monitor::finishLock() {
   //
   for (;;) {
     assert((onDeck_ & ~kLockBit) == reinterpret_cast<intptr_t>(&semaphore) && "just checking");
-    if (tryLock()) {
+    if (tryAcquire()) {
       break;
     }
 
@@ -284,6 +322,11 @@ void Monitor::wait() {
   lockCount_ = lockCount;
 
   onDeck_.store(0, std::memory_order_release);
+
+  // The shared owners could enter, while the lock was released
+  if (readers_.load(std::memory_order_seq_cst) != 0) {
+    waitReaders();
+  }
 }
 
 void Monitor::notify() {
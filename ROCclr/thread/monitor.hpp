@@ -77,6 +77,8 @@ class Monitor : public HeapObject {
 
   static constexpr int kMaxSpinIter = 55;      //!< Total number of spin iterations.
   static constexpr int kMaxReadSpinIter = 50;  //!< Read iterations before yielding
+  static constexpr int kMinAdaptiveSpinIter = 10;   //!< Lower bound of the adaptive spin
+  static constexpr int kMaxAdaptiveSpinIter = 500;  //!< Upper bound of the adaptive spin
 
   /*! Linked list of semaphores the contending threads are waiting on
    *  and main lock.
@@ -97,11 +99,23 @@ class Monitor : public HeapObject {
   //! True if this is a recursive mutex, false otherwise.
   const bool recursive_;
 
+  //! Number of the threads holding the shared lock.
+  std::atomic<uint32_t> readers_;
+  //! Running average of the spin iterations, which acquired the lock. Follows the hold time.
+  std::atomic<int32_t> spinEstimate_;
+
  private:
   //! Finish locking the mutex (contented case).
   void finishLock();
   //! Finish unlocking the mutex (contented case).
   void finishUnlock();
+  //! Finish the shared locking, while the exclusive lock is owned.
+  void finishLockShared();
+  //! Wait until the shared owners leave, after the exclusive lock was acquired.
+  void waitReaders();
+
+  //! Try to acquire the exclusive lock word, ignores the shared owners.
+  inline bool tryAcquire();
 
  protected:
   //! Try to spin-acquire the lock, return true if successful.
@@ -132,6 +146,18 @@ class Monitor : public HeapObject {
   //! Release the lock and wake a single waiting thread if any.
   inline void unlock();
 
+  /*! \brief Acquire the lock in the shared mode.
+   *
+   *  Many threads can own the shared lock at once, while the exclusive lock waits for all of
+   *  them. A waiting exclusive lock blocks the new shared owners, so the writers don't starve.
+   *
+   *  \note The shared lock isn't recursive and can't be upgraded to the exclusive lock.
+   */
+  inline void lockShared();
+
+  //! Release the shared lock.
+  void unlockShared() { readers_.fetch_sub(1, std::memory_order_release); }
+
   /*! \brief Give up the lock and go to sleep.
    *
    *  Calling wait() causes the current thread to go to sleep until
@@ -171,11 +197,21 @@ class ScopedLock : StackObject {
   }
 };
 
+class ScopedSharedLock : StackObject {
+ private:
+  Monitor& lock_;
+
+ public:
+  ScopedSharedLock(Monitor& lock) : lock_(lock) { lock_.lockShared(); }
+
+  ~ScopedSharedLock() { lock_.unlockShared(); }
+};
+
 /*! @}
  *  @}
  */
 
-inline bool Monitor::tryLock() {
+inline bool Monitor::tryAcquire() {
   Thread* thread = Thread::current();
   assert(thread != NULL && "cannot lock() from (null)");
 
@@ -190,8 +226,9 @@ inline bool Monitor::tryLock() {
     return false;  // Already locked!
   }
 
+  // Sequential consistency orders the lock bit against the readers_ check in lockShared()
   if (unlikely(!contendersList_.compare_exchange_weak(
-          ptr, ptr | kLockBit, std::memory_order_acq_rel, std::memory_order_acquire))) {
+          ptr, ptr | kLockBit, std::memory_order_seq_cst, std::memory_order_acquire))) {
     return false;  // We failed the CAS from unlocked to locked.
   }
 
@@ -201,11 +238,27 @@ inline bool Monitor::tryLock() {
   return true;
 }
 
+inline bool Monitor::tryLock() {
+  if (!tryAcquire()) {
+    return false;
+  }
+  if (unlikely((lockCount_ == 1) && (readers_.load(std::memory_order_seq_cst) != 0))) {
+    // The shared owners are still inside
+    unlock();
+    return false;
+  }
+  return true;
+}
+
 inline void Monitor::lock() {
-  if (unlikely(!tryLock())) {
+  if (unlikely(!tryAcquire())) {
     // The lock is contented.
     finishLock();
   }
+  if (unlikely((lockCount_ == 1) && (readers_.load(std::memory_order_seq_cst) != 0))) {
+    // New shared owners see the lock bit and wait, the current ones have to leave
+    waitReaders();
+  }
 
   // This is the beginning of the critical region. From now-on, everything
   // executes single-threaded!
@@ -260,6 +313,16 @@ inline void Monitor::unlock() {
   finishUnlock();
 }
 
+inline void Monitor::lockShared() {
+  readers_.fetch_add(1, std::memory_order_seq_cst);
+  if (likely(!isLocked())) {
+    return;
+  }
+  // An exclusive owner or a waiting writer, back off and queue on the lock
+  readers_.fetch_sub(1, std::memory_order_release);
+  finishLockShared();
+}
+
 }  // namespace amd
 
 #endif /*MONITOR_HPP_*/
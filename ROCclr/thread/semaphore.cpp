@@ -28,6 +28,11 @@
 #include <errno.h>
 #include <time.h>
 #endif  // !_WIN32
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // __linux__
 
 namespace amd {
 
@@ -137,4 +142,49 @@ void Semaphore::timedWait(int millis) {
 #endif  // !_WIN32
 }
 
+void Parker::park(uint64_t spinNanos) {
+  // Spin first, so a close enqueue doesn't pay for the sleep and the wake-up
+  if (spinNanos != 0) {
+    const uint64_t end = Os::timeNanos() + spinNanos;
+    do {
+      if (state_.load(std::memory_order_acquire) == kNotified) {
+        // Consume with RMW to synchronize with the last notification
+        state_.exchange(kEmpty, std::memory_order_acq_rel);
+        return;
+      }
+      Os::spinPause();
+    } while (Os::timeNanos() < end);
+  }
+
+  int state = kEmpty;
+  if (!state_.compare_exchange_strong(state, kParked, std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+    // The notification came in after the spin
+    state_.exchange(kEmpty, std::memory_order_acq_rel);
+    return;
+  }
+
+  while (state_.load(std::memory_order_acquire) == kParked) {
+#if defined(__linux__)
+    // EAGAIN means the state has changed already, EINTR requires a recheck
+    syscall(SYS_futex, reinterpret_cast<int*>(&state_), FUTEX_WAIT_PRIVATE, kParked,
+            nullptr, nullptr, 0);
+#else   // !__linux__
+    sem_.wait();
+#endif  // !__linux__
+  }
+  state_.exchange(kEmpty, std::memory_order_acq_rel);
+}
+
+void Parker::unpark() {
+  if (state_.exchange(kNotified, std::memory_order_acq_rel) == kParked) {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<int*>(&state_), FUTEX_WAKE_PRIVATE, 1,
+            nullptr, nullptr, 0);
+#else   // !__linux__
+    sem_.post();
+#endif  // !__linux__
+  }
+}
+
 }  // namespace amd
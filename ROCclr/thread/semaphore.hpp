@@ -70,6 +70,37 @@ public:
 static_assert(sizeof(Semaphore) == 64 ,
               "unexpected total size of Semaphore");
 
+/*! \brief Parking spot of a single consumer thread
+ *
+ *  The consumer spins for a bounded time before it parks in the kernel
+ *  (a futex on Linux), so unpark() doesn't need a syscall while the consumer
+ *  is still spinning. Any number of threads can unpark the consumer.
+ */
+class alignas(64) Parker : public HeapObject {
+ private:
+  static constexpr int kEmpty = 0;     //!< No pending notification
+  static constexpr int kNotified = 1;  //!< Pending notification
+  static constexpr int kParked = 2;    //!< The consumer sleeps in the kernel
+
+  std::atomic_int state_;  //!< The parking state
+#if !defined(__linux__)
+  Semaphore sem_;          //!< The sleep object if futex isn't available
+#endif /*!linux*/
+
+ public:
+  Parker() : state_(kEmpty) {}
+
+  /*! \brief Wait for a notification
+   *
+   *  Spins up to \a spinNanos before it parks, returns after the next unpark().
+   *  The notification can be spurious, so the caller must recheck its condition.
+   */
+  void park(uint64_t spinNanos);
+
+  //! \brief Wake up the consumer or make the next park() return immediately
+  void unpark();
+};
+
 /*! @}
  *  @}
  */
@@ -111,6 +111,45 @@ template <typename T, int N = 5> class ConcurrentLinkedQueue : public HeapObject
   inline bool empty();
 };
 
+/*! \brief A bounded thread-safe queue.
+ *
+ * This queue orders elements first-in-first-out. It is based on the bounded
+ * MPMC queue by Dmitry Vyukov: every cell carries a sequence number, which
+ * tells the producers and the consumers if the cell is free or filled.
+ * The queue doesn't allocate memory after the construction. The positions of
+ * the producers and the consumers are on separate cache lines.
+ */
+template <typename T> class ConcurrentRingQueue : public HeapObject {
+  //! A ring cell
+  struct Cell {
+    std::atomic<size_t> sequence_;  //!< The sequence number of the cell
+    T value_;                       //!< The value stored in that cell.
+  };
+
+  static constexpr size_t CacheLine = 64;
+
+ private:
+  alignas(CacheLine) std::atomic<size_t> enqueuePos_;  //!< The next position to fill
+  alignas(CacheLine) std::atomic<size_t> dequeuePos_;  //!< The next position to read
+  alignas(CacheLine) Cell* cells_;                     //!< The ring of cells
+  size_t mask_;                                        //!< The ring size minus one
+
+ public:
+  //! \brief Initialize a new ring queue with at least \a capacity elements.
+  explicit ConcurrentRingQueue(size_t capacity);
+  //! \brief Destroy this ring queue.
+  ~ConcurrentRingQueue();
+
+  //! \brief Enqueue an element to this queue, return false if the queue is full.
+  inline bool tryEnqueue(T elem);
+  //! \brief Dequeue an element from this queue, return NULL if the queue is empty.
+  inline T dequeue();
+  //! \brief Check if queue is empty
+  inline bool empty() const;
+  //! \brief Return the capacity of the queue
+  size_t capacity() const { return mask_ + 1; }
+};
+
 /*@}*/
 
 template <typename T, int N> inline ConcurrentLinkedQueue<T, N>::ConcurrentLinkedQueue() {
@@ -204,6 +243,86 @@ template <typename T, int N> inline bool ConcurrentLinkedQueue<T, N>::empty() {
   }
 }
 
+template <typename T>
+inline ConcurrentRingQueue<T>::ConcurrentRingQueue(size_t capacity)
+    : enqueuePos_(0), dequeuePos_(0) {
+  size_t size = 2;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  mask_ = size - 1;
+  cells_ = reinterpret_cast<Cell*>(AlignedMemory::allocate(sizeof(Cell) * size, CacheLine));
+  for (size_t i = 0; i < size; ++i) {
+    new (&cells_[i]) Cell();
+    cells_[i].sequence_.store(i, std::memory_order_relaxed);
+  }
+
+  // Make sure the instance is fully initialized before it becomes
+  // globally visible.
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename T> inline ConcurrentRingQueue<T>::~ConcurrentRingQueue() {
+  for (size_t i = 0; i <= mask_; ++i) {
+    cells_[i].~Cell();
+  }
+  AlignedMemory::deallocate(cells_);
+}
+
+template <typename T> inline bool ConcurrentRingQueue<T>::tryEnqueue(T elem) {
+  size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+  Cell* cell;
+  for (;;) {
+    cell = &cells_[pos & mask_];
+    size_t seq = cell->sequence_.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      // The cell is free, reserve it
+      if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // The consumers didn't free the cell yet, the queue is full
+      return false;
+    } else {
+      pos = enqueuePos_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->value_ = elem;
+  // Publish the value to the consumers
+  cell->sequence_.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T> inline T ConcurrentRingQueue<T>::dequeue() {
+  size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+  Cell* cell;
+  for (;;) {
+    cell = &cells_[pos & mask_];
+    size_t seq = cell->sequence_.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+    if (diff == 0) {
+      // The cell is filled, claim it
+      if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return NULL;
+    } else {
+      pos = dequeuePos_.load(std::memory_order_relaxed);
+    }
+  }
+  T value = cell->value_;
+  // Free the cell for the producers of the next lap
+  cell->sequence_.store(pos + mask_ + 1, std::memory_order_release);
+  return value;
+}
+
+template <typename T> inline bool ConcurrentRingQueue<T>::empty() const {
+  size_t pos = dequeuePos_.load(std::memory_order_acquire);
+  return cells_[pos & mask_].sequence_.load(std::memory_order_acquire) != (pos + 1);
+}
+
 }  // namespace amd
 
 #endif /*CONCURRENT_HPP_*/
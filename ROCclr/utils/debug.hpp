@@ -26,6 +26,7 @@
 #include <cstring>
 #include <cstdio>
 #include <cstdint>
+#include "utils/trace.hpp"
 //! \addtogroup Utils
 #ifdef _WIN32
 #include <process.h>
@@ -196,7 +197,9 @@ inline void warning(const char* msg) { amd::report_warning(msg); }
   do {                                                                                             \
     if (AMD_LOG_LEVEL >= level) {                                                                  \
       if (AMD_LOG_MASK & mask || mask == amd::LOG_ALWAYS) {                                        \
-        if (AMD_LOG_MASK & amd::LOG_LOCATION) {                                                    \
+        if (amd::traceBinary) {                                                                    \
+          amd::trace_record(level, format, ##__VA_ARGS__);                                         \
+        } else if (AMD_LOG_MASK & amd::LOG_LOCATION) {                                             \
           amd::log_printf(level, __FILENAME__, __LINE__, format, ##__VA_ARGS__);                   \
         } else {                                                                                   \
           amd::log_printf(level, "", 0, format, ##__VA_ARGS__);                                    \
@@ -151,6 +151,9 @@ bool Flag::init() {
       std::string fileName = AMD_LOG_LEVEL_FILE;
       outFile = fopen(fileName.c_str(), "w");
     }
+    if (!flagIsDefault(AMD_LOG_BINARY_FILE) && !trace_open(AMD_LOG_BINARY_FILE)) {
+      fprintf(outFile, "Failed to open the binary log file %s\n", AMD_LOG_BINARY_FILE);
+    }
   }
 
   return true;
@@ -188,6 +191,19 @@ bool Flag::setValue(const char* value) {
   return false;
 }
 
+bool Flag::setValue(const char* name, const char* value, bool force) {
+  for (size_t i = 0; i < numFlags_; ++i) {
+    Flag& flag = flags_[i];
+    if (strcmp(flag.name_, name) == 0) {
+      if (!flag.isDefault_ && !force) {
+        return true;  // The environment takes precedence
+      }
+      return flag.setValue(value);
+    }
+  }
+  return false;
+}
+
 #define DEFINE_RELEASE_FLAG_STRUCT(type, name, value, help) {#name, &name, T##type, true},
 #define DEFINE_DEBUG_FLAG_STRUCT(type, name, value, help)                                          \
   {#name, RELEASE_ONLY(NULL) DEBUG_ONLY(&name), T##type, true},
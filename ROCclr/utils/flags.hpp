@@ -46,6 +46,8 @@ release(int, GPU_MAX_WORKGROUP_SIZE_3D_Y, 0,                                  \
         "Maximum number of workitems in a 3D workgroup for GPU, y component, 0 -use default") \
 release(int, GPU_MAX_WORKGROUP_SIZE_3D_Z, 0,                                  \
         "Maximum number of workitems in a 3D workgroup for GPU, z component, 0 -use default") \
+release(bool, GPU_OCCUPANCY_LOCAL_SIZE, true,                                 \
+        "Use the occupancy model for the default local workgroup size")       \
 debug(bool, CPU_MEMORY_GUARD_PAGES, false,                                    \
         "Use guard pages for CPU memory")                                     \
 debug(size_t, CPU_MEMORY_GUARD_PAGE_SIZE, 64,                                 \
@@ -58,6 +60,10 @@ debug(size_t, MEMOBJ_BASE_ADDR_ALIGN, 4*Ki,                                   \
         "Alignment of the base address of any allocate memory object")        \
 release(uint, ROC_HMM_FLAGS, 0,                                               \
         "ROCm HMM configuration flags")                                       \
+release(uint, ROC_HMM_PREFETCH_CHUNK_SIZE, 64,                                \
+        "Size in MB of one HMM prefetch request, 0 - single request")         \
+release(uint, ROC_HMM_PREFETCH_AHEAD, 0,                                      \
+        "Number of chunks to read ahead on sequential prefetches, 0 - off")   \
 release(cstring, GPU_DEVICE_ORDINAL, "",                                      \
         "Select the device ordinal (comma seperated list of available devices)") \
 release(bool, REMOTE_ALLOC, false,                                            \
@@ -66,8 +72,18 @@ release(uint, GPU_MAX_HEAP_SIZE, 100,                                         \
         "Set maximum size of the GPU heap to % of board memory")              \
 release(uint, GPU_STAGING_BUFFER_SIZE, 1024,                                  \
         "Size of the GPU staging buffer in KiB")                              \
+release(uint, GPU_STAGING_PIPELINE_DEPTH, 2,                                  \
+        "Number of staging buffers in flight for pageable copies, 1 disables "\
+        "the overlap of CPU and SDMA copies")                                 \
+release(uint, GPU_HOST_COPY_THREADS, 4,                                       \
+        "Number of worker threads, which split large staging memcpys, "       \
+        "0 disables the workers")                                             \
 release(bool, GPU_DUMP_BLIT_KERNELS, false,                                   \
         "Dump the kernels for blit manager")                                  \
+release(bool, GPU_BLIT_CODE_CACHE, true,                                      \
+        "Keep the compiled blit kernels on disk for the next processes")      \
+release(cstring, GPU_BLIT_CODE_CACHE_PATH, "",                                \
+        "Directory of the runtime disk cache, default is ~/.cache/rocclr")    \
 release(uint, GPU_BLIT_ENGINE_TYPE, 0x0,                                      \
         "Blit engine type: 0 - Default, 1 - Host, 2 - CAL, 3 - Kernel")       \
 release(bool, GPU_FLUSH_ON_EXECUTION, false,                                  \
@@ -94,10 +110,17 @@ release(size_t, GPU_PINNED_XFER_SIZE, 32,                                     \
         "The pinned buffer size for pinning in read/write transfers")         \
 release(size_t, GPU_PINNED_MIN_XFER_SIZE, 1024,                               \
         "The minimal buffer size for pinned read/write transfers in KBytes")  \
+release(size_t, GPU_PINNED_CACHE_SIZE, 0,                                     \
+        "The size of pinned host ranges, kept after the transfers in MB")     \
 release(size_t, GPU_RESOURCE_CACHE_SIZE, 64,                                  \
         "The resource cache size in MB")                                      \
 release(size_t, GPU_MAX_SUBALLOC_SIZE, 4096,                                  \
         "The maximum size accepted for suballocaitons in KB")                 \
+release(uint, GPU_FILE_STAGING_DEPTH, 8,                                      \
+        "Number of staging buffers of a file transfer, the file I/O runs "    \
+        "that many chunks ahead of the DMA")                                  \
+release(uint, GPU_FILE_STAGING_SIZE, 4,                                       \
+        "The size in MB of a staging buffer of a file transfer")              \
 release(bool, GPU_FORCE_64BIT_PTR, 0,                                         \
         "Forces 64 bit pointers on GPU")                                      \
 release(bool, GPU_FORCE_OCL20_32BIT, 0,                                       \
@@ -118,6 +141,10 @@ release(int, GPU_SELECT_COMPUTE_RINGS_ID, -1,                                 \
         "GPU select the compute rings ID -1 - disabled, 0 , 1,.. - the forced compute rings ID for submission") \
 release(uint, GPU_WORKLOAD_SPLIT, 22,                                         \
         "Workload split size")                                                \
+release(bool, GPU_WORKLOAD_FEEDBACK, false,                                   \
+        "Flushes the command buffers by the measured kernel times")           \
+release(uint, GPU_WORKLOAD_CB_BUDGET, 1000,                                   \
+        "GPU time budget of a command buffer in us for GPU_WORKLOAD_FEEDBACK") \
 release(bool, GPU_USE_SINGLE_SCRATCH, false,                                  \
         "Use single scratch buffer per device instead of per HW ring")        \
 release(bool, AMD_OCL_WAIT_COMMAND, false,                                    \
@@ -150,6 +177,10 @@ release(int, AMD_GPU_FORCE_SINGLE_FP_DENORM, -1,                              \
         "Force denorm for single precision: -1 - don't force, 0 - disable, 1 - enable") \
 release(uint, OCL_SET_SVM_SIZE, 4*16384,                                      \
         "set SVM space size for discrete GPU")                                \
+release(bool, OCL_COMMAND_BUFFER_PACKETS, true,                               \
+        "Replay the kernel only command buffers from the AQL packets")        \
+release(bool, OCL_LAZY_HOST_PTR_PIN, true,                                    \
+        "Pin the CL_MEM_USE_HOST_PTR buffers on the first device use")        \
 debug(uint, OCL_SYSMEM_REQUIREMENT, 2,                                        \
         "Use flag to change the minimum requirement of system memory not to downgrade")        \
 debug(bool, GPU_ENABLE_HW_DEBUG, false,                                       \
@@ -176,12 +207,19 @@ release_on_stg(cstring, GPU_WAVE_LIMIT_DUMP, "",                              \
         "File path prefix for dumping wave limiter output")                   \
 release_on_stg(cstring, GPU_WAVE_LIMIT_TRACE, "",                             \
         "File path prefix for tracing wave limiter")                          \
+release(cstring, GPU_WAVE_LIMIT_CACHE, "",                                    \
+        "File of the learned wave limits, loaded on the start and saved at exit") \
 release(bool, OCL_CODE_CACHE_ENABLE, false,                                   \
         "1 = Enable compiler code cache")                                     \
 release(bool, OCL_CODE_CACHE_RESET, false,                                    \
         "1 =  Reset the compiler code cache storage")                         \
+release(uint, OCL_CODE_CACHE_SIZE, 512,                                       \
+        "Max size of the compiler code cache in MB")                          \
 release_on_stg(bool, PAL_DISABLE_SDMA, false,                                 \
         "1 = Disable SDMA for PAL")                                           \
+release(uint, PAL_SDMA_SPLIT_SIZE, 32,                                        \
+        "Min size in MB of a buffer copy, split across 2 SDMA engines, "      \
+        "0 disables the split")                                               \
 release(uint, PAL_RGP_DISP_COUNT, 10000,                                      \
         "The number of dispatches for RGP capture with SQTT")                 \
 release(uint, PAL_MALL_POLICY, 0,                                             \
@@ -230,13 +268,32 @@ release(uint, AMD_OPT_FLUSH, 1,                                               \
         "0x1 = Use device-scope fence operations when possible.")             \
 release(bool, AMD_DIRECT_DISPATCH, false,                                     \
         "Enable direct kernel dispatch.")                                     \
+release(uint, AMD_COMMAND_POOL_DEPTH, 1024,                                 \
+        "Max number of free command blocks per size class, kept for reuse. "  \
+        "0 disables command storage pooling")                                 \
+release(uint, AMD_QUEUE_THREAD_SPIN, 50,                                      \
+        "Max time in us the queue thread spins for new commands before it "   \
+        "parks, 0 disables the spin")                                         \
+release(uint, AMD_QUEUE_RING_SIZE, 16384,                                     \
+        "Max number of commands pending on the queue thread. The enqueue "    \
+        "waits for the queue thread if the limit is reached")                 \
 release(uint, HIP_HIDDEN_FREE_MEM, 0,                                         \
         "Reserve free mem reporting in Mb"                                    \
         "0 = Disable")                                                        \
 release(size_t, GPU_FORCE_BLIT_COPY_SIZE, 0,                                  \
         "Size in KB of the threshold below which to force blit instead for sdma") \
+release(size_t, GPU_SDMA_STRIPE_SIZE, 32,                                      \
+        "Size in MB above which copies use several SDMA engines, 0 - off")    \
+release(bool, ROC_COPY_ENGINE_CALIBRATE, false,                               \
+        "Measure SDMA and blit copies to pick the engine by the copy size")   \
 release(uint, ROC_ACTIVE_WAIT_TIMEOUT, 10,                                    \
         "Forces active wait of GPU interrup for the timeout(us)")             \
+release(bool, ROC_ADAPTIVE_SIGNAL_WAIT, false,                                \
+        "Selects busy poll, timed or interrupt wait by the expected wait time") \
+release(uint, ROC_SIGNAL_RECYCLE_LIMIT, 256,                                  \
+        "Max number of idle HSA signals, kept for recycling on the device")   \
+release(bool, ROC_BATCH_COMPLETION, false,                                    \
+        "Retires completed markers in a batch with a single HSA handler")     \
 release(bool, ROC_ENABLE_LARGE_BAR, true,                                     \
         "Enable Large Bar if supported by the device")                        \
 release(bool, ROC_CPU_WAIT_FOR_SIGNAL, true,                                  \
@@ -249,8 +306,29 @@ release(bool, ROC_ENABLE_PRE_VEGA, false,                                     \
         "Enable support of pre-vega ASICs in ROCm path")                      \
 release(bool, HIP_FORCE_QUEUE_PROFILING, false,                               \
         "Force command queue profiling by default")                           \
+release(bool, HIP_EVENT_FAST_RECORD, true,                                    \
+        "Record HIP events as a single timestamp barrier without a marker "   \
+        "command in direct dispatch mode")                                    \
 release(bool, HIP_MEM_POOL_SUPPORT, false,                                    \
         "Enables memory pool support in HIP")                                 \
+release(uint, HIP_MEM_POOL_RECLAIM_INTERVAL, 0,                               \
+        "Interval in ms of the background release of freed pool memory above "\
+        "the release threshold, 0 disables the reclaim thread")               \
+release(bool, HIP_FAST_EXIT, false,                                           \
+        "Drains the streams at the process exit and skips the release of "    \
+        "the objects, which the OS reclaims")                                 \
+release(bool, HIP_DEFERRED_FREE, false,                                       \
+        "hipFree doesn't wait for the device, the memory is released after "  \
+        "the device queues complete the work, submitted before the free")     \
+release(uint, HIP_VMM_POOL_SIZE, 0,                                           \
+        "Size in MB of released hipMemCreate memory, kept for reuse")         \
+release(uint, HIP_STREAM_POOL_SIZE, 16,                                       \
+        "Idle queues of destroyed streams per device for reuse, 0 - off")     \
+release(uint, HIP_PAGEABLE_ASYNC_COPY, 1,                                     \
+        "Pageable hipMemcpyAsync returns before the copy: 0 - off, "          \
+        "1 - to device, 2 - also from device, via a stream callback")         \
+release(uint, HIP_PAGEABLE_STAGING_SIZE, 64,                                  \
+        "Size in MB of the pinned staging ring of the pageable async copies") \
 release(uint, PAL_FORCE_ASIC_REVISION, 0,                                     \
         "Force a specific asic revision for all devices")                     \
 release(bool, PAL_EMBED_KERNEL_MD, false,                                     \
@@ -262,22 +340,153 @@ release(cstring, AMD_LOG_LEVEL_FILE, "",                                      \
         "Set output file for AMD_LOG_LEVEL, Default is stderr")               \
 release(size_t, PAL_PREPINNED_MEMORY_SIZE, 64,                                \
         "Size in KBytes of prepinned memory")                                 \
+release(bool, PAL_SUBALLOC_THREAD_CACHE, true,                                \
+        "Caches the small freed suballocations per thread, bypassing the "    \
+        "resource cache lock")                                                \
 release(bool, AMD_CPU_AFFINITY, false,                                        \
         "Reset CPU affinity of any runtime threads")                          \
+release(bool, ROC_QUEUE_NUMA_AFFINITY, false,                                 \
+        "Pins the queue threads to the CPU NUMA node of the device")          \
+release(cstring, ROC_DEVICE_NUMA_NODES, "",                                   \
+        "Comma separated CPU NUMA node per visible device for the queue "     \
+        "threads and the staging buffers, -1 keeps the closest node")         \
+release(bool, ROC_STAGING_NUMA_INTERLEAVE, false,                             \
+        "Interleaves the pages of the staging buffers across the CPU NUMA "   \
+        "nodes")                                                              \
 release(bool, ROC_USE_FGS_KERNARG, true,                                      \
         "Use fine grain kernel args segment for supported asics")             \
 release(uint, ROC_P2P_SDMA_SIZE, 1024,                                        \
         "The minimum size in KB for P2P transfer with SDMA")                  \
+release(uint, ROC_SUBALLOC_MAX_SIZE, 256,                                     \
+        "Max size in KB of device allocations, suballocated from large "      \
+        "chunks, 0 allocates each of them in ROCr")                           \
 release(uint, ROC_AQL_QUEUE_SIZE, 4096,                                       \
         "AQL queue size in AQL packets")                                      \
 release(uint, ROC_SIGNAL_POOL_SIZE, 32,                                       \
         "Initial size of HSA signal pool")                                    \
 release(bool, ROC_SKIP_KERNEL_ARG_COPY, false,                                \
         "If true, then runtime can skip kernel arg copy")                     \
+release(uint, ROC_DOORBELL_BATCH_SIZE, 0,                                      \
+        "Max number of AQL packets, published with one doorbell write "         \
+        "in a command batch, 0 rings the doorbell on every packet")           \
+release(uint, ROC_DOORBELL_BATCH_LATENCY, 20,                                 \
+        "Max time in us an AQL packet can wait for the batched doorbell")     \
+release(bool, ROC_KERNARG_SINGLE_LINE, true,                                  \
+        "Places kernel args, which fit a cacheline, into a single cacheline") \
 release(bool, GPU_STREAMOPS_CP_WAIT, false,                                   \
         "Force the stream wait memory operation to wait on CP.")              \
 release(bool, ROC_EVENT_NO_FLUSH, false,                                      \
-        "Use NOP AQL packet for event records with no explicit flags.")
+        "Use NOP AQL packet for event records with no explicit flags.")        \
+release(bool, HIP_GRAPH_PACKET_CAPTURE, false,                                \
+        "Capture AQL packets of kernel only graphs once and replay them on launch") \
+release(uint, HIP_GRAPH_MAX_PARALLEL_QUEUES, 4,                               \
+        "Max number of queues for graph parallel branches, 0 - queue per branch") \
+release(bool, HIP_GRAPH_SINGLE_QUEUE_LAUNCH, false,                           \
+        "Launch kernel, memset and memcpy only graphs in order on the launch queue") \
+release(bool, HIP_GRAPH_FUSE_COPY_NODES, false,                               \
+        "Merge contiguous memset and D2D memcpy graph nodes at instantiation") \
+release(bool, ROC_PARALLEL_DEVICE_INIT, true,                                 \
+        "Create the GPU devices on parallel threads at the runtime initialization") \
+release(uint, HIPRTC_COMPILE_CACHE_SIZE, 64,                                  \
+        "Max size of the in-memory hiprtc compilation cache in MB, 0 - disabled") \
+release(bool, HIPRTC_DISK_CACHE, false,                                       \
+        "Keep the hiprtc compilations in the disk code cache of the runtime") \
+release(bool, HIPRTC_BUILTIN_PCH, false,                                      \
+        "Compile hiprtc programs with a PCH of the builtin header")           \
+release(bool, HIP_LAZY_KERNEL_INIT, false,                                    \
+        "Set up the kernels of the HIP code objects on the first use")        \
+release(bool, HIP_PARALLEL_MODULE_LOAD, true,                                 \
+        "Build the code objects of a fat binary for all devices concurrently") \
+release(bool, HIP_SHARE_CODE_OBJECTS, true,                                   \
+        "Load the identical code objects of fat binaries once per device")    \
+release(bool, HIP_DIRECT_KERNARG_CAPTURE, true,                               \
+        "Capture the HIP kernel arguments without the kernel values stack")   \
+release(bool, OCL_PARALLEL_BUILD, true,                                       \
+        "Compile, link and build the programs for multiple devices concurrently") \
+release(bool, ROC_QUEUE_LOAD_BALANCE, true,                                   \
+        "Share the HW queues of the same priority by their load, not users count") \
+release(bool, HIP_PER_THREAD_STREAM_DECOUPLED, false,                         \
+        "Per-thread default streams don't synchronize with the null stream "  \
+        "and the other blocking streams")                                     \
+release(bool, HIP_IPC_EVENT_GPU_WAIT, true,                                   \
+        "Wait for the IPC events on the device instead of the host callback") \
+release(uint, ROC_IPC_MEM_CACHE_SIZE, 64,                                     \
+        "Max number of the closed IPC memory handles, which stay attached")   \
+release(bool, ROC_P2P_RELAY, true,                                            \
+        "Copy P2P without direct access on a GPU with access to both devices") \
+release(uint, ROC_HIGH_PRIORITY_CU_RESERVE, 0,                                \
+        "Number of CUs, reserved for the high priority queues. The low and "  \
+        "normal priority queues don't use them")                              \
+release(uint, ROC_CALLBACK_THREADS, 2,                                        \
+        "Number of worker threads for the stream callbacks, 0 runs them on the signal handler") \
+release(cstring, AMD_LOG_BINARY_FILE, "",                                     \
+        "Writes the log of AMD_LOG_LEVEL into this file as binary records, "  \
+        "decoded with utils/trace_decode.py")                                 \
+release(bool, ROC_LATENCY_STATS, true,                                        \
+        "Record the latency histograms of the API, enqueue, AQL packet, "      \
+        "doorbell and completion stages")                                     \
+release(uint, ROC_SMALL_READBACK_SIZE, 256,                                   \
+        "Device reads up to this size in bytes poll a pinned bounce buffer, " \
+        "0 - disabled")                                                       \
+release(bool, ROC_MEMORY_STATS, true,                                         \
+        "Account the footprint of every allocation per API category and tag") \
+release(uint, ROC_MEMORY_STATS_DUMP, 0,                                       \
+        "Log the memory footprint every N ms of allocations, 0 - disabled")   \
+release(uint, ROC_ACTIVITY_BATCH_SIZE, 0,                                     \
+        "Activity records per queue, delivered to the profiler at once. "      \
+        "0 or 1 delivers every record at the command completion")             \
+release(uint, ROC_ACTIVITY_BATCH_LATENCY, 1000,                               \
+        "Max wait in us of the first activity record for the batch delivery") \
+release(uint, HIP_API_SAMPLE_RATE, 1,                                         \
+        "Trace 1 in N calls of each HIP API, 1 traces all calls")             \
+release(uint, ROC_ACTIVITY_SAMPLE_RATE, 1,                                    \
+        "Record the activity and the timestamps of 1 in N commands of each op") \
+release(uint, ROC_COUNTER_SAMPLE_RATE, 0,                                     \
+        "Sample the HW counters of 1 in N kernel dispatches of a queue, 0 is off") \
+release(cstring, ROC_COUNTER_SAMPLE_EVENTS, "",                               \
+        "Sampled counters as a list of block:event pairs, such as \"14:4,14:5\"") \
+release(cstring, ROC_TIMELINE_FILE, "",                                       \
+        "Writes the GPU timeline of all commands into this file in the Chrome trace format") \
+release(bool, ROC_OUT_OF_ORDER_DISPATCH, true,                                \
+        "Clear the barrier bit of the kernels in out-of-order queues without dependencies") \
+release(bool, GPU_HOSTCALL_QUEUE_LISTENER, false,                             \
+        "Run a hostcall listener thread per queue instead of per device") \
+release(bool, ROC_PRINTF_ASYNC, false,                                        \
+        "Print the printf output of the kernels in a background thread, without a wait") \
+release(bool, HIP_TEXTURE_OBJECT_CACHE, true,                                 \
+        "Share one texture object between the calls with identical descriptors") \
+release(uint, ROC_OBJECT_POOL_DEPTH, 4096,                                    \
+        "Max number of free small runtime object blocks per size class, kept for reuse. " \
+        "0 disables the pooling") \
+release(uint, ROC_STREAMING_COPY_THRESHOLD, 1048576,                          \
+        "Host copies of this size or larger use the non-temporal stores, 0 disables them") \
+release(uint, ROC_HOST_HUGE_PAGES, 0,                                         \
+        "Huge page size in MB of the host allocations, which cover at least a page: " \
+        "0 - disabled, 2 or 1024") \
+release(cstring, ROC_APP_PROFILE_FILE, "",                                    \
+        "File with the runtime settings per application, in [name] sections") \
+release(cstring, ROC_APP_PROFILE, "",                                         \
+        "Section of ROC_APP_PROFILE_FILE to apply, the executable name by default") \
+release(bool, ROC_COOP_FAST_LAUNCH, true,                                     \
+        "Skip the GWS init and the queue dependency on repeated cooperative launches") \
+release(uint, ROC_SCRATCH_QUEUE_THRESHOLD, 0,                                 \
+        "Private segment bytes per work-item, above which the kernels run on a "   \
+        "dedicated scratch queue, 0 - disabled")                                 \
+release(bool, ROC_GL_INTEROP_LIGHT_SYNC, true,                                \
+        "Sync GL interop with a GL fence and the wait for the release command, "   \
+        "instead of glFinish and a stream finish")                               \
+release(bool, ROC_SCHEDULER_GPU_WAIT, true,                                   \
+        "The queue waits for the device enqueue scheduler on GPU, instead of a "   \
+        "host wait after every parent kernel")                                   \
+release(bool, ROC_LARGE_BAR_DIRECT_MAP, true,                                 \
+        "Write-only maps of the device buffers return the large BAR address, "     \
+        "without the staging copies")                                            \
+release(cstring, HIP_API_CAPTURE_FILE, "",                                    \
+        "Captures the HIP API call pattern into the file, without the data "       \
+        "contents, for the replay in hipperf")                                \
+release(bool, ROC_SVM_MAP_WRITE_WATCH, false,                                 \
+        "Write-protects the coarse-grain SVM maps and copies back only the "  \
+        "written pages. The system calls fail on the protected pages")
 
 namespace amd {
 
@@ -335,6 +544,10 @@ struct Flag {
 
   bool setValue(const char* value);
 
+  //! Sets the flag \a name, e.g. from an application profile. The value must stay valid.
+  //! A flag set in the environment is kept unless \a force. Returns false for an unknown flag
+  static bool setValue(const char* name, const char* value, bool force);
+
   static bool isDefault(Name name) { return flags_[name].isDefault_; }
 };
 
@@ -0,0 +1,192 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef SMALL_VECTOR_HPP_
+#define SMALL_VECTOR_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief A vector with inline storage for the first N elements.
+ *
+ * The vector doesn't allocate memory until it grows above N elements.
+ * The elements must be trivially copyable, since they are moved with memcpy.
+ */
+template <typename T, size_t N> class SmallVector {
+  static_assert(std::is_trivially_copyable<T>::value, "SmallVector requires trivial elements");
+
+ public:
+  typedef T value_type;
+  typedef T* iterator;
+  typedef const T* const_iterator;
+  typedef size_t size_type;
+
+ private:
+  T* data_;          //!< The current storage, inline_ or a heap block
+  size_t size_;      //!< The number of elements
+  size_t capacity_;  //!< The capacity of the current storage
+  T inline_[N];      //!< The inline storage
+
+  //! Returns TRUE if the elements are on the heap
+  bool onHeap() const { return data_ != inline_; }
+
+  //! Moves the elements into storage with at least \a capacity elements
+  void grow(size_t capacity) {
+    capacity = std::max(capacity, capacity_ * 2);
+    T* data = reinterpret_cast<T*>(::operator new(capacity * sizeof(T)));
+    std::memcpy(data, data_, size_ * sizeof(T));
+    if (onHeap()) {
+      ::operator delete(data_);
+    }
+    data_ = data;
+    capacity_ = capacity;
+  }
+
+  //! Takes the storage of \a other, which must be on the heap
+  void steal(SmallVector& other) {
+    data_ = other.data_;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    other.data_ = other.inline_;
+    other.size_ = 0;
+    other.capacity_ = N;
+  }
+
+ public:
+  SmallVector() : data_(inline_), size_(0), capacity_(N) {}
+
+  //! Creates a vector with \a count value initialized elements
+  explicit SmallVector(size_t count) : SmallVector() { resize(count); }
+
+  SmallVector(std::initializer_list<T> list) : SmallVector() {
+    reserve(list.size());
+    std::memcpy(data_, list.begin(), list.size() * sizeof(T));
+    size_ = list.size();
+  }
+
+  SmallVector(const SmallVector& other) : SmallVector() { *this = other; }
+
+  SmallVector(SmallVector&& other) noexcept : SmallVector() { *this = std::move(other); }
+
+  ~SmallVector() {
+    if (onHeap()) {
+      ::operator delete(data_);
+    }
+  }
+
+  SmallVector& operator=(const SmallVector& other) {
+    if (this != &other) {
+      size_ = 0;
+      reserve(other.size_);
+      std::memcpy(data_, other.data_, other.size_ * sizeof(T));
+      size_ = other.size_;
+    }
+    return *this;
+  }
+
+  SmallVector& operator=(SmallVector&& other) noexcept {
+    if (this != &other) {
+      if (other.onHeap()) {
+        if (onHeap()) {
+          ::operator delete(data_);
+        }
+        steal(other);
+      } else {
+        // The inline elements fit into any storage of this vector
+        std::memcpy(data_, other.data_, other.size_ * sizeof(T));
+        size_ = other.size_;
+        other.size_ = 0;
+      }
+    }
+    return *this;
+  }
+
+  iterator begin() { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+
+  T* data() { return data_; }
+  const T* data() const { return data_; }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  bool empty() const { return size_ == 0; }
+
+  T& operator[](size_t index) { return data_[index]; }
+  const T& operator[](size_t index) const { return data_[index]; }
+
+  T& front() { return data_[0]; }
+  const T& front() const { return data_[0]; }
+  T& back() { return data_[size_ - 1]; }
+  const T& back() const { return data_[size_ - 1]; }
+
+  void reserve(size_t capacity) {
+    if (capacity > capacity_) {
+      grow(capacity);
+    }
+  }
+
+  void resize(size_t size) {
+    reserve(size);
+    for (size_t i = size_; i < size; ++i) {
+      data_[i] = T();
+    }
+    size_ = size;
+  }
+
+  void push_back(const T& value) {
+    if (size_ == capacity_) {
+      // The value can be stored in the current storage, so copy it first
+      T copy = value;
+      grow(size_ + 1);
+      data_[size_++] = copy;
+    } else {
+      data_[size_++] = value;
+    }
+  }
+
+  void pop_back() { --size_; }
+
+  void clear() { size_ = 0; }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    iterator pos = data_ + (first - data_);
+    size_t tail = end() - (data_ + (last - data_));
+    std::memmove(pos, last, tail * sizeof(T));
+    size_ -= last - first;
+    return pos;
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+};
+
+/*@}*/} // namespace amd
+
+#endif /*SMALL_VECTOR_HPP_*/
@@ -0,0 +1,190 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "top.hpp"
+#include "utils/trace.hpp"
+#include "os/os.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace amd {
+
+bool traceBinary = false;
+
+namespace {
+
+constexpr char kTraceMagic[8] = {'R', 'O', 'C', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t kTraceVersion = 1;
+constexpr size_t kTraceRingSize = 4096;  //!< Records per thread, must be a power of 2
+constexpr long kTraceFlushMs = 10;       //!< Sleep time of the flush thread
+
+//! Entry tags of the trace file
+enum TraceTag : uint8_t { TagFormat = 'F', TagRecord = 'R', TagDropped = 'D' };
+
+struct TraceRecord {
+  uint64_t time_;                 //!< Time in ns
+  const char* format_;            //!< Format string, written into the file on the first use
+  uint64_t args_[kTraceMaxArgs];  //!< Raw arguments
+  uint32_t level_;                //!< Log level
+  uint32_t numArgs_;              //!< Number of valid arguments
+};
+
+//! Single producer, single consumer ring of a thread
+struct TraceRing {
+  TraceRecord records_[kTraceRingSize];
+  std::atomic<uint64_t> head_{0};     //!< Next record of the producer
+  std::atomic<uint64_t> tail_{0};     //!< Next record of the flush thread
+  std::atomic<uint64_t> dropped_{0};  //!< Records lost on a full ring
+  uint32_t tid_;                      //!< Sequential id of the thread in the trace
+};
+
+std::mutex traceLock;               //!< Protects the ring list and the file
+std::vector<TraceRing*> traceRings; //!< The rings are never freed, the thread may exit any time
+FILE* traceFile = nullptr;
+std::thread traceThread;
+std::atomic<bool> traceStop{false};
+std::unordered_set<const char*> traceFormats;  //!< The formats already in the file
+
+// ================================================================================================
+TraceRing* traceRing() {
+  thread_local TraceRing* ring = nullptr;
+  if (ring == nullptr) {
+    ring = new TraceRing();
+    std::lock_guard<std::mutex> lock(traceLock);
+    ring->tid_ = static_cast<uint32_t>(traceRings.size());
+    traceRings.push_back(ring);
+  }
+  return ring;
+}
+
+// ================================================================================================
+template <typename T> void traceOut(const T& value) {
+  fwrite(&value, sizeof(value), 1, traceFile);
+}
+
+// ================================================================================================
+//! Copies the filled records of all rings into the file, expects traceLock
+void traceFlush() {
+  for (auto ring : traceRings) {
+    const uint64_t tail = ring->tail_.load(std::memory_order_relaxed);
+    const uint64_t head = ring->head_.load(std::memory_order_acquire);
+    for (uint64_t i = tail; i < head; ++i) {
+      const TraceRecord& record = ring->records_[i & (kTraceRingSize - 1)];
+      if (traceFormats.insert(record.format_).second) {
+        const uint32_t size = static_cast<uint32_t>(strlen(record.format_));
+        traceOut(TagFormat);
+        traceOut(reinterpret_cast<uint64_t>(record.format_));
+        traceOut(size);
+        fwrite(record.format_, 1, size, traceFile);
+      }
+      traceOut(TagRecord);
+      traceOut(record.time_);
+      traceOut(reinterpret_cast<uint64_t>(record.format_));
+      traceOut(ring->tid_);
+      traceOut(static_cast<uint8_t>(record.level_));
+      traceOut(static_cast<uint8_t>(record.numArgs_));
+      fwrite(record.args_, sizeof(uint64_t), record.numArgs_, traceFile);
+    }
+    ring->tail_.store(head, std::memory_order_release);
+
+    const uint64_t dropped = ring->dropped_.exchange(0, std::memory_order_relaxed);
+    if (dropped != 0) {
+      traceOut(TagDropped);
+      traceOut(ring->tid_);
+      traceOut(dropped);
+    }
+  }
+  fflush(traceFile);
+}
+
+}  // namespace
+
+// ================================================================================================
+bool trace_open(const char* fileName) {
+  std::lock_guard<std::mutex> lock(traceLock);
+  if (traceFile != nullptr) {
+    return true;
+  }
+  traceFile = fopen(fileName, "wb");
+  if (traceFile == nullptr) {
+    return false;
+  }
+  fwrite(kTraceMagic, 1, sizeof(kTraceMagic), traceFile);
+  traceOut(kTraceVersion);
+  traceOut(kTraceMaxArgs);
+  traceOut(static_cast<uint32_t>(getpid()));
+
+  traceStop = false;
+  traceThread = std::thread([]() {
+    while (!traceStop.load(std::memory_order_relaxed)) {
+      Os::sleep(kTraceFlushMs);
+      std::lock_guard<std::mutex> lock(traceLock);
+      traceFlush();
+    }
+  });
+  traceBinary = true;
+  return true;
+}
+
+// ================================================================================================
+void trace_close() {
+  if (!traceThread.joinable()) {
+    return;
+  }
+  traceBinary = false;
+  traceStop = true;
+  traceThread.join();
+
+  std::lock_guard<std::mutex> lock(traceLock);
+  traceFlush();
+  fclose(traceFile);
+  traceFile = nullptr;
+}
+
+// ================================================================================================
+void trace_write(int level, const char* format, const uint64_t* args, uint32_t numArgs) {
+  TraceRing* ring = traceRing();
+  const uint64_t head = ring->head_.load(std::memory_order_relaxed);
+  if ((head - ring->tail_.load(std::memory_order_acquire)) >= kTraceRingSize) {
+    // Never block the caller on a slow disk, the decoder reports the lost records
+    ring->dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  TraceRecord& record = ring->records_[head & (kTraceRingSize - 1)];
+  record.time_ = Os::timeNanos();
+  record.format_ = format;
+  record.level_ = level;
+  record.numArgs_ = numArgs;
+  memcpy(record.args_, args, numArgs * sizeof(uint64_t));
+  ring->head_.store(head + 1, std::memory_order_release);
+}
+
+}  // namespace amd
@@ -0,0 +1,84 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/*! \brief Binary trace of the log messages
+ *
+ *  The records keep the format pointer and the raw arguments only. Every thread writes
+ *  into its own ring without locks and a background thread copies the rings into the
+ *  trace file. The format strings are written once, on the first use, and
+ *  utils/trace_decode.py expands the records offline. The strings passed for %s are
+ *  recorded as pointers only, since they may not live until the flush.
+ */
+
+namespace amd { /*@{*/
+
+//! Max number of the arguments, the decoder prints the extra arguments as missing
+constexpr uint32_t kTraceMaxArgs = 6;
+
+//! \brief The binary trace is enabled, set from AMD_LOG_BINARY_FILE
+extern bool traceBinary;
+
+//! \brief Opens the trace file and starts the flush thread
+extern bool trace_open(const char* fileName);
+
+//! \brief Flushes all rings and closes the trace file
+extern void trace_close();
+
+//! \brief Inserts a record into the ring of the current thread
+extern void trace_write(int level, const char* format, const uint64_t* args, uint32_t numArgs);
+
+//! \cond ignore
+template <typename T> inline uint64_t trace_arg(T value) {
+  if constexpr (std::is_null_pointer<T>::value) {
+    return 0;
+  } else if constexpr (std::is_pointer<T>::value) {
+    return reinterpret_cast<uintptr_t>(value);
+  } else if constexpr (std::is_floating_point<T>::value) {
+    // printf promotes float to double, hence the record always has the double bits
+    const double promoted = value;
+    uint64_t bits;
+    memcpy(&bits, &promoted, sizeof(bits));
+    return bits;
+  } else if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) {
+    return static_cast<uint64_t>(value);
+  } else {
+    // Handles, such as hsa_signal_t, are printed with their first 8 bytes
+    uint64_t bits = 0;
+    memcpy(&bits, &value, (sizeof(T) < sizeof(bits)) ? sizeof(T) : sizeof(bits));
+    return bits;
+  }
+}
+//! \endcond
+
+//! \brief Inserts a printf-style record without the formatting
+template <typename... Args> inline void trace_record(int level, const char* format, Args... args) {
+  const uint64_t values[sizeof...(Args) + 1] = {trace_arg(args)..., 0};
+  constexpr uint32_t numArgs =
+      (sizeof...(Args) < kTraceMaxArgs) ? sizeof...(Args) : kTraceMaxArgs;
+  trace_write(level, format, values, numArgs);
+}
+
+/*@}*/} // namespace amd
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 Advanced Micro Devices, Inc.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+# Decodes the binary log of AMD_LOG_BINARY_FILE into the text of AMD_LOG_LEVEL.
+# Usage: trace_decode.py <file> [-o <output>]
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = b'ROCTRACE'
+VERSION = 1
+
+SPEC = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGaAcspn%])')
+
+def to_signed(value, bits):
+  value &= (1 << bits) - 1
+  return value - (1 << bits) if value >> (bits - 1) else value
+
+def int_bits(length):
+  if length == 'hh':
+    return 8
+  if length == 'h':
+    return 16
+  if length in ('l', 'll', 'j', 'z', 't'):
+    return 64
+  return 32
+
+def format_record(fmt, args):
+  out = []
+  pos = 0
+  args = list(args)
+
+  def next_arg():
+    return args.pop(0) if args else None
+
+  for m in SPEC.finditer(fmt):
+    out.append(fmt[pos:m.start()])
+    pos = m.end()
+    flags, width, precision, length, conv = m.groups()
+    if conv == '%':
+      out.append('%')
+      continue
+    if width == '*':
+      value = next_arg()
+      width = str(to_signed(value, 32)) if value is not None else ''
+    if precision == '*':
+      value = next_arg()
+      precision = str(to_signed(value, 32)) if value is not None else None
+    spec = '%' + flags + (width or '') + ('.' + precision if precision is not None else '')
+    value = next_arg()
+    if value is None:
+      out.append('<missing>')
+      continue
+    bits = int_bits(length)
+    if conv in 'di':
+      out.append((spec + 'd') % to_signed(value, bits))
+    elif conv in 'ouxX':
+      out.append((spec + conv.replace('u', 'd')) % (value & ((1 << bits) - 1)))
+    elif conv in 'eEfFgGaA':
+      number = struct.unpack('<d', struct.pack('<Q', value))[0]
+      out.append((spec + ('e' if conv in 'aA' else conv)) % number)
+    elif conv == 'c':
+      out.append((spec + 'c') % chr(value & 0xff))
+    elif conv == 's':
+      # The strings aren't recorded, only their address
+      out.append((spec + 's') % ('<str:0x%x>' % value))
+    elif conv == 'p':
+      out.append((spec + 's') % ('0x%x' % value))
+    else:
+      out.append('')
+  out.append(fmt[pos:])
+  return ''.join(out)
+
+def decode(data, output):
+  if data[:len(MAGIC)] != MAGIC:
+    sys.exit('Not a binary log file')
+  version, max_args, pid = struct.unpack_from('<III', data, len(MAGIC))
+  if version != VERSION:
+    sys.exit('Unsupported version %d' % version)
+  pos = len(MAGIC) + struct.calcsize('<III')
+  formats = {}
+  while pos < len(data):
+    tag = data[pos:pos + 1]
+    pos += 1
+    if tag == b'F':
+      ptr, size = struct.unpack_from('<QI', data, pos)
+      pos += struct.calcsize('<QI')
+      formats[ptr] = data[pos:pos + size].decode('utf-8', 'replace')
+      pos += size
+    elif tag == b'R':
+      time, ptr, tid, level, num_args = struct.unpack_from('<QQIBB', data, pos)
+      pos += struct.calcsize('<QQIBB')
+      args = struct.unpack_from('<%dQ' % num_args, data, pos)
+      pos += 8 * num_args
+      message = format_record(formats.get(ptr, '<unknown format 0x%x>' % ptr), args)
+      output.write(':%d:%-25s:%-4d: %010d us: %-5d: [tid:%d] %s\n' %
+                   (level, '', 0, time // 1000, pid, tid, message))
+    elif tag == b'D':
+      tid, dropped = struct.unpack_from('<IQ', data, pos)
+      pos += struct.calcsize('<IQ')
+      output.write('[tid:%d] %d records dropped\n' % (tid, dropped))
+    else:
+      sys.exit('Corrupted file at offset %d' % (pos - 1))
+
+def main():
+  parser = argparse.ArgumentParser(description='Decodes the binary log of AMD_LOG_BINARY_FILE')
+  parser.add_argument('file', help='binary log file')
+  parser.add_argument('-o', '--output', help='text output, default is stdout')
+  args = parser.parse_args()
+  with open(args.file, 'rb') as f:
+    data = f.read()
+  if args.output:
+    with open(args.output, 'w') as output:
+      decode(data, output)
+  else:
+    decode(data, sys.stdout)
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,351 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "cl_common.hpp"
+#include "cl_command_buffer_amd.h"
+#include "platform/commandbuffer.hpp"
+#include "platform/context.hpp"
+#include "platform/program.hpp"
+
+/*! \addtogroup API
+ *  @{
+ *
+ *  \addtogroup AMD_Extensions
+ *  @{
+ *
+ */
+
+/*! \brief Creates a command buffer, which records the commands for \a command_queue
+ *
+ *  \return The new cl_command_buffer_amd object in the recording state, or NULL with
+ *  \a errcode_ret set to:
+ *  - CL_INVALID_COMMAND_QUEUE if \a command_queue is not a valid in-order host queue
+ *  - CL_OUT_OF_HOST_MEMORY if the object couldn't be allocated
+ */
+RUNTIME_ENTRY_RET(cl_command_buffer_amd, clCreateCommandBufferAMD,
+                  (cl_command_queue command_queue, cl_int* errcode_ret)) {
+  if (!is_valid(command_queue)) {
+    *not_null(errcode_ret) = CL_INVALID_COMMAND_QUEUE;
+    return NULL;
+  }
+  amd::HostQueue* queue = as_amd(command_queue)->asHostQueue();
+  // The replay relies on the queue order instead of the dependencies between the commands
+  if ((NULL == queue) || !queue->isInOrder()) {
+    *not_null(errcode_ret) = CL_INVALID_COMMAND_QUEUE;
+    return NULL;
+  }
+
+  amd::CommandBuffer* commandBuffer = new amd::CommandBuffer(*queue);
+  if (commandBuffer == NULL) {
+    *not_null(errcode_ret) = CL_OUT_OF_HOST_MEMORY;
+    return NULL;
+  }
+  *not_null(errcode_ret) = CL_SUCCESS;
+  return as_cl(commandBuffer);
+}
+RUNTIME_EXIT
+
+/*! \brief Increments the command buffer reference count
+ *
+ *  \return CL_SUCCESS, or CL_INVALID_VALUE if \a command_buffer isn't valid
+ */
+RUNTIME_ENTRY(cl_int, clRetainCommandBufferAMD, (cl_command_buffer_amd command_buffer)) {
+  if (!is_valid(command_buffer)) {
+    return CL_INVALID_VALUE;
+  }
+  as_amd(command_buffer)->retain();
+  return CL_SUCCESS;
+}
+RUNTIME_EXIT
+
+/*! \brief Decrements the command buffer reference count. The last release waits for the
+ *  replays in flight, since they read the captured packets.
+ *
+ *  \return CL_SUCCESS, or CL_INVALID_VALUE if \a command_buffer isn't valid
+ */
+RUNTIME_ENTRY(cl_int, clReleaseCommandBufferAMD, (cl_command_buffer_amd command_buffer)) {
+  if (!is_valid(command_buffer)) {
+    return CL_INVALID_VALUE;
+  }
+  as_amd(command_buffer)->release();
+  return CL_SUCCESS;
+}
+RUNTIME_EXIT
+
+/*! \brief Records a kernel launch. The arguments are taken at the recording time, the later
+ *  clSetKernelArg() calls don't change the recorded command.
+ *
+ *  \param command_index returns the index of the command for
+ *  clUpdateCommandBufferKernelArgAMD(), may be NULL
+ *
+ *  \return The clEnqueueNDRangeKernel() errors, or CL_INVALID_OPERATION if the buffer
+ *  was finalized
+ */
+RUNTIME_ENTRY(cl_int, clCommandNDRangeKernelAMD,
+              (cl_command_buffer_amd command_buffer, cl_kernel kernel, cl_uint work_dim,
+               const size_t* global_work_offset, const size_t* global_work_size,
+               const size_t* local_work_size, cl_uint* command_index)) {
+  if (!is_valid(command_buffer)) {
+    return CL_INVALID_VALUE;
+  }
+  if (!is_valid(kernel)) {
+    return CL_INVALID_KERNEL;
+  }
+  amd::CommandBuffer& commandBuffer = *as_amd(command_buffer);
+  amd::HostQueue& hostQueue = commandBuffer.queue();
+  const amd::Kernel* amdKernel = as_amd(kernel);
+  if (&hostQueue.context() != &amdKernel->program().context()) {
+    return CL_INVALID_CONTEXT;
+  }
+
+  const amd::Device& device = hostQueue.device();
+  const device::Kernel* devKernel = amdKernel->getDeviceKernel(device);
+  if (devKernel == NULL) {
+    return CL_INVALID_PROGRAM_EXECUTABLE;
+  }
+  if (amdKernel->parameters().getSvmSystemPointersSupport() == FGS_YES &&
+      !(device.info().svmCapabilities_ & CL_DEVICE_SVM_FINE_GRAIN_SYSTEM)) {
+    return CL_INVALID_OPERATION;
+  }
+
+  cl_int err = amd::clValidateNDRange(*devKernel, work_dim, global_work_offset, global_work_size,
+                                      local_work_size);
+  if (err != CL_SUCCESS) {
+    return err;
+  }
+  if (local_work_size == NULL) {
+    static size_t zeroes[3] = {0, 0, 0};
+    local_work_size = zeroes;
+  }
+
+  // Check that all parameters have been defined.
+  if (!as_amd(kernel)->parameters().check()) {
+    return CL_INVALID_KERNEL_ARGS;
+  }
+
+  amd::NDRangeContainer ndrange((size_t)work_dim, global_work_offset, global_work_size,
+                                local_work_size);
+  return commandBuffer.recordKernel(*amdKernel, ndrange, command_index);
+}
+RUNTIME_EXIT
+
+/*! \brief Records a buffer copy
+ *
+ *  \return The clEnqueueCopyBuffer() errors, or CL_INVALID_OPERATION if the buffer
+ *  was finalized
+ */
+RUNTIME_ENTRY(cl_int, clCommandCopyBufferAMD,
+              (cl_command_buffer_amd command_buffer, cl_mem src_buffer, cl_mem dst_buffer,
+               size_t src_offset, size_t dst_offset, size_t size, cl_uint* command_index)) {
+  if (!is_valid(command_buffer)) {
+    return CL_INVALID_VALUE;
+  }
+  if (!is_valid(src_buffer) || !is_valid(dst_buffer)) {
+    return CL_INVALID_MEM_OBJECT;
+  }
+  amd::Buffer* srcBuffer = as_amd(src_buffer)->asBuffer();
+  amd::Buffer* dstBuffer = as_amd(dst_buffer)->asBuffer();
+  if (srcBuffer == NULL || dstBuffer == NULL) {
+    return CL_INVALID_MEM_OBJECT;
+  }
+  amd::CommandBuffer& commandBuffer = *as_amd(command_buffer);
+  amd::HostQueue& hostQueue = commandBuffer.queue();
+  if ((hostQueue.context() != srcBuffer->getContext()) ||
+      (hostQueue.context() != dstBuffer->getContext())) {
+    return CL_INVALID_CONTEXT;
+  }
+
+  amd::Coord3D srcOffset(src_offset, 0, 0);
+  amd::Coord3D dstOffset(dst_offset, 0, 0);
+  amd::Coord3D copySize(size, 1, 1);
+  if (!srcBuffer->validateRegion(srcOffset, copySize) ||
+      !dstBuffer->validateRegion(dstOffset, copySize)) {
+    return CL_INVALID_VALUE;
+  }
+  if (srcBuffer == dstBuffer &&
+      ((src_offset <= dst_offset && dst_offset < src_offset + size) ||
+       (dst_offset <= src_offset && src_offset < dst_offset + size))) {
+    return CL_MEM_COPY_OVERLAP;
+  }
+  return commandBuffer.recordCopy(*srcBuffer, *dstBuffer, src_offset, dst_offset, size,
+                                  command_index);
+}
+RUNTIME_EXIT
+
+/*! \brief Records a buffer fill
+ *
+ *  \return The clEnqueueFillBuffer() errors, or CL_INVALID_OPERATION if the buffer
+ *  was finalized
+ */
+RUNTIME_ENTRY(cl_int, clCommandFillBufferAMD,
+              (cl_command_buffer_amd command_buffer, cl_mem buffer, const void* pattern,
+               size_t pattern_size, size_t offset, size_t size, cl_uint* command_index)) {
+  if (!is_valid(command_buffer)) {
+    return CL_INVALID_VALUE;
+  }
+  if (!is_valid(buffer)) {
+    return CL_INVALID_MEM_OBJECT;
+  }
+  amd::Buffer* fillBuffer = as_amd(buffer)->asBuffer();
+  if (fillBuffer == NULL) {
+    return CL_INVALID_MEM_OBJECT;
+  }
+  if ((pattern == NULL) || (pattern_size == 0) ||
+      (pattern_size > amd::FillMemoryCommand::MaxFillPatterSize) ||
+      ((pattern_size & (pattern_size - 1)) != 0)) {
+    return CL_INVALID_VALUE;
+  }
+  // Offset and size must be a multiple of pattern_size
+  if (((offset % pattern_size) != 0) || ((size % pattern_size) != 0)) {
+    return CL_INVALID_VALUE;
+  }
+  amd::CommandBuffer& commandBuffer = *as_amd(command_buffer);
+  if (commandBuffer.queue().context() != fillBuffer->getContext()) {
+    return CL_INVALID_CONTEXT;
+  }
+  if (!fillBuffer->validateRegion(amd::Coord3D(offset, 0, 0), amd::Coord3D(size, 1, 1))) {
+    return CL_INVALID_VALUE;
+  }
+  return commandBuffer.recordFill(*fillBuffer, pattern, pattern_size, offset, size,
+                                  command_index);
+}
+RUNTIME_EXIT
+
+/*! \brief Ends the recording. A buffer of kernel launches only is captured into AQL
+ *  packets here, so every enqueue submits the whole buffer with one doorbell.
+ *
+ *  \return CL_SUCCESS, CL_INVALID_VALUE if \a command_buffer isn't valid or
+ *  CL_INVALID_OPERATION if it was finalized already
+ */
+RUNTIME_ENTRY(cl_int, clFinalizeCommandBufferAMD, (cl_command_buffer_amd command_buffer)) {
+  if (!is_valid(command_buffer)) {
+    return CL_INVALID_VALUE;
+  }
+  return as_amd(command_buffer)->finalize();
+}
+RUNTIME_EXIT
+
+/*! \brief Enqueues all recorded commands on the queue of the command buffer
+ *
+ *  \param event returns the event of the whole buffer, may be NULL
+ *
+ *  \return CL_SUCCESS, CL_INVALID_VALUE if \a command_buffer isn't valid,
+ *  CL_INVALID_OPERATION if it isn't finalized, or the errors of the recorded commands
+ */
+RUNTIME_ENTRY(cl_int, clEnqueueCommandBufferAMD,
+              (cl_command_buffer_amd command_buffer, cl_uint num_events_in_wait_list,
+               const cl_event* event_wait_list, cl_event* event)) {
+  *not_null(event) = NULL;
+
+  if (!is_valid(command_buffer)) {
+    return CL_INVALID_VALUE;
+  }
+  amd::CommandBuffer& commandBuffer = *as_amd(command_buffer);
+
+  amd::Command::EventWaitList eventWaitList;
+  cl_int err = amd::clSetEventWaitList(eventWaitList, commandBuffer.queue(),
+                                       num_events_in_wait_list, event_wait_list);
+  if (err != CL_SUCCESS) {
+    return err;
+  }
+
+  amd::Command* command = NULL;
+  err = commandBuffer.enqueue(eventWaitList, &command);
+  if (err != CL_SUCCESS) {
+    return err;
+  }
+
+  *not_null(event) = as_cl(&command->event());
+  if (event == NULL) {
+    command->release();
+  }
+  return CL_SUCCESS;
+}
+RUNTIME_EXIT
+
+/*! \brief Changes an argument of a recorded kernel launch. The replays in flight complete
+ *  with the old value, the next enqueue uses the new one.
+ *
+ *  \return The clSetKernelArg() errors, or CL_INVALID_VALUE if \a command_index isn't
+ *  a kernel launch of \a command_buffer
+ */
+RUNTIME_ENTRY(cl_int, clUpdateCommandBufferKernelArgAMD,
+              (cl_command_buffer_amd command_buffer, cl_uint command_index, cl_uint arg_index,
+               size_t arg_size, const void* arg_value)) {
+  if (!is_valid(command_buffer)) {
+    return CL_INVALID_VALUE;
+  }
+  amd::CommandBuffer& commandBuffer = *as_amd(command_buffer);
+  amd::Kernel* kernel = commandBuffer.kernel(command_index);
+  if (kernel == NULL) {
+    return CL_INVALID_VALUE;
+  }
+
+  // The recorded kernel is a regular kernel object, hence reuse the argument validation
+  cl_int err = clSetKernelArg(as_cl(kernel), arg_index, arg_size, arg_value);
+  if (err != CL_SUCCESS) {
+    return err;
+  }
+  return commandBuffer.updateKernel(command_index);
+}
+RUNTIME_EXIT
+
+/*! \brief Returns the information about the command buffer
+ *
+ *  \return CL_SUCCESS, CL_INVALID_VALUE if \a command_buffer isn't valid, \a param_name
+ *  isn't supported or \a param_value_size is too small
+ */
+RUNTIME_ENTRY(cl_int, clGetCommandBufferInfoAMD,
+              (cl_command_buffer_amd command_buffer, cl_command_buffer_info_amd param_name,
+               size_t param_value_size, void* param_value, size_t* param_value_size_ret)) {
+  if (!is_valid(command_buffer)) {
+    return CL_INVALID_VALUE;
+  }
+  const amd::CommandBuffer& commandBuffer = *as_amd(command_buffer);
+
+  switch (param_name) {
+    case CL_COMMAND_BUFFER_QUEUE_AMD: {
+      cl_command_queue queue = as_cl(static_cast<amd::CommandQueue*>(&commandBuffer.queue()));
+      return amd::clGetInfo(queue, param_value_size, param_value, param_value_size_ret);
+    }
+    case CL_COMMAND_BUFFER_REFERENCE_COUNT_AMD: {
+      cl_uint count = commandBuffer.referenceCount();
+      return amd::clGetInfo(count, param_value_size, param_value, param_value_size_ret);
+    }
+    case CL_COMMAND_BUFFER_STATE_AMD: {
+      cl_command_buffer_state_amd state = (commandBuffer.state() == amd::CommandBuffer::Recording)
+          ? CL_COMMAND_BUFFER_STATE_RECORDING_AMD
+          : CL_COMMAND_BUFFER_STATE_EXECUTABLE_AMD;
+      return amd::clGetInfo(state, param_value_size, param_value, param_value_size_ret);
+    }
+    case CL_COMMAND_BUFFER_NUM_COMMANDS_AMD: {
+      cl_uint count = static_cast<cl_uint>(commandBuffer.numCommands());
+      return amd::clGetInfo(count, param_value_size, param_value, param_value_size_ret);
+    }
+    default:
+      break;
+  }
+  return CL_INVALID_VALUE;
+}
+RUNTIME_EXIT
+
+/*! @}
+ *  @}
+ */
@@ -0,0 +1,85 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef __CL_COMMAND_BUFFER_AMD_H
+#define __CL_COMMAND_BUFFER_AMD_H
+
+#include "CL/cl_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus*/
+
+typedef struct _cl_command_buffer_amd* cl_command_buffer_amd;
+typedef cl_uint cl_command_buffer_info_amd;
+typedef cl_uint cl_command_buffer_state_amd;
+
+/* cl_command_buffer_info_amd */
+#define CL_COMMAND_BUFFER_QUEUE_AMD 0x4600
+#define CL_COMMAND_BUFFER_REFERENCE_COUNT_AMD 0x4601
+#define CL_COMMAND_BUFFER_STATE_AMD 0x4602
+#define CL_COMMAND_BUFFER_NUM_COMMANDS_AMD 0x4603
+
+/* cl_command_buffer_state_amd */
+#define CL_COMMAND_BUFFER_STATE_RECORDING_AMD 0
+#define CL_COMMAND_BUFFER_STATE_EXECUTABLE_AMD 1
+
+extern CL_API_ENTRY cl_command_buffer_amd CL_API_CALL
+clCreateCommandBufferAMD(cl_command_queue command_queue, cl_int* errcode_ret);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clRetainCommandBufferAMD(cl_command_buffer_amd command_buffer);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clReleaseCommandBufferAMD(cl_command_buffer_amd command_buffer);
+
+extern CL_API_ENTRY cl_int CL_API_CALL clCommandNDRangeKernelAMD(
+    cl_command_buffer_amd command_buffer, cl_kernel kernel, cl_uint work_dim,
+    const size_t* global_work_offset, const size_t* global_work_size,
+    const size_t* local_work_size, cl_uint* command_index);
+
+extern CL_API_ENTRY cl_int CL_API_CALL clCommandCopyBufferAMD(
+    cl_command_buffer_amd command_buffer, cl_mem src_buffer, cl_mem dst_buffer,
+    size_t src_offset, size_t dst_offset, size_t size, cl_uint* command_index);
+
+extern CL_API_ENTRY cl_int CL_API_CALL clCommandFillBufferAMD(
+    cl_command_buffer_amd command_buffer, cl_mem buffer, const void* pattern,
+    size_t pattern_size, size_t offset, size_t size, cl_uint* command_index);
+
+extern CL_API_ENTRY cl_int CL_API_CALL
+clFinalizeCommandBufferAMD(cl_command_buffer_amd command_buffer);
+
+extern CL_API_ENTRY cl_int CL_API_CALL clEnqueueCommandBufferAMD(
+    cl_command_buffer_amd command_buffer, cl_uint num_events_in_wait_list,
+    const cl_event* event_wait_list, cl_event* event);
+
+extern CL_API_ENTRY cl_int CL_API_CALL clUpdateCommandBufferKernelArgAMD(
+    cl_command_buffer_amd command_buffer, cl_uint command_index, cl_uint arg_index,
+    size_t arg_size, const void* arg_value);
+
+extern CL_API_ENTRY cl_int CL_API_CALL clGetCommandBufferInfoAMD(
+    cl_command_buffer_amd command_buffer, cl_command_buffer_info_amd param_name,
+    size_t param_value_size, void* param_value, size_t* param_value_size_ret);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif /*__cplusplus*/
+
+#endif
@@ -107,6 +107,59 @@ clSetEventWaitList(
     return CL_SUCCESS;
 }
 
+//! Validates the work dimensions and sizes of a launch, \a local_work_size may be NULL
+static inline cl_int
+clValidateNDRange(
+    const device::Kernel& devKernel,
+    cl_uint work_dim,
+    const size_t* global_work_offset,
+    const size_t* global_work_size,
+    const size_t* local_work_size)
+{
+    if (work_dim < 1 || work_dim > 3) {
+        return CL_INVALID_WORK_DIMENSION;
+    }
+#if !defined(CL_VERSION_1_1)
+    if (global_work_offset != NULL) {
+        return CL_INVALID_GLOBAL_OFFSET;
+    }
+#endif  // CL_VERSION
+    if (global_work_size == NULL) {
+        return CL_INVALID_VALUE;
+    }
+    if (local_work_size == NULL) {
+        return CL_SUCCESS;
+    }
+
+    const device::Kernel::WorkGroupInfo* info = devKernel.workGroupInfo();
+    size_t numWorkItems = 1;
+    for (cl_uint dim = 0; dim < work_dim; ++dim) {
+        if ((info->compileSize_[0] != 0) &&
+                (local_work_size[dim] != info->compileSize_[dim])) {
+            return CL_INVALID_WORK_GROUP_SIZE;
+        }
+        // >32bits global work size is not supported.
+        if ((global_work_size[dim] == 0)
+                || (global_work_size[dim] > static_cast<size_t>(0xffffffff))) {
+            return CL_INVALID_GLOBAL_WORK_SIZE;
+        }
+        numWorkItems *= local_work_size[dim];
+    }
+    // Make sure local work size is valid
+    if ((numWorkItems == 0) || (numWorkItems > info->size_)) {
+        return CL_INVALID_WORK_GROUP_SIZE;
+    }
+    // Check if uniform was requested and validate dimensions
+    if (info->uniformWorkGroupSize_) {
+        for (cl_uint dim = 0; dim < work_dim; ++dim) {
+            if ((global_work_size[dim] % local_work_size[dim]) != 0) {
+                return CL_INVALID_WORK_GROUP_SIZE;
+            }
+        }
+    }
+    return CL_SUCCESS;
+}
+
 //! Common function declarations for CL-external graphics API interop
 cl_int clEnqueueAcquireExtObjectsAMD(cl_command_queue command_queue,
     cl_uint num_objects, const cl_mem* mem_objects,
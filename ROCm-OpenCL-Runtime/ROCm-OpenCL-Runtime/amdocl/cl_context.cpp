@@ -37,6 +37,8 @@
 #include "cl_debugger_amd.h"
 #include "cl_lqdflash_amd.h"
 #include "cl_p2p_amd.h"
+#include "cl_command_buffer_amd.h"
+#include "cl_pipe_amd.h"
 
 #include <GL/gl.h>
 #include <GL/glext.h>
@@ -493,6 +495,10 @@ CL_API_ENTRY void* CL_API_CALL clGetExtensionFunctionAddress(const char* func_na
 #if cl_amd_liquid_flash
       CL_EXTENSION_ENTRYPOINT_CHECK(clCreateSsgFileObjectAMD);
 #endif  // cl_amd_liquid_flash
+      CL_EXTENSION_ENTRYPOINT_CHECK(clCreateCommandBufferAMD);
+      CL_EXTENSION_ENTRYPOINT_CHECK(clCommandNDRangeKernelAMD);
+      CL_EXTENSION_ENTRYPOINT_CHECK(clCommandCopyBufferAMD);
+      CL_EXTENSION_ENTRYPOINT_CHECK(clCommandFillBufferAMD);
       break;
     case 'D':
       break;
@@ -519,6 +525,10 @@ CL_API_ENTRY void* CL_API_CALL clGetExtensionFunctionAddress(const char* func_na
 #if cl_amd_copy_buffer_p2p
       CL_EXTENSION_ENTRYPOINT_CHECK(clEnqueueCopyBufferP2PAMD);
 #endif  // cl_amd_liquid_flash
+      CL_EXTENSION_ENTRYPOINT_CHECK(clEnqueueCommandBufferAMD);
+      break;
+    case 'F':
+      CL_EXTENSION_ENTRYPOINT_CHECK(clFinalizeCommandBufferAMD);
       break;
     case 'G':
       CL_EXTENSION_ENTRYPOINT_CHECK(clGetKernelInfoAMD);
@@ -538,6 +548,7 @@ CL_API_ENTRY void* CL_API_CALL clGetExtensionFunctionAddress(const char* func_na
 #if cl_amd_liquid_flash
       CL_EXTENSION_ENTRYPOINT_CHECK(clGetSsgFileObjectInfoAMD);
 #endif  // cl_amd_liquid_flash
+      CL_EXTENSION_ENTRYPOINT_CHECK(clGetCommandBufferInfoAMD);
       break;
     case 'H':
 #ifdef _WIN32
@@ -579,6 +590,9 @@ CL_API_ENTRY void* CL_API_CALL clGetExtensionFunctionAddress(const char* func_na
       CL_EXTENSION_ENTRYPOINT_CHECK(clRetainSsgFileObjectAMD);
       CL_EXTENSION_ENTRYPOINT_CHECK(clReleaseSsgFileObjectAMD);
 #endif  // cl_amd_liquid_flash
+      CL_EXTENSION_ENTRYPOINT_CHECK(clRetainCommandBufferAMD);
+      CL_EXTENSION_ENTRYPOINT_CHECK(clReleaseCommandBufferAMD);
+      CL_EXTENSION_ENTRYPOINT_CHECK(clReadPipeAMD);
       break;
     case 'S':
       CL_EXTENSION_ENTRYPOINT_CHECK(clSetThreadTraceParamAMD);
@@ -586,6 +600,11 @@ CL_API_ENTRY void* CL_API_CALL clGetExtensionFunctionAddress(const char* func_na
       break;
     case 'U':
       CL_EXTENSION_ENTRYPOINT_CHECK(clUnloadPlatformAMD);
+      CL_EXTENSION_ENTRYPOINT_CHECK(clUpdateCommandBufferKernelArgAMD);
+      break;
+    case 'W':
+      CL_EXTENSION_ENTRYPOINT_CHECK(clWritePipeAMD);
+      break;
     default:
       break;
   }
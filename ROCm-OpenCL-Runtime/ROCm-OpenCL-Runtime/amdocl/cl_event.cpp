@@ -85,6 +85,8 @@ RUNTIME_ENTRY(cl_int, clWaitForEvents, (cl_uint num_events, const cl_event* even
 
   const amd::Context* prevContext = NULL;
   const amd::HostQueue* prevQueue = NULL;
+  const amd::Device* device = NULL;
+  bool singleDevice = true;
 
   for (cl_uint i = 0; i < num_events; ++i) {
     cl_event event = event_list[i];
@@ -106,6 +108,28 @@ RUNTIME_ENTRY(cl_int, clWaitForEvents, (cl_uint num_events, const cl_event* even
       queue->flush();
     }
     prevQueue = queue;
+
+    if (queue == NULL || (device != NULL && device != &queue->device())) {
+      singleDevice = false;
+    } else {
+      device = &queue->device();
+    }
+  }
+
+  // Wait for the HW events of all pending events with a single host sleep, hence the event
+  // waits below only pick up the final status. Any device without HW events skips it
+  if (singleDevice && num_events > 1) {
+    std::vector<amd::Event*> events;
+    events.reserve(num_events);
+    for (cl_uint i = 0; i < num_events; ++i) {
+      amd::Event* event = as_amd(event_list[i]);
+      if (event->status() > CL_COMPLETE) {
+        events.push_back(event);
+      }
+    }
+    if (events.size() > 1) {
+      device->WaitHwEvents(events);
+    }
   }
 
   bool allSucceeded = true;
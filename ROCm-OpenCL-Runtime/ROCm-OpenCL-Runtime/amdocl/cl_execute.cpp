@@ -204,46 +204,14 @@ RUNTIME_ENTRY(cl_int, clEnqueueNDRangeKernel,
     return CL_INVALID_OPERATION;
   }
 
-  if (work_dim < 1 || work_dim > 3) {
-    return CL_INVALID_WORK_DIMENSION;
-  }
-#if !defined(CL_VERSION_1_1)
-  if (global_work_offset != NULL) {
-    return CL_INVALID_GLOBAL_OFFSET;
-  }
-#endif  // CL_VERSION
-  if (global_work_size == NULL) {
-    return CL_INVALID_VALUE;
+  cl_int err = amd::clValidateNDRange(*devKernel, work_dim, global_work_offset, global_work_size,
+                                      local_work_size);
+  if (err != CL_SUCCESS) {
+    return err;
   }
-
   if (local_work_size == NULL) {
     static size_t zeroes[3] = {0, 0, 0};
     local_work_size = zeroes;
-  } else {
-    size_t numWorkItems = 1;
-    for (cl_uint dim = 0; dim < work_dim; ++dim) {
-      if ((devKernel->workGroupInfo()->compileSize_[0] != 0) &&
-          (local_work_size[dim] != devKernel->workGroupInfo()->compileSize_[dim])) {
-        return CL_INVALID_WORK_GROUP_SIZE;
-      }
-      // >32bits global work size is not supported.
-      if ((global_work_size[dim] == 0) || (global_work_size[dim] > static_cast<size_t>(0xffffffff))) {
-        return CL_INVALID_GLOBAL_WORK_SIZE;
-      }
-      numWorkItems *= local_work_size[dim];
-    }
-    // Make sure local work size is valid
-    if ((numWorkItems == 0) || (numWorkItems > devKernel->workGroupInfo()->size_)) {
-      return CL_INVALID_WORK_GROUP_SIZE;
-    }
-    // Check if uniform was requested and validate dimensions
-    if (devKernel->workGroupInfo()->uniformWorkGroupSize_) {
-      for (cl_uint dim = 0; dim < work_dim; ++dim) {
-        if ((global_work_size[dim] % local_work_size[dim]) != 0) {
-          return CL_INVALID_WORK_GROUP_SIZE;
-        }
-      }
-    }
   }
 
   // Check that all parameters have been defined.
@@ -252,7 +220,7 @@ RUNTIME_ENTRY(cl_int, clEnqueueNDRangeKernel,
   }
 
   amd::Command::EventWaitList eventWaitList;
-  cl_int err = amd::clSetEventWaitList(eventWaitList, hostQueue, num_events_in_wait_list,
+  err = amd::clSetEventWaitList(eventWaitList, hostQueue, num_events_in_wait_list,
                                        event_wait_list);
   if (err != CL_SUCCESS) {
     return err;
@@ -444,7 +444,11 @@ RUNTIME_ENTRY_RET(cl_mem, clCreateBuffer, (cl_context context, cl_mem_flags flag
     return (cl_mem)0;
   }
 
-  if (!mem->create(host_ptr)) {
+  // The host range is zero copy, hence the pinning waits for the first device use, the same
+  // way as the deferred allocations of a multi-device context
+  const bool skipAlloc = (flags & CL_MEM_USE_HOST_PTR) && (svmMem == NULL) &&
+      OCL_LAZY_HOST_PTR_PIN && !DISABLE_DEFERRED_ALLOC;
+  if (!mem->create(host_ptr, false, skipAlloc)) {
     *not_null(errcode_ret) = CL_MEM_OBJECT_ALLOCATION_FAILURE;
     mem->release();
     return NULL;
@@ -19,6 +19,7 @@
  THE SOFTWARE. */
 
 #include "cl_common.hpp"
+#include "cl_pipe_amd.h"
 #include "platform/memory.hpp"
 #include "platform/context.hpp"
 #include "platform/command.hpp"
@@ -30,6 +31,42 @@
  *  @{
  */
 
+//! Creates a pipe in fine grain SVM memory, which the host reads and writes directly
+static cl_mem createHostAccessPipe(amd::Context& amdContext, cl_mem_flags flags, size_t size,
+                                   cl_uint pipe_packet_size, cl_uint pipe_max_packets,
+                                   cl_uint alignment, cl_int* errcode_ret) {
+  void* svmPtr = amd::SvmBuffer::malloc(amdContext,
+                                        CL_MEM_SVM_FINE_GRAIN_BUFFER | CL_MEM_SVM_ATOMICS, size,
+                                        alignment);
+  amd::Memory* svmMem = (svmPtr != NULL) ? amd::MemObjMap::FindMemObj(svmPtr) : NULL;
+  if (svmMem == NULL) {
+    *not_null(errcode_ret) = CL_MEM_OBJECT_ALLOCATION_FAILURE;
+    return (cl_mem)0;
+  }
+
+  amd::Memory* mem = new (amdContext)
+      amd::Pipe(*svmMem, flags, (size_t)pipe_packet_size, (size_t)pipe_max_packets);
+  cl_int result = CL_SUCCESS;
+  if (mem == NULL) {
+    result = CL_OUT_OF_HOST_MEMORY;
+  } else {
+    svmMem->setHostMem(svmPtr);
+    // Every device initializes the ring indices on the allocation, hence create them all now,
+    // before the host produces the first packets
+    static constexpr bool ForceAlloc = true;
+    if (!mem->create(NULL, false, false, ForceAlloc)) {
+      result = CL_MEM_OBJECT_ALLOCATION_FAILURE;
+      mem->release();
+      mem = NULL;
+    }
+  }
+
+  // The pipe keeps the SVM allocation alive, but it isn't an SVM pointer of the application
+  amd::SvmBuffer::free(amdContext, svmPtr);
+  *not_null(errcode_ret) = result;
+  return as_cl(mem);
+}
+
 /*! \brief creates a pipe object.
  *
  * \param context is a valid OpenCL context used to create the pipe object.
@@ -50,7 +87,9 @@
  * corresponding values. Each property name is immediately followed by the
  * corresponding desired value. The list is terminated with 0.
  *
- * In OpenCL 2.0, properties must be NULL.
+ * In OpenCL 2.0, properties must be NULL. The cl_amd_pipe_host_access extension
+ * adds CL_PIPE_HOST_ACCESS_AMD, which places the pipe in fine grain SVM memory
+ * with atomics, so clWritePipeAMD and clReadPipeAMD can stream the packets.
  *
  * \param errcode_ret will return an appropriate error code.
  * If \a errcode_ret is NULL, no error code is returned.
@@ -60,7 +99,9 @@
  * value with one of the following error values returned in errcode_ret:
  * - CL_INVALID_CONTEXT if context is not a valid context.
  * - CL_INVALID_VALUE if values specified in flags are not as defined above.
- * - CL_INVALID_VALUE if properties is not NULL.
+ * - CL_INVALID_VALUE if properties has an unknown property or no device in
+ *   the context supports fine grain SVM buffers with atomics for
+ *   CL_PIPE_HOST_ACCESS_AMD.
  * - CL_INVALID_PIPE_SIZE if pipe_packet_size is 0 or the pipe_packet_size
  *   exceeds CL_DEVICE_PIPE_MAX_PACKET_SIZE value for all devices in context
  *   or if pipe_max_packets is 0.
@@ -94,15 +135,36 @@ RUNTIME_ENTRY_RET(cl_mem, clCreatePipe,
     return (cl_mem)0;
   }
 
+  bool hostAccess = false;
+  for (const cl_pipe_properties* p = properties; (p != NULL) && (*p != 0); p += 2) {
+    if (p[0] != CL_PIPE_HOST_ACCESS_AMD) {
+      *not_null(errcode_ret) = CL_INVALID_VALUE;
+      LogWarning("invalid parameter \"properties\"");
+      return (cl_mem)0;
+    }
+    hostAccess = (p[1] != CL_FALSE);
+  }
+
   size_t size = sizeof(struct clk_pipe_t) + pipe_packet_size * pipe_max_packets;
 
   const std::vector<amd::Device*>& devices = as_amd(context)->devices();
   bool sizePass = false;
+  cl_uint alignment = std::numeric_limits<cl_uint>::max();
+  cl_device_svm_capabilities svmCapabilities = 0;
   for (const auto& it : devices) {
     if (it->info().maxMemAllocSize_ >= size) {
       sizePass = true;
-      break;
     }
+    alignment = std::min(alignment, it->info().memBaseAddrAlign_ >> 3);
+    svmCapabilities |= it->info().svmCapabilities_;
+  }
+
+  constexpr cl_device_svm_capabilities HostAccessCaps =
+      CL_DEVICE_SVM_FINE_GRAIN_BUFFER | CL_DEVICE_SVM_ATOMICS;
+  if (hostAccess && ((svmCapabilities & HostAccessCaps) != HostAccessCaps)) {
+    *not_null(errcode_ret) = CL_INVALID_VALUE;
+    LogWarning("No device in context supports SVM fine grained buffers with atomics");
+    return (cl_mem)0;
   }
 
   // check size
@@ -113,6 +175,10 @@ RUNTIME_ENTRY_RET(cl_mem, clCreatePipe,
   }
 
   amd::Context& amdContext = *as_amd(context);
+  if (hostAccess) {
+    return createHostAccessPipe(amdContext, flags, size, pipe_packet_size, pipe_max_packets,
+                                alignment, errcode_ret);
+  }
   amd::Memory* mem = new (amdContext)
       amd::Pipe(amdContext, flags, size, (size_t)pipe_packet_size, (size_t)pipe_max_packets);
   if (mem == NULL) {
@@ -185,6 +251,83 @@ RUNTIME_ENTRY(cl_int, clGetPipeInfo,
 }
 RUNTIME_EXIT
 
+/*! \brief Writes packets into a pipe created with CL_PIPE_HOST_ACCESS_AMD.
+ *
+ * The packets go straight into the ring in fine grain memory, the call neither
+ * blocks nor enqueues a command. The kernels read them with read_pipe().
+ *
+ * \param pipe is a valid pipe object created with CL_PIPE_HOST_ACCESS_AMD.
+ *
+ * \param num_packets is the number of packets in \a packets.
+ *
+ * \param packets points to \a num_packets packets of CL_PIPE_PACKET_SIZE bytes.
+ *
+ * \param num_packets_written returns the number of packets written, which is
+ * below \a num_packets if the pipe is full. It is ignored if NULL.
+ *
+ * \return One of the following values:
+ * - CL_SUCCESS if the function is executed successfully.
+ * - CL_INVALID_MEM_OBJECT if \a pipe is not a pipe with the host access.
+ * - CL_INVALID_VALUE if \a packets is NULL and \a num_packets isn't 0.
+ */
+RUNTIME_ENTRY(cl_int, clWritePipeAMD,
+              (cl_mem pipe, cl_uint num_packets, const void* packets,
+               cl_uint* num_packets_written)) {
+  if (!is_valid(pipe)) {
+    return CL_INVALID_MEM_OBJECT;
+  }
+  amd::Pipe* amdPipe = as_amd(pipe)->asPipe();
+  if ((amdPipe == NULL) || !amdPipe->hostAccess()) {
+    return CL_INVALID_MEM_OBJECT;
+  }
+  if ((packets == NULL) && (num_packets != 0)) {
+    return CL_INVALID_VALUE;
+  }
+
+  *not_null(num_packets_written) =
+      static_cast<cl_uint>(amdPipe->hostWrite(packets, num_packets));
+  return CL_SUCCESS;
+}
+RUNTIME_EXIT
+
+/*! \brief Reads packets from a pipe created with CL_PIPE_HOST_ACCESS_AMD.
+ *
+ * The packets come straight from the ring in fine grain memory, the call
+ * neither blocks nor enqueues a command. The kernels write them with
+ * write_pipe().
+ *
+ * \param pipe is a valid pipe object created with CL_PIPE_HOST_ACCESS_AMD.
+ *
+ * \param num_packets is the number of packets \a packets can hold.
+ *
+ * \param packets points to the memory for \a num_packets packets.
+ *
+ * \param num_packets_read returns the number of packets read, which is below
+ * \a num_packets if the pipe has fewer packets. It is ignored if NULL.
+ *
+ * \return One of the following values:
+ * - CL_SUCCESS if the function is executed successfully.
+ * - CL_INVALID_MEM_OBJECT if \a pipe is not a pipe with the host access.
+ * - CL_INVALID_VALUE if \a packets is NULL and \a num_packets isn't 0.
+ */
+RUNTIME_ENTRY(cl_int, clReadPipeAMD,
+              (cl_mem pipe, cl_uint num_packets, void* packets, cl_uint* num_packets_read)) {
+  if (!is_valid(pipe)) {
+    return CL_INVALID_MEM_OBJECT;
+  }
+  amd::Pipe* amdPipe = as_amd(pipe)->asPipe();
+  if ((amdPipe == NULL) || !amdPipe->hostAccess()) {
+    return CL_INVALID_MEM_OBJECT;
+  }
+  if ((packets == NULL) && (num_packets != 0)) {
+    return CL_INVALID_VALUE;
+  }
+
+  *not_null(num_packets_read) = static_cast<cl_uint>(amdPipe->hostRead(packets, num_packets));
+  return CL_SUCCESS;
+}
+RUNTIME_EXIT
+
 /*! @}
  *  @}
  */
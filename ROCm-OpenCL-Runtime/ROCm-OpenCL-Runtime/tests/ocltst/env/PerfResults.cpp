@@ -0,0 +1,220 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "PerfResults.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "OCLLog.h"
+
+//! Trims the spaces and replaces the characters, which break the CSV and JSON fields
+static std::string sanitize(const std::string& str) {
+  std::string out;
+  for (char c : str) {
+    if ((c == '"') || (c == '\\') || (c == ',') || (c == '\n') || (c == '\r') || (c == '\t')) {
+      c = ' ';
+    }
+    if ((c != ' ') || (!out.empty() && (out.back() != ' '))) {
+      out.push_back(c);
+    }
+  }
+  if (!out.empty() && (out.back() == ' ')) {
+    out.pop_back();
+  }
+  return out;
+}
+
+void PerfResults::add(const char* module, const char* test, unsigned int index,
+                      const char* desc, float value) {
+  char name[256];
+  snprintf(name, sizeof(name), "%s.%s[%u]", module, test, index);
+
+  lock_.lock();
+  auto it = index_.find(name);
+  if (it == index_.end()) {
+    Entry entry;
+    entry.name = name;
+    entry.desc = sanitize(desc);
+    // The perf tests finish the description with the unit, such as "(GB/s)"
+    const std::string str(desc);
+    size_t end = str.rfind(')');
+    size_t begin = (end != std::string::npos) ? str.rfind('(', end) : std::string::npos;
+    if (begin != std::string::npos) {
+      entry.unit = sanitize(str.substr(begin + 1, end - begin - 1));
+    }
+    it = index_.insert(std::make_pair(entry.name, entries_.size())).first;
+    entries_.push_back(entry);
+  }
+  entries_[it->second].samples.push_back(value);
+  lock_.unlock();
+}
+
+PerfResults::Stats PerfResults::stats(std::vector<float> samples) {
+  Stats stats = {};
+  if (samples.empty()) {
+    return stats;
+  }
+  std::sort(samples.begin(), samples.end());
+  auto percentile = [&samples](double percent) {
+    return samples[static_cast<size_t>(percent * (samples.size() - 1) / 100.0 + 0.5)];
+  };
+  double sum = 0.0;
+  for (float value : samples) {
+    sum += value;
+  }
+  const double mean = sum / samples.size();
+  double variance = 0.0;
+  for (float value : samples) {
+    variance += (value - mean) * (value - mean);
+  }
+  stats.median = percentile(50);
+  stats.p5 = percentile(5);
+  stats.p95 = percentile(95);
+  stats.mean = static_cast<float>(mean);
+  stats.stddev = static_cast<float>(std::sqrt(variance / samples.size()));
+  stats.min = samples.front();
+  stats.max = samples.back();
+  return stats;
+}
+
+bool PerfResults::higherIsBetter(const std::string& unit) {
+  // The rates, such as GB/s or Mpixels/s, grow with the performance and the times shrink
+  return (unit.size() > 2) && (unit.compare(unit.size() - 2, 2, "/s") == 0);
+}
+
+bool PerfResults::write(const char* fileName, const std::string& device,
+                        const std::string& driver) const {
+  FILE* fp = fopen(fileName, "w");
+  if (fp == NULL) {
+    oclTestLog(OCLTEST_LOG_ALWAYS, "Could not open the results file: %s\n", fileName);
+    return false;
+  }
+  const size_t length = strlen(fileName);
+  const bool csv = (length > 4) && (strcmp(fileName + length - 4, ".csv") == 0);
+  const std::string dev = sanitize(device);
+  const std::string drv = sanitize(driver);
+
+  lock_.lock();
+  if (csv) {
+    fprintf(fp, "name,description,unit,device,driver,samples,median,p5,p95,mean,stddev,"
+            "min,max\n");
+  } else {
+    fprintf(fp, "{\n  \"device\": \"%s\",\n  \"driver\": \"%s\",\n  \"results\": [\n",
+            dev.c_str(), drv.c_str());
+  }
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const Entry& entry = entries_[i];
+    const Stats s = stats(entry.samples);
+    if (csv) {
+      fprintf(fp, "%s,%s,%s,%s,%s,%zu,%g,%g,%g,%g,%g,%g,%g\n", entry.name.c_str(),
+              entry.desc.c_str(), entry.unit.c_str(), dev.c_str(), drv.c_str(),
+              entry.samples.size(), s.median, s.p5, s.p95, s.mean, s.stddev, s.min,
+              s.max);
+    } else {
+      fprintf(fp, "    {\"name\": \"%s\", \"description\": \"%s\", \"unit\": \"%s\", "
+              "\"samples\": %zu, \"median\": %g, \"p5\": %g, \"p95\": %g, \"mean\": %g, "
+              "\"stddev\": %g, \"min\": %g, \"max\": %g}%s\n", entry.name.c_str(),
+              entry.desc.c_str(), entry.unit.c_str(), entry.samples.size(), s.median,
+              s.p5, s.p95, s.mean, s.stddev, s.min, s.max,
+              ((i + 1) < entries_.size()) ? "," : "");
+    }
+  }
+  lock_.unlock();
+  if (!csv) {
+    fprintf(fp, "  ]\n}\n");
+  }
+  fclose(fp);
+  return true;
+}
+
+bool PerfResults::read(const char* fileName, std::map<std::string, float>& medians) {
+  FILE* fp = fopen(fileName, "r");
+  if (fp == NULL) {
+    return false;
+  }
+  char line[2048];
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    // JSON records have one subtest per line
+    const char* name = strstr(line, "\"name\": \"");
+    if (name != NULL) {
+      name += strlen("\"name\": \"");
+      const char* end = strchr(name, '"');
+      const char* median = strstr(line, "\"median\": ");
+      if ((end != NULL) && (median != NULL)) {
+        medians[std::string(name, end)] =
+            static_cast<float>(atof(median + strlen("\"median\": ")));
+      }
+      continue;
+    }
+    // CSV records have the median in the 7th column
+    std::vector<std::string> fields;
+    const char* field = line;
+    for (const char* c = line; ; ++c) {
+      if ((*c == ',') || (*c == '\n') || (*c == '\0')) {
+        fields.push_back(std::string(field, c));
+        if (*c != ',') {
+          break;
+        }
+        field = c + 1;
+      }
+    }
+    if ((fields.size() >= 7) && (fields[0] != "name")) {
+      medians[fields[0]] = static_cast<float>(atof(fields[6].c_str()));
+    }
+  }
+  fclose(fp);
+  return true;
+}
+
+unsigned int PerfResults::compare(const char* fileName, float threshold) const {
+  std::map<std::string, float> baseline;
+  if (!read(fileName, baseline)) {
+    oclTestLog(OCLTEST_LOG_ALWAYS, "Could not open the baseline file: %s\n", fileName);
+    return 0;
+  }
+  unsigned int regressions = 0;
+  oclTestLog(OCLTEST_LOG_ALWAYS, "\nBaseline comparison with %s (threshold %.1f%%)\n",
+             fileName, threshold);
+  lock_.lock();
+  for (const Entry& entry : entries_) {
+    auto it = baseline.find(entry.name);
+    if ((it == baseline.end()) || (it->second == 0.0f)) {
+      continue;
+    }
+    const float median = stats(entry.samples).median;
+    float change = 100.0f * (median - it->second) / it->second;
+    if (!higherIsBetter(entry.unit)) {
+      change = -change;
+    }
+    if (change < -threshold) {
+      regressions++;
+      oclTestLog(OCLTEST_LOG_ALWAYS, "REGRESSION: %-40s %10.3f vs %10.3f %s (%+.1f%%)\n",
+                 entry.name.c_str(), median, it->second, entry.unit.c_str(), change);
+    }
+  }
+  lock_.unlock();
+  oclTestLog(OCLTEST_LOG_ALWAYS, "Total Regressions:   %8u\n", regressions);
+  return regressions;
+}
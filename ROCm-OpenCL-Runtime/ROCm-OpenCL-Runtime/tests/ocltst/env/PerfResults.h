@@ -0,0 +1,82 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef _PERF_RESULTS_H_
+#define _PERF_RESULTS_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "OCL/Thread.h"
+
+//! Machine-readable results of the subtests and the comparison with a baseline
+//!
+//! Every subtest is identified with "module.test[index]". The runs of -n add more samples
+//! to the same subtest, so the statistics describe the run to run variation.
+class PerfResults {
+ public:
+  PerfResults() {}
+
+  //! Adds the result of one run of a subtest
+  void add(const char* module, const char* test, unsigned int index, const char* desc,
+           float value);
+
+  //! Writes the results into a CSV file, if the name ends with ".csv", or a JSON file
+  bool write(const char* fileName, const std::string& device,
+             const std::string& driver) const;
+
+  //! Compares the medians with a file written by write(), returns the number of regressions
+  //! above the \a threshold in percent
+  unsigned int compare(const char* fileName, float threshold) const;
+
+ private:
+  struct Stats {
+    float median;
+    float p5;
+    float p95;
+    float mean;
+    float stddev;
+    float min;
+    float max;
+  };
+
+  struct Entry {
+    std::string name;          //!< module.test[index]
+    std::string desc;          //!< Test description
+    std::string unit;          //!< Unit from the description, such as GB/s
+    std::vector<float> samples;
+  };
+
+  //! Returns the statistics of the samples
+  static Stats stats(std::vector<float> samples);
+
+  //! Returns true if the larger values of the unit are better, such as GB/s
+  static bool higherIsBetter(const std::string& unit);
+
+  //! Reads the medians of a result file
+  static bool read(const char* fileName, std::map<std::string, float>& medians);
+
+  std::vector<Entry> entries_;           //!< Subtests in the execution order
+  std::map<std::string, size_t> index_;  //!< Entry of a subtest name
+  mutable OCLutil::Lock lock_;
+};
+
+#endif  // _PERF_RESULTS_H_
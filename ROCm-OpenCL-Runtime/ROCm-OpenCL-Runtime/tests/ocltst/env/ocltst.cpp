@@ -45,6 +45,7 @@ typedef void* ModuleHandle;
 #include "OCLTestImp.h"
 #include "OCLTestList.h"
 #include "OCLWrapper.h"
+#include "PerfResults.h"
 #include "Timer.h"
 #include "Worker.h"
 #include "getopt.h"
@@ -58,6 +59,9 @@ typedef void* ModuleHandle;
 //! module variable
 static OCLutil::Lock moduleLock;
 
+//! Results of all subtests for -j and -b
+static PerfResults perfResults;
+
 #include <assert.h>
 #include <stdio.h>
 
@@ -90,6 +94,8 @@ class App {
  public:
   static bool m_reRunFailed;
   static const char* m_svcMsg;
+  static const char* m_resultsFile;
+  static const char* m_baselineFile;
   //! Constructor for App
   App(unsigned int platform)
       : m_list(false),
@@ -99,6 +105,7 @@ class App {
         m_perflab(false),
         m_noSysInfoPrint(false),
         m_numItr(1),
+        m_threshold(5.0f),
         mp_testOrder(NULL),
         m_rndOrder(false),
         m_spawned(0),
@@ -290,6 +297,10 @@ class App {
   //! Function to get the number of iterations.
   int GetNumItr(void) { return m_numItr; }
 
+  //! Writes the results file and compares the results with the baseline,
+  //! returns the number of regressions
+  unsigned int ProcessResults();
+
  private:
   typedef std::vector<unsigned int> TestIndexList;
   typedef std::vector<std::string> StringList;
@@ -342,6 +353,7 @@ class App {
   bool m_perflab;
   bool m_noSysInfoPrint;
   int m_numItr;
+  float m_threshold;
   int* mp_testOrder;
   bool m_rndOrder;
 
@@ -375,6 +387,31 @@ class App {
   OCLWrapper* m_wrapper;
 };
 
+unsigned int App::ProcessResults() {
+  std::string device;
+  std::string driver;
+  cl_device_id devices[MAX_DEVICES];
+  cl_uint numDevices = 0;
+  if ((clGetDeviceIDs(mpform_id, m_useCPU ? CL_DEVICE_TYPE_CPU : CL_DEVICE_TYPE_GPU,
+                      MAX_DEVICES, devices, &numDevices) == CL_SUCCESS) &&
+      (m_deviceId < numDevices)) {
+    char buffer[256];
+    if (clGetDeviceInfo(devices[m_deviceId], CL_DEVICE_NAME, sizeof(buffer), buffer,
+                        NULL) == CL_SUCCESS) {
+      device = buffer;
+    }
+    if (clGetDeviceInfo(devices[m_deviceId], CL_DRIVER_VERSION, sizeof(buffer), buffer,
+                        NULL) == CL_SUCCESS) {
+      driver = buffer;
+    }
+  }
+
+  if (m_resultsFile != NULL) {
+    perfResults.write(m_resultsFile, device, driver);
+  }
+  return (m_baselineFile != NULL) ? perfResults.compare(m_baselineFile, m_threshold) : 0;
+}
+
 void App::printOCLinfo(void) {
   std::string calinfo;
   if (!m_noSysInfoPrint) {
@@ -555,6 +592,9 @@ void report(Worker* w, const char* testname, int testnum, unsigned int crc,
   unsigned int deviceId = w->getDeviceId();
 
   char tmpUnits[256];
+  if (tr->passed && ((App::m_resultsFile != NULL) || (App::m_baselineFile != NULL))) {
+    perfResults.add(w->getModule()->get_libname(), testname, testnum, testDesc, timer);
+  }
   if (perflab) {
     oclTestLog(OCLTEST_LOG_ALWAYS, "%10.3f\n", timer);
   } else {
@@ -1005,6 +1045,14 @@ static void Help(const char* name) {
              "   -o <filename> : dump the output to a specified file\n");
   oclTestLog(OCLTEST_LOG_ALWAYS,
              "   -c            : Run the test on the CPU device.\n");
+  oclTestLog(OCLTEST_LOG_ALWAYS,
+             "   -j <filename> : write the results with the statistics of the -n "
+             "runs to a JSON file, or a CSV file for *.csv\n");
+  oclTestLog(OCLTEST_LOG_ALWAYS,
+             "   -b <filename> : compare the results with a baseline file written "
+             "by -j\n");
+  oclTestLog(OCLTEST_LOG_ALWAYS,
+             "   -e <percent>  : regression threshold of -b, 5%% by default\n");
   oclTestLog(OCLTEST_LOG_ALWAYS, "                 : \n");
   oclTestLog(OCLTEST_LOG_ALWAYS,
              "                 : To run only one subtest of a test, append the "
@@ -1065,7 +1113,7 @@ unsigned int getPlatformID(const char* str) {
   return platform;
 }
 
-static const char* supported_options = "dg:lm:M:o:Ps:t:T:a:A:p:v:wxy:in:rcRVJ";
+static const char* supported_options = "dg:lm:M:o:Ps:t:T:a:A:p:v:wxy:in:rcRVJj:b:e:";
 
 unsigned int parseCommandLineForPlatform(unsigned int argc, char** argv) {
   int c;
@@ -1226,6 +1274,15 @@ void App::CommandLine(unsigned int argc, char** argv) {
       case 'i':
         m_noSysInfoPrint = true;
         break;
+      case 'j':
+        m_resultsFile = optarg;
+        break;
+      case 'b':
+        m_baselineFile = optarg;
+        break;
+      case 'e':
+        m_threshold = static_cast<float>(atof(optarg));
+        break;
       default:
         Help(argv[0]);
         break;
@@ -1462,12 +1519,15 @@ extern int optind;
 /////////////////////////////////////////////////////////////////////////////
 bool App::m_reRunFailed = false;
 const char* App::m_svcMsg = nullptr;
+const char* App::m_resultsFile = nullptr;
+const char* App::m_baselineFile = nullptr;
 
 int main(int argc, char** argv) {
 #if EMU_ENV
   printf("Built for Emulation Environment\n");
 #endif  // EMU_ENV
   unsigned int platform = 0;
+  unsigned int regressions = 0;
   platform = parseCommandLineForPlatform(argc, argv);
   // reset optind as we really didn't parse the full command line
   optind = 1;
@@ -1490,6 +1550,7 @@ int main(int argc, char** argv) {
     for (int i = 0; i < app.GetNumItr(); i++) {
       app.RunAllTests();
     }
+    regressions = app.ProcessResults();
     app.CleanUp();
 #ifdef AUTO_REGRESS
   } catch (...) {
@@ -1498,7 +1559,7 @@ int main(int argc, char** argv) {
   }
 #endif /* AUTO_REGRESS */
 
-  return 0;
+  return (regressions != 0) ? 1 : 0;
 }
 
 #ifdef _WIN32
@@ -0,0 +1,196 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "OCLPerfEnqueueContention.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "CL/cl.h"
+
+// Quiet pesky warnings
+#ifdef WIN_OS
+#define SNPRINTF sprintf_s
+#else
+#define SNPRINTF snprintf
+#endif
+
+static const unsigned int Threads[] = {1, 2, 4, 8, 16, 32, 64, 128};
+static const unsigned int NumThreadCounts = sizeof(Threads) / sizeof(Threads[0]);
+static const unsigned int Iterations = 2000;  //!< Commands per thread
+static const size_t CopySize = 4096;
+
+static const char* strKernel =
+    "__kernel void enqueueContention(__global uint* out)\n"
+    "{\n"
+    "    if (get_global_id(0) == 0xffffffff) out[0] = 0;\n"
+    "}\n";
+
+OCLPerfEnqueueContention::OCLPerfEnqueueContention() {
+  // Thread counts x {shared queue, queue per thread} x {kernel, copy}
+  _numSubTests = NumThreadCounts * 2 * 2;
+  failed_ = false;
+}
+
+OCLPerfEnqueueContention::~OCLPerfEnqueueContention() {}
+
+void OCLPerfEnqueueContention::open(unsigned int test, char* units,
+                                    double& conversion,
+                                    unsigned int deviceId) {
+  OCLTestImp::open(test, units, conversion, deviceId);
+  CHECK_RESULT((error_ != CL_SUCCESS), "Error opening test");
+
+  numThreads_ = Threads[test % NumThreadCounts];
+  sharedQueue_ = ((test / NumThreadCounts) % 2) == 0;
+  copy_ = (test / (NumThreadCounts * 2)) != 0;
+  start_.store(false);
+
+  cl_device_type deviceType;
+  error_ = _wrapper->clGetDeviceInfo(devices_[deviceId], CL_DEVICE_TYPE,
+                                     sizeof(deviceType), &deviceType, NULL);
+  CHECK_RESULT((error_ != CL_SUCCESS), "CL_DEVICE_TYPE failed");
+  if (!(deviceType & CL_DEVICE_TYPE_GPU)) {
+    printf("GPU device is required for this test!\n");
+    failed_ = true;
+    return;
+  }
+
+  program_ = _wrapper->clCreateProgramWithSource(context_, 1, &strKernel,
+                                                 NULL, &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateProgramWithSource() failed");
+  error_ = _wrapper->clBuildProgram(program_, 1, &devices_[deviceId], NULL,
+                                    NULL, NULL);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clBuildProgram() failed");
+
+  threads_.resize(numThreads_);
+  for (auto& it : threads_) {
+    it.test = this;
+    it.queue = NULL;
+    it.kernel = NULL;
+    it.error = CL_SUCCESS;
+    it.latency.resize(Iterations);
+    if (sharedQueue_) {
+      it.queue = cmdQueues_[deviceId];
+    } else {
+      it.queue = _wrapper->clCreateCommandQueue(context_, devices_[deviceId],
+                                                0, &error_);
+      CHECK_RESULT((error_ != CL_SUCCESS), "clCreateCommandQueue() failed");
+    }
+    // The kernel arguments aren't thread safe, hence every thread has a kernel
+    it.kernel = _wrapper->clCreateKernel(program_, "enqueueContention",
+                                         &error_);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clCreateKernel() failed");
+    it.src = _wrapper->clCreateBuffer(context_, CL_MEM_READ_WRITE, CopySize,
+                                      NULL, &error_);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clCreateBuffer() failed");
+    buffers_.push_back(it.src);
+    it.dst = _wrapper->clCreateBuffer(context_, CL_MEM_READ_WRITE, CopySize,
+                                      NULL, &error_);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clCreateBuffer() failed");
+    buffers_.push_back(it.dst);
+    error_ = _wrapper->clSetKernelArg(it.kernel, 0, sizeof(cl_mem), &it.dst);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clSetKernelArg() failed");
+  }
+}
+
+void* OCLPerfEnqueueContention::submit(void* data) {
+  ThreadData* thread = reinterpret_cast<ThreadData*>(data);
+  OCLPerfEnqueueContention* test = thread->test;
+  const size_t global = 64;
+
+  while (!test->start_.load(std::memory_order_acquire)) {
+  }
+  for (unsigned int i = 0; i < Iterations; ++i) {
+    const auto begin = std::chrono::steady_clock::now();
+    cl_int error;
+    if (test->copy_) {
+      error = test->_wrapper->clEnqueueCopyBuffer(thread->queue, thread->src, thread->dst, 0, 0,
+                                                CopySize, 0, NULL, NULL);
+    } else {
+      error = test->_wrapper->clEnqueueNDRangeKernel(
+          thread->queue, thread->kernel, 1, NULL, &global, NULL, 0, NULL, NULL);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    thread->latency[i] =
+        std::chrono::duration<float, std::micro>(end - begin).count();
+    if (error != CL_SUCCESS) {
+      thread->error = error;
+      break;
+    }
+  }
+  test->_wrapper->clFlush(thread->queue);
+  return NULL;
+}
+
+void OCLPerfEnqueueContention::run(void) {
+  if (failed_) {
+    return;
+  }
+  std::vector<OCLutil::Thread> pool(numThreads_);
+  for (unsigned int t = 0; t < numThreads_; ++t) {
+    pool[t].create(submit, &threads_[t]);
+  }
+  start_.store(true, std::memory_order_release);
+  for (auto& it : pool) {
+    it.join();
+  }
+
+  std::vector<float> samples;
+  samples.reserve(numThreads_ * Iterations);
+  for (auto& it : threads_) {
+    CHECK_RESULT((it.error != CL_SUCCESS), "Enqueue failed");
+    error_ = _wrapper->clFinish(it.queue);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clFinish() failed");
+    samples.insert(samples.end(), it.latency.begin(), it.latency.end());
+  }
+  std::sort(samples.begin(), samples.end());
+  auto percentile = [&samples](double percent) {
+    return samples[static_cast<size_t>(percent * (samples.size() - 1) / 100.0)];
+  };
+
+  const char* dd = getenv("AMD_DIRECT_DISPATCH");
+  char buf[256];
+  SNPRINTF(buf, sizeof(buf),
+           " %3u threads %-10s %-6s dd:%-3s p90 %8.2f p99 %8.2f max %9.2f "
+           "p50 (us)", numThreads_, sharedQueue_ ? "shared" : "per-thread",
+           copy_ ? "copy" : "kernel",
+           (dd == NULL) ? "def" : ((atoi(dd) != 0) ? "on" : "off"),
+           percentile(90), percentile(99), samples.back());
+  testDescString = buf;
+  _perfInfo = percentile(50);
+}
+
+unsigned int OCLPerfEnqueueContention::close(void) {
+  for (auto& it : threads_) {
+    if (!sharedQueue_ && (it.queue != NULL)) {
+      _wrapper->clReleaseCommandQueue(it.queue);
+    }
+    if (it.kernel != NULL) {
+      _wrapper->clReleaseKernel(it.kernel);
+    }
+  }
+  threads_.clear();
+  return OCLTestImp::close();
+}
@@ -0,0 +1,66 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef _OCL_PERF_ENQUEUE_CONTENTION_H_
+#define _OCL_PERF_ENQUEUE_CONTENTION_H_
+
+#include <atomic>
+#include <vector>
+
+#include "OCLTestImp.h"
+
+//! Enqueue latency of many host threads, which submit into one shared queue or
+//! into a queue per thread. The direct dispatch mode comes from AMD_DIRECT_DISPATCH,
+//! hence the test runs once per mode.
+class OCLPerfEnqueueContention : public OCLTestImp {
+ public:
+  OCLPerfEnqueueContention();
+  virtual ~OCLPerfEnqueueContention();
+
+ public:
+  virtual void open(unsigned int test, char* units, double& conversion,
+                    unsigned int deviceID);
+  virtual void run(void);
+  virtual unsigned int close(void);
+
+  //! State of a submission thread
+  struct ThreadData {
+    OCLPerfEnqueueContention* test;
+    cl_command_queue queue;
+    cl_kernel kernel;
+    cl_mem src;
+    cl_mem dst;
+    std::vector<float> latency;  //!< Enqueue latency of every command in us
+    cl_int error;
+  };
+
+  //! Submits the commands of one thread
+  static void* submit(void* data);
+
+ private:
+  bool failed_;
+  bool copy_;                //!< Enqueue copies instead of kernels
+  bool sharedQueue_;         //!< All threads use cmdQueues_[_deviceId]
+  unsigned int numThreads_;
+  std::atomic<bool> start_;  //!< Releases all threads at once
+  std::vector<ThreadData> threads_;
+};
+
+#endif  // _OCL_PERF_ENQUEUE_CONTENTION_H_
@@ -0,0 +1,224 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+#include "OCLPerfKernelArgScaling.h"
+
+#include <Timer.h>
+#include <stdio.h>
+
+#include <sstream>
+#include <string>
+
+#include "CL/cl.h"
+
+static const unsigned int Iterations = 4096;
+static const size_t BufSize = 4096;
+static const size_t ImageSize = 64;
+
+static const unsigned int ArgCounts[] = {0, 1, 4, 16, 64, 128, 256};
+static const unsigned int NumArgCounts = sizeof(ArgCounts) / sizeof(ArgCounts[0]);
+
+enum ArgType { ArgBuffer = 0, ArgSvm, ArgValue, ArgImage, NumArgTypes };
+
+static const char* ArgNames[NumArgTypes] = {"buffer", "svm   ", "value ",
+                                            "image "};
+static const char* ArgDecls[NumArgTypes] = {
+    "__global uint* a", "__global uint* a", "uint4 a", "__read_only image2d_t a"};
+//! Kernel argument sizes, the images and the buffers are passed as 64 bit handles
+static const size_t ArgSizes[NumArgTypes] = {8, 8, 16, 8};
+
+OCLPerfKernelArgScaling::OCLPerfKernelArgScaling() {
+  _numSubTests = NumArgTypes * NumArgCounts;
+  failed_ = false;
+}
+
+OCLPerfKernelArgScaling::~OCLPerfKernelArgScaling() {}
+
+void OCLPerfKernelArgScaling::open(unsigned int test, char* units,
+                                   double& conversion, unsigned int deviceId) {
+  _deviceId = deviceId;
+  OCLTestImp::open(test, units, conversion, deviceId);
+  CHECK_RESULT((error_ != CL_SUCCESS), "Error opening test");
+  test_ = test;
+  type_ = test / NumArgCounts;
+  numArgs_ = ArgCounts[test % NumArgCounts];
+  argBytes_ = numArgs_ * ArgSizes[type_];
+
+  // Skip the configurations beyond the device limits
+  size_t maxParamSize = 0;
+  error_ = _wrapper->clGetDeviceInfo(devices_[deviceId],
+                                     CL_DEVICE_MAX_PARAMETER_SIZE,
+                                     sizeof(maxParamSize), &maxParamSize, NULL);
+  CHECK_RESULT((error_ != CL_SUCCESS), "CL_DEVICE_MAX_PARAMETER_SIZE failed");
+  if (argBytes_ > maxParamSize) {
+    printf("Kernel arguments exceed CL_DEVICE_MAX_PARAMETER_SIZE, skipping...\n");
+    failed_ = true;
+    return;
+  }
+  if (type_ == ArgImage) {
+    cl_bool images = CL_FALSE;
+    cl_uint maxImageArgs = 0;
+    _wrapper->clGetDeviceInfo(devices_[deviceId], CL_DEVICE_IMAGE_SUPPORT,
+                              sizeof(images), &images, NULL);
+    _wrapper->clGetDeviceInfo(devices_[deviceId], CL_DEVICE_MAX_READ_IMAGE_ARGS,
+                              sizeof(maxImageArgs), &maxImageArgs, NULL);
+    if (!images || (numArgs_ > maxImageArgs)) {
+      printf("Image arguments aren't supported, skipping...\n");
+      failed_ = true;
+      return;
+    }
+  }
+  if (type_ == ArgSvm) {
+#if defined(CL_VERSION_2_0)
+    cl_device_svm_capabilities caps = 0;
+    _wrapper->clGetDeviceInfo(devices_[deviceId], CL_DEVICE_SVM_CAPABILITIES,
+                              sizeof(caps), &caps, NULL);
+    if (caps == 0) {
+#endif
+      printf("SVM isn't supported, skipping...\n");
+      failed_ = true;
+      return;
+#if defined(CL_VERSION_2_0)
+    }
+#endif
+  }
+
+  std::stringstream source;
+  source << "__kernel void argScaling(__global uint* out";
+  for (unsigned int a = 0; a < numArgs_; ++a) {
+    source << ", " << ArgDecls[type_] << a;
+  }
+  source << ")\n"
+            "{\n"
+            "    if (get_global_id(0) == 0xffffffff) out[0] = 0;\n"
+            "}\n";
+  const std::string str = source.str();
+  const char* program = str.c_str();
+  program_ = _wrapper->clCreateProgramWithSource(context_, 1, &program, NULL,
+                                                 &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateProgramWithSource()  failed");
+  error_ = _wrapper->clBuildProgram(program_, 1, &devices_[deviceId], NULL,
+                                    NULL, NULL);
+  if (error_ != CL_SUCCESS) {
+    char programLog[1024];
+    _wrapper->clGetProgramBuildInfo(program_, devices_[deviceId],
+                                    CL_PROGRAM_BUILD_LOG, 1024, programLog, 0);
+    printf("\n%s\n", programLog);
+    fflush(stdout);
+  }
+  CHECK_RESULT((error_ != CL_SUCCESS), "clBuildProgram() failed");
+  kernel_ = _wrapper->clCreateKernel(program_, "argScaling", &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateKernel() failed");
+
+  cl_mem out = _wrapper->clCreateBuffer(context_, CL_MEM_READ_WRITE, BufSize,
+                                        NULL, &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateBuffer() failed");
+  buffers_.push_back(out);
+  error_ = _wrapper->clSetKernelArg(kernel_, 0, sizeof(cl_mem), &out);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clSetKernelArg() failed");
+
+  // Every argument is a separate memory object, as in the real kernels
+  for (cl_uint a = 1; a <= numArgs_; ++a) {
+    switch (type_) {
+      case ArgBuffer: {
+        cl_mem buffer = _wrapper->clCreateBuffer(context_, CL_MEM_READ_WRITE,
+                                                 BufSize, NULL, &error_);
+        CHECK_RESULT((error_ != CL_SUCCESS), "clCreateBuffer() failed");
+        buffers_.push_back(buffer);
+        error_ = _wrapper->clSetKernelArg(kernel_, a, sizeof(cl_mem), &buffer);
+        break;
+      }
+      case ArgSvm: {
+#if defined(CL_VERSION_2_0)
+        void* ptr =
+            _wrapper->clSVMAlloc(context_, CL_MEM_READ_WRITE, BufSize, 0);
+        CHECK_RESULT((ptr == NULL), "clSVMAlloc() failed");
+        svm_.push_back(ptr);
+        error_ = _wrapper->clSetKernelArgSVMPointer(kernel_, a, ptr);
+#endif
+        break;
+      }
+      case ArgValue: {
+        cl_uint4 value = {{a, a, a, a}};
+        error_ = _wrapper->clSetKernelArg(kernel_, a, sizeof(value), &value);
+        break;
+      }
+      case ArgImage: {
+        cl_image_format format = {CL_RGBA, CL_UNSIGNED_INT8};
+        cl_image_desc desc = {};
+        desc.image_type = CL_MEM_OBJECT_IMAGE2D;
+        desc.image_width = ImageSize;
+        desc.image_height = ImageSize;
+        cl_mem image = _wrapper->clCreateImage(context_, CL_MEM_READ_ONLY,
+                                               &format, &desc, NULL, &error_);
+        CHECK_RESULT((error_ != CL_SUCCESS), "clCreateImage() failed");
+        buffers_.push_back(image);
+        error_ = _wrapper->clSetKernelArg(kernel_, a, sizeof(cl_mem), &image);
+        break;
+      }
+    }
+    CHECK_RESULT((error_ != CL_SUCCESS), "clSetKernelArg() failed");
+  }
+}
+
+void OCLPerfKernelArgScaling::run(void) {
+  if (failed_) {
+    return;
+  }
+  cl_command_queue queue = cmdQueues_[_deviceId];
+  size_t gws[1] = {64};
+  size_t lws[1] = {64};
+
+  // Warm-up
+  error_ = _wrapper->clEnqueueNDRangeKernel(queue, kernel_, 1, NULL, gws, lws,
+                                            0, NULL, NULL);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueNDRangeKernel() failed");
+  _wrapper->clFinish(queue);
+
+  CPerfCounter timer;
+  timer.Reset();
+  timer.Start();
+  for (unsigned int i = 0; i < Iterations; ++i) {
+    error_ = _wrapper->clEnqueueNDRangeKernel(queue, kernel_, 1, NULL, gws,
+                                              lws, 0, NULL, NULL);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clEnqueueNDRangeKernel() failed");
+  }
+  timer.Stop();
+  _wrapper->clFinish(queue);
+
+  std::stringstream stream;
+  stream << "Enqueue time (us) for ";
+  stream.width(3);
+  stream << numArgs_ << " " << ArgNames[type_] << " args, ";
+  stream.width(4);
+  stream << argBytes_ << " bytes";
+  testDescString = stream.str();
+  _perfInfo =
+      static_cast<float>(timer.GetElapsedTime() * 1000000 / Iterations);
+}
+
+unsigned int OCLPerfKernelArgScaling::close(void) {
+#if defined(CL_VERSION_2_0)
+  for (size_t i = 0; i < svm_.size(); ++i) {
+    _wrapper->clSVMFree(context_, svm_[i]);
+  }
+  svm_.clear();
+#endif
+  return OCLTestImp::close();
+}
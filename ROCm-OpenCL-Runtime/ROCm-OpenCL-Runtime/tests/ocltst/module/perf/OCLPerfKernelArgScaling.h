@@ -0,0 +1,49 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+#ifndef _OCL_PERF_KERNEL_ARG_SCALING_H_
+#define _OCL_PERF_KERNEL_ARG_SCALING_H_
+
+#include <vector>
+
+#include "OCLTestImp.h"
+
+//! Enqueue cost by the argument count and type. The arguments are set once, so the time
+//! is the capture of the arguments and the validation of the memory objects per launch.
+class OCLPerfKernelArgScaling : public OCLTestImp {
+ public:
+  OCLPerfKernelArgScaling();
+  virtual ~OCLPerfKernelArgScaling();
+
+ public:
+  virtual void open(unsigned int test, char* units, double& conversion,
+                    unsigned int deviceID);
+  virtual void run(void);
+  virtual unsigned int close(void);
+
+ private:
+  bool failed_;
+  unsigned int test_;
+  unsigned int type_;      //!< Argument type
+  unsigned int numArgs_;   //!< Argument count
+  size_t argBytes_;        //!< Total size of the arguments
+  std::vector<void*> svm_;
+};
+
+#endif  // _OCL_PERF_KERNEL_ARG_SCALING_H_
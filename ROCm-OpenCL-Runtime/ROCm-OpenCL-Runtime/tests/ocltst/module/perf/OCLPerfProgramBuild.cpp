@@ -0,0 +1,121 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+#include "OCLPerfProgramBuild.h"
+
+#include <Timer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "CL/cl.h"
+
+static const unsigned int Iterations = 10;
+static const unsigned int NumKernels = 64;  //!< Kernels of the program
+
+//! Returns a program of NumKernels kernels, \a salt makes the source unique
+static std::string programSource(unsigned int salt) {
+  std::stringstream source;
+  source << "// build " << salt << "\n";
+  for (unsigned int k = 0; k < NumKernels; ++k) {
+    source << "__kernel void build" << k
+           << "(__global float* out, __global const float* in, uint n)\n"
+              "{\n"
+              "    uint id = get_global_id(0);\n"
+              "    float v = in[id];\n"
+              "    for (uint i = 0; i < n; ++i) {\n"
+              "        v = mad(v, "
+           << (k + 1) << ".0f, sin(v)) * cos(v + " << k
+           << ".0f);\n"
+              "    }\n"
+              "    out[id] = v;\n"
+              "}\n";
+  }
+  return source.str();
+}
+
+OCLPerfProgramBuild::OCLPerfProgramBuild() {
+  // Cold and warm builds
+  _numSubTests = 2;
+  failed_ = false;
+}
+
+OCLPerfProgramBuild::~OCLPerfProgramBuild() {}
+
+void OCLPerfProgramBuild::open(unsigned int test, char* units,
+                               double& conversion, unsigned int deviceId) {
+  _deviceId = deviceId;
+  OCLTestImp::open(test, units, conversion, deviceId);
+  CHECK_RESULT((error_ != CL_SUCCESS), "Error opening test");
+  test_ = test;
+}
+
+double OCLPerfProgramBuild::build(const std::string& source) {
+  const char* str = source.c_str();
+  cl_program program =
+      _wrapper->clCreateProgramWithSource(context_, 1, &str, NULL, &error_);
+  if (error_ != CL_SUCCESS) {
+    return 0.0;
+  }
+  CPerfCounter timer;
+  timer.Reset();
+  timer.Start();
+  error_ = _wrapper->clBuildProgram(program, 1, &devices_[_deviceId], "",
+                                    NULL, NULL);
+  timer.Stop();
+  _wrapper->clReleaseProgram(program);
+  return timer.GetElapsedTime() * 1000;
+}
+
+void OCLPerfProgramBuild::run(void) {
+  if (failed_) {
+    return;
+  }
+  const bool cold = (test_ == 0);
+  // A unique salt per process, so the cold builds miss a disk cache of an earlier run
+  const unsigned int base = static_cast<unsigned int>(time(NULL)) * Iterations;
+  if (!cold) {
+    // Prime the caches
+    build(programSource(base));
+    CHECK_RESULT((error_ != CL_SUCCESS), "clBuildProgram() failed");
+  }
+
+  std::vector<double> samples(Iterations);
+  for (unsigned int i = 0; i < Iterations; ++i) {
+    samples[i] = build(programSource(cold ? base + i + 1 : base));
+    CHECK_RESULT((error_ != CL_SUCCESS), "clBuildProgram() failed");
+  }
+  std::sort(samples.begin(), samples.end());
+
+  const char* cache = getenv("OCL_CODE_CACHE_ENABLE");
+  std::stringstream stream;
+  stream << (cold ? "Cold" : "Warm") << " build of " << NumKernels
+         << " kernels, code cache "
+         << (((cache != NULL) && (atoi(cache) != 0)) ? "on " : "off")
+         << ", max " << samples.back() << " ms ";
+  stream << "(ms)";
+  testDescString = stream.str();
+  _perfInfo = static_cast<float>(samples[Iterations / 2]);
+}
+
+unsigned int OCLPerfProgramBuild::close(void) { return OCLTestImp::close(); }
@@ -0,0 +1,49 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+#ifndef _OCL_PERF_PROGRAM_BUILD_H_
+#define _OCL_PERF_PROGRAM_BUILD_H_
+
+#include <string>
+
+#include "OCLTestImp.h"
+
+//! clBuildProgram time of a program with many kernels. The cold builds change the
+//! source every time, so no code cache can hit, the warm builds repeat one source.
+//! The disk cache is enabled with OCL_CODE_CACHE_ENABLE.
+class OCLPerfProgramBuild : public OCLTestImp {
+ public:
+  OCLPerfProgramBuild();
+  virtual ~OCLPerfProgramBuild();
+
+ public:
+  virtual void open(unsigned int test, char* units, double& conversion,
+                    unsigned int deviceID);
+  virtual void run(void);
+  virtual unsigned int close(void);
+
+ private:
+  //! Builds \a source and returns the time in ms
+  double build(const std::string& source);
+
+  bool failed_;
+  unsigned int test_;
+};
+
+#endif  // _OCL_PERF_PROGRAM_BUILD_H_
@@ -0,0 +1,291 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+#include "OCLPerfSoak.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "CL/cl.h"
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+#ifdef WIN_OS
+#define SNPRINTF sprintf_s
+#else
+#define SNPRINTF snprintf
+#endif
+
+static const unsigned int NumQueues = 4;
+static const size_t CopySize = 1024 * 1024;
+static const size_t StagedSize = 64 * 1024;  //!< Pageable transfers go through staging
+static const size_t AllocSize = 4 * 1024 * 1024;
+
+static const char* strKernel =
+    "__kernel void soak(__global uint* out)\n"
+    "{\n"
+    "    out[get_global_id(0)] += 1;\n"
+    "}\n";
+
+//! Process resources, which grow on a leak
+struct Resources {
+  double rssMB;
+  int fds;   //!< Open files, the interrupt signals and the events use them
+  int maps;  //!< Memory mappings, the pinned and staging pools add them
+};
+
+static Resources resources() {
+  Resources res = {0.0, 0, 0};
+#ifndef _WIN32
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (statm != NULL) {
+    unsigned long size = 0, rss = 0;
+    if (fscanf(statm, "%lu %lu", &size, &rss) == 2) {
+      res.rssMB = rss * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024 * 1024);
+    }
+    fclose(statm);
+  }
+  DIR* dir = opendir("/proc/self/fd");
+  if (dir != NULL) {
+    while (readdir(dir) != NULL) {
+      res.fds++;
+    }
+    closedir(dir);
+  }
+  FILE* maps = fopen("/proc/self/maps", "r");
+  if (maps != NULL) {
+    int c;
+    while ((c = fgetc(maps)) != EOF) {
+      res.maps += (c == '\n') ? 1 : 0;
+    }
+    fclose(maps);
+  }
+#endif
+  return res;
+}
+
+OCLPerfSoak::OCLPerfSoak() {
+  _numSubTests = 1;
+  failed_ = false;
+}
+
+OCLPerfSoak::~OCLPerfSoak() {}
+
+void OCLPerfSoak::open(unsigned int test, char* units, double& conversion,
+                       unsigned int deviceId) {
+  OCLTestImp::open(test, units, conversion, deviceId);
+  CHECK_RESULT((error_ != CL_SUCCESS), "Error opening test");
+  const char* minutes = getenv("OCL_SOAK_MINUTES");
+  minutes_ = (minutes != NULL) ? std::max(1, atoi(minutes)) : 1;
+  stop_.store(false);
+
+  program_ = _wrapper->clCreateProgramWithSource(context_, 1, &strKernel,
+                                                 NULL, &error_);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clCreateProgramWithSource() failed");
+  error_ = _wrapper->clBuildProgram(program_, 1, &devices_[deviceId], NULL,
+                                    NULL, NULL);
+  CHECK_RESULT((error_ != CL_SUCCESS), "clBuildProgram() failed");
+
+  for (unsigned int q = 0; q < NumQueues; ++q) {
+    ThreadData* thread = new ThreadData;
+    threads_.push_back(thread);
+    thread->test = this;
+    thread->index = q;
+    thread->kernel = NULL;
+    thread->ops = 0;
+    thread->error = CL_SUCCESS;
+    thread->host.resize(StagedSize);
+    thread->queue = _wrapper->clCreateCommandQueue(context_, devices_[deviceId],
+                                                   0, &error_);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clCreateCommandQueue() failed");
+    // The kernel arguments aren't thread safe, hence every thread has a kernel
+    thread->kernel = _wrapper->clCreateKernel(program_, "soak", &error_);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clCreateKernel() failed");
+    thread->src = _wrapper->clCreateBuffer(context_, CL_MEM_READ_WRITE,
+                                           CopySize, NULL, &error_);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clCreateBuffer() failed");
+    buffers_.push_back(thread->src);
+    thread->dst = _wrapper->clCreateBuffer(context_, CL_MEM_READ_WRITE,
+                                           CopySize, NULL, &error_);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clCreateBuffer() failed");
+    buffers_.push_back(thread->dst);
+    error_ = _wrapper->clSetKernelArg(thread->kernel, 0, sizeof(cl_mem),
+                                      &thread->dst);
+    CHECK_RESULT((error_ != CL_SUCCESS), "clSetKernelArg() failed");
+  }
+}
+
+void* OCLPerfSoak::work(void* data) {
+  ThreadData* thread = reinterpret_cast<ThreadData*>(data);
+  OCLWrapper* wrapper = thread->test->_wrapper;
+  const size_t global = 256;
+  // A fixed seed per queue, so the runs replay the same sequence
+  unsigned int seed = 12345 + thread->index;
+
+  while (!thread->test->stop_.load(std::memory_order_relaxed)) {
+    seed = seed * 1103515245 + 12345;
+    const auto begin = std::chrono::steady_clock::now();
+    cl_int error = CL_SUCCESS;
+    switch ((seed >> 16) % 4) {
+      case 0:
+        error = wrapper->clEnqueueNDRangeKernel(thread->queue, thread->kernel,
+                                                1, NULL, &global, NULL, 0, NULL,
+                                                NULL);
+        error |= wrapper->clFinish(thread->queue);
+        break;
+      case 1:
+        error = wrapper->clEnqueueCopyBuffer(thread->queue, thread->src,
+                                             thread->dst, 0, 0, CopySize, 0,
+                                             NULL, NULL);
+        error |= wrapper->clEnqueueReadBuffer(thread->queue, thread->dst,
+                                              CL_TRUE, 0, StagedSize,
+                                              &thread->host[0], 0, NULL, NULL);
+        break;
+      case 2: {
+        cl_mem buffer = wrapper->clCreateBuffer(thread->test->context_,
+                                                CL_MEM_READ_WRITE, AllocSize,
+                                                NULL, &error);
+        if (error == CL_SUCCESS) {
+          error = wrapper->clEnqueueWriteBuffer(thread->queue, buffer, CL_TRUE,
+                                                0, StagedSize, &thread->host[0],
+                                                0, NULL, NULL);
+          error |= wrapper->clReleaseMemObject(buffer);
+        }
+        break;
+      }
+      case 3: {
+        cl_event event;
+        error = wrapper->clEnqueueMarkerWithWaitList(thread->queue, 0, NULL,
+                                                     &event);
+        if (error == CL_SUCCESS) {
+          error = wrapper->clWaitForEvents(1, &event);
+          error |= wrapper->clReleaseEvent(event);
+        }
+        break;
+      }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    if (error != CL_SUCCESS) {
+      thread->error = error;
+      break;
+    }
+    thread->lock.lock();
+    thread->latency.push_back(
+        std::chrono::duration<float, std::micro>(end - begin).count());
+    thread->ops++;
+    thread->lock.unlock();
+  }
+  return NULL;
+}
+
+void OCLPerfSoak::run(void) {
+  if (failed_) {
+    return;
+  }
+  const auto duration = std::chrono::seconds(minutes_ * 60);
+  // About 20 reports per run, from 5 s to 5 min apart
+  const auto interval = std::min<std::chrono::seconds>(
+      std::max<std::chrono::seconds>(duration / 20, std::chrono::seconds(5)),
+      std::chrono::seconds(300));
+
+  const Resources first = resources();
+  std::vector<OCLutil::Thread> pool(NumQueues);
+  for (unsigned int t = 0; t < NumQueues; ++t) {
+    pool[t].create(work, threads_[t]);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  auto next = start + interval;
+  float firstP99 = 0.0f;
+  float lastP99 = 0.0f;
+  float lastP999 = 0.0f;
+  std::vector<float> samples;
+  while (std::chrono::steady_clock::now() < start + duration) {
+    std::this_thread::sleep_until(next);
+    next += interval;
+
+    samples.clear();
+    for (auto it : threads_) {
+      it->lock.lock();
+      samples.insert(samples.end(), it->latency.begin(), it->latency.end());
+      it->latency.clear();
+      it->lock.unlock();
+    }
+    if (samples.empty()) {
+      continue;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double percent) {
+      return samples[static_cast<size_t>(percent * (samples.size() - 1) / 100.0)];
+    };
+    const Resources res = resources();
+    const double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("  soak %7.0f s: %8zu ops, p50 %8.1f p99 %8.1f p99.9 %9.1f max %10.1f us, "
+           "rss %8.1f MB, fds %5d, maps %6d\n",
+           elapsed, samples.size(), percentile(50), percentile(99), percentile(99.9),
+           samples.back(), res.rssMB, res.fds, res.maps);
+    fflush(stdout);
+    lastP99 = percentile(99);
+    lastP999 = percentile(99.9);
+    if (firstP99 == 0.0f) {
+      firstP99 = lastP99;
+    }
+  }
+  stop_.store(true);
+  for (auto& it : pool) {
+    it.join();
+  }
+
+  unsigned long long ops = 0;
+  for (auto it : threads_) {
+    CHECK_RESULT((it->error != CL_SUCCESS), "Soak workload failed");
+    ops += it->ops;
+  }
+  const Resources last = resources();
+  char buf[256];
+  SNPRINTF(buf, sizeof(buf),
+           " %u min, %u queues, %llu ops, p99 %.1f -> %.1f us, rss %+.1f MB, fds %+d, "
+           "maps %+d, p99.9 (us)", minutes_, NumQueues, ops, firstP99, lastP99,
+           last.rssMB - first.rssMB, last.fds - first.fds, last.maps - first.maps);
+  testDescString = buf;
+  _perfInfo = lastP999;
+}
+
+unsigned int OCLPerfSoak::close(void) {
+  for (auto it : threads_) {
+    if (it->queue != NULL) {
+      _wrapper->clReleaseCommandQueue(it->queue);
+    }
+    if (it->kernel != NULL) {
+      _wrapper->clReleaseKernel(it->kernel);
+    }
+    delete it;
+  }
+  threads_.clear();
+  return OCLTestImp::close();
+}
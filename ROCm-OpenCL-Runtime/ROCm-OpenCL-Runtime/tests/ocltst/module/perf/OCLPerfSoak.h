@@ -0,0 +1,68 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+#ifndef _OCL_PERF_SOAK_H_
+#define _OCL_PERF_SOAK_H_
+
+#include <atomic>
+#include <vector>
+
+#include "OCL/Thread.h"
+#include "OCLTestImp.h"
+
+//! Mixed workload of launches, copies, allocations and events on several queues for
+//! OCL_SOAK_MINUTES (1 by default). Every report interval prints the tail latency and
+//! the process resources, so leaks and a slow degradation show up as a trend.
+class OCLPerfSoak : public OCLTestImp {
+ public:
+  OCLPerfSoak();
+  virtual ~OCLPerfSoak();
+
+ public:
+  virtual void open(unsigned int test, char* units, double& conversion,
+                    unsigned int deviceID);
+  virtual void run(void);
+  virtual unsigned int close(void);
+
+  //! State of a worker thread
+  struct ThreadData {
+    OCLPerfSoak* test;
+    unsigned int index;
+    cl_command_queue queue;
+    cl_kernel kernel;
+    cl_mem src;
+    cl_mem dst;
+    std::vector<char> host;      //!< Pageable memory of the staged transfers
+    OCLutil::Lock lock;          //!< Protects latency
+    std::vector<float> latency;  //!< Op latencies of the current interval in us
+    unsigned long long ops;
+    cl_int error;
+  };
+
+  //! Runs the workload of one queue until stop_
+  static void* work(void* data);
+
+ private:
+  bool failed_;
+  unsigned int minutes_;
+  std::atomic<bool> stop_;
+  std::vector<ThreadData*> threads_;
+};
+
+#endif  // _OCL_PERF_SOAK_H_
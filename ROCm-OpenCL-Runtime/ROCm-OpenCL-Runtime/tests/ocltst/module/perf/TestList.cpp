@@ -39,6 +39,7 @@
 #include "OCLPerfDispatchSpeed.h"
 #include "OCLPerfDoubleDMA.h"
 #include "OCLPerfDoubleDMASeq.h"
+#include "OCLPerfEnqueueContention.h"
 #include "OCLPerfFillBuffer.h"
 #include "OCLPerfFillImage.h"
 #include "OCLPerfFlush.h"
@@ -50,6 +51,7 @@
 #include "OCLPerfImageReadSpeed.h"
 #include "OCLPerfImageSampleRate.h"
 #include "OCLPerfImageWriteSpeed.h"
+#include "OCLPerfKernelArgScaling.h"
 #include "OCLPerfKernelArguments.h"
 #include "OCLPerfLDSLatency.h"
 #include "OCLPerfLDSReadSpeed.h"
@@ -65,6 +67,7 @@
 #include "OCLPerfPinnedBufferReadSpeed.h"
 #include "OCLPerfPinnedBufferWriteSpeed.h"
 #include "OCLPerfPipeCopySpeed.h"
+#include "OCLPerfProgramBuild.h"
 #include "OCLPerfSHA256.h"
 #include "OCLPerfSampleRate.h"
 #include "OCLPerfScalarReplArrayElem.h"
@@ -72,6 +75,7 @@
 #if USE_OPENGL
 #include "OCLPerfSepia.h"
 #endif
+#include "OCLPerfSoak.h"
 #include "OCLPerfTextureMemLatency.h"
 #include "OCLPerfUAVReadSpeed.h"
 #include "OCLPerfUAVReadSpeedHostMem.h"
@@ -188,6 +192,10 @@ TestEntry TestList[] = {
     TEST(OCLPerfDevMemReadSpeed),
     TEST(OCLPerfDevMemWriteSpeed),
     TEST(OCLPerfVerticalFetch),
+    TEST(OCLPerfEnqueueContention),
+    TEST(OCLPerfProgramBuild),
+    TEST(OCLPerfKernelArgScaling),
+    TEST(OCLPerfSoak),
 };
 
 unsigned int TestListCount = sizeof(TestList) / sizeof(TestList[0]);
@@ -17,6 +17,13 @@
 #include <iostream>
 #include <cstring>
 #include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <vector>
 
 #ifdef _MSC_VER
 #include <windows.h>
@@ -4347,6 +4354,354 @@ modified_dispatch = {
     NULL, /* clSetProgramSpecializationConstant */
 };
 
+// The aggregate mode, CL_TRACE_AGGREGATE=1, replaces the formatted trace with the per-API
+// call counts and host times and the per-kernel GPU times. The calls only update the
+// counters of the thread, and the summary is printed at exit.
+
+#define CLTRACE_APIS(X)                                                       \
+    X(GetPlatformIDs) X(GetPlatformInfo) X(GetDeviceIDs) X(GetDeviceInfo)     \
+    X(CreateContext) X(CreateContextFromType) X(RetainContext)                \
+    X(ReleaseContext) X(GetContextInfo) X(CreateCommandQueue)                 \
+    X(RetainCommandQueue) X(ReleaseCommandQueue) X(GetCommandQueueInfo)       \
+    X(SetCommandQueueProperty) X(CreateBuffer) X(CreateImage2D)               \
+    X(CreateImage3D) X(RetainMemObject) X(ReleaseMemObject)                   \
+    X(GetSupportedImageFormats) X(GetMemObjectInfo) X(GetImageInfo)           \
+    X(CreateSampler) X(RetainSampler) X(ReleaseSampler) X(GetSamplerInfo)     \
+    X(CreateProgramWithSource) X(CreateProgramWithBinary) X(RetainProgram)    \
+    X(ReleaseProgram) X(BuildProgram) X(UnloadCompiler) X(GetProgramInfo)     \
+    X(GetProgramBuildInfo) X(CreateKernel) X(CreateKernelsInProgram)          \
+    X(RetainKernel) X(ReleaseKernel) X(SetKernelArg) X(GetKernelInfo)         \
+    X(GetKernelWorkGroupInfo) X(WaitForEvents) X(GetEventInfo)                \
+    X(RetainEvent) X(ReleaseEvent) X(GetEventProfilingInfo) X(Flush)          \
+    X(Finish) X(EnqueueReadBuffer) X(EnqueueWriteBuffer)                      \
+    X(EnqueueCopyBuffer) X(EnqueueReadImage) X(EnqueueWriteImage)             \
+    X(EnqueueCopyImage) X(EnqueueCopyImageToBuffer)                           \
+    X(EnqueueCopyBufferToImage) X(EnqueueMapBuffer) X(EnqueueMapImage)        \
+    X(EnqueueUnmapMemObject) X(EnqueueNDRangeKernel) X(EnqueueTask)           \
+    X(EnqueueNativeKernel) X(EnqueueMarker) X(EnqueueWaitForEvents)           \
+    X(EnqueueBarrier) X(GetExtensionFunctionAddress) X(CreateFromGLBuffer)    \
+    X(CreateFromGLTexture2D) X(CreateFromGLTexture3D)                         \
+    X(CreateFromGLRenderbuffer) X(GetGLObjectInfo) X(GetGLTextureInfo)        \
+    X(EnqueueAcquireGLObjects) X(EnqueueReleaseGLObjects)                     \
+    X(GetGLContextInfoKHR) X(SetEventCallback) X(CreateSubBuffer)             \
+    X(SetMemObjectDestructorCallback) X(CreateUserEvent)                      \
+    X(SetUserEventStatus) X(EnqueueReadBufferRect) X(EnqueueWriteBufferRect)  \
+    X(EnqueueCopyBufferRect) X(RetainDevice) X(ReleaseDevice) X(CreateImage)  \
+    X(CreateProgramWithBuiltInKernels) X(CompileProgram) X(LinkProgram)       \
+    X(UnloadPlatformCompiler) X(GetKernelArgInfo) X(EnqueueFillBuffer)        \
+    X(EnqueueFillImage) X(EnqueueMigrateMemObjects)                           \
+    X(EnqueueMarkerWithWaitList) X(EnqueueBarrierWithWaitList)                \
+    X(GetExtensionFunctionAddressForPlatform) X(CreateFromGLTexture)          \
+    X(CreateCommandQueueWithProperties) X(CreatePipe) X(GetPipeInfo)          \
+    X(SVMAlloc) X(SVMFree) X(EnqueueSVMFree) X(EnqueueSVMMemcpy)              \
+    X(EnqueueSVMMemFill) X(EnqueueSVMMap) X(EnqueueSVMUnmap)                  \
+    X(CreateSamplerWithProperties) X(SetKernelArgSVMPointer)                  \
+    X(SetKernelExecInfo)
+
+enum ApiId {
+#define API_ID(name) API_##name,
+    CLTRACE_APIS(API_ID)
+#undef API_ID
+    API_COUNT
+};
+
+static const char* apiNames[API_COUNT] = {
+#define API_NAME(name) "cl" #name,
+    CLTRACE_APIS(API_NAME)
+#undef API_NAME
+};
+
+// The counters of a thread, written by the thread only
+struct ApiCounters {
+    std::atomic<uint64_t> count[API_COUNT];
+    std::atomic<uint64_t> total[API_COUNT];
+    std::atomic<uint64_t> max[API_COUNT];
+
+    ApiCounters()
+    {
+        for (int i = 0; i < API_COUNT; ++i) {
+            count[i] = 0;
+            total[i] = 0;
+            max[i] = 0;
+        }
+    }
+};
+
+// The counters are never freed, since the summary can run after the thread exit
+static std::mutex countersMtx;
+static std::vector<ApiCounters*> allCounters;
+
+static ApiCounters*
+threadCounters(void)
+{
+    thread_local ApiCounters* counters = NULL;
+    if (counters == NULL) {
+        counters = new ApiCounters();
+        std::lock_guard<std::mutex> lock(countersMtx);
+        allCounters.push_back(counters);
+    }
+    return counters;
+}
+
+static inline uint64_t
+nowNs(void)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Adds the host time of a call to the counters of the thread
+class ApiTimer {
+public:
+    explicit ApiTimer(ApiId id) : id_(id), start_(nowNs()) { }
+
+    ~ApiTimer()
+    {
+        const uint64_t time = nowNs() - start_;
+        ApiCounters* counters = threadCounters();
+        const std::memory_order relaxed = std::memory_order_relaxed;
+        counters->count[id_].store(counters->count[id_].load(relaxed) + 1, relaxed);
+        counters->total[id_].store(counters->total[id_].load(relaxed) + time, relaxed);
+        if (time > counters->max[id_].load(relaxed)) {
+            counters->max[id_].store(time, relaxed);
+        }
+    }
+
+private:
+    ApiId id_;
+    uint64_t start_;
+};
+
+// The timed entry of the dispatch table, calls the original entry
+template <typename F> struct Timed;
+
+template <typename R, typename... Args>
+struct Timed<R (CL_API_CALL*)(Args...)> {
+    template <R (CL_API_CALL* cl_icd_dispatch_table::*Entry)(Args...), ApiId Id>
+    static R CL_API_CALL
+    call(Args... args)
+    {
+        ApiTimer timer(Id);
+        return (original_dispatch.*Entry)(args...);
+    }
+};
+
+struct KernelTime {
+    uint64_t count;
+    uint64_t total;
+    uint64_t max;
+};
+
+static std::mutex kernelsMtx;
+static std::map<std::string, KernelTime> kernelTimes;
+
+// The data of the completion callback of a dispatch
+struct KernelRec {
+    cl_kernel kernel;
+    bool ownEvent;
+};
+
+static void CL_CALLBACK
+kernelComplete(cl_event event, cl_int status, void* data)
+{
+    KernelRec* rec = static_cast<KernelRec*>(data);
+    cl_ulong start = 0;
+    cl_ulong end = 0;
+    size_t size = 0;
+    if (status == CL_COMPLETE
+        && original_dispatch.GetEventProfilingInfo(event, CL_PROFILING_COMMAND_START,
+            sizeof(start), &start, NULL) == CL_SUCCESS
+        && original_dispatch.GetEventProfilingInfo(event, CL_PROFILING_COMMAND_END,
+            sizeof(end), &end, NULL) == CL_SUCCESS
+        && original_dispatch.GetKernelInfo(rec->kernel, CL_KERNEL_FUNCTION_NAME,
+            0, NULL, &size) == CL_SUCCESS) {
+        std::string name(size, '\0');
+        original_dispatch.GetKernelInfo(rec->kernel, CL_KERNEL_FUNCTION_NAME,
+            size, &name[0], NULL);
+        name.resize(strlen(name.c_str()));
+
+        const uint64_t time = (end > start) ? end - start : 0;
+        std::lock_guard<std::mutex> lock(kernelsMtx);
+        KernelTime& kt = kernelTimes[name];
+        ++kt.count;
+        kt.total += time;
+        kt.max = std::max(kt.max, time);
+    }
+    original_dispatch.ReleaseKernel(rec->kernel);
+    if (rec->ownEvent) {
+        original_dispatch.ReleaseEvent(event);
+    }
+    delete rec;
+}
+
+static cl_int CL_API_CALL
+AggregateEnqueueNDRangeKernel(
+    cl_command_queue command_queue,
+    cl_kernel        kernel,
+    cl_uint          work_dim,
+    const size_t *   global_work_offset,
+    const size_t *   global_work_size,
+    const size_t *   local_work_size,
+    cl_uint          num_events_in_wait_list,
+    const cl_event * event_wait_list,
+    cl_event *       event)
+{
+    cl_event ownEvent = NULL;
+    cl_int ret;
+    {
+        ApiTimer timer(API_EnqueueNDRangeKernel);
+        ret = original_dispatch.EnqueueNDRangeKernel(
+            command_queue, kernel, work_dim, global_work_offset, global_work_size,
+            local_work_size, num_events_in_wait_list, event_wait_list,
+            (event != NULL) ? event : &ownEvent);
+    }
+    if (ret != CL_SUCCESS) {
+        return ret;
+    }
+
+    // The GPU time is read on the completion, the kernel must live until then
+    KernelRec* rec = new KernelRec;
+    rec->kernel = kernel;
+    rec->ownEvent = (event == NULL);
+    original_dispatch.RetainKernel(kernel);
+    if (original_dispatch.SetEventCallback((event != NULL) ? *event : ownEvent,
+            CL_COMPLETE, kernelComplete, rec) != CL_SUCCESS) {
+        original_dispatch.ReleaseKernel(kernel);
+        if (ownEvent != NULL) {
+            original_dispatch.ReleaseEvent(ownEvent);
+        }
+        delete rec;
+    }
+    return ret;
+}
+
+// The queues are created with the profiling for the GPU time of the kernels
+static cl_command_queue CL_API_CALL
+AggregateCreateCommandQueue(
+    cl_context                  context,
+    cl_device_id                device,
+    cl_command_queue_properties properties,
+    cl_int *                    errcode_ret)
+{
+    ApiTimer timer(API_CreateCommandQueue);
+    return original_dispatch.CreateCommandQueue(
+        context, device, properties | CL_QUEUE_PROFILING_ENABLE, errcode_ret);
+}
+
+static cl_command_queue CL_API_CALL
+AggregateCreateCommandQueueWithProperties(
+    cl_context                context,
+    cl_device_id              device,
+    const cl_queue_properties* properties,
+    cl_int *                  errcode_ret)
+{
+    ApiTimer timer(API_CreateCommandQueueWithProperties);
+    std::vector<cl_queue_properties> props;
+    bool found = false;
+    for (const cl_queue_properties* p = properties; (p != NULL) && (*p != 0); p += 2) {
+        props.push_back(p[0]);
+        props.push_back((p[0] == CL_QUEUE_PROPERTIES) ? (p[1] | CL_QUEUE_PROFILING_ENABLE) : p[1]);
+        found |= (p[0] == CL_QUEUE_PROPERTIES);
+    }
+    if (!found) {
+        props.push_back(CL_QUEUE_PROPERTIES);
+        props.push_back(CL_QUEUE_PROFILING_ENABLE);
+    }
+    props.push_back(0);
+    return original_dispatch.CreateCommandQueueWithProperties(
+        context, device, &props[0], errcode_ret);
+}
+
+static cl_icd_dispatch_table aggregate_dispatch;
+
+static void
+setAggregateDispatch(void)
+{
+    aggregate_dispatch = original_dispatch;
+#define SET_TIMED(name)                                                       \
+    if (original_dispatch.name != NULL) {                                     \
+        aggregate_dispatch.name =                                             \
+            Timed<decltype(cl_icd_dispatch_table::name)>::                    \
+                template call<&cl_icd_dispatch_table::name, API_##name>;      \
+    }
+    CLTRACE_APIS(SET_TIMED)
+#undef SET_TIMED
+    aggregate_dispatch.EnqueueNDRangeKernel = AggregateEnqueueNDRangeKernel;
+    aggregate_dispatch.CreateCommandQueue = AggregateCreateCommandQueue;
+    if (original_dispatch.CreateCommandQueueWithProperties != NULL) {
+        aggregate_dispatch.CreateCommandQueueWithProperties =
+            AggregateCreateCommandQueueWithProperties;
+    }
+}
+
+static void
+printSummary(void)
+{
+    static bool printed = false;
+    if (printed) {
+        return;
+    }
+    printed = true;
+
+    struct ApiTotal {
+        const char* name;
+        uint64_t count;
+        uint64_t total;
+        uint64_t max;
+    };
+    std::vector<ApiTotal> apis;
+    {
+        std::lock_guard<std::mutex> lock(countersMtx);
+        for (int i = 0; i < API_COUNT; ++i) {
+            ApiTotal at = { apiNames[i], 0, 0, 0 };
+            for (auto counters : allCounters) {
+                at.count += counters->count[i].load(std::memory_order_relaxed);
+                at.total += counters->total[i].load(std::memory_order_relaxed);
+                at.max = std::max(at.max, counters->max[i].load(std::memory_order_relaxed));
+            }
+            if (at.count != 0) {
+                apis.push_back(at);
+            }
+        }
+    }
+    std::sort(apis.begin(), apis.end(),
+        [](const ApiTotal& a, const ApiTotal& b) { return a.total > b.total; });
+
+    std::ostringstream ss;
+    ss << "!!!" << std::endl << "!!! API summary (host time in us)" << std::endl
+        << "!!!" << std::endl;
+    ss << std::left << std::setw(44) << "API" << std::right << std::setw(12) << "calls"
+        << std::setw(14) << "total" << std::setw(12) << "average" << std::setw(12) << "max"
+        << std::endl;
+    ss << std::fixed << std::setprecision(3);
+    for (const auto& at : apis) {
+        ss << std::left << std::setw(44) << at.name << std::right << std::setw(12) << at.count
+            << std::setw(14) << at.total / 1000.0 << std::setw(12)
+            << at.total / 1000.0 / at.count << std::setw(12) << at.max / 1000.0 << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(kernelsMtx);
+    std::vector<std::pair<std::string, KernelTime>> kernels(
+        kernelTimes.begin(), kernelTimes.end());
+    std::sort(kernels.begin(), kernels.end(),
+        [](const std::pair<std::string, KernelTime>& a,
+           const std::pair<std::string, KernelTime>& b) {
+            return a.second.total > b.second.total;
+        });
+    ss << "!!!" << std::endl << "!!! Kernel summary (GPU time in us)" << std::endl
+        << "!!!" << std::endl;
+    ss << std::left << std::setw(44) << "kernel" << std::right << std::setw(12) << "calls"
+        << std::setw(14) << "total" << std::setw(12) << "average" << std::setw(12) << "max"
+        << std::endl;
+    for (const auto& it : kernels) {
+        const KernelTime& kt = it.second;
+        ss << std::left << std::setw(44) << it.first << std::right << std::setw(12) << kt.count
+            << std::setw(14) << kt.total / 1000.0 << std::setw(12)
+            << kt.total / 1000.0 / kt.count << std::setw(12) << kt.max / 1000.0 << std::endl;
+    }
+    std::cerr << ss.str();
+}
+
 static void
 cleanup(void)
 {
@@ -4422,6 +4777,14 @@ vdiAgent_OnLoad(vdi_agent * agent)
     SET_ORIGINAL(SetProgramReleaseCallback);
     SET_ORIGINAL(SetProgramSpecializationConstant);
 
+    const char* aggregateEnv = getenv("CL_TRACE_AGGREGATE");
+    if (aggregateEnv != NULL && atoi(aggregateEnv) != 0) {
+        setAggregateDispatch();
+        std::atexit(printSummary);
+        return agent->SetICDDispatchTable(
+            agent, &aggregate_dispatch, sizeof(aggregate_dispatch));
+    }
+
     err = agent->SetICDDispatchTable(
             agent, &modified_dispatch, sizeof(modified_dispatch));
     if (err != CL_SUCCESS) {
@@ -4436,5 +4799,9 @@ vdiAgent_OnLoad(vdi_agent * agent)
 void CL_CALLBACK
 vdiAgent_OnUnload(vdi_agent * agent)
 {
+    const char* aggregateEnv = getenv("CL_TRACE_AGGREGATE");
+    if (aggregateEnv != NULL && atoi(aggregateEnv) != 0) {
+        printSummary();
+    }
     clTraceLog.close();
 }
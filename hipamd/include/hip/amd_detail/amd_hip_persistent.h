@@ -0,0 +1,166 @@
+/*
+Copyright (c) 2022 - Present Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+/**
+ * @file amd_hip_persistent.h
+ * @brief Persistent kernel work queue.
+ *
+ * hipExtPersistentQueueCreate() launches a resident kernel with a group per CU. The groups
+ * poll a ring of slots in fine-grained host memory. hipExtPersistentQueueEnqueue() writes a
+ * device function and its arguments into the next slot, hence a work item costs a few host
+ * stores and no AQL packet or doorbell.
+ *
+ * The slots follow the protocol of the hostcall packets. The sequence of a slot is the ticket
+ * of the producer when the slot is free, and the ticket plus 1 when the work item is ready.
+ * The group, which owns the ticket, runs the function and frees the slot for the ticket one
+ * lap later. The sequence is 64 bit, so it avoids the ABA problem like the tagged pointers
+ * of the hostcall stacks. Group \p g owns the tickets \p g, \p g + numGroups and so on, and
+ * the device needs no atomics on the host memory.
+ *
+ * The device function is called by all threads of the group. Its address can be read with
+ * hipMemcpyFromSymbol() from a __device__ variable initialized with the function.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HIP_EXT_PERSISTENT_ARGS_SIZE 112
+
+typedef void (*hipExtPersistentFunction_t)(const void* args);
+
+typedef struct hipExtPersistentSlot {
+  uint64_t sequence;  ///< Ticket when free, ticket + 1 when ready
+  uint64_t function;  ///< Device address of a hipExtPersistentFunction_t
+  unsigned char args[HIP_EXT_PERSISTENT_ARGS_SIZE];
+} hipExtPersistentSlot;
+
+typedef struct hipExtPersistentRing {
+  uint32_t numSlots;  ///< Number of slots, power of 2
+  uint32_t stop;      ///< Non-zero when the groups must exit
+  uint64_t reserved[7];
+  hipExtPersistentSlot slots[1];
+} hipExtPersistentRing;
+
+typedef struct ihipPersistentQueue_t* hipExtPersistentQueue_t;
+
+#if defined(__cplusplus) && defined(__HIPCC__)
+/**
+ * @brief Resident kernel of the persistent queue.
+ *
+ * The template makes sure the kernel is in the code object of the application, which has the
+ * device functions. Pass \p hipExtPersistentKernel<> to hipExtPersistentQueueCreate().
+ */
+template <typename T = void>
+__global__ void hipExtPersistentKernel(hipExtPersistentRing* ring) {
+  __shared__ hipExtPersistentSlot* slot;
+  const uint32_t mask = ring->numSlots - 1;
+  for (uint64_t ticket = blockIdx.x; ; ticket += gridDim.x) {
+    if (threadIdx.x == 0 && threadIdx.y == 0 && threadIdx.z == 0) {
+      hipExtPersistentSlot* next = &ring->slots[ticket & mask];
+      while (__hip_atomic_load(&next->sequence, __ATOMIC_ACQUIRE, __HIP_MEMORY_SCOPE_SYSTEM) !=
+             ticket + 1) {
+        if (__hip_atomic_load(&ring->stop, __ATOMIC_RELAXED, __HIP_MEMORY_SCOPE_SYSTEM) != 0) {
+          next = nullptr;
+          break;
+        }
+        __builtin_amdgcn_s_sleep(1);
+      }
+      slot = next;
+    }
+    __syncthreads();
+    hipExtPersistentSlot* current = slot;
+    if (current == nullptr) {
+      return;
+    }
+    reinterpret_cast<hipExtPersistentFunction_t>(current->function)(current->args);
+    __syncthreads();
+    if (threadIdx.x == 0 && threadIdx.y == 0 && threadIdx.z == 0) {
+      __hip_atomic_store(&current->sequence, ticket + mask + 1, __ATOMIC_RELEASE,
+                         __HIP_MEMORY_SCOPE_SYSTEM);
+    }
+  }
+}
+#endif  // defined(__cplusplus) && defined(__HIPCC__)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Launches a persistent kernel and creates its work queue.
+ *
+ * @param [out] queue      Created queue
+ * @param [in]  kernel     Resident kernel, usually hipExtPersistentKernel<>
+ * @param [in]  numGroups  Number of the groups, 0 for a group per CU. All groups must be
+ *                         resident at once, hence it can't exceed the number of CUs.
+ * @param [in]  groupSize  Threads per group
+ * @param [in]  numSlots   Size of the ring, rounded up to a power of 2
+ * @param [in]  stream     Stream of the resident kernel. It's busy until the queue is destroyed.
+ *
+ * @returns hipSuccess, hipErrorInvalidValue, hipErrorOutOfMemory
+ */
+hipError_t hipExtPersistentQueueCreate(hipExtPersistentQueue_t* queue, const void* kernel,
+                                       unsigned int numGroups, unsigned int groupSize,
+                                       unsigned int numSlots, hipStream_t stream);
+
+/**
+ * @brief Enqueues a device function into the ring.
+ *
+ * Lock free and safe from many host threads. It waits only when the ring is full.
+ *
+ * @param [in]  queue     Persistent queue
+ * @param [in]  function  Device address of a hipExtPersistentFunction_t
+ * @param [in]  args      Arguments, copied into the slot
+ * @param [in]  argsSize  Size of the arguments, up to HIP_EXT_PERSISTENT_ARGS_SIZE
+ * @param [out] ticket    Ticket of the work item for hipExtPersistentQueueWait(), optional
+ *
+ * @returns hipSuccess, hipErrorInvalidValue
+ */
+hipError_t hipExtPersistentQueueEnqueue(hipExtPersistentQueue_t queue, const void* function,
+                                        const void* args, size_t argsSize, uint64_t* ticket);
+
+/**
+ * @brief Waits for the work item of \p ticket.
+ *
+ * @returns hipSuccess, hipErrorInvalidValue
+ */
+hipError_t hipExtPersistentQueueWait(hipExtPersistentQueue_t queue, uint64_t ticket);
+
+/**
+ * @brief Waits for all work items of the queue.
+ *
+ * @returns hipSuccess, hipErrorInvalidValue
+ */
+hipError_t hipExtPersistentQueueSynchronize(hipExtPersistentQueue_t queue);
+
+/**
+ * @brief Drains the queue, stops the resident kernel and frees the ring.
+ *
+ * @returns hipSuccess, hipErrorInvalidValue
+ */
+hipError_t hipExtPersistentQueueDestroy(hipExtPersistentQueue_t queue);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
@@ -366,6 +366,23 @@ enum hip_api_id_t {
   HIP_API_ID_hipDestroyTextureObject = HIP_API_ID_NONE,
   HIP_API_ID_hipDeviceGetCount = HIP_API_ID_NONE,
   HIP_API_ID_hipEventRecord_spt = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtGetLatencyStats = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtResetLatencyStats = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtGetKernelCounterSamples = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtSetKernelWaveLimit = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtGetHwQueueStats = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtCaptureTrace = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtMemcpyFromFile = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtMemcpyToFile = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtPersistentQueueCreate = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtPersistentQueueEnqueue = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtPersistentQueueWait = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtPersistentQueueSynchronize = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtPersistentQueueDestroy = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtMemSetTag = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtGetMemoryStats = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtGetMemoryTagStats = HIP_API_ID_NONE,
+  HIP_API_ID_hipExtDumpMemoryStats = HIP_API_ID_NONE,
   HIP_API_ID_hipGetTextureAlignmentOffset = HIP_API_ID_NONE,
   HIP_API_ID_hipGetTextureObjectResourceDesc = HIP_API_ID_NONE,
   HIP_API_ID_hipGetTextureObjectResourceViewDesc = HIP_API_ID_NONE,
@@ -381,6 +398,7 @@ enum hip_api_id_t {
   HIP_API_ID_hipMemcpyArrayToArray = HIP_API_ID_NONE,
   HIP_API_ID_hipMemcpyAsync_spt = HIP_API_ID_NONE,
   HIP_API_ID_hipMemcpyAtoA = HIP_API_ID_NONE,
+  HIP_API_ID_hipMemcpyBatchAsync = HIP_API_ID_NONE,
   HIP_API_ID_hipMemcpyAtoD = HIP_API_ID_NONE,
   HIP_API_ID_hipMemcpyAtoHAsync = HIP_API_ID_NONE,
   HIP_API_ID_hipMemcpyDtoA = HIP_API_ID_NONE,
@@ -9280,4 +9298,607 @@ static inline const char* hipApiString(hip_api_id_t id, const hip_api_data_t* da
   return strdup(oss.str().c_str());
 }
 #endif  // HIP_PROF_HIP_API_STRING
+
+#if HIP_PROF_HIP_API_CAPTURE
+// HIP API capture arguments, the data contents are never captured
+typedef struct hip_api_capture_args_s {
+  const void* stream;
+  const void* event[2];
+  const void* function;
+  const void* ptr;
+  uint32_t host_function;
+  uint32_t kind;
+  size_t size;
+  uint64_t grid;
+  uint64_t block;
+} hip_api_capture_args_t;
+
+// HIP API capture arguments filling helper, called at the API exit
+static inline void hipApiCaptureArgs(hip_api_id_t id, const hip_api_data_t* data,
+                                     hip_api_capture_args_t* out) {
+  memset(out, 0, sizeof(*out));
+  switch (id) {
+    case HIP_API_ID___hipPopCallConfiguration:
+      if (data->args.__hipPopCallConfiguration.stream) out->stream = *(data->args.__hipPopCallConfiguration.stream);
+      break;
+    case HIP_API_ID___hipPushCallConfiguration:
+      out->stream = data->args.__hipPushCallConfiguration.stream;
+      out->grid = (uint64_t)data->args.__hipPushCallConfiguration.gridDim.x * data->args.__hipPushCallConfiguration.gridDim.y * data->args.__hipPushCallConfiguration.gridDim.z;
+      out->block = (uint64_t)data->args.__hipPushCallConfiguration.blockDim.x * data->args.__hipPushCallConfiguration.blockDim.y * data->args.__hipPushCallConfiguration.blockDim.z;
+      break;
+    case HIP_API_ID_hipConfigureCall:
+      out->stream = data->args.hipConfigureCall.stream;
+      out->grid = (uint64_t)data->args.hipConfigureCall.gridDim.x * data->args.hipConfigureCall.gridDim.y * data->args.hipConfigureCall.gridDim.z;
+      out->block = (uint64_t)data->args.hipConfigureCall.blockDim.x * data->args.hipConfigureCall.blockDim.y * data->args.hipConfigureCall.blockDim.z;
+      break;
+    case HIP_API_ID_hipDrvMemcpy3DAsync:
+      out->stream = data->args.hipDrvMemcpy3DAsync.stream;
+      break;
+    case HIP_API_ID_hipEventCreate:
+      if (data->args.hipEventCreate.event) out->event[0] = *(data->args.hipEventCreate.event);
+      break;
+    case HIP_API_ID_hipEventCreateWithFlags:
+      if (data->args.hipEventCreateWithFlags.event) out->event[0] = *(data->args.hipEventCreateWithFlags.event);
+      break;
+    case HIP_API_ID_hipEventDestroy:
+      out->event[0] = data->args.hipEventDestroy.event;
+      break;
+    case HIP_API_ID_hipEventElapsedTime:
+      out->event[0] = data->args.hipEventElapsedTime.start;
+      out->event[1] = data->args.hipEventElapsedTime.stop;
+      break;
+    case HIP_API_ID_hipEventQuery:
+      out->event[0] = data->args.hipEventQuery.event;
+      break;
+    case HIP_API_ID_hipEventRecord:
+      out->event[0] = data->args.hipEventRecord.event;
+      out->stream = data->args.hipEventRecord.stream;
+      break;
+    case HIP_API_ID_hipEventSynchronize:
+      out->event[0] = data->args.hipEventSynchronize.event;
+      break;
+    case HIP_API_ID_hipExtLaunchKernel:
+      out->function = data->args.hipExtLaunchKernel.function_address;
+      out->host_function = 1;
+      out->stream = data->args.hipExtLaunchKernel.stream;
+      out->event[0] = data->args.hipExtLaunchKernel.startEvent;
+      out->event[1] = data->args.hipExtLaunchKernel.stopEvent;
+      out->grid = (uint64_t)data->args.hipExtLaunchKernel.numBlocks.x * data->args.hipExtLaunchKernel.numBlocks.y * data->args.hipExtLaunchKernel.numBlocks.z;
+      out->block = (uint64_t)data->args.hipExtLaunchKernel.dimBlocks.x * data->args.hipExtLaunchKernel.dimBlocks.y * data->args.hipExtLaunchKernel.dimBlocks.z;
+      break;
+    case HIP_API_ID_hipExtMallocWithFlags:
+      if (data->args.hipExtMallocWithFlags.ptr) out->ptr = *(data->args.hipExtMallocWithFlags.ptr);
+      out->size = data->args.hipExtMallocWithFlags.sizeBytes;
+      break;
+    case HIP_API_ID_hipExtModuleLaunchKernel:
+      out->function = data->args.hipExtModuleLaunchKernel.f;
+      out->stream = data->args.hipExtModuleLaunchKernel.hStream;
+      out->event[0] = data->args.hipExtModuleLaunchKernel.startEvent;
+      out->event[1] = data->args.hipExtModuleLaunchKernel.stopEvent;
+      out->grid = (uint64_t)data->args.hipExtModuleLaunchKernel.globalWorkSizeX * data->args.hipExtModuleLaunchKernel.globalWorkSizeY * data->args.hipExtModuleLaunchKernel.globalWorkSizeZ;
+      out->block = (uint64_t)data->args.hipExtModuleLaunchKernel.localWorkSizeX * data->args.hipExtModuleLaunchKernel.localWorkSizeY * data->args.hipExtModuleLaunchKernel.localWorkSizeZ;
+      if (out->block != 0) out->grid /= out->block;
+      break;
+    case HIP_API_ID_hipExtStreamCreateWithCUMask:
+      if (data->args.hipExtStreamCreateWithCUMask.stream) out->stream = *(data->args.hipExtStreamCreateWithCUMask.stream);
+      break;
+    case HIP_API_ID_hipExtStreamGetCUMask:
+      out->stream = data->args.hipExtStreamGetCUMask.stream;
+      break;
+    case HIP_API_ID_hipExternalMemoryGetMappedBuffer:
+      if (data->args.hipExternalMemoryGetMappedBuffer.devPtr) out->ptr = *(data->args.hipExternalMemoryGetMappedBuffer.devPtr);
+      break;
+    case HIP_API_ID_hipFree:
+      out->ptr = data->args.hipFree.ptr;
+      break;
+    case HIP_API_ID_hipFreeAsync:
+      out->ptr = data->args.hipFreeAsync.dev_ptr;
+      out->stream = data->args.hipFreeAsync.stream;
+      break;
+    case HIP_API_ID_hipFreeHost:
+      out->ptr = data->args.hipFreeHost.ptr;
+      break;
+    case HIP_API_ID_hipFuncGetAttribute:
+      out->function = data->args.hipFuncGetAttribute.hfunc;
+      break;
+    case HIP_API_ID_hipFuncGetAttributes:
+      out->function = data->args.hipFuncGetAttributes.func;
+      out->host_function = 1;
+      break;
+    case HIP_API_ID_hipFuncSetAttribute:
+      out->function = data->args.hipFuncSetAttribute.func;
+      out->host_function = 1;
+      break;
+    case HIP_API_ID_hipFuncSetCacheConfig:
+      out->function = data->args.hipFuncSetCacheConfig.func;
+      out->host_function = 1;
+      break;
+    case HIP_API_ID_hipFuncSetSharedMemConfig:
+      out->function = data->args.hipFuncSetSharedMemConfig.func;
+      out->host_function = 1;
+      break;
+    case HIP_API_ID_hipGetSymbolAddress:
+      if (data->args.hipGetSymbolAddress.devPtr) out->ptr = *(data->args.hipGetSymbolAddress.devPtr);
+      break;
+    case HIP_API_ID_hipGraphAddEventRecordNode:
+      out->event[0] = data->args.hipGraphAddEventRecordNode.event;
+      break;
+    case HIP_API_ID_hipGraphAddEventWaitNode:
+      out->event[0] = data->args.hipGraphAddEventWaitNode.event;
+      break;
+    case HIP_API_ID_hipGraphAddMemcpyNode1D:
+      out->kind = data->args.hipGraphAddMemcpyNode1D.kind;
+      out->size = data->args.hipGraphAddMemcpyNode1D.count;
+      break;
+    case HIP_API_ID_hipGraphAddMemcpyNodeFromSymbol:
+      out->kind = data->args.hipGraphAddMemcpyNodeFromSymbol.kind;
+      out->size = data->args.hipGraphAddMemcpyNodeFromSymbol.count;
+      break;
+    case HIP_API_ID_hipGraphAddMemcpyNodeToSymbol:
+      out->kind = data->args.hipGraphAddMemcpyNodeToSymbol.kind;
+      out->size = data->args.hipGraphAddMemcpyNodeToSymbol.count;
+      break;
+    case HIP_API_ID_hipGraphEventRecordNodeGetEvent:
+      if (data->args.hipGraphEventRecordNodeGetEvent.event_out) out->event[0] = *(data->args.hipGraphEventRecordNodeGetEvent.event_out);
+      break;
+    case HIP_API_ID_hipGraphEventRecordNodeSetEvent:
+      out->event[0] = data->args.hipGraphEventRecordNodeSetEvent.event;
+      break;
+    case HIP_API_ID_hipGraphEventWaitNodeGetEvent:
+      if (data->args.hipGraphEventWaitNodeGetEvent.event_out) out->event[0] = *(data->args.hipGraphEventWaitNodeGetEvent.event_out);
+      break;
+    case HIP_API_ID_hipGraphEventWaitNodeSetEvent:
+      out->event[0] = data->args.hipGraphEventWaitNodeSetEvent.event;
+      break;
+    case HIP_API_ID_hipGraphExecEventRecordNodeSetEvent:
+      out->event[0] = data->args.hipGraphExecEventRecordNodeSetEvent.event;
+      break;
+    case HIP_API_ID_hipGraphExecEventWaitNodeSetEvent:
+      out->event[0] = data->args.hipGraphExecEventWaitNodeSetEvent.event;
+      break;
+    case HIP_API_ID_hipGraphExecMemcpyNodeSetParams1D:
+      out->kind = data->args.hipGraphExecMemcpyNodeSetParams1D.kind;
+      out->size = data->args.hipGraphExecMemcpyNodeSetParams1D.count;
+      break;
+    case HIP_API_ID_hipGraphExecMemcpyNodeSetParamsFromSymbol:
+      out->kind = data->args.hipGraphExecMemcpyNodeSetParamsFromSymbol.kind;
+      out->size = data->args.hipGraphExecMemcpyNodeSetParamsFromSymbol.count;
+      break;
+    case HIP_API_ID_hipGraphExecMemcpyNodeSetParamsToSymbol:
+      out->kind = data->args.hipGraphExecMemcpyNodeSetParamsToSymbol.kind;
+      out->size = data->args.hipGraphExecMemcpyNodeSetParamsToSymbol.count;
+      break;
+    case HIP_API_ID_hipGraphLaunch:
+      out->stream = data->args.hipGraphLaunch.stream;
+      break;
+    case HIP_API_ID_hipGraphMemcpyNodeSetParams1D:
+      out->kind = data->args.hipGraphMemcpyNodeSetParams1D.kind;
+      out->size = data->args.hipGraphMemcpyNodeSetParams1D.count;
+      break;
+    case HIP_API_ID_hipGraphMemcpyNodeSetParamsFromSymbol:
+      out->kind = data->args.hipGraphMemcpyNodeSetParamsFromSymbol.kind;
+      out->size = data->args.hipGraphMemcpyNodeSetParamsFromSymbol.count;
+      break;
+    case HIP_API_ID_hipGraphMemcpyNodeSetParamsToSymbol:
+      out->kind = data->args.hipGraphMemcpyNodeSetParamsToSymbol.kind;
+      out->size = data->args.hipGraphMemcpyNodeSetParamsToSymbol.count;
+      break;
+    case HIP_API_ID_hipGraphUpload:
+      out->stream = data->args.hipGraphUpload.stream;
+      break;
+    case HIP_API_ID_hipGraphicsMapResources:
+      out->stream = data->args.hipGraphicsMapResources.stream;
+      break;
+    case HIP_API_ID_hipGraphicsResourceGetMappedPointer:
+      if (data->args.hipGraphicsResourceGetMappedPointer.devPtr) out->ptr = *(data->args.hipGraphicsResourceGetMappedPointer.devPtr);
+      break;
+    case HIP_API_ID_hipGraphicsUnmapResources:
+      out->stream = data->args.hipGraphicsUnmapResources.stream;
+      break;
+    case HIP_API_ID_hipHccModuleLaunchKernel:
+      out->function = data->args.hipHccModuleLaunchKernel.f;
+      out->stream = data->args.hipHccModuleLaunchKernel.hStream;
+      out->event[0] = data->args.hipHccModuleLaunchKernel.startEvent;
+      out->event[1] = data->args.hipHccModuleLaunchKernel.stopEvent;
+      break;
+    case HIP_API_ID_hipHostAlloc:
+      if (data->args.hipHostAlloc.ptr) out->ptr = *(data->args.hipHostAlloc.ptr);
+      out->size = data->args.hipHostAlloc.size;
+      break;
+    case HIP_API_ID_hipHostFree:
+      out->ptr = data->args.hipHostFree.ptr;
+      break;
+    case HIP_API_ID_hipHostGetDevicePointer:
+      if (data->args.hipHostGetDevicePointer.devPtr) out->ptr = *(data->args.hipHostGetDevicePointer.devPtr);
+      break;
+    case HIP_API_ID_hipHostMalloc:
+      if (data->args.hipHostMalloc.ptr) out->ptr = *(data->args.hipHostMalloc.ptr);
+      out->size = data->args.hipHostMalloc.size;
+      break;
+    case HIP_API_ID_hipHostRegister:
+      out->size = data->args.hipHostRegister.sizeBytes;
+      break;
+    case HIP_API_ID_hipIpcCloseMemHandle:
+      out->ptr = data->args.hipIpcCloseMemHandle.devPtr;
+      break;
+    case HIP_API_ID_hipIpcGetEventHandle:
+      out->event[0] = data->args.hipIpcGetEventHandle.event;
+      break;
+    case HIP_API_ID_hipIpcGetMemHandle:
+      out->ptr = data->args.hipIpcGetMemHandle.devPtr;
+      break;
+    case HIP_API_ID_hipIpcOpenEventHandle:
+      if (data->args.hipIpcOpenEventHandle.event) out->event[0] = *(data->args.hipIpcOpenEventHandle.event);
+      break;
+    case HIP_API_ID_hipIpcOpenMemHandle:
+      if (data->args.hipIpcOpenMemHandle.devPtr) out->ptr = *(data->args.hipIpcOpenMemHandle.devPtr);
+      break;
+    case HIP_API_ID_hipLaunchByPtr:
+      out->function = data->args.hipLaunchByPtr.hostFunction;
+      out->host_function = 1;
+      break;
+    case HIP_API_ID_hipLaunchCooperativeKernel:
+      out->function = data->args.hipLaunchCooperativeKernel.f;
+      out->host_function = 1;
+      out->stream = data->args.hipLaunchCooperativeKernel.stream;
+      out->grid = (uint64_t)data->args.hipLaunchCooperativeKernel.gridDim.x * data->args.hipLaunchCooperativeKernel.gridDim.y * data->args.hipLaunchCooperativeKernel.gridDim.z;
+      out->block = (uint64_t)data->args.hipLaunchCooperativeKernel.blockDimX.x * data->args.hipLaunchCooperativeKernel.blockDimX.y * data->args.hipLaunchCooperativeKernel.blockDimX.z;
+      break;
+    case HIP_API_ID_hipLaunchHostFunc:
+      out->stream = data->args.hipLaunchHostFunc.stream;
+      break;
+    case HIP_API_ID_hipLaunchKernel:
+      out->function = data->args.hipLaunchKernel.function_address;
+      out->host_function = 1;
+      out->stream = data->args.hipLaunchKernel.stream;
+      out->grid = (uint64_t)data->args.hipLaunchKernel.numBlocks.x * data->args.hipLaunchKernel.numBlocks.y * data->args.hipLaunchKernel.numBlocks.z;
+      out->block = (uint64_t)data->args.hipLaunchKernel.dimBlocks.x * data->args.hipLaunchKernel.dimBlocks.y * data->args.hipLaunchKernel.dimBlocks.z;
+      break;
+    case HIP_API_ID_hipMalloc:
+      if (data->args.hipMalloc.ptr) out->ptr = *(data->args.hipMalloc.ptr);
+      out->size = data->args.hipMalloc.size;
+      break;
+    case HIP_API_ID_hipMallocArray:
+      out->size = data->args.hipMallocArray.width * data->args.hipMallocArray.height;
+      break;
+    case HIP_API_ID_hipMallocAsync:
+      if (data->args.hipMallocAsync.dev_ptr) out->ptr = *(data->args.hipMallocAsync.dev_ptr);
+      out->stream = data->args.hipMallocAsync.stream;
+      out->size = data->args.hipMallocAsync.size;
+      break;
+    case HIP_API_ID_hipMallocFromPoolAsync:
+      if (data->args.hipMallocFromPoolAsync.dev_ptr) out->ptr = *(data->args.hipMallocFromPoolAsync.dev_ptr);
+      out->stream = data->args.hipMallocFromPoolAsync.stream;
+      out->size = data->args.hipMallocFromPoolAsync.size;
+      break;
+    case HIP_API_ID_hipMallocHost:
+      if (data->args.hipMallocHost.ptr) out->ptr = *(data->args.hipMallocHost.ptr);
+      out->size = data->args.hipMallocHost.size;
+      break;
+    case HIP_API_ID_hipMallocManaged:
+      if (data->args.hipMallocManaged.dev_ptr) out->ptr = *(data->args.hipMallocManaged.dev_ptr);
+      out->size = data->args.hipMallocManaged.size;
+      break;
+    case HIP_API_ID_hipMallocPitch:
+      if (data->args.hipMallocPitch.ptr) out->ptr = *(data->args.hipMallocPitch.ptr);
+      out->size = data->args.hipMallocPitch.width * data->args.hipMallocPitch.height;
+      break;
+    case HIP_API_ID_hipMemAddressFree:
+      out->ptr = data->args.hipMemAddressFree.devPtr;
+      out->size = data->args.hipMemAddressFree.size;
+      break;
+    case HIP_API_ID_hipMemAddressReserve:
+      if (data->args.hipMemAddressReserve.ptr) out->ptr = *(data->args.hipMemAddressReserve.ptr);
+      out->size = data->args.hipMemAddressReserve.size;
+      break;
+    case HIP_API_ID_hipMemAdvise:
+      out->size = data->args.hipMemAdvise.count;
+      break;
+    case HIP_API_ID_hipMemAllocHost:
+      if (data->args.hipMemAllocHost.ptr) out->ptr = *(data->args.hipMemAllocHost.ptr);
+      out->size = data->args.hipMemAllocHost.size;
+      break;
+    case HIP_API_ID_hipMemCreate:
+      out->size = data->args.hipMemCreate.size;
+      break;
+    case HIP_API_ID_hipMemGetAccess:
+      out->ptr = data->args.hipMemGetAccess.ptr;
+      break;
+    case HIP_API_ID_hipMemMap:
+      out->ptr = data->args.hipMemMap.ptr;
+      out->size = data->args.hipMemMap.size;
+      break;
+    case HIP_API_ID_hipMemMapArrayAsync:
+      out->stream = data->args.hipMemMapArrayAsync.stream;
+      break;
+    case HIP_API_ID_hipMemPoolExportPointer:
+      out->ptr = data->args.hipMemPoolExportPointer.dev_ptr;
+      break;
+    case HIP_API_ID_hipMemPoolImportPointer:
+      if (data->args.hipMemPoolImportPointer.dev_ptr) out->ptr = *(data->args.hipMemPoolImportPointer.dev_ptr);
+      break;
+    case HIP_API_ID_hipMemPoolSetAccess:
+      out->size = data->args.hipMemPoolSetAccess.count;
+      break;
+    case HIP_API_ID_hipMemPrefetchAsync:
+      out->stream = data->args.hipMemPrefetchAsync.stream;
+      out->size = data->args.hipMemPrefetchAsync.count;
+      break;
+    case HIP_API_ID_hipMemPtrGetInfo:
+      out->ptr = data->args.hipMemPtrGetInfo.ptr;
+      break;
+    case HIP_API_ID_hipMemRangeGetAttribute:
+      out->size = data->args.hipMemRangeGetAttribute.count;
+      break;
+    case HIP_API_ID_hipMemRangeGetAttributes:
+      out->size = data->args.hipMemRangeGetAttributes.count;
+      break;
+    case HIP_API_ID_hipMemSetAccess:
+      out->ptr = data->args.hipMemSetAccess.ptr;
+      out->size = data->args.hipMemSetAccess.size;
+      break;
+    case HIP_API_ID_hipMemUnmap:
+      out->ptr = data->args.hipMemUnmap.ptr;
+      out->size = data->args.hipMemUnmap.size;
+      break;
+    case HIP_API_ID_hipMemcpy:
+      out->kind = data->args.hipMemcpy.kind;
+      out->size = data->args.hipMemcpy.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpy2D:
+      out->kind = data->args.hipMemcpy2D.kind;
+      out->size = data->args.hipMemcpy2D.width * data->args.hipMemcpy2D.height;
+      break;
+    case HIP_API_ID_hipMemcpy2DAsync:
+      out->kind = data->args.hipMemcpy2DAsync.kind;
+      out->stream = data->args.hipMemcpy2DAsync.stream;
+      out->size = data->args.hipMemcpy2DAsync.width * data->args.hipMemcpy2DAsync.height;
+      break;
+    case HIP_API_ID_hipMemcpy2DFromArray:
+      out->kind = data->args.hipMemcpy2DFromArray.kind;
+      out->size = data->args.hipMemcpy2DFromArray.width * data->args.hipMemcpy2DFromArray.height;
+      break;
+    case HIP_API_ID_hipMemcpy2DFromArrayAsync:
+      out->kind = data->args.hipMemcpy2DFromArrayAsync.kind;
+      out->stream = data->args.hipMemcpy2DFromArrayAsync.stream;
+      out->size = data->args.hipMemcpy2DFromArrayAsync.width * data->args.hipMemcpy2DFromArrayAsync.height;
+      break;
+    case HIP_API_ID_hipMemcpy2DToArray:
+      out->kind = data->args.hipMemcpy2DToArray.kind;
+      out->size = data->args.hipMemcpy2DToArray.width * data->args.hipMemcpy2DToArray.height;
+      break;
+    case HIP_API_ID_hipMemcpy2DToArrayAsync:
+      out->kind = data->args.hipMemcpy2DToArrayAsync.kind;
+      out->stream = data->args.hipMemcpy2DToArrayAsync.stream;
+      out->size = data->args.hipMemcpy2DToArrayAsync.width * data->args.hipMemcpy2DToArrayAsync.height;
+      break;
+    case HIP_API_ID_hipMemcpy3DAsync:
+      out->stream = data->args.hipMemcpy3DAsync.stream;
+      break;
+    case HIP_API_ID_hipMemcpyAsync:
+      out->kind = data->args.hipMemcpyAsync.kind;
+      out->stream = data->args.hipMemcpyAsync.stream;
+      out->size = data->args.hipMemcpyAsync.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyAtoH:
+      out->size = data->args.hipMemcpyAtoH.count;
+      break;
+    case HIP_API_ID_hipMemcpyDtoD:
+      out->size = data->args.hipMemcpyDtoD.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyDtoDAsync:
+      out->stream = data->args.hipMemcpyDtoDAsync.stream;
+      out->size = data->args.hipMemcpyDtoDAsync.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyDtoH:
+      out->size = data->args.hipMemcpyDtoH.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyDtoHAsync:
+      out->stream = data->args.hipMemcpyDtoHAsync.stream;
+      out->size = data->args.hipMemcpyDtoHAsync.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyFromArray:
+      out->kind = data->args.hipMemcpyFromArray.kind;
+      out->size = data->args.hipMemcpyFromArray.count;
+      break;
+    case HIP_API_ID_hipMemcpyFromSymbol:
+      out->kind = data->args.hipMemcpyFromSymbol.kind;
+      out->size = data->args.hipMemcpyFromSymbol.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyFromSymbolAsync:
+      out->kind = data->args.hipMemcpyFromSymbolAsync.kind;
+      out->stream = data->args.hipMemcpyFromSymbolAsync.stream;
+      out->size = data->args.hipMemcpyFromSymbolAsync.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyHtoA:
+      out->size = data->args.hipMemcpyHtoA.count;
+      break;
+    case HIP_API_ID_hipMemcpyHtoD:
+      out->size = data->args.hipMemcpyHtoD.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyHtoDAsync:
+      out->stream = data->args.hipMemcpyHtoDAsync.stream;
+      out->size = data->args.hipMemcpyHtoDAsync.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyParam2DAsync:
+      out->stream = data->args.hipMemcpyParam2DAsync.stream;
+      break;
+    case HIP_API_ID_hipMemcpyPeer:
+      out->size = data->args.hipMemcpyPeer.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyPeerAsync:
+      out->stream = data->args.hipMemcpyPeerAsync.stream;
+      out->size = data->args.hipMemcpyPeerAsync.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyToArray:
+      out->kind = data->args.hipMemcpyToArray.kind;
+      out->size = data->args.hipMemcpyToArray.count;
+      break;
+    case HIP_API_ID_hipMemcpyToSymbol:
+      out->kind = data->args.hipMemcpyToSymbol.kind;
+      out->size = data->args.hipMemcpyToSymbol.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyToSymbolAsync:
+      out->kind = data->args.hipMemcpyToSymbolAsync.kind;
+      out->stream = data->args.hipMemcpyToSymbolAsync.stream;
+      out->size = data->args.hipMemcpyToSymbolAsync.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemcpyWithStream:
+      out->kind = data->args.hipMemcpyWithStream.kind;
+      out->stream = data->args.hipMemcpyWithStream.stream;
+      out->size = data->args.hipMemcpyWithStream.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemset:
+      out->size = data->args.hipMemset.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemset2D:
+      out->size = data->args.hipMemset2D.width * data->args.hipMemset2D.height;
+      break;
+    case HIP_API_ID_hipMemset2DAsync:
+      out->stream = data->args.hipMemset2DAsync.stream;
+      out->size = data->args.hipMemset2DAsync.width * data->args.hipMemset2DAsync.height;
+      break;
+    case HIP_API_ID_hipMemset3DAsync:
+      out->stream = data->args.hipMemset3DAsync.stream;
+      break;
+    case HIP_API_ID_hipMemsetAsync:
+      out->stream = data->args.hipMemsetAsync.stream;
+      out->size = data->args.hipMemsetAsync.sizeBytes;
+      break;
+    case HIP_API_ID_hipMemsetD16:
+      out->size = data->args.hipMemsetD16.count;
+      break;
+    case HIP_API_ID_hipMemsetD16Async:
+      out->stream = data->args.hipMemsetD16Async.stream;
+      out->size = data->args.hipMemsetD16Async.count;
+      break;
+    case HIP_API_ID_hipMemsetD32:
+      out->size = data->args.hipMemsetD32.count;
+      break;
+    case HIP_API_ID_hipMemsetD32Async:
+      out->stream = data->args.hipMemsetD32Async.stream;
+      out->size = data->args.hipMemsetD32Async.count;
+      break;
+    case HIP_API_ID_hipMemsetD8:
+      out->size = data->args.hipMemsetD8.count;
+      break;
+    case HIP_API_ID_hipMemsetD8Async:
+      out->stream = data->args.hipMemsetD8Async.stream;
+      out->size = data->args.hipMemsetD8Async.count;
+      break;
+    case HIP_API_ID_hipModuleLaunchKernel:
+      out->function = data->args.hipModuleLaunchKernel.f;
+      out->stream = data->args.hipModuleLaunchKernel.stream;
+      out->grid = (uint64_t)data->args.hipModuleLaunchKernel.gridDimX * data->args.hipModuleLaunchKernel.gridDimY * data->args.hipModuleLaunchKernel.gridDimZ;
+      out->block = (uint64_t)data->args.hipModuleLaunchKernel.blockDimX * data->args.hipModuleLaunchKernel.blockDimY * data->args.hipModuleLaunchKernel.blockDimZ;
+      break;
+    case HIP_API_ID_hipModuleOccupancyMaxActiveBlocksPerMultiprocessor:
+      out->function = data->args.hipModuleOccupancyMaxActiveBlocksPerMultiprocessor.f;
+      break;
+    case HIP_API_ID_hipModuleOccupancyMaxActiveBlocksPerMultiprocessorWithFlags:
+      out->function = data->args.hipModuleOccupancyMaxActiveBlocksPerMultiprocessorWithFlags.f;
+      break;
+    case HIP_API_ID_hipModuleOccupancyMaxPotentialBlockSize:
+      out->function = data->args.hipModuleOccupancyMaxPotentialBlockSize.f;
+      break;
+    case HIP_API_ID_hipModuleOccupancyMaxPotentialBlockSizeWithFlags:
+      out->function = data->args.hipModuleOccupancyMaxPotentialBlockSizeWithFlags.f;
+      break;
+    case HIP_API_ID_hipOccupancyMaxActiveBlocksPerMultiprocessor:
+      out->function = data->args.hipOccupancyMaxActiveBlocksPerMultiprocessor.f;
+      out->host_function = 1;
+      break;
+    case HIP_API_ID_hipOccupancyMaxActiveBlocksPerMultiprocessorWithFlags:
+      out->function = data->args.hipOccupancyMaxActiveBlocksPerMultiprocessorWithFlags.f;
+      out->host_function = 1;
+      break;
+    case HIP_API_ID_hipOccupancyMaxPotentialBlockSize:
+      out->function = data->args.hipOccupancyMaxPotentialBlockSize.f;
+      out->host_function = 1;
+      break;
+    case HIP_API_ID_hipSetupArgument:
+      out->size = data->args.hipSetupArgument.size;
+      break;
+    case HIP_API_ID_hipSignalExternalSemaphoresAsync:
+      out->stream = data->args.hipSignalExternalSemaphoresAsync.stream;
+      break;
+    case HIP_API_ID_hipStreamAddCallback:
+      out->stream = data->args.hipStreamAddCallback.stream;
+      break;
+    case HIP_API_ID_hipStreamAttachMemAsync:
+      out->stream = data->args.hipStreamAttachMemAsync.stream;
+      out->ptr = data->args.hipStreamAttachMemAsync.dev_ptr;
+      break;
+    case HIP_API_ID_hipStreamBeginCapture:
+      out->stream = data->args.hipStreamBeginCapture.stream;
+      break;
+    case HIP_API_ID_hipStreamCreate:
+      if (data->args.hipStreamCreate.stream) out->stream = *(data->args.hipStreamCreate.stream);
+      break;
+    case HIP_API_ID_hipStreamCreateWithFlags:
+      if (data->args.hipStreamCreateWithFlags.stream) out->stream = *(data->args.hipStreamCreateWithFlags.stream);
+      break;
+    case HIP_API_ID_hipStreamCreateWithPriority:
+      if (data->args.hipStreamCreateWithPriority.stream) out->stream = *(data->args.hipStreamCreateWithPriority.stream);
+      break;
+    case HIP_API_ID_hipStreamDestroy:
+      out->stream = data->args.hipStreamDestroy.stream;
+      break;
+    case HIP_API_ID_hipStreamEndCapture:
+      out->stream = data->args.hipStreamEndCapture.stream;
+      break;
+    case HIP_API_ID_hipStreamGetCaptureInfo:
+      out->stream = data->args.hipStreamGetCaptureInfo.stream;
+      break;
+    case HIP_API_ID_hipStreamGetCaptureInfo_v2:
+      out->stream = data->args.hipStreamGetCaptureInfo_v2.stream;
+      break;
+    case HIP_API_ID_hipStreamGetFlags:
+      out->stream = data->args.hipStreamGetFlags.stream;
+      break;
+    case HIP_API_ID_hipStreamGetPriority:
+      out->stream = data->args.hipStreamGetPriority.stream;
+      break;
+    case HIP_API_ID_hipStreamIsCapturing:
+      out->stream = data->args.hipStreamIsCapturing.stream;
+      break;
+    case HIP_API_ID_hipStreamQuery:
+      out->stream = data->args.hipStreamQuery.stream;
+      break;
+    case HIP_API_ID_hipStreamSynchronize:
+      out->stream = data->args.hipStreamSynchronize.stream;
+      break;
+    case HIP_API_ID_hipStreamUpdateCaptureDependencies:
+      out->stream = data->args.hipStreamUpdateCaptureDependencies.stream;
+      break;
+    case HIP_API_ID_hipStreamWaitEvent:
+      out->stream = data->args.hipStreamWaitEvent.stream;
+      out->event[0] = data->args.hipStreamWaitEvent.event;
+      break;
+    case HIP_API_ID_hipStreamWaitValue32:
+      out->stream = data->args.hipStreamWaitValue32.stream;
+      out->ptr = data->args.hipStreamWaitValue32.ptr;
+      break;
+    case HIP_API_ID_hipStreamWaitValue64:
+      out->stream = data->args.hipStreamWaitValue64.stream;
+      out->ptr = data->args.hipStreamWaitValue64.ptr;
+      break;
+    case HIP_API_ID_hipStreamWriteValue32:
+      out->stream = data->args.hipStreamWriteValue32.stream;
+      out->ptr = data->args.hipStreamWriteValue32.ptr;
+      break;
+    case HIP_API_ID_hipStreamWriteValue64:
+      out->stream = data->args.hipStreamWriteValue64.stream;
+      out->ptr = data->args.hipStreamWriteValue64.ptr;
+      break;
+    case HIP_API_ID_hipTexRefSetAddress:
+      out->size = data->args.hipTexRefSetAddress.bytes;
+      break;
+    case HIP_API_ID_hipWaitExternalSemaphoresAsync:
+      out->stream = data->args.hipWaitExternalSemaphoresAsync.stream;
+      break;
+    default: break;
+  };
+}
+#endif  // HIP_PROF_HIP_API_CAPTURE
 #endif  // _HIP_PROF_STR_H
@@ -36,13 +36,19 @@
 #include "lf.h"
 #include <locale>
 #include <codecvt>
+#elif defined ATI_OS_LINUX
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <locale>
+#include <codecvt>
 #endif  // WITH_LIQUID_FLASH
 
 namespace amd {
 
 LiquidFlashFile::~LiquidFlashFile() { close(); }
 
-bool LiquidFlashFile::open() {
+bool LiquidFlashFile::open(bool direct) {
 #if WITH_LIQUID_FLASH
   lf_status err;
   lf_file_flags flags = 0;
@@ -80,6 +86,38 @@ bool LiquidFlashFile::open() {
     return false;
   }
   return true;
+#elif defined ATI_OS_LINUX
+  int flags = 0;
+  switch (flags_) {
+    case CL_FILE_READ_ONLY_AMD:
+      flags = O_RDONLY;
+      break;
+    case CL_FILE_WRITE_ONLY_AMD:
+      flags = O_WRONLY | O_CREAT;
+      break;
+    case CL_FILE_READ_WRITE_AMD:
+      flags = O_RDWR | O_CREAT;
+      break;
+  }
+  std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> cv;
+  std::string name_char = cv.to_bytes(name_);
+  // O_DIRECT skips the page cache copy, but some file systems don't support it
+  fd_ = direct ? ::open(name_char.c_str(), flags | O_DIRECT, 0644) : -1;
+  blockSize_ = 4 * Ki;
+  if (fd_ < 0) {
+    fd_ = ::open(name_char.c_str(), flags, 0644);
+    blockSize_ = 1;
+  }
+  if (fd_ < 0) {
+    return false;
+  }
+
+  struct stat info;
+  if (fstat(fd_, &info) != 0) {
+    return false;
+  }
+  fileSize_ = info.st_size;
+  return true;
 #else
   return false;
 #endif  // WITH_LIQUID_FLASH
@@ -91,6 +129,11 @@ void LiquidFlashFile::close() {
     lfReleaseFile((lf_file)handle_);
     handle_ = NULL;
   }
+#elif defined ATI_OS_LINUX
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
 #endif  // WITH_LIQUID_FLASH
 }
 
@@ -112,6 +155,19 @@ bool LiquidFlashFile::transferBlock(bool writeBuffer, void* srcDst, uint64_t buf
   } else {
     return false;
   }
+#elif defined ATI_OS_LINUX
+  char* data = reinterpret_cast<char*>(srcDst) + bufferOffset;
+  while (size > 0) {
+    ssize_t done = writeBuffer ? pread(fd_, data, size, fileOffset)
+                               : pwrite(fd_, data, size, fileOffset);
+    if (done <= 0) {
+      return false;
+    }
+    data += done;
+    fileOffset += done;
+    size -= done;
+  }
+  return true;
 #else
   return false;
 #endif  // WITH_LIQUID_FLASH
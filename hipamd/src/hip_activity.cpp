@@ -26,6 +26,11 @@ extern "C" void hipInitActivityCallback(void* id_callback, void* op_callback, vo
                                       arg);
 }
 
+extern "C" void hipInitActivityBatchCallback(void* batch_callback) {
+  activity_prof::CallbacksTable::SetBatchCallback(
+      reinterpret_cast<activity_prof::batch_callback_fun_t>(batch_callback));
+}
+
 extern "C" bool hipEnableActivityCallback(unsigned op, bool enable) {
   return activity_prof::CallbacksTable::SetEnabled(op, enable);
 }
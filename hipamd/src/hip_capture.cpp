@@ -0,0 +1,161 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+// The capture helper of the generated header is compiled only here
+#define HIP_PROF_HIP_API_CAPTURE 1
+
+#include "hip/hip_runtime.h"
+#include "hip_internal.hpp"
+
+#if USE_PROF_API
+#include "hip_capture.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace hip {
+
+std::atomic<bool> ApiCapture::enabled_{false};
+
+namespace {
+
+std::mutex captureLock;                        //!< Protects the file and the kernel names
+FILE* captureFile = nullptr;
+std::unordered_set<const void*> captureNames;  //!< The kernels already in the file
+std::atomic<uint32_t> captureThreads{0};
+
+//! Per thread state of the capture
+struct CaptureThread {
+  hip_api_data_t data_;  //!< Args of the API in the capture
+  bool active_ = false;  //!< The thread is in a captured API
+  uint32_t tid_;         //!< Sequential id of the thread in the capture
+  CaptureThread() : tid_(captureThreads++) {}
+};
+
+thread_local CaptureThread captureThread;
+
+// ================================================================================================
+template <typename T> void captureOut(const T& value) {
+  fwrite(&value, sizeof(value), 1, captureFile);
+}
+
+}  // namespace
+
+// ================================================================================================
+bool ApiCapture::open(const char* fileName) {
+  std::lock_guard<std::mutex> lock(captureLock);
+  if (captureFile != nullptr) {
+    return true;
+  }
+  captureFile = fopen(fileName, "wb");
+  if (captureFile == nullptr) {
+    LogPrintfError("Cannot open the capture file %s", fileName);
+    return false;
+  }
+  fwrite(kApiCaptureMagic, 1, sizeof(kApiCaptureMagic), captureFile);
+  captureOut(kApiCaptureVersion);
+  captureOut(static_cast<uint32_t>(getpid()));
+  // The application may never tear down HIP, so close the file at the process exit
+  atexit(close);
+  enabled_ = true;
+  return true;
+}
+
+// ================================================================================================
+void ApiCapture::close() {
+  enabled_ = false;
+  std::lock_guard<std::mutex> lock(captureLock);
+  if (captureFile != nullptr) {
+    fclose(captureFile);
+    captureFile = nullptr;
+  }
+}
+
+// ================================================================================================
+uint64_t ApiCapture::begin(hip_api_data_t** data) {
+  CaptureThread& thread = captureThread;
+  if (thread.active_) {
+    return 0;
+  }
+  thread.active_ = true;
+  *data = &thread.data_;
+  return amd::Os::timeNanos();
+}
+
+// ================================================================================================
+void ApiCapture::end(uint32_t id, const hip_api_data_t* data, uint64_t start) {
+  CaptureThread& thread = captureThread;
+  ApiCaptureRecord record = {};
+  record.start_ = start;
+  record.duration_ = amd::Os::timeNanos() - start;
+  record.api_ = id;
+  record.tid_ = thread.tid_;
+  record.result_ = g_lastError;
+
+  hip_api_capture_args_t args;
+  hipApiCaptureArgs(static_cast<hip_api_id_t>(id), data, &args);
+  record.stream_ = reinterpret_cast<uint64_t>(args.stream);
+  record.event_[0] = reinterpret_cast<uint64_t>(args.event[0]);
+  record.event_[1] = reinterpret_cast<uint64_t>(args.event[1]);
+  record.ptr_ = reinterpret_cast<uint64_t>(args.ptr);
+  record.size_ = args.size;
+  record.grid_ = args.grid;
+  record.block_ = args.block;
+  record.kind_ = args.kind;
+
+  // The name lookup needs a valid function, so skip the failed calls
+  const char* name = nullptr;
+  if ((args.function != nullptr) && (record.result_ == hipSuccess)) {
+    record.function_ = reinterpret_cast<uint64_t>(args.function);
+    name = args.host_function
+        ? hipKernelNameRefByPtr(args.function, reinterpret_cast<hipStream_t>(
+              const_cast<void*>(args.stream)))
+        : hipKernelNameRef(reinterpret_cast<hipFunction_t>(const_cast<void*>(args.function)));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(captureLock);
+    if (captureFile != nullptr) {
+      if ((name != nullptr) && captureNames.insert(args.function).second) {
+        const uint32_t size = static_cast<uint32_t>(strlen(name));
+        captureOut('K');
+        captureOut(record.function_);
+        captureOut(size);
+        fwrite(name, 1, size, captureFile);
+      }
+      captureOut('C');
+      captureOut(record);
+    }
+  }
+  thread.active_ = false;
+}
+
+}  // namespace hip
+
+#endif  // USE_PROF_API
@@ -0,0 +1,85 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef HIP_SRC_HIP_CAPTURE_HPP
+#define HIP_SRC_HIP_CAPTURE_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace hip {
+
+/*! \brief Record of a captured HIP API call
+ *
+ *  The capture file starts with the "HIPCAPTR" magic, the version and the pid as 32 bit
+ *  values. Then every entry is a tag byte, followed by:
+ *   - 'K': the function as 64 bit key, the 32 bit length and the kernel name
+ *   - 'C': ApiCaptureRecord
+ *  The data contents are never captured, only the call pattern.
+ */
+struct ApiCaptureRecord {
+  uint64_t start_;     //!< Time in ns at the API entry
+  uint64_t duration_;  //!< Time in ns from the entry to the exit
+  uint64_t stream_;    //!< Stream identity, 0 for the null stream
+  uint64_t event_[2];  //!< Event identities
+  uint64_t function_;  //!< Key of the kernel name
+  uint64_t ptr_;       //!< Allocation identity of the allocs and frees
+  uint64_t size_;      //!< Size of the allocation, copy or fill in bytes or elements
+  uint64_t grid_;      //!< Total blocks of a launch
+  uint64_t block_;     //!< Total threads per block of a launch
+  uint32_t api_;       //!< HIP API id
+  uint32_t tid_;       //!< Sequential id of the thread in the capture
+  uint32_t result_;    //!< Returned error code
+  uint32_t kind_;      //!< hipMemcpyKind of the copies
+};
+
+static constexpr char kApiCaptureMagic[8] = {'H', 'I', 'P', 'C', 'A', 'P', 'T', 'R'};
+static constexpr uint32_t kApiCaptureVersion = 1;
+
+//! Capture of the HIP API calls into HIP_API_CAPTURE_FILE
+class ApiCapture {
+ public:
+  //! Opens the capture file and starts the capture
+  static bool open(const char* fileName);
+
+  //! Stops the capture and closes the file
+  static void close();
+
+  //! Returns true if the capture is on
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  /*! \brief Starts the capture of a call
+   *
+   *  Only the calls from the application are captured, not the HIP APIs called by other
+   *  HIP APIs. Returns the start time and the args storage of the thread in \a data,
+   *  or 0 if the call isn't captured.
+   */
+  static uint64_t begin(hip_api_data_t** data);
+
+  //! Writes the record of the call started at \a start
+  static void end(uint32_t id, const hip_api_data_t* data, uint64_t start);
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+}  // namespace hip
+
+#endif  // HIP_SRC_HIP_CAPTURE_HPP
@@ -408,6 +408,58 @@ hipError_t CodeObject::ExtractCodeObjectFromMemory(
   return extractCodeObjectFromFatBinary(data, device_names, code_objs);
 }
 
+// Code object of the offload bundle, with the offset from the start of the bundle
+struct BundleEntry {
+  std::string triple_target_id_;
+  uint64_t offset_;
+  uint64_t size_;
+};
+
+// The parsed bundle headers, keyed by the header bytes. The fat binaries are usually
+// extracted several times (static registration, module loads for every device), hence
+// the entry IDs and the code object versions are parsed only once per bundle.
+static constexpr size_t kMaxBundleCacheEntries = 1024;
+static amd::Monitor bundleCacheLock_("Guards the offload bundle cache");
+static std::unordered_map<std::string, std::vector<BundleEntry>> bundleCache_;
+
+static std::vector<BundleEntry> parseBundle(const void* data) {
+  const auto obheader = reinterpret_cast<const __ClangOffloadBundleHeader*>(data);
+  const auto* desc = &obheader->desc[0];
+  for (uint64_t i = 0; i < obheader->numOfCodeObjects; ++i) {
+    desc = reinterpret_cast<const __ClangOffloadBundleInfo*>(
+        reinterpret_cast<uintptr_t>(&desc->bundleEntryId[0]) + desc->bundleEntryIdSize);
+  }
+  std::string header(reinterpret_cast<const char*>(data),
+                     reinterpret_cast<uintptr_t>(desc) - reinterpret_cast<uintptr_t>(data));
+
+  amd::ScopedLock lock(bundleCacheLock_);
+  auto it = bundleCache_.find(header);
+  if (it != bundleCache_.end()) {
+    return it->second;
+  }
+
+  std::vector<BundleEntry> entries;
+  desc = &obheader->desc[0];
+  for (uint64_t i = 0; i < obheader->numOfCodeObjects; ++i,
+                desc = reinterpret_cast<const __ClangOffloadBundleInfo*>(
+                    reinterpret_cast<uintptr_t>(&desc->bundleEntryId[0]) +
+                    desc->bundleEntryIdSize)) {
+    const void* image =
+        reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(obheader) + desc->offset);
+    std::string bundleEntryId{desc->bundleEntryId, desc->bundleEntryIdSize};
+
+    unsigned co_version = 0;
+    std::string co_triple_target_id;
+    if (!getTripleTargetID(bundleEntryId, image, co_triple_target_id, co_version)) continue;
+    entries.push_back({co_triple_target_id, desc->offset, desc->size});
+  }
+
+  if (bundleCache_.size() < kMaxBundleCacheEntries) {
+    bundleCache_.emplace(std::move(header), entries);
+  }
+  return entries;
+}
+
 // This will be moved to COMGR eventually
 hipError_t CodeObject::extractCodeObjectFromFatBinary(
     const void* data, const std::vector<std::string>& agent_triple_target_ids,
@@ -423,28 +475,16 @@ hipError_t CodeObject::extractCodeObjectFromFatBinary(
     code_objs.push_back(std::make_pair(nullptr, 0));
   }
 
-  const auto obheader = reinterpret_cast<const __ClangOffloadBundleHeader*>(data);
-  const auto* desc = &obheader->desc[0];
   size_t num_code_objs = code_objs.size();
-  for (uint64_t i = 0; i < obheader->numOfCodeObjects; ++i,
-                desc = reinterpret_cast<const __ClangOffloadBundleInfo*>(
-                    reinterpret_cast<uintptr_t>(&desc->bundleEntryId[0]) +
-                    desc->bundleEntryIdSize)) {
-    const void* image =
-        reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(obheader) + desc->offset);
-    const size_t image_size = desc->size;
-
+  for (const auto& entry : parseBundle(data)) {
     if (num_code_objs == 0) break;
-    std::string bundleEntryId{desc->bundleEntryId, desc->bundleEntryIdSize};
-
-    unsigned co_version = 0;
-    std::string co_triple_target_id;
-    if (!getTripleTargetID(bundleEntryId, image, co_triple_target_id, co_version)) continue;
-
+    const void* image = reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(data) +
+                                                      entry.offset_);
     for (size_t dev = 0; dev < agent_triple_target_ids.size(); ++dev) {
       if (code_objs[dev].first) continue;
-      if (isCodeObjectCompatibleWithDevice(co_triple_target_id, agent_triple_target_ids[dev])) {
-        code_objs[dev] = std::make_pair(image, image_size);
+      if (isCodeObjectCompatibleWithDevice(entry.triple_target_id_,
+                                           agent_triple_target_ids[dev])) {
+        code_objs[dev] = std::make_pair(image, entry.size_);
         --num_code_objs;
       }
     }
@@ -493,7 +533,8 @@ hipError_t DynCO::loadCodeObject(const char* fname, const void* image) {
   // Number of devices = 1 in dynamic code object
   fb_info_ = new FatBinaryInfo(fname, image);
   std::vector<hip::Device*> devices = {g_devices[ihipGetDevice()]};
-  IHIP_RETURN_ONFAIL(fb_info_->ExtractFatBinary(devices));
+  // The application may free the image after the load, hence only a mapped file is shared
+  IHIP_RETURN_ONFAIL(fb_info_->ExtractFatBinary(devices, fname != nullptr));
 
   // No Lazy loading for DynCO
   IHIP_RETURN_ONFAIL(fb_info_->BuildProgram(ihipGetDevice()));
@@ -528,22 +569,23 @@ DynCO::~DynCO() {
   delete fb_info_;
 }
 
-hipError_t DynCO::getDeviceVar(DeviceVar** dvar, std::string var_name) {
+hipError_t DynCO::getDeviceVar(DeviceVar** dvar, std::string_view var_name) {
   amd::ScopedLock lock(dclock_);
 
   CheckDeviceIdMatch();
 
-  auto it = vars_.find(var_name);
-  if (it == vars_.end()) {
-    LogPrintfError("Cannot find the Var: %s ", var_name.c_str());
+  Var* var = vars_index_.find(var_name);
+  if (var == nullptr) {
+    LogPrintfError("Cannot find the Var: %.*s ", static_cast<int>(var_name.size()),
+                   var_name.data());
     return hipErrorNotFound;
   }
 
-  hipError_t err = it->second->getDeviceVar(dvar, device_id_, module());
+  hipError_t err = var->getDeviceVar(dvar, device_id_, module());
   return err;
 }
 
-hipError_t DynCO::getDynFunc(hipFunction_t* hfunc, std::string func_name) {
+hipError_t DynCO::getDynFunc(hipFunction_t* hfunc, std::string_view func_name) {
   amd::ScopedLock lock(dclock_);
 
   CheckDeviceIdMatch();
@@ -552,14 +594,15 @@ hipError_t DynCO::getDynFunc(hipFunction_t* hfunc, std::string func_name) {
     return hipErrorInvalidValue;
   }
 
-  auto it = functions_.find(func_name);
-  if (it == functions_.end()) {
-    LogPrintfError("Cannot find the function: %s ", func_name.c_str());
+  Function* func = functions_index_.find(func_name);
+  if (func == nullptr) {
+    LogPrintfError("Cannot find the function: %.*s ", static_cast<int>(func_name.size()),
+                   func_name.data());
     return hipErrorNotFound;
   }
 
   /* See if this could be solved */
-  return it->second->getDynFunc(hfunc, module());
+  return func->getDynFunc(hfunc, module());
 }
 
 hipError_t DynCO::initDynManagedVars(const std::string& managedVar) {
@@ -635,6 +678,7 @@ hipError_t DynCO::populateDynGlobalVars() {
     vars_.insert(
         std::make_pair(elem, new Var(elem, Var::DeviceVarKind::DVK_Variable, 0, 0, 0, nullptr)));
   }
+  vars_index_.build(vars_);
 
   for (auto& elem : var_names) {
     if (elem.find(managedVarExt) != std::string::npos) {
@@ -662,6 +706,7 @@ hipError_t DynCO::populateDynGlobalFuncs() {
   for (auto& elem : func_names) {
     functions_.insert(std::make_pair(elem, new Function(elem)));
   }
+  functions_index_.build(functions_);
 
   return hipSuccess;
 }
@@ -692,11 +737,20 @@ hipError_t StatCO::digestFatBinary(const void* data, FatBinaryInfo*& programs) {
 
   // Create a new fat binary object and extract the fat binary for all devices.
   programs = new FatBinaryInfo(nullptr, data);
-  IHIP_RETURN_ONFAIL(programs->ExtractFatBinary(g_devices));
+  IHIP_RETURN_ONFAIL(programs->ExtractFatBinary(g_devices, true));
 
   return hipSuccess;
 }
 
+hipError_t StatCO::buildFatBinary(FatBinaryInfo** module) {
+  amd::ScopedLock lock(sclock_);
+
+  if ((module == nullptr) || (*module == nullptr)) {
+    return hipErrorInvalidValue;
+  }
+  return (*module)->BuildProgram(g_devices);
+}
+
 FatBinaryInfo** StatCO::addFatBinary(const void* data, bool initialized) {
   amd::ScopedLock lock(sclock_);
 
@@ -802,6 +856,15 @@ hipError_t StatCO::registerStatGlobalVar(const void* hostVar, Var* var) {
 
 hipError_t StatCO::getStatGlobalVar(const void* hostVar, int deviceId, hipDeviceptr_t* dev_ptr,
                                     size_t* size_ptr) {
+  DeviceVar* dvar = nullptr;
+  IHIP_RETURN_ONFAIL(getStatGlobalVar(hostVar, deviceId, &dvar));
+
+  *dev_ptr = dvar->device_ptr();
+  *size_ptr = dvar->size();
+  return hipSuccess;
+}
+
+hipError_t StatCO::getStatGlobalVar(const void* hostVar, int deviceId, DeviceVar** dvar) {
   amd::ScopedLock lock(sclock_);
 
   const auto it = vars_.find(hostVar);
@@ -809,12 +872,8 @@ hipError_t StatCO::getStatGlobalVar(const void* hostVar, int deviceId, hipDevice
     return hipErrorInvalidSymbol;
   }
 
-  DeviceVar* dvar = nullptr;
-  IHIP_RETURN_ONFAIL(it->second->getStatDeviceVar(&dvar, deviceId));
-
-  *dev_ptr = dvar->device_ptr();
-  *size_ptr = dvar->size();
-  return hipSuccess;
+  // The Var keeps the DeviceVar of each device, hence only the first call builds the program
+  return it->second->getStatDeviceVar(dvar, deviceId);
 }
 
 hipError_t StatCO::registerStatManagedVar(Var* var) {
@@ -25,8 +25,11 @@ THE SOFTWARE.
 
 #include "hip_global.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "hip/hip_runtime.h"
 #include "hip/hip_runtime_api.h"
@@ -39,6 +42,31 @@ class PlatformState;
 
 namespace hip {
 
+//Sorted name index over the keys of a symbol map, so the lookups by name don't allocate.
+//The map nodes are stable, hence the views stay valid until the map changes.
+template <typename T> class SymbolIndex {
+ public:
+  void build(const std::unordered_map<std::string, T*>& symbols) {
+    index_.clear();
+    index_.reserve(symbols.size());
+    for (const auto& it : symbols) {
+      index_.emplace_back(it.first, it.second);
+    }
+    std::sort(index_.begin(), index_.end(),
+              [](const Entry& a, const Entry& b) { return a.first < b.first; });
+  }
+
+  T* find(std::string_view name) const {
+    auto it = std::lower_bound(index_.begin(), index_.end(), name,
+                               [](const Entry& a, std::string_view b) { return a.first < b; });
+    return ((it != index_.end()) && (it->first == name)) ? it->second : nullptr;
+  }
+
+ private:
+  typedef std::pair<std::string_view, T*> Entry;
+  std::vector<Entry> index_;
+};
+
 //Code Object base class
 class CodeObject {
  public:
@@ -89,14 +117,14 @@ public:
   hipModule_t module() const { return fb_info_->Module(ihipGetDevice()); };
 
   //Gets GlobalVar/Functions from a dynamically loaded code object
-  hipError_t getDynFunc(hipFunction_t* hfunc, std::string func_name);
-  hipError_t getDeviceVar(DeviceVar** dvar, std::string var_name);
-
-  hipError_t getManagedVarPointer(std::string name, void** pointer, size_t* size_ptr) const {
-    auto it = vars_.find(name);
-    if (it != vars_.end() && it->second->getVarKind() == Var::DVK_Managed) {
-      *pointer = it->second->getManagedVarPtr();
-      *size_ptr = it->second->getSize();
+  hipError_t getDynFunc(hipFunction_t* hfunc, std::string_view func_name);
+  hipError_t getDeviceVar(DeviceVar** dvar, std::string_view var_name);
+
+  hipError_t getManagedVarPointer(std::string_view name, void** pointer, size_t* size_ptr) const {
+    Var* var = vars_index_.find(name);
+    if (var != nullptr && var->getVarKind() == Var::DVK_Managed) {
+      *pointer = var->getManagedVarPtr();
+      *size_ptr = var->getSize();
     }
     return hipSuccess;
   }
@@ -115,6 +143,10 @@ private:
   std::unordered_map<std::string, Function*> functions_;
   std::unordered_map<std::string, Var*> vars_;
 
+  //Lookup indices of the maps above, built once after the code object load
+  SymbolIndex<Function> functions_index_;
+  SymbolIndex<Var> vars_index_;
+
   //Populate Global Vars/Funcs from an code object(@ module_load)
   hipError_t populateDynGlobalFuncs();
   hipError_t populateDynGlobalVars();
@@ -132,6 +164,7 @@ public:
   FatBinaryInfo** addFatBinary(const void* data, bool initialized);
   hipError_t removeFatBinary(FatBinaryInfo** module);
   hipError_t digestFatBinary(const void* data, FatBinaryInfo*& programs);
+  hipError_t buildFatBinary(FatBinaryInfo** module);
 
   //Register vars/funcs given to use from __hipRegister[Var/Func/ManagedVar]
   hipError_t registerStatFunction(const void* hostFunction, Function* func);
@@ -143,6 +176,7 @@ public:
   hipError_t getStatFuncAttr(hipFuncAttributes* func_attr, const void* hostFunction, int deviceId);
   hipError_t getStatGlobalVar(const void* hostVar, int deviceId, hipDeviceptr_t* dev_ptr,
                               size_t* size_ptr);
+  hipError_t getStatGlobalVar(const void* hostVar, int deviceId, DeviceVar** dvar);
 
   //Managed variable is a defined symbol in code object
   //pointer to the alocated managed memory has to be copied to the address of symbol
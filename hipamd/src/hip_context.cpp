@@ -34,6 +34,16 @@ thread_local std::stack<Device*> g_ctxtStack;
 thread_local hipError_t g_lastError = hipSuccess;
 Device* host_device = nullptr;
 
+// ================================================================================================
+//! HIP_FAST_EXIT handler, the OS reclaims the memory, the signals and the queues
+static void fastExit() {
+  Stream::syncAllStreams();
+#if USE_PROF_API
+  ApiCapture::close();
+#endif
+  amd::Runtime::fastExit();
+}
+
 //init() is only to be called from the HIP_INIT macro only once
 bool init() {
   amd::IS_HIP = true;
@@ -80,6 +90,15 @@ bool init() {
   host_device = new Device(hContext, -1);
 
   PlatformState::instance().init();
+#if USE_PROF_API
+  if (!flagIsDefault(HIP_API_CAPTURE_FILE)) {
+    ApiCapture::open(HIP_API_CAPTURE_FILE);
+  }
+#endif
+  // The handler runs before the module destructors, which are registered earlier
+  if (HIP_FAST_EXIT) {
+    atexit(fastExit);
+  }
   return true;
 }
 
@@ -23,6 +23,8 @@
 #include "hip_internal.hpp"
 #include "hip_mempool_impl.hpp"
 
+extern hipError_t ihipFree(void* ptr);
+
 namespace hip {
 
 // ================================================================================================
@@ -56,6 +58,18 @@ bool Device::Create() {
   }
   // Current is default pool after device creation
   current_mem_pool_ = default_mem_pool_;
+
+  if (HIP_MEM_POOL_RECLAIM_INTERVAL != 0) {
+    reclaim_thread_ = new ReclaimThread();
+    if ((reclaim_thread_ == nullptr) || (reclaim_thread_->state() < amd::Thread::INITIALIZED)) {
+      // The reclaim is optional, pools still trim on synchronization
+      LogWarning("Couldn't create memory pool reclaim thread");
+      delete reclaim_thread_;
+      reclaim_thread_ = nullptr;
+    } else {
+      reclaim_thread_->start(this);
+    }
+  }
   return true;
 }
 
@@ -76,11 +90,11 @@ void Device::RemoveMemoryPool(MemoryPool* pool) {
 }
 
 // ================================================================================================
-bool Device::FreeMemory(amd::Memory* memory, Stream* stream) {
+bool Device::FreeMemory(amd::Memory* memory, Stream* stream, size_t offset) {
   amd::ScopedLock lock(lock_);
   // Search for memory in the entire list of pools
   for (auto& it : mem_pools_) {
-    if (it->FreeMemory(memory, stream)) {
+    if (it->FreeMemory(memory, stream, offset)) {
       return true;
     }
   }
@@ -96,6 +110,311 @@ void Device::ReleaseFreedMemory(Stream* stream) {
   }
 }
 
+// ================================================================================================
+void Device::ReclaimFreedMemory() {
+  amd::ScopedLock lock(lock_);
+  for (auto& it : mem_pools_) {
+    it->ReclaimFreedMemory();
+  }
+}
+
+// ================================================================================================
+void Device::DeferFree(amd::Memory* memory) {
+  DeferredFree entry = {memory, {}, false};
+  Stream::lastQueuedCommands(deviceId_, &entry.commands_);
+  if (entry.commands_.empty()) {
+    // The device has no queued work, hence the memory can't be busy
+    memory->release();
+    return;
+  }
+  amd::ScopedLock lock(deferred_lock_);
+  deferred_frees_.push_back(std::move(entry));
+}
+
+// ================================================================================================
+void Device::ReleaseDeferredFrees(bool wait) {
+  amd::ScopedLock lock(deferred_lock_);
+  for (auto it = deferred_frees_.begin(); it != deferred_frees_.end();) {
+    bool ready = true;
+    for (auto command : it->commands_) {
+      if (wait) {
+        command->awaitCompletion();
+      } else if ((command->status() != CL_COMPLETE) &&
+                 !command->queue()->device().IsHwEventReady(*command)) {
+        if (!it->notified_) {
+          // Make sure the command gets to the device, otherwise the status never changes
+          command->notifyCmdQueue();
+        }
+        ready = false;
+        break;
+      }
+    }
+    if (ready) {
+      for (auto command : it->commands_) {
+        command->release();
+      }
+      it->memory_->release();
+      it = deferred_frees_.erase(it);
+    } else {
+      it->notified_ = true;
+      ++it;
+    }
+  }
+}
+
+// ================================================================================================
+void* Device::AllocPhysicalMemory(size_t size) {
+  amd::ScopedLock lock(vmm_lock_);
+  auto it = vmm_pool_.find(size);
+  if (it == vmm_pool_.end()) {
+    return nullptr;
+  }
+  void* ptr = it->second;
+  vmm_pool_.erase(it);
+  vmm_pool_size_ -= size;
+  return ptr;
+}
+
+// ================================================================================================
+bool Device::CachePhysicalMemory(void* ptr, size_t size) {
+  amd::ScopedLock lock(vmm_lock_);
+  if ((vmm_pool_size_ + size) > (static_cast<size_t>(HIP_VMM_POOL_SIZE) * Mi)) {
+    return false;
+  }
+  vmm_pool_.emplace(size, ptr);
+  vmm_pool_size_ += size;
+  return true;
+}
+
+// ================================================================================================
+bool Device::ReleasePhysicalMemory() {
+  amd::ScopedLock lock(vmm_lock_);
+  if (vmm_pool_.empty()) {
+    return false;
+  }
+  for (const auto& it : vmm_pool_) {
+    ihipFree(it.second);
+  }
+  vmm_pool_.clear();
+  vmm_pool_size_ = 0;
+  return true;
+}
+
+// ================================================================================================
+amd::HostQueue* Device::AcquirePooledQueue(const QueueKey& key) {
+  amd::ScopedLock lock(queue_pool_lock_);
+  auto it = queue_pool_.find(key);
+  if (it == queue_pool_.end()) {
+    return nullptr;
+  }
+  amd::HostQueue* queue = it->second;
+  queue_pool_.erase(it);
+  return queue;
+}
+
+// ================================================================================================
+bool Device::PoolQueue(const QueueKey& key, amd::HostQueue* queue) {
+  {
+    amd::ScopedLock lock(queue_pool_lock_);
+    if (queue_pool_.size() >= HIP_STREAM_POOL_SIZE) {
+      return false;
+    }
+  }
+  // The next stream must start on an idle queue, as hipStreamDestroy would leave it
+  queue->finish();
+  amd::ScopedLock lock(queue_pool_lock_);
+  if (queue_pool_.size() >= HIP_STREAM_POOL_SIZE) {
+    return false;
+  }
+  queue_pool_.emplace(key, queue);
+  return true;
+}
+
+// ================================================================================================
+void Device::ReleasePooledQueues() {
+  std::multimap<QueueKey, amd::HostQueue*> queues;
+  {
+    amd::ScopedLock lock(queue_pool_lock_);
+    queues.swap(queue_pool_);
+  }
+  for (const auto& it : queues) {
+    it.second->release();
+  }
+}
+
+// ================================================================================================
+void* Device::AllocSrd() {
+  amd::ScopedLock lock(srd_lock_);
+  // Recycle the retired slots in the destruction order, until the first busy one
+  while (!srd_retired_.empty()) {
+    auto& entry = srd_retired_.front();
+    bool ready = true;
+    for (auto command : entry.commands_) {
+      if ((command->status() != CL_COMPLETE) &&
+          !command->queue()->device().IsHwEventReady(*command)) {
+        ready = false;
+        break;
+      }
+    }
+    if (!ready) {
+      break;
+    }
+    for (auto command : entry.commands_) {
+      command->release();
+    }
+    srd_free_.push_back(entry.slot_);
+    srd_retired_.pop_front();
+  }
+
+  if (srd_free_.empty()) {
+    void* chunk = nullptr;
+    if ((ihipMalloc(&chunk, kSrdChunkSize, CL_MEM_SVM_FINE_GRAIN_BUFFER) != hipSuccess) ||
+        (chunk == nullptr)) {
+      return nullptr;
+    }
+    srd_chunks_.push_back(chunk);
+    for (size_t offset = kSrdChunkSize; offset > 0; offset -= kSrdSlotSize) {
+      srd_free_.push_back(reinterpret_cast<address>(chunk) + offset - kSrdSlotSize);
+    }
+  }
+  void* slot = srd_free_.back();
+  srd_free_.pop_back();
+  return slot;
+}
+
+// ================================================================================================
+bool Device::FreeSrd(void* ptr) {
+  amd::ScopedLock lock(srd_lock_);
+  auto it = std::find_if(srd_chunks_.begin(), srd_chunks_.end(), [ptr](void* chunk) {
+    return (ptr >= chunk) && (ptr < reinterpret_cast<address>(chunk) + kSrdChunkSize);
+  });
+  if (it == srd_chunks_.end()) {
+    return false;
+  }
+  // The kernels in flight may still read the object, hence the slot waits for them
+  RetiredSrd entry = {ptr, {}};
+  Stream::lastQueuedCommands(deviceId_, &entry.commands_);
+  if (entry.commands_.empty()) {
+    srd_free_.push_back(ptr);
+  } else {
+    srd_retired_.push_back(std::move(entry));
+  }
+  return true;
+}
+
+// ================================================================================================
+void Device::ReleaseSrdHeap() {
+  amd::ScopedLock lock(srd_lock_);
+  for (auto& entry : srd_retired_) {
+    for (auto command : entry.commands_) {
+      command->awaitCompletion();
+      command->release();
+    }
+  }
+  srd_retired_.clear();
+  srd_free_.clear();
+  for (auto chunk : srd_chunks_) {
+    ihipFree(chunk);
+  }
+  srd_chunks_.clear();
+}
+
+// ================================================================================================
+void* Device::AllocStaging(size_t size, size_t* chunk) {
+  constexpr size_t kStagingAlignment = 256;
+  size = amd::alignUp(size, kStagingAlignment);
+  amd::ScopedLock lock(staging_lock_);
+  // A chunk restarts from the beginning, once all copies of it are done
+  auto idle = [](StagingChunk& entry) {
+    if (entry.pending_ != 0) {
+      return false;
+    }
+    for (auto command : entry.commands_) {
+      if ((command->status() != CL_COMPLETE) &&
+          !command->queue()->device().IsHwEventReady(*command)) {
+        return false;
+      }
+    }
+    for (auto command : entry.commands_) {
+      command->release();
+    }
+    entry.commands_.clear();
+    entry.offset_ = 0;
+    return true;
+  };
+
+  StagingChunk* entry = nullptr;
+  if (!staging_chunks_.empty() &&
+      ((staging_chunks_[staging_current_].offset_ + size) <=
+       staging_chunks_[staging_current_].size_)) {
+    entry = &staging_chunks_[staging_current_];
+  }
+  for (size_t i = 0; (entry == nullptr) && (i < staging_chunks_.size()); ++i) {
+    const size_t index = (staging_current_ + i) % staging_chunks_.size();
+    if ((staging_chunks_[index].size_ >= size) && idle(staging_chunks_[index])) {
+      staging_current_ = index;
+      entry = &staging_chunks_[index];
+    }
+  }
+  if (entry == nullptr) {
+    // Grow the ring, while it fits the limit
+    const size_t chunkSize = amd::alignUp(size, kStagingChunkSize);
+    amd::MemoryStats::Scope scope(amd::MemoryStats::Staging);
+    void* ptr = nullptr;
+    if (((staging_size_ + chunkSize) > (static_cast<size_t>(HIP_PAGEABLE_STAGING_SIZE) * Mi)) ||
+        (ihipMalloc(&ptr, chunkSize, CL_MEM_SVM_FINE_GRAIN_BUFFER) != hipSuccess) ||
+        (ptr == nullptr)) {
+      return nullptr;
+    }
+    staging_chunks_.push_back({reinterpret_cast<address>(ptr), chunkSize, 0, 0, {}});
+    staging_size_ += chunkSize;
+    staging_current_ = staging_chunks_.size() - 1;
+    entry = &staging_chunks_.back();
+  }
+  void* ptr = entry->ptr_ + entry->offset_;
+  entry->offset_ += size;
+  ++entry->pending_;
+  *chunk = staging_current_;
+  return ptr;
+}
+
+// ================================================================================================
+void Device::TrackStaging(size_t chunk, amd::Command* command) {
+  amd::ScopedLock lock(staging_lock_);
+  StagingChunk& entry = staging_chunks_[chunk];
+  if (command != nullptr) {
+    command->retain();
+    entry.commands_.push_back(command);
+  }
+  --entry.pending_;
+}
+
+// ================================================================================================
+void Device::ReleaseStaging() {
+  amd::ScopedLock lock(staging_lock_);
+  for (auto& entry : staging_chunks_) {
+    for (auto command : entry.commands_) {
+      command->awaitCompletion();
+      command->release();
+    }
+    ihipFree(entry.ptr_);
+  }
+  staging_chunks_.clear();
+  staging_size_ = 0;
+  staging_current_ = 0;
+}
+
+// ================================================================================================
+void Device::ReclaimLoop() {
+  while (!reclaim_stop_.load(std::memory_order_acquire)) {
+    amd::Os::sleep(HIP_MEM_POOL_RECLAIM_INTERVAL);
+    if (!reclaim_stop_.load(std::memory_order_acquire)) {
+      ReclaimFreedMemory();
+      ReleaseDeferredFrees();
+    }
+  }
+}
+
 // ================================================================================================
 void Device::RemoveStreamFromPools(Stream* stream) {
   amd::ScopedLock lock(lock_);
@@ -107,6 +426,18 @@ void Device::RemoveStreamFromPools(Stream* stream) {
 
 // ================================================================================================
 Device::~Device() {
+  if (reclaim_thread_ != nullptr) {
+    reclaim_stop_.store(true, std::memory_order_release);
+    while (reclaim_thread_->state() < amd::Thread::FINISHED) {
+      amd::Os::yield();
+    }
+    delete reclaim_thread_;
+  }
+  ReleaseDeferredFrees(true);
+  ReleasePhysicalMemory();
+  ReleaseSrdHeap();
+  ReleaseStaging();
+  ReleasePooledQueues();
   if (default_mem_pool_ != nullptr) {
     default_mem_pool_->release();
   }
@@ -115,6 +446,9 @@ Device::~Device() {
 }
 
 void ihipDestroyDevice() {
+  if (amd::Runtime::isFastExit()) {
+    return;
+  }
   for (auto deviceHandle : g_devices) {
     delete deviceHandle;
   }
@@ -401,9 +401,13 @@ hipError_t hipDeviceGetLimit ( size_t* pValue, hipLimit_t limit ) {
 
   switch (limit) {
     case hipLimitMallocHeapSize:
-      hipDeviceProp_t prop;
-      HIP_RETURN_ONFAIL(ihipGetDeviceProperties(&prop, ihipGetDevice()));
-      *pValue = prop.totalGlobalMem;
+      *pValue = hip::getCurrentDevice()->devices()[0]->MallocHeapSize();
+      if (*pValue == 0) {
+        // Without a pre-reserved heap the device malloc can grow up to the device memory
+        hipDeviceProp_t prop;
+        HIP_RETURN_ONFAIL(ihipGetDeviceProperties(&prop, ihipGetDevice()));
+        *pValue = prop.totalGlobalMem;
+      }
       break;
     case hipLimitStackSize:
       *pValue = hip::getCurrentDevice()->devices()[0]->StackSize();
@@ -480,6 +484,12 @@ hipError_t hipDeviceSetLimit ( hipLimit_t limit, size_t value ) {
       HIP_RETURN(hipErrorInvalidValue);
     }
     break;
+  case hipLimitMallocHeapSize :
+    // The heap is reserved on the first device malloc, which must come after the limit
+    if (!hip::getCurrentDevice()->devices()[0]->UpdateMallocHeapSize(value)) {
+      HIP_RETURN(hipErrorInvalidValue);
+    }
+    break;
   default:
     LogPrintfError("UnsupportedLimit = %d is passed", limit);
     HIP_RETURN(hipErrorUnsupportedLimit);
@@ -487,6 +497,213 @@ hipError_t hipDeviceSetLimit ( hipLimit_t limit, size_t value ) {
   HIP_RETURN(hipSuccess);
 }
 
+extern "C" hipError_t hipExtGetLatencyStats(int device, uint32_t stage,
+                                            const double* percentiles, uint64_t* values,
+                                            uint32_t numPercentiles, uint64_t* count,
+                                            uint64_t* totalNs) {
+  HIP_INIT_API(hipExtGetLatencyStats, device, stage, percentiles, values, numPercentiles, count,
+               totalNs);
+
+  if (device < 0 || static_cast<size_t>(device) >= g_devices.size()) {
+    HIP_RETURN(hipErrorInvalidDevice);
+  }
+  if ((stage >= amd::LatencyStats::StageCount) ||
+      ((numPercentiles != 0) && ((percentiles == nullptr) || (values == nullptr)))) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  const amd::LatencyHistogram& histogram = g_devices[device]->devices()[0]->latencyStats()
+      .histogram(static_cast<amd::LatencyStats::Stage>(stage));
+  for (uint32_t i = 0; i < numPercentiles; ++i) {
+    values[i] = histogram.percentile(percentiles[i]);
+  }
+  if (count != nullptr) {
+    *count = histogram.count();
+  }
+  if (totalNs != nullptr) {
+    *totalNs = histogram.total();
+  }
+
+  HIP_RETURN(hipSuccess);
+}
+
+extern "C" hipError_t hipExtGetHwQueueStats(int device, uint32_t queue, uint32_t stat,
+                                            const double* percentiles, uint64_t* values,
+                                            uint32_t numPercentiles, uint64_t* count,
+                                            uint64_t* total, uint64_t* queueId) {
+  HIP_INIT_API(hipExtGetHwQueueStats, device, queue, stat, percentiles, values, numPercentiles,
+               count, total, queueId);
+
+  if (device < 0 || static_cast<size_t>(device) >= g_devices.size()) {
+    HIP_RETURN(hipErrorInvalidDevice);
+  }
+  if ((stat >= amd::Device::HwQueueStatCount) ||
+      ((numPercentiles != 0) && ((percentiles == nullptr) || (values == nullptr)))) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  // The queues are enumerated from 0 until hipErrorNotFound
+  const amd::LatencyHistogram* histogram = g_devices[device]->devices()[0]->hwQueueStats(
+      queue, static_cast<amd::Device::HwQueueStat>(stat), queueId);
+  if (histogram == nullptr) {
+    HIP_RETURN(hipErrorNotFound);
+  }
+  for (uint32_t i = 0; i < numPercentiles; ++i) {
+    values[i] = histogram->percentile(percentiles[i]);
+  }
+  if (count != nullptr) {
+    *count = histogram->count();
+  }
+  if (total != nullptr) {
+    *total = histogram->total();
+  }
+
+  HIP_RETURN(hipSuccess);
+}
+
+extern "C" hipError_t hipExtCaptureTrace(int device, uint32_t dispatches, const char* kernelName,
+                                         const char* fileName) {
+  HIP_INIT_API(hipExtCaptureTrace, device, dispatches, kernelName, fileName);
+
+  if (device < 0 || static_cast<size_t>(device) >= g_devices.size()) {
+    HIP_RETURN(hipErrorInvalidDevice);
+  }
+  if ((dispatches == 0) || (fileName == nullptr)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  // The capture needs the backend support and only one capture can be in progress
+  if (!g_devices[device]->devices()[0]->captureTrace(
+          dispatches, (kernelName != nullptr) ? kernelName : "", fileName)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
+
+  HIP_RETURN(hipSuccess);
+}
+
+extern "C" hipError_t hipExtResetLatencyStats(int device) {
+  HIP_INIT_API(hipExtResetLatencyStats, device);
+
+  if (device < 0 || static_cast<size_t>(device) >= g_devices.size()) {
+    HIP_RETURN(hipErrorInvalidDevice);
+  }
+  g_devices[device]->devices()[0]->latencyStats().reset();
+
+  HIP_RETURN(hipSuccess);
+}
+
+extern "C" hipError_t hipExtMemSetTag(uint64_t tag) {
+  HIP_INIT_API(hipExtMemSetTag, tag);
+
+  // The tag follows the thread, the allocations keep the tag of their creation time
+  amd::MemoryStats::setTag(tag);
+
+  HIP_RETURN(hipSuccess);
+}
+
+extern "C" hipError_t hipExtGetMemoryStats(int device, uint32_t category, int host,
+                                           uint64_t* current, uint64_t* peak, uint64_t* count) {
+  HIP_INIT_API(hipExtGetMemoryStats, device, category, host, current, peak, count);
+
+  if (device < 0 || static_cast<size_t>(device) >= g_devices.size()) {
+    HIP_RETURN(hipErrorInvalidDevice);
+  }
+  if (category >= amd::MemoryStats::CategoryCount) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  const amd::MemoryStats::Usage usage = g_devices[device]->devices()[0]->memoryStats()
+      .usage(static_cast<amd::MemoryStats::Category>(category), host != 0);
+  if (current != nullptr) {
+    *current = usage.current_;
+  }
+  if (peak != nullptr) {
+    *peak = usage.peak_;
+  }
+  if (count != nullptr) {
+    *count = usage.count_;
+  }
+
+  HIP_RETURN(hipSuccess);
+}
+
+extern "C" hipError_t hipExtGetMemoryTagStats(int device, uint64_t* tags, uint64_t* bytes,
+                                              uint32_t* numTags) {
+  HIP_INIT_API(hipExtGetMemoryTagStats, device, tags, bytes, numTags);
+
+  if (device < 0 || static_cast<size_t>(device) >= g_devices.size()) {
+    HIP_RETURN(hipErrorInvalidDevice);
+  }
+  if ((numTags == nullptr) || ((*numTags != 0) && ((tags == nullptr) || (bytes == nullptr)))) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  // The largest tags come first, numTags returns the number of all live tags
+  std::vector<std::pair<uint64_t, uint64_t>> snapshot;
+  g_devices[device]->devices()[0]->memoryStats().tags(&snapshot);
+  for (uint32_t i = 0; i < std::min<size_t>(*numTags, snapshot.size()); ++i) {
+    tags[i] = snapshot[i].first;
+    bytes[i] = snapshot[i].second;
+  }
+  *numTags = static_cast<uint32_t>(snapshot.size());
+
+  HIP_RETURN(hipSuccess);
+}
+
+extern "C" hipError_t hipExtDumpMemoryStats(int device) {
+  HIP_INIT_API(hipExtDumpMemoryStats, device);
+
+  if (device < 0 || static_cast<size_t>(device) >= g_devices.size()) {
+    HIP_RETURN(hipErrorInvalidDevice);
+  }
+  g_devices[device]->devices()[0]->memoryStats().dump();
+
+  HIP_RETURN(hipSuccess);
+}
+
+extern "C" hipError_t hipExtGetKernelCounterSamples(int device, const char* kernelName,
+                                                    uint64_t* values, uint32_t numValues,
+                                                    uint64_t* samples) {
+  HIP_INIT_API(hipExtGetKernelCounterSamples, device, kernelName, values, numValues, samples);
+
+  if (device < 0 || static_cast<size_t>(device) >= g_devices.size()) {
+    HIP_RETURN(hipErrorInvalidDevice);
+  }
+  if ((kernelName == nullptr) || (samples == nullptr) ||
+      ((numValues != 0) && (values == nullptr))) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  std::vector<uint64_t> sums;
+  if (!g_devices[device]->devices()[0]->getCounterSamples(kernelName, &sums, samples)) {
+    *samples = 0;
+    HIP_RETURN(hipErrorNotFound);
+  }
+  // The values are the sums over all samples, in the order of ROC_COUNTER_SAMPLE_EVENTS
+  for (uint32_t i = 0; i < numValues; ++i) {
+    values[i] = (i < sums.size()) ? sums[i] : 0;
+  }
+
+  HIP_RETURN(hipSuccess);
+}
+
+extern "C" hipError_t hipExtSetKernelWaveLimit(int device, const char* kernelName,
+                                               uint32_t wavesPerSimd) {
+  HIP_INIT_API(hipExtSetKernelWaveLimit, device, kernelName, wavesPerSimd);
+
+  if (device < 0 || static_cast<size_t>(device) >= g_devices.size()) {
+    HIP_RETURN(hipErrorInvalidDevice);
+  }
+  if ((kernelName == nullptr) || (wavesPerSimd > GPU_WAVE_LIMIT_MAX_WAVE)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  // The kernels loaded from now on start from the seeded value, 0 runs without the limit
+  device::WaveLimitCache::instance().store(
+      g_devices[device]->devices()[0]->isa().targetId(), kernelName, wavesPerSimd);
+
+  HIP_RETURN(hipSuccess);
+}
+
 hipError_t hipDeviceSetSharedMemConfig ( hipSharedMemConfig config ) {
   HIP_INIT_API(hipDeviceSetSharedMemConfig, config);
 
@@ -504,9 +721,9 @@ hipError_t hipDeviceSynchronize ( void ) {
     HIP_RETURN(hipErrorOutOfMemory);
   }
 
-  queue->finish();
-
-  hip::Stream::syncNonBlockingStreams(hip::getCurrentDevice()->deviceId());
+  // The null stream and the non-blocking streams are finished with a single wait
+  hip::Stream::syncNonBlockingStreams(hip::getCurrentDevice()->deviceId(), queue);
+  hip::getCurrentDevice()->ReleaseDeferredFrees();
 
   HIP_RETURN(hipSuccess);
 }
@@ -575,17 +792,19 @@ hipError_t hipSetDeviceFlags ( unsigned int  flags ) {
     case hipDeviceScheduleAuto:
       // Current behavior is different from the spec, due to MT usage in runtime
       if (hip::host_device->devices().size() >= std::thread::hardware_concurrency()) {
-        device->SetActiveWait(false);
+        device->SetWaitMode(amd::Device::WaitAuto);
         break;
       }
       // Fall through for active wait...
     case hipDeviceScheduleSpin:
+      device->SetWaitMode(amd::Device::WaitSpin);
+      break;
     case hipDeviceScheduleYield:
-      // The both options falls into yield, because MT usage in runtime
-      device->SetActiveWait(true);
+      device->SetWaitMode(amd::Device::WaitYield);
       break;
     case hipDeviceScheduleBlockingSync:
-      device->SetActiveWait(false);
+      // The waits sleep until the completion interrupt, without the active wait first
+      device->SetWaitMode(amd::Device::WaitBlocking);
       break;
     default:
       break;
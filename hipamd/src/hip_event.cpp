@@ -28,6 +28,9 @@
 namespace hip {
 
 bool Event::ready() {
+  if (timestamp_ != nullptr) {
+    return g_devices[deviceId()]->devices()[0]->IsHwTimestampReady(timestamp_);
+  }
   if (event_->status() != CL_COMPLETE) {
     event_->notifyCmdQueue();
   }
@@ -40,6 +43,9 @@ bool Event::ready() {
 }
 
 bool EventDD::ready() {
+  if (timestamp_ != nullptr) {
+    return g_devices[deviceId()]->devices()[0]->IsHwTimestampReady(timestamp_);
+  }
   // Check HW status of the ROCcrl event. Note: not all ROCclr modes support HW status
   bool ready = g_devices[deviceId()]->devices()[0]->IsHwEventReady(*event_);
   // FIXME: Remove status check entirely
@@ -50,14 +56,21 @@ bool EventDD::ready() {
 }
 
 hipError_t Event::query() {
+  if (done_.load(std::memory_order_acquire)) {
+    return hipSuccess;
+  }
   amd::ScopedLock lock(lock_);
 
   // If event is not recorded, event_ is null, hence return hipSuccess
-  if (event_ == nullptr) {
+  if ((event_ == nullptr) && (timestamp_ == nullptr)) {
     return hipSuccess;
   }
 
-  return ready() ? hipSuccess : hipErrorNotReady;
+  if (!ready()) {
+    return hipErrorNotReady;
+  }
+  done_.store(true, std::memory_order_release);
+  return hipSuccess;
 }
 
 hipError_t Event::synchronize() {
@@ -65,6 +78,9 @@ hipError_t Event::synchronize() {
 
   // If event is not recorded, event_ is null, hence return hipSuccess
   if (event_ == nullptr) {
+    if (timestamp_ != nullptr) {
+      g_devices[deviceId()]->devices()[0]->IsHwTimestampReady(timestamp_, true);
+    }
     return hipSuccess;
   }
 
@@ -86,10 +102,16 @@ hipError_t Event::synchronize() {
 }
 
 bool Event::awaitEventCompletion() {
+  if (timestamp_ != nullptr) {
+    return g_devices[deviceId()]->devices()[0]->IsHwTimestampReady(timestamp_, true);
+  }
   return event_->awaitCompletion();
 }
 
 bool EventDD::awaitEventCompletion() {
+  if (timestamp_ != nullptr) {
+    return Event::awaitEventCompletion();
+  }
   return g_devices[deviceId()]->devices()[0]->IsHwEventReady(*event_, true);
 }
 
@@ -97,7 +119,7 @@ hipError_t Event::elapsedTime(Event& eStop, float& ms) {
   amd::ScopedLock startLock(lock_);
   if (this == &eStop) {
     ms = 0.f;
-    if (event_ == nullptr) {
+    if ((event_ == nullptr) && (timestamp_ == nullptr)) {
       return hipErrorInvalidHandle;
     }
 
@@ -113,7 +135,8 @@ hipError_t Event::elapsedTime(Event& eStop, float& ms) {
   }
   amd::ScopedLock stopLock(eStop.lock());
 
-  if (event_ == nullptr || eStop.event() == nullptr) {
+  if (((event_ == nullptr) && (timestamp_ == nullptr)) ||
+      ((eStop.event_ == nullptr) && (eStop.timestamp_ == nullptr))) {
     return hipErrorInvalidHandle;
   }
 
@@ -125,7 +148,7 @@ hipError_t Event::elapsedTime(Event& eStop, float& ms) {
     return hipErrorNotReady;
   }
 
-  if (event_ == eStop.event_ && recorded_ && eStop.isRecorded()) {
+  if (event_ != nullptr && event_ == eStop.event_ && recorded_ && eStop.isRecorded()) {
     // Events are the same, which indicates the stream is empty and likely
     // eventRecord is called on another stream. For such cases insert and measure a
     // marker.
@@ -146,6 +169,11 @@ hipError_t Event::elapsedTime(Event& eStop, float& ms) {
 }
 
 int64_t Event::time() const {
+  if (timestamp_ != nullptr) {
+    uint64_t start = 0, end = 0;
+    g_devices[deviceId()]->devices()[0]->getHwTimestampTime(timestamp_, &start, &end);
+    return static_cast<int64_t>(end);
+  }
   assert(event_ != nullptr);
   if (recorded_) {
     return static_cast<int64_t>(event_->profilingInfo().end_);
@@ -155,6 +183,9 @@ int64_t Event::time() const {
 }
 
 int64_t EventDD::time() const {
+  if (timestamp_ != nullptr) {
+    return Event::time();
+  }
   uint64_t start = 0, end = 0;
   assert(event_ != nullptr);
   g_devices[deviceId()]->devices()[0]->getHwEventTime(*event_, &start, &end);
@@ -173,6 +204,10 @@ hipError_t Event::streamWaitCommand(amd::Command*& command, amd::HostQueue* queu
   amd::Command::EventWaitList eventWaitList;
   if (event_ != nullptr) {
     eventWaitList.push_back(event_);
+  } else if (timestamp_ != nullptr) {
+    // The marker can't track the HW timestamp, hence wait for it on the host. All work
+    // before the timestamp was already submitted, so the wait can't block on this queue
+    g_devices[deviceId()]->devices()[0]->IsHwTimestampReady(timestamp_, true);
   }
   command = new amd::Marker(*queue, kMarkerDisableFlush, eventWaitList);
 
@@ -191,9 +226,20 @@ hipError_t Event::streamWait(hipStream_t stream, uint flags) {
   amd::HostQueue* queue = hip::getQueue(stream);
   // Access to event_ object must be lock protected
   amd::ScopedLock lock(lock_);
+  if (timestamp_ != nullptr) {
+    if ((stream_ == queue) || ready()) {
+      return hipSuccess;
+    }
+    return queue->vdev()->waitHwTimestamp(timestamp_) ? hipSuccess : hipErrorLaunchOutOfResources;
+  }
   if ((event_ == nullptr) || (event_->command().queue() == queue) || ready()) {
     return hipSuccess;
   }
+  // The stream already waited for a later command of the same producer stream
+  if (queue->isWaitImplied(*event_)) {
+    ClPrint(amd::LOG_DEBUG, amd::LOG_CMD, "Stream wait for event %p is implied", event_);
+    return hipSuccess;
+  }
   if (!event_->notifyCmdQueue()) {
     return hipErrorLaunchOutOfResources;
   }
@@ -210,26 +256,37 @@ hipError_t Event::streamWait(hipStream_t stream, uint flags) {
   return hipSuccess;
 }
 
+int32_t Event::releaseScope(uint32_t ext_flags) const {
+  int32_t releaseFlags = ((ext_flags == 0) ? flags : ext_flags) &
+                          (hipEventReleaseToSystem | hipEventReleaseToDevice);
+  if (releaseFlags & hipEventReleaseToDevice) {
+    return amd::Device::kCacheStateAgent;
+  } else if (releaseFlags & hipEventReleaseToSystem) {
+    return amd::Device::kCacheStateSystem;
+  }
+  return amd::Device::kCacheStateIgnore;
+}
+
+void Event::releaseTimestamp() {
+  if (timestamp_ != nullptr) {
+    g_devices[deviceId()]->devices()[0]->ReleaseGlobalSignal(timestamp_);
+    timestamp_ = nullptr;
+  }
+}
+
 hipError_t Event::recordCommand(amd::Command*& command, amd::HostQueue* queue,
                                 uint32_t ext_flags ) {
   if (command == nullptr) {
-    int32_t releaseFlags = ((ext_flags == 0) ? flags : ext_flags) &
-                            (hipEventReleaseToSystem | hipEventReleaseToDevice);
-    if (releaseFlags & hipEventReleaseToDevice) {
-      releaseFlags = amd::Device::kCacheStateAgent;
-    } else if (releaseFlags & hipEventReleaseToSystem) {
-      releaseFlags = amd::Device::kCacheStateSystem;
-    } else {
-      releaseFlags = amd::Device::kCacheStateIgnore;
-    }
     // Always submit a EventMarker.
-    command = new hip::EventMarker(*queue, !kMarkerDisableFlush, true, releaseFlags);
+    command = new hip::EventMarker(*queue, !kMarkerDisableFlush, true, releaseScope(ext_flags));
   }
   return hipSuccess;
 }
 
 hipError_t Event::enqueueRecordCommand(hipStream_t stream, amd::Command* command, bool record) {
   command->enqueue();
+  releaseTimestamp();
+  done_.store(false, std::memory_order_relaxed);
   if (event_ == &command->event()) return hipSuccess;
   if (event_ != nullptr) {
     event_->release();
@@ -252,6 +309,28 @@ hipError_t Event::addMarker(hipStream_t stream, amd::Command* command, bool reco
   return status;
 }
 
+bool Event::recordTimestamp(amd::HostQueue* queue) {
+  // Only direct dispatch submits in the caller thread and keeps the order with the commands
+  if (!HIP_EVENT_FAST_RECORD || !AMD_DIRECT_DISPATCH || (flags & hipEventInterprocess)) {
+    return false;
+  }
+  amd::ScopedLock lock(lock_);
+  void* timestamp = queue->vdev()->recordTimestamp(releaseScope(0));
+  if (timestamp == nullptr) {
+    return false;
+  }
+  if (event_ != nullptr) {
+    event_->release();
+    event_ = nullptr;
+  }
+  releaseTimestamp();
+  timestamp_ = timestamp;
+  stream_ = queue;
+  recorded_ = true;
+  done_.store(false, std::memory_order_relaxed);
+  return true;
+}
+
 }  // namespace hip
 // ================================================================================================
 hipError_t ihipEventCreateWithFlags(hipEvent_t* event, unsigned flags) {
@@ -350,6 +429,9 @@ hipError_t hipEventRecord_common(hipEvent_t event, hipStream_t stream) {
   if (g_devices[e->deviceId()]->devices()[0] != &queue->device()) {
     return hipErrorInvalidHandle;
   }
+  if (e->recordTimestamp(queue)) {
+    return hipSuccess;
+  }
   return e->addMarker(stream, nullptr, true);
 }
 
@@ -51,6 +51,9 @@ typedef struct ihipIpcEventShmem_s {
   uint32_t signal[IPC_SIGNALS_PER_EVENT];
 } ihipIpcEventShmem_t;
 
+//! Waits until the IPC event signal after \a previous_read_index is cleared
+extern void WaitIpcSignal(ihipIpcEventShmem_t* shmem, int previous_read_index);
+
 class EventMarker : public amd::Marker {
  public:
   EventMarker(amd::HostQueue& queue, bool disableFlush, bool markerTs = false,
@@ -74,7 +77,8 @@ class Event {
 
  public:
   Event(unsigned int flags) : flags(flags), lock_("hipEvent_t", true),
-                              event_(nullptr), recorded_(false), stream_(nullptr) {
+                              event_(nullptr), timestamp_(nullptr), recorded_(false),
+                              stream_(nullptr) {
     // No need to init event_ here as addMarker does that
     onCapture_ = false;
     device_id_ = hip::getCurrentDevice()->deviceId();  // Created in current device ctx
@@ -84,6 +88,7 @@ class Event {
     if (event_ != nullptr) {
       event_->release();
     }
+    releaseTimestamp();
   }
   unsigned int flags;
 
@@ -99,14 +104,18 @@ class Event {
                                    uint32_t flags = 0);
   virtual hipError_t enqueueRecordCommand(hipStream_t stream, amd::Command* command, bool record);
   hipError_t addMarker(hipStream_t stream, amd::Command* command, bool record);
+  /// Records a HW timestamp without a marker command, returns false if it isn't available
+  bool recordTimestamp(amd::HostQueue* queue);
 
   void BindCommand(amd::Command& command, bool record) {
     amd::ScopedLock lock(lock_);
     if (event_ != nullptr) {
       event_->release();
     }
+    releaseTimestamp();
     event_ = &command.event();
     recorded_ = record;
+    done_.store(false, std::memory_order_relaxed);
     command.retain();
   }
 
@@ -149,14 +158,23 @@ class Event {
   virtual int64_t time() const;
 
  protected:
+  /// Returns the cache scope for the release of the recorded work
+  int32_t releaseScope(uint32_t ext_flags) const;
+  /// Releases the HW timestamp of the last record without a marker command
+  void releaseTimestamp();
+
   amd::Monitor lock_;
   amd::HostQueue* stream_;
   amd::Event* event_;
+  /// HW timestamp of the last record without a marker command. stream_ is the recording queue
+  void* timestamp_;
   int device_id_;
   //! Flag to indicate hipEventRecord has been called. This is needed except for
   //! hip*ModuleLaunchKernel API which takes start and stop events so no
   //! hipEventRecord is called. Cleanup needed once those APIs are deprecated.
   bool recorded_;
+  /// The last record is complete, hence the queries skip the lock until the next record
+  std::atomic<bool> done_{false};
 };
 
 class EventDD : public Event {
@@ -21,6 +21,7 @@
 #include <hip/hip_runtime.h>
 
 #include "hip_event.hpp"
+#include <limits>
 #if !defined(_MSC_VER)
 #include <unistd.h>
 #else
@@ -92,11 +93,7 @@ hipError_t IPCEvent::synchronize() {
   if (ipc_evt_.ipc_shmem_) {
     int prev_read_idx = ipc_evt_.ipc_shmem_->read_index;
     if (prev_read_idx >= 0) {
-      int offset = (prev_read_idx % IPC_SIGNALS_PER_EVENT);
-      while ((ipc_evt_.ipc_shmem_->read_index < prev_read_idx + IPC_SIGNALS_PER_EVENT) &&
-             (ipc_evt_.ipc_shmem_->signal[offset] != 0)) {
-        amd::Os::sleep(1);
-      }
+      WaitIpcSignal(ipc_evt_.ipc_shmem_, prev_read_idx);
     }
   }
   return hipSuccess;
@@ -124,10 +121,22 @@ hipError_t IPCEvent::enqueueStreamWaitCommand(hipStream_t stream, amd::Command*
 }
 
 hipError_t IPCEvent::streamWait(hipStream_t stream, uint flags) {
-  amd::HostQueue* queue = hip::getQueue(stream);
-
   amd::ScopedLock lock(lock_);
   if(query() != hipSuccess) {
+    if (HIP_IPC_EVENT_GPU_WAIT) {
+      // The device of the recording process clears the signal, when the event is completed.
+      // Wait for it on the device, so the host thread doesn't block until the other process
+      // completes the event. If the slot is reused, then the wait ends on a later record
+      int offset = ipc_evt_.ipc_shmem_->read_index % IPC_SIGNALS_PER_EVENT;
+      hipError_t status = ihipStreamOperation(stream, ROCCLR_COMMAND_STREAM_WAIT_VALUE,
+                                              &(ipc_evt_.ipc_shmem_->signal[offset]), 0,
+                                              std::numeric_limits<uint32_t>::max(),
+                                              hipStreamWaitValueEq, sizeof(uint32_t));
+      if (status == hipSuccess) {
+        return status;
+      }
+    }
+    amd::HostQueue* queue = hip::getQueue(stream);
     amd::Command* command;
     hipError_t status = streamWaitCommand(command, queue);
     if (status != hipSuccess) {
@@ -2,8 +2,27 @@
 
 #include "hip_code_object.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string_view>
+#include <thread>
+#include <tuple>
+
 namespace hip {
 
+namespace {
+// Loaded program of the identical code objects of many fat binaries
+struct SharedProgram {
+  amd::Program* program_;
+  std::vector<const void*> images_;  // Code objects of the users, to verify a hash match
+};
+
+amd::Monitor sharedProgramsLock("Shared programs lock");
+// The key is the hash and the size of the code object and the device
+std::map<std::tuple<size_t, size_t, int>, SharedProgram> sharedPrograms;
+}  // namespace
+
 FatBinaryDeviceInfo::~FatBinaryDeviceInfo() {
   if (program_ != nullptr) {
     program_->unload();
@@ -27,6 +46,11 @@ FatBinaryInfo::FatBinaryInfo(const char* fname, const void* image)
 FatBinaryInfo::~FatBinaryInfo() {
 
   for (auto& fbd: fatbin_dev_info_) {
+    // Only the last user of a shared program runs its fini kernels
+    if ((fbd != nullptr) && (fbd->shared_device_ >= 0) && !ReleaseSharedProgram(fbd)) {
+      fbd->program_->release();
+      fbd->program_ = nullptr;
+    }
     delete fbd;
   }
 
@@ -46,7 +70,8 @@ FatBinaryInfo::~FatBinaryInfo() {
   uri_ = std::string();
 }
 
-hipError_t FatBinaryInfo::ExtractFatBinary(const std::vector<hip::Device*>& devices) {
+hipError_t FatBinaryInfo::ExtractFatBinary(const std::vector<hip::Device*>& devices,
+                                           bool share) {
   hipError_t hip_error = hipSuccess;
   std::vector<std::pair<const void*, size_t>> code_objs;
 
@@ -103,11 +128,17 @@ hipError_t FatBinaryInfo::ExtractFatBinary(const std::vector<hip::Device*>& devi
   }
 
   for (size_t dev_idx = 0; dev_idx < devices.size(); ++dev_idx) {
-    fatbin_dev_info_[devices[dev_idx]->deviceId()]->program_
-       = new amd::Program(*devices[dev_idx]->asContext());
-    if (fatbin_dev_info_[devices[dev_idx]->deviceId()]->program_ == NULL) {
+    FatBinaryDeviceInfo* fbd_info = fatbin_dev_info_[devices[dev_idx]->deviceId()];
+    fbd_info->program_ = new amd::Program(*devices[dev_idx]->asContext());
+    if (fbd_info->program_ == NULL) {
       return hipErrorOutOfMemory;
     }
+    if (share && HIP_SHARE_CODE_OBJECTS) {
+      // Many libraries embed the same code objects, hash them to share the loaded programs
+      fbd_info->hash_ = std::hash<std::string_view>()(std::string_view(
+          reinterpret_cast<const char*>(fbd_info->binary_image_), fbd_info->binary_size_));
+      fbd_info->hash_ += (fbd_info->hash_ == 0) ? 1 : 0;
+    }
   }
 
   return hipSuccess;
@@ -133,14 +164,72 @@ hipError_t FatBinaryInfo::AddDevProgram(const int device_id) {
   return hipSuccess;
 }
 
+bool FatBinaryInfo::AcquireSharedProgram(FatBinaryDeviceInfo* fbd_info, int device_id) {
+  amd::ScopedLock lock(sharedProgramsLock);
+  auto it = sharedPrograms.find(
+      std::make_tuple(fbd_info->hash_, fbd_info->binary_size_, device_id));
+  if ((it == sharedPrograms.end()) ||
+      (memcmp(it->second.images_.front(), fbd_info->binary_image_, fbd_info->binary_size_) != 0)) {
+    return false;
+  }
+  // The program of the extraction has no device programs yet, hence it has nothing to unload
+  fbd_info->program_->release();
+  fbd_info->program_ = it->second.program_;
+  fbd_info->program_->retain();
+  fbd_info->add_dev_prog_ = true;
+  fbd_info->prog_built_ = true;
+  fbd_info->shared_device_ = device_id;
+  it->second.images_.push_back(fbd_info->binary_image_);
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "Sharing the loaded code object of %zu bytes on device %d",
+          fbd_info->binary_size_, device_id);
+  return true;
+}
+
+void FatBinaryInfo::RegisterSharedProgram(FatBinaryDeviceInfo* fbd_info, int device_id) {
+  // A shared program has one copy of the program scope variables, but every fat binary
+  // registers its own variables, hence only the code objects without variables are shared
+  const device::Program* dev_program =
+      fbd_info->program_->getDeviceProgram(*g_devices[device_id]->devices()[0]);
+  std::vector<std::string> var_names;
+  if ((dev_program == nullptr) || dev_program->hasGlobalStores() ||
+      !dev_program->getGlobalVarFromCodeObj(&var_names) || !var_names.empty()) {
+    return;
+  }
+  amd::ScopedLock lock(sharedProgramsLock);
+  auto result = sharedPrograms.emplace(
+      std::make_tuple(fbd_info->hash_, fbd_info->binary_size_, device_id),
+      SharedProgram{fbd_info->program_, {fbd_info->binary_image_}});
+  if (result.second) {
+    fbd_info->shared_device_ = device_id;
+  }
+}
+
+bool FatBinaryInfo::ReleaseSharedProgram(FatBinaryDeviceInfo* fbd_info) {
+  amd::ScopedLock lock(sharedProgramsLock);
+  auto it = sharedPrograms.find(
+      std::make_tuple(fbd_info->hash_, fbd_info->binary_size_, fbd_info->shared_device_));
+  guarantee(it != sharedPrograms.end(), "Missing shared program");
+  auto& images = it->second.images_;
+  images.erase(std::find(images.begin(), images.end(), fbd_info->binary_image_));
+  if (!images.empty()) {
+    return false;
+  }
+  sharedPrograms.erase(it);
+  return true;
+}
+
 hipError_t FatBinaryInfo::BuildProgram(const int device_id) {
 
   // Device Id Check and Add DeviceProgram if not added so far
   DeviceIdCheck(device_id);
+  FatBinaryDeviceInfo* fbd_info = fatbin_dev_info_[device_id];
+  if ((fbd_info->prog_built_ == false) && (fbd_info->hash_ != 0)) {
+    // A shared program is built, the load below waits if its owner still loads it
+    AcquireSharedProgram(fbd_info, device_id);
+  }
   IHIP_RETURN_ONFAIL(AddDevProgram(device_id));
 
   // If Program was already built skip this step and return success
-  FatBinaryDeviceInfo* fbd_info = fatbin_dev_info_[device_id];
   if (fbd_info->prog_built_ == false) {
     if(CL_SUCCESS != fbd_info->program_->build(g_devices[device_id]->devices(),
                                                nullptr, nullptr, nullptr,
@@ -148,6 +237,9 @@ hipError_t FatBinaryInfo::BuildProgram(const int device_id) {
       return hipErrorSharedObjectInitFailed;
     }
     fbd_info->prog_built_ = true;
+    if (fbd_info->hash_ != 0) {
+      RegisterSharedProgram(fbd_info, device_id);
+    }
   }
 
   if (!fbd_info->program_->load()) {
@@ -156,4 +248,38 @@ hipError_t FatBinaryInfo::BuildProgram(const int device_id) {
   return hipSuccess;
 }
 
+hipError_t FatBinaryInfo::BuildProgram(const std::vector<hip::Device*>& devices) {
+  size_t pending = 0;
+  for (auto device : devices) {
+    DeviceIdCheck(device->deviceId());
+    pending += fatbin_dev_info_[device->deviceId()]->prog_built_ ? 0 : 1;
+  }
+  if (!HIP_PARALLEL_MODULE_LOAD || pending <= 1) {
+    for (auto device : devices) {
+      IHIP_RETURN_ONFAIL(BuildProgram(device->deviceId()));
+    }
+    return hipSuccess;
+  }
+
+  // Every device has its own program, so the builds and the loads don't share any state
+  std::vector<hipError_t> errors(devices.size(), hipSuccess);
+  std::vector<std::thread> threads;
+  threads.reserve(devices.size());
+  for (size_t dev_idx = 0; dev_idx < devices.size(); ++dev_idx) {
+    threads.emplace_back([this, &devices, &errors, dev_idx]() {
+      errors[dev_idx] = BuildProgram(devices[dev_idx]->deviceId());
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (auto error : errors) {
+    if (error != hipSuccess) {
+      return error;
+    }
+  }
+  return hipSuccess;
+}
+
 } //namespace : hip
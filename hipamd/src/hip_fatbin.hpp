@@ -29,6 +29,9 @@ private:
   //Control Variables
   bool add_dev_prog_;
   bool prog_built_;
+
+  size_t hash_ = 0;          // hash of the code object, 0 if it isn't shared
+  int shared_device_ = -1;   // device of the shared program, -1 if the program is private
 };
 
 
@@ -39,9 +42,13 @@ public:
   ~FatBinaryInfo();
 
   // Loads Fat binary from file or image, unbundles COs for devices.
-  hipError_t ExtractFatBinary(const std::vector<hip::Device*>& devices);
+  // The loaded programs are shared with the identical COs of other fat binaries, if the image
+  // stays valid until the destruction, as the embedded and the mapped fat binaries do
+  hipError_t ExtractFatBinary(const std::vector<hip::Device*>& devices, bool share = false);
   hipError_t AddDevProgram(const int device_id);
   hipError_t BuildProgram(const int device_id);
+  // Builds the programs of all devices, on worker threads with HIP_PARALLEL_MODULE_LOAD
+  hipError_t BuildProgram(const std::vector<hip::Device*>& devices);
 
 
   // Device Id bounds check
@@ -68,6 +75,13 @@ public:
   }
 
 private:
+  // Takes the loaded program of an identical code object, returns false if there is none
+  static bool AcquireSharedProgram(FatBinaryDeviceInfo* fbd_info, int device_id);
+  // Offers the loaded program to the identical code objects of the later fat binaries
+  static void RegisterSharedProgram(FatBinaryDeviceInfo* fbd_info, int device_id);
+  // Drops the program of a fat binary, returns true for the last user of the program
+  static bool ReleaseSharedProgram(FatBinaryDeviceInfo* fbd_info);
+
   std::string fname_;        // File name
   amd::Os::FileDesc fdesc_;  // File descriptor
   size_t fsize_;             // Total file size
@@ -634,7 +634,17 @@ hipError_t hipGraphicsMapResources(int count, hipGraphicsResource_t* resources,
     HIP_RETURN(hipErrorUnknown);
   }
   clearGLErrors(*amdContext);
-  amdContext->glenv()->glFinish_();
+  if (ROC_GL_INTEROP_LIGHT_SYNC) {
+    // Wait for the GL commands issued so far only, without a full pipeline drain
+    GLsync sync = amdContext->glenv()->glFenceSync_(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (sync != nullptr) {
+      amdContext->glenv()->glClientWaitSync_(sync, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                             static_cast<GLuint64>(-1));
+      amdContext->glenv()->glDeleteSync_(sync);
+    }
+  } else {
+    amdContext->glenv()->glFinish_();
+  }
   if (checkForGLError(*amdContext) != GL_NO_ERROR) {
     HIP_RETURN(hipErrorUnknown);
   }
@@ -713,8 +723,10 @@ hipError_t hipGraphicsUnmapResources(int count, hipGraphicsResource_t* resources
     HIP_RETURN(hipErrorContextIsDestroyed);
   }
 
-  // Wait for the current host queue
-  hip::getQueue(stream)->finish();
+  // Wait for the current host queue, unless the wait for the release command below covers it
+  if (!ROC_GL_INTEROP_LIGHT_SYNC) {
+    hip::getQueue(stream)->finish();
+  }
 
   amd::HostQueue* queue = hip::getQueue(stream);
   if (nullptr == queue) {
@@ -744,6 +756,11 @@ hipError_t hipGraphicsUnmapResources(int count, hipGraphicsResource_t* resources
   }
 
   command->enqueue();
+  if (ROC_GL_INTEROP_LIGHT_SYNC) {
+    // The release command follows all earlier work of the stream, hence its completion
+    // makes the results visible to GL
+    command->awaitCompletion();
+  }
 
   if (as_cl(&command->event()) == nullptr) {
     command->release();
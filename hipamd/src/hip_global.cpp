@@ -89,6 +89,81 @@ DeviceFunc::DeviceFunc(std::string name, hipModule_t hmod) : dflock_("function l
   }
 }
 
+static bool collectLaunchInfo(amd::Kernel* kernel, const amd::Device& device,
+                              DeviceFunc::LaunchInfo* info) {
+  const device::Kernel* devKernel = kernel->getDeviceKernel(device);
+  if (devKernel == nullptr) {
+    return false;
+  }
+  info->kernelWorkGroupSize_ = devKernel->workGroupInfo()->size_;
+  info->maxWorkGroupSize_ = std::min(info->kernelWorkGroupSize_, device.info().maxWorkGroupSize_);
+  info->signature_ = &kernel->signature();
+  info->device_ = &device;
+  return true;
+}
+
+const DeviceFunc::LaunchInfo* DeviceFunc::launchInfo(const amd::Device& device,
+                                                     LaunchInfo* scratch) {
+  // A function usually launches on the device of its module, so cache only the first device
+  std::call_once(launchInfoOnce_, [&]() {
+    if (!collectLaunchInfo(kernel_, device, &launchInfo_)) {
+      launchInfo_.device_ = nullptr;
+    }
+  });
+  if (launchInfo_.device_ == &device) {
+    return &launchInfo_;
+  }
+  return collectLaunchInfo(kernel_, device, scratch) ? scratch : nullptr;
+}
+
+static bool collectOccupancyInfo(amd::Kernel* kernel, const amd::Device& device,
+                                 size_t dynamicLds, DeviceFunc::OccupancyInfo* info) {
+  const device::Kernel* devKernel = kernel->getDeviceKernel(device);
+  if (devKernel == nullptr) {
+    return false;
+  }
+  info->device_ = &device;
+  info->dynamicLds_ = dynamicLds;
+  info->waveSize_ = devKernel->workGroupInfo()->wavefrontSize_;
+  info->aluLimitedThreads_ = static_cast<int>(devKernel->maxWavesPerCU() * info->waveSize_);
+  info->ldsGroups_ = static_cast<int>(
+      std::min<size_t>(devKernel->ldsGroupsPerCU(dynamicLds), INT_MAX));
+  // Index 0 stays unused, so a workgroup of N waves is at index N
+  const size_t maxWaves = amd::alignUp(device.info().maxWorkGroupSize_, info->waveSize_) /
+      info->waveSize_;
+  info->blocksPerCU_.resize(maxWaves + 1, 0);
+  for (size_t waves = 1; waves <= maxWaves; ++waves) {
+    info->blocksPerCU_[waves] = std::min(
+        info->aluLimitedThreads_ / static_cast<int>(waves * info->waveSize_), info->ldsGroups_);
+  }
+  return true;
+}
+
+const DeviceFunc::OccupancyInfo* DeviceFunc::occupancyInfo(const amd::Device& device,
+                                                           size_t dynamicLds,
+                                                           OccupancyInfo* scratch) {
+  // Frameworks query a few LDS sizes on every launch, hence keep a small number of the tables
+  constexpr size_t kMaxOccupancyInfos = 8;
+  amd::ScopedLock lock(dflock_);
+  for (const auto& it : occupancy_) {
+    if ((it.device_ == &device) && (it.dynamicLds_ == dynamicLds)) {
+      return &it;
+    }
+  }
+  OccupancyInfo* info = scratch;
+  if (occupancy_.size() < kMaxOccupancyInfos) {
+    occupancy_.emplace_back();
+    info = &occupancy_.back();
+  }
+  if (!collectOccupancyInfo(kernel_, device, dynamicLds, info)) {
+    if (info != scratch) {
+      occupancy_.pop_back();
+    }
+    return nullptr;
+  }
+  return info;
+}
+
 DeviceFunc::~DeviceFunc() {
   if (kernel_ != nullptr) {
     kernel_->release();
@@ -1,6 +1,8 @@
 #ifndef HIP_GLOBAL_HPP
 #define HIP_GLOBAL_HPP
 
+#include <list>
+#include <mutex>
 #include <vector>
 #include <string>
 
@@ -25,6 +27,7 @@ public:
   hipDeviceptr_t device_ptr() const { return device_ptr_; }
   size_t size() const { return size_; }
   std::string name() const { return name_; }
+  amd::Memory* amd_mem_obj() const { return amd_mem_obj_; }
   void* shadowVptr;
 
 private:
@@ -49,9 +52,39 @@ public:
   std::string name() const { return name_; }
   amd::Kernel* kernel() const { return kernel_; }
 
+  //Launch limits and layout of the kernel, which don't change between the launches
+  struct LaunchInfo {
+    const amd::Device* device_;               //Device the info was collected for
+    size_t maxWorkGroupSize_;                 //Min of the device and launch bounds limits
+    size_t kernelWorkGroupSize_;              //Launch bounds of the kernel
+    const amd::KernelSignature* signature_;   //Argument layout of the kernel
+  };
+
+  //Returns the launch info for the device, nullptr if the kernel isn't available.
+  //The info is collected once, on the first launch
+  const LaunchInfo* launchInfo(const amd::Device& device, LaunchInfo* scratch);
+
+  //Occupancy of the kernel for a device and a dynamic LDS size
+  struct OccupancyInfo {
+    const amd::Device* device_;               //Device the table was computed for
+    size_t dynamicLds_;                       //Dynamic LDS size of a workgroup
+    size_t waveSize_;                         //Wavefront size of the kernel
+    int aluLimitedThreads_;                   //Resident threads per CU, limited by the GPRs
+    int ldsGroups_;                           //Resident workgroups per CU, limited by the LDS
+    std::vector<int> blocksPerCU_;            //Resident workgroups per CU, indexed by the waves
+  };
+
+  //Returns the occupancy table, nullptr if the kernel isn't available.
+  //The table is computed on the first query of the device and LDS size
+  const OccupancyInfo* occupancyInfo(const amd::Device& device, size_t dynamicLds,
+                                     OccupancyInfo* scratch);
+
 private:
   std::string name_;        //name of the func(not unique identifier)
   amd::Kernel* kernel_;     //Kernel ptr referencing to ROCclr Symbol
+  std::once_flag launchInfoOnce_;
+  LaunchInfo launchInfo_ = {};
+  std::list<OccupancyInfo> occupancy_;  //Grows only, so the returned tables stay valid
 };
 
 //Abstract Structures
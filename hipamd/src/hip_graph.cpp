@@ -97,7 +97,7 @@ hipError_t ihipGraphAddKernelNode(hipGraphNode_t* pGraphNode, hipGraph_t graph,
     return hipErrorInvalidConfiguration;
   }
 
-  *pGraphNode = new hipGraphKernelNode(pNodeParams, func);
+  *pGraphNode = new (graph) hipGraphKernelNode(pNodeParams, func);
   status = ihipGraphAddNode(*pGraphNode, graph, pDependencies, numDependencies);
   return status;
 }
@@ -113,7 +113,7 @@ hipError_t ihipGraphAddMemcpyNode(hipGraphNode_t* pGraphNode, hipGraph_t graph,
   if (status != hipSuccess) {
     return status;
   }
-  *pGraphNode = new hipGraphMemcpyNode(pCopyParams);
+  *pGraphNode = new (graph) hipGraphMemcpyNode(pCopyParams);
   status = ihipGraphAddNode(*pGraphNode, graph, pDependencies, numDependencies);
   return status;
 }
@@ -129,7 +129,7 @@ hipError_t ihipGraphAddMemcpyNode1D(hipGraphNode_t* pGraphNode, hipGraph_t graph
   if (status != hipSuccess) {
     return status;
   }
-  *pGraphNode = new hipGraphMemcpyNode1D(dst, src, count, kind);
+  *pGraphNode = new (graph) hipGraphMemcpyNode1D(dst, src, count, kind);
   status = ihipGraphAddNode(*pGraphNode, graph, pDependencies, numDependencies);
   return status;
 }
@@ -166,7 +166,7 @@ hipError_t ihipGraphAddMemsetNode(hipGraphNode_t* pGraphNode, hipGraph_t graph,
   if (status != hipSuccess) {
     return status;
   }
-  *pGraphNode = new hipGraphMemsetNode(pMemsetParams);
+  *pGraphNode = new (graph) hipGraphMemsetNode(pMemsetParams);
   status = ihipGraphAddNode(*pGraphNode, graph, pDependencies, numDependencies);
   return status;
 }
@@ -489,14 +489,14 @@ hipError_t capturehipMemcpy(hipStream_t stream, void* dst, const void* src, size
     return hipErrorInvalidValue;
   }
   hip::Stream* s = reinterpret_cast<hip::Stream*>(stream);
-  std::vector<hipGraphNode_t> pDependencies = s->GetLastCapturedNodes();
-  size_t numDependencies = s->GetLastCapturedNodes().size();
+  const std::vector<hipGraphNode_t>& pDependencies = s->GetLastCapturedNodes();
+  size_t numDependencies = pDependencies.size();
   hipGraph_t graph = s->GetCaptureGraph();
   hipError_t status = ihipMemcpy_validate(dst, src, sizeBytes, kind);
   if (status != hipSuccess) {
     return status;
   }
-  hipGraphNode_t node = new hipGraphMemcpyNode1D(dst, src, sizeBytes, kind);
+  hipGraphNode_t node = new (graph) hipGraphMemcpyNode1D(dst, src, sizeBytes, kind);
   status = ihipGraphAddNode(node, graph, pDependencies.data(), numDependencies);
   if (status != hipSuccess) {
     return status;
@@ -562,7 +562,7 @@ hipError_t capturehipMemcpyFromSymbolAsync(hipStream_t& stream, void*& dst, cons
   }
   hip::Stream* s = reinterpret_cast<hip::Stream*>(stream);
   hipGraphNode_t pGraphNode =
-      new hipGraphMemcpyNodeFromSymbol(dst, symbol, sizeBytes, offset, kind);
+      new (s->GetCaptureGraph()) hipGraphMemcpyNodeFromSymbol(dst, symbol, sizeBytes, offset, kind);
   status = ihipGraphAddNode(pGraphNode, s->GetCaptureGraph(), s->GetLastCapturedNodes().data(),
                             s->GetLastCapturedNodes().size());
   if (status != hipSuccess) {
@@ -586,7 +586,8 @@ hipError_t capturehipMemcpyToSymbolAsync(hipStream_t& stream, const void*& symbo
     HIP_RETURN(status);
   }
   hip::Stream* s = reinterpret_cast<hip::Stream*>(stream);
-  hipGraphNode_t pGraphNode = new hipGraphMemcpyNodeToSymbol(symbol, src, sizeBytes, offset, kind);
+  hipGraphNode_t pGraphNode =
+      new (s->GetCaptureGraph()) hipGraphMemcpyNodeToSymbol(symbol, src, sizeBytes, offset, kind);
   status = ihipGraphAddNode(pGraphNode, s->GetCaptureGraph(), s->GetLastCapturedNodes().data(),
                             s->GetLastCapturedNodes().size());
   if (status != hipSuccess) {
@@ -710,7 +711,7 @@ hipError_t capturehipLaunchHostFunc(hipStream_t& stream, hipHostFn_t& fn, void*&
   hostParams.fn = fn;
   hostParams.userData = userData;
   hip::Stream* s = reinterpret_cast<hip::Stream*>(stream);
-  hipGraphNode_t pGraphNode = new hipGraphHostNode(&hostParams);
+  hipGraphNode_t pGraphNode = new (s->GetCaptureGraph()) hipGraphHostNode(&hostParams);
   hipError_t status =
       ihipGraphAddNode(pGraphNode, s->GetCaptureGraph(), s->GetLastCapturedNodes().data(),
                        s->GetLastCapturedNodes().size());
@@ -767,7 +768,9 @@ hipError_t hipStreamBeginCapture(hipStream_t stream, hipStreamCaptureMode mode)
     HIP_RETURN(hipErrorIllegalState);
   }
 
-  s->SetCaptureGraph(new ihipGraph());
+  hipGraph_t graph = new ihipGraph();
+  graph->EnableNodeArena();
+  s->SetCaptureGraph(graph);
   s->SetCaptureMode(mode);
   s->SetOriginStream();
   if (mode != hipStreamCaptureModeRelaxed) {
@@ -952,7 +955,7 @@ hipError_t hipGraphAddEmptyNode(hipGraphNode_t* pGraphNode, hipGraph_t graph,
       (numDependencies > 0 && pDependencies == nullptr)) {
     HIP_RETURN(hipErrorInvalidValue);
   }
-  *pGraphNode = new hipGraphEmptyNode();
+  *pGraphNode = new (graph) hipGraphEmptyNode();
   hipError_t status = ihipGraphAddNode(*pGraphNode, graph, pDependencies, numDependencies);
   HIP_RETURN(status);
 }
@@ -965,7 +968,7 @@ hipError_t hipGraphAddChildGraphNode(hipGraphNode_t* pGraphNode, hipGraph_t grap
       (numDependencies > 0 && pDependencies == nullptr) || childGraph == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
   }
-  *pGraphNode = new hipChildGraphNode(childGraph);
+  *pGraphNode = new (graph) hipChildGraphNode(childGraph);
   hipError_t status = ihipGraphAddNode(*pGraphNode, graph, pDependencies, numDependencies);
   HIP_RETURN(status);
 }
@@ -975,10 +978,15 @@ hipError_t ihipGraphInstantiate(hipGraphExec_t* pGraphExec, hipGraph_t graph) {
     HIP_RETURN(hipErrorInvalidValue);
   }
   std::unordered_map<Node, Node> clonedNodes;
+  // Traversals are cached in the original graph and reused by every instantiation
+  graph->GetTopology();
   hipGraph_t clonedGraph = graph->clone(clonedNodes);
   if (clonedGraph == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (HIP_GRAPH_FUSE_COPY_NODES) {
+    clonedGraph->FuseNodes(clonedNodes);
+  }
   std::vector<std::vector<Node>> parallelLists;
   std::unordered_map<Node, std::vector<Node>> nodeWaitLists;
   clonedGraph->GetRunList(parallelLists, nodeWaitLists);
@@ -1252,7 +1260,11 @@ hipError_t hipGraphExecKernelNodeSetParams(hipGraphExec_t hGraphExec, hipGraphNo
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
   }
-  HIP_RETURN(reinterpret_cast<hipGraphKernelNode*>(clonedNode)->SetParams(pNodeParams));
+  hipError_t status = reinterpret_cast<hipGraphKernelNode*>(clonedNode)->SetParams(pNodeParams);
+  if (status == hipSuccess) {
+    hGraphExec->UpdateAqlPacket(clonedNode);
+  }
+  HIP_RETURN(status);
 }
 
 hipError_t hipGraphChildGraphNodeGetGraph(hipGraphNode_t node, hipGraph_t* pGraph) {
@@ -1560,7 +1572,7 @@ hipError_t hipGraphAddMemcpyNodeFromSymbol(hipGraphNode_t* pGraphNode, hipGraph_
   if (status != hipSuccess) {
     HIP_RETURN(status);
   }
-  *pGraphNode = new hipGraphMemcpyNodeFromSymbol(dst, symbol, count, offset, kind);
+  *pGraphNode = new (graph) hipGraphMemcpyNodeFromSymbol(dst, symbol, count, offset, kind);
   status = ihipGraphAddNode(*pGraphNode, graph, pDependencies, numDependencies);
   HIP_RETURN(status);
 }
@@ -1616,7 +1628,7 @@ hipError_t hipGraphAddMemcpyNodeToSymbol(hipGraphNode_t* pGraphNode, hipGraph_t
   if (status != hipSuccess) {
     HIP_RETURN(status);
   }
-  *pGraphNode = new hipGraphMemcpyNodeToSymbol(symbol, src, count, offset, kind);
+  *pGraphNode = new (graph) hipGraphMemcpyNodeToSymbol(symbol, src, count, offset, kind);
   if (*pGraphNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
   }
@@ -1670,7 +1682,7 @@ hipError_t hipGraphAddEventRecordNode(hipGraphNode_t* pGraphNode, hipGraph_t gra
       (numDependencies > 0 && pDependencies == nullptr) || event == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
   }
-  *pGraphNode = new hipGraphEventRecordNode(event);
+  *pGraphNode = new (graph) hipGraphEventRecordNode(event);
   hipError_t status = ihipGraphAddNode(*pGraphNode, graph, pDependencies, numDependencies);
   HIP_RETURN(status);
 }
@@ -1714,7 +1726,7 @@ hipError_t hipGraphAddEventWaitNode(hipGraphNode_t* pGraphNode, hipGraph_t graph
       (numDependencies > 0 && pDependencies == nullptr) || event == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
   }
-  *pGraphNode = new hipGraphEventWaitNode(event);
+  *pGraphNode = new (graph) hipGraphEventWaitNode(event);
   hipError_t status = ihipGraphAddNode(*pGraphNode, graph, pDependencies, numDependencies);
   HIP_RETURN(status);
 }
@@ -1759,7 +1771,7 @@ hipError_t hipGraphAddHostNode(hipGraphNode_t* pGraphNode, hipGraph_t graph,
     HIP_RETURN(hipErrorInvalidValue);
   }
 
-  *pGraphNode = new hipGraphHostNode(pNodeParams);
+  *pGraphNode = new (graph) hipGraphHostNode(pNodeParams);
   hipError_t status = ihipGraphAddNode(*pGraphNode, graph, pDependencies, numDependencies);
   HIP_RETURN(status);
 }
@@ -1815,6 +1827,12 @@ hipError_t hipGraphExecUpdate(hipGraphExec_t hGraphExec, hipGraph_t hGraph,
   }
   for (std::vector<Node>::size_type i = 0; i != newGraphNodes.size(); i++) {
     if (newGraphNodes[i]->GetType() == oldGraphExecNodes[i]->GetType()) {
+      const bool isKernel = (newGraphNodes[i]->GetType() == hipGraphNodeTypeKernel);
+      // Skip unchanged kernels, so only the modified packets are rewritten
+      if (isKernel && static_cast<hipGraphKernelNode*>(oldGraphExecNodes[i])
+                          ->HasEqualParams(static_cast<hipGraphKernelNode*>(newGraphNodes[i]))) {
+        continue;
+      }
       hipError_t status = oldGraphExecNodes[i]->SetParams(newGraphNodes[i]);
       if (status != hipSuccess) {
         *hErrorNode_out = newGraphNodes[i];
@@ -1827,6 +1845,11 @@ hipError_t hipGraphExecUpdate(hipGraphExec_t hGraphExec, hipGraph_t hGraph,
         }
         HIP_RETURN(hipErrorGraphExecUpdateFailure);
       }
+      if (isKernel) {
+        hGraphExec->UpdateAqlPacket(oldGraphExecNodes[i]);
+      } else {
+        hGraphExec->InvalidateAqlPackets();
+      }
     } else {
       *hErrorNode_out = newGraphNodes[i];
       *updateResult_out = hipGraphExecUpdateErrorNodeTypeChanged;
@@ -45,12 +45,47 @@ const char* GetGraphNodeTypeString(uint32_t op) {
 };
 
 int hipGraphNode::nextID = 0;
-std::unordered_set<hipGraphNode*> hipGraphNode::nodeSet_;
-amd::Monitor hipGraphNode::nodeSetLock_{"Guards global node set"};
-std::unordered_set<ihipGraph*> ihipGraph::graphSet_;
-amd::Monitor ihipGraph::graphSetLock_{"Guards global graph set"};
-std::unordered_set<hipGraphExec*> hipGraphExec::graphExecSet_;
-amd::Monitor hipGraphExec::graphExecSetLock_{"Guards global exec graph set"};
+hipGraphObjectRegistry<hipGraphNode> hipGraphNode::nodeSet_;
+hipGraphObjectRegistry<ihipGraph> ihipGraph::graphSet_;
+
+void* hipGraphNodeArena::Alloc(size_t size) {
+  size = amd::alignUp(size, alignof(std::max_align_t));
+  amd::ScopedLock lock(lock_);
+  if (offset_ + size > kChunkSize) {
+    char* chunk = reinterpret_cast<char*>(::malloc(std::max(size, kChunkSize)));
+    if (chunk == nullptr) {
+      return nullptr;
+    }
+    chunks_.push_back(chunk);
+    offset_ = 0;
+  }
+  void* ptr = chunks_.back() + offset_;
+  offset_ += size;
+  return ptr;
+}
+
+void* hipGraphNode::operator new(size_t size, ihipGraph* graph) noexcept {
+  hipGraphNodeArena* arena = (graph != nullptr) ? graph->GetNodeArena() : nullptr;
+  void* ptr = (arena != nullptr) ? arena->Alloc(size + kNodeHeaderSize)
+                                 : ::malloc(size + kNodeHeaderSize);
+  if (ptr == nullptr) {
+    return nullptr;
+  }
+  *reinterpret_cast<hipGraphNodeArena**>(ptr) = arena;
+  return reinterpret_cast<char*>(ptr) + kNodeHeaderSize;
+}
+
+void hipGraphNode::operator delete(void* ptr) noexcept {
+  if (ptr == nullptr) {
+    return;
+  }
+  char* base = reinterpret_cast<char*>(ptr) - kNodeHeaderSize;
+  // Arena memory is returned when the graph is destroyed
+  if (*reinterpret_cast<hipGraphNodeArena**>(base) == nullptr) {
+    ::free(base);
+  }
+}
+hipGraphObjectRegistry<hipGraphExec> hipGraphExec::graphExecSet_;
 
 hipError_t hipGraphMemcpyNode1D::ValidateParams(void* dst, const void* src, size_t count,
                                                 hipMemcpyKind kind) {
@@ -471,16 +506,43 @@ hipError_t hipGraphMemcpyNode::SetCommandParams(const hipMemcpy3DParms* pNodePar
 }
 
 
-bool ihipGraph::isGraphValid(ihipGraph* pGraph) {
-  amd::ScopedLock lock(graphSetLock_);
-  if (graphSet_.find(pGraph) == graphSet_.end()) {
+bool hipGraphKernelNode::CaptureAqlPacket(amd::HostQueue* queue, address packet,
+                                          address kernArgs) {
+  if (ihipValidateKernelParams(pKernelParams_) != hipSuccess) {
     return false;
   }
-  return true;
+  amd::Command* command = nullptr;
+  hipError_t status = ihipLaunchKernelCommand(
+      command, func_, pKernelParams_->gridDim.x * pKernelParams_->blockDim.x,
+      pKernelParams_->gridDim.y * pKernelParams_->blockDim.y,
+      pKernelParams_->gridDim.z * pKernelParams_->blockDim.z, pKernelParams_->blockDim.x,
+      pKernelParams_->blockDim.y, pKernelParams_->blockDim.z, pKernelParams_->sharedMemBytes,
+      queue, pKernelParams_->kernelParams, pKernelParams_->extra, nullptr, nullptr, 0, 0, 0, 0, 0,
+      0, 0);
+  if (status != hipSuccess) {
+    return false;
+  }
+  amd::NDRangeKernelCommand* kernelCommand = reinterpret_cast<amd::NDRangeKernelCommand*>(command);
+  kernelCommand->setCapturingState(true, packet, kernArgs);
+  // The device layer only builds the packet, hence the command never reaches the HW queue
+  kernelCommand->submit(*queue->vdev());
+  bool captured = kernelCommand->getCapturingState();
+  kernelCommand->releaseResources();
+  kernelCommand->release();
+  return captured;
 }
 
+bool ihipGraph::isGraphValid(ihipGraph* pGraph) { return graphSet_.Contains(pGraph); }
+
+
+void hipGraphNode::InvalidateTopology() {
+  if (parentGraph_ != nullptr) {
+    parentGraph_->InvalidateTopology();
+  }
+}
 
 void ihipGraph::AddNode(const Node& node) {
+  InvalidateTopology();
   vertices_.emplace_back(node);
   ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Add %s(%p)\n",
           GetGraphNodeTypeString(node->GetType()), node);
@@ -488,6 +550,7 @@ void ihipGraph::AddNode(const Node& node) {
 }
 
 void ihipGraph::RemoveNode(const Node& node) {
+  InvalidateTopology();
   vertices_.erase(std::remove(vertices_.begin(), vertices_.end(), node), vertices_.end());
 }
 
@@ -584,29 +647,57 @@ void ihipGraph::GetRunListUtil(Node v, std::unordered_map<Node, bool>& visited,
 // It uses recursive GetRunListUtil()
 void ihipGraph::GetRunList(std::vector<std::vector<Node>>& parallelLists,
                            std::unordered_map<Node, std::vector<Node>>& dependencies) {
-  std::vector<Node> singleList;
+  // Nodes with embedded child graphs build their own run lists
+  for (auto node : vertices_) {
+    node->GetRunList(parallelLists, dependencies);
+  }
+  const Topology& topology = GetTopology();
+  parallelLists.insert(parallelLists.end(), topology.parallelLists_.begin(),
+                       topology.parallelLists_.end());
+  for (const auto& entry : topology.dependencies_) {
+    auto& nodeDependencies = dependencies[entry.first];
+    nodeDependencies.insert(nodeDependencies.end(), entry.second.begin(), entry.second.end());
+  }
+}
+
+void ihipGraph::LevelOrder(std::vector<Node>& levelOrder) {
+  const Topology& topology = GetTopology();
+  levelOrder.insert(levelOrder.end(), topology.levelOrder_.begin(), topology.levelOrder_.end());
+}
 
+const ihipGraph::Topology& ihipGraph::GetTopology() {
+  if (topology_.valid_ && (topology_.version_ == version_)) {
+    return topology_;
+  }
+  topology_.levelOrder_.clear();
+  topology_.parallelLists_.clear();
+  topology_.dependencies_.clear();
+
+  std::vector<Node> singleList;
   // Mark all the vertices as not visited
   std::unordered_map<Node, bool> visited;
   for (auto node : vertices_) visited[node] = false;
 
   // Call the recursive helper function for all vertices one by one
   for (auto node : vertices_) {
-    // If the node has embedded child graph
-    node->GetRunList(parallelLists, dependencies);
     if (visited[node] == false) {
-      GetRunListUtil(node, visited, singleList, parallelLists, dependencies);
+      GetRunListUtil(node, visited, singleList, topology_.parallelLists_, topology_.dependencies_);
     }
   }
-  for (size_t i = 0; i < parallelLists.size(); i++) {
-    for (size_t j = 0; j < parallelLists[i].size(); j++) {
+  for (size_t i = 0; i < topology_.parallelLists_.size(); i++) {
+    for (size_t j = 0; j < topology_.parallelLists_[i].size(); j++) {
       ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] list %d - %s(%p)\n", i + 1,
-              GetGraphNodeTypeString(parallelLists[i][j]->GetType()), parallelLists[i][j]);
+              GetGraphNodeTypeString(topology_.parallelLists_[i][j]->GetType()),
+              topology_.parallelLists_[i][j]);
     }
   }
+  ComputeLevelOrder(topology_.levelOrder_);
+  topology_.version_ = version_;
+  topology_.valid_ = true;
+  return topology_;
 }
 
-void ihipGraph::LevelOrder(std::vector<Node>& levelOrder) {
+void ihipGraph::ComputeLevelOrder(std::vector<Node>& levelOrder) {
   std::vector<Node> roots = GetRootNodes();
   std::unordered_map<Node, bool> visited;
   std::queue<Node> q;
@@ -616,7 +707,7 @@ void ihipGraph::LevelOrder(std::vector<Node>& levelOrder) {
             GetGraphNodeTypeString((*it)->GetType()), *it, (*it)->GetLevel());
   }
   while (!q.empty()) {
-    Node& node = q.front();
+    Node node = q.front();
     q.pop();
     levelOrder.push_back(node);
     for (const auto& i : node->GetEdges()) {
@@ -630,6 +721,102 @@ void ihipGraph::LevelOrder(std::vector<Node>& levelOrder) {
   }
 }
 
+void ihipGraph::UpdateLevels() {
+  std::unordered_map<Node, size_t> pending;
+  std::queue<Node> q;
+  for (auto node : vertices_) {
+    node->SetLevel(0);
+    pending[node] = node->GetInDegree();
+    if (node->GetInDegree() == 0) {
+      q.push(node);
+    }
+  }
+  while (!q.empty()) {
+    Node node = q.front();
+    q.pop();
+    for (auto edge : node->GetEdges()) {
+      edge->SetLevel(std::max(edge->GetLevel(), node->GetLevel() + 1));
+      if (--pending[edge] == 0) {
+        q.push(edge);
+      }
+    }
+  }
+}
+
+// Returns true if both nodes have the same set of parents and children
+static bool HaveSameNeighbors(const Node a, const Node b) {
+  auto sameSet = [](std::vector<Node> x, std::vector<Node> y) {
+    std::sort(x.begin(), x.end());
+    std::sort(y.begin(), y.end());
+    return x == y;
+  };
+  return sameSet(a->GetDependencies(), b->GetDependencies()) &&
+         sameSet(a->GetEdges(), b->GetEdges());
+}
+
+void ihipGraph::FuseNodes(std::unordered_map<Node, Node>& clonedNodes) {
+  size_t numFused = 0;
+  for (size_t i = 0; i < vertices_.size();) {
+    Node node = vertices_[i];
+    std::vector<Node> candidates;
+    // The only child, which doesn't wait for anything else
+    if ((node->GetEdges().size() == 1) && (node->GetEdges()[0]->GetDependencies().size() == 1)) {
+      candidates.push_back(node->GetEdges()[0]);
+    }
+    // Independent siblings, if ordered the same way relative to the rest of the graph
+    const std::vector<Node>& siblings =
+        node->GetDependencies().empty() ? vertices_ : node->GetDependencies()[0]->GetEdges();
+    for (auto sibling : siblings) {
+      if ((sibling != node) && HaveSameNeighbors(node, sibling)) {
+        candidates.push_back(sibling);
+      }
+    }
+    Node fused = nullptr;
+    for (auto candidate : candidates) {
+      if (node->Merge(candidate)) {
+        fused = candidate;
+        break;
+      }
+    }
+    if (fused == nullptr) {
+      ++i;
+      continue;
+    }
+    // The merged node inherits the children of the fused one
+    node->RemoveEdge(fused);
+    const std::vector<Node> edges = fused->GetEdges();
+    for (auto edge : edges) {
+      fused->RemoveEdge(edge);
+      if (std::find(node->GetEdges().begin(), node->GetEdges().end(), edge) ==
+          node->GetEdges().end()) {
+        node->AddEdge(edge);
+      }
+    }
+    const std::vector<Node> dependencies = fused->GetDependencies();
+    for (auto dep : dependencies) {
+      dep->RemoveEdge(fused);
+    }
+    ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Fused %s(%p) into %s(%p)\n",
+            GetGraphNodeTypeString(fused->GetType()), fused,
+            GetGraphNodeTypeString(node->GetType()), node);
+    // Neither node matches its original anymore, so exec node updates can't reach them
+    for (auto it = clonedNodes.begin(); it != clonedNodes.end();) {
+      it = ((it->second == fused) || (it->second == node)) ? clonedNodes.erase(it) : ++it;
+    }
+    auto pos = std::find(vertices_.begin(), vertices_.end(), fused);
+    if (static_cast<size_t>(pos - vertices_.begin()) < i) {
+      --i;
+    }
+    vertices_.erase(pos);
+    delete fused;
+    ++numFused;
+  }
+  if (numFused != 0) {
+    UpdateLevels();
+    InvalidateTopology();
+  }
+}
+
 const ihipGraph* ihipGraph::getOriginalGraph() const {
   return pOriginalGraph_;
 }
@@ -664,6 +851,27 @@ ihipGraph* ihipGraph::clone(std::unordered_map<Node, Node>& clonedNodes) const{
     }
     clonedNodes[node]->SetDependencies(clonedDependencies);
   }
+  // The clone has the same structure, hence the cached traversals only need node translation
+  if (topology_.valid_ && (topology_.version_ == version_)) {
+    Topology& topology = newGraph->topology_;
+    for (auto node : topology_.levelOrder_) {
+      topology.levelOrder_.push_back(clonedNodes[node]);
+    }
+    for (const auto& list : topology_.parallelLists_) {
+      topology.parallelLists_.emplace_back();
+      for (auto node : list) {
+        topology.parallelLists_.back().push_back(clonedNodes[node]);
+      }
+    }
+    for (const auto& entry : topology_.dependencies_) {
+      auto& dependencies = topology.dependencies_[clonedNodes[entry.first]];
+      for (auto node : entry.second) {
+        dependencies.push_back(clonedNodes[node]);
+      }
+    }
+    topology.version_ = newGraph->version_;
+    topology.valid_ = true;
+  }
   newGraph->setOriginalGraph(this);
   return newGraph;
 }
@@ -674,11 +882,7 @@ ihipGraph* ihipGraph::clone() const{
 }
 
 bool hipGraphExec::isGraphExecValid(hipGraphExec* pGraphExec) {
-  amd::ScopedLock lock(graphExecSetLock_);
-  if (graphExecSet_.find(pGraphExec) == graphExecSet_.end()) {
-    return false;
-  }
-  return true;
+  return graphExecSet_.Contains(pGraphExec);
 }
 
 hipError_t hipGraphExec::CreateQueues(size_t numQueues) {
@@ -705,15 +909,73 @@ hipError_t hipGraphExec::CreateQueues(size_t numQueues) {
 
 hipError_t hipGraphExec::Init() {
   hipError_t status;
-  size_t reqNumQueues = 1;
+  size_t reqNumQueues = 0;
 
   for (auto& node : levelOrder_) {
     reqNumQueues += node->GetNumParallelQueues();
   }
-  status = CreateQueues(parallelLists_.size() - 1 + reqNumQueues);
+  singleQueueLaunch_ = HIP_GRAPH_SINGLE_QUEUE_LAUNCH && IsSingleQueueEligible();
+  if (singleQueueLaunch_) {
+    return hipSuccess;
+  }
+  ScheduleBranches();
+  status = CreateQueues(numBranchQueues_ + reqNumQueues);
   return status;
 }
 
+void hipGraphExec::ScheduleBranches() {
+  size_t numBranches = parallelLists_.empty() ? 0 : parallelLists_.size() - 1;
+  numBranchQueues_ = (HIP_GRAPH_MAX_PARALLEL_QUEUES == 0)
+      ? numBranches
+      : std::min(numBranches, static_cast<size_t>(HIP_GRAPH_MAX_PARALLEL_QUEUES));
+  branchQueues_.assign(parallelLists_.size(), 0);
+  if (numBranches == 0) {
+    return;
+  }
+  // Longest path cost from every node to the graph exit, levelOrder_ lists parents first
+  std::unordered_map<Node, size_t> bottomLevel;
+  for (auto it = levelOrder_.rbegin(); it != levelOrder_.rend(); ++it) {
+    size_t level = 0;
+    for (auto edge : (*it)->GetEdges()) {
+      level = std::max(level, bottomLevel[edge]);
+    }
+    bottomLevel[*it] = level + (*it)->GetCost();
+  }
+  std::vector<size_t> branches(numBranches);
+  std::vector<size_t> priority(parallelLists_.size(), 0);
+  for (size_t i = 1; i < parallelLists_.size(); ++i) {
+    branches[i - 1] = i;
+    if (!parallelLists_[i].empty()) {
+      priority[i] = bottomLevel[parallelLists_[i].front()];
+    }
+  }
+  // Branches on the critical path go first, so they always get the least loaded queue
+  std::stable_sort(branches.begin(), branches.end(),
+                   [&priority](size_t a, size_t b) { return priority[a] > priority[b]; });
+  std::vector<size_t> load(numBranchQueues_, 0);
+  for (auto branch : branches) {
+    size_t queue = std::min_element(load.begin(), load.end()) - load.begin();
+    branchQueues_[branch] = queue;
+    for (auto& node : parallelLists_[branch]) {
+      load[queue] += node->GetCost();
+    }
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Scheduled %zu branches on %zu queues\n",
+          numBranches, numBranchQueues_);
+}
+
+void hipGraphExec::UpdateQueues(amd::HostQueue* queue) {
+  // Child graphs take their queues after the queues of the parallel lists
+  currentQueueIndex_ = numBranchQueues_;
+  for (size_t i = 0; i < parallelLists_.size(); ++i) {
+    // first parallel list will be launched on the same queue as parent
+    amd::HostQueue* branchQueue = (i == 0) ? queue : parallelQueues_[branchQueues_[i]];
+    for (auto& node : parallelLists_[i]) {
+      node->SetQueue(branchQueue, this);
+    }
+  }
+}
+
 hipError_t FillCommands(std::vector<std::vector<Node>>& parallelLists,
                         std::unordered_map<Node, std::vector<Node>>& nodeWaitLists,
                         std::vector<Node>& levelOrder,
@@ -726,6 +988,10 @@ hipError_t FillCommands(std::vector<std::vector<Node>>& parallelLists,
     if (status != hipSuccess) return status;
     amd::Command::EventWaitList waitList;
     for (auto depNode : nodeWaitLists[node]) {
+      // The queue is in order, branches scheduled on the same queue don't need markers
+      if (depNode->GetQueue() == node->GetQueue()) {
+        continue;
+      }
       for (auto command : depNode->GetCommands()) {
         waitList.push_back(command);
       }
@@ -789,13 +1055,186 @@ void UpdateQueue(std::vector<std::vector<Node>>& parallelLists, amd::HostQueue*&
   }
 }
 
+bool hipGraphExec::IsSingleQueueEligible() const {
+  for (auto& node : levelOrder_) {
+    switch (node->GetType()) {
+      case hipGraphNodeTypeKernel:
+        if (static_cast<hipGraphKernelNode*>(node)->IsCooperative()) {
+          return false;
+        }
+        break;
+      case hipGraphNodeTypeMemset:
+      case hipGraphNodeTypeMemcpy:
+      case hipGraphNodeTypeEmpty:
+        break;
+      default:
+        return false;
+    }
+  }
+  return !levelOrder_.empty();
+}
+
+hipError_t hipGraphExec::RunSingleQueue(amd::HostQueue* queue, hipStream_t stream) {
+  // The queue is in order and the level order respects all edges, hence no wait lists,
+  // root or end markers are required
+  for (auto& node : levelOrder_) {
+    node->SetQueue(queue, this);
+    hipError_t status = node->CreateCommand(queue);
+    if (status != hipSuccess) {
+      return status;
+    }
+  }
+  for (auto& node : levelOrder_) {
+    node->EnqueueCommands(stream);
+  }
+  return hipSuccess;
+}
+
+bool hipGraphExec::IsPacketCaptureEligible() const {
+  if (levelOrder_.empty()) {
+    return false;
+  }
+  // Only kernel nodes can be replayed, empty nodes are covered by the in-order replay
+  for (auto& node : levelOrder_) {
+    if (node->GetType() == hipGraphNodeTypeKernel) {
+      if (static_cast<hipGraphKernelNode*>(node)->IsCooperative()) {
+        return false;
+      }
+    } else if (node->GetType() != hipGraphNodeTypeEmpty) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool hipGraphExec::CaptureAqlPackets(amd::HostQueue* queue) {
+  const amd::Device& device = queue->device();
+  std::vector<hipGraphKernelNode*> kernelNodes;
+  std::vector<size_t> offsets;
+  size_t size = 0;
+  for (auto& node : levelOrder_) {
+    if (node->GetType() != hipGraphNodeTypeKernel) {
+      continue;
+    }
+    hipGraphKernelNode* kernelNode = static_cast<hipGraphKernelNode*>(node);
+    size_t kernArgSize = 0;
+    size_t alignment = 0;
+    kernelNode->GetKernargSegment(device, kernArgSize, alignment);
+    size = amd::alignUp(size, std::max<size_t>(alignment, 1));
+    offsets.push_back(size);
+    size += kernArgSize;
+    kernelNodes.push_back(kernelNode);
+  }
+
+  kernArgPoolSize_ = std::max<size_t>(size, 1);
+  kernArgPool_ = reinterpret_cast<address>(
+      device.hostAlloc(kernArgPoolSize_, 0, amd::Device::MemorySegment::kKernArg));
+  if (kernArgPool_ == nullptr) {
+    kernArgPoolSize_ = 0;
+    return false;
+  }
+  capturedQueue_ = queue;
+  aqlPackets_.resize(kernelNodes.size() * amd::kAqlPacketSize);
+  offsets.push_back(size);
+  for (size_t i = 0; i < kernelNodes.size(); ++i) {
+    CapturedPacket captured = {i * amd::kAqlPacketSize, offsets[i], offsets[i + 1] - offsets[i]};
+    if (!kernelNodes[i]->CaptureAqlPacket(queue, &aqlPackets_[captured.packetOffset_],
+                                          kernArgPool_ + captured.kernArgOffset_)) {
+      ClPrint(amd::LOG_INFO, amd::LOG_CODE,
+              "[hipGraph] AQL packet capture failed for node %p, fallback to commands\n",
+              kernelNodes[i]);
+      ReleaseAqlPackets();
+      return false;
+    }
+    capturedPackets_[kernelNodes[i]] = captured;
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Captured %zu AQL packets for graph exec %p\n",
+          kernelNodes.size(), this);
+  return true;
+}
+
+hipError_t hipGraphExec::RunAqlPackets(amd::HostQueue* queue) {
+  amd::Command* command = new amd::AccumulateCommand(
+      *queue, {}, aqlPackets_.data(), aqlPackets_.size() / amd::kAqlPacketSize);
+  if (command == nullptr) {
+    return hipErrorOutOfMemory;
+  }
+  command->enqueue();
+  // The last launch is tracked, since all launches share the same kernel arguments
+  if (lastEnqueuedCommand_ != nullptr) {
+    lastEnqueuedCommand_->release();
+  }
+  lastEnqueuedCommand_ = command;
+  return hipSuccess;
+}
+
+void hipGraphExec::ReleaseAqlPackets() {
+  if (lastEnqueuedCommand_ != nullptr) {
+    lastEnqueuedCommand_->awaitCompletion();
+    lastEnqueuedCommand_->release();
+    lastEnqueuedCommand_ = nullptr;
+  }
+  if (kernArgPool_ != nullptr) {
+    capturedQueue_->device().hostFree(kernArgPool_, kernArgPoolSize_);
+    kernArgPool_ = nullptr;
+    kernArgPoolSize_ = 0;
+  }
+  aqlPackets_.clear();
+  capturedPackets_.clear();
+  capturedQueue_ = nullptr;
+}
+
+void hipGraphExec::UpdateAqlPacket(Node node) {
+  if (capturedQueue_ == nullptr) {
+    return;
+  }
+  auto it = capturedPackets_.find(node);
+  if (it == capturedPackets_.end()) {
+    InvalidateAqlPackets();
+    return;
+  }
+  hipGraphKernelNode* kernelNode = static_cast<hipGraphKernelNode*>(node);
+  const CapturedPacket& captured = it->second;
+  size_t size = 0;
+  size_t alignment = 0;
+  kernelNode->GetKernargSegment(capturedQueue_->device(), size, alignment);
+  // A new function may require a bigger or a differently aligned kernel arguments segment
+  if ((size > captured.kernArgSize_) ||
+      ((captured.kernArgOffset_ % std::max<size_t>(alignment, 1)) != 0)) {
+    InvalidateAqlPackets();
+    return;
+  }
+  // The launches in flight read the same packets and kernel arguments
+  if (lastEnqueuedCommand_ != nullptr) {
+    lastEnqueuedCommand_->awaitCompletion();
+    lastEnqueuedCommand_->release();
+    lastEnqueuedCommand_ = nullptr;
+  }
+  if (!kernelNode->CaptureAqlPacket(capturedQueue_, &aqlPackets_[captured.packetOffset_],
+                                    kernArgPool_ + captured.kernArgOffset_)) {
+    InvalidateAqlPackets();
+  }
+}
+
 hipError_t hipGraphExec::Run(hipStream_t stream) {
   hipError_t status;
   amd::HostQueue* queue = hip::getQueue(stream);
   if (queue == nullptr) {
     return hipErrorInvalidResourceHandle;
   }
-  UpdateQueue(parallelLists_, queue, this);
+  if (HIP_GRAPH_PACKET_CAPTURE && !packetCaptureFailed_) {
+    // Packets are captured on the first launch, since hidden arguments may depend on the queue
+    if (capturedQueue_ == nullptr) {
+      packetCaptureFailed_ = !IsPacketCaptureEligible() || !CaptureAqlPackets(queue);
+    }
+    if (capturedQueue_ == queue) {
+      return RunAqlPackets(queue);
+    }
+  }
+  if (singleQueueLaunch_) {
+    return RunSingleQueue(queue, stream);
+  }
+  UpdateQueues(queue);
   std::vector<amd::Command*> rootCommands;
   amd::Command* endCommand = nullptr;
   status =
@@ -43,6 +43,59 @@ hipError_t FillCommands(std::vector<std::vector<Node>>& parallelLists,
 void UpdateQueue(std::vector<std::vector<Node>>& parallelLists, amd::HostQueue*& queue,
                  hipGraphExec* ptr);
 
+struct ihipGraph;
+
+/// Set of live objects, sharded by address so threads working on different objects don't
+/// serialize on one lock
+template <typename T> class hipGraphObjectRegistry {
+  static constexpr size_t kNumShards = 32;
+  struct Shard {
+    amd::Monitor lock_{"Guards graph registry shard"};
+    std::unordered_set<const T*> objects_;
+  };
+  Shard shards_[kNumShards];
+
+  Shard& GetShard(const T* object) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(object);
+    return shards_[((address >> 4) ^ (address >> 12)) % kNumShards];
+  }
+
+ public:
+  void Insert(const T* object) {
+    Shard& shard = GetShard(object);
+    amd::ScopedLock lock(shard.lock_);
+    shard.objects_.insert(object);
+  }
+  void Erase(const T* object) {
+    Shard& shard = GetShard(object);
+    amd::ScopedLock lock(shard.lock_);
+    shard.objects_.erase(object);
+  }
+  bool Contains(const T* object) {
+    Shard& shard = GetShard(object);
+    amd::ScopedSharedLock lock(shard.lock_);
+    return shard.objects_.find(object) != shard.objects_.end();
+  }
+};
+
+/// Bump allocator for the nodes of a captured graph, the memory is released with the graph
+class hipGraphNodeArena {
+  static constexpr size_t kChunkSize = 64 * Ki;
+  amd::Monitor lock_;          //!< Streams may capture into the same graph from many threads
+  std::vector<char*> chunks_;  //!< Allocated memory chunks
+  size_t offset_;              //!< Offset of the free space in the last chunk
+
+ public:
+  hipGraphNodeArena() : lock_("Guards graph node arena"), offset_(kChunkSize) {}
+  ~hipGraphNodeArena() {
+    for (auto chunk : chunks_) {
+      ::free(chunk);
+    }
+  }
+  /// Returns memory for a node, nullptr if out of memory
+  void* Alloc(size_t size);
+};
+
 struct hipGraphNode {
  protected:
   amd::HostQueue* queue_;
@@ -59,11 +112,18 @@ struct hipGraphNode {
   size_t outDegree_;
   static int nextID;
   struct ihipGraph* parentGraph_;
-  static std::unordered_set<hipGraphNode*> nodeSet_;
-  static amd::Monitor nodeSetLock_;
+  static hipGraphObjectRegistry<hipGraphNode> nodeSet_;
   hipKernelNodeAttrValue kernelAttr_;
+  // Every node is prefixed with the arena it came from, nullptr for the heap nodes
+  static constexpr size_t kNodeHeaderSize = alignof(std::max_align_t);
 
  public:
+  /// Allocates the node from the arena of the graph, or from the heap if the graph has no arena
+  static void* operator new(size_t size, ihipGraph* graph) noexcept;
+  static void* operator new(size_t size) noexcept { return operator new(size, nullptr); }
+  static void operator delete(void* ptr) noexcept;
+  static void operator delete(void* ptr, ihipGraph* graph) noexcept { operator delete(ptr); }
+
   hipGraphNode(hipGraphNodeType type)
       : type_(type),
         level_(0),
@@ -72,8 +132,7 @@ struct hipGraphNode {
         outDegree_(0),
         id_(nextID++),
         parentGraph_(nullptr) {
-    amd::ScopedLock lock(nodeSetLock_);
-    nodeSet_.insert(this);
+    nodeSet_.Insert(this);
     memset(&kernelAttr_, 0, sizeof(kernelAttr_));
   }
   /// Copy Constructor
@@ -85,8 +144,7 @@ struct hipGraphNode {
     visited_ = false;
     id_ = node.id_;
     parentGraph_ = nullptr;
-    amd::ScopedLock lock(nodeSetLock_);
-    nodeSet_.insert(this);
+    nodeSet_.Insert(this);
   }
 
   virtual ~hipGraphNode() {
@@ -96,17 +154,12 @@ struct hipGraphNode {
     for (auto node : dependencies_) {
       node->RemoveEdge(this);
     }
-    amd::ScopedLock lock(nodeSetLock_);
-    nodeSet_.erase(this);
+    nodeSet_.Erase(this);
   }
 
   // check node validity
   static bool isNodeValid(hipGraphNode* pGraphNode) {
-    amd::ScopedLock lock(nodeSetLock_);
-    if (nodeSet_.find(pGraphNode) == nodeSet_.end()) {
-      return false;
-    }
-    return true;
+    return nodeSet_.Contains(pGraphNode);
   }
 
   amd::HostQueue* GetQueue() { return queue_; }
@@ -175,8 +228,11 @@ struct hipGraphNode {
       edge->UpdateEdgeLevel();
     }
   }
+  /// Drops cached traversals of the parent graph after an edge change
+  void InvalidateTopology();
   /// Add edge, update parent node outdegree, child node indegree, level and dependency
   void AddEdge(const Node& childNode) {
+    InvalidateTopology();
     edges_.push_back(childNode);
     outDegree_++;
     childNode->SetInDegree(childNode->GetInDegree() + 1);
@@ -193,6 +249,7 @@ struct hipGraphNode {
       // Should come here if childNode is not present in the edge list
       return false;
     }
+    InvalidateTopology();
     edges_.erase(it, edges_.end());
     outDegree_--;
     childNode->SetInDegree(childNode->GetInDegree() - 1);
@@ -219,6 +276,10 @@ struct hipGraphNode {
     }
   }
   virtual size_t GetNumParallelQueues() { return 0; }
+  /// Returns estimated cost of the node work, used to balance the graph branches between queues
+  virtual size_t GetCost() const { return 1; }
+  /// Extends the node work with the work of the provided node, if both fit in one dispatch
+  virtual bool Merge(const hipGraphNode* node) { return false; }
   /// Enqueue commands part of the node
   virtual void EnqueueCommands(hipStream_t stream) {
     for (auto& command : commands_) {
@@ -235,26 +296,47 @@ struct hipGraphNode {
 struct ihipGraph {
   std::vector<Node> vertices_;
   const ihipGraph* pOriginalGraph_ = nullptr;
-  static std::unordered_set<ihipGraph*> graphSet_;
-  static amd::Monitor graphSetLock_;
+  static hipGraphObjectRegistry<ihipGraph> graphSet_;
+  hipGraphNodeArena* nodeArena_ = nullptr;
+  // Traversals of the graph, reused by instantiations and clones until the structure changes
+  struct Topology {
+    uint64_t version_ = 0;
+    bool valid_ = false;
+    std::vector<Node> levelOrder_;
+    std::vector<std::vector<Node>> parallelLists_;
+    std::unordered_map<Node, std::vector<Node>> dependencies_;
+  };
+  uint64_t version_ = 0;  //!< Incremented on every node or edge change
+  Topology topology_;
+
+  void ComputeLevelOrder(std::vector<Node>& levelOrder);
 
  public:
   ihipGraph() {
-    amd::ScopedLock lock(graphSetLock_);
-    graphSet_.insert(this);
+    graphSet_.Insert(this);
   };
 
   ~ihipGraph() {
     for (auto node : vertices_) {
       delete node;
     }
-    amd::ScopedLock lock(graphSetLock_);
-    graphSet_.erase(this);
+    // Nodes are destroyed above, the arena only returns their memory
+    delete nodeArena_;
+    graphSet_.Erase(this);
   };
 
   // check graphs validity
   static bool isGraphValid(ihipGraph* pGraph);
 
+  /// Allocates the nodes added to the graph from an arena, used by stream capture
+  void EnableNodeArena() {
+    if (nodeArena_ == nullptr) {
+      nodeArena_ = new hipGraphNodeArena();
+    }
+  }
+  /// Returns the node arena, nullptr if the nodes are allocated from the heap
+  hipGraphNodeArena* GetNodeArena() const { return nodeArena_; }
+
   /// add node to the graph
   void AddNode(const Node& node);
   void RemoveNode(const Node& node);
@@ -281,6 +363,14 @@ struct ihipGraph {
   void GetRunList(std::vector<std::vector<Node>>& parallelLists,
                   std::unordered_map<Node, std::vector<Node>>& dependencies);
   void LevelOrder(std::vector<Node>& levelOrder);
+  /// Returns level order and run lists of the graph nodes, computed once per graph structure
+  const Topology& GetTopology();
+  /// Marks the cached traversals as stale
+  void InvalidateTopology() { ++version_; }
+  /// Recomputes node levels as the longest path from the root nodes
+  void UpdateLevels();
+  /// Merges contiguous memset and memcpy nodes, fused nodes are removed from clonedNodes
+  void FuseNodes(std::unordered_map<Node, Node>& clonedNodes);
   ihipGraph* clone(std::unordered_map<Node, Node>& clonedNodes) const;
   ihipGraph* clone() const;
 };
@@ -291,11 +381,25 @@ struct hipGraphExec {
   std::vector<Node> levelOrder_;
   std::unordered_map<Node, std::vector<Node>> nodeWaitLists_;
   std::vector<amd::HostQueue*> parallelQueues_;
+  std::vector<size_t> branchQueues_;  //!< Queue index of every parallel list
+  size_t numBranchQueues_;            //!< Number of queues shared by the parallel lists
+  bool singleQueueLaunch_;            //!< All nodes are launched in order on the launch queue
   uint currentQueueIndex_;
   std::unordered_map<Node, Node> clonedNodes_;
   amd::Command* lastEnqueuedCommand_;
-  static std::unordered_set<hipGraphExec*> graphExecSet_;
-  static amd::Monitor graphExecSetLock_;
+  static hipGraphObjectRegistry<hipGraphExec> graphExecSet_;
+  // AQL packets captured for the replay, used with HIP_GRAPH_PACKET_CAPTURE only
+  struct CapturedPacket {
+    size_t packetOffset_;   //!< Offset of the node packet in the packet block
+    size_t kernArgOffset_;  //!< Offset of the node kernel arguments in the pool
+    size_t kernArgSize_;    //!< Size of the kernel arguments reserved for the node
+  };
+  std::unordered_map<Node, CapturedPacket> capturedPackets_;
+  std::vector<uint8_t> aqlPackets_;
+  address kernArgPool_;             //!< Kernel arguments of the captured packets
+  size_t kernArgPoolSize_;          //!< Size of the kernel arguments pool
+  amd::HostQueue* capturedQueue_;   //!< Queue the packets were captured for
+  bool packetCaptureFailed_;        //!< The graph can't be replayed from the captured packets
 
  public:
   hipGraphExec(std::vector<Node>& levelOrder, std::vector<std::vector<Node>>& lists,
@@ -306,20 +410,27 @@ struct hipGraphExec {
         nodeWaitLists_(nodeWaitLists),
         clonedNodes_(clonedNodes),
         lastEnqueuedCommand_(nullptr),
-        currentQueueIndex_(0) {
-    amd::ScopedLock lock(graphExecSetLock_);
-    graphExecSet_.insert(this);
+        numBranchQueues_(0),
+        singleQueueLaunch_(false),
+        currentQueueIndex_(0),
+        kernArgPool_(nullptr),
+        kernArgPoolSize_(0),
+        capturedQueue_(nullptr),
+        packetCaptureFailed_(false) {
+    graphExecSet_.Insert(this);
   }
 
   ~hipGraphExec() {
+    // The captured packets and kernel arguments are shared between all launches
+    ReleaseAqlPackets();
     // new commands are launched for every launch they are destroyed as and when command is
     // terminated after it complete execution
     for (auto queue : parallelQueues_) {
       queue->release();
     }
-    for (auto it = clonedNodes_.begin(); it != clonedNodes_.end(); it++) delete it->second;
-    amd::ScopedLock lock(graphExecSetLock_);
-    graphExecSet_.erase(this);
+    // clonedNodes_ doesn't track the nodes merged at instantiation
+    for (auto node : levelOrder_) delete node;
+    graphExecSet_.Erase(this);
   }
 
   Node GetClonedNode(Node node) {
@@ -341,7 +452,30 @@ struct hipGraphExec {
   void ResetQueueIndex() { currentQueueIndex_ = 0; }
   hipError_t Init();
   hipError_t CreateQueues(size_t numQueues);
+  /// Distributes the parallel lists between a bounded number of queues
+  void ScheduleBranches();
+  /// Assigns the launch queue and the scheduled branch queues to the graph nodes
+  void UpdateQueues(amd::HostQueue* queue);
   hipError_t Run(hipStream_t stream);
+  /// Returns true if the graph can be launched in level order on a single queue
+  bool IsSingleQueueEligible() const;
+  /// Launches all nodes on the provided queue without cross-queue dependencies
+  hipError_t RunSingleQueue(amd::HostQueue* queue, hipStream_t stream);
+  /// Returns true if the graph can be replayed from the captured AQL packets
+  bool IsPacketCaptureEligible() const;
+  /// Builds AQL packets and kernel arguments of all graph nodes for the provided queue
+  bool CaptureAqlPackets(amd::HostQueue* queue);
+  /// Submits the captured AQL packets into the queue
+  hipError_t RunAqlPackets(amd::HostQueue* queue);
+  /// Waits for the last replay and releases the captured packets
+  void ReleaseAqlPackets();
+  /// Drops the captured packets after a node update, the next launch will capture them again
+  void InvalidateAqlPackets() {
+    ReleaseAqlPackets();
+    packetCaptureFailed_ = false;
+  }
+  /// Rewrites the captured packet and kernel arguments of the updated kernel node in place
+  void UpdateAqlPacket(Node node);
 };
 struct hipChildGraphNode : public hipGraphNode {
   struct ihipGraph* childGraph_;
@@ -750,6 +884,58 @@ class hipGraphKernelNode : public hipGraphNode {
     const hipGraphKernelNode* kernelNode = static_cast<hipGraphKernelNode const*>(node);
     return SetParams(kernelNode->pKernelParams_);
   }
+
+  /// Returns the size and the alignment of the kernel arguments segment
+  void GetKernargSegment(const amd::Device& device, size_t& size, size_t& alignment) const {
+    hip::DeviceFunc* function = hip::DeviceFunc::asFunction(func_);
+    const device::Kernel* devKernel = function->kernel()->getDeviceKernel(device);
+    size = devKernel->KernargSegmentByteSize();
+    alignment = devKernel->KernargSegmentAlignment();
+  }
+
+  /// Returns true if the node launches the same function with the same arguments as \a node
+  bool HasEqualParams(const hipGraphKernelNode* node) const {
+    const hipKernelNodeParams* params = node->pKernelParams_;
+    if ((func_ != node->func_) || (numParams_ != node->numParams_) ||
+        (params->sharedMemBytes != pKernelParams_->sharedMemBytes) ||
+        (params->gridDim.x != pKernelParams_->gridDim.x) ||
+        (params->gridDim.y != pKernelParams_->gridDim.y) ||
+        (params->gridDim.z != pKernelParams_->gridDim.z) ||
+        (params->blockDim.x != pKernelParams_->blockDim.x) ||
+        (params->blockDim.y != pKernelParams_->blockDim.y) ||
+        (params->blockDim.z != pKernelParams_->blockDim.z)) {
+      return false;
+    }
+    if ((params->kernelParams != nullptr) && (pKernelParams_->kernelParams != nullptr)) {
+      const amd::KernelSignature& signature =
+          hip::DeviceFunc::asFunction(func_)->kernel()->signature();
+      for (uint32_t i = 0; i < numParams_; ++i) {
+        if (::memcmp(params->kernelParams[i], pKernelParams_->kernelParams[i],
+                     signature.at(i).size_) != 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+    if ((params->extra != nullptr) && (pKernelParams_->extra != nullptr)) {
+      size_t size = *reinterpret_cast<size_t*>(params->extra[3]);
+      return (size == *reinterpret_cast<size_t*>(pKernelParams_->extra[3])) &&
+             (::memcmp(params->extra[1], pKernelParams_->extra[1], size) == 0);
+    }
+    return false;
+  }
+
+  /// Kernel cost is estimated by the number of workgroups
+  size_t GetCost() const {
+    return static_cast<size_t>(pKernelParams_->gridDim.x) * pKernelParams_->gridDim.y *
+           pKernelParams_->gridDim.z;
+  }
+
+  /// Returns true if the node requires a cooperative launch
+  bool IsCooperative() const { return kernelAttr_.cooperative != 0; }
+
+  /// Builds the AQL packet and the kernel arguments of the node without the submission
+  bool CaptureAqlPacket(amd::HostQueue* queue, address packet, address kernArgs);
 };
 
 class hipGraphMemcpyNode : public hipGraphNode {
@@ -856,6 +1042,35 @@ class hipGraphMemcpyNode1D : public hipGraphNode {
     return SetParams(memcpy1DNode->dst_, memcpy1DNode->src_, memcpy1DNode->count_,
                      memcpy1DNode->kind_);
   }
+  /// Merges device to device copies of contiguous, non overlapping ranges
+  bool Merge(const hipGraphNode* node) {
+    const hipGraphMemcpyNode1D* copyNode = dynamic_cast<const hipGraphMemcpyNode1D*>(node);
+    if ((GetType() != hipGraphNodeTypeMemcpy) || (copyNode == nullptr) ||
+        (node->GetType() != hipGraphNodeTypeMemcpy) || (kind_ != hipMemcpyDeviceToDevice) ||
+        (copyNode->kind_ != hipMemcpyDeviceToDevice)) {
+      return false;
+    }
+    const char* src = static_cast<const char*>(src_);
+    const char* dst = static_cast<const char*>(dst_);
+    const char* nodeSrc = static_cast<const char*>(copyNode->src_);
+    const char* nodeDst = static_cast<const char*>(copyNode->dst_);
+    if ((nodeDst + copyNode->count_ == dst) && (nodeSrc + copyNode->count_ == src)) {
+      src = nodeSrc;
+      dst = nodeDst;
+    } else if ((dst + count_ != nodeDst) || (src + count_ != nodeSrc)) {
+      return false;
+    }
+    size_t count = count_ + copyNode->count_;
+    // A single copy can't read the data written by the other one
+    if ((src < dst + count) && (dst < src + count)) {
+      return false;
+    }
+    src_ = src;
+    dst_ = const_cast<char*>(dst);
+    count_ = count;
+    return true;
+  }
+
   // ToDo: use this when commands are cloned and command params are to be updated
   hipError_t SetCommandParams(void* dst, const void* src, size_t count, hipMemcpyKind kind);
   hipError_t ValidateParams(void* dst, const void* src, size_t count, hipMemcpyKind kind);
@@ -1107,6 +1322,28 @@ class hipGraphMemsetNode : public hipGraphNode {
     const hipGraphMemsetNode* memsetNode = static_cast<hipGraphMemsetNode const*>(node);
     return SetParams(memsetNode->pMemsetParams_);
   }
+
+  /// Merges 1D memsets of adjacent ranges with the same value
+  bool Merge(const hipGraphNode* node) {
+    if (node->GetType() != hipGraphNodeTypeMemset) {
+      return false;
+    }
+    const hipMemsetParams* params = static_cast<const hipGraphMemsetNode*>(node)->pMemsetParams_;
+    if ((pMemsetParams_->height != 1) || (params->height != 1) ||
+        (pMemsetParams_->elementSize != params->elementSize) ||
+        (pMemsetParams_->value != params->value)) {
+      return false;
+    }
+    const char* dst = static_cast<const char*>(pMemsetParams_->dst);
+    const char* nodeDst = static_cast<const char*>(params->dst);
+    if (nodeDst + params->width * params->elementSize == dst) {
+      pMemsetParams_->dst = params->dst;
+    } else if (dst + pMemsetParams_->width * pMemsetParams_->elementSize != nodeDst) {
+      return false;
+    }
+    pMemsetParams_->width += params->width;
+    return true;
+  }
 };
 
 class hipGraphEventRecordNode : public hipGraphNode {
@@ -62,6 +62,7 @@ static_assert(static_cast<uint32_t>(hipMemRangeAttributeLastPrefetchLocation) ==
 // ================================================================================================
 hipError_t hipMallocManaged(void** dev_ptr, size_t size, unsigned int flags) {
   HIP_INIT_API(hipMallocManaged, dev_ptr, size, flags);
+  amd::MemoryStats::Scope memScope(amd::MemoryStats::Managed);
 
   if ((dev_ptr == nullptr) || (size == 0) ||
       ((flags != hipMemAttachGlobal) && (flags != hipMemAttachHost))) {
@@ -74,6 +74,21 @@ hipError_t hipRemoveActivityCallback(uint32_t id) {
   return callbacks_table.set_activity(id, NULL, NULL) ? hipSuccess : hipErrorInvalidValue;
 }
 
+extern "C" hipError_t hipGetApiSampleCount(uint32_t id, uint64_t* calls, uint64_t* sampled) {
+  if (calls == nullptr || sampled == nullptr) {
+    return hipErrorInvalidValue;
+  }
+  return callbacks_table.get_sample_count(id, calls, sampled) ? hipSuccess : hipErrorInvalidValue;
+}
+
+extern "C" hipError_t hipGetActivitySampleCount(uint32_t op, uint64_t* total, uint64_t* sampled) {
+  if (total == nullptr || sampled == nullptr) {
+    return hipErrorInvalidValue;
+  }
+  return activity_prof::ActivityProf::GetSampleCount(op, total, sampled) ? hipSuccess :
+                                                                            hipErrorInvalidValue;
+}
+
 hipError_t hipEnableTracing(bool enabled) {
   callbacks_table.set_enabled(enabled);
   return hipSuccess;
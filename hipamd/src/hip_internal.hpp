@@ -29,8 +29,10 @@
 #include "hip_graph_capture.hpp"
 
 #include <unordered_set>
+#include <map>
 #include <thread>
 #include <stack>
+#include <tuple>
 #include <mutex>
 #include <iterator>
 #ifdef _WIN32
@@ -48,6 +50,35 @@
 #define KCYN "\x1B[36m"
 #define KWHT "\x1B[37m"
 
+/*! hipStreamCreateWithFlags extension flags, selecting the submission batching policy.
+ *  The value of the count and time policies is encoded in bits 8..27 */
+#ifndef hipExtStreamBatchImmediate
+#define hipExtStreamBatchImmediate    0x10000000
+#define hipExtStreamBatchCount(n)     (0x20000000 | (((n) & 0xfffff) << 8))
+#define hipExtStreamBatchTime(us)     (0x30000000 | (((us) & 0xfffff) << 8))
+#endif
+#define IHIP_STREAM_BATCH_MODE_MASK   0x30000000
+#define IHIP_STREAM_BATCH_VALUE_MASK  0x0fffff00
+#define IHIP_STREAM_BATCH_VALUE_SHIFT 8
+
+/*! hipHostMalloc extension flag, backing the allocation with the huge pages.
+ *  The size is ROC_HOST_HUGE_PAGES MB or 2MB, the regular pages are used if none are available */
+#ifndef hipExtHostMallocHugePages
+#define hipExtHostMallocHugePages     0x08000000
+#endif
+
+/*! hipHostMalloc extension flags, placing the allocation on a CPU NUMA node, on the node
+ *  closest to a device or interleaved across the nodes. The bits 8-15 have the node or the device */
+#ifndef hipExtHostMallocNumaNode
+#define hipExtHostMallocNumaNode(n)     (0x04000000 | (((n) & 0xff) << 8))
+#define hipExtHostMallocNumaDevice(d)   (0x02000000 | (((d) & 0xff) << 8))
+#define hipExtHostMallocNumaInterleave  0x01000000
+#endif
+#define IHIP_HOST_MALLOC_NUMA_NODE      0x04000000
+#define IHIP_HOST_MALLOC_NUMA_DEVICE    0x02000000
+#define IHIP_HOST_MALLOC_NUMA_MASK      0x0700ff00
+#define IHIP_HOST_MALLOC_NUMA_VALUE(flags) (((flags) >> 8) & 0xff)
+
 /*! IHIP IPC MEMORY Structure */
 #define IHIP_IPC_MEM_HANDLE_SIZE   32
 #define IHIP_IPC_MEM_RESERVED_SIZE LP64_SWITCH(24,16)
@@ -109,6 +140,7 @@ static  amd::Monitor g_hipInitlock{"hipInit lock"};
           __func__, ihipGetErrorName(err), ToString( __VA_ARGS__ ).c_str());
 
 #define HIP_INIT_API_INTERNAL(noReturn, cid, ...)            \
+  hip::ApiLatency apiLatency;                                \
   HIP_API_PRINT(__VA_ARGS__)                                 \
   amd::Thread* thread = amd::Thread::current();              \
   if (!VDI_CHECK_THREAD(thread) && !noReturn) {              \
@@ -267,8 +299,14 @@ namespace hip {
     /// Returns the CU mask for the current stream
     const std::vector<uint32_t> GetCUMask() const { return cuMask_; }
 
-    /// Sync all non-blocking streams
-    static void syncNonBlockingStreams(int deviceId);
+    /// Sync all non-blocking streams and \p nullQueue together
+    static void syncNonBlockingStreams(int deviceId, amd::HostQueue* nullQueue = nullptr);
+
+    /// Sync all streams and the null streams of all devices together
+    static void syncAllStreams();
+
+    /// Retains the last queued commands of all streams on a given device
+    static void lastQueuedCommands(int deviceId, std::vector<amd::Command*>* commands);
 
     /// Destroy all streams on a given device
     static void destroyAllStreams(int deviceId);
@@ -359,7 +397,76 @@ namespace hip {
 
     std::set<MemoryPool*> mem_pools_;
 
+    /// Low priority thread, which releases retired pool memory off the application threads
+    class ReclaimThread : public amd::Thread {
+    public:
+      ReclaimThread() : amd::Thread("Memory Pool Reclaim Thread", CQ_THREAD_STACK_SIZE) {}
+
+      //! The reclaim thread entry point
+      void run(void* data) { reinterpret_cast<Device*>(data)->ReclaimLoop(); }
+    };
+    ReclaimThread* reclaim_thread_ = nullptr;
+    std::atomic<bool> reclaim_stop_{false};  //!< Requests the reclaim thread to exit
+
+    /// Periodically releases freed memory above the release threshold from all pools
+    void ReclaimLoop();
+
+    /// Memory, freed with hipFree, and the queue positions it waits for
+    struct DeferredFree {
+      amd::Memory* memory_;                  //!< Freed memory object
+      std::vector<amd::Command*> commands_;  //!< The last commands of the queues at the free
+      bool notified_;                        //!< The queues were notified about the status check
+    };
+    std::list<DeferredFree> deferred_frees_;  //!< Memory, waiting for the release
+    amd::Monitor deferred_lock_{"Deferred free lock"};
+
+    /// Physical memory of released hipMemCreate handles, kept for reuse by the size
+    std::multimap<size_t, void*> vmm_pool_;
+    size_t vmm_pool_size_ = 0;  //!< The total size of the memory in the pool
+    amd::Monitor vmm_lock_{"VMM pool lock"};
+
   public:
+    /// Creation parameters of a host queue: priority, stream flags, properties and CU mask
+    using QueueKey = std::tuple<int, unsigned int, cl_command_queue_properties,
+                                std::vector<uint32_t>>;
+
+  private:
+    /// Idle host queues of destroyed streams, kept for reuse by the creation parameters
+    std::multimap<QueueKey, amd::HostQueue*> queue_pool_;
+    amd::Monitor queue_pool_lock_{"Queue pool lock"};
+
+    /// Fine grain chunks, sub-allocated into the slots of the texture and surface objects
+    std::vector<void*> srd_chunks_;
+    std::vector<void*> srd_free_;  //!< The slots, available for a new object
+    /// Slot of a destroyed object and the queue positions, which may still read it
+    struct RetiredSrd {
+      void* slot_;
+      std::vector<amd::Command*> commands_;
+    };
+    std::list<RetiredSrd> srd_retired_;
+    amd::Monitor srd_lock_{"SRD heap lock"};
+
+    /// Pinned chunk of the staging ring for the pageable copies of hipMemcpyAsync
+    struct StagingChunk {
+      address ptr_;                          //!< Pinned host memory
+      size_t size_;                          //!< Size of the chunk
+      size_t offset_;                        //!< The next free byte
+      uint32_t pending_;                     //!< Allocated spans without the tracked command
+      std::vector<amd::Command*> commands_;  //!< The commands, which access the chunk
+    };
+    std::vector<StagingChunk> staging_chunks_;
+    size_t staging_current_ = 0;  //!< The chunk of the next allocation
+    size_t staging_size_ = 0;     //!< The total size of all chunks
+    amd::Monitor staging_lock_{"Pageable staging lock"};
+
+  public:
+    /// Slot size for the texture and surface objects in the SRD heap
+    static constexpr size_t kSrdSlotSize = 512;
+    /// Size of the fine grain allocation, split into the SRD slots
+    static constexpr size_t kSrdChunkSize = 64 * Ki;
+    /// Granularity of the chunks of the pageable staging ring
+    static constexpr size_t kStagingChunkSize = 4 * Mi;
+
     Device(amd::Context* ctx, int devId): context_(ctx),
         deviceId_(devId),
         null_stream_(this, Stream::Priority::Normal, 0, true),
@@ -434,12 +541,58 @@ namespace hip {
     /// Remove memory pool from the device
     void RemoveMemoryPool(MemoryPool* pool);
 
-    /// Free memory from the device
-    bool FreeMemory(amd::Memory* memory, Stream* stream);
+    /// Free memory from the device, offset locates sub allocations inside the memory object
+    bool FreeMemory(amd::Memory* memory, Stream* stream, size_t offset = 0);
 
     /// Release freed memory from all pools on the current device
     void ReleaseFreedMemory(Stream* stream);
 
+    /// Releases retired memory above the release threshold without blocking on busy pools
+    void ReclaimFreedMemory();
+
+    /// Takes the memory reference and releases it after the device completes the current work
+    void DeferFree(amd::Memory* memory);
+
+    /// Releases the deferred memory with completed work, or all of it if wait is true
+    void ReleaseDeferredFrees(bool wait = false);
+
+    /// Returns physical memory of the size from the VMM pool, or nullptr if none is cached
+    void* AllocPhysicalMemory(size_t size);
+
+    /// Keeps the released physical memory for reuse, returns false if the pool is full
+    bool CachePhysicalMemory(void* ptr, size_t size);
+
+    /// Frees all memory in the VMM pool, returns false if the pool was empty
+    bool ReleasePhysicalMemory();
+
+    /// Returns an idle host queue with the parameters, or nullptr if none is cached
+    amd::HostQueue* AcquirePooledQueue(const QueueKey& key);
+
+    /// Keeps the host queue of a destroyed stream for reuse, returns false if the pool is full
+    bool PoolQueue(const QueueKey& key, amd::HostQueue* queue);
+
+    /// Releases all idle host queues in the pool
+    void ReleasePooledQueues();
+
+    /// Returns a slot of kSrdSlotSize bytes for a texture or surface object, nullptr on failure
+    void* AllocSrd();
+
+    /// Retires the slot until the device completes the current work, false if it isn't in the heap
+    bool FreeSrd(void* ptr);
+
+    /// Waits for the retired slots and frees all chunks of the SRD heap
+    void ReleaseSrdHeap();
+
+    /// Returns pinned staging memory for a pageable copy, nullptr if the ring is full.
+    /// The caller must pass the copy command of the returned chunk to TrackStaging()
+    void* AllocStaging(size_t size, size_t* chunk);
+
+    /// Keeps the span of the chunk busy until the command completes, nullptr drops the span
+    void TrackStaging(size_t chunk, amd::Command* command);
+
+    /// Waits for the copies and frees all chunks of the staging ring
+    void ReleaseStaging();
+
     /// Removes a destroyed stream from the safe list of memory pools
     void RemoveStreamFromPools(Stream* stream);
   };
@@ -454,6 +607,21 @@ namespace hip {
 
   extern Device* getCurrentDevice();
 
+  /// Records the API latency on the current device at the scope exit
+  class ApiLatency {
+   public:
+    ApiLatency() : start_(amd::LatencyStats::start()) {}
+    ~ApiLatency() {
+      // The API may fail before the runtime initialization, hence the device check
+      if ((start_ != 0) && (g_device != nullptr)) {
+        g_device->devices()[0]->latencyStats().record(amd::LatencyStats::Api, start_);
+      }
+    }
+
+   private:
+    uint64_t start_;  //!< API entry time
+  };
+
   extern void setCurrentDevice(unsigned int index);
 
   /// Get ROCclr queue associated with hipStream
@@ -489,7 +657,7 @@ extern std::vector<hip::Device*> g_devices;
 extern hipError_t ihipDeviceGetCount(int* count);
 extern int ihipGetDevice();
 
-extern hipError_t ihipMalloc(void** ptr, size_t sizeBytes, unsigned int flags);
+extern hipError_t ihipMalloc(void** ptr, size_t sizeBytes, cl_mem_flags flags);
 extern amd::Memory* getMemoryObject(const void* ptr, size_t& offset, size_t size = 0);
 extern amd::Memory* getMemoryObjectWithOffset(const void* ptr, const size_t size);
 extern void getStreamPerThread(hipStream_t& stream);
@@ -27,6 +27,9 @@
 #include "platform/memory.hpp"
 #include "amdocl/cl_vk_amd.hpp"
 
+#include <codecvt>
+#include <locale>
+
 amd::Monitor hip::hipArraySetLock{"Guards global hipArray set"};
 std::unordered_set<hipArray*> hip::hipArraySet;
 
@@ -93,6 +96,15 @@ hipError_t ihipFree(void *ptr) {
     // Wait on the device, associated with the current memory object during allocation
     auto device_id = memory_object->getUserData().deviceId;
     auto dev = g_devices[device_id];
+    if (HIP_DEFERRED_FREE) {
+      // The pointer becomes invalid now, but the memory stays alive until the device
+      // completes the work, which was submitted before the free
+      memory_object->retain();
+      amd::SvmBuffer::free(memory_object->getContext(), ptr);
+      dev->DeferFree(memory_object);
+      dev->ReleaseDeferredFrees();
+      return hipSuccess;
+    }
     // Skip stream allocation, since if it wasn't allocated until free, then the device wasn't used
     constexpr bool SkipStreamAlloc = true;
     amd::HostQueue* queue = dev->NullStream(SkipStreamAlloc);
@@ -256,7 +268,7 @@ hipError_t hipDestroyExternalSemaphore(hipExternalSemaphore_t extSem)
 
 
 // ================================================================================================
-hipError_t ihipMalloc(void** ptr, size_t sizeBytes, unsigned int flags)
+hipError_t ihipMalloc(void** ptr, size_t sizeBytes, cl_mem_flags flags)
 {
   if (ptr == nullptr) {
     return hipErrorInvalidValue;
@@ -284,6 +296,26 @@ hipError_t ihipMalloc(void** ptr, size_t sizeBytes, unsigned int flags)
   *ptr = amd::SvmBuffer::malloc(*amdContext, flags, sizeBytes, dev_info.memBaseAddrAlign_,
               useHostDevice ? curDevContext->svmDevices()[0] : nullptr);
 
+  if ((*ptr == nullptr) && HIP_DEFERRED_FREE) {
+    // Wait for the memory, which is still waiting for the release after hipFree, and retry.
+    // Host memory is deferred on the device, which was current at the allocation
+    if (useHostDevice) {
+      for (auto device : g_devices) {
+        device->ReleaseDeferredFrees(true);
+      }
+    } else {
+      hip::getCurrentDevice()->ReleaseDeferredFrees(true);
+    }
+    *ptr = amd::SvmBuffer::malloc(*amdContext, flags, sizeBytes, dev_info.memBaseAddrAlign_,
+                useHostDevice ? curDevContext->svmDevices()[0] : nullptr);
+  }
+
+  if ((*ptr == nullptr) && !useHostDevice && hip::getCurrentDevice()->ReleasePhysicalMemory()) {
+    // Free the physical memory, cached for hipMemCreate, and retry
+    *ptr = amd::SvmBuffer::malloc(*amdContext, flags, sizeBytes, dev_info.memBaseAddrAlign_,
+                                  nullptr);
+  }
+
   if (*ptr == nullptr) {
     if (!useHostDevice) {
       size_t free = 0, total =0;
@@ -409,6 +441,102 @@ hipError_t ihipMemcpyCommand(amd::Command*& command, void* dst, const void* src,
   return hipSuccess;
 }
 
+// ================================================================================================
+struct PageableReadback {
+  void* dst_;           //!< Pageable destination
+  const void* staging_; //!< Pinned staging span with the device data
+  size_t size_;
+};
+
+// ================================================================================================
+void CL_CALLBACK ihipPageableReadback(cl_event event, cl_int command_exec_status,
+                                      void* user_data) {
+  PageableReadback* data = reinterpret_cast<PageableReadback*>(user_data);
+  memcpy(data->dst_, data->staging_, data->size_);
+  delete data;
+}
+
+// ================================================================================================
+//! Stages a pageable async copy in the pinned ring of the device, false runs the copy
+//! synchronously. The copies to the device snapshot the source before the return, the copies
+//! from the device finish in a stream callback, which blocks the stream until the host copy
+static bool ihipMemcpyPageableAsync(void* dst, const void* src, size_t sizeBytes,
+                                    amd::Memory& devMemory, amd::HostQueue& queue,
+                                    bool toDevice) {
+  // Only the copies of the queue device skip the wait, the others switch the queues
+  if ((devMemory.getContext().devices().size() != 1) ||
+      (devMemory.getContext().devices()[0] != &queue.device())) {
+    return false;
+  }
+  hip::Device* device = nullptr;
+  for (auto it : g_devices) {
+    if (it->devices()[0] == &queue.device()) {
+      device = it;
+      break;
+    }
+  }
+  size_t chunk = 0;
+  void* staging = (device != nullptr) ? device->AllocStaging(sizeBytes, &chunk) : nullptr;
+  if (staging == nullptr) {
+    return false;
+  }
+
+  amd::Command* command = nullptr;
+  if (toDevice) {
+    // The application may reuse the source after the return
+    memcpy(staging, src, sizeBytes);
+    if (ihipMemcpyCommand(command, dst, staging, sizeBytes, hipMemcpyHostToDevice, queue) !=
+        hipSuccess) {
+      device->TrackStaging(chunk, nullptr);
+      return false;
+    }
+    command->enqueue();
+    device->TrackStaging(chunk, command);
+    command->release();
+    return true;
+  }
+
+  if (ihipMemcpyCommand(command, staging, src, sizeBytes, hipMemcpyDeviceToHost, queue) !=
+      hipSuccess) {
+    device->TrackStaging(chunk, nullptr);
+    return false;
+  }
+  command->enqueue();
+  amd::Command::EventWaitList waitList = {command};
+  amd::Command* callback = new amd::Marker(queue, !kMarkerDisableFlush, waitList);
+  PageableReadback* data = new PageableReadback{dst, staging, sizeBytes};
+  if ((callback == nullptr) || (data == nullptr) ||
+      !callback->setCallback(CL_COMPLETE, ihipPageableReadback, data)) {
+    // Finish the copy on this thread
+    command->awaitCompletion();
+    memcpy(dst, staging, sizeBytes);
+    delete data;
+    if (callback != nullptr) {
+      callback->release();
+    }
+    command->release();
+    device->TrackStaging(chunk, nullptr);
+    return true;
+  }
+  callback->enqueue();
+  command->release();
+  // Stall the stream until the callback copies the data to the destination
+  waitList = {callback};
+  amd::Command* block = new amd::Marker(queue, !kMarkerDisableFlush, waitList);
+  if (block == nullptr) {
+    callback->awaitCompletion();
+    callback->release();
+    device->TrackStaging(chunk, nullptr);
+    return true;
+  }
+  block->enqueue();
+  callback->release();
+  // The staging span is free, once the blocking marker completes after the callback
+  device->TrackStaging(chunk, block);
+  block->release();
+  return true;
+}
+
 // ================================================================================================
 hipError_t ihipMemcpy(void* dst, const void* src, size_t sizeBytes, hipMemcpyKind kind,
                       amd::HostQueue& queue, bool isAsync = false) {
@@ -434,8 +562,16 @@ hipError_t ihipMemcpy(void* dst, const void* src, size_t sizeBytes, hipMemcpyKin
       return hipErrorInvalidValue;
     }
   } else if ((srcMemory == nullptr) && (dstMemory != nullptr)) {
+    if (isAsync && (HIP_PAGEABLE_ASYNC_COPY >= 1) &&
+        ihipMemcpyPageableAsync(dst, src, sizeBytes, *dstMemory, queue, true)) {
+      return hipSuccess;
+    }
     isAsync = false;
   } else if ((srcMemory != nullptr) && (dstMemory == nullptr)) {
+    if (isAsync && (HIP_PAGEABLE_ASYNC_COPY >= 2) &&
+        ihipMemcpyPageableAsync(dst, src, sizeBytes, *srcMemory, queue, false)) {
+      return hipSuccess;
+    }
     isAsync = false;
   }
   amd::Command* command = nullptr;
@@ -469,6 +605,7 @@ hipError_t ihipMemcpy(void* dst, const void* src, size_t sizeBytes, hipMemcpyKin
 // ================================================================================================
 hipError_t hipExtMallocWithFlags(void** ptr, size_t sizeBytes, unsigned int flags) {
   HIP_INIT_API(hipExtMallocWithFlags, ptr, sizeBytes, flags);
+  amd::MemoryStats::Scope memScope(amd::MemoryStats::Malloc);
 
   unsigned int ihipFlags = 0;
   if (flags == hipDeviceMallocDefault) {
@@ -498,12 +635,14 @@ hipError_t hipExtMallocWithFlags(void** ptr, size_t sizeBytes, unsigned int flag
 hipError_t hipMalloc(void** ptr, size_t sizeBytes) {
   HIP_INIT_API(hipMalloc, ptr, sizeBytes);
   CHECK_STREAM_CAPTURE_SUPPORTED();
+  amd::MemoryStats::Scope memScope(amd::MemoryStats::Malloc);
   HIP_RETURN_DURATION(ihipMalloc(ptr, sizeBytes, 0), (ptr != nullptr)? *ptr : nullptr);
 }
 
 hipError_t hipHostMalloc(void** ptr, size_t sizeBytes, unsigned int flags) {
   HIP_INIT_API(hipHostMalloc, ptr, sizeBytes, flags);
   CHECK_STREAM_CAPTURE_SUPPORTED();
+  amd::MemoryStats::Scope memScope(amd::MemoryStats::HostMalloc);
   if (ptr == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
   }
@@ -520,8 +659,9 @@ hipError_t hipHostMalloc(void** ptr, size_t sizeBytes, unsigned int flags) {
     HIP_RETURN(hipErrorInvalidValue);
   }
 
-  unsigned int ihipFlags = CL_MEM_SVM_FINE_GRAIN_BUFFER;
-  if (flags == 0 ||
+  cl_mem_flags ihipFlags = CL_MEM_SVM_FINE_GRAIN_BUFFER;
+  // The placement alone keeps the coherent default
+  if ((flags & ~IHIP_HOST_MALLOC_NUMA_MASK) == 0 ||
       flags & (hipHostMallocCoherent | hipHostMallocMapped | hipHostMallocNumaUser) ||
       (!(flags & hipHostMallocNonCoherent) && HIP_HOST_COHERENT)) {
     ihipFlags |= CL_MEM_SVM_ATOMICS;
@@ -531,10 +671,27 @@ hipError_t hipHostMalloc(void** ptr, size_t sizeBytes, unsigned int flags) {
     ihipFlags |= CL_MEM_FOLLOW_USER_NUMA_POLICY;
   }
 
+  if (flags & hipExtHostMallocHugePages) {
+    ihipFlags |= ROCCLR_MEM_HUGE_PAGES;
+  }
+
   if (flags & hipHostMallocNonCoherent) {
     ihipFlags &= ~CL_MEM_SVM_ATOMICS;
   }
 
+  if (flags & hipExtHostMallocNumaInterleave) {
+    ihipFlags |= ROCCLR_MEM_NUMA_INTERLEAVE;
+  } else if (flags & (IHIP_HOST_MALLOC_NUMA_NODE | IHIP_HOST_MALLOC_NUMA_DEVICE)) {
+    uint64_t node = IHIP_HOST_MALLOC_NUMA_VALUE(flags);
+    if (flags & IHIP_HOST_MALLOC_NUMA_DEVICE) {
+      if (node >= g_devices.size()) {
+        HIP_RETURN(hipErrorInvalidDevice);
+      }
+      node = g_devices[node]->devices()[0]->getPreferredNumaNode();
+    }
+    ihipFlags |= ROCCLR_MEM_NUMA_NODE | (node << ROCCLR_MEM_NUMA_NODE_SHIFT);
+  }
+
   hipError_t status = ihipMalloc(ptr, sizeBytes, ihipFlags);
 
   if ((status == hipSuccess) && ((*ptr) != nullptr)) {
@@ -747,6 +904,7 @@ hipError_t ihipMallocPitch(void** ptr, size_t* pitch, size_t width, size_t heigh
 hipError_t hipMallocPitch(void** ptr, size_t* pitch, size_t width, size_t height) {
   HIP_INIT_API(hipMallocPitch, ptr, pitch, width, height);
   CHECK_STREAM_CAPTURE_SUPPORTED();
+  amd::MemoryStats::Scope memScope(amd::MemoryStats::Malloc);
   if (width == 0 || height == 0) {
     HIP_RETURN(hipErrorInvalidValue);
   }
@@ -757,6 +915,7 @@ hipError_t hipMallocPitch(void** ptr, size_t* pitch, size_t width, size_t height
 hipError_t hipMalloc3D(hipPitchedPtr* pitchedDevPtr, hipExtent extent) {
   HIP_INIT_API(hipMalloc3D, pitchedDevPtr, extent);
   CHECK_STREAM_CAPTURE_SUPPORTED();
+  amd::MemoryStats::Scope memScope(amd::MemoryStats::Malloc);
   size_t pitch = 0;
 
   if (pitchedDevPtr == nullptr) {
@@ -1135,6 +1294,8 @@ hipError_t ihipHostUnregister(void* hostPtr) {
           amd::MemObjMap::RemoveMemObj(vAddr);
         }
       }
+      // Drop the pinned ranges, cached by the pageable transfers, so the memory is unlocked
+      device->devices()[0]->ReleasePinnedRange(mem->getHostMem(), mem->getSize());
     }
     amd::MemObjMap::RemoveMemObj(hostPtr);
     mem->release();
@@ -1173,6 +1334,55 @@ inline hipError_t ihipMemcpySymbol_validate(const void* symbol, size_t sizeBytes
   return hipSuccess;
 }
 
+// Copies between a symbol and the pageable host memory with the memory object of the symbol, hence
+// the repeated uploads skip the pointer lookups. Small writes take the large BAR path in the blit.
+// Returns hipErrorNotSupported if the copy needs the generic path.
+static hipError_t ihipMemcpySymbolHost(const void* symbol, void* host, size_t sizeBytes,
+                                       size_t offset, bool toSymbol, hipStream_t stream) {
+  hip::DeviceVar* dvar = nullptr;
+  hipError_t status = PlatformState::instance().getStatGlobalVar(symbol, ihipGetDevice(), &dvar);
+  if (status != hipSuccess) {
+    return status;
+  }
+  if ((offset + sizeBytes) > dvar->size()) {
+    LogPrintfError("Trying to access out of bounds, offset: %u sizeBytes: %u sym_size: %u \n",
+                   offset, sizeBytes, dvar->size());
+    return hipErrorInvalidValue;
+  }
+  if (sizeBytes == 0) {
+    return hipSuccess;
+  }
+  if (host == nullptr) {
+    return hipErrorInvalidValue;
+  }
+  amd::HostQueue* queue = (stream != nullptr) ? hip::getQueue(stream) : hip::getNullStream();
+  size_t hostOffset = 0;
+  // The runtime allocations and the queues of other devices need the dependency logic of
+  // the generic copy
+  if ((queue == nullptr) || (getMemoryObject(host, hostOffset) != nullptr) ||
+      (&queue->device() != dvar->amd_mem_obj()->getContext().devices()[0])) {
+    return hipErrorNotSupported;
+  }
+
+  amd::Command::EventWaitList waitList;
+  amd::Buffer& buffer = *dvar->amd_mem_obj()->asBuffer();
+  amd::Command* command = nullptr;
+  if (toSymbol) {
+    command = new amd::WriteMemoryCommand(*queue, CL_COMMAND_WRITE_BUFFER, waitList, buffer,
+                                          offset, sizeBytes, host);
+  } else {
+    command = new amd::ReadMemoryCommand(*queue, CL_COMMAND_READ_BUFFER, waitList, buffer,
+                                         offset, sizeBytes, host);
+  }
+  if (command == nullptr) {
+    return hipErrorOutOfMemory;
+  }
+  command->enqueue();
+  command->awaitCompletion();
+  command->release();
+  return hipSuccess;
+}
+
 hipError_t hipMemcpyToSymbol_common(const void* symbol, const void* src, size_t sizeBytes,
                              size_t offset, hipMemcpyKind kind, hipStream_t stream=nullptr) {
   CHECK_STREAM_CAPTURING();
@@ -1181,6 +1391,14 @@ hipError_t hipMemcpyToSymbol_common(const void* symbol, const void* src, size_t
     HIP_RETURN(hipErrorInvalidMemcpyDirection);
   }
 
+  if (kind == hipMemcpyHostToDevice) {
+    hipError_t status = ihipMemcpySymbolHost(symbol, const_cast<void*>(src), sizeBytes, offset,
+                                             true, stream);
+    if (status != hipErrorNotSupported) {
+      return status;
+    }
+  }
+
   size_t sym_size = 0;
   hipDeviceptr_t device_ptr = nullptr;
 
@@ -1214,6 +1432,13 @@ hipError_t hipMemcpyFromSymbol_common(void* dst, const void* symbol, size_t size
     HIP_RETURN(hipErrorInvalidMemcpyDirection);
   }
 
+  if (kind == hipMemcpyDeviceToHost) {
+    hipError_t status = ihipMemcpySymbolHost(symbol, dst, sizeBytes, offset, false, stream);
+    if (status != hipErrorNotSupported) {
+      return status;
+    }
+  }
+
   size_t sym_size = 0;
   hipDeviceptr_t device_ptr = nullptr;
 
@@ -1327,6 +1552,157 @@ hipError_t hipMemcpyAsync_spt(void* dst, const void* src, size_t sizeBytes,
   HIP_RETURN_DURATION(hipMemcpyAsync_common(dst, src, sizeBytes, kind, stream));
 }
 
+// ================================================================================================
+extern "C" hipError_t hipMemcpyBatchAsync(void** dsts, const void** srcs, const size_t* sizes,
+                                          size_t count, hipMemcpyKind kind, hipStream_t stream) {
+  HIP_INIT_API(hipMemcpyBatchAsync, dsts, srcs, sizes, count, kind, stream);
+
+  if ((count != 0) && ((dsts == nullptr) || (srcs == nullptr) || (sizes == nullptr))) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+
+  getStreamPerThread(stream);
+  if (stream != nullptr &&
+      reinterpret_cast<hip::Stream*>(stream)->GetCaptureStatus() ==
+          hipStreamCaptureStatusActive) {
+    // The graph gets a memcpy node per range
+    for (size_t i = 0; i < count; ++i) {
+      hipError_t status = hipMemcpyAsync_common(dsts[i], srcs[i], sizes[i], kind, stream);
+      if (status != hipSuccess) {
+        HIP_RETURN(status);
+      }
+    }
+    HIP_RETURN(hipSuccess);
+  }
+
+  amd::HostQueue* queue = hip::getQueue(stream);
+  amd::Device* queueDevice = &queue->device();
+
+  // Device memory ranges on the stream's device go into one batch command
+  std::vector<amd::CopyMemoryBatchCommand::Range> ranges;
+  std::vector<size_t> others;
+  for (size_t i = 0; i < count; ++i) {
+    if (sizes[i] == 0) {
+      continue;
+    }
+    hipError_t status = ihipMemcpy_validate(dsts[i], srcs[i], sizes[i], kind);
+    if (status != hipSuccess) {
+      HIP_RETURN(status);
+    }
+    size_t sOffset = 0;
+    amd::Memory* srcMemory = getMemoryObject(srcs[i], sOffset);
+    size_t dOffset = 0;
+    amd::Memory* dstMemory = getMemoryObject(dsts[i], dOffset);
+    if ((srcMemory != nullptr) && (dstMemory != nullptr) &&
+        (srcMemory->getContext().devices().size() == 1) &&
+        (dstMemory->getContext().devices().size() == 1) &&
+        (srcMemory->getContext().devices()[0] == queueDevice) &&
+        (dstMemory->getContext().devices()[0] == queueDevice)) {
+      ranges.push_back({srcMemory, sOffset, dstMemory, dOffset, sizes[i]});
+    } else {
+      others.push_back(i);
+    }
+  }
+
+  if (!ranges.empty()) {
+    amd::Command::EventWaitList waitList;
+    amd::Command* command = new amd::CopyMemoryBatchCommand(*queue, waitList, std::move(ranges));
+    if (command == nullptr) {
+      HIP_RETURN(hipErrorOutOfMemory);
+    }
+    command->enqueue();
+    command->release();
+  }
+
+  // The remaining ranges involve host memory or other devices, so use the regular copies
+  for (auto i : others) {
+    hipError_t status = ihipMemcpy(dsts[i], srcs[i], sizes[i], kind, *queue, true);
+    if (status != hipSuccess) {
+      HIP_RETURN(status);
+    }
+  }
+
+  HIP_RETURN_DURATION(hipSuccess);
+}
+
+// ================================================================================================
+static hipError_t ihipMemcpyFile(bool toDevice, void* devPtr, const char* fileName,
+                                 size_t fileOffset, size_t sizeBytes, hipStream_t stream) {
+  if ((devPtr == nullptr) || (fileName == nullptr)) {
+    return hipErrorInvalidValue;
+  }
+  if (sizeBytes == 0) {
+    return hipSuccess;
+  }
+  getStreamPerThread(stream);
+  if (stream != nullptr &&
+      reinterpret_cast<hip::Stream*>(stream)->GetCaptureStatus() ==
+          hipStreamCaptureStatusActive) {
+    return hipErrorStreamCaptureUnsupported;
+  }
+
+  size_t offset = 0;
+  amd::Memory* memory = getMemoryObject(devPtr, offset);
+  if ((memory == nullptr) || (memory->asBuffer() == nullptr) ||
+      !memory->asBuffer()->validateRegion(amd::Coord3D(offset), amd::Coord3D(sizeBytes))) {
+    return hipErrorInvalidValue;
+  }
+
+  std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> cv;
+  amd::LiquidFlashFile* file = new amd::LiquidFlashFile(
+      cv.from_bytes(fileName).c_str(), toDevice ? CL_FILE_READ_ONLY_AMD : CL_FILE_WRITE_ONLY_AMD);
+  if (file == nullptr) {
+    return hipErrorOutOfMemory;
+  }
+  // The direct I/O needs block aligned transfers, otherwise go through the page cache
+  constexpr bool Direct = true;
+  if (!file->open(Direct) ||
+      (((fileOffset | sizeBytes | offset) % file->blockSize()) != 0)) {
+    file->close();
+    if (!file->open(!Direct)) {
+      file->release();
+      return hipErrorFileNotFound;
+    }
+  }
+  if (toDevice && ((fileOffset + sizeBytes) > file->fileSize())) {
+    file->release();
+    return hipErrorInvalidValue;
+  }
+
+  amd::HostQueue* queue = hip::getQueue(stream);
+  amd::Command::EventWaitList waitList;
+  amd::TransferBufferFileCommand* command = new amd::TransferBufferFileCommand(
+      toDevice ? CL_COMMAND_READ_SSG_FILE_AMD : CL_COMMAND_WRITE_SSG_FILE_AMD, *queue, waitList,
+      *memory, amd::Coord3D(offset), amd::Coord3D(sizeBytes), file, fileOffset);
+  // The command keeps the file open until the transfer is done
+  file->release();
+  if (command == nullptr) {
+    return hipErrorOutOfMemory;
+  }
+  if (!command->validateMemory()) {
+    delete command;
+    return hipErrorOutOfMemory;
+  }
+  command->enqueue();
+  command->release();
+  return hipSuccess;
+}
+
+// ================================================================================================
+extern "C" hipError_t hipExtMemcpyFromFile(void* dst, const char* fileName, size_t fileOffset,
+                                           size_t sizeBytes, hipStream_t stream) {
+  HIP_INIT_API(hipExtMemcpyFromFile, dst, fileName, fileOffset, sizeBytes, stream);
+  HIP_RETURN_DURATION(ihipMemcpyFile(true, dst, fileName, fileOffset, sizeBytes, stream));
+}
+
+// ================================================================================================
+extern "C" hipError_t hipExtMemcpyToFile(const char* fileName, size_t fileOffset, const void* src,
+                                         size_t sizeBytes, hipStream_t stream) {
+  HIP_INIT_API(hipExtMemcpyToFile, fileName, fileOffset, src, sizeBytes, stream);
+  HIP_RETURN_DURATION(ihipMemcpyFile(false, const_cast<void*>(src), fileName, fileOffset,
+                                     sizeBytes, stream));
+}
+
 hipError_t hipMemcpyHtoDAsync(hipDeviceptr_t dstDevice, void* srcHost, size_t ByteCount,
                               hipStream_t stream) {
   HIP_INIT_API(hipMemcpyHtoDAsync, dstDevice, srcHost, ByteCount, stream);
@@ -80,7 +80,7 @@ hipError_t hipFreeAsync(void* dev_ptr, hipStream_t stream) {
   auto id = memory->getUserData().deviceId;
   auto hip_stream = (stream == nullptr) ? hip::getCurrentDevice()->GetNullStream() :
     reinterpret_cast<hip::Stream*>(stream);
-  if (!g_devices[id]->FreeMemory(memory, hip_stream)) {
+  if (!g_devices[id]->FreeMemory(memory, hip_stream, offset)) {
     //! @todo It's not the most optimal logic. The current implementation has unconditional waits
     HIP_RETURN(ihipFree(dev_ptr));
    }
@@ -245,6 +245,23 @@ hipError_t hipMemPoolImportFromShareableHandle(
 // ================================================================================================
 hipError_t hipMemPoolExportPointer(hipMemPoolPtrExportData* export_data, void* ptr) {
   HIP_INIT_API(hipMemPoolExportPointer, export_data, ptr);
+  static_assert(sizeof(hipMemPoolPtrExportData) >= sizeof(ihipIpcMemHandle_t),
+                "Export data can't hold IPC memory handle");
+  if ((export_data == nullptr) || (ptr == nullptr)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  size_t offset = 0;
+  amd::Memory* memory = getMemoryObject(ptr, offset);
+  if (memory == nullptr) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  // The pool pointer is exported with IPC of the device, which owns the pool memory
+  amd::Device* device = g_devices[memory->getUserData().deviceId]->devices()[0];
+  auto ihandle = reinterpret_cast<ihipIpcMemHandle_t*>(export_data);
+  if (!device->IpcCreate(ptr, &ihandle->psize, &ihandle->ipc_handle, &ihandle->poffset)) {
+    LogPrintfError("IPC memory creation failed for pool memory: 0x%x", ptr);
+    HIP_RETURN(hipErrorInvalidValue);
+  }
   HIP_RETURN(hipSuccess);
 }
 
@@ -254,5 +271,18 @@ hipError_t hipMemPoolImportPointer(
     hipMemPool_t             mem_pool,
     hipMemPoolPtrExportData* export_data) {
   HIP_INIT_API(hipMemPoolImportPointer, ptr, mem_pool, export_data);
-  HIP_RETURN(hipSuccess);
+  if ((ptr == nullptr) || (mem_pool == nullptr) || (export_data == nullptr)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  auto ihandle = reinterpret_cast<ihipIpcMemHandle_t*>(export_data);
+  if (ihandle->psize == 0) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  amd::Device* device = reinterpret_cast<hip::MemoryPool*>(mem_pool)->Device()->devices()[0];
+  if (!device->IpcAttach(&ihandle->ipc_handle, ihandle->psize, ihandle->poffset,
+                         hipIpcMemLazyEnablePeerAccess, ptr)) {
+    LogPrintfError("Cannot attach pool memory with size: %u offset: %u",
+                   ihandle->psize, ihandle->poffset);
+    HIP_RETURN(hipErrorInvalidValue);
+  }
 }
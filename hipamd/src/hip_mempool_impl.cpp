@@ -25,6 +25,7 @@ namespace hip {
 // ================================================================================================
 void Heap::AddMemory(amd::Memory* memory, hip::Stream* stream) {
   allocations_.insert({memory, {stream, nullptr}});
+  size_index_.insert({memory->getSize(), memory});
   total_size_ += memory->getSize();
   max_total_size_ = std::max(max_total_size_, total_size_);
 }
@@ -32,26 +33,39 @@ void Heap::AddMemory(amd::Memory* memory, hip::Stream* stream) {
 // ================================================================================================
 void Heap::AddMemory(amd::Memory* memory, const MemoryTimestamp& ts) {
   allocations_.insert({memory, ts});
+  size_index_.insert({memory->getSize(), memory});
   total_size_ += memory->getSize();
   max_total_size_ = std::max(max_total_size_, total_size_);
 }
 
+// ================================================================================================
+void Heap::RemoveFromSizeIndex(amd::Memory* memory) {
+  auto range = size_index_.equal_range(memory->getSize());
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == memory) {
+      size_index_.erase(it);
+      return;
+    }
+  }
+}
+
 // ================================================================================================
 amd::Memory* Heap::FindMemory(size_t size, hip::Stream* stream, bool opportunistic) {
-  amd::Memory* memory = nullptr;
-  for (auto it = allocations_.begin(); it != allocations_.end();) {
-    // Check if size can match and it's safe to use this resource
-    if ((it->first->getSize() >= size) && (it->second.IsSafeFind(stream, opportunistic))) {
-      memory = it->first;
+  // Best fit: walk the allocations from the smallest one, which can hold the requested size
+  for (auto it = size_index_.lower_bound(size); it != size_index_.end(); ++it) {
+    auto alloc = allocations_.find(it->second);
+    // Check if it's safe to use this resource
+    if (alloc->second.IsSafeFind(stream, opportunistic)) {
+      amd::Memory* memory = it->second;
+      alloc->second.SetPosition(nullptr);
       total_size_ -= memory->getSize();
       // Remove found allocation from the map
-      it = allocations_.erase(it);
-      break;
-    } else {
-      ++it;
+      allocations_.erase(alloc);
+      size_index_.erase(it);
+      return memory;
     }
   }
-  return memory;
+  return nullptr;
 }
 
 // ================================================================================================
@@ -63,10 +77,11 @@ bool Heap::RemoveMemory(amd::Memory* memory, MemoryTimestamp* ts) {
     } else {
       // Runtime will delete the timestamp object, hence make sure HIP event is released
       it->second.Wait();
-      it->second.SetEvent(nullptr);
+      it->second.SetPosition(nullptr);
     }
     total_size_ -= memory->getSize();
     allocations_.erase(it);
+    RemoveFromSizeIndex(memory);
     return true;
   }
   return false;
@@ -78,8 +93,9 @@ Heap::EraseAllocaton(std::unordered_map<amd::Memory*, MemoryTimestamp>::iterator
   const device::Memory* dev_mem = it->first->getDeviceMemory(*device_->devices()[0]);
   amd::SvmBuffer::free(it->first->getContext(), reinterpret_cast<void*>(dev_mem->virtualAddress()));
   total_size_ -= it->first->getSize();
-  // Clear HIP event
-  it->second.SetEvent(nullptr);
+  // Release the queue position
+  it->second.SetPosition(nullptr);
+  RemoveFromSizeIndex(it->first);
   // Remove the allocation from the map
   return allocations_.erase(it);
 }
@@ -122,74 +138,329 @@ bool Heap::ReleaseAllMemory(hip::Stream* stream) {
 
 // ================================================================================================
 void Heap::RemoveStream(hip::Stream* stream) {
-  for (auto it : allocations_) {
+  for (auto& it : allocations_) {
     it.second.safe_streams_.erase(stream);
   }
 }
 
+// ================================================================================================
+static void SetMemoryAccess(amd::Memory* memory, hip::Device* device, bool enable) {
+  auto peer_device = device->asContext()->devices()[0];
+  device::Memory* mem = memory->getDeviceMemory(*peer_device);
+  if (mem != nullptr) {
+    if (!mem->getAllowedPeerAccess() && enable) {
+      // Enable p2p access for the specified device
+      peer_device->deviceAllowAccess(reinterpret_cast<void*>(mem->virtualAddress()));
+      mem->setAllowedPeerAccess(true);
+    } else if (mem->getAllowedPeerAccess() && !enable) {
+      mem->setAllowedPeerAccess(false);
+    }
+  } else {
+    LogError("Couldn't find device memory for P2P access");
+  }
+}
+
 // ================================================================================================
 void Heap::SetAccess(hip::Device* device, bool enable) {
   for (const auto& it : allocations_) {
-    auto peer_device = device->asContext()->devices()[0];
-    device::Memory* mem = it.first->getDeviceMemory(*peer_device);
-    if (mem != nullptr) {
-      if (!mem->getAllowedPeerAccess() && enable) {
-        // Enable p2p access for the specified device
-        peer_device->deviceAllowAccess(reinterpret_cast<void*>(mem->virtualAddress()));
-        mem->setAllowedPeerAccess(true);
-      } else if (mem->getAllowedPeerAccess() && !enable) {
-        mem->setAllowedPeerAccess(false);
+    SetMemoryAccess(it.first, device, enable);
+  }
+}
+
+// ================================================================================================
+void* SubAllocator::Reserve(Chunk& chunk, size_t offset, size_t size, amd::Memory** memory,
+                            size_t* memory_offset, size_t* reserved) {
+  chunk.busy_[offset] = size;
+  used_size_ += size;
+  if (memory != nullptr) {
+    *memory = chunk.memory_;
+  }
+  if (memory_offset != nullptr) {
+    *memory_offset = offset;
+  }
+  if (reserved != nullptr) {
+    *reserved = size;
+  }
+  const device::Memory* dev_mem = chunk.memory_->getDeviceMemory(*device_->devices()[0]);
+  return reinterpret_cast<void*>(dev_mem->virtualAddress() + offset);
+}
+
+// ================================================================================================
+void* SubAllocator::Allocate(size_t size, hip::Stream* stream, amd::Memory** memory,
+                             size_t* memory_offset, size_t* reserved) {
+  size = amd::alignUp(size, kGranularity);
+  for (auto& it : chunks_) {
+    Chunk& chunk = it.second;
+    RetireRanges(chunk, false);
+    // The freeing stream can reuse its ranges right away, since its work is executed in order
+    for (auto pending = chunk.pending_.begin(); pending != chunk.pending_.end(); ++pending) {
+      if ((pending->stream_ == stream) && (pending->size_ >= size)) {
+        size_t offset = pending->offset_;
+        if (pending->size_ > size) {
+          // The remainder waits for the same marker
+          pending->offset_ += size;
+          pending->size_ -= size;
+        } else {
+          delete pending->event_;
+          chunk.pending_.erase(pending);
+        }
+        return Reserve(chunk, offset, size, memory, memory_offset, reserved);
+      }
+    }
+    // First fit in the retired ranges
+    for (auto range = chunk.free_.begin(); range != chunk.free_.end(); ++range) {
+      if (range->second >= size) {
+        size_t offset = range->first;
+        size_t remainder = range->second - size;
+        chunk.free_.erase(range);
+        if (remainder != 0) {
+          chunk.free_[offset + size] = remainder;
+        }
+        return Reserve(chunk, offset, size, memory, memory_offset, reserved);
       }
+    }
+  }
+  return nullptr;
+}
+
+// ================================================================================================
+void SubAllocator::AddChunk(amd::Memory* memory) {
+  Chunk& chunk = chunks_[memory];
+  chunk.memory_ = memory;
+  chunk.free_[0] = memory->getSize();
+  total_size_ += memory->getSize();
+}
+
+// ================================================================================================
+bool SubAllocator::Free(amd::Memory* memory, size_t offset, hip::Stream* stream) {
+  Chunk& chunk = chunks_[memory];
+  auto busy = chunk.busy_.find(offset);
+  if (busy == chunk.busy_.end()) {
+    LogError("Sub allocation isn't busy in the memory pool");
+    return false;
+  }
+  Pending pending = {busy->first, busy->second, stream, nullptr};
+  used_size_ -= busy->second;
+  chunk.busy_.erase(busy);
+
+  // Add a marker to the stream to trace availability of this range
+  // Without a marker only the freeing stream can reuse the range
+  hip::Event* e = new hip::Event(0);
+  if (e != nullptr) {
+    if (hipSuccess == e->addMarker(reinterpret_cast<hipStream_t>(stream), nullptr, true)) {
+      pending.event_ = e;
     } else {
-      LogError("Couldn't find device memory for P2P access");
+      delete e;
     }
   }
+  chunk.pending_.push_back(pending);
+  return true;
 }
 
 // ================================================================================================
-void* MemoryPool::AllocateMemory(size_t size, hip::Stream* stream) {
-  amd::ScopedLock lock(lock_pool_ops_);
+void SubAllocator::InsertFreeRange(Chunk& chunk, size_t offset, size_t size) {
+  auto next = chunk.free_.lower_bound(offset);
+  if ((next != chunk.free_.end()) && (offset + size == next->first)) {
+    size += next->second;
+    next = chunk.free_.erase(next);
+  }
+  if (next != chunk.free_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      prev->second += size;
+      return;
+    }
+  }
+  chunk.free_.emplace_hint(next, offset, size);
+}
+
+// ================================================================================================
+void SubAllocator::RetireRanges(Chunk& chunk, bool wait) {
+  for (auto it = chunk.pending_.begin(); it != chunk.pending_.end();) {
+    if (wait) {
+      if (it->event_ != nullptr) {
+        it->event_->synchronize();
+      }
+    } else if ((it->event_ == nullptr) || (it->event_->query() != hipSuccess)) {
+      ++it;
+      continue;
+    }
+    delete it->event_;
+    InsertFreeRange(chunk, it->offset_, it->size_);
+    it = chunk.pending_.erase(it);
+  }
+}
+
+// ================================================================================================
+void SubAllocator::Release(bool safe_release) {
+  for (auto it = chunks_.begin(); it != chunks_.end();) {
+    Chunk& chunk = it->second;
+    RetireRanges(chunk, safe_release);
+    if (chunk.busy_.empty() && chunk.pending_.empty()) {
+      const device::Memory* dev_mem = chunk.memory_->getDeviceMemory(*device_->devices()[0]);
+      total_size_ -= chunk.memory_->getSize();
+      amd::SvmBuffer::free(chunk.memory_->getContext(),
+                           reinterpret_cast<void*>(dev_mem->virtualAddress()));
+      it = chunks_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (!chunks_.empty()) {
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Memory pool chunks: %zu, size: %zu, used: %zu",
+            chunks_.size(), total_size_, used_size_);
+  }
+}
 
+// ================================================================================================
+void SubAllocator::RemoveStream(hip::Stream* stream) {
+  for (auto& it : chunks_) {
+    for (auto& pending : it.second.pending_) {
+      if (pending.stream_ == stream) {
+        pending.stream_ = nullptr;
+      }
+    }
+  }
+}
+
+// ================================================================================================
+void SubAllocator::SetAccess(hip::Device* device, bool enable) {
+  for (const auto& it : chunks_) {
+    if (!enable || !it.second.busy_.empty()) {
+      SetMemoryAccess(it.first, device, enable);
+    }
+  }
+}
+
+// ================================================================================================
+amd::Memory* MemoryPool::AllocateMemoryObject(size_t size) {
+  amd::Context* context = device_->asContext();
+  const auto& dev_info = context->devices()[0]->info();
+  if (dev_info.maxMemAllocSize_ < size) {
+    return nullptr;
+  }
+
+  void* dev_ptr = amd::SvmBuffer::malloc(*context, 0, size, dev_info.memBaseAddrAlign_, nullptr);
+  if (dev_ptr == nullptr) {
+    size_t free = 0, total =0;
+    hipError_t err = hipMemGetInfo(&free, &total);
+    if (err == hipSuccess) {
+      LogPrintfError("Allocation failed : Device memory : required :%zu | free :%zu | total :%zu \n",
+        size, free, total);
+    }
+    return nullptr;
+  }
+
+  size_t offset = 0;
+  amd::Memory* memory = getMemoryObject(dev_ptr, offset);
+  // Saves the current device id so that it can be accessed later
+  memory->getUserData().deviceId = device_->deviceId();
+
+  // Update access for the new allocation from other devices
+  EnsureAccess(memory);
+  return memory;
+}
+
+// ================================================================================================
+void MemoryPool::EnsureAccess(amd::Memory* memory) {
+  for (const auto& it : access_map_) {
+    if (it.second != hipMemAccessFlagsProtNone) {
+      // The peer device memory caches the mapping state, hence mapped memory is skipped
+      SetMemoryAccess(memory, it.first, true);
+    }
+  }
+}
+
+// ================================================================================================
+void* MemoryPool::AllocateMemory(size_t size, hip::Stream* stream) {
   void* dev_ptr = nullptr;
-  amd::Memory* memory = free_heap_.FindMemory(size, stream, Opportunistic());
-  if (memory == nullptr) {
-    amd::Context* context = device_->asContext();
-    const auto& dev_info = context->devices()[0]->info();
-    if (dev_info.maxMemAllocSize_ < size) {
+  CachedAllocation allocation = {};
+  {
+    // Same stream reuse doesn't need the pool lock
+    StreamShard& shard = stream_cache_[ShardIndex(stream)];
+    amd::ScopedLock lock(shard.lock_);
+    if (auto it = shard.cache_.find(stream); it != shard.cache_.end()) {
+      auto& cache = it->second;
+      auto best = cache.end();
+      for (auto entry = cache.begin(); entry != cache.end(); ++entry) {
+        // Don't let a small request hold a much bigger allocation
+        size_t entry_size = entry->second.size_;
+        if ((entry_size >= size) && (entry_size <= 2 * size + SubAllocator::kGranularity) &&
+            ((best == cache.end()) || (entry_size < best->second.size_))) {
+          best = entry;
+        }
+      }
+      if (best != cache.end()) {
+        dev_ptr = best->first;
+        allocation = best->second;
+        cache.erase(best);
+      }
+    }
+  }
+  if (dev_ptr == nullptr) {
+    // The pool growth is attributed to the stream, unless the application set a tag
+    amd::MemoryStats::Scope scope(amd::MemoryStats::MemPool,
+        (amd::MemoryStats::tag() == 0) ? reinterpret_cast<uint64_t>(stream) : 0);
+    dev_ptr = AllocateFromHeaps(size, stream, &allocation);
+    if (dev_ptr == nullptr) {
       return nullptr;
     }
+  }
+  allocation.stream_ = stream;
+  LiveShard& live = live_[ShardIndex(dev_ptr)];
+  amd::ScopedLock lock(live.lock_);
+  live.allocations_[reinterpret_cast<address>(dev_ptr)] = allocation;
+  return dev_ptr;
+}
 
-    dev_ptr = amd::SvmBuffer::malloc(*context, 0, size, dev_info.memBaseAddrAlign_, nullptr);
+// ================================================================================================
+void* MemoryPool::AllocateFromHeaps(size_t size, hip::Stream* stream,
+                                    CachedAllocation* allocation) {
+  amd::ScopedLock lock(lock_pool_ops_);
+
+  void* dev_ptr = nullptr;
+  if (size <= SubAllocator::kMaxSize) {
+    // Small requests share large chunks, instead of a system allocation per request
+    dev_ptr = sub_allocator_.Allocate(size, stream, &allocation->memory_, &allocation->offset_,
+                                      &allocation->size_);
     if (dev_ptr == nullptr) {
-      size_t free = 0, total =0;
-      hipError_t err = hipMemGetInfo(&free, &total);
-      if (err == hipSuccess) {
-        LogPrintfError("Allocation failed : Device memory : required :%zu | free :%zu | total :%zu \n",
-          size, free, total);
+      amd::Memory* chunk = AllocateMemoryObject(SubAllocator::kChunkSize);
+      if (chunk == nullptr) {
+        return nullptr;
       }
-      return nullptr;
+      sub_allocator_.AddChunk(chunk);
+      dev_ptr = sub_allocator_.Allocate(size, stream, &allocation->memory_, &allocation->offset_,
+                                        &allocation->size_);
+    }
+    if (dev_ptr != nullptr) {
+      // An idle chunk could skip the mapping on the access change
+      EnsureAccess(allocation->memory_);
+      // Increment the reference counter on the pool
+      retain();
     }
+    return dev_ptr;
+  }
 
-    size_t offset = 0;
-    memory = getMemoryObject(dev_ptr, offset);
-    // Saves the current device id so that it can be accessed later
-    memory->getUserData().deviceId = device_->deviceId();
-
-    // Update access for the new allocation from other devices
-    for (const auto& it : access_map_) {
-      auto vdi_device = it.first->asContext()->devices()[0];
-      device::Memory* mem = memory->getDeviceMemory(*vdi_device);
-      if ((mem != nullptr) && (it.second != hipMemAccessFlagsProtNone)) {
-        mem->setAllowedPeerAccess(true);
-      }
+  amd::Memory* memory = free_heap_.FindMemory(size, stream, Opportunistic());
+  if (memory == nullptr) {
+    memory = AllocateMemoryObject(size);
+    if (memory == nullptr) {
+      return nullptr;
     }
+    const device::Memory* dev_mem = memory->getDeviceMemory(*device_->devices()[0]);
+    dev_ptr = reinterpret_cast<void*>(dev_mem->virtualAddress());
   } else {
     free_heap_.RemoveMemory(memory);
+    // Free memory skips the mapping on the access change
+    EnsureAccess(memory);
     const device::Memory* dev_mem = memory->getDeviceMemory(*device_->devices()[0]);
     dev_ptr = reinterpret_cast<void*>(dev_mem->virtualAddress());
   }
   // Place the allocated memory into the busy heap
   busy_heap_.AddMemory(memory, stream);
+  allocation->memory_ = memory;
+  allocation->offset_ = 0;
+  allocation->size_ = memory->getSize();
 
   // Increment the reference counter on the pool
   retain();
@@ -198,8 +469,47 @@ void* MemoryPool::AllocateMemory(size_t size, hip::Stream* stream) {
 }
 
 // ================================================================================================
-bool MemoryPool::FreeMemory(amd::Memory* memory, hip::Stream* stream) {
+bool MemoryPool::FreeMemory(amd::Memory* memory, hip::Stream* stream, size_t offset) {
+  const device::Memory* dev_mem = memory->getDeviceMemory(*device_->devices()[0]);
+  if (dev_mem == nullptr) {
+    return false;
+  }
+  address dev_ptr = reinterpret_cast<address>(dev_mem->virtualAddress()) + offset;
+  CachedAllocation allocation;
+  {
+    LiveShard& live = live_[ShardIndex(dev_ptr)];
+    amd::ScopedLock lock(live.lock_);
+    auto it = live.allocations_.find(dev_ptr);
+    if (it == live.allocations_.end()) {
+      // This pool doesn't contain memory
+      return false;
+    }
+    allocation = it->second;
+    live.allocations_.erase(it);
+  }
+  if (allocation.stream_ == stream) {
+    StreamShard& shard = stream_cache_[ShardIndex(stream)];
+    amd::ScopedLock lock(shard.lock_);
+    auto& cache = shard.cache_[stream];
+    if (cache.size() < kMaxCachedPerStream) {
+      cache.push_back({dev_ptr, allocation});
+      return true;
+    }
+  }
   amd::ScopedLock lock(lock_pool_ops_);
+  return FreeToHeaps(allocation.memory_, stream, allocation.offset_);
+}
+
+// ================================================================================================
+bool MemoryPool::FreeToHeaps(amd::Memory* memory, hip::Stream* stream, size_t offset) {
+  if (sub_allocator_.IsChunk(memory)) {
+    if (sub_allocator_.Free(memory, offset, stream)) {
+      // Decrement the reference counter on the pool
+      release();
+    }
+    // A chunk can't be released by the caller, even if the range wasn't busy
+    return true;
+  }
 
   MemoryTimestamp ts;
   // Remove memory object fro the busy pool
@@ -210,13 +520,10 @@ bool MemoryPool::FreeMemory(amd::Memory* memory, hip::Stream* stream) {
   // The stream of destruction is a safe stream, because the app must handle sync
   ts.AddSafeStream(stream);
 
-  // Add a marker to the stream to trace availability of this memory
-  Event* e = new hip::Event(0);
-  if (e != nullptr) {
-    if (hipSuccess == e->addMarker(reinterpret_cast<hipStream_t>(stream), nullptr, true)) {
-      ts.SetEvent(e);
-    }
-  }
+  // The last command on the stream traces availability of this memory, the stream is in order
+  amd::HostQueue* queue = stream->asHostQueue();
+  amd::Command* command = (queue != nullptr) ? queue->getLastQueuedCommand(true) : nullptr;
+  ts.SetPosition(command, GetProgress(stream));
   free_heap_.AddMemory(memory, ts);
 
   // Decrement the reference counter on the pool
@@ -225,25 +532,80 @@ bool MemoryPool::FreeMemory(amd::Memory* memory, hip::Stream* stream) {
   return true;
 }
 
+// ================================================================================================
+const std::shared_ptr<StreamProgress>& MemoryPool::GetProgress(hip::Stream* stream) {
+  auto& progress = progress_[stream];
+  if (progress == nullptr) {
+    progress = std::make_shared<StreamProgress>();
+  }
+  return progress;
+}
+
+// ================================================================================================
+void MemoryPool::FlushStreamCache(hip::Stream* stream) {
+  std::vector<std::pair<address, CachedAllocation>> flushed;
+  for (size_t i = 0; i < kNumShards; ++i) {
+    if ((stream != nullptr) && (i != ShardIndex(stream))) {
+      continue;
+    }
+    amd::ScopedLock lock(stream_cache_[i].lock_);
+    auto& caches = stream_cache_[i].cache_;
+    for (auto it = caches.begin(); it != caches.end();) {
+      if ((stream == nullptr) || (it->first == stream)) {
+        flushed.insert(flushed.end(), it->second.begin(), it->second.end());
+        it = caches.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  if (flushed.empty()) {
+    return;
+  }
+  amd::ScopedLock lock(lock_pool_ops_);
+  for (const auto& it : flushed) {
+    FreeToHeaps(it.second.memory_, it.second.stream_, it.second.offset_);
+  }
+}
+
 // ================================================================================================
 void MemoryPool::ReleaseFreedMemory(hip::Stream* stream) {
+  FlushStreamCache(stream);
   amd::ScopedLock lock(lock_pool_ops_);
 
   free_heap_.ReleaseAllMemory(stream);
+  sub_allocator_.Release();
+}
+
+// ================================================================================================
+void MemoryPool::ReclaimFreedMemory() {
+  // Don't compete with the application threads for the pool
+  if (!lock_pool_ops_.tryLock()) {
+    return;
+  }
+  // Only the blocks with the completed HIP events are released
+  free_heap_.ReleaseAllMemory(nullptr);
+  lock_pool_ops_.unlock();
 }
 
 // ================================================================================================
 void MemoryPool::RemoveStream(hip::Stream* stream) {
+  FlushStreamCache(stream);
   amd::ScopedLock lock(lock_pool_ops_);
 
   free_heap_.RemoveStream(stream);
+  sub_allocator_.RemoveStream(stream);
+  // The timestamps keep the progress of the destroyed stream alive
+  progress_.erase(stream);
 }
 
 // ================================================================================================
 void MemoryPool::TrimTo(size_t min_bytes_to_hold) {
+  FlushStreamCache();
   amd::ScopedLock lock(lock_pool_ops_);
 
   free_heap_.ReleaseAllMemory(min_bytes_to_hold);
+  sub_allocator_.Release();
 }
 
 // ================================================================================================
@@ -318,15 +680,17 @@ hipError_t MemoryPool::GetAttribute(hipMemPoolAttr attr, void* value) {
       break;
     case hipMemPoolAttrReservedMemCurrent:
       // All allocate memory by the pool in OS
-      *reinterpret_cast<uint64_t*>(value) = busy_heap_.GetTotalSize() + free_heap_.GetTotalSize();
+      *reinterpret_cast<uint64_t*>(value) = busy_heap_.GetTotalSize() + free_heap_.GetTotalSize() +
+          sub_allocator_.GetTotalSize();
       break;
     case hipMemPoolAttrReservedMemHigh:
       // High watermark of all allocated memory in OS, since the last reset
       *reinterpret_cast<uint64_t*>(value) = busy_heap_.GetTotalSize() + free_heap_.GetMaxTotalSize();
       break;
     case hipMemPoolAttrUsedMemCurrent:
-      // Total currently used memory by the pool
-      *reinterpret_cast<uint64_t*>(value) = busy_heap_.GetTotalSize();
+      // Total currently used memory by the pool, including the stream caches
+      *reinterpret_cast<uint64_t*>(value) = busy_heap_.GetTotalSize() +
+          sub_allocator_.GetUsedSize();
       break;
     case hipMemPoolAttrUsedMemHigh:
       // High watermark of all used memoryS, since the last reset
@@ -362,9 +726,13 @@ void MemoryPool::SetAccess(hip::Device* device, hipMemAccessFlags flags) {
     if ((flags == hipMemAccessFlagsProtRead) || (flags == hipMemAccessFlagsProtReadWrite)) {
       enable_access = true;
     }
-    // Update device access on the both pools
+    // Busy memory must be accessible right away. Free memory is mapped lazily, when the pool
+    // hands it out again, so a change of access doesn't remap the entire pool
     busy_heap_.SetAccess(device, enable_access);
-    free_heap_.SetAccess(device, enable_access);
+    if (!enable_access) {
+      free_heap_.SetAccess(device, enable_access);
+    }
+    sub_allocator_.SetAccess(device, enable_access);
   }
 }
 
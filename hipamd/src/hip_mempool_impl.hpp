@@ -23,6 +23,9 @@
 #include <hip/hip_runtime.h>
 #include "hip_event.hpp"
 #include "hip_internal.hpp"
+#include <list>
+#include <memory>
+#include <map>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -31,27 +34,39 @@ namespace hip {
 class Device;
 class Stream;
 
+/// Completion progress of the frees on a stream. The stream executes in order, hence a retired
+/// sequence number retires all earlier frees on the same stream
+struct StreamProgress {
+  uint64_t next_ = 0;     //!< The last sequence number, assigned to a free
+  uint64_t retired_ = 0;  //!< The last sequence number, known to be complete
+};
+
 struct MemoryTimestamp {
-  MemoryTimestamp(hip::Stream* stream, hip::Event* event = nullptr): event_(event) {
+  MemoryTimestamp(hip::Stream* stream): command_(nullptr), seq_(0), notified_(false) {
     safe_streams_.insert(stream);
   }
-  MemoryTimestamp(): event_(nullptr) {}
+  MemoryTimestamp(): command_(nullptr), seq_(0), notified_(false) {}
 
   /// Adds a safe stream to the list of stream for possible reuse
   void AddSafeStream(hip::Stream* stream) {
-    if (safe_streams_.find(stream) != safe_streams_.end()) {
+    if (safe_streams_.find(stream) == safe_streams_.end()) {
       safe_streams_.insert(stream);
     }
   }
-  /// Changes last known valid event asociated with memory
-  void SetEvent(hip::Event* event) {
-    delete event_;
-    event_ = event;
+  /// Changes the queue position asociated with memory. Takes ownership of the command reference
+  void SetPosition(amd::Command* command, const std::shared_ptr<StreamProgress>& progress = {}) {
+    if (command_ != nullptr) {
+      command_->release();
+    }
+    command_ = command;
+    notified_ = false;
+    progress_ = progress;
+    seq_ = (progress_ != nullptr) ? ++progress_->next_ : 0;
   }
   /// Wait for memory to be available
   void Wait() {
-    if (event_ != nullptr) {
-      auto hip_error = event_->synchronize();
+    if (!IsRetired()) {
+      command_->awaitCompletion();
     }
   }
   /// Returns if memory object is safe for reuse
@@ -60,24 +75,38 @@ struct MemoryTimestamp {
     if (safe_streams_.find(stream) != safe_streams_.end()) {
       // A safe stream doesn't require TS validation
       result = true;
-    } else if (opportunistic && (event_ != nullptr)) {
-      // Check HIP event for a retired status
-      result = (event_->query() == hipSuccess) ? true : false;
+    } else if (opportunistic) {
+      result = IsRetired();
     }
     return result;
   }
   /// Returns if memory object is safe for reuse
-  bool IsSafeRelease() {
-    bool result = true;
-    if (event_ != nullptr) {
-      // Check HIP event for a retired status
-      result = (event_->query() == hipSuccess) ? true : false;
-    }
-    return result;
-  }
+  bool IsSafeRelease() { return IsRetired(); }
 
   std::unordered_set<hip::Stream*>  safe_streams_;  //!< Safe streams for memory reuse
-  hip::Event*   event_;   //!< Last known HIP event, associated with the memory object
+  amd::Command* command_;   //!< The last command on the freeing stream before the free
+  std::shared_ptr<StreamProgress> progress_;  //!< Progress of the freeing stream
+  uint64_t      seq_;       //!< Sequence number of the free on the freeing stream
+  bool          notified_;  //!< The queue was notified about the status check
+
+private:
+  /// Returns true if the work, submitted before the free, is complete
+  bool IsRetired() {
+    if ((command_ == nullptr) || ((progress_ != nullptr) && (seq_ <= progress_->retired_))) {
+      return true;
+    }
+    bool ready = (command_->status() == CL_COMPLETE) ||
+        command_->queue()->device().IsHwEventReady(*command_);
+    if (!ready && !notified_) {
+      // Make sure the command gets to the device, otherwise the status never changes
+      command_->notifyCmdQueue();
+      notified_ = true;
+    }
+    if (ready && (progress_ != nullptr)) {
+      progress_->retired_ = std::max(progress_->retired_, seq_);
+    }
+    return ready;
+  }
 };
 
 class Heap : public amd::EmbeddedObject {
@@ -137,7 +166,11 @@ private:
   Heap(const Heap&) = delete;
   Heap& operator=(const Heap&) = delete;
 
+  /// Removes allocation from the size index
+  void RemoveFromSizeIndex(amd::Memory* memory);
+
   std::unordered_map<amd::Memory*, MemoryTimestamp> allocations_;   //!< Map of allocations on a specific stream
+  std::multimap<size_t, amd::Memory*> size_index_;  //!< Allocations ordered by size for best fit search
   uint64_t total_size_;         //!< Size of all allocations in the heap
   uint64_t max_total_size_;     //!< Maximum heap allocation size
   uint64_t release_threshold_;  //!< Threshold size in bytes for memory release from heap, default 0
@@ -145,6 +178,82 @@ private:
   hip::Device*  device_;    //!< Hip device the allocations will reside
 };
 
+/// Carves small allocations out of large pool chunks. Freed ranges stay pending until the marker
+/// of the freeing stream retires, then they are coalesced with the neighbour free ranges
+class SubAllocator : public amd::EmbeddedObject {
+public:
+  static constexpr size_t kMaxSize = 1 * Mi;      //!< The largest request served from the chunks
+  static constexpr size_t kChunkSize = 8 * Mi;    //!< The size of a single chunk
+  static constexpr size_t kGranularity = 256;     //!< Alignment of the sub allocations
+
+  SubAllocator(hip::Device* device): total_size_(0), used_size_(0), device_(device) {}
+  ~SubAllocator() {}
+
+  /// Returns a sub allocation from the existing chunks or nullptr if none has enough space.
+  /// The chunk, offset and reserved size of the allocation are returned in the optional arguments
+  void* Allocate(size_t size, hip::Stream* stream, amd::Memory** chunk = nullptr,
+                 size_t* offset = nullptr, size_t* reserved = nullptr);
+
+  /// Adds a new chunk for the sub allocations
+  void AddChunk(amd::Memory* memory);
+
+  /// Returns true if the memory object is a chunk of the sub allocator
+  bool IsChunk(amd::Memory* memory) const { return chunks_.find(memory) != chunks_.end(); }
+
+  /// Returns the range at offset to its chunk, false if the range isn't busy
+  bool Free(amd::Memory* memory, size_t offset, hip::Stream* stream);
+
+  /// Coalesces the retired ranges and releases empty chunks
+  void Release(bool safe_release = false);
+
+  /// Remove the provided stream from the pending ranges
+  void RemoveStream(hip::Stream* stream);
+
+  /// Enables P2P access to the provided device. Enabling maps only the chunks with busy ranges,
+  /// the idle chunks are mapped on reuse
+  void SetAccess(hip::Device* device, bool enable);
+
+  /// Returns the size of all chunks
+  uint64_t GetTotalSize() const { return total_size_; }
+
+  /// Returns the size of the busy sub allocations
+  uint64_t GetUsedSize() const { return used_size_; }
+
+private:
+  SubAllocator() = delete;
+  SubAllocator(const SubAllocator&) = delete;
+  SubAllocator& operator=(const SubAllocator&) = delete;
+
+  struct Pending {
+    size_t offset_;         //!< Offset of the freed range in the chunk
+    size_t size_;           //!< Size of the freed range
+    hip::Stream* stream_;   //!< The stream, which freed the range and can reuse it right away
+    hip::Event* event_;     //!< Marker of the freeing stream
+  };
+  struct Chunk {
+    amd::Memory* memory_;                       //!< Memory object of the chunk
+    std::map<size_t, size_t> free_;             //!< Free ranges, ordered by offset
+    std::unordered_map<size_t, size_t> busy_;   //!< Busy ranges, by offset
+    std::list<Pending> pending_;                //!< Freed ranges, which GPU may still access
+  };
+
+  /// Moves the retired pending ranges into the free list of the chunk
+  void RetireRanges(Chunk& chunk, bool wait);
+
+  /// Inserts a free range and merges it with the adjacent ones
+  void InsertFreeRange(Chunk& chunk, size_t offset, size_t size);
+
+  /// Marks the range busy and returns its address
+  void* Reserve(Chunk& chunk, size_t offset, size_t size, amd::Memory** memory,
+                size_t* memory_offset, size_t* reserved);
+
+  std::unordered_map<amd::Memory*, Chunk> chunks_;  //!< Chunks of the sub allocator
+  uint64_t total_size_;   //!< Size of all chunks
+  uint64_t used_size_;    //!< Size of all busy ranges
+
+  hip::Device*  device_;  //!< Hip device the chunks will reside
+};
+
 /// Allocates memory in the pool on the specified stream and places the allocation into busy_heap_
 /// @note: the logic also will look in free_heap for possible reuse.
 /// hipMemPoolReuseAllowOpportunistic option will validate if HIP event,
@@ -154,6 +263,7 @@ public:
   MemoryPool(hip::Device* device):
     busy_heap_(device),
     free_heap_(device),
+    sub_allocator_(device),
     lock_pool_ops_("Pool operations", true), device_(device) {
       device_->AddMemoryPool(this);
       state_.event_dependencies_ = 1;
@@ -161,18 +271,20 @@ public:
       state_.internal_dependencies_ = 1;
     }
   virtual ~MemoryPool() {
+    // Remove memory pool from the list of all pool on the current device first,
+    // so the reclaim thread can't access the pool during destruction
+    device_->RemoveMemoryPool(this);
     assert(busy_heap_.IsEmpty() && "Can't destroy pool with busy allocations!");
     constexpr bool kSafeRelease = true;
     free_heap_.ReleaseAllMemory(0, kSafeRelease);
-    // Remove memory pool from the list of all pool on the current device
-    device_->RemoveMemoryPool(this);
+    sub_allocator_.Release(kSafeRelease);
   }
 
   /// The same stream can reuse memory without HIP event validation
   void* AllocateMemory(size_t size, hip::Stream* stream);
 
   /// Frees memory by placing memory object with HIP event into free_heap_
-  bool FreeMemory(amd::Memory* memory, hip::Stream* stream);
+  bool FreeMemory(amd::Memory* memory, hip::Stream* stream, size_t offset = 0);
 
   /// Releases all allocations from free_heap_. It can be called on Stream or Device synchronization
   /// @note The caller must make sure it's safe to release memory
@@ -184,6 +296,10 @@ public:
   /// Releases all allocations in MemoryPool
   void ReleaseAllMemory();
 
+  /// Releases retired memory above the release threshold, skips the pool if it's busy with
+  /// other operations. Never waits for the device
+  void ReclaimFreedMemory();
+
   /// Trims the pool until it has only min_bytes_to_hold
   void TrimTo(size_t min_bytes_to_hold);
 
@@ -212,9 +328,58 @@ private:
   MemoryPool(const MemoryPool&) = delete;
   MemoryPool& operator=(const MemoryPool&) = delete;
 
+  /// Allocates a new memory object on the pool device with the pool access settings
+  amd::Memory* AllocateMemoryObject(size_t size);
+
+  /// Allocation, tracked by the stream caches
+  struct CachedAllocation {
+    hip::Stream*  stream_;  //!< The stream, which allocated the memory
+    amd::Memory*  memory_;  //!< Memory object of the allocation or its chunk
+    size_t        offset_;  //!< Offset of the allocation in the memory object
+    size_t        size_;    //!< Size of the allocation
+  };
+
+  /// Allocates memory from the heaps under the pool lock
+  void* AllocateFromHeaps(size_t size, hip::Stream* stream, CachedAllocation* allocation);
+
+  /// Returns memory into the heaps, the caller must hold the pool lock
+  bool FreeToHeaps(amd::Memory* memory, hip::Stream* stream, size_t offset);
+
+  /// Maps memory for all peer devices with enabled access, if it wasn't mapped before
+  void EnsureAccess(amd::Memory* memory);
+
+  /// Returns the free progress of the stream
+  const std::shared_ptr<StreamProgress>& GetProgress(hip::Stream* stream);
+
+  /// Returns cached memory of the stream into the heaps, all streams if stream is nullptr
+  void FlushStreamCache(hip::Stream* stream = nullptr);
+
+  template <typename T> static size_t ShardIndex(const T* ptr) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+    return ((address >> 4) ^ (address >> 12)) % kNumShards;
+  }
+
+  static constexpr size_t kNumShards = 16;
+  static constexpr size_t kMaxCachedPerStream = 32;
+
+  /// Busy allocations by address, so a free finds the allocating stream without the pool lock
+  struct LiveShard {
+    amd::Monitor lock_{"Pool live allocations"};
+    std::unordered_map<address, CachedAllocation> allocations_;
+  };
+  /// Memory freed on the allocating stream. The stream can reuse it without HIP events, because
+  /// its work is ordered. The heaps still count it as busy
+  struct StreamShard {
+    amd::Monitor lock_{"Pool stream cache"};
+    std::unordered_map<hip::Stream*, std::vector<std::pair<address, CachedAllocation>>> cache_;
+  };
 
   Heap busy_heap_;    //!< Heap of busy allocations
   Heap free_heap_;    //!< Heap of freed allocations
+  SubAllocator sub_allocator_;  //!< Small allocations, carved out of large chunks
+  std::unordered_map<hip::Stream*, std::shared_ptr<StreamProgress>> progress_;  //!< Free progress
+  LiveShard live_[kNumShards];            //!< Busy allocations of the pool
+  StreamShard stream_cache_[kNumShards];  //!< Per stream caches of freed memory
   struct {
     uint32_t event_dependencies_ : 1;     //!< Event dependencies tracking is enabled
     uint32_t opportunistic_ : 1;          //!< HIP event check is enabled
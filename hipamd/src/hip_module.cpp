@@ -218,19 +218,23 @@ hipError_t ihipLaunchKernel_validate(hipFunction_t f, uint32_t globalWorkSizeX,
   }
 
   const amd::Device* device = g_devices[deviceId]->devices()[0];
-  // Make sure dispatch doesn't exceed max workgroup size limit
-  if (blockDimX * blockDimY * blockDimZ > device->info().maxWorkGroupSize_) {
-    return hipErrorInvalidConfiguration;
-  }
   hip::DeviceFunc* function = hip::DeviceFunc::asFunction(f);
   amd::Kernel* kernel = function->kernel();
-  // Make sure the launch params are not larger than if specified launch_bounds
-  // If it exceeds, then return a failure
-  if (blockDimX * blockDimY * blockDimZ >
-      kernel->getDeviceKernel(*device)->workGroupInfo()->size_) {
+  hip::DeviceFunc::LaunchInfo scratch;
+  const hip::DeviceFunc::LaunchInfo* info = function->launchInfo(*device, &scratch);
+  if (info == nullptr) {
+    return hipErrorInvalidDeviceFunction;
+  }
+  const size_t blockSize = static_cast<size_t>(blockDimX) * blockDimY * blockDimZ;
+  if (blockSize > info->maxWorkGroupSize_) {
+    // Make sure dispatch doesn't exceed max workgroup size limit
+    if (blockSize > device->info().maxWorkGroupSize_) {
+      return hipErrorInvalidConfiguration;
+    }
+    // Make sure the launch params are not larger than if specified launch_bounds
+    // If it exceeds, then return a failure
     LogPrintfError("Launch params (%u, %u, %u) are larger than launch bounds (%lu) for kernel %s",
-                   blockDimX, blockDimY, blockDimZ,
-                   kernel->getDeviceKernel(*device)->workGroupInfo()->size_,
+                   blockDimX, blockDimY, blockDimZ, info->kernelWorkGroupSize_,
                    function->name().c_str());
     return hipErrorLaunchFailure;
   }
@@ -272,7 +276,12 @@ hipError_t ihipLaunchKernel_validate(hipFunction_t f, uint32_t globalWorkSizeX,
     kernargs = reinterpret_cast<address>(extra[1]);
   }
 
-  const amd::KernelSignature& signature = kernel->signature();
+  // The direct capture packs the arguments at the command creation, so skip setting them
+  if (HIP_DIRECT_KERNARG_CAPTURE && kernel->parameters().directCapture()) {
+    return hipSuccess;
+  }
+
+  const amd::KernelSignature& signature = *info->signature_;
   for (size_t i = 0; i < signature.numParameters(); ++i) {
     const amd::KernelParameterDescriptor& desc = signature.at(i);
     if (kernelParams == nullptr) {
@@ -322,7 +331,16 @@ hipError_t ihipLaunchKernelCommand(amd::Command*& command, hipFunction_t f,
   }
 
   // Capture the kernel arguments
-  if (CL_SUCCESS != kernelCommand->captureAndValidate()) {
+  int32_t error = CL_SUCCESS;
+  if (HIP_DIRECT_KERNARG_CAPTURE && kernel->parameters().directCapture()) {
+    if (extra != nullptr) {
+      kernargs = reinterpret_cast<address>(extra[1]);
+    }
+    error = kernelCommand->captureAndValidate(kernelParams, kernargs);
+  } else {
+    error = kernelCommand->captureAndValidate();
+  }
+  if (CL_SUCCESS != error) {
     delete kernelCommand;
     return hipErrorOutOfMemory;
   }
@@ -330,6 +348,39 @@ hipError_t ihipLaunchKernelCommand(amd::Command*& command, hipFunction_t f,
   return hipSuccess;
 }
 
+//! Validates the launch and creates its command without the enqueue. The caller holds dflock_
+static hipError_t ihipModuleLaunchCommand(amd::Command*& command, hipFunction_t f,
+                                          uint32_t globalWorkSizeX, uint32_t globalWorkSizeY,
+                                          uint32_t globalWorkSizeZ, uint32_t blockDimX,
+                                          uint32_t blockDimY, uint32_t blockDimZ,
+                                          uint32_t sharedMemBytes, hipStream_t hStream,
+                                          void** kernelParams, void** extra,
+                                          hipEvent_t startEvent, hipEvent_t stopEvent,
+                                          uint32_t flags, uint32_t params, uint32_t gridId,
+                                          uint32_t numGrids, uint64_t prevGridSum,
+                                          uint64_t allGridSum, uint32_t firstDevice) {
+  int deviceId = hip::Stream::DeviceId(hStream);
+  hipError_t status = PlatformState::instance().initStatManagedVarDevicePtr(deviceId);
+  if (status != hipSuccess) {
+    return status;
+  }
+  if (f == nullptr) {
+    LogPrintfError("%s", "Function passed is null");
+    return hipErrorInvalidImage;
+  }
+  status = ihipLaunchKernel_validate(
+      f, globalWorkSizeX, globalWorkSizeY, globalWorkSizeZ, blockDimX, blockDimY, blockDimZ,
+      sharedMemBytes, kernelParams, extra, deviceId, params);
+  if (status != hipSuccess) {
+    return status;
+  }
+  amd::HostQueue* queue = hip::getQueue(hStream);
+  return ihipLaunchKernelCommand(command, f, globalWorkSizeX, globalWorkSizeY, globalWorkSizeZ,
+                                 blockDimX, blockDimY, blockDimZ, sharedMemBytes, queue,
+                                 kernelParams, extra, startEvent, stopEvent, flags, params,
+                                 gridId, numGrids, prevGridSum, allGridSum, firstDevice);
+}
+
 hipError_t ihipModuleLaunchKernel(hipFunction_t f, uint32_t globalWorkSizeX,
                                   uint32_t globalWorkSizeY, uint32_t globalWorkSizeZ,
                                   uint32_t blockDimX, uint32_t blockDimY, uint32_t blockDimZ,
@@ -342,28 +393,17 @@ hipError_t ihipModuleLaunchKernel(hipFunction_t f, uint32_t globalWorkSizeX,
                blockDimX, blockDimY, blockDimZ, sharedMemBytes, hStream, kernelParams, extra,
                startEvent, stopEvent, flags, params);
 
-  int deviceId = hip::Stream::DeviceId(hStream);
-  HIP_RETURN_ONFAIL(PlatformState::instance().initStatManagedVarDevicePtr(deviceId));
   if (f == nullptr) {
     LogPrintfError("%s", "Function passed is null");
     return hipErrorInvalidImage;
   }
-  hip::DeviceFunc* function = hip::DeviceFunc::asFunction(f);
-  amd::Kernel* kernel = function->kernel();
-  amd::ScopedLock lock(function->dflock_);
+  amd::ScopedLock lock(hip::DeviceFunc::asFunction(f)->dflock_);
 
-  hipError_t status = ihipLaunchKernel_validate(
-      f, globalWorkSizeX, globalWorkSizeY, globalWorkSizeZ, blockDimX, blockDimY, blockDimZ,
-      sharedMemBytes, kernelParams, extra, deviceId, params);
-  if (status != hipSuccess) {
-    return status;
-  }
   amd::Command* command = nullptr;
-  amd::HostQueue* queue = hip::getQueue(hStream);
-  status = ihipLaunchKernelCommand(command, f, globalWorkSizeX, globalWorkSizeY, globalWorkSizeZ,
-                                   blockDimX, blockDimY, blockDimZ, sharedMemBytes, queue,
-                                   kernelParams, extra, startEvent, stopEvent, flags, params,
-                                   gridId, numGrids, prevGridSum, allGridSum, firstDevice);
+  hipError_t status = ihipModuleLaunchCommand(
+      command, f, globalWorkSizeX, globalWorkSizeY, globalWorkSizeZ, blockDimX, blockDimY,
+      blockDimZ, sharedMemBytes, hStream, kernelParams, extra, startEvent, stopEvent, flags,
+      params, gridId, numGrids, prevGridSum, allGridSum, firstDevice);
   if (status != hipSuccess) {
     return status;
   }
@@ -522,6 +562,32 @@ hipError_t hipLaunchCooperativeKernel_spt(const void* f, dim3 gridDim, dim3 bloc
                                                hStream));
 }
 
+//! Waits for the streams of a multi-device launch. The markers on all devices are submitted
+//! first, so the devices drain concurrently instead of one finish after another
+static void ihipSyncLaunchStreams(const hipLaunchParams* launchParamsList, int numDevices) {
+  if (numDevices == 1) {
+    reinterpret_cast<hip::Stream*>(launchParamsList[0].stream)->asHostQueue()->finish();
+    return;
+  }
+  std::vector<amd::Command*> markers;
+  markers.reserve(numDevices);
+  for (int i = 0; i < numDevices; ++i) {
+    amd::HostQueue* queue =
+        reinterpret_cast<hip::Stream*>(launchParamsList[i].stream)->asHostQueue();
+    amd::Command* marker = new amd::Marker(*queue, false);
+    if (marker == nullptr) {
+      queue->finish();
+      continue;
+    }
+    marker->enqueue();
+    markers.push_back(marker);
+  }
+  for (auto marker : markers) {
+    marker->awaitCompletion();
+    marker->release();
+  }
+}
+
 hipError_t ihipLaunchCooperativeKernelMultiDevice(hipLaunchParams* launchParamsList, int numDevices,
                                                   unsigned int flags, uint32_t extFlags) {
   int numActiveGPUs = 0;
@@ -570,13 +636,13 @@ hipError_t ihipLaunchCooperativeKernelMultiDevice(hipLaunchParams* launchParamsL
 
   // Sync the execution streams on all devices
   if ((flags & hipCooperativeLaunchMultiDeviceNoPreSync) == 0) {
-    for (int i = 0; i < numDevices; ++i) {
-      amd::HostQueue* queue =
-          reinterpret_cast<hip::Stream*>(launchParamsList[i].stream)->asHostQueue();
-      queue->finish();
-    }
+    ihipSyncLaunchStreams(launchParamsList, numDevices);
   }
 
+  // Build the commands for all devices first, so the launches are submitted back-to-back
+  // and the grids start close to each other, without the host work in between
+  std::vector<amd::Command*> commands;
+  commands.reserve(numDevices);
   for (int i = 0; i < numDevices; ++i) {
     const hipLaunchParams& launch = launchParamsList[i];
     amd::HostQueue* queue = reinterpret_cast<hip::Stream*>(launch.stream)->asHostQueue();
@@ -595,7 +661,7 @@ hipError_t ihipLaunchCooperativeKernelMultiDevice(hipLaunchParams* launchParamsL
     }
     if (func == nullptr) {
       result = hipErrorInvalidDeviceFunction;
-      HIP_RETURN(result);
+      break;
     }
     size_t globalWorkSizeX = static_cast<size_t>(launch.gridDim.x) * launch.blockDim.x;
     size_t globalWorkSizeY = static_cast<size_t>(launch.gridDim.y) * launch.blockDim.y;
@@ -603,26 +669,38 @@ hipError_t ihipLaunchCooperativeKernelMultiDevice(hipLaunchParams* launchParamsL
     if (globalWorkSizeX > std::numeric_limits<uint32_t>::max() ||
         globalWorkSizeY > std::numeric_limits<uint32_t>::max() ||
         globalWorkSizeZ > std::numeric_limits<uint32_t>::max()) {
-      HIP_RETURN(hipErrorInvalidConfiguration);
+      result = hipErrorInvalidConfiguration;
+      break;
     }
-    result = ihipModuleLaunchKernel(
-        func, static_cast<uint32_t>(globalWorkSizeX), static_cast<uint32_t>(globalWorkSizeY),
-        static_cast<uint32_t>(globalWorkSizeZ), launch.blockDim.x, launch.blockDim.y,
-        launch.blockDim.z, launch.sharedMem, launch.stream, launch.args, nullptr, nullptr, nullptr,
-        flags, extFlags, i, numDevices, prevGridSize, allGridSize, firstDevice);
+    amd::ScopedLock lock(hip::DeviceFunc::asFunction(func)->dflock_);
+    amd::Command* command = nullptr;
+    result = ihipModuleLaunchCommand(
+        command, func, static_cast<uint32_t>(globalWorkSizeX),
+        static_cast<uint32_t>(globalWorkSizeY), static_cast<uint32_t>(globalWorkSizeZ),
+        launch.blockDim.x, launch.blockDim.y, launch.blockDim.z, launch.sharedMem, launch.stream,
+        launch.args, nullptr, nullptr, nullptr, flags, extFlags, i, numDevices, prevGridSize,
+        allGridSize, firstDevice);
     if (result != hipSuccess) {
       break;
     }
+    commands.push_back(command);
     prevGridSize += globalWorkSizeX * globalWorkSizeY * globalWorkSizeZ;
   }
 
+  // A failed launch doesn't submit any grid, since a partial multi-device grid can't complete
+  for (auto command : commands) {
+    if (result == hipSuccess) {
+      command->enqueue();
+    }
+    command->release();
+  }
+  if (result != hipSuccess) {
+    return result;
+  }
+
   // Sync the execution streams on all devices
   if ((flags & hipCooperativeLaunchMultiDeviceNoPostSync) == 0) {
-    for (int i = 0; i < numDevices; ++i) {
-      amd::HostQueue* queue =
-          reinterpret_cast<hip::Stream*>(launchParamsList[i].stream)->asHostQueue();
-      queue->finish();
-    }
+    ihipSyncLaunchStreams(launchParamsList, numDevices);
   }
 
   return result;
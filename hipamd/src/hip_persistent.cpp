@@ -0,0 +1,176 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+#include <hip/hip_runtime.h>
+#include <hip/amd_detail/amd_hip_persistent.h>
+
+#include "hip_internal.hpp"
+
+#include <atomic>
+
+extern hipError_t ihipFree(void* ptr);
+extern hipError_t ihipLaunchKernel(const void* hostFunction, dim3 gridDim, dim3 blockDim,
+                                   void** args, size_t sharedMemBytes, hipStream_t stream,
+                                   hipEvent_t startEvent, hipEvent_t stopEvent, int flags);
+
+//! Host side of a persistent queue, the ring is in fine-grained host memory
+struct ihipPersistentQueue_t {
+  hipExtPersistentRing* ring_;      //!< Ring shared with the resident kernel
+  hipStream_t stream_;              //!< Stream of the resident kernel
+  std::atomic<uint64_t> ticket_{0}; //!< Next ticket of the producers
+  uint32_t mask_;                   //!< Number of slots - 1
+
+  //! Returns the slot of \a ticket
+  hipExtPersistentSlot& slot(uint64_t ticket) const { return ring_->slots[ticket & mask_]; }
+
+  //! Returns the sequence of the slot of \a ticket
+  uint64_t sequence(uint64_t ticket) const {
+    return reinterpret_cast<std::atomic<uint64_t>&>(slot(ticket).sequence)
+        .load(std::memory_order_acquire);
+  }
+
+  //! Spins until the group frees the slot of \a ticket
+  void wait(uint64_t ticket) const {
+    while (sequence(ticket) < ticket + mask_ + 1) {
+      amd::Os::yield();
+    }
+  }
+
+  //! Waits for all tickets, only the last lap can be pending
+  void drain() const {
+    const uint64_t end = ticket_.load(std::memory_order_relaxed);
+    const uint64_t numSlots = static_cast<uint64_t>(mask_) + 1;
+    for (uint64_t i = (end > numSlots) ? end - numSlots : 0; i < end; ++i) {
+      wait(i);
+    }
+  }
+};
+
+// ================================================================================================
+extern "C" hipError_t hipExtPersistentQueueCreate(hipExtPersistentQueue_t* queue,
+                                                  const void* kernel, unsigned int numGroups,
+                                                  unsigned int groupSize, unsigned int numSlots,
+                                                  hipStream_t stream) {
+  HIP_INIT_API(hipExtPersistentQueueCreate, queue, kernel, numGroups, groupSize, numSlots,
+               stream);
+  if ((queue == nullptr) || (kernel == nullptr) || (groupSize == 0) || (numSlots == 0) ||
+      (stream == nullptr) || !hip::isValid(stream)) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  // A group, which isn't resident, never runs its tickets, hence a group per CU at most
+  const uint32_t numCUs = hip::getQueue(stream)->device().info().maxComputeUnits_;
+  if (numGroups == 0) {
+    numGroups = numCUs;
+  }
+  if (numGroups > numCUs) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  numSlots = amd::nextPowerOfTwo(std::max(numSlots, numGroups));
+
+  void* ptr = nullptr;
+  const size_t size = sizeof(hipExtPersistentRing) + (numSlots - 1) * sizeof(hipExtPersistentSlot);
+  hipError_t status = ihipMalloc(&ptr, size, CL_MEM_SVM_FINE_GRAIN_BUFFER | CL_MEM_SVM_ATOMICS);
+  if (status != hipSuccess) {
+    HIP_RETURN(status);
+  }
+  auto ring = reinterpret_cast<hipExtPersistentRing*>(ptr);
+  memset(ring, 0, size);
+  ring->numSlots = numSlots;
+  for (uint32_t i = 0; i < numSlots; ++i) {
+    ring->slots[i].sequence = i;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+
+  void* args[] = {&ring};
+  status = ihipLaunchKernel(kernel, dim3(numGroups), dim3(groupSize), args, 0, stream, nullptr,
+                            nullptr, 0);
+  if (status != hipSuccess) {
+    ihipFree(ptr);
+    HIP_RETURN(status);
+  }
+  auto persistent = new ihipPersistentQueue_t();
+  persistent->ring_ = ring;
+  persistent->stream_ = stream;
+  persistent->mask_ = numSlots - 1;
+  *queue = persistent;
+  HIP_RETURN(hipSuccess);
+}
+
+// ================================================================================================
+extern "C" hipError_t hipExtPersistentQueueEnqueue(hipExtPersistentQueue_t queue,
+                                                   const void* function, const void* args,
+                                                   size_t argsSize, uint64_t* ticket) {
+  HIP_INIT_API(hipExtPersistentQueueEnqueue, queue, function, args, argsSize, ticket);
+  if ((queue == nullptr) || (function == nullptr) ||
+      (argsSize > HIP_EXT_PERSISTENT_ARGS_SIZE) || ((args == nullptr) && (argsSize != 0))) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  const uint64_t current = queue->ticket_.fetch_add(1, std::memory_order_relaxed);
+  // The slot is free when the group finished the ticket of the previous lap
+  while (queue->sequence(current) != current) {
+    amd::Os::yield();
+  }
+  hipExtPersistentSlot& slot = queue->slot(current);
+  slot.function = reinterpret_cast<uint64_t>(function);
+  if (argsSize != 0) {
+    memcpy(slot.args, args, argsSize);
+  }
+  // Publish the work item, the fine-grained memory makes it visible without a doorbell
+  reinterpret_cast<std::atomic<uint64_t>&>(slot.sequence)
+      .store(current + 1, std::memory_order_release);
+  if (ticket != nullptr) {
+    *ticket = current;
+  }
+  HIP_RETURN(hipSuccess);
+}
+
+// ================================================================================================
+extern "C" hipError_t hipExtPersistentQueueWait(hipExtPersistentQueue_t queue, uint64_t ticket) {
+  HIP_INIT_API(hipExtPersistentQueueWait, queue, ticket);
+  if ((queue == nullptr) || (ticket >= queue->ticket_.load(std::memory_order_relaxed))) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  queue->wait(ticket);
+  HIP_RETURN(hipSuccess);
+}
+
+// ================================================================================================
+extern "C" hipError_t hipExtPersistentQueueSynchronize(hipExtPersistentQueue_t queue) {
+  HIP_INIT_API(hipExtPersistentQueueSynchronize, queue);
+  if (queue == nullptr) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  queue->drain();
+  HIP_RETURN(hipSuccess);
+}
+
+// ================================================================================================
+extern "C" hipError_t hipExtPersistentQueueDestroy(hipExtPersistentQueue_t queue) {
+  HIP_INIT_API(hipExtPersistentQueueDestroy, queue);
+  if (queue == nullptr) {
+    HIP_RETURN(hipErrorInvalidValue);
+  }
+  queue->drain();
+  reinterpret_cast<std::atomic<uint32_t>&>(queue->ring_->stop)
+      .store(1, std::memory_order_release);
+  hip::getQueue(queue->stream_)->finish();
+  hipError_t status = ihipFree(queue->ring_);
+  delete queue;
+  HIP_RETURN(status);
+}
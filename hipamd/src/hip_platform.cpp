@@ -97,6 +97,10 @@ extern "C" void __hipRegisterFunction(hip::FatBinaryInfo** modules, const void*
     HIP_INIT_VOID();
     hipFunction_t hfunc = nullptr;
 
+    // Build the code objects of all devices at once, the lookups below only find the kernels
+    hip_error = PlatformState::instance().buildFatBinary(modules);
+    guarantee((hip_error == hipSuccess), "Cannot build fat binary");
+
     for (size_t dev_idx = 0; dev_idx < g_devices.size(); ++dev_idx) {
       hip_error = PlatformState::instance().getStatFunc(&hfunc, hostFunction, dev_idx);
       guarantee((hip_error == hipSuccess), "Cannot retrieve Static function");
@@ -176,6 +180,10 @@ extern "C" void __hipRegisterTexture(
 }
 
 extern "C" void __hipUnregisterFatBinary(hip::FatBinaryInfo** modules) {
+  // The code objects and the device variables are left to the OS at a fast exit
+  if (amd::Runtime::isFastExit()) {
+    return;
+  }
   hipError_t err = PlatformState::instance().removeFatBinary(modules);
   guarantee((err == hipSuccess), "Cannot Unregister Fat Binary");
 }
@@ -302,9 +310,6 @@ hipError_t ihipOccupancyMaxActiveBlocksPerMultiprocessor(
     int* maxBlocksPerCU, int* numBlocksPerGrid, int* bestBlockSize, const amd::Device& device,
     hipFunction_t func, int inputBlockSize, size_t dynamicSMemSize, bool bCalcPotentialBlkSz) {
   hip::DeviceFunc* function = hip::DeviceFunc::asFunction(func);
-  const amd::Kernel& kernel = *function->kernel();
-
-  const device::Kernel::WorkGroupInfo* wrkGrpInfo = kernel.getDeviceKernel(device)->workGroupInfo();
   if (bCalcPotentialBlkSz == false) {
     if (inputBlockSize <= 0) {
       return hipErrorInvalidValue;
@@ -325,63 +330,22 @@ hipError_t ihipOccupancyMaxActiveBlocksPerMultiprocessor(
       inputBlockSize = device.info().maxWorkGroupSize_;
     }
   }
-  // Find wave occupancy per CU => simd_per_cu * GPR usage
-  size_t MaxWavesPerSimd;
-
-  if (device.isa().versionMajor() <= 9) {
-    MaxWavesPerSimd = 8;  // Limited by SPI 32 per CU, hence 8 per SIMD
-  } else {
-    MaxWavesPerSimd = 16;
-  }
-  size_t VgprWaves = MaxWavesPerSimd;
-  size_t maxVGPRs;
-  uint32_t VgprGranularity;
-  if (device.isa().versionMajor() <= 9) {
-    if (device.isa().versionMajor() == 9 && device.isa().versionMinor() == 0 &&
-        device.isa().versionStepping() == 10) {
-      maxVGPRs = 512;
-      VgprGranularity = 8;
-    } else {
-      maxVGPRs = 256;
-      VgprGranularity = 4;
-    }
-  } else {
-    maxVGPRs = 1024;
-    VgprGranularity = 8;
-  }
-  if (wrkGrpInfo->usedSGPRs_ > 0) {
-    VgprWaves = maxVGPRs / amd::alignUp(wrkGrpInfo->usedVGPRs_, VgprGranularity);
-  }
-
-  size_t GprWaves = VgprWaves;
-  if (wrkGrpInfo->usedSGPRs_ > 0) {
-    size_t maxSGPRs;
-    if (device.isa().versionMajor() < 8) {
-      maxSGPRs = 512;
-    } else if (device.isa().versionMajor() < 10) {
-      maxSGPRs = 800;
-    } else {
-      maxSGPRs = SIZE_MAX;  // gfx10+ does not share SGPRs between waves
-    }
-    const size_t SgprWaves = maxSGPRs / amd::alignUp(wrkGrpInfo->usedSGPRs_, 16);
-    GprWaves = std::min(VgprWaves, SgprWaves);
-  }
-
-  const size_t alu_occupancy = device.info().simdPerCU_ * std::min(MaxWavesPerSimd, GprWaves);
-  const int alu_limited_threads = alu_occupancy * wrkGrpInfo->wavefrontSize_;
-
-  int lds_occupancy_wgs = INT_MAX;
-  const size_t total_used_lds = wrkGrpInfo->usedLDSSize_ + dynamicSMemSize;
-  if (total_used_lds != 0) {
-    lds_occupancy_wgs = static_cast<int>(device.info().localMemSize_ / total_used_lds);
+  // Find wave occupancy per CU => simd_per_cu * GPR usage, and the LDS limit.
+  // The table is computed once per device and LDS size, later queries only look it up
+  hip::DeviceFunc::OccupancyInfo scratch;
+  const hip::DeviceFunc::OccupancyInfo* occupancy =
+      function->occupancyInfo(device, dynamicSMemSize, &scratch);
+  if (occupancy == nullptr) {
+    return hipErrorInvalidDeviceFunction;
   }
+  const int alu_limited_threads = occupancy->aluLimitedThreads_;
+  const int waveSize = static_cast<int>(occupancy->waveSize_);
   // Calculate how many blocks of inputBlockSize we can fit per CU
   // Need to align with hardware wavefront size. If they want 65 threads, but
   // waves are 64, then we need 128 threads per block.
   // So this calculates how many blocks we can fit.
-  *maxBlocksPerCU = alu_limited_threads / amd::alignUp(inputBlockSize, wrkGrpInfo->wavefrontSize_);
   // Unless those blocks are further constrained by LDS size.
-  *maxBlocksPerCU = std::min(*maxBlocksPerCU, lds_occupancy_wgs);
+  *maxBlocksPerCU = occupancy->blocksPerCU_[amd::alignUp(inputBlockSize, waveSize) / waveSize];
 
   // Some callers of this function want to return the block size, in threads, that
   // leads to the maximum occupancy. In that case, inputBlockSize is the maximum
@@ -390,13 +354,12 @@ hipError_t ihipOccupancyMaxActiveBlocksPerMultiprocessor(
   // the maximum available block size for this kernel, which could have come from the
   // user. e.g., if the user indicates the maximum block size is 64 threads, but we
   // calculate that 128 threads can fit in each CU, we have to give up and return 64.
-  *bestBlockSize =
-      std::min(alu_limited_threads, amd::alignUp(inputBlockSize, wrkGrpInfo->wavefrontSize_));
+  *bestBlockSize = std::min(alu_limited_threads, amd::alignUp(inputBlockSize, waveSize));
   // If the best block size is smaller than the block size used to fit the maximum,
   // then we need to make the grid bigger for full occupancy.
-  const int bestBlocksPerCU = alu_limited_threads / (*bestBlockSize);
   // Unless those blocks are further constrained by LDS size.
-  *numBlocksPerGrid = device.info().maxComputeUnits_ * std::min(bestBlocksPerCU, lds_occupancy_wgs);
+  *numBlocksPerGrid =
+      device.info().maxComputeUnits_ * occupancy->blocksPerCU_[*bestBlockSize / waveSize];
 
   return hipSuccess;
 }
@@ -869,6 +832,10 @@ hipError_t PlatformState::digestFatBinary(const void* data, hip::FatBinaryInfo*&
   return statCO_.digestFatBinary(data, programs);
 }
 
+hipError_t PlatformState::buildFatBinary(hip::FatBinaryInfo** module) {
+  return statCO_.buildFatBinary(module);
+}
+
 hip::FatBinaryInfo** PlatformState::addFatBinary(const void* data) {
   return statCO_.addFatBinary(data, initialized_);
 }
@@ -907,6 +874,11 @@ hipError_t PlatformState::getStatGlobalVar(const void* hostVar, int deviceId,
   return statCO_.getStatGlobalVar(hostVar, deviceId, dev_ptr, size_ptr);
 }
 
+hipError_t PlatformState::getStatGlobalVar(const void* hostVar, int deviceId,
+                                           hip::DeviceVar** dvar) {
+  return statCO_.getStatGlobalVar(hostVar, deviceId, dvar);
+}
+
 hipError_t PlatformState::initStatManagedVarDevicePtr(int deviceId) {
   return statCO_.initStatManagedVarDevicePtr(deviceId);
 }
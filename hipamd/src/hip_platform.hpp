@@ -69,6 +69,7 @@ class PlatformState {
   hip::FatBinaryInfo** addFatBinary(const void* data);
   hipError_t removeFatBinary(hip::FatBinaryInfo** module);
   hipError_t digestFatBinary(const void* data, hip::FatBinaryInfo*& programs);
+  hipError_t buildFatBinary(hip::FatBinaryInfo** module);
 
   hipError_t registerStatFunction(const void* hostFunction, hip::Function* func);
   hipError_t registerStatGlobalVar(const void* hostVar, hip::Var* var);
@@ -79,6 +80,7 @@ class PlatformState {
   hipError_t getStatFuncAttr(hipFuncAttributes* func_attr, const void* hostFunction, int deviceId);
   hipError_t getStatGlobalVar(const void* hostVar, int deviceId, hipDeviceptr_t* dev_ptr,
                               size_t* size_ptr);
+  hipError_t getStatGlobalVar(const void* hostVar, int deviceId, hip::DeviceVar** dvar);
 
   hipError_t initStatManagedVarDevicePtr(int deviceId);
 
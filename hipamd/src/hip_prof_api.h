@@ -28,13 +28,14 @@
 #if USE_PROF_API
 #include "hip/amd_detail/hip_prof_str.h"
 #include "platform/prof_protocol.h"
+#include "hip_capture.hpp"
 
 // HIP API callbacks spawner object macro
 #define HIP_CB_SPAWNER_OBJECT(CB_ID) \
   api_callbacks_spawner_t<HIP_API_ID_##CB_ID> __api_tracer; \
   { \
     hip_api_data_t* api_data = __api_tracer.get_api_data_ptr(); \
-    if (api_data != NULL) { \
+    if (unlikely(api_data != NULL)) { \
       hip_api_data_t& api_data_ref = *api_data; \
       INIT_CB_ARGS_DATA(CB_ID, api_data_ref); \
       __api_tracer.call(); \
@@ -62,6 +63,8 @@ class api_callbacks_table_t {
     void* a_arg;
     fun_t fun;
     void* arg;
+    std::atomic<uint64_t> calls{0};    // All calls of the API
+    std::atomic<uint64_t> sampled{0};  // Traced calls of the API
   };
 
   struct hip_cb_table_t {
@@ -142,7 +145,27 @@ class api_callbacks_table_t {
   }
 
   inline bool is_enabled() const {
-    return amd::IS_PROFILER_ON;
+    // The flags only gate the tracing, hence the relaxed loads on every API call
+    return amd::IS_PROFILER_ON.load(std::memory_order_relaxed) || hip::ApiCapture::enabled();
+  }
+
+  // Returns true if the call is traced, only 1 in HIP_API_SAMPLE_RATE calls of each API is
+  inline bool sample(const uint32_t& id) {
+    const uint64_t count = entry(id).calls.fetch_add(1, std::memory_order_relaxed);
+    if ((HIP_API_SAMPLE_RATE > 1) && ((count % HIP_API_SAMPLE_RATE) != 0)) {
+      return false;
+    }
+    entry(id).sampled.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool get_sample_count(uint32_t id, uint64_t* calls, uint64_t* sampled) {
+    if (id < HIP_API_ID_FIRST || id > HIP_API_ID_LAST) {
+      return false;
+    }
+    *calls = entry(id).calls.load(std::memory_order_relaxed);
+    *sampled = entry(id).sampled.load(std::memory_order_relaxed);
+    return true;
   }
 
  private:
@@ -188,18 +211,11 @@ template <int cid_>
 class api_callbacks_spawner_t {
  public:
   api_callbacks_spawner_t() :
-    api_data_(NULL)
+    api_data_(NULL),
+    capture_start_(0)
   {
-    if (!is_enabled()) return;
-
-    static_assert(cid_ >= HIP_API_ID_FIRST || cid_ <= HIP_API_ID_LAST, "invalid callback id");
-    callbacks_table.sem_sync(cid_);
-    auto &entry = this->entry(cid_);
-    fun_ = std::make_pair(entry.fun, entry.arg);
-    act_ = std::make_pair(entry.act, entry.a_arg);
-    callbacks_table.sem_release(cid_);
-
-    if (act_.first != NULL) api_data_ = (hip_api_data_t*) act_.first(cid_, NULL, NULL, NULL);
+    // Without a tool the API pays a single predicted branch, the tracing stays out of line
+    if (unlikely(is_enabled())) start();
   }
 
   void call() {
@@ -210,10 +226,7 @@ class api_callbacks_spawner_t {
   }
 
   ~api_callbacks_spawner_t() {
-    if (api_data_ != NULL) {
-      if (fun_.first != NULL) fun_.first(HIP_DOMAIN_ID, cid_, api_data_, fun_.second);
-      if (act_.first != NULL) act_.first(cid_, NULL, NULL, act_.second);
-    }
+    if (unlikely(api_data_ != NULL)) stop();
   }
 
   hip_api_data_t* get_api_data_ptr() {
@@ -225,6 +238,31 @@ class api_callbacks_spawner_t {
   }
 
  private:
+  NOINLINE void start() {
+    // A tool may replace the args storage of the capture below, both read the same args
+    if (hip::ApiCapture::enabled()) capture_start_ = hip::ApiCapture::begin(&api_data_);
+    if (!callbacks_table.sample(cid_)) return;
+
+    static_assert(cid_ >= HIP_API_ID_FIRST || cid_ <= HIP_API_ID_LAST, "invalid callback id");
+    callbacks_table.sem_sync(cid_);
+    auto &entry = this->entry(cid_);
+    fun_ = std::make_pair(entry.fun, entry.arg);
+    act_ = std::make_pair(entry.act, entry.a_arg);
+    callbacks_table.sem_release(cid_);
+
+    if (act_.first != NULL) {
+      hip_api_data_t* api_data = (hip_api_data_t*) act_.first(cid_, NULL, NULL, NULL);
+      if ((api_data != NULL) || (capture_start_ == 0)) api_data_ = api_data;
+    }
+  }
+
+  NOINLINE void stop() {
+    if (fun_.first != NULL) fun_.first(HIP_DOMAIN_ID, cid_, api_data_, fun_.second);
+    // The activity callback may release the args of the tool
+    if (capture_start_ != 0) hip::ApiCapture::end(cid_, api_data_, capture_start_);
+    if (act_.first != NULL) act_.first(cid_, NULL, NULL, act_.second);
+  }
+
   inline api_callbacks_table_t::hip_cb_table_entry_t& entry(const uint32_t& id) {
     return callbacks_table.entry(id);
   }
@@ -232,6 +270,7 @@ class api_callbacks_spawner_t {
   std::pair<hip_api_callback_t, void *> fun_;
   std::pair<hip_act_callback_t, void *> act_;
   hip_api_data_t* api_data_;
+  uint64_t capture_start_;  // Start time of a captured call, 0 otherwise
 };
 
 template <>
@@ -253,6 +292,7 @@ class api_callbacks_table_t {
   typedef void* fun_t;
   bool set_activity(uint32_t id, act_t fun, void* arg) { return false; }
   bool set_callback(uint32_t id, fun_t fun, void* arg) { return false; }
+  bool get_sample_count(uint32_t id, uint64_t* calls, uint64_t* sampled) { return false; }
 };
 
 #endif
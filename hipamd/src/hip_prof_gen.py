@@ -377,6 +377,100 @@ def parse_src(api_map, src_path, src_patt, out):
             f.close()
       if recursive_mode == 0: break
 #############################################################
+# Generating the capture helper, which extracts the stream, event, size and launch
+# arguments of an API for the record-and-replay capture
+def generate_capture_helper(f, api_map):
+  size_names = ['sizeBytes', 'size', 'count', 'bytes', 'ByteCount']
+  func_names = ['function_address', 'hostFunction', 'func', 'f']
+  ptr_names = ['ptr', 'dev_ptr', 'devPtr']
+  f.write('\n#if HIP_PROF_HIP_API_CAPTURE\n')
+  f.write('// HIP API capture arguments, the data contents are never captured\n')
+  f.write(
+  'typedef struct hip_api_capture_args_s {\n' +
+  '  const void* stream;\n' +
+  '  const void* event[2];\n' +
+  '  const void* function;\n' +
+  '  const void* ptr;\n' +
+  '  uint32_t host_function;\n' +
+  '  uint32_t kind;\n' +
+  '  size_t size;\n' +
+  '  uint64_t grid;\n' +
+  '  uint64_t block;\n' +
+  '} hip_api_capture_args_t;\n'
+  )
+  f.write('\n// HIP API capture arguments filling helper, called at the API exit\n')
+  f.write('static inline void hipApiCaptureArgs(hip_api_id_t id, const hip_api_data_t* data,\n')
+  f.write('                                     hip_api_capture_args_t* out) {\n')
+  f.write('  memset(out, 0, sizeof(*out));\n')
+  f.write('  switch (id) {\n')
+  for name in sorted(api_map.keys()):
+    args = api_map[name]
+    arg_types = {}
+    for arg_tuple in args:
+      arg_types[arg_tuple[1]] = arg_tuple[0]
+    lines = []
+    events = 0
+    dims = []
+    has_stream = False
+    for arg_tuple in args:
+      arg_type = arg_tuple[0]
+      arg_name = arg_tuple[1]
+      var_name = 'data->args.' + name + '.' + arg_name
+      if arg_type == 'hipStream_t' and not has_stream:
+        lines.append('out->stream = ' + var_name + ';')
+        has_stream = True
+      elif arg_type == 'hipStream_t*' and not has_stream:
+        lines.append('if (' + var_name + ') out->stream = *(' + var_name + ');')
+        has_stream = True
+      elif arg_type == 'hipEvent_t' and events < 2:
+        lines.append('out->event[' + str(events) + '] = ' + var_name + ';')
+        events += 1
+      elif arg_type == 'hipEvent_t*' and events < 2:
+        lines.append('if (' + var_name + ') out->event[' + str(events) + '] = *(' + var_name + ');')
+        events += 1
+      elif arg_type == 'hipFunction_t':
+        lines.append('out->function = ' + var_name + ';')
+      elif arg_type == 'const void*' and arg_name in func_names:
+        lines.append('out->function = ' + var_name + ';')
+        lines.append('out->host_function = 1;')
+      elif arg_type == 'void**' and arg_name in ptr_names:
+        lines.append('if (' + var_name + ') out->ptr = *(' + var_name + ');')
+      elif arg_type == 'void*' and arg_name in ptr_names:
+        lines.append('out->ptr = ' + var_name + ';')
+      elif arg_type == 'hipMemcpyKind':
+        lines.append('out->kind = ' + var_name + ';')
+      elif arg_type == 'dim3':
+        dims.append(var_name)
+    for size_name in size_names:
+      if arg_types.get(size_name) == 'size_t':
+        lines.append('out->size = data->args.' + name + '.' + size_name + ';')
+        break
+    else:
+      if arg_types.get('width') == 'size_t' and arg_types.get('height') == 'size_t':
+        lines.append('out->size = data->args.' + name + '.width * data->args.' + name + '.height;')
+    if len(dims) == 2:
+      lines.append('out->grid = (uint64_t)' + dims[0] + '.x * ' + dims[0] + '.y * ' + dims[0] + '.z;')
+      lines.append('out->block = (uint64_t)' + dims[1] + '.x * ' + dims[1] + '.y * ' + dims[1] + '.z;')
+    for prefix in [('gridDim', 'blockDim'), ('globalWorkSize', 'localWorkSize')]:
+      grid_args = [prefix[0] + c for c in 'XYZ']
+      block_args = [prefix[1] + c for c in 'XYZ']
+      if all(arg in arg_types for arg in grid_args + block_args):
+        var_name = 'data->args.' + name + '.'
+        lines.append('out->grid = (uint64_t)' + ' * '.join(var_name + arg for arg in grid_args) + ';')
+        lines.append('out->block = (uint64_t)' + ' * '.join(var_name + arg for arg in block_args) + ';')
+        if prefix[0] == 'globalWorkSize':
+          lines.append('if (out->block != 0) out->grid /= out->block;')
+    if len(lines) == 0: continue
+    f.write('    case HIP_API_ID_' + name + ':\n')
+    for line in lines:
+      f.write('      ' + line + '\n')
+    f.write('      break;\n')
+  f.write('    default: break;\n')
+  f.write('  };\n')
+  f.write('}\n')
+  f.write('#endif  // HIP_PROF_HIP_API_CAPTURE\n')
+
+#############################################################
 # Generating profiling primitives header
 # api_map - public API map [<api name>] => [(type, name), ...]
 # callback_ids - public API callback IDs list (name, callback_id)
@@ -573,6 +667,8 @@ def generate_prof_header(f, api_map, callback_ids, opts_map):
   f.write('}\n')
   f.write('#endif  // HIP_PROF_HIP_API_STRING\n')
 
+  generate_capture_helper(f, api_map)
+
   f.write('#endif  // _HIP_PROF_STR_H\n');
 
 #############################################################
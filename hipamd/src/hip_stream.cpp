@@ -23,11 +23,15 @@
 #include "hip_event.hpp"
 #include "thread/monitor.hpp"
 #include "hip_prof_api.h"
+#include <atomic>
 
 extern api_callbacks_table_t callbacks_table;
 
 static amd::Monitor streamSetLock{"Guards global stream set"};
 static std::unordered_set<hip::Stream*> streamSet;
+//! Changes when the streams of a device are destroyed, so the per-thread streams can skip
+//! the validation under streamSetLock until the next device reset
+static std::atomic<uint64_t> streamResetEpoch{0};
 namespace hip {
 
 // ================================================================================================
@@ -47,10 +51,15 @@ Stream::Stream(hip::Device* dev, Priority p, unsigned int f, bool null_stream,
 // ================================================================================================
 Stream::~Stream() {
   if (queue_ != nullptr) {
-    amd::ScopedLock lock(streamSetLock);
-    streamSet.erase(this);
-
-    queue_->release();
+    {
+      amd::ScopedLock lock(streamSetLock);
+      streamSet.erase(this);
+    }
+    // The queue keeps its virtual device, kernarg pool and HW queue for the next stream
+    const Device::QueueKey key(priority_, flags_, queue_->properties().value_, cuMask_);
+    if (null_ || !device_->PoolQueue(key, queue_)) {
+      queue_->release();
+    }
     queue_ = nullptr;
   }
 }
@@ -96,19 +105,42 @@ bool Stream::Create() {
       p = amd::CommandQueue::Priority::Normal;
       break;
   }
-  amd::HostQueue* queue = new amd::HostQueue(*device_->asContext(), *device_->devices()[0],
-                                             properties, amd::CommandQueue::RealTimeDisabled,
-                                             p, cuMask_);
+  amd::CommandQueue::BatchPolicy batchPolicy;
+  uint value = (flags_ & IHIP_STREAM_BATCH_VALUE_MASK) >> IHIP_STREAM_BATCH_VALUE_SHIFT;
+  switch (flags_ & IHIP_STREAM_BATCH_MODE_MASK) {
+    case hipExtStreamBatchImmediate:
+      batchPolicy.mode_ = amd::CommandQueue::BatchPolicy::Mode::Immediate;
+      break;
+    case hipExtStreamBatchCount(0):
+      batchPolicy = {amd::CommandQueue::BatchPolicy::Mode::Count, value};
+      break;
+    case hipExtStreamBatchTime(0):
+      batchPolicy = {amd::CommandQueue::BatchPolicy::Mode::Time, value};
+      break;
+    default:
+      break;
+  }
+  // A queue of a destroyed stream with the same parameters skips the device queue setup
+  amd::HostQueue* queue = null_ ? nullptr : device_->AcquirePooledQueue(
+      Device::QueueKey(priority_, flags_, properties, cuMask_));
+  const bool pooled = (queue != nullptr);
+  if (!pooled) {
+    queue = new amd::HostQueue(*device_->asContext(), *device_->devices()[0],
+                               properties, amd::CommandQueue::RealTimeDisabled,
+                               p, cuMask_, batchPolicy);
+  }
 
   // Create a host queue
-  bool result = (queue != nullptr) ? queue->create() : false;
+  bool result = pooled || ((queue != nullptr) ? queue->create() : false);
   // Insert just created stream into the list of the blocking queues
   if (result) {
     amd::ScopedLock lock(streamSetLock);
     streamSet.insert(this);
     queue_ = queue;
     queue->vdev()->profilerAttach(isProfilerAttached);
-    device_->SaveQueue(queue);
+    if (!pooled) {
+      device_->SaveQueue(queue);
+    }
   } else if (queue != nullptr) {
     // Queue creation has failed, and virtual device associated with the queue may not be created.
     // Just need to delete the queue instance.
@@ -126,7 +158,9 @@ bool isValid(hipStream_t& stream) {
   }
 
   if (hipStreamPerThread == stream) {
+    // The per-thread stream is validated on the lookup
     getStreamPerThread(stream);
+    return stream != nullptr;
   }
 
   hip::Stream* s = reinterpret_cast<hip::Stream*>(stream);
@@ -178,12 +212,51 @@ int Stream::DeviceId(const hipStream_t hStream) {
   return deviceId;
 }
 
-void Stream::syncNonBlockingStreams(int deviceId) {
+void Stream::syncNonBlockingStreams(int deviceId, amd::HostQueue* nullQueue) {
+  std::vector<amd::HostQueue*> queues;
+  if (nullQueue != nullptr) {
+    queues.push_back(nullQueue);
+  }
   amd::ScopedLock lock(streamSetLock);
   for (auto& it : streamSet) {
     if (it->Flags() & hipStreamNonBlocking) {
-      if (it->DeviceId() == deviceId) {
-        it->asHostQueue()->finish();
+      // The streams without a queue have no work
+      amd::HostQueue* queue = it->asHostQueue(true);
+      if ((queue != nullptr) && (it->DeviceId() == deviceId)) {
+        queues.push_back(queue);
+      }
+    }
+  }
+  // Wait for all streams at once, the idle streams don't queue a marker
+  amd::HostQueue::finishAll(queues);
+}
+
+void Stream::syncAllStreams() {
+  std::vector<amd::HostQueue*> queues;
+  for (auto& device : g_devices) {
+    amd::HostQueue* queue = device->NullStream(true);
+    if (queue != nullptr) {
+      queues.push_back(queue);
+    }
+  }
+  amd::ScopedLock lock(streamSetLock);
+  for (auto& it : streamSet) {
+    amd::HostQueue* queue = it->asHostQueue(true);
+    if (queue != nullptr) {
+      queues.push_back(queue);
+    }
+  }
+  amd::HostQueue::finishAll(queues);
+}
+
+void Stream::lastQueuedCommands(int deviceId, std::vector<amd::Command*>* commands) {
+  amd::ScopedLock lock(streamSetLock);
+  for (auto& it : streamSet) {
+    amd::HostQueue* queue = it->asHostQueue(true);
+    if ((queue != nullptr) && (it->DeviceId() == deviceId)) {
+      amd::Command* command = queue->getLastQueuedCommand(true);
+      if (command != nullptr) {
+        commands->push_back(command);
       }
     }
   }
@@ -199,9 +272,12 @@ void Stream::destroyAllStreams(int deviceId) {
       }
     }
   }
+  streamResetEpoch.fetch_add(1, std::memory_order_acq_rel);
   for (auto& it : toBeDeleted) {
     delete it;
   }
+  // The reset releases the device queues, including the idle ones
+  g_devices[deviceId]->ReleasePooledQueues();
 }
 
 };// hip namespace
@@ -276,9 +352,18 @@ void CL_CALLBACK ihipStreamCallback(cl_event event, cl_int command_exec_status,
 static hipError_t ihipStreamCreate(hipStream_t* stream,
                                   unsigned int flags, hip::Stream::Priority priority,
                                   const std::vector<uint32_t>& cuMask = {}) {
+  unsigned int batchMode = flags & IHIP_STREAM_BATCH_MODE_MASK;
+  unsigned int batchValue = flags & IHIP_STREAM_BATCH_VALUE_MASK;
+  flags &= ~(IHIP_STREAM_BATCH_MODE_MASK | IHIP_STREAM_BATCH_VALUE_MASK);
   if (flags != hipStreamDefault && flags != hipStreamNonBlocking) {
     return hipErrorInvalidValue;
   }
+  // The count and time policies require a limit, the immediate policy doesn't take any
+  if ((batchMode == hipExtStreamBatchImmediate) ? (batchValue != 0) :
+      ((batchMode != 0) && (batchValue == 0))) {
+    return hipErrorInvalidValue;
+  }
+  flags |= batchMode | batchValue;
   hip::Stream* hStream = new hip::Stream(hip::getCurrentDevice(), priority, flags, false, cuMask);
 
   if (hStream == nullptr || !hStream->Create()) {
@@ -295,12 +380,11 @@ static hipError_t ihipStreamCreate(hipStream_t* stream,
 class stream_per_thread {
 private:
   std::vector<hipStream_t> m_streams;
+  std::vector<uint64_t> m_epochs;  //!< streamResetEpoch, when the streams were validated
 public:
   stream_per_thread() {
-    m_streams.resize(g_devices.size());
-    for (auto &stream : m_streams) {
-      stream = nullptr;
-    }
+    m_streams.resize(g_devices.size(), nullptr);
+    m_epochs.resize(g_devices.size(), 0);
   }
   stream_per_thread(const stream_per_thread& ) = delete;
   void operator=(const stream_per_thread& ) = delete;
@@ -318,20 +402,30 @@ public:
     int currDev = device->deviceId();
     // This is to make sure m_streams is not empty
     if (m_streams.empty()) {
-      m_streams.resize(g_devices.size());
-      for (auto &stream : m_streams) {
-        stream = nullptr;
-      }
+      m_streams.resize(g_devices.size(), nullptr);
+      m_epochs.resize(g_devices.size(), 0);
+    }
+    // Only this thread uses the stream, so it stays valid until a device reset.
+    // Skip the lookup in the global stream set, if no device was reset since the last check
+    const uint64_t epoch = streamResetEpoch.load(std::memory_order_acquire);
+    if (m_streams[currDev] != nullptr && m_epochs[currDev] == epoch) {
+      return m_streams[currDev];
     }
     // There is a scenario where hipResetDevice destroys stream per thread
     // hence isValid check is required to make sure only valid stream is used
     if (m_streams[currDev] == nullptr || !hip::isValid(m_streams[currDev])) {
-      hipError_t status = ihipStreamCreate(&m_streams[currDev], hipStreamDefault,
+      // The decoupled per-thread streams don't synchronize with the null stream
+      const unsigned int flags = HIP_PER_THREAD_STREAM_DECOUPLED ? hipStreamNonBlocking
+                                                                 : hipStreamDefault;
+      hipError_t status = ihipStreamCreate(&m_streams[currDev], flags,
                                            hip::Stream::Priority::Normal);
       if (status != hipSuccess) {
         DevLogError("Stream creation failed\n");
+        m_streams[currDev] = nullptr;
+        return nullptr;
       }
     }
+    m_epochs[currDev] = epoch;
     return m_streams[currDev];
   }
 };
@@ -489,13 +583,28 @@ hipError_t hipStreamDestroy(hipStream_t stream) {
   HIP_RETURN(hipSuccess);
 }
 
+void hip::WaitIpcSignal(hip::ihipIpcEventShmem_t* shmem, int previous_read_index) {
+  // Another process completes the event, so there is nothing to block on.
+  // Spin first for the short waits, then back off to reduce the CPU load
+  constexpr uint kSpinCount = 1000;
+  constexpr uint kYieldCount = 10000;
+  int offset = previous_read_index % IPC_SIGNALS_PER_EVENT;
+  for (uint count = 0; (shmem->read_index < previous_read_index + IPC_SIGNALS_PER_EVENT) &&
+       (__atomic_load_n(&shmem->signal[offset], __ATOMIC_ACQUIRE) != 0); ++count) {
+    if (count < kSpinCount) {
+      continue;
+    } else if (count < kYieldCount) {
+      amd::Os::yield();
+    } else {
+      amd::Os::sleep(1);
+    }
+  }
+}
+
+// ================================================================================================
 void WaitThenDecrementSignal(hipStream_t stream, hipError_t status, void* user_data) {
   CallbackData* data =  reinterpret_cast<CallbackData*>(user_data);
-  int offset = data->previous_read_index % IPC_SIGNALS_PER_EVENT;
-  while (data->shmem->read_index < data->previous_read_index + IPC_SIGNALS_PER_EVENT &&
-         data->shmem->signal[offset] != 0) {
-    amd::Os::sleep(1);
-  }
+  hip::WaitIpcSignal(data->shmem, data->previous_read_index);
   delete data;
 }
 
@@ -540,6 +649,19 @@ hipError_t hipStreamQuery_common(hipStream_t stream) {
 
   amd::HostQueue* hostQueue = hip::getQueue(stream);
 
+  // Direct dispatch submits in the caller thread, hence the HW state covers all commands.
+  // The marker path below runs only if the last submission has no signal
+  if (AMD_DIRECT_DISPATCH) {
+    switch (hostQueue->vdev()->queryState()) {
+      case device::VirtualDevice::QueueState::Idle:
+        return hipSuccess;
+      case device::VirtualDevice::QueueState::Busy:
+        return hipErrorNotReady;
+      default:
+        break;
+    }
+  }
+
   amd::Command* command = hostQueue->getLastQueuedCommand(true);
   if (command == nullptr) {
     // Nothing was submitted to the queue
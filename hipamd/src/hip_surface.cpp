@@ -40,6 +40,9 @@ struct __hip_surface {
   }
 };
 
+static_assert(sizeof(__hip_surface) <= hip::Device::kSrdSlotSize,
+              "The surface object doesn't fit into the SRD heap slot");
+
 hipError_t ihipCreateSurfaceObject(hipSurfaceObject_t* pSurfObject,
                                    const hipResourceDesc* pResDesc) {
   amd::Device* device = hip::getCurrentDevice()->devices()[0];
@@ -63,11 +66,14 @@ hipError_t ihipCreateSurfaceObject(hipSurfaceObject_t* pSurfObject,
   }
   image = as_amd(memObj)->asImage();
 
-  void* surfObjectBuffer = nullptr;
-  hipError_t err = ihipMalloc(&surfObjectBuffer, sizeof(__hip_surface),
-                              CL_MEM_SVM_FINE_GRAIN_BUFFER);
-  if (surfObjectBuffer == nullptr || err != hipSuccess) {
-    return hipErrorOutOfMemory;
+  // The object is a slot of the SRD heap, unless the heap is out of memory
+  void* surfObjectBuffer = hip::getCurrentDevice()->AllocSrd();
+  if (surfObjectBuffer == nullptr) {
+    hipError_t err = ihipMalloc(&surfObjectBuffer, sizeof(__hip_surface),
+                                CL_MEM_SVM_FINE_GRAIN_BUFFER);
+    if (surfObjectBuffer == nullptr || err != hipSuccess) {
+      return hipErrorOutOfMemory;
+    }
   }
   *pSurfObject = new (surfObjectBuffer) __hip_surface{image, *pResDesc};
 
@@ -86,6 +92,11 @@ hipError_t ihipDestroySurfaceObject(hipSurfaceObject_t surfaceObject) {
     return hipSuccess;
   }
 
+  for (auto device : g_devices) {
+    if (device->FreeSrd(surfaceObject)) {
+      return hipSuccess;
+    }
+  }
   return ihipFree(surfaceObject);
 }
 
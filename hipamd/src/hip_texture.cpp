@@ -25,6 +25,9 @@
 #include "hip_conversions.hpp"
 #include "platform/sampler.hpp"
 
+#include <string>
+#include <unordered_map>
+
 hipError_t ihipMemcpy(void* dst, const void* src, size_t sizeBytes, hipMemcpyKind kind,
                       amd::HostQueue& queue, bool isAsync = false);
 
@@ -60,6 +63,9 @@ struct __hip_texture {
   }
 };
 
+static_assert(sizeof(__hip_texture) <= hip::Device::kSrdSlotSize,
+              "The texture object doesn't fit into the SRD heap slot");
+
 amd::Image* ihipImageCreate(const cl_channel_order channelOrder,
                             const cl_channel_type channelType,
                             const cl_mem_object_type imageType,
@@ -72,10 +78,10 @@ amd::Image* ihipImageCreate(const cl_channel_order channelOrder,
                             const uint32_t numMipLevels,
                             amd::Memory* buffer);
 
-hipError_t ihipCreateTextureObject(hipTextureObject_t* pTexObject,
-                                   const hipResourceDesc* pResDesc,
-                                   const hipTextureDesc* pTexDesc,
-                                   const hipResourceViewDesc* pResViewDesc) {
+static hipError_t createTextureObject(hipTextureObject_t* pTexObject,
+                                     const hipResourceDesc* pResDesc,
+                                     const hipTextureDesc* pTexDesc,
+                                     const hipResourceViewDesc* pResViewDesc) {
   amd::Device* device = hip::getCurrentDevice()->devices()[0];
   const device::Info& info = device->info();
   if (!info.imageSupport_) {
@@ -296,16 +302,87 @@ hipError_t ihipCreateTextureObject(hipTextureObject_t* pTexObject,
   }
   }
 
-  void *texObjectBuffer = nullptr;
-  hipError_t err = ihipMalloc(&texObjectBuffer, sizeof(__hip_texture), CL_MEM_SVM_FINE_GRAIN_BUFFER);
-  if (texObjectBuffer == nullptr || err != hipSuccess) {
-    return hipErrorOutOfMemory;
+  // The object is a slot of the SRD heap, unless the heap is out of memory
+  void *texObjectBuffer = hip::getCurrentDevice()->AllocSrd();
+  if (texObjectBuffer == nullptr) {
+    hipError_t err = ihipMalloc(&texObjectBuffer, sizeof(__hip_texture), CL_MEM_SVM_FINE_GRAIN_BUFFER);
+    if (texObjectBuffer == nullptr || err != hipSuccess) {
+      return hipErrorOutOfMemory;
+    }
   }
   *pTexObject = new (texObjectBuffer) __hip_texture{image, sampler, *pResDesc, *pTexDesc, (pResViewDesc != nullptr) ? *pResViewDesc : hipResourceViewDesc{}};
 
   return hipSuccess;
 }
 
+// Texture objects with identical descriptors share one object, so the image view, the sampler
+// and the SRD allocation aren't recreated by the apps, which create the objects per frame.
+// The objects are immutable, hence a shared object is indistinguishable from a new one.
+struct TextureCacheEntry {
+  hipTextureObject_t texObject_;
+  uint32_t refCount_;
+};
+static amd::Monitor textureCacheLock_("Guards the texture object cache");
+static std::unordered_map<std::string, TextureCacheEntry> textureCache_;
+static std::unordered_map<hipTextureObject_t, std::string> textureCacheKeys_;
+
+static std::string textureCacheKey(const hipResourceDesc* pResDesc,
+                                   const hipTextureDesc* pTexDesc,
+                                   const hipResourceViewDesc* pResViewDesc) {
+  // Only the active member of the resource union is a part of the key
+  hipResourceDesc resDesc;
+  std::memset(&resDesc, 0, sizeof(resDesc));
+  resDesc.resType = pResDesc->resType;
+  switch (pResDesc->resType) {
+  case hipResourceTypeArray:
+    resDesc.res.array = pResDesc->res.array;
+    break;
+  case hipResourceTypeMipmappedArray:
+    resDesc.res.mipmap = pResDesc->res.mipmap;
+    break;
+  case hipResourceTypeLinear:
+    resDesc.res.linear = pResDesc->res.linear;
+    break;
+  case hipResourceTypePitch2D:
+    resDesc.res.pitch2D = pResDesc->res.pitch2D;
+    break;
+  }
+  const int deviceId = hip::getCurrentDevice()->deviceId();
+  std::string key(reinterpret_cast<const char*>(&deviceId), sizeof(deviceId));
+  key.append(reinterpret_cast<const char*>(&resDesc), sizeof(resDesc));
+  key.append(reinterpret_cast<const char*>(pTexDesc), sizeof(*pTexDesc));
+  if (pResViewDesc != nullptr) {
+    key.append(reinterpret_cast<const char*>(pResViewDesc), sizeof(*pResViewDesc));
+  }
+  return key;
+}
+
+hipError_t ihipCreateTextureObject(hipTextureObject_t* pTexObject,
+                                   const hipResourceDesc* pResDesc,
+                                   const hipTextureDesc* pTexDesc,
+                                   const hipResourceViewDesc* pResViewDesc) {
+  if (!HIP_TEXTURE_OBJECT_CACHE || (pTexObject == nullptr) || (pResDesc == nullptr) ||
+      (pTexDesc == nullptr)) {
+    return createTextureObject(pTexObject, pResDesc, pTexDesc, pResViewDesc);
+  }
+
+  std::string key = textureCacheKey(pResDesc, pTexDesc, pResViewDesc);
+  amd::ScopedLock lock(textureCacheLock_);
+  auto it = textureCache_.find(key);
+  if (it != textureCache_.end()) {
+    ++it->second.refCount_;
+    *pTexObject = it->second.texObject_;
+    return hipSuccess;
+  }
+
+  hipError_t err = createTextureObject(pTexObject, pResDesc, pTexDesc, pResViewDesc);
+  if (err == hipSuccess) {
+    textureCacheKeys_.emplace(*pTexObject, key);
+    textureCache_.emplace(std::move(key), TextureCacheEntry{*pTexObject, 1});
+  }
+  return err;
+}
+
 hipError_t hipCreateTextureObject(hipTextureObject_t* pTexObject,
                                   const hipResourceDesc* pResDesc,
                                   const hipTextureDesc* pTexDesc,
@@ -315,7 +392,7 @@ hipError_t hipCreateTextureObject(hipTextureObject_t* pTexObject,
   HIP_RETURN(ihipCreateTextureObject(pTexObject, pResDesc, pTexDesc, pResViewDesc));
 }
 
-hipError_t ihipDestroyTextureObject(hipTextureObject_t texObject) {
+static hipError_t destroyTextureObject(hipTextureObject_t texObject) {
   if (texObject == nullptr) {
     return hipSuccess;
   }
@@ -339,10 +416,34 @@ hipError_t ihipDestroyTextureObject(hipTextureObject_t texObject) {
   // The texture object always owns the sampler SRD.
   texObject->sampler->release();
 
+  for (auto device : g_devices) {
+    if (device->FreeSrd(texObject)) {
+      return hipSuccess;
+    }
+  }
   // TODO Should call ihipFree() to not polute the api trace.
   return ihipFree(texObject);
 }
 
+hipError_t ihipDestroyTextureObject(hipTextureObject_t texObject) {
+  if (texObject == nullptr) {
+    return hipSuccess;
+  }
+  {
+    amd::ScopedLock lock(textureCacheLock_);
+    auto it = textureCacheKeys_.find(texObject);
+    if (it != textureCacheKeys_.end()) {
+      auto entry = textureCache_.find(it->second);
+      if (--entry->second.refCount_ != 0) {
+        return hipSuccess;
+      }
+      textureCache_.erase(entry);
+      textureCacheKeys_.erase(it);
+    }
+  }
+  return destroyTextureObject(texObject);
+}
+
 hipError_t ihipUnbindTexture(textureReference* texRef) {
 
   hipError_t hip_error = hipSuccess;
@@ -68,6 +68,7 @@ hipError_t hipMemAddressReserve(void** ptr, size_t size, size_t alignment, void*
 
 hipError_t hipMemCreate(hipMemGenericAllocationHandle_t* handle, size_t size, const hipMemAllocationProp* prop, unsigned long long flags) {
   HIP_INIT_API(hipMemCreate, handle, size, prop, flags);
+  amd::MemoryStats::Scope memScope(amd::MemoryStats::Vmm);
 
   if (handle == nullptr ||
       size == 0 ||
@@ -93,10 +94,18 @@ hipError_t hipMemCreate(hipMemGenericAllocationHandle_t* handle, size_t size, co
     HIP_RETURN(hipErrorInvalidValue);
   }
 
-  amd::Context* amdContext = g_devices[prop->location.id]->asContext();
+  hip::Device* device = g_devices[prop->location.id];
+  amd::Context* amdContext = device->asContext();
 
-  void* ptr = amd::SvmBuffer::malloc(*amdContext, 0, size, dev_info.memBaseAddrAlign_,
-                nullptr);
+  // Reuse the physical memory of a released handle, if the VMM pool has one of the same size
+  void* ptr = device->AllocPhysicalMemory(size);
+  if (ptr == nullptr) {
+    ptr = amd::SvmBuffer::malloc(*amdContext, 0, size, dev_info.memBaseAddrAlign_, nullptr);
+  }
+  if ((ptr == nullptr) && device->ReleasePhysicalMemory()) {
+    // The pooled memory of other sizes may free enough space for the allocation
+    ptr = amd::SvmBuffer::malloc(*amdContext, 0, size, dev_info.memBaseAddrAlign_, nullptr);
+  }
 
   if (ptr == nullptr) {
     size_t free = 0, total =0;
@@ -225,6 +234,14 @@ hipError_t hipMemRelease(hipMemGenericAllocationHandle_t handle) {
 
   hip::GenericAllocation* ga = reinterpret_cast<hip::GenericAllocation*>(handle);
 
+  // Keep the physical memory for the next hipMemCreate, unless it's still mapped
+  amd::Memory& memory = ga->asAmdMemory();
+  if ((memory.getSvmPtr() == ga->genericAddress()) &&
+      g_devices[ga->GetProperties().location.id]->CachePhysicalMemory(ga->genericAddress(),
+                                                                      ga->size())) {
+    memory.getUserData().data = nullptr;
+    ga->detach();
+  }
   delete ga;
 
   HIP_RETURN(hipSuccess);
@@ -269,18 +286,42 @@ hipError_t hipMemUnmap(void* ptr, size_t size) {
   if (ptr == nullptr) HIP_RETURN(hipErrorInvalidValue);
 
   amd::Memory* va = amd::MemObjMap::FindMemObj(ptr);
+  if (va == nullptr) HIP_RETURN(hipErrorInvalidValue);
+
+  // Collect all mappings in the range, so a single command unmaps them
+  std::vector<amd::VirtualMapCommand::Range> ranges;
+  std::vector<amd::Memory*> mappings;
+  address start = reinterpret_cast<address>(ptr);
+  address end = start + size;
+  for (address addr = start; addr < end;) {
+    amd::Memory* mem = amd::MemObjMap::FindMemObj(addr);
+    if ((mem == nullptr) || (mem->getSvmPtr() != addr) ||
+        (mem->getUserData().deviceId != va->getUserData().deviceId)) {
+      break;
+    }
+    const size_t mapSize = std::min(mem->getSize(), static_cast<size_t>(end - addr));
+    ranges.push_back({addr, mapSize, nullptr});
+    mappings.push_back(mem);
+    addr += mapSize;
+  }
+  if (ranges.empty()) {
+    ranges.push_back({ptr, size, nullptr});
+    mappings.push_back(va);
+  }
 
   auto& queue = *g_devices[va->getUserData().deviceId]->NullStream();
 
-  amd::Command* cmd = new amd::VirtualMapCommand(queue, amd::Command::EventWaitList{}, ptr, size, nullptr);
+  amd::Command* cmd = new amd::VirtualMapCommand(queue, amd::Command::EventWaitList{},
+                                                 std::move(ranges));
   cmd->enqueue();
   cmd->awaitCompletion();
   cmd->release();
 
-  // restore the original va of the generic allocation
-  hip::GenericAllocation* ga = reinterpret_cast<hip::GenericAllocation*>(va->getUserData().data);
-  va->setSvmPtr(ga->genericAddress());
+  // restore the original va of the generic allocations
+  for (auto mem : mappings) {
+    hip::GenericAllocation* ga = reinterpret_cast<hip::GenericAllocation*>(mem->getUserData().data);
+    mem->setSvmPtr(ga->genericAddress());
+  }
 
   HIP_RETURN(hipSuccess);
 }
-
@@ -34,12 +34,15 @@ class GenericAllocation {
 
 public:
   GenericAllocation(void* ptr, size_t size, const hipMemAllocationProp& prop): ptr_(ptr), size_(size), properties_(prop) {}
-  ~GenericAllocation() { hipError_t err = ihipFree(ptr_); }
+  ~GenericAllocation() { if (ptr_ != nullptr) { hipError_t err = ihipFree(ptr_); } }
 
   const hipMemAllocationProp& GetProperties() const { return properties_; }
   hipMemGenericAllocationHandle_t asMemGenericAllocationHandle() { return reinterpret_cast<hipMemGenericAllocationHandle_t>(this); }
   amd::Memory& asAmdMemory() { return *amd::MemObjMap::FindMemObj(genericAddress()); }
   void* genericAddress() const { return ptr_; }
+  size_t size() const { return size_; }
+  //! Gives up the ownership of the physical memory, which the VMM pool keeps for reuse
+  void detach() { ptr_ = nullptr; }
 };
 };
 
@@ -27,6 +27,8 @@ THE SOFTWARE.
 
 #include "vdi_common.hpp"
 #include "utils/flags.hpp"
+#include "utils/versions.hpp"
+#include "device/devcodecache.hpp"
 
 namespace hiprtc {
 using namespace helpers;
@@ -173,16 +175,32 @@ bool RTCCompileProgram::addHeader(const std::string& source, const std::string&
   if (!addCodeObjData(compile_input_, vsource, name, AMD_COMGR_DATA_KIND_INCLUDE)) {
     return false;
   }
+  std::stringstream key;
+  key << name << ":" << source.size() << ":" << std::hex << std::hash<std::string>()(source)
+      << ";";
+  headers_key_ += key.str();
   return true;
 }
 
 bool RTCCompileProgram::addBuiltinHeader() {
-  std::vector<char> source(__hipRTC_header, __hipRTC_header + __hipRTC_header_size);
-  std::string name{"hiprtc_runtime.h"};
-  if (!addCodeObjData(compile_input_, source, name, AMD_COMGR_DATA_KIND_INCLUDE)) {
+  // The header is copied once and shared by all programs, since the data sets retain their data
+  static amd_comgr_data_t header = []() {
+    amd_comgr_data_t data = {0};
+    if (amd::Comgr::create_data(AMD_COMGR_DATA_KIND_INCLUDE, &data) != AMD_COMGR_STATUS_SUCCESS) {
+      return amd_comgr_data_t{0};
+    }
+    if ((amd::Comgr::set_data(data, __hipRTC_header_size, __hipRTC_header) !=
+         AMD_COMGR_STATUS_SUCCESS) ||
+        (amd::Comgr::set_data_name(data, "hiprtc_runtime.h") != AMD_COMGR_STATUS_SUCCESS)) {
+      amd::Comgr::release_data(data);
+      return amd_comgr_data_t{0};
+    }
+    return data;
+  }();
+  if (header.handle == 0) {
     return false;
   }
-  return true;
+  return amd::Comgr::data_set_add(compile_input_, header) == AMD_COMGR_STATUS_SUCCESS;
 }
 
 bool RTCCompileProgram::transformOptions() {
@@ -228,6 +246,150 @@ bool RTCCompileProgram::transformOptions() {
 }
 
 amd::Monitor RTCProgram::lock_("HIPRTC Program", true);
+RTCCompileProgram::CacheList RTCCompileProgram::cache_;
+std::unordered_map<std::string, RTCCompileProgram::CacheList::iterator>
+    RTCCompileProgram::cache_map_;
+size_t RTCCompileProgram::cache_size_ = 0;
+std::unordered_map<std::string, std::string> RTCCompileProgram::pch_files_;
+
+static constexpr const char* kDiskCachePrefix = "hiprtc_";
+// The PCH files must not match kDiskCachePrefix, since the trim of the code cache skips them
+static constexpr const char* kPchPrefix = "hiprtcpch_";
+
+std::string RTCCompileProgram::cacheKey() const {
+  // The builtin header changes with the runtime only, hence hash it once
+  static const size_t builtinHash =
+      std::hash<std::string>()(std::string(__hipRTC_header, __hipRTC_header_size));
+
+  size_t comgrMajor = 0;
+  size_t comgrMinor = 0;
+  amd::Comgr::get_version(&comgrMajor, &comgrMinor);
+
+  std::hash<std::string> hash;
+  std::stringstream key;
+  key << isa_ << ";" << AMD_BUILD_STRING << ";comgr " << comgrMajor << "." << comgrMinor << ";"
+      << (fgpu_rdc_ ? "rdc;" : "exe;");
+  for (const auto& options : {&compile_options_, &link_options_, &exe_options_}) {
+    for (const auto& option : *options) {
+      key << option << " ";
+    }
+    key << ";";
+  }
+  // The source has the name expressions, since they are appended as the variables
+  key << std::hex << builtinHash << ";" << headers_key_ << source_name_ << ":"
+      << source_code_.size() << ":" << hash(source_code_);
+  return key.str();
+}
+
+bool RTCCompileProgram::findCache(const std::string& key) {
+  std::vector<char>& binary = fgpu_rdc_ ? LLVMBitcode_ : executable_;
+  auto it = cache_map_.find(key);
+  if (it != cache_map_.end()) {
+    // Move the compilation to the front of the list
+    cache_.splice(cache_.begin(), cache_, it->second);
+    binary = it->second->second;
+    return true;
+  }
+
+  if (!HIPRTC_DISK_CACHE) {
+    return false;
+  }
+  const std::string file = amd::CodeCache::file(kDiskCachePrefix + isa_, key);
+  if (file.empty() || !amd::CodeCache::load(file, key, &binary)) {
+    return false;
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "Loaded hiprtc program %s from %s", name_.c_str(),
+          file.c_str());
+  addCache(key);
+  return true;
+}
+
+void RTCCompileProgram::addCache(const std::string& key) {
+  const std::vector<char>& binary = fgpu_rdc_ ? LLVMBitcode_ : executable_;
+  const size_t maxSize = static_cast<size_t>(HIPRTC_COMPILE_CACHE_SIZE) * Mi;
+  if ((binary.size() <= maxSize) && (cache_map_.find(key) == cache_map_.end())) {
+    // Evict the least recently used compilations
+    while ((cache_size_ + binary.size()) > maxSize) {
+      cache_size_ -= cache_.back().second.size();
+      cache_map_.erase(cache_.back().first);
+      cache_.pop_back();
+    }
+    cache_.emplace_front(key, binary);
+    cache_map_[key] = cache_.begin();
+    cache_size_ += binary.size();
+  }
+}
+
+std::string RTCCompileProgram::builtinPch() {
+  // The PCH depends on every option, which changes the preprocessor state or the language
+  std::string options;
+  if (!settings_.offloadArchProvided) {
+    const std::string prefix = "amdgcn-amd-amdhsa--";
+    options += "\"--offload-arch=" + isa_.substr(prefix.size()) + "\" ";
+  }
+  for (size_t i = 0; i < compile_options_.size(); ++i) {
+    if ((compile_options_[i] == "-include") && (i + 1 < compile_options_.size()) &&
+        (compile_options_[i + 1] == "hiprtc_runtime.h")) {
+      ++i;
+    } else if (!compile_options_[i].empty()) {
+      options += "\"" + compile_options_[i] + "\" ";
+    }
+  }
+  const std::string key = isa_ + ";" + AMD_BUILD_STRING + ";" + options;
+  auto it = pch_files_.find(key);
+  if (it != pch_files_.end()) {
+    return it->second;
+  }
+  std::string& pch = pch_files_[key];
+
+  const std::string base = amd::CodeCache::file(kPchPrefix + isa_, key);
+  if (base.empty()) {
+    return pch;
+  }
+  // The header stays next to the PCH, since clang validates the inputs of a PCH
+  const std::string header = base + ".h";
+  if (amd::Os::pathExists(base) && amd::Os::pathExists(header)) {
+    pch = base;
+    return pch;
+  }
+  std::ofstream out(header, std::ios::binary | std::ios::trunc);
+  if (!out.write(__hipRTC_header, __hipRTC_header_size)) {
+    return pch;
+  }
+  out.close();
+
+  std::string clang = amd::Os::getEnvironment("HIP_CLANG_PATH");
+  if (clang.empty()) {
+    std::string rocm = amd::Os::getEnvironment("ROCM_PATH");
+    clang = (rocm.empty() ? std::string("/opt/rocm") : rocm) + "/llvm/bin";
+  }
+  clang += amd::Os::fileSeparator() + std::string(IS_WINDOWS ? "clang.exe" : "clang");
+  // -emit-pch is the last action of cc1, hence it overrides the syntax only run
+  const std::string command = "\"" + clang + "\" -x hip --cuda-device-only -nogpulib " + options +
+      "-fsyntax-only -Xclang -emit-pch -Xclang -o -Xclang \"" + base + "\" \"" + header + "\"";
+  if (amd::Os::systemCall(command) != 0) {
+    LogPrintfInfo("Failed to generate the builtin PCH: %s", command.c_str());
+    amd::Os::unlink(base);
+    return pch;
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "Generated the hiprtc builtin PCH %s", base.c_str());
+  pch = base;
+  return pch;
+}
+
+bool RTCCompileProgram::lowerNames() {
+  std::vector<std::string> mangledNames;
+  if (!fillMangledNames(executable_, mangledNames)) {
+    LogError("Error in hiprtc: unable to fill mangled names");
+    return false;
+  }
+
+  if (!getDemangledNames(mangledNames, demangled_names_)) {
+    LogError("Error in hiprtc: unable to get demangled names");
+    return false;
+  }
+  return true;
+}
 
 bool RTCCompileProgram::compile(const std::vector<std::string>& options, bool fgpu_rdc) {
   amd::ScopedLock lock(lock_); // Lock, because LLVM is not multi threaded
@@ -248,12 +410,55 @@ bool RTCCompileProgram::compile(const std::vector<std::string>& options, bool fg
     return false;
   }
 
-  if (!compileToBitCode(compile_input_, isa_, compile_options_, build_log_, LLVMBitcode_)) {
+  // The ISA dumps need the compilation
+  std::string key;
+  if (!settings_.dumpISA && ((HIPRTC_COMPILE_CACHE_SIZE != 0) || HIPRTC_DISK_CACHE)) {
+    key = cacheKey();
+    if (findCache(key)) {
+      // The names are lowered from the executable, so hiprtcGetLoweredName works on a hit
+      return fgpu_rdc_ || lowerNames();
+    }
+  }
+
+  bool compiled = false;
+  bool pchFailed = false;
+  const std::string pch = HIPRTC_BUILTIN_PCH ? builtinPch() : std::string();
+  if (!pch.empty()) {
+    std::vector<std::string> options = compile_options_;
+    auto it = std::find(options.begin(), options.end(), "hiprtc_runtime.h");
+    if ((it != options.begin()) && (it != options.end()) && (*(it - 1) == "-include")) {
+      *(it - 1) = "-include-pch";
+      *it = pch;
+      const size_t logSize = build_log_.size();
+      compiled = compileToBitCode(compile_input_, isa_, options, build_log_, LLVMBitcode_);
+      if (!compiled) {
+        // Retry with the source header, the log of the retry reports the errors of the source
+        build_log_.resize(logSize);
+        LLVMBitcode_.clear();
+        pchFailed = true;
+      }
+    }
+  }
+  if (!compiled &&
+      !compileToBitCode(compile_input_, isa_, compile_options_, build_log_, LLVMBitcode_)) {
     LogError("Error in hiprtc: unable to compile source to bitcode");
     return false;
   }
+  if (pchFailed) {
+    // The source is valid, hence clang rejected a stale or incompatible PCH
+    LogPrintfInfo("Compilation with the builtin PCH %s failed, disabling it", pch.c_str());
+    for (auto& it : pch_files_) {
+      if (it.second == pch) {
+        it.second.clear();
+      }
+    }
+    amd::Os::unlink(pch);
+  }
 
   if (fgpu_rdc_) {
+    if (!key.empty()) {
+      saveCache(key);
+    }
     return true;
   }
 
@@ -287,18 +492,23 @@ bool RTCCompileProgram::compile(const std::vector<std::string>& options, bool fg
     return false;
   }
 
-  std::vector<std::string> mangledNames;
-  if (!fillMangledNames(executable_, mangledNames)) {
-    LogError("Error in hiprtc: unable to fill mangled names");
-    return false;
+  if (!key.empty()) {
+    saveCache(key);
   }
 
-  if (!getDemangledNames(mangledNames, demangled_names_)) {
-    LogError("Error in hiprtc: unable to get demangled names");
-    return false;
-  }
+  return lowerNames();
+}
 
-  return true;
+void RTCCompileProgram::saveCache(const std::string& key) {
+  addCache(key);
+  if (HIPRTC_DISK_CACHE) {
+    const std::vector<char>& binary = fgpu_rdc_ ? LLVMBitcode_ : executable_;
+    const std::string file = amd::CodeCache::file(kDiskCachePrefix + isa_, key);
+    if (!file.empty()) {
+      amd::CodeCache::save(file, key, binary.data(), binary.size());
+      amd::CodeCache::trim(kDiskCachePrefix, static_cast<uint64_t>(OCL_CODE_CACHE_SIZE) * Mi);
+    }
+  }
 }
 
 void RTCCompileProgram::stripNamedExpression(std::string& strippedName) {
@@ -28,9 +28,11 @@ THE SOFTWARE.
 #include <exception>
 #endif
 #include <atomic>
+#include <list>
 #include <map>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "top.hpp"
 #include "utils/debug.hpp"
@@ -131,10 +133,33 @@ class RTCCompileProgram : public RTCProgram {
   bool fgpu_rdc_;
   std::vector<char> LLVMBitcode_;
 
+  std::string headers_key_;  //!< Names and hashes of the added headers
+
+  //! Compilations of the process, the most recently used first
+  typedef std::list<std::pair<std::string, std::vector<char>>> CacheList;
+  static CacheList cache_;
+  static std::unordered_map<std::string, CacheList::iterator> cache_map_;
+  static size_t cache_size_;  //!< The total size of the cached binaries
+
+  //! PCH files of the builtin header per target and options, empty after a failed generation
+  static std::unordered_map<std::string, std::string> pch_files_;
+
   // Private Member functions
   bool addSource_impl();
   bool addBuiltinHeader();
   bool transformOptions();
+  bool lowerNames();
+
+  //! Returns the key of the compilation, which has everything that changes the binary
+  std::string cacheKey() const;
+  //! Restores the bitcode or executable of a previous compilation, returns false on a miss
+  bool findCache(const std::string& key);
+  //! Adds the bitcode or executable of the compilation to the process cache
+  void addCache(const std::string& key);
+  //! Adds the bitcode or executable of the compilation to the process and disk caches
+  void saveCache(const std::string& key);
+  //! Returns the PCH file of the builtin header, generated on the first use; empty on a failure
+  std::string builtinPch();
 
   RTCCompileProgram() = delete;
   RTCCompileProgram(RTCCompileProgram&) = delete;
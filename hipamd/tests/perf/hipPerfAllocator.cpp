@@ -0,0 +1,292 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hipPerfCommon.hpp"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+
+namespace hipperf {
+
+//! Live memory limit of the trace, so the replay fits into any device
+static constexpr size_t MaxLiveBytes = 2ull * 1024 * 1024 * 1024;
+
+//! The footprint is sampled once per this number of operations
+static constexpr uint32_t FootprintInterval = 64;
+
+//! Streams of the multi-stream pool replay
+static constexpr uint32_t TraceStreams = 4;
+
+//! One operation of an allocation trace
+struct TraceOp {
+  bool alloc_;       //!< Allocation or release
+  uint32_t id_;      //!< Allocation slot
+  size_t size_;      //!< Requested size
+  uint32_t stream_;  //!< Stream of the allocation, the release uses the same stream
+};
+
+// ================================================================================================
+/*! \brief Generates a trace with the size distribution and the lifetimes of a framework
+ *
+ *  Most allocations are small activations, which are released within a few operations.
+ *  Some are medium buffers with longer lifetimes and a few are large weights, which stay
+ *  live until the end. The generator is deterministic, so the runs are comparable.
+ */
+static std::vector<TraceOp> generateTrace(uint32_t allocations) {
+  uint64_t seed = 0x2545f4914f6cdd1dull;
+  auto random = [&seed](uint64_t range) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    return (seed >> 33) % range;
+  };
+
+  std::vector<TraceOp> trace;
+  std::multimap<uint32_t, TraceOp> pending;  //!< Releases ordered by the step
+  size_t live = 0;
+  for (uint32_t step = 0; step < allocations; ++step) {
+    for (auto it = pending.begin(); (it != pending.end()) && (it->first <= step);) {
+      live -= it->second.size_;
+      trace.push_back(it->second);
+      it = pending.erase(it);
+    }
+
+    size_t size;
+    uint32_t lifetime;
+    const uint64_t kind = random(100);
+    if (kind < 60) {
+      size = 256 + random(64 * 1024);
+      lifetime = 1 + static_cast<uint32_t>(random(8));
+    } else if (kind < 90) {
+      size = 64 * 1024 + random(4 * 1024 * 1024);
+      lifetime = 100 + static_cast<uint32_t>(random(900));
+    } else {
+      size = 4 * 1024 * 1024 + random(60 * 1024 * 1024);
+      lifetime = allocations;
+    }
+    // Frameworks round the sizes up to 256 bytes
+    size = (size + 255) & ~static_cast<size_t>(255);
+    if (live + size > MaxLiveBytes) {
+      continue;
+    }
+    live += size;
+    const uint32_t stream = static_cast<uint32_t>(random(TraceStreams));
+    trace.push_back({true, step, size, stream});
+    pending.insert(std::make_pair(step + lifetime, TraceOp{false, step, size, stream}));
+  }
+  for (const auto& it : pending) {
+    trace.push_back(it.second);
+  }
+  return trace;
+}
+
+//! Allocator under the test
+class Allocator {
+ public:
+  virtual ~Allocator() {}
+  virtual void* allocate(size_t size, uint32_t stream) = 0;
+  virtual void release(void* ptr, size_t size, uint32_t stream) = 0;
+  //! Waits for the asynchronous releases
+  virtual void finish() {}
+  //! Returns the device memory held by the allocator
+  virtual size_t footprint() = 0;
+};
+
+//! hipMalloc and hipFree
+class MallocAllocator : public Allocator {
+ public:
+  MallocAllocator() { base_ = used(); }
+  void* allocate(size_t size, uint32_t) override {
+    void* ptr = nullptr;
+    HIP_PERF_CHECK(hipMalloc(&ptr, size));
+    return ptr;
+  }
+  void release(void* ptr, size_t, uint32_t) override { HIP_PERF_CHECK(hipFree(ptr)); }
+  size_t footprint() override { return used() - std::min(base_, used()); }
+
+ private:
+  static size_t used() {
+    size_t free = 0;
+    size_t total = 0;
+    HIP_PERF_CHECK(hipMemGetInfo(&free, &total));
+    return total - free;
+  }
+  size_t base_;  //!< Device memory used before the replay
+};
+
+//! hipMallocAsync and hipFreeAsync of the default pool
+class PoolAllocator : public Allocator {
+ public:
+  PoolAllocator(int device, uint32_t streams) : streams_(streams) {
+    for (auto& it : streams_) {
+      HIP_PERF_CHECK(hipStreamCreate(&it));
+    }
+    HIP_PERF_CHECK(hipDeviceGetDefaultMemPool(&pool_, device));
+    uint64_t threshold = UINT64_MAX;
+    HIP_PERF_CHECK(hipMemPoolSetAttribute(pool_, hipMemPoolAttrReleaseThreshold, &threshold));
+    HIP_PERF_CHECK(hipMemPoolTrimTo(pool_, 0));
+  }
+  ~PoolAllocator() {
+    HIP_PERF_CHECK(hipMemPoolTrimTo(pool_, 0));
+    for (auto it : streams_) {
+      HIP_PERF_CHECK(hipStreamDestroy(it));
+    }
+  }
+  void* allocate(size_t size, uint32_t stream) override {
+    void* ptr = nullptr;
+    HIP_PERF_CHECK(hipMallocAsync(&ptr, size, streams_[stream % streams_.size()]));
+    return ptr;
+  }
+  void release(void* ptr, size_t, uint32_t stream) override {
+    HIP_PERF_CHECK(hipFreeAsync(ptr, streams_[stream % streams_.size()]));
+  }
+  void finish() override {
+    for (auto it : streams_) {
+      HIP_PERF_CHECK(hipStreamSynchronize(it));
+    }
+  }
+  size_t footprint() override {
+    uint64_t reserved = 0;
+    HIP_PERF_CHECK(hipMemPoolGetAttribute(pool_, hipMemPoolAttrReservedMemCurrent, &reserved));
+    return reserved;
+  }
+
+ private:
+  std::vector<hipStream_t> streams_;
+  hipMemPool_t pool_;
+};
+
+//! hipMemCreate and hipMemMap, every allocation is a separate physical allocation
+class VmmAllocator : public Allocator {
+ public:
+  explicit VmmAllocator(int device) : footprint_(0) {
+    prop_ = {};
+    prop_.type = hipMemAllocationTypePinned;
+    prop_.location.type = hipMemLocationTypeDevice;
+    prop_.location.id = device;
+    access_ = {};
+    access_.location = prop_.location;
+    access_.flags = hipMemAccessFlagsProtReadWrite;
+    HIP_PERF_CHECK(hipMemGetAllocationGranularity(&granularity_, &prop_,
+                                                  hipMemAllocationGranularityMinimum));
+  }
+  void* allocate(size_t size, uint32_t) override {
+    const size_t rounded = (size + granularity_ - 1) / granularity_ * granularity_;
+    hipMemGenericAllocationHandle_t handle;
+    void* ptr = nullptr;
+    HIP_PERF_CHECK(hipMemCreate(&handle, rounded, &prop_, 0));
+    HIP_PERF_CHECK(hipMemAddressReserve(&ptr, rounded, 0, nullptr, 0));
+    HIP_PERF_CHECK(hipMemMap(ptr, rounded, 0, handle, 0));
+    HIP_PERF_CHECK(hipMemSetAccess(ptr, rounded, &access_, 1));
+    handles_[ptr] = handle;
+    footprint_ += rounded;
+    return ptr;
+  }
+  void release(void* ptr, size_t size, uint32_t) override {
+    const size_t rounded = (size + granularity_ - 1) / granularity_ * granularity_;
+    HIP_PERF_CHECK(hipMemUnmap(ptr, rounded));
+    HIP_PERF_CHECK(hipMemRelease(handles_[ptr]));
+    HIP_PERF_CHECK(hipMemAddressFree(ptr, rounded));
+    handles_.erase(ptr);
+    footprint_ -= rounded;
+  }
+  size_t footprint() override { return footprint_; }
+
+ private:
+  hipMemAllocationProp prop_;
+  hipMemAccessDesc access_;
+  size_t granularity_;
+  size_t footprint_;
+  std::map<void*, hipMemGenericAllocationHandle_t> handles_;
+};
+
+// ================================================================================================
+static void replay(const char* name, Allocator& allocator, const std::vector<TraceOp>& trace,
+                   Reporter& reporter) {
+  std::vector<void*> ptrs(trace.size());
+  std::vector<double> allocLatency;
+  std::vector<double> releaseLatency;
+  allocLatency.reserve(trace.size() / 2);
+  releaseLatency.reserve(trace.size() / 2);
+  size_t live = 0;
+  size_t peakLive = 0;
+  size_t peakFootprint = 0;
+  double busy = 0.0;
+
+  for (size_t i = 0; i < trace.size(); ++i) {
+    const TraceOp& op = trace[i];
+    const uint64_t start = timeNs();
+    if (op.alloc_) {
+      ptrs[op.id_] = allocator.allocate(op.size_, op.stream_);
+      const double us = (timeNs() - start) / 1000.0;
+      allocLatency.push_back(us);
+      busy += us;
+      live += op.size_;
+      peakLive = std::max(peakLive, live);
+    } else {
+      allocator.release(ptrs[op.id_], op.size_, op.stream_);
+      const double us = (timeNs() - start) / 1000.0;
+      releaseLatency.push_back(us);
+      busy += us;
+      live -= op.size_;
+    }
+    // The sampling isn't a part of the measured time
+    if ((i % FootprintInterval) == 0) {
+      peakFootprint = std::max(peakFootprint, allocator.footprint());
+    }
+  }
+  allocator.finish();
+
+  const std::string config = std::string("allocator=") + name;
+  reporter.add("alloc_trace_alloc", config, "us", allocLatency);
+  reporter.add("alloc_trace_free", config, "us", releaseLatency);
+  reporter.add("alloc_trace_throughput", config, "ops/s", trace.size() * 1e6 / busy);
+  reporter.add("alloc_trace_peak_live", config, "MB", peakLive / (1024.0 * 1024.0));
+  reporter.add("alloc_trace_peak_footprint", config, "MB", peakFootprint / (1024.0 * 1024.0));
+  // The share of the held memory, which wasn't requested at the peak
+  reporter.add("alloc_trace_fragmentation", config, "%",
+               (peakFootprint > peakLive) ? 100.0 * (peakFootprint - peakLive) / peakFootprint :
+                                            0.0);
+}
+
+// ================================================================================================
+void allocatorTrace(const Options& options, Reporter& reporter) {
+  const std::vector<TraceOp> trace = generateTrace(options.iterations_ * 10);
+  {
+    MallocAllocator allocator;
+    replay("malloc", allocator, trace, reporter);
+  }
+  {
+    PoolAllocator allocator(options.device_, 1);
+    replay("mempool", allocator, trace, reporter);
+  }
+  {
+    PoolAllocator allocator(options.device_, TraceStreams);
+    replay("mempool_multistream", allocator, trace, reporter);
+  }
+  int vmm = 0;
+  HIP_PERF_CHECK(hipDeviceGetAttribute(&vmm, hipDeviceAttributeVirtualMemoryManagementSupported,
+                                       options.device_));
+  if (vmm != 0) {
+    VmmAllocator allocator(options.device_);
+    replay("vmm", allocator, trace, reporter);
+  }
+}
+
+}  // namespace hipperf
@@ -0,0 +1,133 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hipPerfCommon.hpp"
+
+#include <hip/hip_ext.h>
+
+#include <algorithm>
+
+// Instrumentation API of the runtime, see hip_device_runtime.cpp
+extern "C" hipError_t hipExtGetLatencyStats(int device, uint32_t stage,
+                                            const double* percentiles, uint64_t* values,
+                                            uint32_t numPercentiles, uint64_t* count,
+                                            uint64_t* totalNs);
+extern "C" hipError_t hipExtGetHwQueueStats(int device, uint32_t queue, uint32_t stat,
+                                            const double* percentiles, uint64_t* values,
+                                            uint32_t numPercentiles, uint64_t* count,
+                                            uint64_t* total, uint64_t* queueId);
+extern "C" hipError_t hipExtResetLatencyStats(int device);
+
+namespace hipperf {
+
+__global__ void breakdownKernel() {}
+
+//! Stages of amd::LatencyStats
+enum RuntimeStage : uint32_t { StageApi = 0, StageEnqueue, StagePacketWrite, StageDoorbell,
+                               StageCompletion };
+
+//! amd::Device::HwQueueStartLatency
+static constexpr uint32_t HwQueueStartLatency = 2;
+
+static const double Percentiles[] = {50.0, 5.0, 95.0};
+
+// ================================================================================================
+//! Reports a runtime stage in us, returns the median in us
+static double reportStage(Reporter& reporter, int device, uint32_t stage, const char* name) {
+  uint64_t values[3] = {};
+  uint64_t count = 0;
+  HIP_PERF_CHECK(hipExtGetLatencyStats(device, stage, Percentiles, values, 3, &count, nullptr));
+  reporter.print("launch_breakdown", std::string("stage=") + name, "us", values[0] / 1000.0,
+                 values[1] / 1000.0, values[2] / 1000.0, count);
+  return values[0] / 1000.0;
+}
+
+// ================================================================================================
+void launchBreakdown(const Options& options, Reporter& reporter) {
+  hipStream_t stream;
+  HIP_PERF_CHECK(hipStreamCreate(&stream));
+  hipLaunchKernelGGL(breakdownKernel, dim3(1), dim3(1), 0, stream);
+  HIP_PERF_CHECK(hipStreamSynchronize(stream));
+
+  // Host side stages. The launches aren't synchronized one by one, because the waits add
+  // markers into the runtime histograms, hence a single wait follows the whole loop
+  HIP_PERF_CHECK(hipExtResetLatencyStats(options.device_));
+  std::vector<double> api(options.iterations_);
+  for (auto& it : api) {
+    const uint64_t start = timeNs();
+    hipLaunchKernelGGL(breakdownKernel, dim3(1), dim3(1), 0, stream);
+    it = (timeNs() - start) / 1000.0;
+  }
+  HIP_PERF_CHECK(hipStreamSynchronize(stream));
+
+  // The API time includes the enqueue, the enqueue includes the packet write and
+  // the doorbell in the direct dispatch mode
+  reporter.add("launch_breakdown", "stage=host_api", "us", api);
+  const double apiMedian = reportStage(reporter, options.device_, StageApi, "api");
+  const double enqueue = reportStage(reporter, options.device_, StageEnqueue, "enqueue");
+  const double packet = reportStage(reporter, options.device_, StagePacketWrite, "packet_write");
+  const double doorbell = reportStage(reporter, options.device_, StageDoorbell, "doorbell");
+  reportStage(reporter, options.device_, StageCompletion, "completion");
+  reporter.add("launch_breakdown", "stage=validation", "us", std::max(0.0, apiMedian - enqueue));
+  reporter.add("launch_breakdown", "stage=queue_handoff", "us",
+               std::max(0.0, enqueue - packet - doorbell));
+
+  // Device side stages. The events enable the kernel timestamps, which give the execution
+  // time and the CP pickup from the submission to the GPU start
+  hipEvent_t start;
+  hipEvent_t stop;
+  HIP_PERF_CHECK(hipEventCreate(&start));
+  HIP_PERF_CHECK(hipEventCreate(&stop));
+  std::vector<double> execution(options.iterations_);
+  for (auto& it : execution) {
+    hipExtLaunchKernelGGL(breakdownKernel, dim3(1), dim3(1), 0, stream, start, stop, 0);
+    HIP_PERF_CHECK(hipEventSynchronize(stop));
+    float ms = 0.0f;
+    HIP_PERF_CHECK(hipEventElapsedTime(&ms, start, stop));
+    it = ms * 1000.0;
+  }
+  reporter.add("launch_breakdown", "stage=kernel_execution", "us", execution);
+
+  // The HW queue histograms aren't reset, hence report the queue with the most samples
+  uint64_t best[3] = {};
+  uint64_t bestCount = 0;
+  for (uint32_t queue = 0; ; ++queue) {
+    uint64_t values[3] = {};
+    uint64_t count = 0;
+    if (hipExtGetHwQueueStats(options.device_, queue, HwQueueStartLatency, Percentiles, values,
+                              3, &count, nullptr, nullptr) != hipSuccess) {
+      break;
+    }
+    if (count > bestCount) {
+      std::copy(values, values + 3, best);
+      bestCount = count;
+    }
+  }
+  if (bestCount != 0) {
+    reporter.print("launch_breakdown", "stage=cp_pickup", "us", best[0] / 1000.0,
+                   best[1] / 1000.0, best[2] / 1000.0, bestCount);
+  }
+
+  HIP_PERF_CHECK(hipEventDestroy(start));
+  HIP_PERF_CHECK(hipEventDestroy(stop));
+  HIP_PERF_CHECK(hipStreamDestroy(stream));
+}
+
+}  // namespace hipperf
@@ -0,0 +1,126 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include <hip/hip_runtime.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! Aborts the benchmark on a failed HIP call, the results are meaningless after an error
+#define HIP_PERF_CHECK(cmd)                                                                     \
+  do {                                                                                          \
+    hipError_t status = (cmd);                                                                  \
+    if (status != hipSuccess) {                                                                 \
+      fprintf(stderr, "%s:%d: %s failed: %s\n", __FILE__, __LINE__, #cmd,                       \
+              hipGetErrorString(status));                                                       \
+      exit(EXIT_FAILURE);                                                                       \
+    }                                                                                           \
+  } while (false)
+
+namespace hipperf {
+
+//! Returns the host time in ns
+inline uint64_t timeNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//! Command line options shared by all benchmarks
+struct Options {
+  int device_ = 0;              //!< Device under the test
+  uint32_t iterations_ = 1000;  //!< Samples of the latency benchmarks
+  std::string filter_;          //!< Runs only the benchmarks, which contain this string
+  bool csv_ = false;            //!< Prints CSV instead of JSON
+  std::string module_;          //!< Code object of the module load benchmark
+  bool child_ = false;          //!< The process runs a part of a benchmark for its parent
+  std::string capture_;         //!< HIP_API_CAPTURE_FILE of the replay benchmark
+};
+
+/*! \brief Collects the results and prints them in a machine-readable format
+ *
+ *  Every result is one JSON object per line or one CSV row, so the output can be
+ *  appended across runs and parsed without a custom log parser.
+ */
+class Reporter {
+ public:
+  Reporter(const Options& options, const std::string& device)
+      : options_(options), device_(device) {}
+
+  //! Prints the header of the CSV output
+  void begin();
+
+  //! Reports a single value, such as the bandwidth
+  void add(const char* test, const std::string& config, const char* unit, double value);
+
+  //! Reports the median of the samples, together with p5, p95 and the sample count
+  void add(const char* test, const std::string& config, const char* unit,
+           std::vector<double>& samples);
+
+  //! Reports the statistics collected elsewhere, such as in the runtime
+  void print(const char* test, const std::string& config, const char* unit, double median,
+             double p5, double p95, size_t count);
+
+ private:
+
+  const Options& options_;
+  std::string device_;  //!< Device name, repeated in every record
+};
+
+/*! \brief Runs hipperf again with \a args and the additional environment \a env
+ *
+ *  The runtime reads most settings once, hence a benchmark of the settings needs new
+ *  processes. The stdout of the child goes into \a stdoutFd. Returns false on a failure.
+ */
+bool runSelf(const std::vector<std::string>& args,
+             const std::vector<std::pair<std::string, std::string>>& env, int stdoutFd);
+
+//! Benchmark entry point
+typedef void (*BenchmarkFn)(const Options& options, Reporter& reporter);
+
+// Benchmarks
+void launchLatency(const Options& options, Reporter& reporter);
+void launchBreakdown(const Options& options, Reporter& reporter);
+void launchThroughput(const Options& options, Reporter& reporter);
+void graphLaunch(const Options& options, Reporter& reporter);
+void graphScaling(const Options& options, Reporter& reporter);
+void eventRecord(const Options& options, Reporter& reporter);
+void streamCreate(const Options& options, Reporter& reporter);
+void memPoolAlloc(const Options& options, Reporter& reporter);
+void allocatorTrace(const Options& options, Reporter& reporter);
+void memcpyBandwidth(const Options& options, Reporter& reporter);
+void peerBandwidth(const Options& options, Reporter& reporter);
+void transferMatrix(const Options& options, Reporter& reporter);
+void startupTime(const Options& options, Reporter& reporter);
+void captureReplay(const Options& options, Reporter& reporter);
+void persistentLatency(const Options& options, Reporter& reporter);
+
+//! Returns true in the processes, which startupTime() creates
+bool isStartupChild();
+
+//! Runs the measured phases of a startupTime() process, \a mainNs is the time of main()
+int startupChild(const Options& options, uint64_t mainNs);
+
+}  // namespace hipperf
@@ -0,0 +1,232 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hipPerfCommon.hpp"
+
+#include <algorithm>
+
+namespace hipperf {
+
+__global__ void graphKernel(uint32_t) {}
+
+//! Kernel nodes of the generated graphs
+static const uint32_t GraphNodes[] = {10, 100, 1000, 10000, 100000};
+
+//! Kernel nodes in one child graph of the nested shape
+static constexpr uint32_t ChildNodes = 10;
+
+//! The larger graphs of a shape are skipped, once the instantiation takes longer, in ms
+static constexpr double MaxInstantiateMs = 10000.0;
+
+//! Graph topologies
+enum class Shape { Chain, FanOut, Diamond, Nested };
+
+static const struct {
+  Shape shape_;
+  const char* name_;
+} Shapes[] = {{Shape::Chain, "chain"}, {Shape::FanOut, "fanout"}, {Shape::Diamond, "diamond"},
+              {Shape::Nested, "nested"}};
+
+//! Generated graph together with its top level kernel nodes
+struct Graph {
+  hipGraph_t graph_;
+  std::vector<hipGraphNode_t> kernels_;
+};
+
+// ================================================================================================
+static hipKernelNodeParams kernelParams(void** args) {
+  hipKernelNodeParams params = {};
+  params.func = reinterpret_cast<void*>(graphKernel);
+  params.gridDim = dim3(1);
+  params.blockDim = dim3(1);
+  params.kernelParams = args;
+  return params;
+}
+
+// ================================================================================================
+static hipGraphNode_t addKernel(hipGraph_t graph, const hipGraphNode_t* deps, size_t numDeps,
+                                uint32_t value) {
+  void* args[] = {&value};
+  const hipKernelNodeParams params = kernelParams(args);
+  hipGraphNode_t node;
+  HIP_PERF_CHECK(hipGraphAddKernelNode(&node, graph, deps, numDeps, &params));
+  return node;
+}
+
+// ================================================================================================
+static void addChain(hipGraph_t graph, uint32_t nodes, uint32_t value,
+                     std::vector<hipGraphNode_t>& kernels) {
+  hipGraphNode_t prev = nullptr;
+  for (uint32_t i = 0; i < nodes; ++i) {
+    prev = addKernel(graph, &prev, (prev != nullptr) ? 1 : 0, value);
+    kernels.push_back(prev);
+  }
+}
+
+// ================================================================================================
+/*! \brief Builds a graph of \a nodes kernels
+ *
+ *  The fan-out is one root, the parallel kernels and one join. The diamonds are a chain of
+ *  a fork into 2 kernels and a join. The nested graph is a chain of child graphs with
+ *  ChildNodes kernels each. \a value is the kernel argument, so 2 graphs of the same shape
+ *  differ only in the parameters, as hipGraphExecUpdate() expects.
+ */
+static Graph buildGraph(Shape shape, uint32_t nodes, uint32_t value) {
+  Graph result;
+  HIP_PERF_CHECK(hipGraphCreate(&result.graph_, 0));
+  std::vector<hipGraphNode_t>& kernels = result.kernels_;
+  kernels.reserve(nodes);
+
+  switch (shape) {
+    case Shape::Chain:
+      addChain(result.graph_, nodes, value, kernels);
+      break;
+    case Shape::FanOut: {
+      const hipGraphNode_t root = addKernel(result.graph_, nullptr, 0, value);
+      kernels.push_back(root);
+      std::vector<hipGraphNode_t> leaves;
+      for (uint32_t i = 2; i < nodes; ++i) {
+        leaves.push_back(addKernel(result.graph_, &root, 1, value));
+      }
+      kernels.insert(kernels.end(), leaves.begin(), leaves.end());
+      kernels.push_back(addKernel(result.graph_, leaves.data(), leaves.size(), value));
+      break;
+    }
+    case Shape::Diamond: {
+      hipGraphNode_t join = addKernel(result.graph_, nullptr, 0, value);
+      kernels.push_back(join);
+      for (uint32_t i = 1; i + 3 <= nodes; i += 3) {
+        hipGraphNode_t fork[2];
+        fork[0] = addKernel(result.graph_, &join, 1, value);
+        fork[1] = addKernel(result.graph_, &join, 1, value);
+        join = addKernel(result.graph_, fork, 2, value);
+        kernels.insert(kernels.end(), {fork[0], fork[1], join});
+      }
+      break;
+    }
+    case Shape::Nested: {
+      hipGraphNode_t prev = nullptr;
+      for (uint32_t i = 0; i < nodes; i += ChildNodes) {
+        hipGraph_t child;
+        std::vector<hipGraphNode_t> childKernels;
+        HIP_PERF_CHECK(hipGraphCreate(&child, 0));
+        addChain(child, std::min(ChildNodes, nodes - i), value, childKernels);
+        // The child graph is cloned into the node
+        hipGraphNode_t node;
+        HIP_PERF_CHECK(hipGraphAddChildGraphNode(&node, result.graph_, &prev,
+                                                 (prev != nullptr) ? 1 : 0, child));
+        HIP_PERF_CHECK(hipGraphDestroy(child));
+        prev = node;
+      }
+      break;
+    }
+  }
+  return result;
+}
+
+// ================================================================================================
+void graphScaling(const Options& options, Reporter& reporter) {
+  hipStream_t stream;
+  HIP_PERF_CHECK(hipStreamCreate(&stream));
+
+  for (const auto& shape : Shapes) {
+    for (auto nodes : GraphNodes) {
+      const std::string config =
+          std::string("shape=") + shape.name_ + ",nodes=" + std::to_string(nodes);
+      // Fewer samples of the large graphs, every sample is O(nodes) at least
+      const uint32_t samples = std::max(3u, std::min(options.iterations_, 100000 / nodes));
+
+      Graph graph = buildGraph(shape.shape_, nodes, 0);
+      Graph update = buildGraph(shape.shape_, nodes, 1);
+
+      hipGraphExec_t exec = nullptr;
+      std::vector<double> instantiate(std::max(1u, samples / 10));
+      for (auto& it : instantiate) {
+        if (exec != nullptr) {
+          HIP_PERF_CHECK(hipGraphExecDestroy(exec));
+        }
+        const uint64_t start = timeNs();
+        HIP_PERF_CHECK(hipGraphInstantiate(&exec, graph.graph_, nullptr, nullptr, 0));
+        it = (timeNs() - start) / 1000.0;
+      }
+      const double maxInstantiate = *std::max_element(instantiate.begin(), instantiate.end());
+      reporter.add("graph_instantiate", config, "us", instantiate);
+
+      // The first launch creates the commands of the nodes
+      HIP_PERF_CHECK(hipGraphLaunch(exec, stream));
+      HIP_PERF_CHECK(hipStreamSynchronize(stream));
+
+      // The enqueue is the host cost of FillCommands() and the submission
+      std::vector<double> enqueue(samples);
+      std::vector<double> launch(samples);
+      for (uint32_t i = 0; i < samples; ++i) {
+        const uint64_t start = timeNs();
+        HIP_PERF_CHECK(hipGraphLaunch(exec, stream));
+        enqueue[i] = (timeNs() - start) / 1000.0;
+        HIP_PERF_CHECK(hipStreamSynchronize(stream));
+        launch[i] = (timeNs() - start) / 1000.0 / nodes;
+      }
+      reporter.add("graph_launch_enqueue", config, "us", enqueue);
+      reporter.add("graph_launch", config, "us/node", launch);
+
+      std::vector<double> execUpdate(samples);
+      for (uint32_t i = 0; i < samples; ++i) {
+        hipGraphNode_t errorNode;
+        hipGraphExecUpdateResult result;
+        // Alternate between the graphs, so every update changes the parameters
+        hipGraph_t source = ((i & 1) == 0) ? update.graph_ : graph.graph_;
+        const uint64_t start = timeNs();
+        HIP_PERF_CHECK(hipGraphExecUpdate(exec, source, &errorNode, &result));
+        execUpdate[i] = (timeNs() - start) / 1000.0;
+      }
+      reporter.add("graph_exec_update", config, "us", execUpdate);
+
+      // The child graph nodes have no kernel parameters of their own
+      if (!graph.kernels_.empty()) {
+        std::vector<double> setParams(std::min<size_t>(options.iterations_,
+                                                       graph.kernels_.size()));
+        for (size_t i = 0; i < setParams.size(); ++i) {
+          uint32_t value = static_cast<uint32_t>(i);
+          void* args[] = {&value};
+          const hipKernelNodeParams params = kernelParams(args);
+          // Spread the nodes over the graph, the lookup may depend on the position
+          hipGraphNode_t node = graph.kernels_[i * graph.kernels_.size() / setParams.size()];
+          const uint64_t start = timeNs();
+          HIP_PERF_CHECK(hipGraphExecKernelNodeSetParams(exec, node, &params));
+          setParams[i] = (timeNs() - start) / 1000.0;
+        }
+        reporter.add("graph_exec_kernel_set_params", config, "us", setParams);
+      }
+
+      HIP_PERF_CHECK(hipGraphExecDestroy(exec));
+      HIP_PERF_CHECK(hipGraphDestroy(update.graph_));
+      HIP_PERF_CHECK(hipGraphDestroy(graph.graph_));
+
+      if (maxInstantiate / 1000.0 > MaxInstantiateMs) {
+        fprintf(stderr, "graph_scaling: shape=%s stops at %u nodes, instantiate took %.0f ms\n",
+                shape.name_, nodes, maxInstantiate / 1000.0);
+        break;
+      }
+    }
+  }
+  HIP_PERF_CHECK(hipStreamDestroy(stream));
+}
+
+}  // namespace hipperf
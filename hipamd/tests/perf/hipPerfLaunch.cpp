@@ -0,0 +1,181 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hipPerfCommon.hpp"
+
+#include <algorithm>
+
+namespace hipperf {
+
+__global__ void emptyKernel() {}
+
+//! Block sizes of the launch benchmarks, the small grids keep the runtime overhead dominant
+static const uint32_t LaunchThreads[] = {1, 2, 4, 8, 16, 32, 64};
+
+//! Launches in one graph or one batch of the stream launches
+static constexpr uint32_t GraphKernels = 64;
+
+// ================================================================================================
+void launchLatency(const Options& options, Reporter& reporter) {
+  hipStream_t stream;
+  HIP_PERF_CHECK(hipStreamCreate(&stream));
+  for (auto threads : LaunchThreads) {
+    // Warm up, the first launch loads the code object
+    hipLaunchKernelGGL(emptyKernel, dim3(1), dim3(threads), 0, stream);
+    HIP_PERF_CHECK(hipStreamSynchronize(stream));
+
+    std::vector<double> samples(options.iterations_);
+    for (auto& it : samples) {
+      const uint64_t start = timeNs();
+      hipLaunchKernelGGL(emptyKernel, dim3(1), dim3(threads), 0, stream);
+      HIP_PERF_CHECK(hipStreamSynchronize(stream));
+      it = (timeNs() - start) / 1000.0;
+    }
+    reporter.add("launch_latency", "threads=" + std::to_string(threads), "us", samples);
+  }
+  HIP_PERF_CHECK(hipStreamDestroy(stream));
+}
+
+// ================================================================================================
+void launchThroughput(const Options& options, Reporter& reporter) {
+  hipStream_t stream;
+  HIP_PERF_CHECK(hipStreamCreate(&stream));
+  for (auto threads : LaunchThreads) {
+    hipLaunchKernelGGL(emptyKernel, dim3(1), dim3(threads), 0, stream);
+    HIP_PERF_CHECK(hipStreamSynchronize(stream));
+
+    // The enqueue cost of a launch, without the completion wait
+    std::vector<double> enqueue(options.iterations_);
+    const uint64_t start = timeNs();
+    for (auto& it : enqueue) {
+      const uint64_t launch = timeNs();
+      hipLaunchKernelGGL(emptyKernel, dim3(1), dim3(threads), 0, stream);
+      it = (timeNs() - launch) / 1000.0;
+    }
+    HIP_PERF_CHECK(hipStreamSynchronize(stream));
+    const double total = (timeNs() - start) / 1000.0;
+
+    const std::string config = "threads=" + std::to_string(threads);
+    reporter.add("launch_enqueue", config, "us", enqueue);
+    reporter.add("launch_throughput", config, "launches/s", options.iterations_ * 1e6 / total);
+  }
+  HIP_PERF_CHECK(hipStreamDestroy(stream));
+}
+
+// ================================================================================================
+void graphLaunch(const Options& options, Reporter& reporter) {
+  hipStream_t stream;
+  HIP_PERF_CHECK(hipStreamCreate(&stream));
+
+  hipGraph_t graph;
+  hipGraphExec_t exec;
+  HIP_PERF_CHECK(hipStreamBeginCapture(stream, hipStreamCaptureModeGlobal));
+  for (uint32_t i = 0; i < GraphKernels; ++i) {
+    hipLaunchKernelGGL(emptyKernel, dim3(1), dim3(1), 0, stream);
+  }
+  HIP_PERF_CHECK(hipStreamEndCapture(stream, &graph));
+  HIP_PERF_CHECK(hipGraphInstantiate(&exec, graph, nullptr, nullptr, 0));
+  HIP_PERF_CHECK(hipGraphLaunch(exec, stream));
+  HIP_PERF_CHECK(hipStreamSynchronize(stream));
+
+  const uint32_t iterations = std::max(1u, options.iterations_ / GraphKernels);
+  const std::string config = "kernels=" + std::to_string(GraphKernels);
+
+  // The same work as a graph and as the stream launches, in us per kernel
+  std::vector<double> graphSamples(iterations);
+  for (auto& it : graphSamples) {
+    const uint64_t start = timeNs();
+    HIP_PERF_CHECK(hipGraphLaunch(exec, stream));
+    HIP_PERF_CHECK(hipStreamSynchronize(stream));
+    it = (timeNs() - start) / 1000.0 / GraphKernels;
+  }
+  reporter.add("graph_launch", config, "us/kernel", graphSamples);
+
+  std::vector<double> streamSamples(iterations);
+  for (auto& it : streamSamples) {
+    const uint64_t start = timeNs();
+    for (uint32_t i = 0; i < GraphKernels; ++i) {
+      hipLaunchKernelGGL(emptyKernel, dim3(1), dim3(1), 0, stream);
+    }
+    HIP_PERF_CHECK(hipStreamSynchronize(stream));
+    it = (timeNs() - start) / 1000.0 / GraphKernels;
+  }
+  reporter.add("stream_launch", config, "us/kernel", streamSamples);
+
+  HIP_PERF_CHECK(hipGraphExecDestroy(exec));
+  HIP_PERF_CHECK(hipGraphDestroy(graph));
+  HIP_PERF_CHECK(hipStreamDestroy(stream));
+}
+
+// ================================================================================================
+void eventRecord(const Options& options, Reporter& reporter) {
+  hipStream_t stream;
+  HIP_PERF_CHECK(hipStreamCreate(&stream));
+  const struct {
+    const char* name_;
+    unsigned flags_;
+  } Events[] = {{"default", hipEventDefault}, {"disable_timing", hipEventDisableTiming}};
+
+  for (const auto& type : Events) {
+    hipEvent_t event;
+    HIP_PERF_CHECK(hipEventCreateWithFlags(&event, type.flags_));
+    HIP_PERF_CHECK(hipEventRecord(event, stream));
+    HIP_PERF_CHECK(hipEventSynchronize(event));
+
+    std::vector<double> record(options.iterations_);
+    std::vector<double> query(options.iterations_);
+    for (uint32_t i = 0; i < options.iterations_; ++i) {
+      uint64_t start = timeNs();
+      HIP_PERF_CHECK(hipEventRecord(event, stream));
+      record[i] = (timeNs() - start) / 1000.0;
+      HIP_PERF_CHECK(hipEventSynchronize(event));
+      // The query of a completed event is the common polling case
+      start = timeNs();
+      HIP_PERF_CHECK(hipEventQuery(event));
+      query[i] = (timeNs() - start) / 1000.0;
+    }
+    const std::string config = std::string("flags=") + type.name_;
+    reporter.add("event_record", config, "us", record);
+    reporter.add("event_query", config, "us", query);
+    HIP_PERF_CHECK(hipEventDestroy(event));
+  }
+  HIP_PERF_CHECK(hipStreamDestroy(stream));
+}
+
+// ================================================================================================
+void streamCreate(const Options& options, Reporter& reporter) {
+  // Per request streams of the servers: create, launch once and destroy.
+  // The first cycle creates the device queue, the next cycles reuse it from the stream pool
+  std::vector<double> create(options.iterations_);
+  std::vector<double> cycle(options.iterations_);
+  for (uint32_t i = 0; i < options.iterations_; ++i) {
+    hipStream_t stream;
+    const uint64_t start = timeNs();
+    HIP_PERF_CHECK(hipStreamCreate(&stream));
+    hipLaunchKernelGGL(emptyKernel, dim3(1), dim3(1), 0, stream);
+    create[i] = (timeNs() - start) / 1000.0;
+    HIP_PERF_CHECK(hipStreamDestroy(stream));
+    cycle[i] = (timeNs() - start) / 1000.0;
+  }
+  reporter.add("stream_create", "launch=1", "us", create);
+  reporter.add("stream_cycle", "launch=1", "us", cycle);
+}
+
+}  // namespace hipperf
@@ -0,0 +1,210 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hipPerfCommon.hpp"
+
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+extern char** environ;
+
+namespace hipperf {
+
+// ================================================================================================
+void Reporter::begin() {
+  // The parent has printed the header already
+  if (options_.csv_ && !options_.child_) {
+    printf("test,config,device,unit,median,p5,p95,samples\n");
+  }
+}
+
+// ================================================================================================
+void Reporter::add(const char* test, const std::string& config, const char* unit, double value) {
+  print(test, config, unit, value, value, value, 1);
+}
+
+// ================================================================================================
+void Reporter::add(const char* test, const std::string& config, const char* unit,
+                   std::vector<double>& samples) {
+  if (samples.empty()) {
+    return;
+  }
+  std::sort(samples.begin(), samples.end());
+  auto percentile = [&samples](double percent) {
+    return samples[static_cast<size_t>(percent * (samples.size() - 1) / 100.0 + 0.5)];
+  };
+  print(test, config, unit, percentile(50), percentile(5), percentile(95), samples.size());
+}
+
+// ================================================================================================
+void Reporter::print(const char* test, const std::string& config, const char* unit,
+                     double median, double p5, double p95, size_t count) {
+  if (options_.csv_) {
+    printf("%s,\"%s\",\"%s\",%s,%.3f,%.3f,%.3f,%zu\n", test, config.c_str(), device_.c_str(), unit,
+           median, p5, p95, count);
+  } else {
+    printf("{\"test\":\"%s\",\"config\":\"%s\",\"device\":\"%s\",\"unit\":\"%s\","
+           "\"median\":%.3f,\"p5\":%.3f,\"p95\":%.3f,\"samples\":%zu}\n",
+           test, config.c_str(), device_.c_str(), unit, median, p5, p95, count);
+  }
+  fflush(stdout);
+}
+
+// ================================================================================================
+bool runSelf(const std::vector<std::string>& args,
+             const std::vector<std::pair<std::string, std::string>>& env, int stdoutFd) {
+  std::vector<std::string> vars;
+  for (const auto& it : env) {
+    vars.push_back(it.first + "=" + it.second);
+  }
+  vars.push_back("HIPPERF_CHILD=1");
+  // getenv() returns the first match, but drop the replaced variables all the same
+  for (char** it = environ; *it != nullptr; ++it) {
+    const char* name = *it;
+    const size_t length = strcspn(name, "=");
+    if (std::none_of(env.begin(), env.end(), [&](const std::pair<std::string, std::string>& var) {
+          return var.first.compare(0, std::string::npos, name, length) == 0;
+        })) {
+      vars.push_back(name);
+    }
+  }
+  std::vector<char*> envp;
+  for (auto& it : vars) {
+    envp.push_back(&it[0]);
+  }
+  envp.push_back(nullptr);
+
+  std::vector<std::string> cmd(args);
+  cmd.insert(cmd.begin(), "hipperf");
+  std::vector<char*> argv;
+  for (auto& it : cmd) {
+    argv.push_back(&it[0]);
+  }
+  argv.push_back(nullptr);
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  if (stdoutFd != STDOUT_FILENO) {
+    posix_spawn_file_actions_adddup2(&actions, stdoutFd, STDOUT_FILENO);
+    posix_spawn_file_actions_addclose(&actions, stdoutFd);
+  }
+  fflush(stdout);
+  pid_t pid;
+  const int status = posix_spawn(&pid, "/proc/self/exe", &actions, nullptr, argv.data(),
+                                 envp.data());
+  posix_spawn_file_actions_destroy(&actions);
+  if (status != 0) {
+    fprintf(stderr, "posix_spawn failed: %s\n", strerror(status));
+    return false;
+  }
+  int exitCode;
+  return (waitpid(pid, &exitCode, 0) == pid) && WIFEXITED(exitCode) &&
+      (WEXITSTATUS(exitCode) == EXIT_SUCCESS);
+}
+
+}  // namespace hipperf
+
+using namespace hipperf;
+
+static const struct {
+  const char* name_;
+  BenchmarkFn run_;
+} Benchmarks[] = {
+  {"launch_latency", launchLatency},
+  {"launch_breakdown", launchBreakdown},
+  {"launch_throughput", launchThroughput},
+  {"graph_launch", graphLaunch},
+  {"graph_scaling", graphScaling},
+  {"event_record", eventRecord},
+  {"stream_create", streamCreate},
+  {"mempool_alloc", memPoolAlloc},
+  {"alloc_trace", allocatorTrace},
+  {"memcpy_bandwidth", memcpyBandwidth},
+  {"peer_bandwidth", peerBandwidth},
+  {"transfer_matrix", transferMatrix},
+  {"startup_time", startupTime},
+  {"capture_replay", captureReplay},
+  {"persistent_latency", persistentLatency},
+};
+
+static void usage(const char* name) {
+  printf("Usage: %s [-d <device>] [-i <iterations>] [-t <test filter>] [-m <code object>] [-r <capture>] "
+         "[-csv] [-l]\n", name);
+}
+
+int main(int argc, char** argv) {
+  const uint64_t mainNs = timeNs();
+  Options options;
+  options.child_ = (getenv("HIPPERF_CHILD") != nullptr);
+  bool list = false;
+  for (int i = 1; i < argc; ++i) {
+    if ((strcmp(argv[i], "-d") == 0) && (i + 1 < argc)) {
+      options.device_ = atoi(argv[++i]);
+    } else if ((strcmp(argv[i], "-i") == 0) && (i + 1 < argc)) {
+      options.iterations_ = std::max(1, atoi(argv[++i]));
+    } else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) {
+      options.filter_ = argv[++i];
+    } else if ((strcmp(argv[i], "-m") == 0) && (i + 1 < argc)) {
+      options.module_ = argv[++i];
+    } else if ((strcmp(argv[i], "-r") == 0) && (i + 1 < argc)) {
+      options.capture_ = argv[++i];
+    } else if (strcmp(argv[i], "-csv") == 0) {
+      options.csv_ = true;
+    } else if (strcmp(argv[i], "-l") == 0) {
+      list = true;
+    } else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (list) {
+    for (const auto& it : Benchmarks) {
+      printf("%s\n", it.name_);
+    }
+    return EXIT_SUCCESS;
+  }
+
+  // The startup benchmark measures the runtime init, hence it must run first
+  if (isStartupChild()) {
+    return startupChild(options, mainNs);
+  }
+
+  HIP_PERF_CHECK(hipSetDevice(options.device_));
+  hipDeviceProp_t props;
+  HIP_PERF_CHECK(hipGetDeviceProperties(&props, options.device_));
+  int driver = 0;
+  HIP_PERF_CHECK(hipDriverGetVersion(&driver));
+  const std::string device = std::string(props.gcnArchName) + " (" + props.name + ", driver " +
+      std::to_string(driver) + ")";
+
+  Reporter reporter(options, device);
+  reporter.begin();
+  for (const auto& it : Benchmarks) {
+    if (options.filter_.empty() || (strstr(it.name_, options.filter_.c_str()) != nullptr)) {
+      it.run_(options, reporter);
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,191 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hipPerfCommon.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace hipperf {
+
+//! Repeats the copies until this amount of data is transferred
+static constexpr size_t CopyBytes = 1024ull * 1024 * 1024;
+
+// ================================================================================================
+static std::string sizeConfig(size_t size) {
+  return (size >= 1024 * 1024) ? ("size=" + std::to_string(size / (1024 * 1024)) + "MB") :
+                                 ("size=" + std::to_string(size / 1024) + "KB");
+}
+
+// ================================================================================================
+void memPoolAlloc(const Options& options, Reporter& reporter) {
+  hipStream_t stream;
+  HIP_PERF_CHECK(hipStreamCreate(&stream));
+  hipMemPool_t pool;
+  HIP_PERF_CHECK(hipDeviceGetDefaultMemPool(&pool, options.device_));
+  // Keep the freed memory in the pool, otherwise the benchmark measures the OS allocations
+  uint64_t threshold = UINT64_MAX;
+  HIP_PERF_CHECK(hipMemPoolSetAttribute(pool, hipMemPoolAttrReleaseThreshold, &threshold));
+
+  for (size_t size = 4 * 1024; size <= 64 * 1024 * 1024; size *= 4) {
+    void* ptr = nullptr;
+    HIP_PERF_CHECK(hipMallocAsync(&ptr, size, stream));
+    HIP_PERF_CHECK(hipFreeAsync(ptr, stream));
+    HIP_PERF_CHECK(hipStreamSynchronize(stream));
+
+    std::vector<double> alloc(options.iterations_);
+    std::vector<double> release(options.iterations_);
+    for (uint32_t i = 0; i < options.iterations_; ++i) {
+      uint64_t start = timeNs();
+      HIP_PERF_CHECK(hipMallocAsync(&ptr, size, stream));
+      alloc[i] = (timeNs() - start) / 1000.0;
+      start = timeNs();
+      HIP_PERF_CHECK(hipFreeAsync(ptr, stream));
+      release[i] = (timeNs() - start) / 1000.0;
+    }
+    HIP_PERF_CHECK(hipStreamSynchronize(stream));
+    reporter.add("mempool_alloc", sizeConfig(size), "us", alloc);
+    reporter.add("mempool_free", sizeConfig(size), "us", release);
+  }
+  HIP_PERF_CHECK(hipMemPoolTrimTo(pool, 0));
+  HIP_PERF_CHECK(hipStreamDestroy(stream));
+}
+
+// ================================================================================================
+//! Returns the bandwidth of \a copy in GB/s, the copy is repeated to transfer CopyBytes
+template <typename Copy>
+static double bandwidth(size_t size, hipStream_t stream, Copy copy) {
+  copy();
+  HIP_PERF_CHECK(hipStreamSynchronize(stream));
+  const size_t repeats = std::max<size_t>(1, CopyBytes / size);
+  const uint64_t start = timeNs();
+  for (size_t i = 0; i < repeats; ++i) {
+    copy();
+  }
+  HIP_PERF_CHECK(hipStreamSynchronize(stream));
+  return static_cast<double>(size) * repeats / (timeNs() - start);
+}
+
+// ================================================================================================
+void memcpyBandwidth(const Options& options, Reporter& reporter) {
+  constexpr size_t MaxSize = 256 * 1024 * 1024;
+  hipStream_t stream;
+  HIP_PERF_CHECK(hipStreamCreate(&stream));
+  void* device = nullptr;
+  void* pinned = nullptr;
+  HIP_PERF_CHECK(hipMalloc(&device, MaxSize));
+  HIP_PERF_CHECK(hipHostMalloc(&pinned, MaxSize));
+  void* pageable = malloc(MaxSize);
+  if (pageable == nullptr) {
+    fprintf(stderr, "Pageable allocation failed\n");
+    exit(EXIT_FAILURE);
+  }
+  memset(pageable, 0, MaxSize);
+
+  const struct {
+    const char* name_;
+    void* host_;
+  } Hosts[] = {{"pageable", pageable}, {"pinned", pinned}};
+
+  for (const auto& host : Hosts) {
+    for (size_t size = 4 * 1024; size <= MaxSize; size *= 4) {
+      const std::string config = std::string("host=") + host.name_ + "," + sizeConfig(size);
+      reporter.add("memcpy_h2d", config, "GB/s", bandwidth(size, stream, [&]() {
+        HIP_PERF_CHECK(hipMemcpyAsync(device, host.host_, size, hipMemcpyHostToDevice, stream));
+      }));
+      reporter.add("memcpy_d2h", config, "GB/s", bandwidth(size, stream, [&]() {
+        HIP_PERF_CHECK(hipMemcpyAsync(host.host_, device, size, hipMemcpyDeviceToHost, stream));
+      }));
+    }
+  }
+
+  // The return time of a pageable async copy, which is staged without the wait for the copy
+  for (size_t size = 4 * 1024; size <= 4 * 1024 * 1024; size *= 4) {
+    std::vector<double> samples(options.iterations_);
+    for (auto& it : samples) {
+      const uint64_t start = timeNs();
+      HIP_PERF_CHECK(hipMemcpyAsync(device, pageable, size, hipMemcpyHostToDevice, stream));
+      it = (timeNs() - start) / 1000.0;
+      HIP_PERF_CHECK(hipStreamSynchronize(stream));
+    }
+    reporter.add("memcpy_h2d_return", "host=pageable," + sizeConfig(size), "us", samples);
+  }
+
+  // The latency of a small synchronous read into pageable memory, such as a reduction result
+  for (size_t size = 4; size <= 256; size *= 4) {
+    std::vector<double> samples(options.iterations_);
+    for (auto& it : samples) {
+      const uint64_t start = timeNs();
+      HIP_PERF_CHECK(hipMemcpy(pageable, device, size, hipMemcpyDeviceToHost));
+      it = (timeNs() - start) / 1000.0;
+    }
+    reporter.add("memcpy_d2h_small", "host=pageable," + sizeConfig(size), "us", samples);
+  }
+
+  free(pageable);
+  HIP_PERF_CHECK(hipHostFree(pinned));
+  HIP_PERF_CHECK(hipFree(device));
+  HIP_PERF_CHECK(hipStreamDestroy(stream));
+}
+
+// ================================================================================================
+void peerBandwidth(const Options& options, Reporter& reporter) {
+  constexpr size_t MaxSize = 64 * 1024 * 1024;
+  int count = 0;
+  HIP_PERF_CHECK(hipGetDeviceCount(&count));
+
+  for (int peer = 0; peer < count; ++peer) {
+    int access = 0;
+    if (peer != options.device_) {
+      HIP_PERF_CHECK(hipDeviceCanAccessPeer(&access, options.device_, peer));
+    }
+    if (access == 0) {
+      continue;
+    }
+    void* src = nullptr;
+    void* dst = nullptr;
+    HIP_PERF_CHECK(hipSetDevice(peer));
+    HIP_PERF_CHECK(hipMalloc(&dst, MaxSize));
+    HIP_PERF_CHECK(hipSetDevice(options.device_));
+    HIP_PERF_CHECK(hipMalloc(&src, MaxSize));
+    hipError_t status = hipDeviceEnablePeerAccess(peer, 0);
+    if ((status != hipSuccess) && (status != hipErrorPeerAccessAlreadyEnabled)) {
+      HIP_PERF_CHECK(status);
+    }
+    hipStream_t stream;
+    HIP_PERF_CHECK(hipStreamCreate(&stream));
+
+    for (size_t size = 4 * 1024; size <= MaxSize; size *= 4) {
+      const std::string config = "peer=" + std::to_string(peer) + "," + sizeConfig(size);
+      reporter.add("peer_copy", config, "GB/s", bandwidth(size, stream, [&]() {
+        HIP_PERF_CHECK(hipMemcpyPeerAsync(dst, peer, src, options.device_, size, stream));
+      }));
+    }
+
+    HIP_PERF_CHECK(hipStreamDestroy(stream));
+    HIP_PERF_CHECK(hipDeviceDisablePeerAccess(peer));
+    HIP_PERF_CHECK(hipFree(src));
+    HIP_PERF_CHECK(hipSetDevice(peer));
+    HIP_PERF_CHECK(hipFree(dst));
+    HIP_PERF_CHECK(hipSetDevice(options.device_));
+  }
+}
+
+}  // namespace hipperf
@@ -0,0 +1,94 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hipPerfCommon.hpp"
+
+#include <hip/amd_detail/amd_hip_persistent.h>
+
+namespace hipperf {
+
+__device__ void persistentWork(const void* args) {
+  if (threadIdx.x == 0) {
+    uint32_t* counter = *reinterpret_cast<uint32_t* const*>(args);
+    __hip_atomic_fetch_add(counter, 1u, __ATOMIC_RELAXED, __HIP_MEMORY_SCOPE_SYSTEM);
+  }
+}
+
+__device__ hipExtPersistentFunction_t persistentWorkPtr = persistentWork;
+
+__global__ void persistentLaunchKernel(uint32_t* counter) { persistentWork(&counter); }
+
+// ================================================================================================
+void persistentLatency(const Options& options, Reporter& reporter) {
+  hipStream_t resident;
+  hipStream_t stream;
+  HIP_PERF_CHECK(hipStreamCreate(&resident));
+  HIP_PERF_CHECK(hipStreamCreate(&stream));
+  uint32_t* counter = nullptr;
+  HIP_PERF_CHECK(hipHostMalloc(&counter, sizeof(uint32_t), hipHostMallocCoherent));
+  void* function = nullptr;
+  HIP_PERF_CHECK(hipMemcpyFromSymbol(&function, HIP_SYMBOL(persistentWorkPtr), sizeof(function)));
+
+  hipExtPersistentQueue_t queue;
+  HIP_PERF_CHECK(hipExtPersistentQueueCreate(
+      &queue, reinterpret_cast<const void*>(hipExtPersistentKernel<>), 0, 64, 1024, resident));
+
+  // Round trip of a single work item, the counterpart of launch_latency
+  std::vector<double> persistent(options.iterations_);
+  for (auto& it : persistent) {
+    uint64_t ticket = 0;
+    const uint64_t start = timeNs();
+    HIP_PERF_CHECK(hipExtPersistentQueueEnqueue(queue, function, &counter, sizeof(counter),
+                                                &ticket));
+    HIP_PERF_CHECK(hipExtPersistentQueueWait(queue, ticket));
+    it = (timeNs() - start) / 1000.0;
+  }
+  reporter.add("persistent_latency", "mode=persistent", "us", persistent);
+
+  std::vector<double> launch(options.iterations_);
+  for (auto& it : launch) {
+    const uint64_t start = timeNs();
+    hipLaunchKernelGGL(persistentLaunchKernel, dim3(1), dim3(64), 0, stream, counter);
+    HIP_PERF_CHECK(hipStreamSynchronize(stream));
+    it = (timeNs() - start) / 1000.0;
+  }
+  reporter.add("persistent_latency", "mode=launch", "us", launch);
+
+  // Back to back work items without the waits
+  const uint64_t start = timeNs();
+  for (uint32_t i = 0; i < options.iterations_; ++i) {
+    HIP_PERF_CHECK(hipExtPersistentQueueEnqueue(queue, function, &counter, sizeof(counter),
+                                                nullptr));
+  }
+  HIP_PERF_CHECK(hipExtPersistentQueueSynchronize(queue));
+  reporter.add("persistent_latency", "mode=persistent_throughput", "us",
+               (timeNs() - start) / 1000.0 / options.iterations_);
+
+  HIP_PERF_CHECK(hipExtPersistentQueueDestroy(queue));
+  if (*counter != 3 * options.iterations_) {
+    fprintf(stderr, "persistent_latency: %u work items done, expected %u\n", *counter,
+            3 * options.iterations_);
+  }
+  HIP_PERF_CHECK(hipHostFree(counter));
+  HIP_PERF_CHECK(hipStreamDestroy(stream));
+  HIP_PERF_CHECK(hipStreamDestroy(resident));
+}
+
+}  // namespace hipperf
@@ -0,0 +1,428 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hipPerfCommon.hpp"
+#include "hip/amd_detail/hip_prof_str.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+namespace hipperf {
+
+__global__ void replayKernel() {}
+
+//! Copies and fills larger than this replay with this size, so any capture fits the device
+static constexpr size_t MaxReplayBytes = 256 * 1024 * 1024;
+
+//! Record of HIP_API_CAPTURE_FILE, must match hip::ApiCaptureRecord in hipamd/src/hip_capture.hpp
+struct CaptureRecord {
+  uint64_t start_;
+  uint64_t duration_;
+  uint64_t stream_;
+  uint64_t event_[2];
+  uint64_t function_;
+  uint64_t ptr_;
+  uint64_t size_;
+  uint64_t grid_;
+  uint64_t block_;
+  uint32_t api_;
+  uint32_t tid_;
+  uint32_t result_;
+  uint32_t kind_;
+};
+
+//! The call pattern of a capture file
+struct Capture {
+  std::vector<CaptureRecord> records_;               //!< The calls in the start time order
+  std::unordered_map<uint64_t, std::string> names_;  //!< Kernel names
+};
+
+// ================================================================================================
+static bool loadCapture(const std::string& fileName, Capture& capture) {
+  FILE* file = fopen(fileName.c_str(), "rb");
+  if (file == nullptr) {
+    fprintf(stderr, "Cannot open %s\n", fileName.c_str());
+    return false;
+  }
+  char magic[8];
+  uint32_t header[2];
+  bool result = (fread(magic, sizeof(magic), 1, file) == 1) &&
+      (memcmp(magic, "HIPCAPTR", sizeof(magic)) == 0) &&
+      (fread(header, sizeof(header), 1, file) == 1) && (header[0] == 1);
+  if (!result) {
+    fprintf(stderr, "%s isn't a capture file of version 1\n", fileName.c_str());
+  }
+  int tag;
+  while (result && ((tag = fgetc(file)) != EOF)) {
+    if (tag == 'C') {
+      CaptureRecord record;
+      result = (fread(&record, sizeof(record), 1, file) == 1);
+      capture.records_.push_back(record);
+    } else if (tag == 'K') {
+      uint64_t function;
+      uint32_t size;
+      result = (fread(&function, sizeof(function), 1, file) == 1) &&
+          (fread(&size, sizeof(size), 1, file) == 1);
+      std::string name(size, '\0');
+      result = result && (fread(&name[0], 1, size, file) == size);
+      capture.names_[function] = name;
+    } else {
+      result = false;
+    }
+    if (!result) {
+      fprintf(stderr, "%s is corrupted\n", fileName.c_str());
+    }
+  }
+  fclose(file);
+  // The threads write the records at the exit, replay in the order of the calls
+  std::stable_sort(capture.records_.begin(), capture.records_.end(),
+                   [](const CaptureRecord& a, const CaptureRecord& b) {
+                     return a.start_ < b.start_;
+                   });
+  return result;
+}
+
+/*! \brief Replays a capture with synthetic data
+ *
+ *  The captured streams, events and allocations are recreated on the first use. The copies
+ *  and fills use scratch buffers, the launches an empty kernel with the captured grid. So
+ *  the replay reproduces the runtime overhead of the call pattern, not the kernel time.
+ *  All calls replay from one thread in the order of the capture.
+ */
+class Replay {
+ public:
+  explicit Replay(const Capture& capture) : capture_(capture) {
+    size_t scratch = 1;
+    for (const auto& it : capture.records_) {
+      if (isCopy(it.api_) || isFill(it.api_)) {
+        scratch = std::max(scratch, std::min(fillBytes(it), MaxReplayBytes));
+      }
+    }
+    scratchSize_ = scratch;
+    HIP_PERF_CHECK(hipMalloc(&device_[0], scratchSize_));
+    HIP_PERF_CHECK(hipMalloc(&device_[1], scratchSize_));
+    HIP_PERF_CHECK(hipHostMalloc(&host_, scratchSize_));
+  }
+
+  ~Replay() {
+    HIP_PERF_CHECK(hipDeviceSynchronize());
+    for (const auto& it : streams_) {
+      HIP_PERF_CHECK(hipStreamDestroy(it.second));
+    }
+    for (const auto& it : events_) {
+      HIP_PERF_CHECK(hipEventDestroy(it.second));
+    }
+    for (const auto& it : allocs_) {
+      HIP_PERF_CHECK(it.second.second ? hipHostFree(it.second.first) : hipFree(it.second.first));
+    }
+    HIP_PERF_CHECK(hipFree(device_[0]));
+    HIP_PERF_CHECK(hipFree(device_[1]));
+    HIP_PERF_CHECK(hipHostFree(host_));
+  }
+
+  //! Replays one call and returns false if the API isn't supported. \a ns is the host time
+  bool run(const CaptureRecord& record, uint64_t& ns);
+
+ private:
+  static bool isCopy(uint32_t api) {
+    switch (api) {
+      case HIP_API_ID_hipMemcpy:
+      case HIP_API_ID_hipMemcpyAsync:
+      case HIP_API_ID_hipMemcpyHtoD:
+      case HIP_API_ID_hipMemcpyHtoDAsync:
+      case HIP_API_ID_hipMemcpyDtoH:
+      case HIP_API_ID_hipMemcpyDtoHAsync:
+      case HIP_API_ID_hipMemcpyDtoD:
+      case HIP_API_ID_hipMemcpyDtoDAsync:
+      case HIP_API_ID_hipMemcpy2D:
+      case HIP_API_ID_hipMemcpy2DAsync:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  static bool isFill(uint32_t api) {
+    switch (api) {
+      case HIP_API_ID_hipMemset:
+      case HIP_API_ID_hipMemsetAsync:
+      case HIP_API_ID_hipMemsetD8:
+      case HIP_API_ID_hipMemsetD8Async:
+      case HIP_API_ID_hipMemsetD16:
+      case HIP_API_ID_hipMemsetD16Async:
+      case HIP_API_ID_hipMemsetD32:
+      case HIP_API_ID_hipMemsetD32Async:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  //! Returns the size of a fill in bytes, the D16 and D32 fills capture the elements
+  static size_t fillBytes(const CaptureRecord& record) {
+    switch (record.api_) {
+      case HIP_API_ID_hipMemsetD16:
+      case HIP_API_ID_hipMemsetD16Async:
+        return record.size_ * 2;
+      case HIP_API_ID_hipMemsetD32:
+      case HIP_API_ID_hipMemsetD32Async:
+        return record.size_ * 4;
+      default:
+        return record.size_;
+    }
+  }
+
+  hipStream_t stream(uint64_t id) {
+    if (id == 0) {
+      return nullptr;
+    }
+    auto it = streams_.find(id);
+    if (it == streams_.end()) {
+      hipStream_t stream;
+      HIP_PERF_CHECK(hipStreamCreate(&stream));
+      it = streams_.insert({id, stream}).first;
+    }
+    return it->second;
+  }
+
+  hipEvent_t event(uint64_t id) {
+    auto it = events_.find(id);
+    if (it == events_.end()) {
+      hipEvent_t event;
+      HIP_PERF_CHECK(hipEventCreate(&event));
+      it = events_.insert({id, event}).first;
+    }
+    return it->second;
+  }
+
+  const Capture& capture_;
+  std::unordered_map<uint64_t, hipStream_t> streams_;
+  std::unordered_map<uint64_t, hipEvent_t> events_;
+  std::unordered_map<uint64_t, std::pair<void*, bool>> allocs_;  //!< Host allocs are marked
+  void* device_[2];     //!< Scratch memory of the device copies and fills
+  void* host_;          //!< Pinned scratch memory of the host copies
+  size_t scratchSize_;  //!< Size of every scratch buffer
+};
+
+// ================================================================================================
+bool Replay::run(const CaptureRecord& record, uint64_t& ns) {
+  const size_t size = std::min<size_t>(record.size_, scratchSize_);
+  hipStream_t s = stream(record.stream_);
+  // The copy direction of the APIs without a kind argument
+  uint32_t kind = record.kind_;
+  switch (record.api_) {
+    case HIP_API_ID_hipMemcpyHtoD:
+    case HIP_API_ID_hipMemcpyHtoDAsync:
+      kind = hipMemcpyHostToDevice;
+      break;
+    case HIP_API_ID_hipMemcpyDtoH:
+    case HIP_API_ID_hipMemcpyDtoHAsync:
+      kind = hipMemcpyDeviceToHost;
+      break;
+    case HIP_API_ID_hipMemcpyDtoD:
+    case HIP_API_ID_hipMemcpyDtoDAsync:
+      kind = hipMemcpyDeviceToDevice;
+      break;
+    default:
+      break;
+  }
+  const bool dstHost = (kind == hipMemcpyDeviceToHost) || (kind == hipMemcpyHostToHost);
+  const bool srcHost = (kind == hipMemcpyHostToDevice) || (kind == hipMemcpyHostToHost);
+  void* dst = dstHost ? host_ : device_[0];
+  const void* src = srcHost ? host_ : device_[1];
+  const dim3 grid(static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(record.grid_, 1),
+                                                           INT32_MAX)));
+  const dim3 block(static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(record.block_, 1),
+                                                            1024)));
+
+  const uint64_t start = timeNs();
+  switch (record.api_) {
+    case HIP_API_ID_hipLaunchKernel:
+    case HIP_API_ID_hipExtLaunchKernel:
+    case HIP_API_ID_hipLaunchCooperativeKernel:
+    case HIP_API_ID_hipModuleLaunchKernel:
+    case HIP_API_ID_hipExtModuleLaunchKernel:
+    case HIP_API_ID_hipHccModuleLaunchKernel:
+      hipLaunchKernelGGL(replayKernel, grid, block, 0, s);
+      break;
+    case HIP_API_ID_hipMemcpy:
+    case HIP_API_ID_hipMemcpyHtoD:
+    case HIP_API_ID_hipMemcpyDtoH:
+    case HIP_API_ID_hipMemcpyDtoD:
+    case HIP_API_ID_hipMemcpy2D:
+      HIP_PERF_CHECK(hipMemcpy(dst, src, size, hipMemcpyDefault));
+      break;
+    case HIP_API_ID_hipMemcpyAsync:
+    case HIP_API_ID_hipMemcpyHtoDAsync:
+    case HIP_API_ID_hipMemcpyDtoHAsync:
+    case HIP_API_ID_hipMemcpyDtoDAsync:
+    case HIP_API_ID_hipMemcpy2DAsync:
+      HIP_PERF_CHECK(hipMemcpyAsync(dst, src, size, hipMemcpyDefault, s));
+      break;
+    case HIP_API_ID_hipMemset:
+    case HIP_API_ID_hipMemsetD8:
+    case HIP_API_ID_hipMemsetD16:
+    case HIP_API_ID_hipMemsetD32:
+      HIP_PERF_CHECK(hipMemset(device_[0], 0, std::min(fillBytes(record), scratchSize_)));
+      break;
+    case HIP_API_ID_hipMemsetAsync:
+    case HIP_API_ID_hipMemsetD8Async:
+    case HIP_API_ID_hipMemsetD16Async:
+    case HIP_API_ID_hipMemsetD32Async:
+      HIP_PERF_CHECK(hipMemsetAsync(device_[0], 0, std::min(fillBytes(record), scratchSize_), s));
+      break;
+    case HIP_API_ID_hipMalloc:
+    case HIP_API_ID_hipExtMallocWithFlags: {
+      void* ptr;
+      HIP_PERF_CHECK(hipMalloc(&ptr, std::max<size_t>(record.size_, 1)));
+      allocs_[record.ptr_] = {ptr, false};
+      break;
+    }
+    case HIP_API_ID_hipHostMalloc: {
+      void* ptr;
+      HIP_PERF_CHECK(hipHostMalloc(&ptr, std::max<size_t>(record.size_, 1)));
+      allocs_[record.ptr_] = {ptr, true};
+      break;
+    }
+    case HIP_API_ID_hipMallocAsync: {
+      void* ptr;
+      HIP_PERF_CHECK(hipMallocAsync(&ptr, std::max<size_t>(record.size_, 1), s));
+      allocs_[record.ptr_] = {ptr, false};
+      break;
+    }
+    case HIP_API_ID_hipFree:
+    case HIP_API_ID_hipHostFree:
+    case HIP_API_ID_hipFreeAsync: {
+      auto it = allocs_.find(record.ptr_);
+      if (it == allocs_.end()) {
+        // The allocation was before the capture or from an API without the replay
+        return false;
+      }
+      if (record.api_ == HIP_API_ID_hipFreeAsync) {
+        HIP_PERF_CHECK(hipFreeAsync(it->second.first, s));
+      } else {
+        HIP_PERF_CHECK(it->second.second ? hipHostFree(it->second.first) :
+                                           hipFree(it->second.first));
+      }
+      allocs_.erase(it);
+      break;
+    }
+    case HIP_API_ID_hipStreamCreate:
+    case HIP_API_ID_hipStreamCreateWithFlags:
+    case HIP_API_ID_hipStreamCreateWithPriority: {
+      hipStream_t stream;
+      HIP_PERF_CHECK(hipStreamCreate(&stream));
+      streams_[record.stream_] = stream;
+      break;
+    }
+    case HIP_API_ID_hipStreamDestroy:
+      HIP_PERF_CHECK(hipStreamDestroy(s));
+      streams_.erase(record.stream_);
+      break;
+    case HIP_API_ID_hipStreamSynchronize:
+      HIP_PERF_CHECK(hipStreamSynchronize(s));
+      break;
+    case HIP_API_ID_hipStreamQuery:
+      (void)hipStreamQuery(s);
+      break;
+    case HIP_API_ID_hipStreamWaitEvent:
+      HIP_PERF_CHECK(hipStreamWaitEvent(s, event(record.event_[0]), 0));
+      break;
+    case HIP_API_ID_hipDeviceSynchronize:
+      HIP_PERF_CHECK(hipDeviceSynchronize());
+      break;
+    case HIP_API_ID_hipEventCreate:
+    case HIP_API_ID_hipEventCreateWithFlags: {
+      hipEvent_t event;
+      HIP_PERF_CHECK(hipEventCreate(&event));
+      events_[record.event_[0]] = event;
+      break;
+    }
+    case HIP_API_ID_hipEventDestroy:
+      HIP_PERF_CHECK(hipEventDestroy(event(record.event_[0])));
+      events_.erase(record.event_[0]);
+      break;
+    case HIP_API_ID_hipEventRecord:
+      HIP_PERF_CHECK(hipEventRecord(event(record.event_[0]), s));
+      break;
+    case HIP_API_ID_hipEventSynchronize:
+      HIP_PERF_CHECK(hipEventSynchronize(event(record.event_[0])));
+      break;
+    case HIP_API_ID_hipEventQuery:
+      (void)hipEventQuery(event(record.event_[0]));
+      break;
+    default:
+      return false;
+  }
+  ns = timeNs() - start;
+  return true;
+}
+
+// ================================================================================================
+void captureReplay(const Options& options, Reporter& reporter) {
+  // The capture comes from the command line only
+  if (options.capture_.empty()) {
+    return;
+  }
+  Capture capture;
+  if (!loadCapture(options.capture_, capture)) {
+    return;
+  }
+
+  // The samples of every API and kernel, the captured ones and the replayed ones
+  std::map<std::string, std::pair<std::vector<double>, std::vector<double>>> samples;
+  uint32_t skipped = 0;
+  uint64_t replayNs = 0;
+  {
+    Replay replay(capture);
+    HIP_PERF_CHECK(hipDeviceSynchronize());
+    const uint64_t start = timeNs();
+    for (const auto& it : capture.records_) {
+      uint64_t ns;
+      // The failed calls have no effect to reproduce
+      if ((it.result_ != hipSuccess) || !replay.run(it, ns)) {
+        ++skipped;
+        continue;
+      }
+      std::string config = std::string("api=") + hip_api_name(it.api_);
+      auto name = capture.names_.find(it.function_);
+      if (name != capture.names_.end()) {
+        config += ",kernel=" + name->second;
+      }
+      auto& sample = samples[config];
+      sample.first.push_back(it.duration_ / 1000.0);
+      sample.second.push_back(ns / 1000.0);
+    }
+    HIP_PERF_CHECK(hipDeviceSynchronize());
+    replayNs = timeNs() - start;
+  }
+
+  for (auto& it : samples) {
+    reporter.add("capture_api", it.first, "us", it.second.first);
+    reporter.add("replay_api", it.first, "us", it.second.second);
+  }
+  const std::string config = "calls=" + std::to_string(capture.records_.size());
+  reporter.add("replay_total", config, "ms", replayNs / 1e6);
+  reporter.add("replay_skipped", config, "calls", skipped);
+}
+
+}  // namespace hipperf
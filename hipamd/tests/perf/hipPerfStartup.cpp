@@ -0,0 +1,169 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hipPerfCommon.hpp"
+
+#include <fcntl.h>
+#include <ftw.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+
+namespace hipperf {
+
+__global__ void startupKernel() {}
+
+//! Environment variable, which turns hipperf into a child of the startup benchmark
+static const char* StartupChild = "HIPPERF_STARTUP_CHILD";
+
+//! Host time of the spawn of the child, in ns
+static const char* StartupSpawn = "HIPPERF_STARTUP_SPAWN_NS";
+
+//! Processes per mode, every sample is a full runtime init
+static constexpr uint32_t MaxStartupRuns = 20;
+
+// ================================================================================================
+bool isStartupChild() { return getenv(StartupChild) != nullptr; }
+
+// ================================================================================================
+/*! \brief Measures the phases of a fresh process and prints them as "<phase> <us>" lines
+ *
+ *  The time to main includes the loader and the static initializers, hence also
+ *  __hipRegisterFatBinary() of the hipperf kernels. The spawn time includes the environment
+ *  setup of runSelf(), which is a few us.
+ */
+int startupChild(const Options& options, uint64_t mainNs) {
+  const char* spawn = getenv(StartupSpawn);
+  const uint64_t spawnNs = (spawn != nullptr) ? strtoull(spawn, nullptr, 10) : mainNs;
+  printf("process_to_main %.3f\n", (mainNs - spawnNs) / 1000.0);
+
+  // Runtime init, roc::Device::init() discovers the devices
+  uint64_t start = timeNs();
+  HIP_PERF_CHECK(hipInit(0));
+  printf("hip_init %.3f\n", (timeNs() - start) / 1000.0);
+
+  // The device and the context, including the blit program build
+  start = timeNs();
+  HIP_PERF_CHECK(hipSetDevice(options.device_));
+  HIP_PERF_CHECK(hipFree(nullptr));
+  printf("device_init %.3f\n", (timeNs() - start) / 1000.0);
+
+  // The first launch loads the code object of the fat binary
+  start = timeNs();
+  hipLaunchKernelGGL(startupKernel, dim3(1), dim3(1), 0, 0);
+  HIP_PERF_CHECK(hipDeviceSynchronize());
+  const uint64_t end = timeNs();
+  printf("first_launch %.3f\n", (end - start) / 1000.0);
+  printf("start_to_first_dispatch %.3f\n", (end - spawnNs) / 1000.0);
+
+  if (!options.module_.empty()) {
+    hipModule_t module;
+    start = timeNs();
+    HIP_PERF_CHECK(hipModuleLoad(&module, options.module_.c_str()));
+    printf("module_load %.3f\n", (timeNs() - start) / 1000.0);
+    HIP_PERF_CHECK(hipModuleUnload(module));
+  }
+  return EXIT_SUCCESS;
+}
+
+// ================================================================================================
+//! Runs one child and adds its phases to \a phases
+static void runChild(const std::string& cacheDir, const Options& options,
+                     std::map<std::string, std::vector<double>>& phases) {
+  int pipeFd[2];
+  if (pipe2(pipeFd, O_CLOEXEC) != 0) {
+    perror("pipe2");
+    exit(EXIT_FAILURE);
+  }
+  std::vector<std::string> args = {"-d", std::to_string(options.device_)};
+  if (!options.module_.empty()) {
+    args.push_back("-m");
+    args.push_back(options.module_);
+  }
+  // All runtime code caches live under GPU_BLIT_CODE_CACHE_PATH
+  const bool passed = runSelf(args, {{"GPU_BLIT_CODE_CACHE_PATH", cacheDir},
+                                     {StartupChild, "1"},
+                                     {StartupSpawn, std::to_string(timeNs())}}, pipeFd[1]);
+  close(pipeFd[1]);
+
+  FILE* output = fdopen(pipeFd[0], "r");
+  char phase[64];
+  double us;
+  while (fscanf(output, "%63s %lf", phase, &us) == 2) {
+    phases[phase].push_back(us);
+  }
+  fclose(output);
+  if (!passed) {
+    fprintf(stderr, "startup_time: the child process failed\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+// ================================================================================================
+static std::string createCacheDir() {
+  char dir[] = "/tmp/hipperf_cache_XXXXXX";
+  if (mkdtemp(dir) == nullptr) {
+    perror("mkdtemp");
+    exit(EXIT_FAILURE);
+  }
+  return dir;
+}
+
+// ================================================================================================
+static void removeCacheDir(const std::string& dir) {
+  nftw(dir.c_str(), [](const char* path, const struct stat*, int, struct FTW*) {
+    return remove(path);
+  }, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+// ================================================================================================
+/*! \brief Process start to the first dispatch, with the code caches cold and warm
+ *
+ *  Every cold run gets an empty cache directory, the warm runs share one directory,
+ *  which a run before the measurement fills. The OS page cache stays warm in both modes.
+ */
+void startupTime(const Options& options, Reporter& reporter) {
+  const uint32_t runs = std::min(options.iterations_, MaxStartupRuns);
+  for (const bool cold : {true, false}) {
+    std::map<std::string, std::vector<double>> phases;
+    if (cold) {
+      for (uint32_t i = 0; i < runs; ++i) {
+        const std::string dir = createCacheDir();
+        runChild(dir, options, phases);
+        removeCacheDir(dir);
+      }
+    } else {
+      const std::string dir = createCacheDir();
+      std::map<std::string, std::vector<double>> prime;
+      runChild(dir, options, prime);
+      for (uint32_t i = 0; i < runs; ++i) {
+        runChild(dir, options, phases);
+      }
+      removeCacheDir(dir);
+    }
+    const std::string config = std::string("cache=") + (cold ? "cold" : "warm");
+    for (auto& it : phases) {
+      reporter.add(("startup_" + it.first).c_str(), config, "us", it.second);
+    }
+  }
+}
+
+}  // namespace hipperf
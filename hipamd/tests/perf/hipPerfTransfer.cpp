@@ -0,0 +1,261 @@
+/* Copyright (c) 2022 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include "hipPerfCommon.hpp"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace hipperf {
+
+//! Engine of the child processes, see TransferEngines
+static const char* TransferEngine = "HIPPERF_TRANSFER_ENGINE";
+
+//! Largest transfer, reduced to the memory of the system
+static constexpr size_t MaxTransferSize = 4ull * 1024 * 1024 * 1024;
+
+//! A cell repeats the copy until this amount of data is transferred
+static constexpr size_t TransferBytes = 256ull * 1024 * 1024;
+
+//! Memory policies of set_mempolicy(), numaif.h is a part of libnuma-dev
+static constexpr int PolicyDefault = 0;
+static constexpr int PolicyBind = 2;
+
+//! The engine settings. ROC picks SDMA or the blit kernels by GPU_FORCE_BLIT_COPY_SIZE and
+//! the ROCr copies by HSA_ENABLE_SDMA, PAL uses GPU_BLIT_ENGINE_TYPE.
+static const struct {
+  const char* name_;
+  std::vector<std::pair<std::string, std::string>> env_;
+} TransferEngines[] = {
+  {"default", {}},
+  {"sdma", {{"GPU_BLIT_ENGINE_TYPE", "2"}, {"GPU_FORCE_BLIT_COPY_SIZE", "0"},
+            {"ROC_COPY_ENGINE_CALIBRATE", "0"}}},
+  {"blit", {{"GPU_BLIT_ENGINE_TYPE", "3"}, {"GPU_FORCE_BLIT_COPY_SIZE", "4194304"},
+            {"ROC_COPY_ENGINE_CALIBRATE", "0"}, {"HSA_ENABLE_SDMA", "0"}}},
+};
+
+//! Host memory types
+enum class Host { Pageable, Pinned, Registered };
+
+static const struct {
+  Host type_;
+  const char* name_;
+} Hosts[] = {{Host::Pageable, "pageable"}, {Host::Pinned, "pinned"},
+             {Host::Registered, "registered"}};
+
+// ================================================================================================
+//! Returns the number of the NUMA nodes, 1 without the NUMA information
+static int numaNodes() {
+  std::ifstream file("/sys/devices/system/node/online");
+  std::string online;
+  if (!(file >> online)) {
+    return 1;
+  }
+  // The list is "0" or "0-3", or "0-1,3" with the holes
+  const size_t last = online.find_last_of("-,");
+  const int nodes = atoi(online.c_str() + ((last == std::string::npos) ? 0 : last + 1)) + 1;
+  return std::min(std::max(nodes, 1), 64);
+}
+
+// ================================================================================================
+//! Binds the future allocations of the thread to \a node, -1 restores the default
+static bool bindNuma(int node) {
+  if (node < 0) {
+    return syscall(SYS_set_mempolicy, PolicyDefault, nullptr, 0) == 0;
+  }
+  unsigned long mask = 1ul << node;
+  return syscall(SYS_set_mempolicy, PolicyBind, &mask, sizeof(mask) * 8) == 0;
+}
+
+// ================================================================================================
+//! Allocates \a size bytes of \a type on the bound NUMA node
+static void* allocHost(Host type, size_t size) {
+  void* ptr = nullptr;
+  if (type == Host::Pinned) {
+    // NumaUser follows the policy of the thread
+    HIP_PERF_CHECK(hipHostMalloc(&ptr, size, hipHostMallocNumaUser));
+    return ptr;
+  }
+  ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) {
+    perror("mmap");
+    exit(EXIT_FAILURE);
+  }
+  // First touch, the pages land on the bound node
+  memset(ptr, 0, size);
+  if (type == Host::Registered) {
+    HIP_PERF_CHECK(hipHostRegister(ptr, size, hipHostRegisterDefault));
+  }
+  return ptr;
+}
+
+// ================================================================================================
+static void freeHost(Host type, void* ptr, size_t size) {
+  if (type == Host::Pinned) {
+    HIP_PERF_CHECK(hipHostFree(ptr));
+    return;
+  }
+  if (type == Host::Registered) {
+    HIP_PERF_CHECK(hipHostUnregister(ptr));
+  }
+  munmap(ptr, size);
+}
+
+// ================================================================================================
+//! Returns the bandwidth of \a copy in GB/s, the small copies are limited to \a maxRepeats
+template <typename Copy>
+static double transferBandwidth(size_t size, size_t maxRepeats, hipStream_t stream, Copy copy) {
+  copy();
+  HIP_PERF_CHECK(hipStreamSynchronize(stream));
+  const size_t repeats = std::max<size_t>(1, std::min(maxRepeats, TransferBytes / size));
+  const uint64_t start = timeNs();
+  for (size_t i = 0; i < repeats; ++i) {
+    copy();
+  }
+  HIP_PERF_CHECK(hipStreamSynchronize(stream));
+  return static_cast<double>(size) * repeats / (timeNs() - start);
+}
+
+// ================================================================================================
+//! Sweeps the sizes of one cell row, the config has the same keys in all rows
+template <typename Copy>
+static void sweep(const char* engine, const char* dir, const char* host, const std::string& numa,
+                  size_t maxSize, const Options& options, hipStream_t stream,
+                  Reporter& reporter, Copy copy) {
+  for (size_t size = 4; size <= maxSize; size *= 4) {
+    const std::string config = std::string("engine=") + engine + ",dir=" + dir + ",host=" +
+        host + ",numa=" + numa + ",bytes=" + std::to_string(size);
+    reporter.add("transfer_matrix", config, "GB/s",
+                 transferBandwidth(size, options.iterations_, stream, [&]() { copy(size); }));
+  }
+}
+
+// ================================================================================================
+static void transferCells(const char* engine, const Options& options, Reporter& reporter) {
+  hipDeviceProp_t props;
+  HIP_PERF_CHECK(hipGetDeviceProperties(&props, options.device_));
+  // 2 device buffers for D2D and one host buffer at a time
+  const size_t hostMemory = static_cast<size_t>(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGESIZE);
+  size_t maxSize = MaxTransferSize;
+  while ((maxSize > 4) && ((maxSize * 4 > props.totalGlobalMem) || (maxSize * 4 > hostMemory))) {
+    maxSize /= 4;
+  }
+
+  hipStream_t stream;
+  HIP_PERF_CHECK(hipStreamCreate(&stream));
+  void* src = nullptr;
+  void* dst = nullptr;
+  HIP_PERF_CHECK(hipMalloc(&src, maxSize));
+  HIP_PERF_CHECK(hipMalloc(&dst, maxSize));
+
+  const int nodes = numaNodes();
+  for (int node = 0; node < nodes; ++node) {
+    if (!bindNuma(node)) {
+      // A memoryless or offline node
+      continue;
+    }
+    const std::string numa = std::to_string(node);
+    for (const auto& host : Hosts) {
+      void* ptr = allocHost(host.type_, maxSize);
+      bindNuma(-1);
+      sweep(engine, "h2d", host.name_, numa, maxSize, options, stream, reporter, [&](size_t size) {
+        HIP_PERF_CHECK(hipMemcpyAsync(src, ptr, size, hipMemcpyHostToDevice, stream));
+      });
+      sweep(engine, "d2h", host.name_, numa, maxSize, options, stream, reporter, [&](size_t size) {
+        HIP_PERF_CHECK(hipMemcpyAsync(ptr, src, size, hipMemcpyDeviceToHost, stream));
+      });
+      freeHost(host.type_, ptr, maxSize);
+      bindNuma(node);
+    }
+    bindNuma(-1);
+  }
+
+  sweep(engine, "d2d", "none", "none", maxSize, options, stream, reporter, [&](size_t size) {
+    HIP_PERF_CHECK(hipMemcpyAsync(dst, src, size, hipMemcpyDeviceToDevice, stream));
+  });
+
+  int count = 0;
+  HIP_PERF_CHECK(hipGetDeviceCount(&count));
+  for (int peer = 0; peer < count; ++peer) {
+    int access = 0;
+    if (peer != options.device_) {
+      HIP_PERF_CHECK(hipDeviceCanAccessPeer(&access, options.device_, peer));
+    }
+    if (access == 0) {
+      continue;
+    }
+    void* peerDst = nullptr;
+    HIP_PERF_CHECK(hipSetDevice(peer));
+    HIP_PERF_CHECK(hipMalloc(&peerDst, maxSize));
+    HIP_PERF_CHECK(hipSetDevice(options.device_));
+    hipError_t status = hipDeviceEnablePeerAccess(peer, 0);
+    if ((status != hipSuccess) && (status != hipErrorPeerAccessAlreadyEnabled)) {
+      HIP_PERF_CHECK(status);
+    }
+    const std::string dir = "p2p" + std::to_string(peer);
+    sweep(engine, dir.c_str(), "none", "none", maxSize, options, stream, reporter,
+          [&](size_t size) {
+      HIP_PERF_CHECK(hipMemcpyPeerAsync(peerDst, peer, src, options.device_, size, stream));
+    });
+    HIP_PERF_CHECK(hipDeviceDisablePeerAccess(peer));
+    HIP_PERF_CHECK(hipFree(peerDst));
+  }
+
+  HIP_PERF_CHECK(hipFree(dst));
+  HIP_PERF_CHECK(hipFree(src));
+  HIP_PERF_CHECK(hipStreamDestroy(stream));
+}
+
+// ================================================================================================
+/*! \brief Bandwidth matrix of the size, the direction, the host memory, the engine and the
+ *  NUMA node of the host memory
+ *
+ *  Every row has the same config keys, so the output pivots into a heatmap per engine and
+ *  direction. The runtime reads the engine settings once, hence every engine runs in a new
+ *  process.
+ */
+void transferMatrix(const Options& options, Reporter& reporter) {
+  const char* engine = getenv(TransferEngine);
+  if (engine != nullptr) {
+    transferCells(engine, options, reporter);
+    return;
+  }
+  for (const auto& it : TransferEngines) {
+    std::vector<std::string> args = {"-d", std::to_string(options.device_), "-i",
+                                      std::to_string(options.iterations_), "-t",
+                                      "transfer_matrix"};
+    if (options.csv_) {
+      args.push_back("-csv");
+    }
+    auto env = it.env_;
+    env.push_back(std::make_pair(TransferEngine, it.name_));
+    if (!runSelf(args, env, STDOUT_FILENO)) {
+      fprintf(stderr, "transfer_matrix: engine=%s failed\n", it.name_);
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+}  // namespace hipperf